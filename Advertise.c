@@ -0,0 +1,467 @@
+/*****< advertise.c >**********************************************************/
+/*                                                                            */
+/*  Advertise - LE advertising manager with precomputed payloads and fast/    */
+/*              slow interval profiles.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "Main.h"          /* Application Interface Abstraction.              */
+#include "Advertise.h"     /* Advertising Manager Prototypes/Constants.       */
+#include "ConnParam.h"     /* Connection Parameter Policy Prototypes.         */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+
+#define MAXIMUM_PAYLOAD_LENGTH                          (31)  /* Denotes the   */
+                                                         /* size of the       */
+                                                         /* advertising data  */
+                                                         /* and scan response.*/
+
+#define MAXIMUM_UUIDS                                    (8)  /* Denotes the   */
+                                                         /* number of UUIDs   */
+                                                         /* that can be       */
+                                                         /* listed (more can  */
+                                                         /* never fit).       */
+
+   /* The following type definition represents the container type which */
+   /* holds a payload that is being built.                              */
+typedef struct _tagPayload_t
+{
+   unsigned int Length;
+   Byte_t       Data[MAXIMUM_PAYLOAD_LENGTH];
+} Payload_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static unsigned int           AdvertiseStackID;     /* Variable which holds the*/
+                                                    /* stack the advertising   */
+                                                    /* is managed on (zero if  */
+                                                    /* it is not managed).     */
+
+static Advertising_Data_t     AdvertisingData;      /* Variables which hold the*/
+static unsigned int           AdvertisingDataLength; /* precomputed payloads.  */
+static Scan_Response_Data_t   ScanResponseData;
+static unsigned int           ScanResponseDataLength;
+
+static Advertise_Profile_t    CurrentProfile;       /* Variables which hold the*/
+static unsigned int           NumberConnections;    /* current profile, the    */
+static unsigned long          FastStartTime;        /* number of links and when*/
+static unsigned long          AdvertiseStartTime;   /* the fast profile and the*/
+                                                    /* advertising were        */
+                                                    /* started.                */
+
+static Advertise_Statistics_t AdvertiseStatistics;  /* Variable which holds the*/
+                                                    /* statistics.             */
+
+   /* Internal function prototypes.                                     */
+static Byte_t *AppendUUIDList(Payload_t *Payload, unsigned int NumberUUIDs, const GATT_UUID_t *UUIDs, GATT_UUID_Type_t UUIDType, Boolean_t *Listed);
+static void AppendName(Payload_t *Payload, char *DeviceName);
+static Advertise_Profile_t DesiredProfile(void);
+static void ApplyProfile(Advertise_Profile_t Profile);
+static void BTPSAPI GAP_LE_Event_Callback(unsigned int BluetoothStackID, GAP_LE_Event_Data_t *GAP_LE_Event_Data, unsigned long CallbackParameter);
+
+   /* The following function appends a list of the UUIDs of the         */
+   /* specified type that were not yet listed and fit into the payload. */
+   /* The type field of the list is returned (NULL if no list was       */
+   /* added) so it can be set to the complete or partial type once it is*/
+   /* known whether every UUID made it into one of the payloads.        */
+static Byte_t *AppendUUIDList(Payload_t *Payload, unsigned int NumberUUIDs, const GATT_UUID_t *UUIDs, GATT_UUID_Type_t UUIDType, Boolean_t *Listed)
+{
+   Byte_t       *ret_val = NULL;
+   unsigned int  Index;
+   unsigned int  UUIDSize;
+   unsigned int  LengthOffset;
+
+   UUIDSize = (UUIDType == guUUID_16)?sizeof(UUID_16_t):sizeof(UUID_128_t);
+
+   /* A list needs the length and type fields and at least one UUID.    */
+   if((Payload->Length + 2 + UUIDSize) <= MAXIMUM_PAYLOAD_LENGTH)
+   {
+      LengthOffset = Payload->Length;
+
+      Payload->Data[LengthOffset]     = 1;
+      Payload->Data[LengthOffset + 1] = 0;
+      Payload->Length                += 2;
+
+      for(Index=0;Index<NumberUUIDs;Index++)
+      {
+         if((!Listed[Index]) && (UUIDs[Index].UUID_Type == UUIDType) && ((Payload->Length + UUIDSize) <= MAXIMUM_PAYLOAD_LENGTH))
+         {
+            if(UUIDType == guUUID_16)
+               BTPS_MemCopy(&(Payload->Data[Payload->Length]), &(UUIDs[Index].UUID.UUID_16), UUIDSize);
+            else
+               BTPS_MemCopy(&(Payload->Data[Payload->Length]), &(UUIDs[Index].UUID.UUID_128), UUIDSize);
+
+            Payload->Data[LengthOffset] += (Byte_t)UUIDSize;
+            Payload->Length             += UUIDSize;
+            Listed[Index]                = TRUE;
+         }
+      }
+
+      /* Drop the list again if no UUID of the type was left.           */
+      if(Payload->Data[LengthOffset] == 1)
+         Payload->Length = LengthOffset;
+      else
+         ret_val = &(Payload->Data[LengthOffset + 1]);
+   }
+
+   return(ret_val);
+}
+
+   /* The following function appends the device name to the payload,   */
+   /* shortened to the space that is left.                              */
+static void AppendName(Payload_t *Payload, char *DeviceName)
+{
+   unsigned int NameLength;
+
+   if((DeviceName) && ((NameLength = BTPS_StringLength(DeviceName)) != 0) && ((Payload->Length + 3) <= MAXIMUM_PAYLOAD_LENGTH))
+   {
+      if((Payload->Length + 2 + NameLength) <= MAXIMUM_PAYLOAD_LENGTH)
+         Payload->Data[Payload->Length + 1] = HCI_LE_ADVERTISING_DATA_TYPE_LOCAL_NAME_COMPLETE;
+      else
+      {
+         NameLength                         = MAXIMUM_PAYLOAD_LENGTH - (Payload->Length + 2);
+         Payload->Data[Payload->Length + 1] = HCI_LE_ADVERTISING_DATA_TYPE_LOCAL_NAME_SHORTENED;
+      }
+
+      Payload->Data[Payload->Length] = (Byte_t)(NameLength + 1);
+
+      BTPS_MemCopy(&(Payload->Data[Payload->Length + 2]), DeviceName, NameLength);
+
+      Payload->Length += NameLength + 2;
+   }
+}
+
+   /* The following function returns the profile that should be in use */
+   /* for the current number of links and time.                         */
+static Advertise_Profile_t DesiredProfile(void)
+{
+   Advertise_Profile_t ret_val;
+
+   if(NumberConnections >= ADVERTISE_MAXIMUM_CONNECTIONS)
+      ret_val = apStopped;
+   else
+   {
+      if((!NumberConnections) && ((BTPS_GetTickCount() - FastStartTime) < ADVERTISE_FAST_TIMEOUT_MS))
+         ret_val = apFast;
+      else
+         ret_val = apSlow;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function (re)starts or stops the advertising with   */
+   /* the specified profile.  The payloads are left as they are, only   */
+   /* the parameters change.                                            */
+static void ApplyProfile(Advertise_Profile_t Profile)
+{
+   int                                Result;
+   GAP_LE_Advertising_Parameters_t    AdvertisingParameters;
+   GAP_LE_Connectability_Parameters_t ConnectabilityParameters;
+
+   if(Profile == apStopped)
+   {
+      GAP_LE_Advertising_Disable(AdvertiseStackID);
+
+      Result = 0;
+   }
+   else
+   {
+      BTPS_MemInitialize(&ConnectabilityParameters, 0, sizeof(ConnectabilityParameters));
+
+      if(Profile == apFast)
+      {
+         AdvertisingParameters.Advertising_Interval_Min = ADVERTISE_FAST_INTERVAL_MIN;
+         AdvertisingParameters.Advertising_Interval_Max = ADVERTISE_FAST_INTERVAL_MAX;
+      }
+      else
+      {
+         AdvertisingParameters.Advertising_Interval_Min = ADVERTISE_SLOW_INTERVAL_MIN;
+         AdvertisingParameters.Advertising_Interval_Max = ADVERTISE_SLOW_INTERVAL_MAX;
+      }
+
+      AdvertisingParameters.Advertising_Channel_Map   = HCI_LE_ADVERTISING_CHANNEL_MAP_DEFAULT;
+      AdvertisingParameters.Scan_Request_Filter       = fpNoFilter;
+      AdvertisingParameters.Connect_Request_Filter    = fpNoFilter;
+
+      ConnectabilityParameters.Connectability_Mode    = lcmConnectable;
+      ConnectabilityParameters.Own_Address_Type       = latPublic;
+      ConnectabilityParameters.Direct_Address_Type    = latPublic;
+
+      Result = GAP_LE_Advertising_Enable(AdvertiseStackID, (Boolean_t)(ScanResponseDataLength != 0), &AdvertisingParameters, &ConnectabilityParameters, GAP_LE_Event_Callback, 0);
+   }
+
+   /* A failed start is retried on the next pass.                       */
+   if(!Result)
+   {
+      if(Profile != CurrentProfile)
+         AdvertiseStatistics.ProfileChanges++;
+
+      CurrentProfile = Profile;
+   }
+   else
+   {
+      AdvertiseStatistics.Failures++;
+
+      CurrentProfile = apStopped;
+   }
+
+   AdvertiseStatistics.Profile = CurrentProfile;
+}
+
+   /* The following function is the GAP LE event callback of the        */
+   /* advertising.  It counts the links, records the time to connection */
+   /* and passes the events on to the connection parameter policy.  The */
+   /* advertising itself is adjusted from Advertise_Process() (the      */
+   /* controller already stopped it when a central connected).          */
+static void BTPSAPI GAP_LE_Event_Callback(unsigned int BluetoothStackID, GAP_LE_Event_Data_t *GAP_LE_Event_Data, unsigned long CallbackParameter)
+{
+   unsigned long TimeToConnection;
+
+   if((AdvertiseStackID) && (GAP_LE_Event_Data))
+   {
+      switch(GAP_LE_Event_Data->Event_Data_Type)
+      {
+         case etLE_Connection_Complete:
+            if((GAP_LE_Event_Data->Event_Data.GAP_LE_Connection_Complete_Event_Data) && (!GAP_LE_Event_Data->Event_Data.GAP_LE_Connection_Complete_Event_Data->Status) && (!GAP_LE_Event_Data->Event_Data.GAP_LE_Connection_Complete_Event_Data->Master))
+            {
+               TimeToConnection = BTPS_GetTickCount() - AdvertiseStartTime;
+
+               if(!AdvertiseStatistics.Connections)
+                  AdvertiseStatistics.TimeToFirstConnection = TimeToConnection;
+
+               if((!AdvertiseStatistics.Connections) || (TimeToConnection < AdvertiseStatistics.MinimumTimeToConnection))
+                  AdvertiseStatistics.MinimumTimeToConnection = TimeToConnection;
+
+               if(TimeToConnection > AdvertiseStatistics.MaximumTimeToConnection)
+                  AdvertiseStatistics.MaximumTimeToConnection = TimeToConnection;
+
+               if(CurrentProfile == apFast)
+                  AdvertiseStatistics.FastConnections++;
+
+               AdvertiseStatistics.Connections++;
+               AdvertiseStatistics.LastTimeToConnection   = TimeToConnection;
+               AdvertiseStatistics.TotalTimeToConnection += TimeToConnection;
+
+               /* The next connection is timed from now (the advertising*/
+               /* goes on if more links are allowed).                   */
+               AdvertiseStartTime = BTPS_GetTickCount();
+
+               NumberConnections++;
+
+               CurrentProfile              = apStopped;
+               AdvertiseStatistics.Profile = apStopped;
+            }
+            break;
+         case etLE_Disconnection_Complete:
+            if(NumberConnections)
+            {
+               NumberConnections--;
+
+               /* Losing the last link starts the fast profile again, a */
+               /* central that dropped the link usually reconnects soon.*/
+               if(!NumberConnections)
+               {
+                  FastStartTime      = BTPS_GetTickCount();
+                  AdvertiseStartTime = FastStartTime;
+               }
+            }
+            break;
+         default:
+            break;
+      }
+
+      /* The links the advertising brought up are the ones whose        */
+      /* parameters the policy manages.                                 */
+      ConnParam_ProcessGAPLEEvent(GAP_LE_Event_Data);
+   }
+}
+
+   /* The following function builds the advertising data (the flags and */
+   /* the specified service UUIDs) and the scan response (the UUIDs that*/
+   /* did not fit and the device name, shortened if needed), passes them*/
+   /* to the controller and starts the fast advertising.  The UUIDs are */
+   /* listed in the order specified, 16-bit UUIDs first.  This function */
+   /* may be called again after the stack was re-opened (the statistics */
+   /* are kept).  This function returns zero if successful or a negative*/
+   /* error code.                                                       */
+int Advertise_Initialize(unsigned int BluetoothStackID, char *DeviceName, unsigned int NumberUUIDs, const GATT_UUID_t *UUIDs)
+{
+   int          ret_val;
+   Byte_t      *TypeFields[4];
+   Boolean_t    Complete16;
+   Boolean_t    Complete128;
+   Boolean_t    Listed[MAXIMUM_UUIDS];
+   Payload_t    Advertising;
+   Payload_t    ScanResponse;
+   unsigned int Index;
+
+   if((BluetoothStackID) && (NumberUUIDs <= MAXIMUM_UUIDS) && ((!NumberUUIDs) || (UUIDs)))
+   {
+      BTPS_MemInitialize(Listed, 0, sizeof(Listed));
+      BTPS_MemInitialize(&Advertising, 0, sizeof(Advertising));
+      BTPS_MemInitialize(&ScanResponse, 0, sizeof(ScanResponse));
+
+      /* The flags are mandatory for a discoverable device and must be  */
+      /* in the advertising data.                                       */
+      Advertising.Data[0] = 2;
+      Advertising.Data[1] = HCI_LE_ADVERTISING_DATA_TYPE_FLAGS;
+      Advertising.Data[2] = (HCI_LE_ADVERTISING_FLAGS_GENERAL_DISCOVERABLE_MODE_FLAGS_BIT_MASK | HCI_LE_ADVERTISING_FLAGS_SIMULTANEOUS_LE_BR_EDR_TO_SAME_DEVICE_CONTROLLER_BIT_MASK | HCI_LE_ADVERTISING_FLAGS_SIMULTANEOUS_LE_BR_EDR_TO_SAME_DEVICE_HOST_BIT_MASK);
+      Advertising.Length  = 3;
+
+      /* The UUIDs go into the advertising data as far as they fit (a   */
+      /* central filtering on a service does not need to scan), the    */
+      /* rest into the scan response.                                  */
+      TypeFields[0] = AppendUUIDList(&Advertising, NumberUUIDs, UUIDs, guUUID_16, Listed);
+      TypeFields[1] = AppendUUIDList(&Advertising, NumberUUIDs, UUIDs, guUUID_128, Listed);
+      TypeFields[2] = AppendUUIDList(&ScanResponse, NumberUUIDs, UUIDs, guUUID_16, Listed);
+      TypeFields[3] = AppendUUIDList(&ScanResponse, NumberUUIDs, UUIDs, guUUID_128, Listed);
+
+      Complete16  = TRUE;
+      Complete128 = TRUE;
+
+      for(Index=0;Index<NumberUUIDs;Index++)
+      {
+         if(!Listed[Index])
+         {
+            if(UUIDs[Index].UUID_Type == guUUID_16)
+               Complete16 = FALSE;
+            else
+               Complete128 = FALSE;
+         }
+      }
+
+      /* A list is only complete if it holds every UUID of its type, a  */
+      /* type that was split between both payloads has two partial      */
+      /* lists.                                                         */
+      if((TypeFields[0]) && (TypeFields[2]))
+         Complete16 = FALSE;
+
+      if((TypeFields[1]) && (TypeFields[3]))
+         Complete128 = FALSE;
+
+      for(Index=0;Index<(sizeof(TypeFields)/sizeof(TypeFields[0]));Index++)
+      {
+         if(TypeFields[Index])
+         {
+            if(!(Index % 2))
+               *(TypeFields[Index]) = (Byte_t)(Complete16?HCI_LE_ADVERTISING_DATA_TYPE_16_BIT_SERVICE_UUID_COMPLETE:HCI_LE_ADVERTISING_DATA_TYPE_16_BIT_SERVICE_UUID_PARTIAL);
+            else
+               *(TypeFields[Index]) = (Byte_t)(Complete128?HCI_LE_ADVERTISING_DATA_TYPE_128_BIT_SERVICE_UUID_COMPLETE:HCI_LE_ADVERTISING_DATA_TYPE_128_BIT_SERVICE_UUID_PARTIAL);
+         }
+      }
+
+      /* The name is only needed once the device was found, it fills   */
+      /* the scan response.                                            */
+      AppendName(&ScanResponse, DeviceName);
+
+      AdvertiseStackID       = BluetoothStackID;
+      NumberConnections      = 0;
+      CurrentProfile         = apStopped;
+
+      BTPS_MemCopy(AdvertisingData.Advertising_Data, Advertising.Data, sizeof(AdvertisingData.Advertising_Data));
+      BTPS_MemCopy(ScanResponseData.Scan_Response_Data, ScanResponse.Data, sizeof(ScanResponseData.Scan_Response_Data));
+
+      AdvertisingDataLength  = Advertising.Length;
+      ScanResponseDataLength = ScanResponse.Length;
+
+      if((ret_val = GAP_LE_Set_Advertising_Data(BluetoothStackID, AdvertisingDataLength, &AdvertisingData)) == 0)
+      {
+         if((ret_val = GAP_LE_Set_Scan_Response_Data(BluetoothStackID, ScanResponseDataLength, &ScanResponseData)) == 0)
+         {
+            FastStartTime      = BTPS_GetTickCount();
+            AdvertiseStartTime = FastStartTime;
+
+            ApplyProfile(apFast);
+         }
+      }
+
+      if(ret_val)
+         AdvertiseStackID = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function stops the advertising and the management  */
+   /* of it (until Advertise_Initialize() is called again).             */
+void Advertise_Cleanup(void)
+{
+   if(AdvertiseStackID)
+   {
+      if(CurrentProfile != apStopped)
+         GAP_LE_Advertising_Disable(AdvertiseStackID);
+
+      AdvertiseStackID            = 0;
+      CurrentProfile              = apStopped;
+      AdvertiseStatistics.Profile = apStopped;
+   }
+}
+
+   /* The following function must be called periodically from the main  */
+   /* loop.  It switches between the advertising profiles and restarts  */
+   /* the advertising after a link was lost.                            */
+void Advertise_Process(void)
+{
+   Advertise_Profile_t Profile;
+
+   if(AdvertiseStackID)
+   {
+      if((Profile = DesiredProfile()) != CurrentProfile)
+         ApplyProfile(Profile);
+   }
+}
+
+   /* The following function returns the advertising statistics.  This  */
+   /* function returns zero if successful or a negative value if the    */
+   /* parameter is invalid.                                             */
+int Advertise_QueryStatistics(Advertise_Statistics_t *Statistics)
+{
+   int ret_val;
+
+   if(Statistics)
+   {
+      *Statistics = AdvertiseStatistics;
+      ret_val     = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function displays the payloads, the profile in use  */
+   /* and the advertising statistics.                                   */
+void Advertise_Display(void)
+{
+   unsigned int Index;
+
+   Display(("Advertising Data (%u bytes):", AdvertisingDataLength));
+
+   for(Index=0;Index<AdvertisingDataLength;Index++)
+      Display((" %02X", AdvertisingData.Advertising_Data[Index]));
+
+   Display(("\r\nScan Response    (%u bytes):", ScanResponseDataLength));
+
+   for(Index=0;Index<ScanResponseDataLength;Index++)
+      Display((" %02X", ScanResponseData.Scan_Response_Data[Index]));
+
+   Display(("\r\n"));
+
+   Display(("   %-24s %s\r\n", "Profile", (AdvertiseStatistics.Profile == apFast)?"Fast":((AdvertiseStatistics.Profile == apSlow)?"Slow":"Stopped")));
+   Display(("   %-24s %u\r\n", "Links", NumberConnections));
+   Display(("   %-24s %u (%u while fast)\r\n", "Connections", AdvertiseStatistics.Connections, AdvertiseStatistics.FastConnections));
+   Display(("   %-24s %u\r\n", "Profile Changes", AdvertiseStatistics.ProfileChanges));
+   Display(("   %-24s %u\r\n", "Failures", AdvertiseStatistics.Failures));
+
+   if(AdvertiseStatistics.Connections)
+   {
+      Display(("   %-24s %5lu ms\r\n", "Time To First Connection", AdvertiseStatistics.TimeToFirstConnection));
+      Display(("   %-24s %5lu ms\r\n", "Last Time To Connection", AdvertiseStatistics.LastTimeToConnection));
+      Display(("   %-24s %5lu ms (min %lu ms, max %lu ms)\r\n", "Mean Time To Connection", (AdvertiseStatistics.TotalTimeToConnection / AdvertiseStatistics.Connections), AdvertiseStatistics.MinimumTimeToConnection, AdvertiseStatistics.MaximumTimeToConnection));
+   }
+   else
+      Display(("   No connection yet.\r\n"));
+}
@@ -0,0 +1,105 @@
+/*****< advertise.h >**********************************************************/
+/*                                                                            */
+/*  Advertise - LE advertising manager with precomputed payloads and fast/    */
+/*              slow interval profiles.                                       */
+/*                                                                            */
+/*  The advertising data and scan response are built once (from the service */
+/*  UUIDs and the device name) and handed to the controller, only the        */
+/*  advertising parameters change afterwards.  The device advertises with   */
+/*  the fast profile for ADVERTISE_FAST_TIMEOUT_MS after the advertising is  */
+/*  started (and after the last link was lost), then with the slow profile.  */
+/*  Once ADVERTISE_MAXIMUM_CONNECTIONS links are up the advertising stops,   */
+/*  below that but with links up the slow profile is used.                   */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __ADVERTISEH__
+#define __ADVERTISEH__
+
+#include "SS1BTPS.h"       /* Includes for the SS1 Bluetooth Protocol Stack.  */
+#include "GATTAPI.h"       /* Includes for the GATT API.                      */
+
+#ifndef ADVERTISE_MAXIMUM_CONNECTIONS
+
+#define ADVERTISE_MAXIMUM_CONNECTIONS                (1)  /* Denotes the number*/
+                                                         /* of LE links at    */
+                                                         /* which the         */
+                                                         /* advertising is    */
+                                                         /* stopped.          */
+
+#endif
+
+#define ADVERTISE_FAST_TIMEOUT_MS                (30000)  /* Denotes how long  */
+                                                         /* the fast profile  */
+                                                         /* is used before    */
+                                                         /* falling back to   */
+                                                         /* the slow profile. */
+
+#define ADVERTISE_FAST_INTERVAL_MIN                 (32)  /* Denotes the fast  */
+#define ADVERTISE_FAST_INTERVAL_MAX                 (48)  /* profile interval  */
+                                                         /* (20 - 30 ms, in   */
+                                                         /* 0.625 ms units).  */
+
+#define ADVERTISE_SLOW_INTERVAL_MIN               (1600)  /* Denotes the slow  */
+#define ADVERTISE_SLOW_INTERVAL_MAX               (1636)  /* profile interval  */
+                                                         /* (1000 - 1022.5 ms,*/
+                                                         /* in 0.625 ms       */
+                                                         /* units).           */
+
+   /* The following enumerated type represents the advertising profile  */
+   /* that is in use.                                                   */
+typedef enum
+{
+   apStopped,
+   apFast,
+   apSlow
+} Advertise_Profile_t;
+
+   /* The following structure holds the statistics of the advertising.  */
+   /* All times are in milliseconds.  The time to connection is measured*/
+   /* from the start of the advertising (at initialization or after the */
+   /* last link was lost) until a central connected, the time to first  */
+   /* connection is the one of the first connection after               */
+   /* initialization.                                                   */
+typedef struct _tagAdvertise_Statistics_t
+{
+   Advertise_Profile_t Profile;
+   unsigned int        Connections;
+   unsigned int        FastConnections;
+   unsigned int        ProfileChanges;
+   unsigned int        Failures;
+   unsigned long       TimeToFirstConnection;
+   unsigned long       LastTimeToConnection;
+   unsigned long       MinimumTimeToConnection;
+   unsigned long       MaximumTimeToConnection;
+   unsigned long       TotalTimeToConnection;
+} Advertise_Statistics_t;
+
+   /* The following function builds the advertising data (the flags and */
+   /* the specified service UUIDs) and the scan response (the UUIDs that*/
+   /* did not fit and the device name, shortened if needed), passes them*/
+   /* to the controller and starts the fast advertising.  The UUIDs are */
+   /* listed in the order specified, 16-bit UUIDs first.  This function */
+   /* may be called again after the stack was re-opened (the statistics */
+   /* are kept).  This function returns zero if successful or a negative*/
+   /* error code.                                                       */
+int Advertise_Initialize(unsigned int BluetoothStackID, char *DeviceName, unsigned int NumberUUIDs, const GATT_UUID_t *UUIDs);
+
+   /* The following function stops the advertising and the management  */
+   /* of it (until Advertise_Initialize() is called again).             */
+void Advertise_Cleanup(void);
+
+   /* The following function must be called periodically from the main  */
+   /* loop.  It switches between the advertising profiles and restarts  */
+   /* the advertising after a link was lost.                            */
+void Advertise_Process(void);
+
+   /* The following function returns the advertising statistics.  This  */
+   /* function returns zero if successful or a negative value if the    */
+   /* parameter is invalid.                                             */
+int Advertise_QueryStatistics(Advertise_Statistics_t *Statistics);
+
+   /* The following function displays the payloads, the profile in use  */
+   /* and the advertising statistics.                                   */
+void Advertise_Display(void);
+
+#endif
@@ -0,0 +1,722 @@
+/*****< audiolink.c >**********************************************************/
+/*                                                                            */
+/*  AudioLink - Synchronous parameter set selection of the HFP audio link.    */
+/*                                                                            */
+/******************************************************************************/
+#include "Main.h"          /* Application Interface Abstraction.              */
+#include "AudioLink.h"     /* Audio Link Prototypes/Constants.                */
+#include "PeerCache.h"     /* Peer Cache Prototypes/Constants.                */
+#include "SS1BTHFR.h"      /* Bluetooth HFRE API Prototypes/Constants.        */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+
+   /* The following type definition represents the container type which */
+   /* holds the parameters of a set (HFP 1.7 5.7).  The packet types    */
+   /* carry the inverted EDR bits, so only the named EDR packet is      */
+   /* allowed.                                                          */
+typedef struct _tagSet_Parameters_t
+{
+   Word_t Packet_Type;
+   Word_t Max_Latency;
+   Byte_t Retransmission_Effort;
+} Set_Parameters_t;
+
+   /* The following type definition represents the container type which */
+   /* holds the state of a setup.  Set is the set being tried, Tried    */
+   /* flags the sets of the codec tried so far and Remembered a set that*/
+   /* came from the peer cache.  CodecFallback flags a setup that went  */
+   /* on with CVSD after mSBC failed, StartTime is the time of the      */
+   /* request.                                                          */
+typedef struct _tagSetup_t
+{
+   Boolean_t         InProgress;
+   BD_ADDR_t         BD_ADDR;
+   unsigned int      HFREPortID;
+   Word_t            Connection_Handle;
+   AudioLink_Codec_t Codec;
+   AudioLink_Set_t   Set;
+   Word_t            Tried;
+   Boolean_t         Remembered;
+   Boolean_t         CodecFallback;
+   unsigned int      Attempts;
+   unsigned long     StartTime;
+} Setup_t;
+
+   /* The following type definition represents the container type which */
+   /* holds a codec list limited to CVSD.  The full list is offered     */
+   /* again through the port once the audio connection is over, the     */
+   /* limit ends with the ACL link.                                     */
+typedef struct _tagCodecLimit_t
+{
+   Boolean_t    Limited;
+   BD_ADDR_t    BD_ADDR;
+   unsigned int HFREPortID;
+   Word_t       Connection_Handle;
+} CodecLimit_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static unsigned int            AudioLinkStackID;    /* Variable which holds the*/
+                                                    /* stack of the audio      */
+                                                    /* links (zero if the      */
+                                                    /* module is stopped).     */
+
+static Setup_t                 Setup;               /* Variable which holds the*/
+                                                    /* setup in progress.      */
+
+static CodecLimit_t            CodecLimit;          /* Variable which holds the*/
+                                                    /* codec list limited to   */
+                                                    /* CVSD.                   */
+
+static Boolean_t               ResultValid;         /* Variable which flags if */
+                                                    /* LastResult holds an     */
+                                                    /* audio connection.       */
+
+static AudioLink_Information_t LastResult;          /* Variable which holds the*/
+                                                    /* result of the last audio*/
+                                                    /* connection.             */
+
+static AudioLink_Statistics_t  AudioLinkStatistics; /* Variable which holds the*/
+                                                    /* statistics.             */
+
+static const Set_Parameters_t SetParameters[asNumberSets] =
+{
+   { 0x0000, 0x0000, 0x00 },
+   { 0x03C4, 0xFFFF, 0xFF },
+   { 0x03C8, 0x0007, 0x01 },
+   { 0x0388, 0x0007, 0x01 },
+   { 0x0388, 0x000A, 0x01 },
+   { 0x0388, 0x000C, 0x02 },
+   { 0x03C8, 0x0008, 0x02 },
+   { 0x0388, 0x000D, 0x02 }
+};
+
+   /* The following tables hold the order the sets of each codec are    */
+   /* tried in (terminated by asNone).                                  */
+static const AudioLink_Set_t CVSDSets[] = { asS4, asS3, asS2, asS1, asD1, asNone };
+static const AudioLink_Set_t MSBCSets[] = { asT2, asT1, asNone };
+
+static const AudioLink_Set_t *CodecSets[acNumberCodecs] = { CVSDSets, MSBCSets };
+
+   /* The following table holds the CVSD sets with EDR packets, the     */
+   /* tightest latency first (terminated by asNone).                    */
+static const AudioLink_Set_t CVSDEDRSets[] = { asS2, asS3, asS4, asNone };
+
+static char *SetNames[asNumberSets] = { "-", "D1", "S1", "S2", "S3", "S4", "T1", "T2" };
+
+static char *CodecNames[acNumberCodecs] = { "CVSD", "mSBC" };
+
+   /* The following table holds the HFRE codec IDs (AT+BAC).            */
+static unsigned char CodecIDs[acNumberCodecs] = { HFRE_CVSD_CODEC_ID, HFRE_MSBC_CODEC_ID };
+
+   /* Internal function prototypes.                                     */
+static Boolean_t SetOfCodec(AudioLink_Codec_t Codec, AudioLink_Set_t Set);
+static AudioLink_Set_t FirstSet(BD_ADDR_t BD_ADDR, AudioLink_Codec_t Codec, Boolean_t *Remembered);
+static AudioLink_Set_t NextSet(void);
+static int ApplySet(AudioLink_Set_t Set);
+static int RequestSet(AudioLink_Set_t Set);
+static void StartCodec(AudioLink_Codec_t Codec);
+static int LimitCodecs(void);
+static void RestoreCodecs(void);
+static AudioLink_Set_t ClassifySet(HCI_Synchronous_Connection_Complete_Event_Data_t *SynchronousData, AudioLink_Codec_t Codec);
+static void RecordResult(HCI_Synchronous_Connection_Complete_Event_Data_t *SynchronousData, AudioLink_Codec_t Codec, AudioLink_Set_t Set, unsigned int Attempts, unsigned long SetupTime);
+static void ProcessSynchronousConnection(HCI_Synchronous_Connection_Complete_Event_Data_t *SynchronousData);
+
+   /* The following function returns TRUE if the specified set is one of*/
+   /* the specified codec.                                              */
+static Boolean_t SetOfCodec(AudioLink_Codec_t Codec, AudioLink_Set_t Set)
+{
+   unsigned int Index;
+   Boolean_t    ret_val = FALSE;
+
+   for(Index=0;(CodecSets[Codec][Index] != asNone) && (!ret_val);Index++)
+   {
+      if(CodecSets[Codec][Index] == Set)
+         ret_val = TRUE;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the set to try first with the      */
+   /* specified device and codec, the one remembered in the peer cache  */
+   /* or else the best one.  Remembered is set to TRUE if the set was   */
+   /* remembered.                                                       */
+static AudioLink_Set_t FirstSet(BD_ADDR_t BD_ADDR, AudioLink_Codec_t Codec, Boolean_t *Remembered)
+{
+   Byte_t          Cached;
+   AudioLink_Set_t ret_val;
+
+   Cached = PeerCache_QueryAudioSet(BD_ADDR, (unsigned int)Codec);
+
+   if((Cached < asNumberSets) && (SetOfCodec(Codec, (AudioLink_Set_t)Cached)))
+   {
+      *Remembered = TRUE;
+      ret_val     = (AudioLink_Set_t)Cached;
+   }
+   else
+   {
+      *Remembered = FALSE;
+      ret_val     = CodecSets[Codec][0];
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the best set of the codec of the   */
+   /* setup that was not tried yet (asNone if all were).                */
+static AudioLink_Set_t NextSet(void)
+{
+   unsigned int    Index;
+   AudioLink_Set_t ret_val = asNone;
+
+   for(Index=0;(CodecSets[Setup.Codec][Index] != asNone) && (ret_val == asNone);Index++)
+   {
+      if(!(Setup.Tried & (1 << CodecSets[Setup.Codec][Index])))
+         ret_val = CodecSets[Setup.Codec][Index];
+   }
+
+   return(ret_val);
+}
+
+   /* The following function hands the parameters of the specified set  */
+   /* to the SCO layer, HFRE sets up and accepts the audio connections  */
+   /* with them.  This function returns zero if successful or a negative*/
+   /* error code.                                                       */
+static int ApplySet(AudioLink_Set_t Set)
+{
+   return(SCO_Set_Synchronous_Parameters(AudioLinkStackID, SetParameters[Set].Packet_Type, SetParameters[Set].Max_Latency, SetParameters[Set].Retransmission_Effort));
+}
+
+   /* The following function requests an audio connection with the      */
+   /* specified set through the port of the setup.  This function       */
+   /* returns zero if the request was sent or a negative error code.    */
+static int RequestSet(AudioLink_Set_t Set)
+{
+   int ret_val;
+
+   Setup.Set    = Set;
+   Setup.Tried |= (Word_t)(1 << Set);
+
+   if((ret_val = ApplySet(Set)) == 0)
+      ret_val = HFRE_Setup_Audio_Connection(AudioLinkStackID, Setup.HFREPortID);
+
+   return(ret_val);
+}
+
+   /* The following function starts the walk through the sets of the    */
+   /* specified codec with the first set to try with the device of the  */
+   /* setup.                                                            */
+static void StartCodec(AudioLink_Codec_t Codec)
+{
+   Setup.Codec = Codec;
+   Setup.Set   = FirstSet(Setup.BD_ADDR, Codec, &Setup.Remembered);
+   Setup.Tried = (Word_t)(1 << Setup.Set);
+
+   if(Setup.Remembered)
+      AudioLinkStatistics.Remembered++;
+}
+
+   /* The following function offers CVSD only through the port of the   */
+   /* setup.  This function returns zero if successful or a negative    */
+   /* error code.                                                       */
+static int LimitCodecs(void)
+{
+   int ret_val;
+
+   if((ret_val = HFRE_Send_Available_Codecs(AudioLinkStackID, Setup.HFREPortID, 1, &CodecIDs[acCVSD])) == 0)
+   {
+      CodecLimit.Limited           = TRUE;
+      CodecLimit.BD_ADDR           = Setup.BD_ADDR;
+      CodecLimit.HFREPortID        = Setup.HFREPortID;
+      CodecLimit.Connection_Handle = Setup.Connection_Handle;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function offers the full codec list again if it was */
+   /* limited to CVSD.                                                  */
+static void RestoreCodecs(void)
+{
+   if(CodecLimit.Limited)
+   {
+      CodecLimit.Limited = FALSE;
+
+      if(!HFRE_Send_Available_Codecs(AudioLinkStackID, CodecLimit.HFREPortID, acNumberCodecs, CodecIDs))
+         AudioLinkStatistics.Restored++;
+   }
+}
+
+   /* The following function returns the set a negotiated synchronous   */
+   /* connection of the specified codec belongs to.  The controllers    */
+   /* report the packet length and the latency only, so the set is the  */
+   /* one of the packet with the tightest latency the connection        */
+   /* satisfies.                                                        */
+static AudioLink_Set_t ClassifySet(HCI_Synchronous_Connection_Complete_Event_Data_t *SynchronousData, AudioLink_Codec_t Codec)
+{
+   unsigned int    Index;
+   unsigned long   Latency;
+   AudioLink_Set_t ret_val;
+
+   if(SynchronousData->Link_Type == HCI_LINK_TYPE_SCO_CONNECTION)
+      ret_val = asD1;
+   else
+   {
+      /* An EV3 carries up to 30 bytes, the sets with more use 2-EV3.   */
+      if(Codec == acMSBC)
+         ret_val = (SynchronousData->Tx_Packet_Length <= 30)?asT1:asT2;
+      else
+      {
+         if(SynchronousData->Tx_Packet_Length <= 30)
+            ret_val = asS1;
+         else
+         {
+            Latency = ((unsigned long)SynchronousData->Transmission_Interval + SynchronousData->Retransmission_Window) * 625;
+            ret_val = asNone;
+
+            for(Index=0;(CVSDEDRSets[Index] != asNone) && (ret_val == asNone);Index++)
+            {
+               if(Latency <= ((unsigned long)SetParameters[CVSDEDRSets[Index]].Max_Latency * 1000))
+                  ret_val = CVSDEDRSets[Index];
+            }
+
+            if(ret_val == asNone)
+               ret_val = asS4;
+         }
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function records a completed synchronous connection */
+   /* (successful or not) as the last result.                           */
+static void RecordResult(HCI_Synchronous_Connection_Complete_Event_Data_t *SynchronousData, AudioLink_Codec_t Codec, AudioLink_Set_t Set, unsigned int Attempts, unsigned long SetupTime)
+{
+   BTPS_MemInitialize(&LastResult, 0, sizeof(LastResult));
+
+   LastResult.BD_ADDR   = SynchronousData->BD_ADDR;
+   LastResult.Codec     = Codec;
+   LastResult.Set       = Set;
+   LastResult.Status    = SynchronousData->Status;
+   LastResult.Attempts  = Attempts;
+   LastResult.SetupTime = SetupTime;
+
+   if(SynchronousData->Status == HCI_ERROR_CODE_NO_ERROR)
+   {
+      LastResult.Connected             = TRUE;
+      LastResult.Connection_Handle     = SynchronousData->Connection_Handle;
+      LastResult.Link_Type             = SynchronousData->Link_Type;
+      LastResult.Transmission_Interval = SynchronousData->Transmission_Interval;
+      LastResult.Retransmission_Window = SynchronousData->Retransmission_Window;
+      LastResult.Rx_Packet_Length      = SynchronousData->Rx_Packet_Length;
+      LastResult.Tx_Packet_Length      = SynchronousData->Tx_Packet_Length;
+      LastResult.Air_Mode              = SynchronousData->Air_Mode;
+
+      /* The interval and the window are in 0.625 ms slots.             */
+      LastResult.Latency               = ((unsigned long)SynchronousData->Transmission_Interval + SynchronousData->Retransmission_Window) * 625;
+   }
+
+   ResultValid = TRUE;
+}
+
+   /* The following function processes a Synchronous Connection Complete*/
+   /* event.  The attempts of a setup are counted, the set of a         */
+   /* connection is recorded in the peer cache (which forgets a failed  */
+   /* mSBC).  The set of a setup is the one that was requested, so it is*/
+   /* requested first again.  A connection outside of a setup was set up*/
+   /* by the AG.                                                        */
+static void ProcessSynchronousConnection(HCI_Synchronous_Connection_Complete_Event_Data_t *SynchronousData)
+{
+   Boolean_t         InSetup;
+   AudioLink_Codec_t Codec;
+   AudioLink_Set_t   Set;
+   AudioLink_Set_t   Requested;
+
+   InSetup = (Boolean_t)((Setup.InProgress) && (COMPARE_BD_ADDR(SynchronousData->BD_ADDR, Setup.BD_ADDR)));
+
+   if(InSetup)
+   {
+      Setup.Attempts++;
+      AudioLinkStatistics.Attempts++;
+   }
+
+   if(SynchronousData->Status == HCI_ERROR_CODE_NO_ERROR)
+   {
+      Codec     = (SynchronousData->Air_Mode == HCI_AIR_MODE_TRANSPARENT_DATA)?acMSBC:acCVSD;
+      Set       = ClassifySet(SynchronousData, Codec);
+      Requested = Set;
+
+      if(InSetup)
+      {
+         RecordResult(SynchronousData, Codec, Set, Setup.Attempts, BTPS_GetTickCount() - Setup.StartTime);
+
+         if(Setup.Attempts == 1)
+            AudioLinkStatistics.FirstTry++;
+         else
+            AudioLinkStatistics.Fallbacks++;
+
+         if(SetOfCodec(Codec, Setup.Set))
+            Requested = Setup.Set;
+      }
+      else
+      {
+         RecordResult(SynchronousData, Codec, Set, 0, 0);
+
+         AudioLinkStatistics.Accepted++;
+      }
+
+      if((Codec == acMSBC) && (PeerCache_QueryAudioSet(SynchronousData->BD_ADDR, (unsigned int)acMSBC) == AUDIO_LINK_CODEC_FAILED))
+         AudioLinkStatistics.Forgotten++;
+
+      PeerCache_UpdateAudioSet(SynchronousData->BD_ADDR, (unsigned int)Codec, (Byte_t)Requested);
+
+      AudioLinkStatistics.Negotiated[Set]++;
+   }
+   else
+   {
+      if(InSetup)
+         RecordResult(SynchronousData, Setup.Codec, asNone, Setup.Attempts, BTPS_GetTickCount() - Setup.StartTime);
+   }
+}
+
+   /* The following function initializes the module for the specified   */
+   /* stack (a setup in progress is dropped, the statistics are kept).  */
+   /* This function returns zero if successful or a negative error code.*/
+int AudioLink_Initialize(unsigned int BluetoothStackID)
+{
+   int ret_val;
+
+   if(BluetoothStackID)
+   {
+      BTPS_MemInitialize(&Setup, 0, sizeof(Setup));
+      BTPS_MemInitialize(&CodecLimit, 0, sizeof(CodecLimit));
+
+      AudioLinkStackID = BluetoothStackID;
+      ResultValid      = FALSE;
+
+      ret_val          = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function stops the module.                          */
+void AudioLink_Cleanup(void)
+{
+   BTPS_MemInitialize(&Setup, 0, sizeof(Setup));
+   BTPS_MemInitialize(&CodecLimit, 0, sizeof(CodecLimit));
+
+   AudioLinkStackID = 0;
+}
+
+   /* The following function must be called with the HCI events         */
+   /* (Synchronous Connection Complete and disconnection).  The         */
+   /* attempts and the negotiated link are recorded from here.          */
+void AudioLink_ProcessHCIEvent(HCI_Event_Data_t *HCI_Event_Data)
+{
+   Word_t Connection_Handle;
+
+   if((AudioLinkStackID) && (HCI_Event_Data) && (HCI_Event_Data->Event_Data.Void))
+   {
+      switch(HCI_Event_Data->Event_Data_Type)
+      {
+         case etSynchronous_Connection_Complete_Event:
+            ProcessSynchronousConnection(HCI_Event_Data->Event_Data.HCI_Synchronous_Connection_Complete_Event_Data);
+            break;
+         case etDisconnection_Complete_Event:
+            /* The loss of the ACL link ends a setup and a limited codec*/
+            /* list (the next service level connection offers all       */
+            /* codecs), the release of the audio connection is noted in */
+            /* the last result.                                         */
+            Connection_Handle = HCI_Event_Data->Event_Data.HCI_Disconnection_Complete_Event_Data->Connection_Handle;
+
+            if((Setup.InProgress) && (Setup.Connection_Handle == Connection_Handle))
+            {
+               AudioLinkStatistics.Failed++;
+
+               Setup.InProgress = FALSE;
+            }
+
+            if((CodecLimit.Limited) && (CodecLimit.Connection_Handle == Connection_Handle))
+               CodecLimit.Limited = FALSE;
+
+            if((ResultValid) && (LastResult.Connected) && (LastResult.Connection_Handle == Connection_Handle))
+               LastResult.Connected = FALSE;
+            break;
+         default:
+            break;
+      }
+   }
+}
+
+   /* The following function must be called with the codec the AG       */
+   /* selected for the specified device (+BCS).  The codec is the one   */
+   /* of a setup in progress from then on and the set remembered for it */
+   /* is handed to the SCO layer (also for the connections the AG sets  */
+   /* up).                                                              */
+void AudioLink_ProcessCodecSelection(BD_ADDR_t BD_ADDR, AudioLink_Codec_t Codec)
+{
+   Boolean_t Remembered;
+
+   if((AudioLinkStackID) && (Codec < acNumberCodecs))
+   {
+      if((Setup.InProgress) && (COMPARE_BD_ADDR(Setup.BD_ADDR, BD_ADDR)))
+      {
+         /* The AG selected another codec than the setup started with,  */
+         /* the walk starts over with the sets of that codec.           */
+         if(Codec != Setup.Codec)
+         {
+            StartCodec(Codec);
+
+            ApplySet(Setup.Set);
+         }
+      }
+      else
+         ApplySet(FirstSet(BD_ADDR, Codec, &Remembered));
+   }
+}
+
+   /* The following function must be called with the status of the HFRE */
+   /* Audio Connection Indications of the specified device.  This       */
+   /* function returns TRUE if a failed setup goes on with the next set */
+   /* or with CVSD (the setup is not over yet).                         */
+Boolean_t AudioLink_ProcessAudioConnection(BD_ADDR_t BD_ADDR, unsigned int Status)
+{
+   AudioLink_Set_t Set;
+   Boolean_t       ret_val = FALSE;
+
+   if((AudioLinkStackID) && (Setup.InProgress) && (COMPARE_BD_ADDR(Setup.BD_ADDR, BD_ADDR)))
+   {
+      if(Status)
+      {
+         /* A remembered set that failed is forgotten, the walk goes on */
+         /* with the best set that was not tried yet.                   */
+         if(Setup.Remembered)
+         {
+            PeerCache_UpdateAudioSet(Setup.BD_ADDR, (unsigned int)Setup.Codec, 0);
+
+            Setup.Remembered = FALSE;
+
+            AudioLinkStatistics.Forgotten++;
+         }
+
+         while((!ret_val) && ((Set = NextSet()) != asNone))
+            ret_val = (Boolean_t)(!RequestSet(Set));
+
+         /* No mSBC set worked.  Offering CVSD only makes the AG select */
+         /* CVSD and the CVSD sets are tried, the device is remembered  */
+         /* so the next setup offers CVSD only right away.              */
+         if((!ret_val) && (Setup.Codec == acMSBC) && (!Setup.CodecFallback))
+         {
+            PeerCache_UpdateAudioSet(Setup.BD_ADDR, (unsigned int)acMSBC, AUDIO_LINK_CODEC_FAILED);
+
+            Setup.CodecFallback = TRUE;
+
+            StartCodec(acCVSD);
+
+            if((!LimitCodecs()) && (!RequestSet(Setup.Set)))
+            {
+               AudioLinkStatistics.CodecFallbacks++;
+
+               ret_val = TRUE;
+            }
+         }
+
+         if(!ret_val)
+         {
+            AudioLinkStatistics.Failed++;
+
+            Setup.InProgress = FALSE;
+
+            RestoreCodecs();
+         }
+      }
+      else
+         Setup.InProgress = FALSE;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function must be called with the HFRE Audio         */
+   /* Disconnection Indications of the specified device.  The full      */
+   /* codec list is offered again if it was limited to CVSD.            */
+void AudioLink_ProcessAudioDisconnection(BD_ADDR_t BD_ADDR)
+{
+   if((AudioLinkStackID) && (CodecLimit.Limited) && (!Setup.InProgress) && (COMPARE_BD_ADDR(CodecLimit.BD_ADDR, BD_ADDR)))
+      RestoreCodecs();
+}
+
+   /* The following function sets up an audio connection through the    */
+   /* specified HFRE port to the specified device, the codec is the one */
+   /* the AG selected last (a setup in progress is dropped).  The set   */
+   /* remembered for the device is tried first.  This function returns  */
+   /* zero if the request was sent or a negative error code.            */
+int AudioLink_Setup(BD_ADDR_t BD_ADDR, unsigned int HFREPortID, AudioLink_Codec_t Codec)
+{
+   int    ret_val;
+   Word_t Connection_Handle;
+
+   if((AudioLinkStackID) && (Codec < acNumberCodecs) && (!GAP_Query_Connection_Handle(AudioLinkStackID, BD_ADDR, &Connection_Handle)))
+   {
+      BTPS_MemInitialize(&Setup, 0, sizeof(Setup));
+
+      Setup.BD_ADDR           = BD_ADDR;
+      Setup.HFREPortID        = HFREPortID;
+      Setup.Connection_Handle = Connection_Handle;
+      Setup.StartTime         = BTPS_GetTickCount();
+
+      AudioLinkStatistics.Setups++;
+
+      /* An AG that could not set up mSBC with the device before is     */
+      /* offered CVSD only, so it does not try the mSBC sets again.     */
+      ret_val = 0;
+
+      if(PeerCache_QueryAudioSet(BD_ADDR, (unsigned int)acMSBC) == AUDIO_LINK_CODEC_FAILED)
+      {
+         Codec               = acCVSD;
+         Setup.CodecFallback = TRUE;
+
+         if((ret_val = LimitCodecs()) == 0)
+            AudioLinkStatistics.CVSDOnly++;
+      }
+
+      StartCodec(Codec);
+
+      if((!ret_val) && ((ret_val = RequestSet(Setup.Set)) == 0))
+         Setup.InProgress = TRUE;
+      else
+      {
+         AudioLinkStatistics.Failed++;
+
+         RestoreCodecs();
+      }
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function returns TRUE while a setup to the specified*/
+   /* device is in progress.                                            */
+Boolean_t AudioLink_InProgress(BD_ADDR_t BD_ADDR)
+{
+   return((Boolean_t)((Setup.InProgress) && (COMPARE_BD_ADDR(Setup.BD_ADDR, BD_ADDR))));
+}
+
+   /* The following function returns the result of the last audio       */
+   /* connection.  This function returns zero if successful or a        */
+   /* negative value if there was none.                                 */
+int AudioLink_QueryLink(AudioLink_Information_t *Information)
+{
+   int ret_val;
+
+   if((Information) && (ResultValid))
+   {
+      *Information = LastResult;
+      ret_val      = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following functions return the name of a parameter set and of */
+   /* the packet type of a negotiated audio connection.                 */
+char *AudioLink_SetName(AudioLink_Set_t Set)
+{
+   return((Set < asNumberSets)?SetNames[Set]:"?");
+}
+
+char *AudioLink_PacketName(AudioLink_Information_t *Information)
+{
+   char *ret_val;
+
+   /* The controllers report the link type and the packet lengths only, */
+   /* the packet follows from the length (an EV3 carries up to 30       */
+   /* bytes, a 2-EV3 60 and a 3-EV3 90).                                */
+   if((Information) && (Information->Connected))
+   {
+      if(Information->Link_Type == HCI_LINK_TYPE_SCO_CONNECTION)
+         ret_val = "HV3";
+      else
+      {
+         if(Information->Tx_Packet_Length <= 30)
+            ret_val = "EV3";
+         else
+         {
+            if(Information->Tx_Packet_Length <= 60)
+               ret_val = "2-EV3";
+            else
+               ret_val = "3-EV3";
+         }
+      }
+   }
+   else
+      ret_val = "-";
+
+   return(ret_val);
+}
+
+   /* The following function returns the statistics.  This function     */
+   /* returns zero if successful or a negative value if the parameter is*/
+   /* invalid.                                                          */
+int AudioLink_QueryStatistics(AudioLink_Statistics_t *Statistics)
+{
+   int ret_val;
+
+   if(Statistics)
+   {
+      *Statistics = AudioLinkStatistics;
+      ret_val     = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function displays the parameter sets, the last audio*/
+   /* connection and the statistics.                                    */
+void AudioLink_Display(void)
+{
+   unsigned int Index;
+   unsigned int Codec;
+
+   Display(("   %-5s %-4s %-6s %-7s %-6s %s\r\n", "Codec", "Set", "Packet", "Latency", "Effort", "Negotiated"));
+
+   for(Codec=0;Codec<acNumberCodecs;Codec++)
+   {
+      for(Index=0;CodecSets[Codec][Index] != asNone;Index++)
+         Display(("   %-5s %-4s 0x%04X 0x%04X  0x%02X   %lu\r\n", CodecNames[Codec], SetNames[CodecSets[Codec][Index]], SetParameters[CodecSets[Codec][Index]].Packet_Type, SetParameters[CodecSets[Codec][Index]].Max_Latency, SetParameters[CodecSets[Codec][Index]].Retransmission_Effort, AudioLinkStatistics.Negotiated[CodecSets[Codec][Index]]));
+   }
+
+   if(ResultValid)
+   {
+      Display(("   %-24s %02X:%02X:%02X:%02X:%02X:%02X %s %s%s%s\r\n", "Last Connection", LastResult.BD_ADDR.BD_ADDR5, LastResult.BD_ADDR.BD_ADDR4, LastResult.BD_ADDR.BD_ADDR3, LastResult.BD_ADDR.BD_ADDR2, LastResult.BD_ADDR.BD_ADDR1, LastResult.BD_ADDR.BD_ADDR0, CodecNames[LastResult.Codec], SetNames[LastResult.Set], (LastResult.Connected)?" (up)":"", (LastResult.Status)?" (failed)":""));
+
+      if(LastResult.Status == HCI_ERROR_CODE_NO_ERROR)
+      {
+         Display(("   %-24s %s, %u/%u bytes, air mode %u\r\n", "Packet", AudioLink_PacketName(&LastResult), LastResult.Tx_Packet_Length, LastResult.Rx_Packet_Length, LastResult.Air_Mode));
+         Display(("   %-24s %lu.%03lu ms (interval %u, window %u slots)\r\n", "Latency", LastResult.Latency / 1000, LastResult.Latency % 1000, LastResult.Transmission_Interval, LastResult.Retransmission_Window));
+      }
+      else
+         Display(("   %-24s 0x%02X\r\n", "Status", LastResult.Status));
+
+      Display(("   %-24s %u (%lu ms)\r\n", "Attempts", LastResult.Attempts, LastResult.SetupTime));
+   }
+
+   Display(("   %-24s %lu (%lu first try, %lu fallback, %lu failed)\r\n", "Setups", AudioLinkStatistics.Setups, AudioLinkStatistics.FirstTry, AudioLinkStatistics.Fallbacks, AudioLinkStatistics.Failed));
+   Display(("   %-24s %lu\r\n", "Connection Attempts", AudioLinkStatistics.Attempts));
+   Display(("   %-24s %lu\r\n", "mSBC Fell Back To CVSD", AudioLinkStatistics.CodecFallbacks));
+   Display(("   %-24s %lu (%lu forgotten)\r\n", "Remembered Set First", AudioLinkStatistics.Remembered, AudioLinkStatistics.Forgotten));
+   Display(("   %-24s %lu (%lu restored)\r\n", "CVSD Only (Remembered)", AudioLinkStatistics.CVSDOnly, AudioLinkStatistics.Restored));
+   Display(("   %-24s %lu\r\n", "Set Up By The AG", AudioLinkStatistics.Accepted));
+}
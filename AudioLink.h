@@ -0,0 +1,179 @@
+/*****< audiolink.h >**********************************************************/
+/*                                                                            */
+/*  AudioLink - Synchronous parameter set selection of the HFP audio link.    */
+/*                                                                            */
+/*  Audio connections are requested through HFRE (HFRE_Setup_Audio_Connection */
+/*  sends AT+BCC to an AG that negotiates codecs), so the profile owns the    */
+/*  SCO connection.  The parameters of the set to try are handed to the SCO   */
+/*  layer first, HFRE sets up and accepts the connection with them.  The sets */
+/*  that the Hands-Free Profile recommends are tried the best one first:      */
+/*                                                                            */
+/*     - CVSD: S4, S3, S2, S1 (eSCO) and then D1 (SCO).                       */
+/*     - mSBC: T2 and then T1 (eSCO).                                         */
+/*                                                                            */
+/*  The set that worked is remembered per device and codec in the peer cache  */
+/*  and is the first one tried with the device from then on (a remembered set */
+/*  that fails is forgotten and the walk starts over with the best set).      */
+/*                                                                            */
+/*  If no mSBC set worked this unit offers CVSD only (AT+BAC) and goes on     */
+/*  with the CVSD sets.  The failure is remembered as well, the next setup to */
+/*  the device offers CVSD only right away.  The full codec list is offered   */
+/*  again once the CVSD connection is released (or the setup is over without  */
+/*  one), so the AG may select mSBC for the next one.  An mSBC connection to  */
+/*  the device (set up by the AG) forgets the failure again.                  */
+/*                                                                            */
+/*  The set, the packet type and the latency that the controllers negotiated  */
+/*  are recorded for each audio connection (including the ones set up by the  */
+/*  AG).  The set is the one with the tightest latency that the connection    */
+/*  satisfies.                                                                */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __AUDIOLINKH__
+#define __AUDIOLINKH__
+
+#include "SS1BTPS.h"       /* Includes for the SS1 Bluetooth Protocol Stack.  */
+
+#define AUDIO_LINK_CODEC_FAILED                   (0xFF)  /* Denotes the value */
+                                                         /* the peer cache    */
+                                                         /* holds for a codec */
+                                                         /* the device could  */
+                                                         /* not set up.       */
+
+   /* The following enumerated type represents the codecs of the audio  */
+   /* connection (the values index the peer cache).                     */
+typedef enum
+{
+   acCVSD,
+   acMSBC,
+   acNumberCodecs
+} AudioLink_Codec_t;
+
+   /* The following enumerated type represents the parameter sets of the*/
+   /* Hands-Free Profile (asNone denotes a failed audio connection).    */
+typedef enum
+{
+   asNone,
+   asD1,
+   asS1,
+   asS2,
+   asS3,
+   asS4,
+   asT1,
+   asT2,
+   asNumberSets
+} AudioLink_Set_t;
+
+   /* The following structure holds the result of the last audio        */
+   /* connection.  Status is the status of the last attempt, Attempts   */
+   /* the number of synchronous connection attempts of the setup.  The  */
+   /* link parameters are the ones negotiated, Latency is the           */
+   /* transmission interval plus the retransmission window              */
+   /* (microseconds), SetupTime the time from the first request to the  */
+   /* connection (milliseconds).                                        */
+typedef struct _tagAudioLink_Information_t
+{
+   BD_ADDR_t         BD_ADDR;
+   AudioLink_Codec_t Codec;
+   AudioLink_Set_t   Set;
+   Boolean_t         Connected;
+   Byte_t            Status;
+   unsigned int      Attempts;
+   Word_t            Connection_Handle;
+   Byte_t            Link_Type;
+   Byte_t            Transmission_Interval;
+   Byte_t            Retransmission_Window;
+   Word_t            Rx_Packet_Length;
+   Word_t            Tx_Packet_Length;
+   Byte_t            Air_Mode;
+   unsigned long     Latency;
+   unsigned long     SetupTime;
+} AudioLink_Information_t;
+
+   /* The following structure holds the statistics of the module.       */
+   /* FirstTry counts the setups that worked with the first synchronous */
+   /* connection attempt, Fallbacks the ones that needed another set    */
+   /* and CodecFallbacks the ones that went on with CVSD after mSBC     */
+   /* failed.  Remembered counts the setups that started with the set   */
+   /* remembered for the device, Forgotten the remembered sets (and     */
+   /* mSBC failures) that did not hold any more.  CVSDOnly counts the   */
+   /* setups that offered CVSD only because mSBC had failed with the    */
+   /* device before, Restored the times the full codec list was offered */
+   /* again.  Accepted counts the audio connections set up by the AG.   */
+typedef struct _tagAudioLink_Statistics_t
+{
+   unsigned long Setups;
+   unsigned long Attempts;
+   unsigned long FirstTry;
+   unsigned long Fallbacks;
+   unsigned long CodecFallbacks;
+   unsigned long Failed;
+   unsigned long Remembered;
+   unsigned long Forgotten;
+   unsigned long CVSDOnly;
+   unsigned long Restored;
+   unsigned long Accepted;
+   unsigned long Negotiated[asNumberSets];
+} AudioLink_Statistics_t;
+
+   /* The following function initializes the module for the specified   */
+   /* stack (a setup in progress is dropped, the statistics are kept).  */
+   /* This function returns zero if successful or a negative error code.*/
+int AudioLink_Initialize(unsigned int BluetoothStackID);
+
+   /* The following function stops the module.                          */
+void AudioLink_Cleanup(void);
+
+   /* The following function must be called with the HCI events         */
+   /* (Synchronous Connection Complete and disconnection).  The         */
+   /* attempts and the negotiated link are recorded from here.          */
+void AudioLink_ProcessHCIEvent(HCI_Event_Data_t *HCI_Event_Data);
+
+   /* The following function must be called with the status of the HFRE */
+   /* Audio Connection Indications of the specified device.  This       */
+   /* function returns TRUE if a failed setup goes on with the next set */
+   /* or with CVSD (the setup is not over yet).                         */
+Boolean_t AudioLink_ProcessAudioConnection(BD_ADDR_t BD_ADDR, unsigned int Status);
+
+   /* The following function must be called with the HFRE Audio         */
+   /* Disconnection Indications of the specified device.  The full      */
+   /* codec list is offered again if it was limited to CVSD.            */
+void AudioLink_ProcessAudioDisconnection(BD_ADDR_t BD_ADDR);
+
+   /* The following function must be called with the codec the AG       */
+   /* selected for the specified device (+BCS).  The codec is the one   */
+   /* of a setup in progress from then on and the set remembered for it */
+   /* is handed to the SCO layer (also for the connections the AG sets  */
+   /* up).                                                              */
+void AudioLink_ProcessCodecSelection(BD_ADDR_t BD_ADDR, AudioLink_Codec_t Codec);
+
+   /* The following function sets up an audio connection through the    */
+   /* specified HFRE port to the specified device, the codec is the one */
+   /* the AG selected last (a setup in progress is dropped).  The set   */
+   /* remembered for the device is tried first.  This function returns  */
+   /* zero if the request was sent or a negative error code.            */
+int AudioLink_Setup(BD_ADDR_t BD_ADDR, unsigned int HFREPortID, AudioLink_Codec_t Codec);
+
+   /* The following function returns TRUE while a setup to the specified*/
+   /* device is in progress.                                            */
+Boolean_t AudioLink_InProgress(BD_ADDR_t BD_ADDR);
+
+   /* The following function returns the result of the last audio       */
+   /* connection.  This function returns zero if successful or a        */
+   /* negative value if there was none.                                 */
+int AudioLink_QueryLink(AudioLink_Information_t *Information);
+
+   /* The following functions return the name of a parameter set and of */
+   /* the packet type of a negotiated audio connection.                 */
+char *AudioLink_SetName(AudioLink_Set_t Set);
+char *AudioLink_PacketName(AudioLink_Information_t *Information);
+
+   /* The following function returns the statistics.  This function     */
+   /* returns zero if successful or a negative value if the parameter is*/
+   /* invalid.                                                          */
+int AudioLink_QueryStatistics(AudioLink_Statistics_t *Statistics);
+
+   /* The following function displays the parameter sets, the last audio*/
+   /* connection and the statistics.                                    */
+void AudioLink_Display(void);
+
+#endif
@@ -0,0 +1,391 @@
+/*****< btsnoop.c >************************************************************/
+/*                                                                            */
+/*  BTSnoop - HCI traffic capture into a RAM ring in BTSnoop format.          */
+/*                                                                            */
+/******************************************************************************/
+#include <string.h>        /* Included for memcpy/memset.                     */
+#include "BTSnoop.h"       /* BTSnoop Capture Prototypes/Constants.           */
+
+   /* The following constants represent the H4 packet types (and the    */
+   /* HCILL sleep protocol bytes, which are not captured).              */
+#define H4_PACKET_TYPE_COMMAND                          0x01
+#define H4_PACKET_TYPE_ACL_DATA                         0x02
+#define H4_PACKET_TYPE_SCO_DATA                         0x03
+#define H4_PACKET_TYPE_EVENT                            0x04
+
+#define H4_MAXIMUM_HEADER_LENGTH                        4
+
+   /* The following constants represent the values of the BTSnoop file  */
+   /* header and records.  Records carry the H4 packet type (Datalink   */
+   /* HCI UART) and the timestamp is in microseconds since midnight     */
+   /* January 1st, 0 AD.                                                */
+#define BTSNOOP_VERSION                                 1
+#define BTSNOOP_DATALINK_HCI_UART                       1002
+
+#define BTSNOOP_FLAGS_RECEIVED                          0x00000001
+#define BTSNOOP_FLAGS_COMMAND_EVENT                     0x00000002
+
+#define BTSNOOP_EPOCH_DELTA                             0x00DCDDB30F2F8000ULL
+
+   /* The following constant represents the largest packet that is      */
+   /* captured (packet type, ACL header and the maximum truncation).    */
+#define MAXIMUM_CAPTURE_LENGTH                          (1 + H4_MAXIMUM_HEADER_LENGTH + BTSNOOP_MAXIMUM_TRUNCATION)
+
+   /* The following enumerated type represents the state of the H4      */
+   /* packet parser of a direction.                                     */
+typedef enum
+{
+   csPacketType,
+   csHeader,
+   csPayload
+} CaptureState_t;
+
+   /* The following structure holds the packet that is being captured in*/
+   /* a direction.  The packet is staged here until it is complete and  */
+   /* then copied into the ring as a single record.                     */
+typedef struct _tagCapture_t
+{
+   CaptureState_t     State;
+   unsigned int       HeaderLength;
+   unsigned int       Remaining;
+   unsigned int       Limit;
+   unsigned int       Included;
+   unsigned int       Original;
+   unsigned long long Timestamp;
+   unsigned char      Data[MAXIMUM_CAPTURE_LENGTH];
+} Capture_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static int                  Enabled;                /* Variable which flags whether the*/
+                                                    /* capture is enabled.             */
+
+static BTSnoop_Timestamp_t  GetTimestamp;           /* Variable which holds the        */
+                                                    /* function that returns the time. */
+
+static unsigned int         PayloadTruncation;      /* Variable which holds the number */
+                                                    /* of ACL/SCO payload bytes that   */
+                                                    /* are captured.                   */
+
+static Capture_t            CaptureList[2];         /* Variable which holds the packet */
+                                                    /* in progress of each direction.  */
+
+static unsigned char        Ring[BTSNOOP_RING_SIZE]; /* Variables which hold the       */
+static unsigned int         RingHead;               /* capture ring.  Records are added*/
+static unsigned int         RingTail;               /* at the head and drained from the*/
+static unsigned int         RingUsed;               /* tail.                           */
+
+static unsigned int         ReadRemaining;          /* Variable which holds the number */
+                                                    /* of bytes of the record at the   */
+                                                    /* tail that have not been drained */
+                                                    /* (zero at a record boundary).    */
+
+static BTSnoop_Statistics_t CaptureStatistics;      /* Variable which holds the capture*/
+                                                    /* statistics.                     */
+
+   /* Internal function prototypes.                                     */
+static void PutBigEndian32(unsigned char *Buffer, unsigned long Value);
+static void RingWrite(unsigned int Length, unsigned char *Data);
+static unsigned int RingRecordLength(void);
+static void CommitRecord(unsigned int Direction, Capture_t *Capture);
+
+   /* The following function writes a 32 bit value in big endian format.*/
+static void PutBigEndian32(unsigned char *Buffer, unsigned long Value)
+{
+   Buffer[0] = (unsigned char)(Value >> 24);
+   Buffer[1] = (unsigned char)(Value >> 16);
+   Buffer[2] = (unsigned char)(Value >> 8);
+   Buffer[3] = (unsigned char)Value;
+}
+
+   /* The following function copies data to the head of the ring.  The  */
+   /* caller must have made sure that there is enough room.             */
+static void RingWrite(unsigned int Length, unsigned char *Data)
+{
+   unsigned int Count;
+
+   while(Length)
+   {
+      Count = BTSNOOP_RING_SIZE - RingHead;
+      if(Count > Length)
+         Count = Length;
+
+      memcpy(&Ring[RingHead], Data, Count);
+
+      RingHead  = (RingHead + Count) % BTSNOOP_RING_SIZE;
+      RingUsed += Count;
+      Data     += Count;
+      Length   -= Count;
+   }
+}
+
+   /* The following function returns the total length of the record at  */
+   /* the tail of the ring (taken from its Included Length field).      */
+static unsigned int RingRecordLength(void)
+{
+   unsigned int Index;
+   unsigned int Length;
+
+   Length = 0;
+   for(Index=4;Index<8;Index++)
+      Length = (Length << 8) | Ring[(RingTail + Index) % BTSNOOP_RING_SIZE];
+
+   return(BTSNOOP_RECORD_HEADER_SIZE + Length);
+}
+
+   /* The following function adds the completed packet of a direction to*/
+   /* the ring.  If there is not enough room the oldest records are     */
+   /* discarded (unless the oldest record is partially drained, the new */
+   /* packet is dropped in that case).                                  */
+static void CommitRecord(unsigned int Direction, Capture_t *Capture)
+{
+   unsigned int  Length;
+   unsigned long Flags;
+   unsigned char Header[BTSNOOP_RECORD_HEADER_SIZE];
+
+   Length = BTSNOOP_RECORD_HEADER_SIZE + Capture->Included;
+
+   while((BTSNOOP_RING_SIZE - RingUsed < Length) && (RingUsed) && (!ReadRemaining))
+   {
+      Length    = RingRecordLength();
+      RingTail  = (RingTail + Length) % BTSNOOP_RING_SIZE;
+      RingUsed -= Length;
+      Length    = BTSNOOP_RECORD_HEADER_SIZE + Capture->Included;
+
+      CaptureStatistics.OverwrittenPackets++;
+   }
+
+   if(BTSNOOP_RING_SIZE - RingUsed >= Length)
+   {
+      Flags = (Direction == BTSNOOP_DIRECTION_RECEIVED)?BTSNOOP_FLAGS_RECEIVED:0;
+      if((Capture->Data[0] == H4_PACKET_TYPE_COMMAND) || (Capture->Data[0] == H4_PACKET_TYPE_EVENT))
+         Flags |= BTSNOOP_FLAGS_COMMAND_EVENT;
+
+      PutBigEndian32(&Header[0], Capture->Original);
+      PutBigEndian32(&Header[4], Capture->Included);
+      PutBigEndian32(&Header[8], Flags);
+      PutBigEndian32(&Header[12], CaptureStatistics.DroppedPackets + CaptureStatistics.OverwrittenPackets);
+      PutBigEndian32(&Header[16], (unsigned long)(Capture->Timestamp >> 32));
+      PutBigEndian32(&Header[20], (unsigned long)(Capture->Timestamp & 0xFFFFFFFFUL));
+
+      RingWrite(BTSNOOP_RECORD_HEADER_SIZE, Header);
+      RingWrite(Capture->Included, Capture->Data);
+
+      CaptureStatistics.Packets++;
+   }
+   else
+      CaptureStatistics.DroppedPackets++;
+}
+
+   /* The following function initializes the capture and enables it.     */
+   /* Truncation is the number of ACL/SCO payload bytes that are        */
+   /* captured of each packet (commands and events are always captured  */
+   /* completely).                                                      */
+void BTSnoop_Initialize(BTSnoop_Timestamp_t TimestampFunction, unsigned int Truncation)
+{
+   memset(&CaptureStatistics, 0, sizeof(CaptureStatistics));
+
+   GetTimestamp  = TimestampFunction;
+   RingHead      = 0;
+   RingTail      = 0;
+   RingUsed      = 0;
+   ReadRemaining = 0;
+
+   BTSnoop_SetTruncation(Truncation);
+   BTSnoop_Enable(1);
+}
+
+   /* The following function enables or disables the capture.  Any      */
+   /* packet that was in progress is discarded.                         */
+void BTSnoop_Enable(int Enable)
+{
+   CaptureList[BTSNOOP_DIRECTION_SENT].State     = csPacketType;
+   CaptureList[BTSNOOP_DIRECTION_RECEIVED].State = csPacketType;
+
+   Enabled = Enable;
+}
+
+   /* The following function changes the truncation of ACL/SCO payloads,*/
+   /* it takes effect with the next packet.                             */
+void BTSnoop_SetTruncation(unsigned int Truncation)
+{
+   PayloadTruncation = (Truncation > BTSNOOP_MAXIMUM_TRUNCATION)?BTSNOOP_MAXIMUM_TRUNCATION:Truncation;
+}
+
+   /* The following function is called by the HCI transport with the     */
+   /* sent or received H4 data.  The data may be split at any point, the*/
+   /* packet boundaries are found by following the H4 headers.  Only the*/
+   /* captured part of each packet is copied (into the staging buffer of*/
+   /* the direction), so the cost per byte of payload that is not       */
+   /* captured is just the length bookkeeping.                          */
+void BTSnoop_CaptureData(unsigned int Direction, unsigned int Length, unsigned char *Data)
+{
+   unsigned int  Count;
+   Capture_t    *Capture;
+
+   if((Enabled) && (Direction <= BTSNOOP_DIRECTION_RECEIVED) && (Data))
+   {
+      Capture = &CaptureList[Direction];
+
+      while(Length)
+      {
+         switch(Capture->State)
+         {
+            case csPacketType:
+               switch(*Data)
+               {
+                  case H4_PACKET_TYPE_COMMAND:
+                  case H4_PACKET_TYPE_SCO_DATA:
+                     Capture->HeaderLength = 3;
+                     break;
+                  case H4_PACKET_TYPE_ACL_DATA:
+                     Capture->HeaderLength = 4;
+                     break;
+                  case H4_PACKET_TYPE_EVENT:
+                     Capture->HeaderLength = 2;
+                     break;
+                  default:
+                     /* HCILL messages (and anything unrecognized) are  */
+                     /* not captured.                                   */
+                     Capture->HeaderLength = 0;
+                     break;
+               }
+
+               if(Capture->HeaderLength)
+               {
+                  Capture->Data[0]   = *Data;
+                  Capture->Included  = 1;
+                  Capture->Original  = 1;
+                  Capture->Remaining = Capture->HeaderLength;
+                  Capture->Timestamp = BTSNOOP_EPOCH_DELTA + ((GetTimestamp)?(*GetTimestamp)():0);
+                  Capture->State     = csHeader;
+
+                  /* Commands and events are captured completely, data  */
+                  /* packets up to the truncation.                      */
+                  if((*Data == H4_PACKET_TYPE_ACL_DATA) || (*Data == H4_PACKET_TYPE_SCO_DATA))
+                     Capture->Limit = 1 + Capture->HeaderLength + PayloadTruncation;
+                  else
+                     Capture->Limit = MAXIMUM_CAPTURE_LENGTH;
+               }
+
+               Data++;
+               Length--;
+               break;
+            case csHeader:
+               Capture->Data[Capture->Included++] = *Data;
+               Capture->Original++;
+
+               Data++;
+               Length--;
+
+               if(!--Capture->Remaining)
+               {
+                  /* The header is complete, the payload length is the  */
+                  /* last field of every header (16 bits for ACL data). */
+                  if(Capture->Data[0] == H4_PACKET_TYPE_ACL_DATA)
+                     Capture->Remaining = (unsigned int)Capture->Data[3] | ((unsigned int)Capture->Data[4] << 8);
+                  else
+                     Capture->Remaining = Capture->Data[Capture->HeaderLength];
+
+                  if(Capture->Remaining)
+                     Capture->State = csPayload;
+                  else
+                  {
+                     CommitRecord(Direction, Capture);
+
+                     Capture->State = csPacketType;
+                  }
+               }
+               break;
+            case csPayload:
+               Count = (Length < Capture->Remaining)?Length:Capture->Remaining;
+
+               /* Copy only what is still within the capture limit.     */
+               if(Capture->Included < Capture->Limit)
+               {
+                  if(Capture->Included + Count > Capture->Limit)
+                     memcpy(&(Capture->Data[Capture->Included]), Data, Capture->Limit - Capture->Included);
+                  else
+                     memcpy(&(Capture->Data[Capture->Included]), Data, Count);
+
+                  Capture->Included = (Capture->Included + Count > Capture->Limit)?Capture->Limit:(Capture->Included + Count);
+               }
+
+               Capture->Original  += Count;
+               Capture->Remaining -= Count;
+               Data               += Count;
+               Length             -= Count;
+
+               if(!Capture->Remaining)
+               {
+                  CommitRecord(Direction, Capture);
+
+                  Capture->State = csPacketType;
+               }
+               break;
+         }
+      }
+   }
+}
+
+   /* The following function writes the BTSnoop file header (of          */
+   /* BTSNOOP_FILE_HEADER_SIZE bytes) to the specified buffer.          */
+void BTSnoop_ReadFileHeader(unsigned char *Buffer)
+{
+   if(Buffer)
+   {
+      memcpy(Buffer, "btsnoop", 8);
+
+      PutBigEndian32(&Buffer[8], BTSNOOP_VERSION);
+      PutBigEndian32(&Buffer[12], BTSNOOP_DATALINK_HCI_UART);
+   }
+}
+
+   /* The following function drains up to BufferLength bytes of captured*/
+   /* records from the ring.  Records may be split across calls.  This  */
+   /* function returns the number of bytes that were copied.            */
+unsigned int BTSnoop_Read(unsigned int BufferLength, unsigned char *Buffer)
+{
+   unsigned int ret_val;
+   unsigned int Count;
+
+   ret_val = 0;
+
+   while((Buffer) && (ret_val < BufferLength) && (RingUsed))
+   {
+      if(!ReadRemaining)
+         ReadRemaining = RingRecordLength();
+
+      /* Copy up to the end of the record, the end of the ring or the   */
+      /* end of the caller's buffer (whichever comes first).            */
+      Count = ReadRemaining;
+      if(Count > BTSNOOP_RING_SIZE - RingTail)
+         Count = BTSNOOP_RING_SIZE - RingTail;
+      if(Count > BufferLength - ret_val)
+         Count = BufferLength - ret_val;
+
+      memcpy(&Buffer[ret_val], &Ring[RingTail], Count);
+
+      RingTail       = (RingTail + Count) % BTSNOOP_RING_SIZE;
+      RingUsed      -= Count;
+      ReadRemaining -= Count;
+      ret_val       += Count;
+   }
+
+   CaptureStatistics.BytesDrained += ret_val;
+
+   return(ret_val);
+}
+
+   /* The following function returns the capture statistics.             */
+void BTSnoop_QueryStatistics(BTSnoop_Statistics_t *Statistics)
+{
+   if(Statistics)
+   {
+      *Statistics             = CaptureStatistics;
+      Statistics->BytesQueued = RingUsed;
+      Statistics->Truncation  = PayloadTruncation;
+   }
+}
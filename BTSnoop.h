@@ -0,0 +1,106 @@
+/*****< btsnoop.h >************************************************************/
+/*                                                                            */
+/*  BTSnoop - HCI traffic capture into a RAM ring in BTSnoop format.          */
+/*                                                                            */
+/*  The HCI transport feeds the sent and received H4 byte streams to this     */
+/*  module, complete packets are timestamped and appended to the ring as      */
+/*  BTSnoop records (ACL and SCO payloads truncated to a configurable         */
+/*  length).  The ring is drained with BTSnoop_Read() (console, GATT or a     */
+/*  file on the host, see Linux/BTSnoopFile.c and the -S option of            */
+/*  HCIReplay).  Prefixed with the data of BTSnoop_ReadFileHeader(), the      */
+/*  drained data is a valid BTSnoop file (Wireshark, Frontline).              */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __BTSNOOPH__
+#define __BTSNOOPH__
+
+#ifndef BTSNOOP_RING_SIZE
+
+#define BTSNOOP_RING_SIZE                          (512)  /* Denotes the size  */
+                                                         /* (in bytes) of the */
+                                                         /* capture ring.     */
+
+#endif
+
+#ifndef BTSNOOP_DEFAULT_TRUNCATION
+
+#define BTSNOOP_DEFAULT_TRUNCATION                  (16)  /* Denotes the number*/
+                                                         /* of ACL/SCO payload*/
+                                                         /* bytes that are    */
+                                                         /* captured by       */
+                                                         /* default (enough   */
+                                                         /* for the L2CAP and */
+                                                         /* RFCOMM/ATT        */
+                                                         /* headers).         */
+
+#endif
+
+#define BTSNOOP_MAXIMUM_TRUNCATION                 (255)  /* Denotes the       */
+                                                         /* largest payload   */
+                                                         /* that is captured  */
+                                                         /* of ACL/SCO data.  */
+
+#define BTSNOOP_FILE_HEADER_SIZE                    (16)  /* Denotes the size  */
+                                                         /* of the BTSnoop    */
+                                                         /* file header.      */
+
+#define BTSNOOP_RECORD_HEADER_SIZE                  (24)  /* Denotes the size  */
+                                                         /* of the header of  */
+                                                         /* each BTSnoop      */
+                                                         /* record.           */
+
+   /* The following constants represent the direction of a packet.       */
+#define BTSNOOP_DIRECTION_SENT                       (0)
+#define BTSNOOP_DIRECTION_RECEIVED                   (1)
+
+   /* The following type definition represents the function that returns*/
+   /* the current time in microseconds since January 1st 1970 (or since */
+   /* boot when the real time is not known, the capture then starts at  */
+   /* 1970).                                                            */
+typedef unsigned long long (*BTSnoop_Timestamp_t)(void);
+
+   /* The following structure holds the capture statistics.  Dropped     */
+   /* Packets is the number of packets that were not captured because   */
+   /* the ring was full and Overwritten Packets the number of captured  */
+   /* packets that were discarded (oldest first) to make room.          */
+typedef struct _tagBTSnoop_Statistics_t
+{
+   unsigned long Packets;
+   unsigned long DroppedPackets;
+   unsigned long OverwrittenPackets;
+   unsigned long BytesDrained;
+   unsigned int  BytesQueued;
+   unsigned int  Truncation;
+} BTSnoop_Statistics_t;
+
+   /* The following function initializes the capture and enables it.     */
+   /* Truncation is the number of ACL/SCO payload bytes that are        */
+   /* captured of each packet (commands and events are always captured  */
+   /* completely).                                                      */
+void BTSnoop_Initialize(BTSnoop_Timestamp_t TimestampFunction, unsigned int Truncation);
+
+   /* The following functions enable or disable the capture and change   */
+   /* the truncation of ACL/SCO payloads.                               */
+void BTSnoop_Enable(int Enable);
+void BTSnoop_SetTruncation(unsigned int Truncation);
+
+   /* The following function is called by the HCI transport with the     */
+   /* sent or received H4 data.  The data may be split at any point, the*/
+   /* packet boundaries are found by following the H4 headers.  The     */
+   /* transport calls this function for each direction from a single    */
+   /* context (never from an interrupt handler).                        */
+void BTSnoop_CaptureData(unsigned int Direction, unsigned int Length, unsigned char *Data);
+
+   /* The following function writes the BTSnoop file header (of          */
+   /* BTSNOOP_FILE_HEADER_SIZE bytes) to the specified buffer.          */
+void BTSnoop_ReadFileHeader(unsigned char *Buffer);
+
+   /* The following function drains up to BufferLength bytes of captured*/
+   /* records from the ring.  Records may be split across calls.  This  */
+   /* function returns the number of bytes that were copied.            */
+unsigned int BTSnoop_Read(unsigned int BufferLength, unsigned char *Buffer);
+
+   /* The following function returns the capture statistics.             */
+void BTSnoop_QueryStatistics(BTSnoop_Statistics_t *Statistics);
+
+#endif
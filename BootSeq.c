@@ -0,0 +1,125 @@
+/*****< bootseq.c >************************************************************/
+/*                                                                            */
+/*  BootSeq - Boot phase timing and fast controller bring-up settings.        */
+/*                                                                            */
+/******************************************************************************/
+#include "Main.h"          /* Application Interface Abstraction.              */
+#include "BootSeq.h"       /* Boot Sequence Prototypes/Constants.             */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static BootSeqPhase_t PhaseList[BOOT_SEQ_MAX_PHASES]; /* Variable which holds the     */
+                                                    /* phases that were recorded.      */
+
+static unsigned int   NumberPhases;                 /* Variable which holds the number */
+                                                    /* of valid entries in the Phase   */
+                                                    /* List.                           */
+
+static unsigned long  StartTime;                    /* Variable which holds the tick   */
+                                                    /* count at the start of the boot. */
+
+static unsigned long  LastMarkTime;                 /* Variable which holds the tick   */
+                                                    /* count at the last phase mark.   */
+
+static unsigned long  TimeToConnectable;            /* Variable which holds the time   */
+                                                    /* until the device became         */
+                                                    /* connectable (zero if not yet).  */
+
+   /* The following function starts a new boot sequence, any phases that*/
+   /* were previously recorded are discarded.  This function must be    */
+   /* called after BTPS_Init() (the tick count is used for timing).     */
+void BootSeq_Start(void)
+{
+   NumberPhases      = 0;
+   TimeToConnectable = 0;
+   StartTime         = BTPS_GetTickCount();
+   LastMarkTime      = StartTime;
+}
+
+   /* The following function marks the end of the current boot phase.   */
+   /* The phase is timed from the previous mark (or the start of the    */
+   /* sequence).  If Budget is non-zero and the phase took longer the   */
+   /* phase is flagged as a regression when displayed.                  */
+void BootSeq_MarkPhase(char *PhaseName, unsigned long Budget)
+{
+   unsigned long CurrentTime = BTPS_GetTickCount();
+
+   if((PhaseName) && (NumberPhases < BOOT_SEQ_MAX_PHASES))
+   {
+      PhaseList[NumberPhases].PhaseName = PhaseName;
+      PhaseList[NumberPhases].Duration  = CurrentTime - LastMarkTime;
+      PhaseList[NumberPhases].Budget    = Budget;
+
+      NumberPhases++;
+   }
+
+   LastMarkTime = CurrentTime;
+}
+
+   /* The following function records that the device has become         */
+   /* connectable.  The time to connectable is measured from the start  */
+   /* of the sequence and checked against BOOT_SEQ_CONNECTABLE_BUDGET.  */
+void BootSeq_MarkConnectable(void)
+{
+   /* Note that a time of zero is reported as one millisecond so that it*/
+   /* is not mistaken for "not yet connectable".                        */
+   if(!TimeToConnectable)
+   {
+      TimeToConnectable = BTPS_GetTickCount() - StartTime;
+      if(!TimeToConnectable)
+         TimeToConnectable = 1;
+   }
+}
+
+   /* The following function returns the time (in ms) from the start of */
+   /* the boot sequence until the device became connectable, or zero if */
+   /* it has not yet become connectable.                                */
+unsigned long BootSeq_QueryTimeToConnectable(void)
+{
+   return(TimeToConnectable);
+}
+
+   /* The following function displays the recorded phases, the total    */
+   /* boot time and the time to connectable.  Phases that exceeded their*/
+   /* budget are flagged.  This function returns the number of phases   */
+   /* (including time to connectable) that exceeded their budget.       */
+int BootSeq_Display(void)
+{
+   int          ret_val = 0;
+   unsigned int Index;
+
+   Display(("Boot Phases:\r\n"));
+
+   for(Index=0;Index<NumberPhases;Index++)
+   {
+      if((PhaseList[Index].Budget) && (PhaseList[Index].Duration > PhaseList[Index].Budget))
+      {
+         Display(("   %-20s %5lu ms (budget %lu ms) REGRESSION\r\n", PhaseList[Index].PhaseName, PhaseList[Index].Duration, PhaseList[Index].Budget));
+
+         ret_val++;
+      }
+      else
+         Display(("   %-20s %5lu ms\r\n", PhaseList[Index].PhaseName, PhaseList[Index].Duration));
+   }
+
+   Display(("   %-20s %5lu ms\r\n", "Total", (LastMarkTime - StartTime)));
+
+   if(TimeToConnectable)
+   {
+      if(TimeToConnectable > BOOT_SEQ_CONNECTABLE_BUDGET)
+      {
+         Display(("   %-20s %5lu ms (budget %u ms) REGRESSION\r\n", "Time To Connectable", TimeToConnectable, BOOT_SEQ_CONNECTABLE_BUDGET));
+
+         ret_val++;
+      }
+      else
+         Display(("   %-20s %5lu ms\r\n", "Time To Connectable", TimeToConnectable));
+   }
+   else
+      Display(("   Not connectable.\r\n"));
+
+   return(ret_val);
+}
@@ -0,0 +1,107 @@
+/*****< bootseq.h >************************************************************/
+/*                                                                            */
+/*  BootSeq - Boot phase timing and fast controller bring-up settings.        */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __BOOTSEQH__
+#define __BOOTSEQH__
+
+#include "SS1BTPS.h"       /* Includes for the SS1 Bluetooth Protocol Stack.  */
+
+#ifndef BOOT_SEQ_HCI_BAUD_RATE
+
+#define BOOT_SEQ_HCI_BAUD_RATE                   (4000000L)  /* Denotes the HCI */
+                                                         /* UART baud rate.   */
+                                                         /* The CC256x vendor */
+                                                         /* initialization    */
+                                                         /* switches the      */
+                                                         /* controller and the*/
+                                                         /* local UART to this*/
+                                                         /* rate before the   */
+                                                         /* Service Pack is   */
+                                                         /* downloaded, 4 Mbps*/
+                                                         /* is the maximum the*/
+                                                         /* CC256x supports.  */
+
+#endif
+
+#ifndef BOOT_SEQ_INITIALIZATION_DELAY
+
+#define BOOT_SEQ_INITIALIZATION_DELAY                (0)  /* Denotes the delay */
+                                                         /* (in ms) between   */
+                                                         /* releasing the     */
+                                                         /* controller from   */
+                                                         /* reset and the     */
+                                                         /* first HCI command.*/
+                                                         /* No fixed wait is  */
+                                                         /* needed, the HCI   */
+                                                         /* UART runs with    */
+                                                         /* RTS/CTS flow      */
+                                                         /* control and the   */
+                                                         /* CC256x keeps its  */
+                                                         /* RTS deasserted    */
+                                                         /* until it is ready */
+                                                         /* to receive, so the*/
+                                                         /* first command is  */
+                                                         /* held in the UART. */
+
+#endif
+
+#define BOOT_SEQ_MAX_PHASES                         (12)  /* Denotes the max   */
+                                                         /* number of phases  */
+                                                         /* that are recorded.*/
+
+#define BOOT_SEQ_CONTROLLER_BUDGET                 (500)  /* Denotes the time  */
+                                                         /* (in ms) the       */
+                                                         /* controller        */
+                                                         /* initialization    */
+                                                         /* (including the    */
+                                                         /* Service Pack      */
+                                                         /* download) is      */
+                                                         /* expected to take. */
+
+#define BOOT_SEQ_CONNECTABLE_BUDGET                (750)  /* Denotes the time  */
+                                                         /* (in ms) from the  */
+                                                         /* start of the boot */
+                                                         /* that the device   */
+                                                         /* is expected to be */
+                                                         /* connectable by.   */
+
+   /* The following structure holds the timing of a single boot phase.  */
+   /* All times are specified in milliseconds.  A Budget of zero means  */
+   /* the phase is not checked for regressions.                         */
+typedef struct _tagBootSeqPhase_t
+{
+   char          *PhaseName;
+   unsigned long  Duration;
+   unsigned long  Budget;
+} BootSeqPhase_t;
+
+   /* The following function starts a new boot sequence, any phases that*/
+   /* were previously recorded are discarded.  This function must be    */
+   /* called after BTPS_Init() (the tick count is used for timing).     */
+void BootSeq_Start(void);
+
+   /* The following function marks the end of the current boot phase.   */
+   /* The phase is timed from the previous mark (or the start of the    */
+   /* sequence).  If Budget is non-zero and the phase took longer the   */
+   /* phase is flagged as a regression when displayed.                  */
+void BootSeq_MarkPhase(char *PhaseName, unsigned long Budget);
+
+   /* The following function records that the device has become         */
+   /* connectable.  The time to connectable is measured from the start  */
+   /* of the sequence and checked against BOOT_SEQ_CONNECTABLE_BUDGET.  */
+void BootSeq_MarkConnectable(void);
+
+   /* The following function returns the time (in ms) from the start of */
+   /* the boot sequence until the device became connectable, or zero if */
+   /* it has not yet become connectable.                                */
+unsigned long BootSeq_QueryTimeToConnectable(void);
+
+   /* The following function displays the recorded phases, the total    */
+   /* boot time and the time to connectable.  Phases that exceeded their*/
+   /* budget are flagged.  This function returns the number of phases   */
+   /* (including time to connectable) that exceeded their budget.       */
+int BootSeq_Display(void);
+
+#endif
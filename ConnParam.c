@@ -0,0 +1,518 @@
+/*****< connparam.c >**********************************************************/
+/*                                                                            */
+/*  ConnParam - Connection parameter policy of the LE links (slave role).    */
+/*                                                                            */
+/******************************************************************************/
+#include "Main.h"          /* Application Interface Abstraction.              */
+#include "ConnParam.h"     /* Connection Parameter Policy Prototypes.         */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+
+   /* The following type definition represents the container type which */
+   /* holds the state of a link.  WindowStart and WindowRequests count  */
+   /* the GATT requests of the current burst window, Gap is the time    */
+   /* that must pass before the next request (it grows with each        */
+   /* rejection).  Applying is set from the acceptance of a request     */
+   /* until the central applied the parameters.                         */
+typedef struct _tagLink_t
+{
+   Boolean_t                    InUse;
+   ConnParam_Link_Information_t Information;
+   unsigned long                ConnectTime;
+   unsigned long                LastActivity;
+   unsigned long                WindowStart;
+   unsigned int                 WindowRequests;
+   Boolean_t                    Backlog;
+   Boolean_t                    Deferred;
+   Boolean_t                    Requested;
+   Boolean_t                    Applying;
+   ConnParam_Profile_t          RequestedProfile;
+   unsigned long                RequestTime;
+   unsigned long                Gap;
+   unsigned int                 ConsecutiveRejections[cpNumberProfiles];
+   unsigned long                ProfileStart;
+} Link_t;
+
+   /* The following type definition represents the container type which */
+   /* holds the parameters of a profile (in the units of the update     */
+   /* request).                                                         */
+typedef struct _tagProfile_Parameters_t
+{
+   Word_t Interval_Min;
+   Word_t Interval_Max;
+   Word_t Slave_Latency;
+   Word_t Supervision_Timeout;
+} Profile_Parameters_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static unsigned int           ConnParamStackID;     /* Variable which holds the*/
+                                                    /* stack the links are     */
+                                                    /* managed on (zero if     */
+                                                    /* they are not managed).  */
+
+static Link_t                 Links[CONN_PARAM_MAXIMUM_LINKS]; /* Variable which*/
+                                                    /* holds the tracked links.*/
+
+static ConnParam_Statistics_t ConnParamStatistics;  /* Variable which holds the*/
+                                                    /* statistics.             */
+
+static const Profile_Parameters_t ProfileParameters[cpNumberProfiles] =
+{
+   { CONN_PARAM_BURST_INTERVAL_MIN, CONN_PARAM_BURST_INTERVAL_MAX, CONN_PARAM_BURST_SLAVE_LATENCY, CONN_PARAM_BURST_SUPERVISION_TIMEOUT },
+   { CONN_PARAM_IDLE_INTERVAL_MIN,  CONN_PARAM_IDLE_INTERVAL_MAX,  CONN_PARAM_IDLE_SLAVE_LATENCY,  CONN_PARAM_IDLE_SUPERVISION_TIMEOUT  }
+};
+
+static char *ProfileNames[cpNumberProfiles] = { "Burst", "Idle" };
+
+   /* Internal function prototypes.                                     */
+static Link_t *FindLink(BD_ADDR_t BD_ADDR);
+static void AccountTime(Link_t *Link, unsigned long Now);
+static Boolean_t Satisfies(Link_t *Link, ConnParam_Profile_t Profile);
+static ConnParam_Profile_t ClassifyParameters(Link_t *Link);
+static void RequestProfile(Link_t *Link, ConnParam_Profile_t Profile, unsigned long Now);
+static void CompleteRequest(Link_t *Link, Boolean_t Accepted);
+
+   /* The following function returns the tracked link to the specified  */
+   /* device (NULL if the link is not tracked).                         */
+static Link_t *FindLink(BD_ADDR_t BD_ADDR)
+{
+   unsigned int  Index;
+   Link_t       *ret_val = NULL;
+
+   for(Index=0;(Index<CONN_PARAM_MAXIMUM_LINKS) && (!ret_val);Index++)
+   {
+      if((Links[Index].InUse) && (COMPARE_BD_ADDR(Links[Index].Information.BD_ADDR, BD_ADDR)))
+         ret_val = &Links[Index];
+   }
+
+   return(ret_val);
+}
+
+   /* The following function adds the time since the last call to the   */
+   /* profile the link is in.                                           */
+static void AccountTime(Link_t *Link, unsigned long Now)
+{
+   Link->Information.ProfileTime[Link->Information.Profile] += Now - Link->ProfileStart;
+   Link->ProfileStart                                        = Now;
+}
+
+   /* The following function returns TRUE if the applied parameters of   */
+   /* the link serve the specified profile.  A burst needs a short      */
+   /* interval without latency, a link is idle enough once the slave    */
+   /* may sleep as long as the idle interval.                           */
+static Boolean_t Satisfies(Link_t *Link, ConnParam_Profile_t Profile)
+{
+   Boolean_t ret_val;
+
+   if(Profile == cpBurst)
+      ret_val = (Boolean_t)((Link->Information.Connection_Interval <= CONN_PARAM_BURST_INTERVAL_MAX) && (Link->Information.Slave_Latency <= CONN_PARAM_BURST_SLAVE_LATENCY));
+   else
+      ret_val = (Boolean_t)(((unsigned long)Link->Information.Connection_Interval * (unsigned long)(Link->Information.Slave_Latency + 1)) >= CONN_PARAM_IDLE_INTERVAL_MIN);
+
+   return(ret_val);
+}
+
+   /* The following function returns the profile the applied parameters */
+   /* of the link fall into.                                            */
+static ConnParam_Profile_t ClassifyParameters(Link_t *Link)
+{
+   return(Satisfies(Link, cpBurst)?cpBurst:cpIdle);
+}
+
+   /* The following function asks the central for the parameters of the */
+   /* specified profile.  A request that could not be sent is retried   */
+   /* after the gap as well.                                            */
+static void RequestProfile(Link_t *Link, ConnParam_Profile_t Profile, unsigned long Now)
+{
+   int Result;
+
+   Result = L2CA_Connection_Parameter_Update_Request(ConnParamStackID, Link->Information.BD_ADDR, ProfileParameters[Profile].Interval_Min, ProfileParameters[Profile].Interval_Max, ProfileParameters[Profile].Slave_Latency, ProfileParameters[Profile].Supervision_Timeout);
+
+   Link->Requested   = TRUE;
+   Link->RequestTime = Now;
+   Link->Deferred    = FALSE;
+
+   if(!Result)
+   {
+      Link->Information.Pending = TRUE;
+      Link->RequestedProfile    = Profile;
+
+      Link->Information.Requests++;
+      ConnParamStatistics.Requests++;
+   }
+   else
+      ConnParamStatistics.Failures++;
+}
+
+   /* The following function ends the outstanding request of a link.     */
+   /* A rejection (or no answer) doubles the gap to the next request and */
+   /* gives up the profile after too many in a row.                     */
+static void CompleteRequest(Link_t *Link, Boolean_t Accepted)
+{
+   Link->Information.Pending = FALSE;
+
+   if(Accepted)
+   {
+      ConnParamStatistics.Accepted++;
+
+      Link->Applying                                      = TRUE;
+      Link->ConsecutiveRejections[Link->RequestedProfile] = 0;
+      Link->Gap                                           = CONN_PARAM_UPDATE_GAP_MS;
+   }
+   else
+   {
+      Link->Information.Rejections++;
+
+      if(++Link->ConsecutiveRejections[Link->RequestedProfile] == CONN_PARAM_MAXIMUM_REJECTIONS)
+         ConnParamStatistics.GivenUp++;
+
+      if((Link->Gap *= 2) > CONN_PARAM_MAXIMUM_GAP_MS)
+         Link->Gap = CONN_PARAM_MAXIMUM_GAP_MS;
+   }
+}
+
+   /* The following function starts the management of the connection   */
+   /* parameters of the LE links of the specified stack (the links that */
+   /* are tracked are dropped, the statistics are kept).  This function */
+   /* returns zero if successful or a negative error code.              */
+int ConnParam_Initialize(unsigned int BluetoothStackID)
+{
+   int ret_val;
+
+   if(BluetoothStackID)
+   {
+      BTPS_MemInitialize(Links, 0, sizeof(Links));
+
+      ConnParamStackID          = BluetoothStackID;
+      ConnParamStatistics.Links = 0;
+
+      ret_val                   = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function stops the management of the connection    */
+   /* parameters.                                                       */
+void ConnParam_Cleanup(void)
+{
+   BTPS_MemInitialize(Links, 0, sizeof(Links));
+
+   ConnParamStackID          = 0;
+   ConnParamStatistics.Links = 0;
+}
+
+   /* The following function must be called with the GAP LE events of   */
+   /* the links (connection, disconnection, parameter updates and the   */
+   /* answers to the update requests).                                  */
+void ConnParam_ProcessGAPLEEvent(GAP_LE_Event_Data_t *GAP_LE_Event_Data)
+{
+   unsigned int                                      Index;
+   unsigned long                                     Now;
+   Link_t                                           *Link;
+   GAP_LE_Connection_Complete_Event_Data_t          *ConnectionData;
+   GAP_LE_Connection_Parameter_Updated_Event_Data_t *UpdatedData;
+
+   if((ConnParamStackID) && (GAP_LE_Event_Data) && (GAP_LE_Event_Data->Event_Data.GAP_LE_Connection_Complete_Event_Data))
+   {
+      Now = BTPS_GetTickCount();
+
+      switch(GAP_LE_Event_Data->Event_Data_Type)
+      {
+         case etLE_Connection_Complete:
+            /* Only the slave asks for parameters, the master sets them. */
+            ConnectionData = GAP_LE_Event_Data->Event_Data.GAP_LE_Connection_Complete_Event_Data;
+
+            if((!ConnectionData->Status) && (!ConnectionData->Master) && (!FindLink(ConnectionData->Peer_Address)))
+            {
+               for(Index=0;(Index<CONN_PARAM_MAXIMUM_LINKS) && (Links[Index].InUse);Index++)
+                  ;
+
+               if(Index < CONN_PARAM_MAXIMUM_LINKS)
+               {
+                  Link = &Links[Index];
+
+                  BTPS_MemInitialize(Link, 0, sizeof(Link_t));
+
+                  Link->InUse                           = TRUE;
+                  Link->Information.BD_ADDR             = ConnectionData->Peer_Address;
+                  Link->Information.Connection_Interval = ConnectionData->Connection_Interval;
+                  Link->Information.Slave_Latency       = ConnectionData->Slave_Latency;
+                  Link->Information.Supervision_Timeout = ConnectionData->Supervision_Timeout;
+                  Link->Information.Profile             = ClassifyParameters(Link);
+                  Link->Information.Wanted              = cpBurst;
+                  Link->ConnectTime                     = Now;
+                  Link->LastActivity                    = Now;
+                  Link->WindowStart                     = Now;
+                  Link->ProfileStart                    = Now;
+                  Link->Gap                             = CONN_PARAM_UPDATE_GAP_MS;
+
+                  ConnParamStatistics.Links++;
+               }
+            }
+            break;
+         case etLE_Disconnection_Complete:
+            if((Link = FindLink(GAP_LE_Event_Data->Event_Data.GAP_LE_Disconnection_Complete_Event_Data->BD_ADDR)) != NULL)
+            {
+               Link->InUse = FALSE;
+
+               ConnParamStatistics.Links--;
+            }
+            break;
+         case etLE_Connection_Parameter_Updated:
+            UpdatedData = GAP_LE_Event_Data->Event_Data.GAP_LE_Connection_Parameter_Updated_Event_Data;
+
+            if((!UpdatedData->Status) && ((Link = FindLink(UpdatedData->BD_ADDR)) != NULL))
+            {
+               AccountTime(Link, Now);
+
+               Link->Information.Connection_Interval = UpdatedData->Connection_Interval;
+               Link->Information.Slave_Latency       = UpdatedData->Slave_Latency;
+               Link->Information.Supervision_Timeout = UpdatedData->Supervision_Timeout;
+               Link->Information.Profile             = ClassifyParameters(Link);
+               Link->Applying                        = FALSE;
+
+               Link->Information.Updates++;
+               ConnParamStatistics.Updates++;
+            }
+            break;
+         case etLE_Connection_Parameter_Update_Response:
+            if(((Link = FindLink(GAP_LE_Event_Data->Event_Data.GAP_LE_Connection_Parameter_Update_Response_Event_Data->BD_ADDR)) != NULL) && (Link->Information.Pending))
+            {
+               if(GAP_LE_Event_Data->Event_Data.GAP_LE_Connection_Parameter_Update_Response_Event_Data->Accepted)
+                  CompleteRequest(Link, TRUE);
+               else
+               {
+                  ConnParamStatistics.Rejected++;
+
+                  CompleteRequest(Link, FALSE);
+               }
+            }
+            break;
+         default:
+            break;
+      }
+   }
+}
+
+   /* The following function must be called with the GATT connection    */
+   /* events (the discovery starts at the GATT connection, a drained    */
+   /* buffer ends a notification backlog).                              */
+void ConnParam_ProcessGATTConnectionEvent(GATT_Connection_Event_Data_t *GATT_Connection_Event_Data)
+{
+   Link_t *Link;
+
+   if((ConnParamStackID) && (GATT_Connection_Event_Data) && (GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_Data))
+   {
+      switch(GATT_Connection_Event_Data->Event_Data_Type)
+      {
+         case etGATT_Connection_Device_Connection:
+            if((Link = FindLink(GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_Data->RemoteDevice)) != NULL)
+            {
+               Link->ConnectTime  = BTPS_GetTickCount();
+               Link->LastActivity = Link->ConnectTime;
+            }
+            break;
+         case etGATT_Connection_Device_Buffer_Empty:
+            if((Link = FindLink(GATT_Connection_Event_Data->Event_Data.GATT_Device_Buffer_Empty_Data->RemoteDevice)) != NULL)
+            {
+               /* The backlog counts as activity, the idle time starts  */
+               /* once it is drained.                                   */
+               if(Link->Backlog)
+                  Link->LastActivity = BTPS_GetTickCount();
+
+               Link->Backlog = FALSE;
+            }
+            break;
+         default:
+            break;
+      }
+   }
+}
+
+   /* The following function notes a GATT request of the specified      */
+   /* device.                                                           */
+void ConnParam_NoteActivity(BD_ADDR_t BD_ADDR)
+{
+   unsigned long  Now;
+   Link_t        *Link;
+
+   if((ConnParamStackID) && ((Link = FindLink(BD_ADDR)) != NULL))
+   {
+      Now = BTPS_GetTickCount();
+
+      if((Now - Link->WindowStart) >= CONN_PARAM_BURST_WINDOW_MS)
+      {
+         Link->WindowStart    = Now;
+         Link->WindowRequests = 0;
+      }
+
+      /* A single request is served at whatever interval is in use, a  */
+      /* burst of them is worth shorter intervals.                     */
+      if(++Link->WindowRequests >= CONN_PARAM_BURST_REQUESTS)
+         Link->Information.Wanted = cpBurst;
+
+      Link->LastActivity = Now;
+   }
+}
+
+   /* The following function notes that a notification or indication    */
+   /* for the specified device could not be queued, the link stays in   */
+   /* the burst profile until the buffer of the link is drained.        */
+void ConnParam_NoteBacklog(BD_ADDR_t BD_ADDR)
+{
+   Link_t *Link;
+
+   if((ConnParamStackID) && ((Link = FindLink(BD_ADDR)) != NULL))
+   {
+      Link->Backlog            = TRUE;
+      Link->Information.Wanted = cpBurst;
+
+      ConnParamStatistics.Backlogs++;
+   }
+}
+
+   /* The following function must be called periodically from the main  */
+   /* loop.  It re-evaluates the wanted profile of each link and issues */
+   /* the update requests the throttle allows.                          */
+void ConnParam_Process(void)
+{
+   unsigned int         Index;
+   unsigned long        Now;
+   Link_t              *Link;
+   ConnParam_Profile_t  Wanted;
+
+   if(ConnParamStackID)
+   {
+      Now = BTPS_GetTickCount();
+
+      for(Index=0;Index<CONN_PARAM_MAXIMUM_LINKS;Index++)
+      {
+         Link = &Links[Index];
+
+         if(!Link->InUse)
+            continue;
+
+         /* A central that does not answer counts as a rejection.       */
+         if((Link->Information.Pending) && ((Now - Link->RequestTime) >= CONN_PARAM_RESPONSE_TIMEOUT_MS))
+         {
+            ConnParamStatistics.Timeouts++;
+
+            CompleteRequest(Link, FALSE);
+         }
+
+         /* A central that accepted but never applied the parameters may */
+         /* be asked again.                                             */
+         if((Link->Applying) && ((Now - Link->RequestTime) >= CONN_PARAM_RESPONSE_TIMEOUT_MS))
+            Link->Applying = FALSE;
+
+         /* Discovery and a backlog keep the link busy, it is relaxed  */
+         /* once it was quiet long enough (in between it keeps the     */
+         /* profile it wants).                                         */
+         if((Link->Backlog) || ((Now - Link->ConnectTime) < CONN_PARAM_DISCOVERY_MS))
+            Link->Information.Wanted = cpBurst;
+         else
+         {
+            if((Now - Link->LastActivity) >= CONN_PARAM_IDLE_MS)
+               Link->Information.Wanted = cpIdle;
+         }
+
+         Wanted = Link->Information.Wanted;
+
+         if(Satisfies(Link, Wanted))
+            Link->Deferred = FALSE;
+         else
+         {
+            if((!Link->Information.Pending) && (!Link->Applying) && (Link->ConsecutiveRejections[Wanted] < CONN_PARAM_MAXIMUM_REJECTIONS))
+            {
+               if((!Link->Requested) || ((Now - Link->RequestTime) >= Link->Gap))
+                  RequestProfile(Link, Wanted, Now);
+               else
+               {
+                  if(!Link->Deferred)
+                  {
+                     Link->Deferred = TRUE;
+
+                     ConnParamStatistics.Deferred++;
+                  }
+               }
+            }
+         }
+      }
+   }
+}
+
+   /* The following function returns the state of the link to the       */
+   /* specified device.  This function returns zero if successful or a */
+   /* negative value if the link is not tracked.                        */
+int ConnParam_QueryLink(BD_ADDR_t BD_ADDR, ConnParam_Link_Information_t *Information)
+{
+   int     ret_val;
+   Link_t *Link;
+
+   if((Information) && ((Link = FindLink(BD_ADDR)) != NULL))
+   {
+      AccountTime(Link, BTPS_GetTickCount());
+
+      *Information = Link->Information;
+      ret_val      = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function returns the statistics of all links.  This */
+   /* function returns zero if successful or a negative value if the    */
+   /* parameter is invalid.                                             */
+int ConnParam_QueryStatistics(ConnParam_Statistics_t *Statistics)
+{
+   int ret_val;
+
+   if(Statistics)
+   {
+      *Statistics = ConnParamStatistics;
+      ret_val     = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function displays the links with their applied      */
+   /* parameters and the statistics.                                    */
+void ConnParam_Display(void)
+{
+   unsigned int  Index;
+   Link_t       *Link;
+
+   Display(("   %-17s %-5s %-5s %8s %3s %7s %4s %4s %4s %8s %8s\r\n", "Link", "Now", "Wants", "Interval", "Lat", "Timeout", "Req", "Rej", "Upd", "Burst s", "Idle s"));
+
+   for(Index=0;Index<CONN_PARAM_MAXIMUM_LINKS;Index++)
+   {
+      Link = &Links[Index];
+
+      if(!Link->InUse)
+         continue;
+
+      AccountTime(Link, BTPS_GetTickCount());
+
+      Display(("   %02X:%02X:%02X:%02X:%02X:%02X %-5s %-5s", Link->Information.BD_ADDR.BD_ADDR5, Link->Information.BD_ADDR.BD_ADDR4, Link->Information.BD_ADDR.BD_ADDR3, Link->Information.BD_ADDR.BD_ADDR2, Link->Information.BD_ADDR.BD_ADDR1, Link->Information.BD_ADDR.BD_ADDR0, ProfileNames[Link->Information.Profile], ProfileNames[Link->Information.Wanted]));
+
+      /* The interval is in 1.25 ms, the timeout in 10 ms units.        */
+      Display((" %5u.%02u %3u %5u0 %4u %4u %4u %8lu %8lu%s\r\n", (Link->Information.Connection_Interval * 5) / 4, ((Link->Information.Connection_Interval * 5) % 4) * 25, Link->Information.Slave_Latency, Link->Information.Supervision_Timeout, Link->Information.Requests, Link->Information.Rejections, Link->Information.Updates, Link->Information.ProfileTime[cpBurst] / 1000, Link->Information.ProfileTime[cpIdle] / 1000, (Link->Information.Pending)?" (pending)":((Link->Backlog)?" (backlog)":"")));
+   }
+
+   Display(("   %-24s %u\r\n", "Links", ConnParamStatistics.Links));
+   Display(("   %-24s %lu (%lu accepted, %lu rejected, %lu unanswered, %lu failed)\r\n", "Requests", ConnParamStatistics.Requests, ConnParamStatistics.Accepted, ConnParamStatistics.Rejected, ConnParamStatistics.Timeouts, ConnParamStatistics.Failures));
+   Display(("   %-24s %lu\r\n", "Deferred By The Throttle", ConnParamStatistics.Deferred));
+   Display(("   %-24s %lu\r\n", "Send Backlogs", ConnParamStatistics.Backlogs));
+   Display(("   %-24s %lu\r\n", "Profiles Given Up", ConnParamStatistics.GivenUp));
+   Display(("   %-24s %lu\r\n", "Parameter Updates", ConnParamStatistics.Updates));
+}
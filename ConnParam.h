@@ -0,0 +1,175 @@
+/*****< connparam.h >**********************************************************/
+/*                                                                            */
+/*  ConnParam - Connection parameter policy of the LE links (slave role).    */
+/*                                                                            */
+/*  The central picks the connection parameters, the slave can only ask for  */
+/*  others with the L2CAP Connection Parameter Update Request.  The policy    */
+/*  asks for the burst profile (short interval, no latency) while a link is  */
+/*  busy (service discovery after the connection, bursts of GATT requests or */
+/*  a backlog of notifications) and for the idle profile (long interval with */
+/*  slave latency) once it was quiet for CONN_PARAM_IDLE_MS.                 */
+/*                                                                            */
+/*  The requests are throttled: at most one is outstanding per link, two    */
+/*  requests are at least CONN_PARAM_UPDATE_GAP_MS apart (doubled after each */
+/*  rejection) and a profile the central rejected too often in a row is no   */
+/*  longer asked for on that link.  The parameters the central actually      */
+/*  applied are recorded per link.                                           */
+/*                                                                            */
+/*  The profiles follow the common central guidelines (interval max at least */
+/*  15 ms above interval min, interval max * (latency + 1) at most 2 s and   */
+/*  a supervision timeout above three times that).                           */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __CONNPARAMH__
+#define __CONNPARAMH__
+
+#include "SS1BTPS.h"       /* Includes for the SS1 Bluetooth Protocol Stack.  */
+#include "GATTAPI.h"       /* Includes for the GATT API.                      */
+
+#ifndef CONN_PARAM_MAXIMUM_LINKS
+
+#define CONN_PARAM_MAXIMUM_LINKS                     (2)  /* Denotes the number*/
+                                                         /* of LE links whose */
+                                                         /* parameters are    */
+                                                         /* managed.          */
+
+#endif
+
+#define CONN_PARAM_BURST_INTERVAL_MIN               (12)  /* Denotes the burst */
+#define CONN_PARAM_BURST_INTERVAL_MAX               (24)  /* profile (15 - 30  */
+#define CONN_PARAM_BURST_SLAVE_LATENCY               (0)  /* ms, no latency, 4 */
+#define CONN_PARAM_BURST_SUPERVISION_TIMEOUT       (400)  /* s timeout).       */
+
+#define CONN_PARAM_IDLE_INTERVAL_MIN                (80)  /* Denotes the idle  */
+#define CONN_PARAM_IDLE_INTERVAL_MAX               (104)  /* profile (100 - 130*/
+#define CONN_PARAM_IDLE_SLAVE_LATENCY                (4)  /* ms, latency 4, 6 s*/
+#define CONN_PARAM_IDLE_SUPERVISION_TIMEOUT        (600)  /* timeout).         */
+
+#define CONN_PARAM_DISCOVERY_MS                   (5000)  /* Denotes how long  */
+                                                         /* after the         */
+                                                         /* connection the    */
+                                                         /* link is treated as*/
+                                                         /* busy (discovery). */
+
+#define CONN_PARAM_BURST_REQUESTS                    (4)  /* Denotes the number*/
+#define CONN_PARAM_BURST_WINDOW_MS                 (500)  /* of GATT requests  */
+                                                         /* within the window */
+                                                         /* that make a burst.*/
+
+#define CONN_PARAM_IDLE_MS                        (2000)  /* Denotes how long a*/
+                                                         /* link must be quiet*/
+                                                         /* before it is      */
+                                                         /* relaxed.          */
+
+#define CONN_PARAM_UPDATE_GAP_MS                  (5000)  /* Denotes the least */
+#define CONN_PARAM_MAXIMUM_GAP_MS                (60000)  /* and the largest   */
+                                                         /* time between two  */
+                                                         /* requests on a     */
+                                                         /* link.             */
+
+#define CONN_PARAM_RESPONSE_TIMEOUT_MS           (30000)  /* Denotes how long  */
+                                                         /* the answer of the */
+                                                         /* central is waited */
+                                                         /* for (L2CAP RTX).  */
+
+#define CONN_PARAM_MAXIMUM_REJECTIONS                (3)  /* Denotes the number*/
+                                                         /* of rejections in a*/
+                                                         /* row after which a */
+                                                         /* profile is given  */
+                                                         /* up on a link.     */
+
+   /* The following enumerated type represents the connection parameter */
+   /* profiles.                                                         */
+typedef enum
+{
+   cpBurst,
+   cpIdle,
+   cpNumberProfiles
+} ConnParam_Profile_t;
+
+   /* The following structure holds the state of one link.  Profile is  */
+   /* the profile the applied interval falls into, Wanted the one the   */
+   /* workload asks for.  The applied parameters are in the HCI units   */
+   /* (1.25 ms interval, 10 ms timeout).  The time in each profile is in*/
+   /* milliseconds.                                                     */
+typedef struct _tagConnParam_Link_Information_t
+{
+   BD_ADDR_t           BD_ADDR;
+   ConnParam_Profile_t Profile;
+   ConnParam_Profile_t Wanted;
+   Boolean_t           Pending;
+   Word_t              Connection_Interval;
+   Word_t              Slave_Latency;
+   Word_t              Supervision_Timeout;
+   unsigned int        Requests;
+   unsigned int        Rejections;
+   unsigned int        Updates;
+   unsigned long       ProfileTime[cpNumberProfiles];
+} ConnParam_Link_Information_t;
+
+   /* The following structure holds the statistics of all links.        */
+   /* Deferred counts the wanted profiles that had to wait for the      */
+   /* throttle, Backlogs the sends that could not be queued.            */
+typedef struct _tagConnParam_Statistics_t
+{
+   unsigned int  Links;
+   unsigned long Requests;
+   unsigned long Accepted;
+   unsigned long Rejected;
+   unsigned long Timeouts;
+   unsigned long Failures;
+   unsigned long GivenUp;
+   unsigned long Deferred;
+   unsigned long Backlogs;
+   unsigned long Updates;
+} ConnParam_Statistics_t;
+
+   /* The following function starts the management of the connection   */
+   /* parameters of the LE links of the specified stack (the links that */
+   /* are tracked are dropped, the statistics are kept).  This function */
+   /* returns zero if successful or a negative error code.              */
+int ConnParam_Initialize(unsigned int BluetoothStackID);
+
+   /* The following function stops the management of the connection    */
+   /* parameters.                                                       */
+void ConnParam_Cleanup(void);
+
+   /* The following function must be called with the GAP LE events of   */
+   /* the links (connection, disconnection, parameter updates and the   */
+   /* answers to the update requests).                                  */
+void ConnParam_ProcessGAPLEEvent(GAP_LE_Event_Data_t *GAP_LE_Event_Data);
+
+   /* The following function must be called with the GATT connection    */
+   /* events (the discovery starts at the GATT connection, a drained    */
+   /* buffer ends a notification backlog).                              */
+void ConnParam_ProcessGATTConnectionEvent(GATT_Connection_Event_Data_t *GATT_Connection_Event_Data);
+
+   /* The following function notes a GATT request of the specified      */
+   /* device.                                                           */
+void ConnParam_NoteActivity(BD_ADDR_t BD_ADDR);
+
+   /* The following function notes that a notification or indication    */
+   /* for the specified device could not be queued, the link stays in   */
+   /* the burst profile until the buffer of the link is drained.        */
+void ConnParam_NoteBacklog(BD_ADDR_t BD_ADDR);
+
+   /* The following function must be called periodically from the main  */
+   /* loop.  It re-evaluates the wanted profile of each link and issues */
+   /* the update requests the throttle allows.                          */
+void ConnParam_Process(void);
+
+   /* The following function returns the state of the link to the       */
+   /* specified device.  This function returns zero if successful or a */
+   /* negative value if the link is not tracked.                        */
+int ConnParam_QueryLink(BD_ADDR_t BD_ADDR, ConnParam_Link_Information_t *Information);
+
+   /* The following function returns the statistics of all links.  This */
+   /* function returns zero if successful or a negative value if the    */
+   /* parameter is invalid.                                             */
+int ConnParam_QueryStatistics(ConnParam_Statistics_t *Statistics);
+
+   /* The following function displays the links with their applied      */
+   /* parameters and the statistics.                                    */
+void ConnParam_Display(void);
+
+#endif
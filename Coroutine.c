@@ -0,0 +1,209 @@
+/*****< coroutine.c >**********************************************************/
+/*                                                                            */
+/*  Coroutine - Stackless coroutines that await the events of the stack.      */
+/*                                                                            */
+/******************************************************************************/
+#include "Coroutine.h"     /* Coroutine Prototypes/Constants.                 */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+#include "Metrics.h"       /* Metrics Prototypes/Constants.                   */
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the compiler*/
+   /* as part of standard C/C++).                                       */
+
+static Coroutine_t   *CoroutineList;                /* Variable which holds the list of*/
+                                                    /* running coroutines.             */
+
+static unsigned int   NumberRunning;                /* Variable which holds the number */
+                                                    /* of running coroutines.          */
+
+static unsigned long  SignalSequence;               /* Variable which holds the number */
+                                                    /* of signals so far (a coroutine  */
+                                                    /* that awaits the same event again*/
+                                                    /* is not resumed by the signal    */
+                                                    /* that resumed it).               */
+
+   /* Internal function prototypes.                                     */
+static void RemoveCoroutine(Coroutine_t *Coroutine);
+static int ResumeCoroutine(Coroutine_t *Coroutine);
+
+   /* The following function removes the specified coroutine from the   */
+   /* list of running coroutines.                                       */
+static void RemoveCoroutine(Coroutine_t *Coroutine)
+{
+   Coroutine_t **Link;
+
+   for(Link=&CoroutineList;*Link;Link=&((*Link)->NextCoroutine))
+   {
+      if(*Link == Coroutine)
+      {
+         *Link = Coroutine->NextCoroutine;
+
+         NumberRunning--;
+
+         break;
+      }
+   }
+
+   Coroutine->NextCoroutine = NULL;
+   Coroutine->Function      = NULL;
+   Coroutine->Event         = COROUTINE_EVENT_NONE;
+}
+
+   /* The following function runs the specified coroutine up to its next*/
+   /* await (or its end, in which case it is removed from the list).    */
+   /* This function returns the value that the function of the coroutine*/
+   /* returned.                                                         */
+static int ResumeCoroutine(Coroutine_t *Coroutine)
+{
+   int ret_val;
+
+   Coroutine->Event = COROUTINE_EVENT_NONE;
+
+   ret_val = (*Coroutine->Function)(Coroutine, Coroutine->CallbackParameter);
+
+   if(ret_val != COROUTINE_WAITING)
+      RemoveCoroutine(Coroutine);
+
+   return(ret_val);
+}
+
+   /* The following function starts the specified coroutine.  The       */
+   /* function runs right away up to its first await (or to its end).   */
+   /* This function returns COROUTINE_WAITING if the coroutine awaits an*/
+   /* event, the result of the coroutine if it already finished or a    */
+   /* negative value if it could not be started (COROUTINE_ERROR_BUSY if*/
+   /* it is still running).                                             */
+int Coroutine_Start(Coroutine_t *Coroutine, char *Name, Coroutine_Function_t Function, unsigned long CallbackParameter)
+{
+   int ret_val;
+
+   if((Coroutine) && (Function))
+   {
+      if(!Coroutine->Function)
+      {
+         Coroutine->Name              = Name;
+         Coroutine->Function          = Function;
+         Coroutine->CallbackParameter = CallbackParameter;
+         Coroutine->ResumePoint       = 0;
+         Coroutine->StartTime         = BTPS_GetTickCount();
+         Coroutine->Result            = 0;
+
+         Coroutine->NextCoroutine     = CoroutineList;
+         CoroutineList                = Coroutine;
+
+         METRICS_WATERMARK(mwOperations, ++NumberRunning);
+
+         ret_val = ResumeCoroutine(Coroutine);
+      }
+      else
+         ret_val = COROUTINE_ERROR_BUSY;
+   }
+   else
+      ret_val = COROUTINE_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* The following function is used by COROUTINE_AWAIT() to note the   */
+   /* event that the coroutine awaits.                                  */
+void Coroutine_Await(Coroutine_t *Coroutine, unsigned int Event, BD_ADDR_t *BD_ADDR, unsigned long TimeoutMS)
+{
+   Coroutine->Event    = Event;
+   Coroutine->Deadline = BTPS_GetTickCount() + TimeoutMS;
+   Coroutine->Sequence = SignalSequence;
+
+   if(BD_ADDR)
+      Coroutine->BD_ADDR = *BD_ADDR;
+   else
+      ASSIGN_BD_ADDR(Coroutine->BD_ADDR, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+}
+
+   /* The following function signals the specified Event of the         */
+   /* specified device (NULL if the event is not bound to a device).    */
+   /* Every coroutine that awaits the event is resumed with the         */
+   /* specified Result before this function returns.  This function     */
+   /* returns the number of coroutines that were resumed.               */
+unsigned int Coroutine_Signal(unsigned int Event, BD_ADDR_t *BD_ADDR, int Result)
+{
+   unsigned int  ret_val;
+   unsigned long Sequence;
+   Coroutine_t  *Coroutine;
+
+   ret_val  = 0;
+   Sequence = ++SignalSequence;
+
+   /* A resumed coroutine may finish, start another one or await again, */
+   /* so the list is walked from the start after each one.              */
+   Coroutine = CoroutineList;
+   while(Coroutine)
+   {
+      if((Coroutine->Event == Event) && (Coroutine->Sequence != Sequence) && ((!BD_ADDR) || (COMPARE_NULL_BD_ADDR(Coroutine->BD_ADDR)) || (COMPARE_BD_ADDR(Coroutine->BD_ADDR, *BD_ADDR))))
+      {
+         Coroutine->Sequence = Sequence;
+         Coroutine->Result   = Result;
+
+         ResumeCoroutine(Coroutine);
+
+         ret_val++;
+
+         Coroutine = CoroutineList;
+      }
+      else
+         Coroutine = Coroutine->NextCoroutine;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function stops the specified coroutine without      */
+   /* resuming it (for example, when the stack is closed).              */
+void Coroutine_Cancel(Coroutine_t *Coroutine)
+{
+   if((Coroutine) && (Coroutine->Function))
+   {
+      RemoveCoroutine(Coroutine);
+
+      Coroutine->ResumePoint = 0;
+   }
+}
+
+   /* The following function returns TRUE if the specified coroutine is */
+   /* running.                                                          */
+Boolean_t Coroutine_Running(Coroutine_t *Coroutine)
+{
+   return((Boolean_t)((Coroutine) && (Coroutine->Function)));
+}
+
+   /* The following function returns the running coroutine after the    */
+   /* specified one (the first one if Coroutine is NULL), or NULL if    */
+   /* there are no more.                                                */
+Coroutine_t *Coroutine_QueryNext(Coroutine_t *Coroutine)
+{
+   return((Coroutine)?Coroutine->NextCoroutine:CoroutineList);
+}
+
+   /* The following function must be called periodically from the main  */
+   /* loop.  It resumes the coroutines whose await timed out.           */
+void Coroutine_Process(void)
+{
+   unsigned long  CurrentTime;
+   Coroutine_t   *Coroutine;
+
+   CurrentTime = BTPS_GetTickCount();
+
+   Coroutine = CoroutineList;
+   while(Coroutine)
+   {
+      if((Coroutine->Event != COROUTINE_EVENT_NONE) && ((long)(CurrentTime - Coroutine->Deadline) >= 0))
+      {
+         Coroutine->Result = COROUTINE_RESULT_TIMEOUT;
+
+         ResumeCoroutine(Coroutine);
+
+         Coroutine = CoroutineList;
+      }
+      else
+         Coroutine = Coroutine->NextCoroutine;
+   }
+}
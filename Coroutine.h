@@ -0,0 +1,144 @@
+/*****< coroutine.h >**********************************************************/
+/*                                                                            */
+/*  Coroutine - Stackless coroutines that await the events of the stack.      */
+/*                                                                            */
+/*  A stack operation that completes with an event (an inquiry, a bond, an    */
+/*  audio connection) is written as one function that reads from top to       */
+/*  bottom: it issues the request, awaits the event that completes it and     */
+/*  goes on with the result.  The function returns to its caller at every     */
+/*  await (no stack is kept, the resume point is a line number that the       */
+/*  function switches to when it is resumed), so several operations run       */
+/*  interleaved on the main loop without a thread each:                       */
+/*                                                                            */
+/*     static int Flow(Coroutine_t *Coroutine, unsigned long Parameter)       */
+/*     {                                                                      */
+/*        COROUTINE_BEGIN(Coroutine);                                         */
+/*                                                                            */
+/*        Start the operation (COROUTINE_EXIT() if it failed).                */
+/*                                                                            */
+/*        COROUTINE_AWAIT(Coroutine, Event, &BD_ADDR, TimeoutMS);             */
+/*                                                                            */
+/*        Use COROUTINE_AWAIT_RESULT(Coroutine).                              */
+/*                                                                            */
+/*        COROUTINE_END(Coroutine);                                           */
+/*     }                                                                      */
+/*                                                                            */
+/*  The event callbacks report the events with Coroutine_Signal(), which      */
+/*  resumes the coroutines that await them, and Coroutine_Process() (called   */
+/*  from the main loop) resumes the ones whose await timed out.               */
+/*                                                                            */
+/*  Local variables of the function do not survive an await, the state that   */
+/*  is needed after it is kept in a structure that is passed as the           */
+/*  CallbackParameter.  A switch statement cannot enclose an await.           */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __COROUTINEH__
+#define __COROUTINEH__
+
+#include "SS1BTPS.h"       /* Includes for the SS1 Bluetooth Protocol Stack.  */
+
+#define COROUTINE_WAITING                           (1)  /* Denotes that the   */
+                                                         /* coroutine awaits  */
+                                                         /* an event.         */
+
+#define COROUTINE_ERROR_BUSY                    (-1000)  /* Denotes that the   */
+                                                         /* coroutine is      */
+                                                         /* already running.  */
+
+#define COROUTINE_ERROR_INVALID_PARAMETER       (-1001)  /* Denotes that the   */
+                                                         /* parameters are    */
+                                                         /* invalid.          */
+
+#define COROUTINE_RESULT_TIMEOUT                (-1002)  /* Denotes the result */
+                                                         /* of an await that  */
+                                                         /* timed out.        */
+
+#define COROUTINE_EVENT_NONE                        (0)  /* Denotes that the   */
+                                                         /* coroutine awaits  */
+                                                         /* no event.         */
+
+struct _tagCoroutine_t;
+
+   /* The following type definition represents the function of a        */
+   /* coroutine.  The function returns COROUTINE_WAITING when it awaits */
+   /* an event (see COROUTINE_AWAIT()) and its result (zero if          */
+   /* successful or a negative value if there was an error) when it     */
+   /* finished.                                                         */
+typedef int (*Coroutine_Function_t)(struct _tagCoroutine_t *Coroutine, unsigned long CallbackParameter);
+
+   /* The following structure holds the state of a coroutine.  The      */
+   /* structure is owned by the caller (normally a static variable per  */
+   /* operation, so an operation runs once at a time) and must not be   */
+   /* changed while the coroutine is running.                           */
+typedef struct _tagCoroutine_t
+{
+   char                   *Name;
+   Coroutine_Function_t    Function;
+   unsigned long           CallbackParameter;
+   unsigned int            ResumePoint;
+   unsigned int            Event;
+   BD_ADDR_t               BD_ADDR;
+   unsigned long           Deadline;
+   unsigned long           StartTime;
+   unsigned long           Sequence;
+   int                     Result;
+   struct _tagCoroutine_t *NextCoroutine;
+} Coroutine_t;
+
+   /* The following macros are used by the function of a coroutine.     */
+   /* COROUTINE_BEGIN() must come first (after the declarations) and    */
+   /* COROUTINE_END() last, it finishes the coroutine with a result of  */
+   /* zero.  COROUTINE_EXIT() finishes the coroutine early with the     */
+   /* specified result.                                                 */
+#define COROUTINE_BEGIN(_x)                        switch((_x)->ResumePoint) { case 0:
+
+#define COROUTINE_END(_x)                          } (_x)->ResumePoint = 0; return(0)
+
+#define COROUTINE_EXIT(_x, _y)                     do { (_x)->ResumePoint = 0; return(_y); } while(0)
+
+   /* The following macro suspends the coroutine until the specified    */
+   /* Event is signalled for the specified device (NULL for any device) */
+   /* or TimeoutMS have passed.  The result that the event was signalled*/
+   /* with (or COROUTINE_RESULT_TIMEOUT) is read with                   */
+   /* COROUTINE_AWAIT_RESULT() once the coroutine is resumed.           */
+#define COROUTINE_AWAIT(_x, _y, _z, _t)            do { Coroutine_Await((_x), (_y), (_z), (_t)); (_x)->ResumePoint = __LINE__; return(COROUTINE_WAITING); case __LINE__: ; } while(0)
+
+#define COROUTINE_AWAIT_RESULT(_x)                 ((_x)->Result)
+
+   /* The following function starts the specified coroutine.  The       */
+   /* function runs right away up to its first await (or to its end).   */
+   /* This function returns COROUTINE_WAITING if the coroutine awaits an*/
+   /* event, the result of the coroutine if it already finished or a    */
+   /* negative value if it could not be started (COROUTINE_ERROR_BUSY if*/
+   /* it is still running).                                             */
+int Coroutine_Start(Coroutine_t *Coroutine, char *Name, Coroutine_Function_t Function, unsigned long CallbackParameter);
+
+   /* The following function is used by COROUTINE_AWAIT() to note the   */
+   /* event that the coroutine awaits.                                  */
+void Coroutine_Await(Coroutine_t *Coroutine, unsigned int Event, BD_ADDR_t *BD_ADDR, unsigned long TimeoutMS);
+
+   /* The following function signals the specified Event of the         */
+   /* specified device (NULL if the event is not bound to a device).    */
+   /* Every coroutine that awaits the event is resumed with the         */
+   /* specified Result before this function returns.  This function     */
+   /* returns the number of coroutines that were resumed.               */
+unsigned int Coroutine_Signal(unsigned int Event, BD_ADDR_t *BD_ADDR, int Result);
+
+   /* The following function stops the specified coroutine without      */
+   /* resuming it (for example, when the stack is closed).              */
+void Coroutine_Cancel(Coroutine_t *Coroutine);
+
+   /* The following function returns TRUE if the specified coroutine is */
+   /* running.                                                          */
+Boolean_t Coroutine_Running(Coroutine_t *Coroutine);
+
+   /* The following function returns the running coroutine after the    */
+   /* specified one (the first one if Coroutine is NULL), or NULL if    */
+   /* there are no more.                                                */
+Coroutine_t *Coroutine_QueryNext(Coroutine_t *Coroutine);
+
+   /* The following function must be called periodically from the main  */
+   /* loop.  It resumes the coroutines whose await timed out.           */
+void Coroutine_Process(void);
+
+#endif
@@ -0,0 +1,1210 @@
+/*****< gattclient.c >*********************************************************/
+/*                                                                            */
+/*  GATTClient - GATT client role with a per-peer discovery cache.            */
+/*                                                                            */
+/******************************************************************************/
+#include <stdint.h>        /* Included for TivaWare driver library types.     */
+#include <stdbool.h>       /* Included for TivaWare driver library types.     */
+#include "Main.h"          /* Application Interface Abstraction.              */
+#include "GATTClient.h"    /* GATT Client Prototypes/Constants.               */
+#include "GATTUUID.h"      /* GATT UUID Prototypes/Constants.                 */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+#include "driverlib/flash.h" /* TivaWare Flash Driver Prototypes.             */
+
+#ifdef GATT_CLIENT_ENABLE
+
+#define GATT_CLIENT_SIGNATURE                    (0x47434348)  /* "GCCH"      */
+
+#define GATT_CLIENT_VERSION                          (0x0001)
+
+#define ENTRY_FLAGS_HASH_VALID                         (0x01)
+
+#define DATABASE_HASH_SIZE                               (16)
+
+   /* The following constants define the serialized form of a database. */
+   /* Each attribute is one record: a header byte (the record type and  */
+   /* the flags below), the handle as the distance to the handle of the */
+   /* previous record (one byte) or absolute (two bytes), the end of a  */
+   /* service as the distance to its handle or absolute, the properties */
+   /* of a characteristic and the UUID (2 or 16 bytes).  Characteristics*/
+   /* are recorded by their value handle.                               */
+#define RECORD_TYPE_MASK                               (0xC0)
+#define RECORD_TYPE_SERVICE                            (0x00)
+#define RECORD_TYPE_CHARACTERISTIC                     (0x40)
+#define RECORD_TYPE_DESCRIPTOR                         (0x80)
+#define RECORD_FLAG_UUID_128                           (0x20)
+#define RECORD_FLAG_ABSOLUTE_HANDLE                    (0x10)
+#define RECORD_FLAG_ABSOLUTE_END                       (0x08)
+
+#define RECORD_MAXIMUM_SIZE                            (1 + 2 + 2 + 1 + sizeof(UUID_128_t))
+
+   /* The following type definition represents an entry of the cache.  */
+   /* The serialized databases follow each other in the data area in   */
+   /* the order of the entries.  The handles of the Service Changed     */
+   /* characteristic and of its configuration descriptor are kept so an */
+   /* indication can be recognized without decoding the database.      */
+typedef struct _tagCacheEntry_t
+{
+   BD_ADDR_t BD_ADDR;
+   Byte_t    Flags;
+   Byte_t    Age;
+   Word_t    Length;
+   Word_t    ServiceChangedHandle;
+   Word_t    ConfigurationHandle;
+   Byte_t    Hash[DATABASE_HASH_SIZE];
+} CacheEntry_t;
+
+typedef struct _tagCacheHeader_t
+{
+   DWord_t      Signature;
+   Word_t       Version;
+   Word_t       NumberEntries;
+   CacheEntry_t Entries[GATT_CLIENT_MAXIMUM_PEERS];
+} CacheHeader_t;
+
+#define CACHE_DATA_SIZE                                  (GATT_CLIENT_FLASH_SIZE - sizeof(CacheHeader_t) - sizeof(DWord_t))
+
+   /* The following type definition represents the image of the cache   */
+   /* that is stored in flash (it fills the flash pages of the cache).  */
+typedef struct _tagCacheImage_t
+{
+   CacheHeader_t Header;
+   Byte_t        Data[CACHE_DATA_SIZE];
+   DWord_t       Checksum;
+} CacheImage_t;
+
+   /* The flash can only be programmed a word at a time so the image is */
+   /* built in a word aligned buffer that is rounded up to a word.      */
+#define CACHE_IMAGE_WORDS                                ((sizeof(CacheImage_t) + sizeof(uint32_t) - 1)/sizeof(uint32_t))
+
+typedef union _tagCacheImageBuffer_t
+{
+   CacheImage_t Image;
+   uint32_t     Words[CACHE_IMAGE_WORDS];
+} CacheImageBuffer_t;
+
+   /* The following enumerated type represents the state of a link.     */
+   /* Only the link that owns the discovery buffer is in lsDiscovering, */
+   /* lsHashRead or lsSubscribing, the others wait in lsWaiting.        */
+typedef enum
+{
+   lsIdle,
+   lsHashCheck,
+   lsWaiting,
+   lsDiscovering,
+   lsHashRead,
+   lsSubscribing,
+   lsReady
+} LinkState_t;
+
+   /* The following type definition represents the container type which */
+   /* holds the state of a link.  The link is added when the local      */
+   /* device connected as the master, ConnectionID is zero until the    */
+   /* GATT connection of the link is reported.  Stored is set while the */
+   /* database of the link is in the cache, Rediscover when a Service   */
+   /* Changed indication arrived while a request was outstanding.       */
+   /* ServiceChangedHandle is the handle the indication is expected on. */
+typedef struct _tagLink_t
+{
+   Boolean_t     InUse;
+   unsigned int  ConnectionID;
+   BD_ADDR_t     BD_ADDR;
+   LinkState_t   State;
+   Boolean_t     Stored;
+   Boolean_t     Rediscover;
+   Word_t        ServiceChangedHandle;
+   unsigned int  TransactionID;
+} Link_t;
+
+   /* The following type definition represents the container type which */
+   /* holds the discovery in progress.  The database is serialized into */
+   /* Buffer as the services are reported (PreviousHandle is the handle */
+   /* of the last record), Overflow is set if it does not fit.  The     */
+   /* handles of the Database Hash and Service Changed characteristics  */
+   /* (and of the configuration descriptor of the latter) are noted on  */
+   /* the way.                                                          */
+typedef struct _tagDiscovery_t
+{
+   Link_t       *Link;
+   unsigned int  Length;
+   Word_t        PreviousHandle;
+   Boolean_t     Overflow;
+   Word_t        HashHandle;
+   Word_t        ServiceChangedHandle;
+   Word_t        ConfigurationHandle;
+   Boolean_t     HashValid;
+   Byte_t        Hash[DATABASE_HASH_SIZE];
+   Byte_t        Buffer[GATT_CLIENT_MAXIMUM_DATABASE_SIZE];
+} Discovery_t;
+
+   /* The following type definition represents a decoded record of a    */
+   /* serialized database.                                              */
+typedef struct _tagRecord_t
+{
+   Byte_t      Type;
+   Word_t      Handle;
+   Word_t      EndHandle;
+   Byte_t      Properties;
+   GATT_UUID_t UUID;
+} Record_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static unsigned int            GATTClientStackID;   /* Variable which holds the*/
+                                                    /* stack the client runs   */
+                                                    /* on (zero if stopped).   */
+
+static GATTClient_Ready_Callback_t ReadyCallback;   /* Variables which hold the*/
+static unsigned long           ReadyCallbackParameter; /* function called when */
+                                                    /* a database is known.    */
+
+static CacheImageBuffer_t      CacheImage;          /* Variable which holds the*/
+                                                    /* RAM copy of the cache.  */
+
+static Boolean_t               CacheDirty;          /* Variable which flags    */
+                                                    /* that the cache must be  */
+                                                    /* written back to flash.  */
+
+static Byte_t                  CacheAge;            /* Variable which holds the*/
+                                                    /* current age stamp given */
+                                                    /* to entries when used.   */
+
+static Link_t                  Links[GATT_CLIENT_MAXIMUM_LINKS]; /* Variable   */
+                                                    /* which holds the tracked */
+                                                    /* links.                  */
+
+static Discovery_t             Discovery;           /* Variable which holds the*/
+                                                    /* discovery in progress.  */
+
+static GATTClient_Statistics_t GATTClientStatistics; /* Variable which holds   */
+                                                    /* the statistics.         */
+
+static const GATT_UUID_t DatabaseHashUUID        = GATT_UUID_16_INITIALIZER(0x2B2A);
+static const GATT_UUID_t ServiceChangedUUID      = GATT_UUID_16_INITIALIZER(0x2A05);
+static const GATT_UUID_t ClientConfigurationUUID = GATT_UUID_16_INITIALIZER(0x2902);
+
+static char *StateNames[] = { "Idle", "HashCheck", "Waiting", "Discovering", "HashRead", "Subscribing", "Ready" };
+
+   /* Internal function prototypes.                                     */
+static DWord_t CalculateChecksum(CacheImage_t *Image);
+static Boolean_t CompareUUID(const GATT_UUID_t *UUID1, const GATT_UUID_t *UUID2);
+static int FindEntry(BD_ADDR_t BD_ADDR);
+static unsigned int EntryOffset(unsigned int Index);
+static unsigned int CacheBytes(void);
+static void RemoveEntry(unsigned int Index);
+static Link_t *FindLink(unsigned int ConnectionID);
+static Link_t *FindLinkByAddress(BD_ADDR_t BD_ADDR);
+static Boolean_t StoreEntry(Link_t *Link);
+static void EncodeRecord(Byte_t Type, Word_t Handle, Word_t EndHandle, Byte_t Properties, GATT_UUID_t *UUID);
+static unsigned int DecodeRecord(Byte_t *Data, unsigned int Length, Word_t *PreviousHandle, Record_t *Record);
+static void SignalReady(Link_t *Link, Boolean_t Cached);
+static void StartDiscovery(Link_t *Link);
+static void ReleaseDiscovery(void);
+static void ContinueSetup(Link_t *Link);
+static void BTPSAPI GATTClient_Discovery_Event_Callback(unsigned int BluetoothStackID, GATT_Service_Discovery_Event_Data_t *GATT_Service_Discovery_Event_Data, unsigned long CallbackParameter);
+static void BTPSAPI GATTClient_Event_Callback(unsigned int BluetoothStackID, GATT_Client_Event_Data_t *GATT_Client_Event_Data, unsigned long CallbackParameter);
+
+   /* The following function calculates the checksum of the cache image*/
+   /* (excluding the checksum itself).                                  */
+static DWord_t CalculateChecksum(CacheImage_t *Image)
+{
+   DWord_t       ret_val = 0;
+   Byte_t       *Data    = (Byte_t *)Image;
+   unsigned int  Index;
+
+   for(Index=0;Index<(unsigned int)((Byte_t *)&(Image->Checksum) - Data);Index++)
+      ret_val = ((ret_val << 5) | (ret_val >> 27)) ^ Data[Index];
+
+   return(ret_val);
+}
+
+   /* The following function returns TRUE if the specified UUIDs are     */
+   /* equal.                                                            */
+static Boolean_t CompareUUID(const GATT_UUID_t *UUID1, const GATT_UUID_t *UUID2)
+{
+   Boolean_t ret_val = FALSE;
+
+   if(UUID1->UUID_Type == UUID2->UUID_Type)
+   {
+      if(UUID1->UUID_Type == guUUID_16)
+         ret_val = (Boolean_t)(!BTPS_MemCompare(&(UUID1->UUID.UUID_16), &(UUID2->UUID.UUID_16), sizeof(UUID_16_t)));
+      else
+         ret_val = (Boolean_t)(!BTPS_MemCompare(&(UUID1->UUID.UUID_128), &(UUID2->UUID.UUID_128), sizeof(UUID_128_t)));
+   }
+
+   return(ret_val);
+}
+
+   /* The following function searches the cache for the specified       */
+   /* device.  This function returns the index of the entry or a        */
+   /* negative value if the device is not cached.                       */
+static int FindEntry(BD_ADDR_t BD_ADDR)
+{
+   int          ret_val = -1;
+   unsigned int Index;
+
+   for(Index=0;(Index<CacheImage.Image.Header.NumberEntries) && (ret_val < 0);Index++)
+   {
+      if(COMPARE_BD_ADDR(CacheImage.Image.Header.Entries[Index].BD_ADDR, BD_ADDR))
+         ret_val = (int)Index;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the offset of the database of the  */
+   /* specified entry in the data area.                                 */
+static unsigned int EntryOffset(unsigned int Index)
+{
+   unsigned int ret_val;
+
+   for(ret_val=0;Index;Index--)
+      ret_val += CacheImage.Image.Header.Entries[Index - 1].Length;
+
+   return(ret_val);
+}
+
+   /* The following function returns the number of bytes of the data area*/
+   /* that are in use.                                                  */
+static unsigned int CacheBytes(void)
+{
+   return(EntryOffset(CacheImage.Image.Header.NumberEntries));
+}
+
+   /* The following function removes the specified entry (and its        */
+   /* database) from the cache.  The databases behind it are moved down */
+   /* so the data area stays packed.                                    */
+static void RemoveEntry(unsigned int Index)
+{
+   Byte_t        Flags;
+   Link_t       *Link;
+   unsigned int  Offset;
+   unsigned int  Length;
+
+   if(Index < CacheImage.Image.Header.NumberEntries)
+   {
+      if((Link = FindLinkByAddress(CacheImage.Image.Header.Entries[Index].BD_ADDR)) != NULL)
+         Link->Stored = FALSE;
+
+      Offset = EntryOffset(Index);
+      Length = CacheImage.Image.Header.Entries[Index].Length;
+      Flags  = CacheImage.Image.Header.Entries[Index].Flags;
+
+      BTPS_MemMove(&(CacheImage.Image.Data[Offset]), &(CacheImage.Image.Data[Offset + Length]), CacheBytes() - (Offset + Length));
+      BTPS_MemMove(&(CacheImage.Image.Header.Entries[Index]), &(CacheImage.Image.Header.Entries[Index + 1]), (CacheImage.Image.Header.NumberEntries - (Index + 1)) * sizeof(CacheEntry_t));
+
+      CacheImage.Image.Header.NumberEntries--;
+
+      /* Clear the freed space so the image does not depend on what was */
+      /* removed.                                                       */
+      BTPS_MemInitialize(&(CacheImage.Image.Header.Entries[CacheImage.Image.Header.NumberEntries]), 0, sizeof(CacheEntry_t));
+      BTPS_MemInitialize(&(CacheImage.Image.Data[CacheBytes()]), 0, CACHE_DATA_SIZE - CacheBytes());
+
+      /* Entries without a hash are not meant to be in flash.           */
+      if(Flags & ENTRY_FLAGS_HASH_VALID)
+         CacheDirty = TRUE;
+   }
+}
+
+   /* The following function returns the tracked link with the specified*/
+   /* connection ID (NULL if the link is not tracked).                  */
+static Link_t *FindLink(unsigned int ConnectionID)
+{
+   unsigned int  Index;
+   Link_t       *ret_val = NULL;
+
+   for(Index=0;(Index<GATT_CLIENT_MAXIMUM_LINKS) && (!ret_val);Index++)
+   {
+      if((Links[Index].InUse) && (Links[Index].ConnectionID == ConnectionID))
+         ret_val = &Links[Index];
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the tracked link to the specified   */
+   /* device (NULL if the link is not tracked).                         */
+static Link_t *FindLinkByAddress(BD_ADDR_t BD_ADDR)
+{
+   unsigned int  Index;
+   Link_t       *ret_val = NULL;
+
+   for(Index=0;(Index<GATT_CLIENT_MAXIMUM_LINKS) && (!ret_val);Index++)
+   {
+      if((Links[Index].InUse) && (COMPARE_BD_ADDR(Links[Index].BD_ADDR, BD_ADDR)))
+         ret_val = &Links[Index];
+   }
+
+   return(ret_val);
+}
+
+   /* The following function stores the database in the discovery buffer*/
+   /* as the entry of the specified link.  The least recently used      */
+   /* entries make room, except the ones of the connected peers (their  */
+   /* databases are in use).  A database without a Database Hash is    */
+   /* only kept while the link is up, it does not make the cache dirty  */
+   /* (a reconnect could not tell whether it is still valid).  This     */
+   /* function returns FALSE if the database does not fit.              */
+static Boolean_t StoreEntry(Link_t *Link)
+{
+   int           Result;
+   Boolean_t     ret_val = FALSE;
+   unsigned int  Index;
+   CacheEntry_t *Entry;
+
+   if((Result = FindEntry(Link->BD_ADDR)) >= 0)
+      RemoveEntry((unsigned int)Result);
+
+   if((!Discovery.Overflow) && (Discovery.Length <= CACHE_DATA_SIZE))
+   {
+      while((CacheImage.Image.Header.NumberEntries == GATT_CLIENT_MAXIMUM_PEERS) || ((CacheBytes() + Discovery.Length) > CACHE_DATA_SIZE))
+      {
+         /* The age stamp wraps so compare distances from the current   */
+         /* stamp.                                                      */
+         for(Index=0,Result=-1;Index<CacheImage.Image.Header.NumberEntries;Index++)
+         {
+            if(FindLinkByAddress(CacheImage.Image.Header.Entries[Index].BD_ADDR))
+               continue;
+
+            if((Result < 0) || ((Byte_t)(CacheAge - CacheImage.Image.Header.Entries[Index].Age) > (Byte_t)(CacheAge - CacheImage.Image.Header.Entries[Result].Age)))
+               Result = (int)Index;
+         }
+
+         if(Result < 0)
+            break;
+
+         RemoveEntry((unsigned int)Result);
+
+         GATTClientStatistics.Evicted++;
+      }
+
+      if((CacheImage.Image.Header.NumberEntries < GATT_CLIENT_MAXIMUM_PEERS) && ((CacheBytes() + Discovery.Length) <= CACHE_DATA_SIZE))
+      {
+         BTPS_MemCopy(&(CacheImage.Image.Data[CacheBytes()]), Discovery.Buffer, Discovery.Length);
+
+         Entry = &(CacheImage.Image.Header.Entries[CacheImage.Image.Header.NumberEntries++]);
+
+         BTPS_MemInitialize(Entry, 0, sizeof(CacheEntry_t));
+
+         Entry->BD_ADDR              = Link->BD_ADDR;
+         Entry->Age                  = ++CacheAge;
+         Entry->Length               = (Word_t)Discovery.Length;
+         Entry->ServiceChangedHandle = Discovery.ServiceChangedHandle;
+         Entry->ConfigurationHandle  = Discovery.ConfigurationHandle;
+
+         if(Discovery.HashValid)
+         {
+            Entry->Flags |= ENTRY_FLAGS_HASH_VALID;
+
+            BTPS_MemCopy(Entry->Hash, Discovery.Hash, DATABASE_HASH_SIZE);
+
+            CacheDirty = TRUE;
+
+            GATTClientStatistics.Stored++;
+         }
+         else
+            GATTClientStatistics.Unverified++;
+
+         Link->Stored = TRUE;
+         ret_val      = TRUE;
+      }
+   }
+
+   if(!ret_val)
+      GATTClientStatistics.Overflows++;
+
+   return(ret_val);
+}
+
+   /* The following function appends a record to the database in the     */
+   /* discovery buffer (a database that does not fit is flagged, it is  */
+   /* not cached).                                                      */
+static void EncodeRecord(Byte_t Type, Word_t Handle, Word_t EndHandle, Byte_t Properties, GATT_UUID_t *UUID)
+{
+   Byte_t       Record[RECORD_MAXIMUM_SIZE];
+   unsigned int Length;
+
+   Record[0] = Type;
+   Length    = 1;
+
+   if((Handle > Discovery.PreviousHandle) && ((Handle - Discovery.PreviousHandle) <= 0xFF))
+      Record[Length++] = (Byte_t)(Handle - Discovery.PreviousHandle);
+   else
+   {
+      Record[0] |= RECORD_FLAG_ABSOLUTE_HANDLE;
+
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Record[Length], Handle);
+      Length    += 2;
+   }
+
+   if(Type == RECORD_TYPE_SERVICE)
+   {
+      if((EndHandle >= Handle) && ((EndHandle - Handle) <= 0xFF))
+         Record[Length++] = (Byte_t)(EndHandle - Handle);
+      else
+      {
+         Record[0] |= RECORD_FLAG_ABSOLUTE_END;
+
+         ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Record[Length], EndHandle);
+         Length    += 2;
+      }
+   }
+
+   if(Type == RECORD_TYPE_CHARACTERISTIC)
+      Record[Length++] = Properties;
+
+   if(UUID->UUID_Type == guUUID_16)
+   {
+      BTPS_MemCopy(&Record[Length], &(UUID->UUID.UUID_16), sizeof(UUID_16_t));
+      Length    += sizeof(UUID_16_t);
+   }
+   else
+   {
+      Record[0] |= RECORD_FLAG_UUID_128;
+
+      BTPS_MemCopy(&Record[Length], &(UUID->UUID.UUID_128), sizeof(UUID_128_t));
+      Length    += sizeof(UUID_128_t);
+   }
+
+   if((Discovery.Length + Length) <= sizeof(Discovery.Buffer))
+   {
+      BTPS_MemCopy(&Discovery.Buffer[Discovery.Length], Record, Length);
+
+      Discovery.Length += Length;
+   }
+   else
+      Discovery.Overflow = TRUE;
+
+   Discovery.PreviousHandle = Handle;
+}
+
+
+   /* The following function decodes the record at the start of the      */
+   /* specified data (PreviousHandle holds the handle of the record     */
+   /* before it and is advanced).  This function returns the size of the*/
+   /* record or zero if the data does not hold a complete record.       */
+static unsigned int DecodeRecord(Byte_t *Data, unsigned int Length, Word_t *PreviousHandle, Record_t *Record)
+{
+   Byte_t       Header;
+   unsigned int ret_val = 0;
+   unsigned int Size;
+
+   BTPS_MemInitialize(Record, 0, sizeof(Record_t));
+
+   if(Length)
+   {
+      Header       = Data[0];
+      Record->Type = (Byte_t)(Header & RECORD_TYPE_MASK);
+
+      /* Work out the size of the record before anything is read.       */
+      Size = 1 + ((Header & RECORD_FLAG_ABSOLUTE_HANDLE)?2:1) + ((Header & RECORD_FLAG_UUID_128)?sizeof(UUID_128_t):sizeof(UUID_16_t));
+
+      if(Record->Type == RECORD_TYPE_SERVICE)
+         Size += (Header & RECORD_FLAG_ABSOLUTE_END)?2:1;
+
+      if(Record->Type == RECORD_TYPE_CHARACTERISTIC)
+         Size++;
+
+      if((Record->Type != RECORD_TYPE_MASK) && (Size <= Length))
+      {
+         ret_val = Size;
+         Size    = 1;
+
+         if(Header & RECORD_FLAG_ABSOLUTE_HANDLE)
+         {
+            Record->Handle  = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[Size]);
+            Size           += 2;
+         }
+         else
+            Record->Handle = (Word_t)(*PreviousHandle + Data[Size++]);
+
+         if(Record->Type == RECORD_TYPE_SERVICE)
+         {
+            if(Header & RECORD_FLAG_ABSOLUTE_END)
+            {
+               Record->EndHandle  = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[Size]);
+               Size              += 2;
+            }
+            else
+               Record->EndHandle = (Word_t)(Record->Handle + Data[Size++]);
+         }
+
+         if(Record->Type == RECORD_TYPE_CHARACTERISTIC)
+            Record->Properties = Data[Size++];
+
+         if(Header & RECORD_FLAG_UUID_128)
+         {
+            Record->UUID.UUID_Type = guUUID_128;
+
+            BTPS_MemCopy(&(Record->UUID.UUID.UUID_128), &Data[Size], sizeof(UUID_128_t));
+         }
+         else
+         {
+            Record->UUID.UUID_Type = guUUID_16;
+
+            BTPS_MemCopy(&(Record->UUID.UUID.UUID_16), &Data[Size], sizeof(UUID_16_t));
+         }
+
+         *PreviousHandle = Record->Handle;
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function marks the database of the specified link as*/
+   /* known and tells the application.                                  */
+static void SignalReady(Link_t *Link, Boolean_t Cached)
+{
+   Link->State = lsReady;
+
+   if(ReadyCallback)
+      (*ReadyCallback)(Link->ConnectionID, Link->BD_ADDR, Cached, ReadyCallbackParameter);
+}
+
+   /* The following function starts the discovery of the database of the*/
+   /* specified link.  The link waits if another link owns the discovery*/
+   /* buffer (the link that owns it may restart its own discovery).     */
+static void StartDiscovery(Link_t *Link)
+{
+   Link->Rediscover    = FALSE;
+   Link->TransactionID = 0;
+
+   if((Discovery.Link) && (Discovery.Link != Link))
+      Link->State = lsWaiting;
+   else
+   {
+      BTPS_MemInitialize(&Discovery, 0, sizeof(Discovery));
+
+      Discovery.Link = Link;
+      Link->State    = lsDiscovering;
+
+      GATTClientStatistics.Discoveries++;
+
+      if(GATT_Start_Service_Discovery(GATTClientStackID, Link->ConnectionID, 0, NULL, GATTClient_Discovery_Event_Callback, (unsigned long)Link->ConnectionID))
+      {
+         GATTClientStatistics.DiscoveryFailures++;
+
+         Link->State = lsIdle;
+
+         ReleaseDiscovery();
+      }
+   }
+}
+
+   /* The following function frees the discovery buffer and starts the   */
+   /* discovery of the next waiting link.                               */
+static void ReleaseDiscovery(void)
+{
+   unsigned int Index;
+
+   Discovery.Link = NULL;
+
+   for(Index=0;(Index<GATT_CLIENT_MAXIMUM_LINKS) && (!Discovery.Link);Index++)
+   {
+      if((Links[Index].InUse) && (Links[Index].State == lsWaiting))
+         StartDiscovery(&Links[Index]);
+   }
+}
+
+   /* The following function takes the link that owns the discovery      */
+   /* buffer through the steps after the discovery: the Database Hash is*/
+   /* read (if the server has one), Service Changed is subscribed to (if*/
+   /* the server has it) and the database is stored.  It is called when */
+   /* the discovery completes and with the answer to each step.         */
+static void ContinueSetup(Link_t *Link)
+{
+   int    Result;
+   Byte_t Value[2];
+
+   /* A Service Changed indication during the setup makes the database  */
+   /* just discovered stale.                                            */
+   if(Link->Rediscover)
+      StartDiscovery(Link);
+   else
+   {
+      Result = 0;
+
+      if(Link->State == lsDiscovering)
+      {
+         Link->ServiceChangedHandle = Discovery.ServiceChangedHandle;
+
+         if(Discovery.HashHandle)
+         {
+            Link->State = lsHashRead;
+            Result      = GATT_Read_Using_Characteristic_UUID(GATTClientStackID, Link->ConnectionID, (GATT_UUID_t *)&DatabaseHashUUID, Discovery.HashHandle, Discovery.HashHandle, GATTClient_Event_Callback, (unsigned long)Link->ConnectionID);
+         }
+      }
+
+      if((Result <= 0) && ((Link->State == lsDiscovering) || (Link->State == lsHashRead)) && (Discovery.ConfigurationHandle))
+      {
+         /* Enable the indications of Service Changed.                  */
+         ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(Value, 0x0002);
+
+         Link->State = lsSubscribing;
+         Result      = GATT_Write_Request(GATTClientStackID, Link->ConnectionID, Discovery.ConfigurationHandle, sizeof(Value), Value, GATTClient_Event_Callback, (unsigned long)Link->ConnectionID);
+      }
+
+      if(Result > 0)
+         Link->TransactionID = (unsigned int)Result;
+      else
+      {
+         /* Nothing is left to ask (or the request could not be sent),  */
+         /* the database is stored and the next link may discover.      */
+         StoreEntry(Link);
+
+         SignalReady(Link, FALSE);
+
+         ReleaseDiscovery();
+      }
+   }
+}
+
+   /* The following function is the callback of the service discovery.  */
+   /* Each service is serialized into the discovery buffer when it is   */
+   /* reported, the complete event continues the setup of the link.     */
+static void BTPSAPI GATTClient_Discovery_Event_Callback(unsigned int BluetoothStackID, GATT_Service_Discovery_Event_Data_t *GATT_Service_Discovery_Event_Data, unsigned long CallbackParameter)
+{
+   Link_t                                   *Link;
+   unsigned int                              Index;
+   unsigned int                              Number;
+   GATT_Characteristic_Information_t        *Characteristic;
+   GATT_Service_Discovery_Indication_Data_t *IndicationData;
+
+   if((GATTClientStackID) && (GATT_Service_Discovery_Event_Data) && ((Link = FindLink((unsigned int)CallbackParameter)) != NULL) && (Discovery.Link == Link) && (Link->State == lsDiscovering))
+   {
+      switch(GATT_Service_Discovery_Event_Data->Event_Data_Type)
+      {
+         case etGATT_Service_Discovery_Indication:
+            if((IndicationData = GATT_Service_Discovery_Event_Data->Event_Data.GATT_Service_Discovery_Indication_Data) != NULL)
+            {
+               EncodeRecord(RECORD_TYPE_SERVICE, IndicationData->ServiceInformation.Service_Handle, IndicationData->ServiceInformation.End_Group_Handle, 0, &(IndicationData->ServiceInformation.UUID));
+
+               for(Index=0;Index<IndicationData->NumberOfCharacteristics;Index++)
+               {
+                  Characteristic = &(IndicationData->CharacteristicInformationList[Index]);
+
+                  EncodeRecord(RECORD_TYPE_CHARACTERISTIC, Characteristic->Characteristic_Handle, 0, Characteristic->Characteristic_Properties, &(Characteristic->Characteristic_UUID));
+
+                  if(CompareUUID(&(Characteristic->Characteristic_UUID), &DatabaseHashUUID))
+                     Discovery.HashHandle = Characteristic->Characteristic_Handle;
+
+                  if(CompareUUID(&(Characteristic->Characteristic_UUID), &ServiceChangedUUID))
+                     Discovery.ServiceChangedHandle = Characteristic->Characteristic_Handle;
+
+                  for(Number=0;Number<Characteristic->NumberOfDescriptors;Number++)
+                  {
+                     EncodeRecord(RECORD_TYPE_DESCRIPTOR, Characteristic->DescriptorList[Number].Characteristic_Descriptor_Handle, 0, 0, &(Characteristic->DescriptorList[Number].Characteristic_Descriptor_UUID));
+
+                     if((Discovery.ServiceChangedHandle == Characteristic->Characteristic_Handle) && (CompareUUID(&(Characteristic->DescriptorList[Number].Characteristic_Descriptor_UUID), &ClientConfigurationUUID)))
+                        Discovery.ConfigurationHandle = Characteristic->DescriptorList[Number].Characteristic_Descriptor_Handle;
+                  }
+               }
+            }
+            break;
+         case etGATT_Service_Discovery_Complete:
+            if((GATT_Service_Discovery_Event_Data->Event_Data.GATT_Service_Discovery_Complete_Data) && (GATT_Service_Discovery_Event_Data->Event_Data.GATT_Service_Discovery_Complete_Data->Status == GATT_SERVICE_DISCOVERY_STATUS_SUCCESS))
+               ContinueSetup(Link);
+            else
+            {
+               GATTClientStatistics.DiscoveryFailures++;
+
+               if(Link->Rediscover)
+                  StartDiscovery(Link);
+               else
+               {
+                  Link->State = lsIdle;
+
+                  ReleaseDiscovery();
+               }
+            }
+            break;
+         default:
+            break;
+      }
+   }
+}
+
+   /* The following function is the callback of the requests of the      */
+   /* client (the Database Hash reads and the Service Changed           */
+   /* subscription).  Answers that are not the one the link waits for  */
+   /* are ignored.                                                      */
+static void BTPSAPI GATTClient_Event_Callback(unsigned int BluetoothStackID, GATT_Client_Event_Data_t *GATT_Client_Event_Data, unsigned long CallbackParameter)
+{
+   int                                Result;
+   Link_t                            *Link;
+   Byte_t                            *Hash;
+   unsigned int                       TransactionID;
+   GATT_Read_By_UUID_Response_Data_t *ReadData;
+
+   if((GATTClientStackID) && (GATT_Client_Event_Data) && (GATT_Client_Event_Data->Event_Data.GATT_Read_By_UUID_Response_Data) && ((Link = FindLink((unsigned int)CallbackParameter)) != NULL))
+   {
+      Hash = NULL;
+
+      switch(GATT_Client_Event_Data->Event_Data_Type)
+      {
+         case etGATT_Client_Read_By_UUID_Response:
+            ReadData      = GATT_Client_Event_Data->Event_Data.GATT_Read_By_UUID_Response_Data;
+            TransactionID = ReadData->TransactionID;
+
+            if((ReadData->NumberOfAttributes) && (ReadData->AttributeList) && (ReadData->AttributeList[0].AttributeValueLength == DATABASE_HASH_SIZE))
+               Hash = ReadData->AttributeList[0].AttributeValue;
+            break;
+         case etGATT_Client_Write_Response:
+            TransactionID = GATT_Client_Event_Data->Event_Data.GATT_Write_Response_Data->TransactionID;
+            break;
+         case etGATT_Client_Error_Response:
+            TransactionID = GATT_Client_Event_Data->Event_Data.GATT_Request_Error_Data->TransactionID;
+            break;
+         default:
+            TransactionID = 0;
+            break;
+      }
+
+      if((TransactionID) && (TransactionID == Link->TransactionID))
+      {
+         Link->TransactionID = 0;
+
+         switch(Link->State)
+         {
+            case lsHashCheck:
+               /* A server that lost its hash characteristic counts as a*/
+               /* mismatch.                                             */
+               Result = FindEntry(Link->BD_ADDR);
+
+               if((!Link->Rediscover) && (Hash) && (Result >= 0) && (!BTPS_MemCompare(CacheImage.Image.Header.Entries[Result].Hash, Hash, DATABASE_HASH_SIZE)))
+               {
+                  CacheImage.Image.Header.Entries[Result].Age = ++CacheAge;
+
+                  Link->Stored = TRUE;
+
+                  GATTClientStatistics.CacheHits++;
+
+                  SignalReady(Link, TRUE);
+               }
+               else
+               {
+                  if(!Link->Rediscover)
+                     GATTClientStatistics.HashMismatches++;
+
+                  if(Result >= 0)
+                     RemoveEntry((unsigned int)Result);
+
+                  StartDiscovery(Link);
+               }
+               break;
+            case lsHashRead:
+               if(Hash)
+               {
+                  BTPS_MemCopy(Discovery.Hash, Hash, DATABASE_HASH_SIZE);
+
+                  Discovery.HashValid = TRUE;
+               }
+
+               ContinueSetup(Link);
+               break;
+            case lsSubscribing:
+               ContinueSetup(Link);
+               break;
+            default:
+               break;
+         }
+      }
+   }
+}
+
+   /* The following function loads the cache from flash (an invalid     */
+   /* image is cleared) and starts the client on the specified stack.   */
+   /* This function returns the number of cached peers or a negative    */
+   /* error code.                                                       */
+int GATTClient_Initialize(unsigned int BluetoothStackID, GATTClient_Ready_Callback_t Callback, unsigned long CallbackParameter)
+{
+   int          ret_val;
+   unsigned int Index;
+
+   if(BluetoothStackID)
+   {
+      BTPS_MemCopy(&CacheImage, (void *)GATT_CLIENT_FLASH_ADDRESS, sizeof(CacheImage));
+
+      if((CacheImage.Image.Header.Signature != GATT_CLIENT_SIGNATURE) || (CacheImage.Image.Header.Version != GATT_CLIENT_VERSION) || (CacheImage.Image.Header.NumberEntries > GATT_CLIENT_MAXIMUM_PEERS) || (CacheBytes() > CACHE_DATA_SIZE) || (CacheImage.Image.Checksum != CalculateChecksum(&(CacheImage.Image))))
+      {
+         /* No valid image was found, start with an empty cache.        */
+         BTPS_MemInitialize(&CacheImage, 0, sizeof(CacheImage));
+
+         CacheImage.Image.Header.Signature = GATT_CLIENT_SIGNATURE;
+         CacheImage.Image.Header.Version   = GATT_CLIENT_VERSION;
+      }
+
+      /* Continue the age stamps from the most recently used entry.     */
+      for(Index=0,CacheAge=0;Index<CacheImage.Image.Header.NumberEntries;Index++)
+      {
+         if((SByte_t)(CacheImage.Image.Header.Entries[Index].Age - CacheAge) > 0)
+            CacheAge = CacheImage.Image.Header.Entries[Index].Age;
+      }
+
+      BTPS_MemInitialize(Links, 0, sizeof(Links));
+      BTPS_MemInitialize(&Discovery, 0, sizeof(Discovery));
+
+      /* Databases without a hash belonged to links that were up when   */
+      /* the image was written, they are not trusted after a restart.   */
+      for(Index=CacheImage.Image.Header.NumberEntries;Index>0;Index--)
+      {
+         if(!(CacheImage.Image.Header.Entries[Index - 1].Flags & ENTRY_FLAGS_HASH_VALID))
+            RemoveEntry(Index - 1);
+      }
+
+      CacheDirty             = FALSE;
+      GATTClientStackID      = BluetoothStackID;
+      ReadyCallback          = Callback;
+      ReadyCallbackParameter = CallbackParameter;
+
+      ret_val                = (int)CacheImage.Image.Header.NumberEntries;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function stops the client (the tracked links are    */
+   /* dropped, the cache is kept).                                      */
+void GATTClient_Cleanup(void)
+{
+   if((GATTClientStackID) && (Discovery.Link) && (Discovery.Link->State == lsDiscovering))
+      GATT_Stop_Service_Discovery(GATTClientStackID, Discovery.Link->ConnectionID);
+
+   BTPS_MemInitialize(Links, 0, sizeof(Links));
+
+   Discovery.Link    = NULL;
+   GATTClientStackID = 0;
+   ReadyCallback     = NULL;
+}
+
+   /* The following function writes the cache back to flash if it was   */
+   /* modified.  Because erasing flash stalls the processor for several */
+   /* milliseconds this function should only be called from the main    */
+   /* loop.  This function returns zero if nothing was written, a       */
+   /* positive value if the cache was written, or a negative value on   */
+   /* error (the cache stays modified and is written again on the next  */
+   /* call).                                                            */
+int GATTClient_Flush(void)
+{
+   int          ret_val = 0;
+   unsigned int Offset;
+
+   if(CacheDirty)
+   {
+      CacheImage.Image.Checksum = CalculateChecksum(&(CacheImage.Image));
+
+      /* Only rewrite the pages if the contents actually differ, this   */
+      /* saves erase cycles when an update did not change anything.     */
+      if(BTPS_MemCompare(&CacheImage, (void *)GATT_CLIENT_FLASH_ADDRESS, sizeof(CacheImage)))
+      {
+         for(Offset=0;(!ret_val) && (Offset<GATT_CLIENT_FLASH_SIZE);Offset+=GATT_CLIENT_FLASH_PAGE_SIZE)
+         {
+            if(FlashErase(GATT_CLIENT_FLASH_ADDRESS + Offset))
+               ret_val = -1;
+         }
+
+         if((!ret_val) && (!FlashProgram(CacheImage.Words, GATT_CLIENT_FLASH_ADDRESS, sizeof(CacheImage.Words))))
+         {
+            GATTClientStatistics.FlashWrites++;
+
+            ret_val = 1;
+         }
+         else
+            ret_val = -1;
+      }
+
+      /* A failed write is tried again on the next call.                */
+      if(ret_val >= 0)
+         CacheDirty = FALSE;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function removes all peers from the cache (and flags*/
+   /* the cache to be written back on the next flush).                  */
+void GATTClient_Clear(void)
+{
+   unsigned int Index;
+
+   CacheImage.Image.Header.NumberEntries = 0;
+
+   BTPS_MemInitialize(CacheImage.Image.Header.Entries, 0, sizeof(CacheImage.Image.Header.Entries));
+   BTPS_MemInitialize(CacheImage.Image.Data, 0, sizeof(CacheImage.Image.Data));
+
+   for(Index=0;Index<GATT_CLIENT_MAXIMUM_LINKS;Index++)
+      Links[Index].Stored = FALSE;
+
+   CacheDirty = TRUE;
+}
+
+   /* The following function must be called with the GAP LE events of   */
+   /* the links the local device establishes (the events of the         */
+   /* callback of GAP_LE_Create_Connection()).  Only links on which the */
+   /* local device is the master are tracked.                           */
+void GATTClient_ProcessGAPLEEvent(GAP_LE_Event_Data_t *GAP_LE_Event_Data)
+{
+   Link_t                                  *Link;
+   unsigned int                             Index;
+   GAP_LE_Connection_Complete_Event_Data_t *ConnectionData;
+
+   if((GATTClientStackID) && (GAP_LE_Event_Data) && (GAP_LE_Event_Data->Event_Data.GAP_LE_Connection_Complete_Event_Data))
+   {
+      switch(GAP_LE_Event_Data->Event_Data_Type)
+      {
+         case etLE_Connection_Complete:
+            ConnectionData = GAP_LE_Event_Data->Event_Data.GAP_LE_Connection_Complete_Event_Data;
+
+            if((!ConnectionData->Status) && (ConnectionData->Master) && (!FindLinkByAddress(ConnectionData->Peer_Address)))
+            {
+               for(Index=0;(Index<GATT_CLIENT_MAXIMUM_LINKS) && (Links[Index].InUse);Index++)
+                  ;
+
+               if(Index < GATT_CLIENT_MAXIMUM_LINKS)
+               {
+                  Link = &Links[Index];
+
+                  BTPS_MemInitialize(Link, 0, sizeof(Link_t));
+
+                  Link->InUse   = TRUE;
+                  Link->BD_ADDR = ConnectionData->Peer_Address;
+               }
+            }
+            break;
+         case etLE_Disconnection_Complete:
+            /* Links with a GATT connection are dropped with it.        */
+            if(((Link = FindLinkByAddress(GAP_LE_Event_Data->Event_Data.GAP_LE_Disconnection_Complete_Event_Data->BD_ADDR)) != NULL) && (!Link->ConnectionID))
+               Link->InUse = FALSE;
+            break;
+         default:
+            break;
+      }
+   }
+}
+
+   /* The following function must be called with the GATT connection    */
+   /* events (connections, disconnections and server indications).      */
+void GATTClient_ProcessGATTConnectionEvent(GATT_Connection_Event_Data_t *GATT_Connection_Event_Data)
+{
+   int                            Result;
+   Link_t                        *Link;
+   GATT_Device_Connection_Data_t *ConnectionData;
+   GATT_Server_Indication_Data_t *IndicationData;
+
+   if((GATTClientStackID) && (GATT_Connection_Event_Data) && (GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_Data))
+   {
+      switch(GATT_Connection_Event_Data->Event_Data_Type)
+      {
+         case etGATT_Connection_Device_Connection:
+            ConnectionData = GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_Data;
+
+            /* Only the links the local device connected as the master  */
+            /* were added (by GATTClient_ProcessGAPLEEvent()).          */
+            if((ConnectionData->ConnectionType == gctLE) && (!FindLink(ConnectionData->ConnectionID)) && ((Link = FindLinkByAddress(ConnectionData->RemoteDevice)) != NULL) && (!Link->ConnectionID))
+            {
+               Link->ConnectionID = ConnectionData->ConnectionID;
+
+               GATTClientStatistics.Connections++;
+
+               if(((Result = FindEntry(Link->BD_ADDR)) >= 0) && (CacheImage.Image.Header.Entries[Result].Flags & ENTRY_FLAGS_HASH_VALID))
+               {
+                  Link->ServiceChangedHandle = CacheImage.Image.Header.Entries[Result].ServiceChangedHandle;
+
+                  /* One read tells whether the database is still the   */
+                  /* cached one (the handle of the hash may have moved, */
+                  /* so it is read by its UUID).                        */
+                  Link->State = lsHashCheck;
+
+                  GATTClientStatistics.HashChecks++;
+
+                  if((Result = GATT_Read_Using_Characteristic_UUID(GATTClientStackID, Link->ConnectionID, (GATT_UUID_t *)&DatabaseHashUUID, 0x0001, 0xFFFF, GATTClient_Event_Callback, (unsigned long)Link->ConnectionID)) > 0)
+                     Link->TransactionID = (unsigned int)Result;
+                  else
+                     StartDiscovery(Link);
+               }
+               else
+               {
+                  if(Result >= 0)
+                     RemoveEntry((unsigned int)Result);
+
+                  StartDiscovery(Link);
+               }
+            }
+            break;
+         case etGATT_Connection_Device_Disconnection:
+            if((Link = FindLink(GATT_Connection_Event_Data->Event_Data.GATT_Device_Disconnection_Data->ConnectionID)) != NULL)
+            {
+               /* The stack ends the discovery of the link itself.  A   */
+               /* database without a hash is of no use once the link is */
+               /* down.                                                 */
+               if(((Result = FindEntry(Link->BD_ADDR)) >= 0) && (!(CacheImage.Image.Header.Entries[Result].Flags & ENTRY_FLAGS_HASH_VALID)))
+                  RemoveEntry((unsigned int)Result);
+
+               Link->InUse = FALSE;
+
+               if(Discovery.Link == Link)
+                  ReleaseDiscovery();
+            }
+            break;
+         case etGATT_Connection_Server_Indication:
+            IndicationData = GATT_Connection_Event_Data->Event_Data.GATT_Server_Indication_Data;
+
+            if((Link = FindLink(IndicationData->ConnectionID)) != NULL)
+            {
+               GATT_Handle_Value_Confirmation(GATTClientStackID, Link->ConnectionID, IndicationData->TransactionID);
+
+               /* The affected handle range is not looked at, the whole */
+               /* database is discovered again.                         */
+               if((IndicationData->AttributeHandle) && (IndicationData->AttributeHandle == Link->ServiceChangedHandle))
+               {
+                  GATTClientStatistics.ServiceChanged++;
+
+                  if((Result = FindEntry(Link->BD_ADDR)) >= 0)
+                     RemoveEntry((unsigned int)Result);
+
+                  if((Link->State == lsReady) || (Link->State == lsIdle))
+                     StartDiscovery(Link);
+                  else
+                  {
+                     if(Link->State != lsWaiting)
+                        Link->Rediscover = TRUE;
+                  }
+               }
+            }
+            break;
+         default:
+            break;
+      }
+   }
+}
+
+   /* The following function looks up a characteristic in the database  */
+   /* of the specified link (in the first service of ServiceUUID, or in */
+   /* any service if ServiceUUID is NULL).  The value handle, the       */
+   /* properties and the handle of the Client Characteristic            */
+   /* Configuration descriptor (zero if there is none) are returned     */
+   /* through the pointers that are not NULL.  This function returns    */
+   /* zero if successful or a negative value if the database of the     */
+   /* link is not known or has no such characteristic.                  */
+int GATTClient_FindCharacteristic(unsigned int ConnectionID, GATT_UUID_t *ServiceUUID, GATT_UUID_t *CharacteristicUUID, Word_t *ValueHandle, Byte_t *Properties, Word_t *ConfigurationHandle)
+{
+   int           ret_val = -1;
+   int           Result;
+   Byte_t       *Data;
+   Word_t        Handle;
+   Link_t       *Link;
+   Record_t      Record;
+   Boolean_t     InService;
+   Boolean_t     Done;
+   unsigned int  Index;
+   unsigned int  Length;
+   unsigned int  Size;
+
+   if((CharacteristicUUID) && ((Link = FindLink(ConnectionID)) != NULL) && (Link->State == lsReady) && (Link->Stored) && ((Result = FindEntry(Link->BD_ADDR)) >= 0))
+   {
+      Data      = &(CacheImage.Image.Data[EntryOffset((unsigned int)Result)]);
+      Length    = CacheImage.Image.Header.Entries[Result].Length;
+      Handle    = 0;
+      InService = FALSE;
+      Done      = FALSE;
+
+      for(Index=0;(!Done) && ((Size = DecodeRecord(&Data[Index], Length - Index, &Handle, &Record)) != 0);Index+=Size)
+      {
+         switch(Record.Type)
+         {
+            case RECORD_TYPE_SERVICE:
+               /* Only the first matching service is searched.          */
+               if((!ret_val) || ((ServiceUUID) && (InService)))
+                  Done = TRUE;
+               else
+                  InService = (Boolean_t)((!ServiceUUID) || (CompareUUID(&(Record.UUID), ServiceUUID)));
+               break;
+            case RECORD_TYPE_CHARACTERISTIC:
+               if(!ret_val)
+                  Done = TRUE;
+               else
+               {
+                  if((InService) && (CompareUUID(&(Record.UUID), CharacteristicUUID)))
+                  {
+                     if(ValueHandle)
+                        *ValueHandle = Record.Handle;
+
+                     if(Properties)
+                        *Properties = Record.Properties;
+
+                     if(ConfigurationHandle)
+                        *ConfigurationHandle = 0;
+
+                     ret_val = 0;
+                  }
+               }
+               break;
+            default:
+               if((!ret_val) && (ConfigurationHandle) && (CompareUUID(&(Record.UUID), &ClientConfigurationUUID)))
+                  *ConfigurationHandle = Record.Handle;
+               break;
+         }
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the statistics of the client.  This*/
+   /* function returns zero if successful or a negative value if the    */
+   /* parameter is invalid.                                             */
+int GATTClient_QueryStatistics(GATTClient_Statistics_t *Statistics)
+{
+   int ret_val;
+
+   if(Statistics)
+   {
+      GATTClientStatistics.Peers      = CacheImage.Image.Header.NumberEntries;
+      GATTClientStatistics.CacheBytes = CacheBytes();
+
+      *Statistics = GATTClientStatistics;
+      ret_val     = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function displays the cached peers, the links and   */
+   /* the statistics.                                                   */
+void GATTClient_Display(void)
+{
+   unsigned int  Index;
+   CacheEntry_t *Entry;
+
+   Display(("GATT Client %s:\r\n", GATTClientStackID?"running":"stopped"));
+   Display(("   %-20s %lu\r\n", "Connections", GATTClientStatistics.Connections));
+   Display(("   %-20s %lu\r\n", "Cache Hits", GATTClientStatistics.CacheHits));
+   Display(("   %-20s %lu (%lu mismatched)\r\n", "Hash Checks", GATTClientStatistics.HashChecks, GATTClientStatistics.HashMismatches));
+   Display(("   %-20s %lu\r\n", "Service Changed", GATTClientStatistics.ServiceChanged));
+   Display(("   %-20s %lu (%lu failed)\r\n", "Discoveries", GATTClientStatistics.Discoveries, GATTClientStatistics.DiscoveryFailures));
+   Display(("   %-20s %lu stored, %lu evicted, %lu too large, %lu without hash\r\n", "Databases", GATTClientStatistics.Stored, GATTClientStatistics.Evicted, GATTClientStatistics.Overflows, GATTClientStatistics.Unverified));
+   Display(("   %-20s %u of %u peers, %u of %u bytes\r\n", "Cache", CacheImage.Image.Header.NumberEntries, GATT_CLIENT_MAXIMUM_PEERS, CacheBytes(), (unsigned int)CACHE_DATA_SIZE));
+   Display(("   %-20s %u\r\n", "Flash Writes", GATTClientStatistics.FlashWrites));
+
+   for(Index=0;Index<CacheImage.Image.Header.NumberEntries;Index++)
+   {
+      Entry = &(CacheImage.Image.Header.Entries[Index]);
+
+      Display(("   %02X:%02X:%02X:%02X:%02X:%02X %4u bytes%s\r\n", Entry->BD_ADDR.BD_ADDR5, Entry->BD_ADDR.BD_ADDR4, Entry->BD_ADDR.BD_ADDR3, Entry->BD_ADDR.BD_ADDR2, Entry->BD_ADDR.BD_ADDR1, Entry->BD_ADDR.BD_ADDR0, Entry->Length, (Entry->Flags & ENTRY_FLAGS_HASH_VALID)?", hash":""));
+   }
+
+   for(Index=0;Index<GATT_CLIENT_MAXIMUM_LINKS;Index++)
+   {
+      if(Links[Index].InUse)
+         Display(("   Link %u %02X:%02X:%02X:%02X:%02X:%02X %s\r\n", Links[Index].ConnectionID, Links[Index].BD_ADDR.BD_ADDR5, Links[Index].BD_ADDR.BD_ADDR4, Links[Index].BD_ADDR.BD_ADDR3, Links[Index].BD_ADDR.BD_ADDR2, Links[Index].BD_ADDR.BD_ADDR1, Links[Index].BD_ADDR.BD_ADDR0, StateNames[Links[Index].State]));
+   }
+}
+
+#endif
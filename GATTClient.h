@@ -0,0 +1,164 @@
+/*****< gattclient.h >*********************************************************/
+/*                                                                            */
+/*  GATTClient - GATT client role with a per-peer discovery cache.            */
+/*                                                                            */
+/*  The attribute database of the remote server (its primary services with    */
+/*  their characteristics and descriptors) is discovered when the local       */
+/*  device connected to it as the master, links of centrals that connected    */
+/*  to the local server are not tracked.  The database is kept in flash in a  */
+/*  compact serialized form (a few bytes per attribute instead of the         */
+/*  discovery structures of the stack).  A reconnect to a known peer reads    */
+/*  its Database Hash (one Read By Type request) and compares it with the     */
+/*  cached one, a match skips the discovery, a mismatch drops the entry and   */
+/*  the database is discovered again.                                         */
+/*                                                                            */
+/*  Only databases with a Database Hash are cached.  Without one the client   */
+/*  could only trust a cached database if it was told about every change      */
+/*  with Service Changed, which a server only does for bonded clients, and    */
+/*  the application has no LE bonding.  Such servers are discovered at every  */
+/*  connection, their database is only kept while the link is up (it is not  */
+/*  written to flash).                                                        */
+/*                                                                            */
+/*  A Service Changed indication drops the entry of the peer and the          */
+/*  database is discovered again.  Only one discovery runs at a time (the     */
+/*  results are collected in one buffer), other links wait for it.  Peers     */
+/*  are identified by their address (a peer with a resolvable private         */
+/*  address is discovered again whenever its address changes).                */
+/*                                                                            */
+/*  The client is only compiled in if GATT_CLIENT_ENABLE is defined (the      */
+/*  GATT_CLIENT option of CMakeLists.txt).  The demo only connects as the     */
+/*  slave, so by default the 2.7 KB of RAM of the cache image and the         */
+/*  discovery buffer are left to the rest of the image (see NoOS/Budget.txt). */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __GATTCLIENTH__
+#define __GATTCLIENTH__
+
+#include "SS1BTPS.h"       /* Includes for the SS1 Bluetooth Protocol Stack.  */
+#include "GATTAPI.h"       /* Includes for the GATT API.                      */
+
+#ifndef GATT_CLIENT_MAXIMUM_LINKS
+
+#define GATT_CLIENT_MAXIMUM_LINKS                    (4)  /* Denotes the number*/
+                                                         /* of LE links whose */
+                                                         /* database is       */
+                                                         /* tracked.          */
+
+#endif
+
+#define GATT_CLIENT_MAXIMUM_PEERS                    (8)  /* Denotes the number*/
+                                                         /* of peers whose    */
+                                                         /* database is       */
+                                                         /* cached.           */
+
+#define GATT_CLIENT_MAXIMUM_DATABASE_SIZE          (512)  /* Denotes the       */
+                                                         /* largest serialized*/
+                                                         /* database that is  */
+                                                         /* cached (the size  */
+                                                         /* of the discovery  */
+                                                         /* buffer).          */
+
+#ifndef GATT_CLIENT_FLASH_ADDRESS
+
+#define GATT_CLIENT_FLASH_ADDRESS          (0x0003F400)  /* Denotes the flash */
+                                                         /* pages that hold   */
+                                                         /* the cache (below  */
+                                                         /* the page of the   */
+                                                         /* Peer Cache).      */
+                                                         /* These pages are   */
+                                                         /* removed from the  */
+                                                         /* FLASH region in   */
+                                                         /* the linker files. */
+
+#endif
+
+#define GATT_CLIENT_FLASH_SIZE                  (0x0800)  /* Denotes the size  */
+#define GATT_CLIENT_FLASH_PAGE_SIZE             (0x0400)  /* of the cache and  */
+                                                         /* the flash erase   */
+                                                         /* block size.       */
+
+   /* The following type definition represents the function that is     */
+   /* called once the database of a link is known (Cached is TRUE if it */
+   /* came from the cache without a discovery).  It is called again     */
+   /* after the database was discovered anew (Service Changed).         */
+typedef void (*GATTClient_Ready_Callback_t)(unsigned int ConnectionID, BD_ADDR_t BD_ADDR, Boolean_t Cached, unsigned long CallbackParameter);
+
+   /* The following structure holds the statistics of the client.       */
+   /* CacheHits counts the connections that skipped the discovery,      */
+   /* Overflows the databases that did not fit into the cache and       */
+   /* Unverified the ones that were not cached (no Database Hash).      */
+typedef struct _tagGATTClient_Statistics_t
+{
+   unsigned long Connections;
+   unsigned long CacheHits;
+   unsigned long HashChecks;
+   unsigned long HashMismatches;
+   unsigned long ServiceChanged;
+   unsigned long Discoveries;
+   unsigned long DiscoveryFailures;
+   unsigned long Stored;
+   unsigned long Evicted;
+   unsigned long Overflows;
+   unsigned long Unverified;
+   unsigned int  FlashWrites;
+   unsigned int  Peers;
+   unsigned int  CacheBytes;
+} GATTClient_Statistics_t;
+
+#ifdef GATT_CLIENT_ENABLE
+
+   /* The following function loads the cache from flash (an invalid     */
+   /* image is cleared) and starts the client on the specified stack.   */
+   /* This function returns the number of cached peers or a negative    */
+   /* error code.                                                       */
+int GATTClient_Initialize(unsigned int BluetoothStackID, GATTClient_Ready_Callback_t Callback, unsigned long CallbackParameter);
+
+   /* The following function stops the client (the tracked links are    */
+   /* dropped, the cache is kept).                                      */
+void GATTClient_Cleanup(void);
+
+   /* The following function writes the cache back to flash if it was   */
+   /* modified.  Because erasing flash stalls the processor for several */
+   /* milliseconds this function should only be called from the main    */
+   /* loop.  This function returns zero if nothing was written, a       */
+   /* positive value if the cache was written, or a negative value on   */
+   /* error (the cache stays modified and is written again on the next  */
+   /* call).                                                            */
+int GATTClient_Flush(void);
+
+   /* The following function removes all peers from the cache (and flags*/
+   /* the cache to be written back on the next flush).                  */
+void GATTClient_Clear(void);
+
+   /* The following function must be called with the GAP LE events of   */
+   /* the links the local device establishes (the events of the         */
+   /* callback of GAP_LE_Create_Connection()).  Only links on which the */
+   /* local device is the master are tracked.                           */
+void GATTClient_ProcessGAPLEEvent(GAP_LE_Event_Data_t *GAP_LE_Event_Data);
+
+   /* The following function must be called with the GATT connection    */
+   /* events (connections, disconnections and server indications).      */
+void GATTClient_ProcessGATTConnectionEvent(GATT_Connection_Event_Data_t *GATT_Connection_Event_Data);
+
+   /* The following function looks up a characteristic in the database  */
+   /* of the specified link (in the first service of ServiceUUID, or in */
+   /* any service if ServiceUUID is NULL).  The value handle, the       */
+   /* properties and the handle of the Client Characteristic            */
+   /* Configuration descriptor (zero if there is none) are returned     */
+   /* through the pointers that are not NULL.  This function returns    */
+   /* zero if successful or a negative value if the database of the     */
+   /* link is not known or has no such characteristic.                  */
+int GATTClient_FindCharacteristic(unsigned int ConnectionID, GATT_UUID_t *ServiceUUID, GATT_UUID_t *CharacteristicUUID, Word_t *ValueHandle, Byte_t *Properties, Word_t *ConfigurationHandle);
+
+   /* The following function returns the statistics of the client.  This*/
+   /* function returns zero if successful or a negative value if the    */
+   /* parameter is invalid.                                             */
+int GATTClient_QueryStatistics(GATTClient_Statistics_t *Statistics);
+
+   /* The following function displays the cached peers, the links and   */
+   /* the statistics.                                                   */
+void GATTClient_Display(void);
+
+#endif
+
+#endif
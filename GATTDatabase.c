@@ -0,0 +1,752 @@
+/*****< gattdatabase.c >*******************************************************/
+/*                                                                            */
+/*  GATTDatabase - Database Hash and Service Changed of the GATT server.      */
+/*                                                                            */
+/******************************************************************************/
+#include <stdint.h>        /* Included for TivaWare driver library types.     */
+#include <stdbool.h>       /* Included for TivaWare driver library types.     */
+#include "Main.h"          /* Application Interface Abstraction.              */
+#include "GATTDatabase.h"  /* GATT Database Prototypes/Constants.             */
+#include "GATTHash.h"      /* Generated Database Hash.                        */
+#include "GATTUUID.h"      /* GATT UUID Prototypes/Constants.                 */
+#include "ConnParam.h"     /* Connection Parameter Policy.                    */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+#include "driverlib/flash.h" /* TivaWare Flash Driver Prototypes.             */
+
+#define GATT_DATABASE_SIGNATURE                  (0x47444253)  /* "GDBS"      */
+
+#define GATT_DATABASE_VERSION                        (0x0001)
+
+#define CLIENT_FLAGS_PENDING                           (0x01)
+
+   /* The following constants define the attributes of the Generic      */
+   /* Attribute service (offsets in ServiceTable).                      */
+#define SERVICE_ATTRIBUTE_OFFSET                          (0)
+#define SERVICE_CHANGED_DECLARATION_OFFSET                (1)
+#define SERVICE_CHANGED_VALUE_OFFSET                      (2)
+#define SERVICE_CHANGED_CONFIGURATION_OFFSET              (3)
+#define DATABASE_HASH_DECLARATION_OFFSET                  (4)
+#define DATABASE_HASH_VALUE_OFFSET                        (5)
+#define NUMBER_SERVICE_ATTRIBUTES                         (6)
+
+   /* The following constants are the attribute types that are part of  */
+   /* the hash input.                                                   */
+#define ATTRIBUTE_TYPE_PRIMARY_SERVICE               (0x2800)
+#define ATTRIBUTE_TYPE_SECONDARY_SERVICE             (0x2801)
+#define ATTRIBUTE_TYPE_CHARACTERISTIC                (0x2803)
+#define ATTRIBUTE_TYPE_EXTENDED_PROPERTIES           (0x2900)
+#define ATTRIBUTE_TYPE_FIRST_HASHED_DESCRIPTOR       (0x2901)
+#define ATTRIBUTE_TYPE_LAST_HASHED_DESCRIPTOR        (0x2905)
+
+   /* The following type definition represents the subscription of a    */
+   /* client.  Configuration is the value of its Client Characteristic  */
+   /* Configuration descriptor of Service Changed.                      */
+typedef struct _tagClientEntry_t
+{
+   BD_ADDR_t BD_ADDR;
+   Byte_t    Flags;
+   Byte_t    Age;
+   Word_t    Configuration;
+} ClientEntry_t;
+
+   /* The following type definition represents the image of the state   */
+   /* that is stored in flash.  Layout is the checksum of the hash input*/
+   /* of the database the clients were last told about.                 */
+typedef struct _tagDatabaseImage_t
+{
+   DWord_t       Signature;
+   Word_t        Version;
+   Word_t        NumberClients;
+   DWord_t       Layout;
+   ClientEntry_t Clients[GATT_DATABASE_MAXIMUM_CLIENTS];
+   DWord_t       Checksum;
+} DatabaseImage_t;
+
+   /* The flash can only be programmed a word at a time so the image is */
+   /* built in a word aligned buffer that is rounded up to a word.      */
+#define DATABASE_IMAGE_WORDS                             ((sizeof(DatabaseImage_t) + sizeof(uint32_t) - 1)/sizeof(uint32_t))
+
+typedef union _tagDatabaseImageBuffer_t
+{
+   DatabaseImage_t Image;
+   uint32_t        Words[DATABASE_IMAGE_WORDS];
+} DatabaseImageBuffer_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static unsigned int            GATTDatabaseStackID; /* Variable which holds the*/
+                                                    /* stack the module runs   */
+                                                    /* on (zero if stopped).   */
+
+static unsigned int            GATTServiceID;       /* Variable which holds the*/
+                                                    /* ID of the Generic       */
+                                                    /* Attribute service.      */
+
+static DatabaseImageBuffer_t   DatabaseImage;       /* Variable which holds the*/
+                                                    /* RAM copy of the state.  */
+
+static Boolean_t               ImageDirty;          /* Variable which flags    */
+                                                    /* that the state must be  */
+                                                    /* written back to flash.  */
+
+static Byte_t                  ClientAge;           /* Variable which holds the*/
+                                                    /* current age stamp given */
+                                                    /* to clients when seen.   */
+
+static Word_t                  NextHandle;          /* Variable which holds the*/
+                                                    /* handle the next service */
+                                                    /* is placed at.           */
+
+static DWord_t                 Layout;              /* Variable which holds the*/
+                                                    /* checksum of the hash    */
+                                                    /* input of the services   */
+                                                    /* registered so far.      */
+
+static GATTDatabase_Statistics_t GATTDatabaseStatistics; /* Variable which    */
+                                                    /* holds the statistics.   */
+
+static GATT_Service_Attribute_Entry_t ServiceTable[NUMBER_SERVICE_ATTRIBUTES];
+static GATTUUID_Entry_Value_t  ServiceValues[NUMBER_SERVICE_ATTRIBUTES];
+                                                    /* Variables which hold the*/
+                                                    /* Generic Attribute       */
+                                                    /* service (the stack keeps*/
+                                                    /* the pointers).          */
+
+static Byte_t                  ServiceChangedValue[4]; /* Variables which hold */
+static Byte_t                  ConfigurationValue[2]; /* the values of the     */
+                                                    /* table (the reads are    */
+                                                    /* answered by the module).*/
+
+static const Byte_t DatabaseHash[GATT_DATABASE_HASH_SIZE] = GATT_HASH_INITIALIZER;
+
+static const GATT_UUID_t GenericAttributeUUID    = GATT_UUID_16_INITIALIZER(0x1801);
+static const GATT_UUID_t ServiceChangedUUID      = GATT_UUID_16_INITIALIZER(0x2A05);
+static const GATT_UUID_t ClientConfigurationUUID = GATT_UUID_16_INITIALIZER(0x2902);
+static const GATT_UUID_t DatabaseHashUUID        = GATT_UUID_16_INITIALIZER(0x2B2A);
+
+   /* Internal function prototypes.                                     */
+static DWord_t CalculateChecksum(DatabaseImage_t *Image);
+static int FindClient(BD_ADDR_t BD_ADDR);
+static void RemoveClient(unsigned int Index);
+static void StoreConfiguration(BD_ADDR_t BD_ADDR, Word_t Configuration);
+static unsigned int CountPending(void);
+static void SendServiceChanged(unsigned int ConnectionID, BD_ADDR_t BD_ADDR);
+static void BTPSAPI GATTDatabase_Server_Event_Callback(unsigned int BluetoothStackID, GATT_Server_Event_Data_t *GATT_Server_Event_Data, unsigned long CallbackParameter);
+
+   /* The following function calculates the checksum of the state image */
+   /* (excluding the checksum itself).                                  */
+static DWord_t CalculateChecksum(DatabaseImage_t *Image)
+{
+   DWord_t       ret_val = 0;
+   Byte_t       *Data    = (Byte_t *)Image;
+   unsigned int  Index;
+
+   for(Index=0;Index<(unsigned int)((Byte_t *)&(Image->Checksum) - Data);Index++)
+      ret_val = ((ret_val << 5) | (ret_val >> 27)) ^ Data[Index];
+
+   return(ret_val);
+}
+
+   /* The following function searches the subscribed clients for the    */
+   /* specified device.  This function returns the index of the client  */
+   /* or a negative value if the device is not known.                   */
+static int FindClient(BD_ADDR_t BD_ADDR)
+{
+   int          ret_val = -1;
+   unsigned int Index;
+
+   for(Index=0;(Index<DatabaseImage.Image.NumberClients) && (ret_val < 0);Index++)
+   {
+      if(COMPARE_BD_ADDR(DatabaseImage.Image.Clients[Index].BD_ADDR, BD_ADDR))
+         ret_val = (int)Index;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function removes the specified client.              */
+static void RemoveClient(unsigned int Index)
+{
+   if(Index < DatabaseImage.Image.NumberClients)
+   {
+      BTPS_MemMove(&(DatabaseImage.Image.Clients[Index]), &(DatabaseImage.Image.Clients[Index + 1]), (DatabaseImage.Image.NumberClients - (Index + 1)) * sizeof(ClientEntry_t));
+
+      DatabaseImage.Image.NumberClients--;
+
+      /* Clear the freed entry so the image does not depend on what was */
+      /* removed.                                                       */
+      BTPS_MemInitialize(&(DatabaseImage.Image.Clients[DatabaseImage.Image.NumberClients]), 0, sizeof(ClientEntry_t));
+
+      ImageDirty = TRUE;
+   }
+}
+
+   /* The following function stores the configuration a client wrote to */
+   /* the Service Changed descriptor.  A client that turns it off is    */
+   /* removed, a new client takes the place of the least recently seen  */
+   /* one if all are in use.  A pending indication is kept (the client  */
+   /* may have subscribed from a cached database).                      */
+static void StoreConfiguration(BD_ADDR_t BD_ADDR, Word_t Configuration)
+{
+   int            Result;
+   unsigned int   Index;
+   ClientEntry_t *Entry;
+
+   if((Result = FindClient(BD_ADDR)) < 0)
+   {
+      if(Configuration)
+      {
+         if(DatabaseImage.Image.NumberClients == GATT_DATABASE_MAXIMUM_CLIENTS)
+         {
+            /* The age stamp wraps so compare distances from the current*/
+            /* stamp.                                                   */
+            for(Index=1,Result=0;Index<DatabaseImage.Image.NumberClients;Index++)
+            {
+               if((Byte_t)(ClientAge - DatabaseImage.Image.Clients[Index].Age) > (Byte_t)(ClientAge - DatabaseImage.Image.Clients[Result].Age))
+                  Result = (int)Index;
+            }
+
+            RemoveClient((unsigned int)Result);
+
+            GATTDatabaseStatistics.Evicted++;
+         }
+
+         Entry = &(DatabaseImage.Image.Clients[DatabaseImage.Image.NumberClients++]);
+
+         BTPS_MemInitialize(Entry, 0, sizeof(ClientEntry_t));
+
+         Entry->BD_ADDR       = BD_ADDR;
+         Entry->Age           = ++ClientAge;
+         Entry->Configuration = Configuration;
+         ImageDirty           = TRUE;
+
+         GATTDatabaseStatistics.Subscriptions++;
+      }
+   }
+   else
+   {
+      if(Configuration)
+      {
+         Entry      = &(DatabaseImage.Image.Clients[Result]);
+         Entry->Age = ++ClientAge;
+
+         if(Entry->Configuration != Configuration)
+         {
+            Entry->Configuration = Configuration;
+            ImageDirty           = TRUE;
+
+            GATTDatabaseStatistics.Subscriptions++;
+         }
+      }
+      else
+         RemoveClient((unsigned int)Result);
+   }
+}
+
+   /* The following function returns the number of clients that still   */
+   /* have to be told about a change.                                   */
+static unsigned int CountPending(void)
+{
+   unsigned int ret_val;
+   unsigned int Index;
+
+   for(Index=0,ret_val=0;Index<DatabaseImage.Image.NumberClients;Index++)
+   {
+      if(DatabaseImage.Image.Clients[Index].Flags & CLIENT_FLAGS_PENDING)
+         ret_val++;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function sends the Service Changed indication on the*/
+   /* specified link.  The whole handle range is reported as affected   */
+   /* (the previous layout is not known).  An indication the stack could*/
+   /* not queue is sent again when the buffer of the link is empty, the */
+   /* connection parameter policy keeps the link fast until then.       */
+static void SendServiceChanged(unsigned int ConnectionID, BD_ADDR_t BD_ADDR)
+{
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&ServiceChangedValue[0], 0x0001);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&ServiceChangedValue[2], 0xFFFF);
+
+   if(GATT_Handle_Value_Indication(GATTDatabaseStackID, GATTServiceID, ConnectionID, SERVICE_CHANGED_VALUE_OFFSET, sizeof(ServiceChangedValue), ServiceChangedValue) > 0)
+      GATTDatabaseStatistics.Indications++;
+   else
+   {
+      GATTDatabaseStatistics.Deferred++;
+
+      ConnParam_NoteBacklog(BD_ADDR);
+   }
+}
+
+   /* The following function is the server event callback of the Generic*/
+   /* Attribute service.  The configuration of Service Changed is kept  */
+   /* per client, the hash is only readable if GATTHash.h matches the   */
+   /* database and a confirmed indication ends the pending state of the */
+   /* client.                                                           */
+static void BTPSAPI GATTDatabase_Server_Event_Callback(unsigned int BluetoothStackID, GATT_Server_Event_Data_t *GATT_Server_Event_Data, unsigned long CallbackParameter)
+{
+   int                        Result;
+   Word_t                     Configuration;
+   GATT_Read_Request_Data_t  *ReadData;
+   GATT_Write_Request_Data_t *WriteData;
+   GATT_Confirmation_Data_t  *ConfirmationData;
+
+   if((GATT_Server_Event_Data) && (GATT_Server_Event_Data->Event_Data.GATT_Read_Request_Data))
+   {
+      switch(GATT_Server_Event_Data->Event_Data_Type)
+      {
+         case etGATT_Server_Read_Request:
+            ReadData = GATT_Server_Event_Data->Event_Data.GATT_Read_Request_Data;
+
+            if(ReadData->AttributeOffset == SERVICE_CHANGED_CONFIGURATION_OFFSET)
+            {
+               Configuration = (Word_t)(((Result = FindClient(ReadData->RemoteDevice)) >= 0)?DatabaseImage.Image.Clients[Result].Configuration:0);
+
+               ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(ConfigurationValue, Configuration);
+
+               if(ReadData->AttributeValueOffset <= sizeof(ConfigurationValue))
+                  GATT_Read_Response(BluetoothStackID, ReadData->TransactionID, sizeof(ConfigurationValue) - ReadData->AttributeValueOffset, &ConfigurationValue[ReadData->AttributeValueOffset]);
+               else
+                  GATT_Error_Response(BluetoothStackID, ReadData->TransactionID, ReadData->AttributeOffset, ATT_PROTOCOL_ERROR_CODE_INVALID_OFFSET);
+            }
+            else
+            {
+               if((ReadData->AttributeOffset == DATABASE_HASH_VALUE_OFFSET) && (GATTDatabaseStatistics.HashValid))
+               {
+                  GATTDatabaseStatistics.HashReads++;
+
+                  if(ReadData->AttributeValueOffset <= GATT_DATABASE_HASH_SIZE)
+                     GATT_Read_Response(BluetoothStackID, ReadData->TransactionID, GATT_DATABASE_HASH_SIZE - ReadData->AttributeValueOffset, (Byte_t *)&DatabaseHash[ReadData->AttributeValueOffset]);
+                  else
+                     GATT_Error_Response(BluetoothStackID, ReadData->TransactionID, ReadData->AttributeOffset, ATT_PROTOCOL_ERROR_CODE_INVALID_OFFSET);
+               }
+               else
+                  GATT_Error_Response(BluetoothStackID, ReadData->TransactionID, ReadData->AttributeOffset, ATT_PROTOCOL_ERROR_CODE_READ_NOT_PERMITTED);
+            }
+            break;
+         case etGATT_Server_Write_Request:
+            WriteData = GATT_Server_Event_Data->Event_Data.GATT_Write_Request_Data;
+
+            if(WriteData->AttributeOffset == SERVICE_CHANGED_CONFIGURATION_OFFSET)
+            {
+               if((WriteData->AttributeValueLength == sizeof(ConfigurationValue)) && (WriteData->AttributeValue))
+               {
+                  StoreConfiguration(WriteData->RemoteDevice, READ_UNALIGNED_WORD_LITTLE_ENDIAN(WriteData->AttributeValue));
+
+                  if(WriteData->TransactionID)
+                     GATT_Write_Response(BluetoothStackID, WriteData->TransactionID);
+               }
+               else
+               {
+                  if(WriteData->TransactionID)
+                     GATT_Error_Response(BluetoothStackID, WriteData->TransactionID, WriteData->AttributeOffset, ATT_PROTOCOL_ERROR_CODE_INVALID_ATTRIBUTE_VALUE_LENGTH);
+               }
+            }
+            else
+            {
+               if(WriteData->TransactionID)
+                  GATT_Error_Response(BluetoothStackID, WriteData->TransactionID, WriteData->AttributeOffset, ATT_PROTOCOL_ERROR_CODE_WRITE_NOT_PERMITTED);
+            }
+            break;
+         case etGATT_Server_Confirmation_Response:
+            ConfirmationData = GATT_Server_Event_Data->Event_Data.GATT_Confirmation_Data;
+
+            if((ConfirmationData->Status == GATT_CONFIRMATION_STATUS_SUCCESS) && ((Result = FindClient(ConfirmationData->RemoteDevice)) >= 0))
+            {
+               GATTDatabaseStatistics.Confirmations++;
+
+               if(DatabaseImage.Image.Clients[Result].Flags & CLIENT_FLAGS_PENDING)
+               {
+                  DatabaseImage.Image.Clients[Result].Flags &= (Byte_t)~CLIENT_FLAGS_PENDING;
+
+                  ImageDirty = TRUE;
+               }
+            }
+            break;
+         default:
+            break;
+      }
+   }
+}
+
+   /* The following function loads the state from flash (an invalid     */
+   /* image is cleared) and registers the Generic Attribute service.  It*/
+   /* must be called after GATT_Initialize() and before the services of */
+   /* the application are registered.  This function returns the number */
+   /* of subscribed clients or a negative error code.                   */
+int GATTDatabase_Initialize(unsigned int BluetoothStackID)
+{
+   int          ret_val;
+   unsigned int Index;
+
+   if(BluetoothStackID)
+   {
+      BTPS_MemCopy(&DatabaseImage, (void *)GATT_DATABASE_FLASH_ADDRESS, sizeof(DatabaseImage));
+
+      if((DatabaseImage.Image.Signature != GATT_DATABASE_SIGNATURE) || (DatabaseImage.Image.Version != GATT_DATABASE_VERSION) || (DatabaseImage.Image.NumberClients > GATT_DATABASE_MAXIMUM_CLIENTS) || (DatabaseImage.Image.Checksum != CalculateChecksum(&(DatabaseImage.Image))))
+      {
+         /* No valid image was found, start without clients.            */
+         BTPS_MemInitialize(&DatabaseImage, 0, sizeof(DatabaseImage));
+
+         DatabaseImage.Image.Signature = GATT_DATABASE_SIGNATURE;
+         DatabaseImage.Image.Version   = GATT_DATABASE_VERSION;
+      }
+
+      /* Continue the age stamps from the most recently seen client.    */
+      for(Index=0,ClientAge=0;Index<DatabaseImage.Image.NumberClients;Index++)
+      {
+         if((SByte_t)(DatabaseImage.Image.Clients[Index].Age - ClientAge) > 0)
+            ClientAge = DatabaseImage.Image.Clients[Index].Age;
+      }
+
+      ImageDirty                        = FALSE;
+      NextHandle                        = GATT_DATABASE_STARTING_HANDLE;
+      Layout                            = 0;
+      GATTDatabaseStatistics.Services   = 0;
+      GATTDatabaseStatistics.Attributes = 0;
+      GATTDatabaseStatistics.HashValid  = FALSE;
+      GATTDatabaseStatistics.Changed    = FALSE;
+
+      /* The values are answered by the callback, the table only needs  */
+      /* their sizes.                                                   */
+      GATTUUID_AssignPrimaryService(&ServiceTable[SERVICE_ATTRIBUTE_OFFSET], &ServiceValues[SERVICE_ATTRIBUTE_OFFSET], &GenericAttributeUUID);
+      GATTUUID_AssignCharacteristicDeclaration(&ServiceTable[SERVICE_CHANGED_DECLARATION_OFFSET], &ServiceValues[SERVICE_CHANGED_DECLARATION_OFFSET], &ServiceChangedUUID, GATT_CHARACTERISTIC_PROPERTIES_INDICATE);
+      GATTUUID_AssignCharacteristicValue(&ServiceTable[SERVICE_CHANGED_VALUE_OFFSET], &ServiceValues[SERVICE_CHANGED_VALUE_OFFSET], &ServiceChangedUUID, 0, sizeof(ServiceChangedValue), ServiceChangedValue);
+      GATTUUID_AssignCharacteristicDescriptor(&ServiceTable[SERVICE_CHANGED_CONFIGURATION_OFFSET], &ServiceValues[SERVICE_CHANGED_CONFIGURATION_OFFSET], &ClientConfigurationUUID, GATT_ATTRIBUTE_FLAGS_READABLE_WRITABLE, sizeof(ConfigurationValue), ConfigurationValue);
+      GATTUUID_AssignCharacteristicDeclaration(&ServiceTable[DATABASE_HASH_DECLARATION_OFFSET], &ServiceValues[DATABASE_HASH_DECLARATION_OFFSET], &DatabaseHashUUID, GATT_CHARACTERISTIC_PROPERTIES_READ);
+      GATTUUID_AssignCharacteristicValue(&ServiceTable[DATABASE_HASH_VALUE_OFFSET], &ServiceValues[DATABASE_HASH_VALUE_OFFSET], &DatabaseHashUUID, GATT_ATTRIBUTE_FLAGS_READABLE, GATT_DATABASE_HASH_SIZE, (Byte_t *)DatabaseHash);
+
+      GATTDatabaseStackID = BluetoothStackID;
+
+      if((ret_val = GATTDatabase_RegisterService(BluetoothStackID, GATT_SERVICE_FLAGS_LE_SERVICE, NUMBER_SERVICE_ATTRIBUTES, ServiceTable, NULL, GATTDatabase_Server_Event_Callback, 0)) > 0)
+      {
+         GATTServiceID = (unsigned int)ret_val;
+         ret_val       = (int)DatabaseImage.Image.NumberClients;
+      }
+      else
+         GATTDatabaseStackID = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function registers a service of the application (the*/
+   /* parameters are the ones of GATT_Register_Service(), the handle    */
+   /* group result may be NULL).  The service is placed behind the      */
+   /* previous one.  This function returns the service ID or a negative */
+   /* error code.                                                       */
+int GATTDatabase_RegisterService(unsigned int BluetoothStackID, Byte_t ServiceFlags, unsigned int NumberOfServiceAttributeEntries, GATT_Service_Attribute_Entry_t *ServiceTable, GATT_Attribute_Handle_Group_t *ServiceHandleGroupResult, GATT_Server_Event_Callback_t ServerEventCallback, unsigned long CallbackParameter)
+{
+   int                           ret_val;
+   Byte_t                        HashInput[GATT_DATABASE_MAXIMUM_HASH_INPUT];
+   unsigned int                  Index;
+   unsigned int                  Offset;
+   unsigned int                  Length;
+   GATT_Attribute_Handle_Group_t HandleGroup;
+
+   if((GATTDatabaseStackID) && (BluetoothStackID == GATTDatabaseStackID) && (NumberOfServiceAttributeEntries) && (ServiceTable))
+   {
+      /* Ask for the handles right behind the previous service, so a    */
+      /* service only moves if one in front of it changed.              */
+      HandleGroup.Starting_Handle = NextHandle;
+      HandleGroup.Ending_Handle   = (Word_t)(NextHandle + NumberOfServiceAttributeEntries - 1);
+
+      if((ret_val = GATT_Register_Service(BluetoothStackID, ServiceFlags, NumberOfServiceAttributeEntries, ServiceTable, &HandleGroup, ServerEventCallback, CallbackParameter)) > 0)
+      {
+         /* The checksum follows the handles the stack actually used.   */
+         for(Index=0;Index<NumberOfServiceAttributeEntries;Index++)
+         {
+            Length = GATTDatabase_HashInput((Word_t)(HandleGroup.Starting_Handle + Index), &ServiceTable[Index], HashInput);
+
+            for(Offset=0;Offset<Length;Offset++)
+               Layout = ((Layout << 5) | (Layout >> 27)) ^ HashInput[Offset];
+         }
+
+         NextHandle = (Word_t)(HandleGroup.Ending_Handle + 1);
+
+         GATTDatabaseStatistics.Services++;
+         GATTDatabaseStatistics.Attributes += NumberOfServiceAttributeEntries;
+
+         if(ServiceHandleGroupResult)
+            *ServiceHandleGroupResult = HandleGroup;
+      }
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function must be called once all services are       */
+   /* registered.  It compares the database with the one of the last    */
+   /* boot and, if it changed, flags the subscribed clients for a       */
+   /* Service Changed indication.  This function returns the number of  */
+   /* clients that will be told or a negative error code.               */
+int GATTDatabase_Publish(void)
+{
+   int          ret_val;
+   unsigned int Index;
+
+   if(GATTDatabaseStackID)
+   {
+      GATTDatabaseStatistics.Layout    = Layout;
+      GATTDatabaseStatistics.HashValid = (Boolean_t)(Layout == GATT_HASH_LAYOUT);
+
+      if(DatabaseImage.Image.Layout != Layout)
+      {
+         for(Index=0;Index<DatabaseImage.Image.NumberClients;Index++)
+         {
+            if(DatabaseImage.Image.Clients[Index].Configuration & GATT_CLIENT_CONFIGURATION_CHARACTERISTIC_INDICATE_ENABLE)
+               DatabaseImage.Image.Clients[Index].Flags |= CLIENT_FLAGS_PENDING;
+         }
+
+         DatabaseImage.Image.Layout     = Layout;
+         ImageDirty                     = TRUE;
+         GATTDatabaseStatistics.Changed = TRUE;
+      }
+
+      ret_val = (int)CountPending();
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function stops the module (the state in flash is    */
+   /* kept).                                                            */
+void GATTDatabase_Cleanup(void)
+{
+   GATTDatabaseStackID = 0;
+   GATTServiceID       = 0;
+}
+
+   /* The following function writes the state back to flash if it was   */
+   /* modified.  Because erasing flash stalls the processor for several */
+   /* milliseconds this function should only be called from the main    */
+   /* loop.  This function returns zero if nothing was written, a       */
+   /* positive value if the state was written, or a negative value on   */
+   /* error.                                                            */
+int GATTDatabase_Flush(void)
+{
+   int ret_val = 0;
+
+   if(ImageDirty)
+   {
+      DatabaseImage.Image.Checksum = CalculateChecksum(&(DatabaseImage.Image));
+
+      /* Only rewrite the page if the contents actually differ, this    */
+      /* saves erase cycles when an update did not change anything.     */
+      if(BTPS_MemCompare(&DatabaseImage, (void *)GATT_DATABASE_FLASH_ADDRESS, sizeof(DatabaseImage)))
+      {
+         if((!FlashErase(GATT_DATABASE_FLASH_ADDRESS)) && (!FlashProgram(DatabaseImage.Words, GATT_DATABASE_FLASH_ADDRESS, sizeof(DatabaseImage.Words))))
+         {
+            GATTDatabaseStatistics.FlashWrites++;
+
+            ret_val = 1;
+         }
+         else
+            ret_val = -1;
+      }
+
+      ImageDirty = FALSE;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function must be called with the GATT connection    */
+   /* events (a pending client is sent the indication when it connects, */
+   /* or when the buffer of its link drained after a deferred send).    */
+void GATTDatabase_ProcessGATTConnectionEvent(GATT_Connection_Event_Data_t *GATT_Connection_Event_Data)
+{
+   int                              Result;
+   ClientEntry_t                   *Entry;
+   GATT_Device_Connection_Data_t   *ConnectionData;
+   GATT_Device_Buffer_Empty_Data_t *BufferEmptyData;
+
+   if((GATTDatabaseStackID) && (GATT_Connection_Event_Data) && (GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_Data))
+   {
+      switch(GATT_Connection_Event_Data->Event_Data_Type)
+      {
+         case etGATT_Connection_Device_Connection:
+            ConnectionData = GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_Data;
+
+            if((ConnectionData->ConnectionType == gctLE) && ((Result = FindClient(ConnectionData->RemoteDevice)) >= 0))
+            {
+               /* The age is not worth a flash write, it is stored with */
+               /* the next change.                                      */
+               Entry      = &(DatabaseImage.Image.Clients[Result]);
+               Entry->Age = ++ClientAge;
+
+               if((Entry->Flags & CLIENT_FLAGS_PENDING) && (Entry->Configuration & GATT_CLIENT_CONFIGURATION_CHARACTERISTIC_INDICATE_ENABLE))
+                  SendServiceChanged(ConnectionData->ConnectionID, ConnectionData->RemoteDevice);
+            }
+            break;
+         case etGATT_Connection_Device_Buffer_Empty:
+            BufferEmptyData = GATT_Connection_Event_Data->Event_Data.GATT_Device_Buffer_Empty_Data;
+
+            /* A confirmed indication already cleared the pending state. */
+            if((BufferEmptyData->ConnectionType == gctLE) && ((Result = FindClient(BufferEmptyData->RemoteDevice)) >= 0))
+            {
+               Entry = &(DatabaseImage.Image.Clients[Result]);
+
+               if((Entry->Flags & CLIENT_FLAGS_PENDING) && (Entry->Configuration & GATT_CLIENT_CONFIGURATION_CHARACTERISTIC_INDICATE_ENABLE))
+                  SendServiceChanged(BufferEmptyData->ConnectionID, BufferEmptyData->RemoteDevice);
+            }
+            break;
+         default:
+            break;
+      }
+   }
+}
+
+   /* The following function writes the contribution of the specified   */
+   /* attribute to the Database Hash input (Core 5.1 Vol 3 Part G       */
+   /* 7.3.1) to Buffer, which must hold GATT_DATABASE_MAXIMUM_HASH_INPUT*/
+   /* bytes.  This function returns the number of bytes written (zero   */
+   /* for attributes that are not hashed).                              */
+unsigned int GATTDatabase_HashInput(Word_t Handle, GATT_Service_Attribute_Entry_t *Entry, Byte_t *Buffer)
+{
+   Word_t                                       Type;
+   unsigned int                                 ret_val = 0;
+   unsigned int                                 Length;
+   GATT_Characteristic_Descriptor_16_Entry_t   *Descriptor;
+   GATT_Characteristic_Declaration_16_Entry_t  *Declaration16;
+   GATT_Characteristic_Declaration_128_Entry_t *Declaration128;
+
+   if((Entry) && (Entry->Attribute_Value) && (Buffer))
+   {
+      /* Services and declarations are hashed with their value, the     */
+      /* descriptors 0x2901 - 0x2905 without.  Values, descriptors with */
+      /* 128-bit UUIDs and include definitions (not used by the         */
+      /* application) are not part of the hash.  Secondary services     */
+      /* have the layout of the primary ones.                           */
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Buffer[0], Handle);
+
+      switch(Entry->Attribute_Entry_Type)
+      {
+         case aetPrimaryService16:
+         case aetSecondaryService16:
+            Type = (Word_t)((Entry->Attribute_Entry_Type == aetPrimaryService16)?ATTRIBUTE_TYPE_PRIMARY_SERVICE:ATTRIBUTE_TYPE_SECONDARY_SERVICE);
+
+            BTPS_MemCopy(&Buffer[4], &(((GATT_Primary_Service_16_Entry_t *)Entry->Attribute_Value)->Service_UUID), sizeof(UUID_16_t));
+
+            ret_val = 4 + sizeof(UUID_16_t);
+            break;
+         case aetPrimaryService128:
+         case aetSecondaryService128:
+            Type = (Word_t)((Entry->Attribute_Entry_Type == aetPrimaryService128)?ATTRIBUTE_TYPE_PRIMARY_SERVICE:ATTRIBUTE_TYPE_SECONDARY_SERVICE);
+
+            BTPS_MemCopy(&Buffer[4], &(((GATT_Primary_Service_128_Entry_t *)Entry->Attribute_Value)->Service_UUID), sizeof(UUID_128_t));
+
+            ret_val = 4 + sizeof(UUID_128_t);
+            break;
+         case aetCharacteristicDeclaration16:
+            Type          = ATTRIBUTE_TYPE_CHARACTERISTIC;
+            Declaration16 = (GATT_Characteristic_Declaration_16_Entry_t *)Entry->Attribute_Value;
+            Buffer[4]     = Declaration16->Properties;
+
+            /* The value follows the declaration.                       */
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Buffer[5], (Word_t)(Handle + 1));
+            BTPS_MemCopy(&Buffer[7], &(Declaration16->Characteristic_Value_UUID), sizeof(UUID_16_t));
+
+            ret_val = 7 + sizeof(UUID_16_t);
+            break;
+         case aetCharacteristicDeclaration128:
+            Type           = ATTRIBUTE_TYPE_CHARACTERISTIC;
+            Declaration128 = (GATT_Characteristic_Declaration_128_Entry_t *)Entry->Attribute_Value;
+            Buffer[4]      = Declaration128->Properties;
+
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Buffer[5], (Word_t)(Handle + 1));
+            BTPS_MemCopy(&Buffer[7], &(Declaration128->Characteristic_Value_UUID), sizeof(UUID_128_t));
+
+            ret_val = 7 + sizeof(UUID_128_t);
+            break;
+         case aetCharacteristicDescriptor16:
+            Descriptor = (GATT_Characteristic_Descriptor_16_Entry_t *)Entry->Attribute_Value;
+            Type       = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&(Descriptor->Characteristic_Descriptor_UUID));
+
+            if(Type == ATTRIBUTE_TYPE_EXTENDED_PROPERTIES)
+            {
+               Length = Descriptor->Characteristic_Descriptor_Length;
+
+               if(Length > (GATT_DATABASE_MAXIMUM_HASH_INPUT - 4))
+                  Length = GATT_DATABASE_MAXIMUM_HASH_INPUT - 4;
+
+               if((Length) && (Descriptor->Characteristic_Descriptor))
+                  BTPS_MemCopy(&Buffer[4], Descriptor->Characteristic_Descriptor, Length);
+               else
+                  Length = 0;
+
+               ret_val = 4 + Length;
+            }
+            else
+            {
+               if((Type >= ATTRIBUTE_TYPE_FIRST_HASHED_DESCRIPTOR) && (Type <= ATTRIBUTE_TYPE_LAST_HASHED_DESCRIPTOR))
+                  ret_val = 4;
+            }
+            break;
+         default:
+            Type = 0;
+            break;
+      }
+
+      if(ret_val)
+         ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Buffer[2], Type);
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the state and the statistics.  This*/
+   /* function returns zero if successful or a negative value if the    */
+   /* parameter is invalid.                                             */
+int GATTDatabase_QueryStatistics(GATTDatabase_Statistics_t *Statistics)
+{
+   int ret_val;
+
+   if(Statistics)
+   {
+      GATTDatabaseStatistics.Clients = DatabaseImage.Image.NumberClients;
+      GATTDatabaseStatistics.Pending = CountPending();
+
+      *Statistics = GATTDatabaseStatistics;
+      ret_val     = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function displays the state, the subscribed clients */
+   /* and the statistics.                                               */
+void GATTDatabase_Display(void)
+{
+   unsigned int   Index;
+   ClientEntry_t *Entry;
+
+   Display(("GATT Database %s:\r\n", GATTDatabaseStackID?"running":"stopped"));
+   Display(("   %-20s %u (%u attributes, handles 0x%04X - 0x%04X)\r\n", "Services", GATTDatabaseStatistics.Services, GATTDatabaseStatistics.Attributes, GATT_DATABASE_STARTING_HANDLE, (unsigned int)(NextHandle - 1)));
+   Display(("   %-20s 0x%08lX (%s)\r\n", "Layout", (unsigned long)GATTDatabaseStatistics.Layout, GATTDatabaseStatistics.HashValid?"hash valid":"GATTHash.h is stale"));
+   Display(("   %-20s %02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X\r\n", "Database Hash", DatabaseHash[15], DatabaseHash[14], DatabaseHash[13], DatabaseHash[12], DatabaseHash[11], DatabaseHash[10], DatabaseHash[9], DatabaseHash[8], DatabaseHash[7], DatabaseHash[6], DatabaseHash[5], DatabaseHash[4], DatabaseHash[3], DatabaseHash[2], DatabaseHash[1], DatabaseHash[0]));
+   Display(("   %-20s %s\r\n", "Changed", GATTDatabaseStatistics.Changed?"yes":"no"));
+   Display(("   %-20s %lu\r\n", "Hash Reads", GATTDatabaseStatistics.HashReads));
+   Display(("   %-20s %lu\r\n", "Subscriptions", GATTDatabaseStatistics.Subscriptions));
+   Display(("   %-20s %lu sent, %lu confirmed, %lu deferred\r\n", "Indications", GATTDatabaseStatistics.Indications, GATTDatabaseStatistics.Confirmations, GATTDatabaseStatistics.Deferred));
+   Display(("   %-20s %u of %u (%u pending, %lu evicted)\r\n", "Clients", DatabaseImage.Image.NumberClients, GATT_DATABASE_MAXIMUM_CLIENTS, CountPending(), GATTDatabaseStatistics.Evicted));
+   Display(("   %-20s %u\r\n", "Flash Writes", GATTDatabaseStatistics.FlashWrites));
+
+   for(Index=0;Index<DatabaseImage.Image.NumberClients;Index++)
+   {
+      Entry = &(DatabaseImage.Image.Clients[Index]);
+
+      Display(("   %02X:%02X:%02X:%02X:%02X:%02X 0x%04X%s\r\n", Entry->BD_ADDR.BD_ADDR5, Entry->BD_ADDR.BD_ADDR4, Entry->BD_ADDR.BD_ADDR3, Entry->BD_ADDR.BD_ADDR2, Entry->BD_ADDR.BD_ADDR1, Entry->BD_ADDR.BD_ADDR0, Entry->Configuration, (Entry->Flags & CLIENT_FLAGS_PENDING)?", pending":""));
+   }
+}
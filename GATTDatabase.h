@@ -0,0 +1,146 @@
+/*****< gattdatabase.h >*******************************************************/
+/*                                                                            */
+/*  GATTDatabase - Database Hash and Service Changed of the GATT server.      */
+/*                                                                            */
+/*  The module registers the Generic Attribute service (first, at handle      */
+/*  0x0001) with the Service Changed and Database Hash characteristics and    */
+/*  places the services of the application behind it, each at the handle      */
+/*  that follows the previous one, so the handles only move when the tables   */
+/*  change.                                                                   */
+/*                                                                            */
+/*  The hash is not computed on the target (it would need AES-CMAC): the      */
+/*  host tool Linux/GATTHashGen.c registers the same tables on the stand-in   */
+/*  stack, hashes them and writes GATTHash.h.  A checksum of the hash input   */
+/*  is computed at run time as well and stored in flash:                      */
+/*                                                                            */
+/*     - If it differs from the one of GATTHash.h the header is stale and     */
+/*       the Database Hash is not readable (clients fall back to a            */
+/*       discovery).                                                          */
+/*     - If it differs from the one of the last boot the database changed     */
+/*       and every client subscribed to Service Changed is sent an            */
+/*       indication at its next connection (until it confirms).               */
+/*                                                                            */
+/*  The Service Changed subscriptions are kept per client in flash (the       */
+/*  application has no LE security, so every client is treated as bonded      */
+/*  and is identified by its address).                                        */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __GATTDATABASEH__
+#define __GATTDATABASEH__
+
+#include "SS1BTPS.h"       /* Includes for the SS1 Bluetooth Protocol Stack.  */
+#include "GATTAPI.h"       /* Includes for the GATT API.                      */
+
+#define GATT_DATABASE_STARTING_HANDLE           (0x0001)  /* Denotes the handle*/
+                                                         /* of the Generic    */
+                                                         /* Attribute service.*/
+
+#define GATT_DATABASE_MAXIMUM_CLIENTS                (8)  /* Denotes the number*/
+                                                         /* of clients whose  */
+                                                         /* subscription is   */
+                                                         /* kept.             */
+
+#ifndef GATT_DATABASE_FLASH_ADDRESS
+
+#define GATT_DATABASE_FLASH_ADDRESS        (0x0003F000)  /* Denotes the flash */
+                                                         /* page that holds   */
+                                                         /* the state (below  */
+                                                         /* the GATT client   */
+                                                         /* cache).  This page*/
+                                                         /* is removed from   */
+                                                         /* the FLASH region  */
+                                                         /* in the linker     */
+                                                         /* files.            */
+
+#endif
+
+#define GATT_DATABASE_FLASH_PAGE_SIZE           (0x0400)  /* Denotes the flash */
+                                                         /* erase block size. */
+
+#define GATT_DATABASE_HASH_SIZE                     (16)  /* Denotes the size  */
+                                                         /* of the Database   */
+                                                         /* Hash.             */
+
+#define GATT_DATABASE_MAXIMUM_HASH_INPUT            (23)  /* Denotes the most  */
+                                                         /* bytes one         */
+                                                         /* attribute adds to */
+                                                         /* the hash input.   */
+
+   /* The following structure holds the state and the statistics of the */
+   /* module.  Layout is the checksum of the hash input, HashValid is   */
+   /* TRUE if it matches GATTHash.h.  Pending counts the clients that   */
+   /* still have to be told about a change, Deferred the indications    */
+   /* the stack could not queue.                                        */
+typedef struct _tagGATTDatabase_Statistics_t
+{
+   unsigned int  Services;
+   unsigned int  Attributes;
+   DWord_t       Layout;
+   Boolean_t     HashValid;
+   Boolean_t     Changed;
+   unsigned int  Clients;
+   unsigned int  Pending;
+   unsigned long HashReads;
+   unsigned long Subscriptions;
+   unsigned long Indications;
+   unsigned long Confirmations;
+   unsigned long Deferred;
+   unsigned long Evicted;
+   unsigned int  FlashWrites;
+} GATTDatabase_Statistics_t;
+
+   /* The following function loads the state from flash (an invalid     */
+   /* image is cleared) and registers the Generic Attribute service.  It*/
+   /* must be called after GATT_Initialize() and before the services of */
+   /* the application are registered.  This function returns the number */
+   /* of subscribed clients or a negative error code.                   */
+int GATTDatabase_Initialize(unsigned int BluetoothStackID);
+
+   /* The following function registers a service of the application (the*/
+   /* parameters are the ones of GATT_Register_Service(), the handle    */
+   /* group result may be NULL).  The service is placed behind the      */
+   /* previous one.  This function returns the service ID or a negative */
+   /* error code.                                                       */
+int GATTDatabase_RegisterService(unsigned int BluetoothStackID, Byte_t ServiceFlags, unsigned int NumberOfServiceAttributeEntries, GATT_Service_Attribute_Entry_t *ServiceTable, GATT_Attribute_Handle_Group_t *ServiceHandleGroupResult, GATT_Server_Event_Callback_t ServerEventCallback, unsigned long CallbackParameter);
+
+   /* The following function must be called once all services are       */
+   /* registered.  It compares the database with the one of the last    */
+   /* boot and, if it changed, flags the subscribed clients for a       */
+   /* Service Changed indication.  This function returns the number of  */
+   /* clients that will be told or a negative error code.               */
+int GATTDatabase_Publish(void);
+
+   /* The following function stops the module (the state in flash is    */
+   /* kept).                                                            */
+void GATTDatabase_Cleanup(void);
+
+   /* The following function writes the state back to flash if it was   */
+   /* modified.  Because erasing flash stalls the processor for several */
+   /* milliseconds this function should only be called from the main    */
+   /* loop.  This function returns zero if nothing was written, a       */
+   /* positive value if the state was written, or a negative value on   */
+   /* error.                                                            */
+int GATTDatabase_Flush(void);
+
+   /* The following function must be called with the GATT connection    */
+   /* events (a pending client is sent the indication when it connects, */
+   /* or when the buffer of its link drained after a deferred send).    */
+void GATTDatabase_ProcessGATTConnectionEvent(GATT_Connection_Event_Data_t *GATT_Connection_Event_Data);
+
+   /* The following function writes the contribution of the specified   */
+   /* attribute to the Database Hash input (Core 5.1 Vol 3 Part G       */
+   /* 7.3.1) to Buffer, which must hold GATT_DATABASE_MAXIMUM_HASH_INPUT*/
+   /* bytes.  This function returns the number of bytes written (zero   */
+   /* for attributes that are not hashed).                              */
+unsigned int GATTDatabase_HashInput(Word_t Handle, GATT_Service_Attribute_Entry_t *Entry, Byte_t *Buffer);
+
+   /* The following function returns the state and the statistics.  This*/
+   /* function returns zero if successful or a negative value if the    */
+   /* parameter is invalid.                                             */
+int GATTDatabase_QueryStatistics(GATTDatabase_Statistics_t *Statistics);
+
+   /* The following function displays the state, the subscribed clients */
+   /* and the statistics.                                               */
+void GATTDatabase_Display(void);
+
+#endif
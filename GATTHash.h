@@ -0,0 +1,25 @@
+/*****< gatthash.h >***********************************************************/
+/*                                                                            */
+/*  GATTHash - Database Hash of the GATT server.                              */
+/*                                                                            */
+/*  Generated by Linux/GATTHashGen.c from the service tables, do not edit.    */
+/*  Regenerate it whenever a table changes (the gatthash target of            */
+/*  CMakeLists.txt does so before each build).  A stale header is detected    */
+/*  at run time (the Database Hash is then not readable).                     */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __GATTHASHH__
+#define __GATTHASHH__
+
+#define GATT_HASH_LAYOUT                   (0x30863575)  /* Denotes the       */
+                                                         /* checksum of the   */
+                                                         /* hash input (see   */
+                                                         /* GATTDatabase.c).  */
+
+   /* The following constant is the initializer of the Database Hash    */
+   /* (in the little endian order of ATT).                              */
+#define GATT_HASH_INITIALIZER                                                   \
+   { 0xB0, 0x06, 0x06, 0xFF, 0x9A, 0x24, 0x56, 0xA9,                            \
+     0xA0, 0x74, 0xA5, 0x88, 0xF4, 0x0C, 0x8D, 0x4B }
+
+#endif
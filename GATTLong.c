@@ -0,0 +1,569 @@
+/*****< gattlong.c >***********************************************************/
+/*                                                                            */
+/*  GATTLong - Long attribute values of the GATT server.                      */
+/*                                                                            */
+/******************************************************************************/
+#include "Main.h"          /* Application Interface Abstraction.              */
+#include "GATTLong.h"      /* GATT Long Attribute Prototypes/Constants.       */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+#include "Metrics.h"       /* Metrics Prototypes/Constants.                   */
+
+#define ARENA_ALIGNMENT                        (sizeof(DWord_t))
+
+   /* The following macro rounds a size up to the alignment of the parts*/
+   /* in the arena.                                                     */
+#define ARENA_ALIGN(_x)                        (((_x) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1))
+
+   /* The following type definition represents a registered long        */
+   /* attribute.                                                        */
+typedef struct _tagLongAttribute_t
+{
+   unsigned int               ServiceID;
+   Word_t                     AttributeOffset;
+   Word_t                     MaximumLength;
+   Word_t                     Length;
+   Byte_t                    *Value;
+   GATTLong_Commit_Callback_t CommitCallback;
+   unsigned long              CallbackParameter;
+} LongAttribute_t;
+
+   /* The following type definition represents the header of a prepared */
+   /* write in the arena, the part follows it.                          */
+typedef struct _tagPreparedWrite_t
+{
+   Byte_t Attribute;
+   Byte_t Reserved;
+   Word_t ValueOffset;
+   Word_t ValueLength;
+} PreparedWrite_t;
+
+   /* The following type definition represents the queue of prepared    */
+   /* writes of a link (ConnectionID is zero while the queue is free).  */
+   /* The parts are allocated from the front of the arena one after the */
+   /* other (Used is the bump pointer), they are never freed one by one.*/
+typedef struct _tagWriteQueue_t
+{
+   unsigned int ConnectionID;
+   unsigned int NumberWrites;
+   unsigned int Used;
+   DWord_t      Arena[GATT_LONG_ARENA_SIZE/sizeof(DWord_t)];
+} WriteQueue_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static unsigned int          GATTLongStackID;       /* Variable which holds   */
+                                                    /* the stack the module   */
+                                                    /* runs on (zero if       */
+                                                    /* stopped).              */
+
+static LongAttribute_t       Attributes[GATT_LONG_MAXIMUM_ATTRIBUTES]; /*     */
+static unsigned int          NumberAttributes;      /* Variables which hold   */
+                                                    /* the registered long    */
+                                                    /* attributes.            */
+
+static WriteQueue_t          Queues[GATT_LONG_MAXIMUM_LINKS]; /* Variable     */
+                                                    /* which holds the queues */
+                                                    /* of prepared writes.    */
+
+static unsigned int          ExecuteTransactionID;  /* Variable which holds   */
+                                                    /* the last executed      */
+                                                    /* transaction (every     */
+                                                    /* service is told).      */
+
+static GATTLong_Statistics_t GATTLongStatistics;    /* Variable which holds   */
+                                                    /* the statistics.        */
+
+   /* Internal function prototypes.                                     */
+static LongAttribute_t *FindAttribute(unsigned int ServiceID, Word_t AttributeOffset);
+static WriteQueue_t *FindQueue(unsigned int ConnectionID, Boolean_t Allocate);
+static void *AllocateFromArena(WriteQueue_t *Queue, unsigned int Size);
+static void ResetQueue(WriteQueue_t *Queue);
+static void ProcessRead(unsigned int BluetoothStackID, GATT_Read_Request_Data_t *ReadRequestData, LongAttribute_t *Attribute);
+static void ProcessWrite(unsigned int BluetoothStackID, GATT_Write_Request_Data_t *WriteRequestData, LongAttribute_t *Attribute);
+static void ProcessPrepareWrite(unsigned int BluetoothStackID, GATT_Prepare_Write_Request_Data_t *PrepareWriteRequestData, LongAttribute_t *Attribute);
+static void ProcessExecuteWrite(unsigned int BluetoothStackID, GATT_Execute_Write_Request_Data_t *ExecuteWriteRequestData);
+
+   /* The following function returns the long attribute at the specified*/
+   /* offset of a service or NULL if it is not registered.              */
+static LongAttribute_t *FindAttribute(unsigned int ServiceID, Word_t AttributeOffset)
+{
+   unsigned int     Index;
+   LongAttribute_t *ret_val = NULL;
+
+   for(Index=0;(Index<NumberAttributes) && (!ret_val);Index++)
+   {
+      if((Attributes[Index].ServiceID == ServiceID) && (Attributes[Index].AttributeOffset == AttributeOffset))
+         ret_val = &Attributes[Index];
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the queue of a link.  If the link  */
+   /* has none and Allocate is TRUE a free queue is taken.  This        */
+   /* function returns NULL if there is no (free) queue.                */
+static WriteQueue_t *FindQueue(unsigned int ConnectionID, Boolean_t Allocate)
+{
+   unsigned int  Index;
+   WriteQueue_t *ret_val = NULL;
+   WriteQueue_t *Free    = NULL;
+
+   for(Index=0;(Index<GATT_LONG_MAXIMUM_LINKS) && (!ret_val);Index++)
+   {
+      if(Queues[Index].ConnectionID == ConnectionID)
+         ret_val = &Queues[Index];
+      else
+      {
+         if((!Queues[Index].ConnectionID) && (!Free))
+            Free = &Queues[Index];
+      }
+   }
+
+   if((!ret_val) && (Allocate) && (Free))
+   {
+      ret_val               = Free;
+      ret_val->ConnectionID = ConnectionID;
+
+      GATTLongStatistics.Queues++;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function allocates the specified number of bytes    */
+   /* from the arena of a queue.  This function returns NULL if the     */
+   /* arena is full.                                                    */
+static void *AllocateFromArena(WriteQueue_t *Queue, unsigned int Size)
+{
+   void *ret_val = NULL;
+
+   Size = ARENA_ALIGN(Size);
+
+   if(Size <= (sizeof(Queue->Arena) - Queue->Used))
+   {
+      ret_val      = &(((Byte_t *)Queue->Arena)[Queue->Used]);
+      Queue->Used += Size;
+
+      if(Queue->Used > GATTLongStatistics.ArenaHighWater)
+         GATTLongStatistics.ArenaHighWater = Queue->Used;
+
+      METRICS_WATERMARK(mwPreparedWriteQueue, Queue->Used);
+   }
+
+   return(ret_val);
+}
+
+   /* The following function discards every prepared write of a queue   */
+   /* and frees the queue.                                              */
+static void ResetQueue(WriteQueue_t *Queue)
+{
+   if(Queue->ConnectionID)
+      GATTLongStatistics.Queues--;
+
+   Queue->ConnectionID = 0;
+   Queue->NumberWrites = 0;
+   Queue->Used         = 0;
+}
+
+   /* The following function answers a read (or Read Blob) request of a */
+   /* long attribute with as much of the value at the requested offset  */
+   /* as fits the MTU.                                                  */
+static void ProcessRead(unsigned int BluetoothStackID, GATT_Read_Request_Data_t *ReadRequestData, LongAttribute_t *Attribute)
+{
+   Word_t MTU;
+   Word_t Length;
+
+   if(ReadRequestData->AttributeValueOffset)
+      GATTLongStatistics.BlobReads++;
+   else
+      GATTLongStatistics.Reads++;
+
+   if(ReadRequestData->AttributeValueOffset <= Attribute->Length)
+   {
+      if((GATT_Query_Connection_MTU(BluetoothStackID, ReadRequestData->ConnectionID, &MTU)) || (MTU < ATT_PROTOCOL_MTU_MINIMUM_LE))
+         MTU = ATT_PROTOCOL_MTU_MINIMUM_LE;
+
+      Length = (Word_t)(Attribute->Length - ReadRequestData->AttributeValueOffset);
+
+      if(Length > (MTU - 1))
+         Length = (Word_t)(MTU - 1);
+
+      GATT_Read_Response(BluetoothStackID, ReadRequestData->TransactionID, Length, &(Attribute->Value[ReadRequestData->AttributeValueOffset]));
+   }
+   else
+      GATT_Error_Response(BluetoothStackID, ReadRequestData->TransactionID, ReadRequestData->AttributeOffset, ATT_PROTOCOL_ERROR_CODE_INVALID_OFFSET);
+}
+
+   /* The following function writes the value of a write request (or    */
+   /* command) to a long attribute.  A write at an offset keeps the     */
+   /* value before the offset and ends the value after the part.        */
+static void ProcessWrite(unsigned int BluetoothStackID, GATT_Write_Request_Data_t *WriteRequestData, LongAttribute_t *Attribute)
+{
+   Byte_t ErrorCode = 0;
+
+   if(WriteRequestData->AttributeValueOffset > Attribute->Length)
+      ErrorCode = ATT_PROTOCOL_ERROR_CODE_INVALID_OFFSET;
+   else
+   {
+      if((WriteRequestData->AttributeValueOffset + WriteRequestData->AttributeValueLength) > Attribute->MaximumLength)
+         ErrorCode = ATT_PROTOCOL_ERROR_CODE_INVALID_ATTRIBUTE_VALUE_LENGTH;
+   }
+
+   if(!ErrorCode)
+   {
+      if(WriteRequestData->AttributeValueLength)
+         BTPS_MemCopy(&(Attribute->Value[WriteRequestData->AttributeValueOffset]), WriteRequestData->AttributeValue, WriteRequestData->AttributeValueLength);
+
+      Attribute->Length = (Word_t)(WriteRequestData->AttributeValueOffset + WriteRequestData->AttributeValueLength);
+
+      GATTLongStatistics.Writes++;
+
+      if(WriteRequestData->TransactionID)
+         GATT_Write_Response(BluetoothStackID, WriteRequestData->TransactionID);
+
+      if(Attribute->CommitCallback)
+         (*Attribute->CommitCallback)(WriteRequestData->ConnectionID, (unsigned int)(Attribute - Attributes) + 1, Attribute->Length, Attribute->CallbackParameter);
+   }
+   else
+   {
+      /* Write commands are not answered.                               */
+      if(WriteRequestData->TransactionID)
+         GATT_Error_Response(BluetoothStackID, WriteRequestData->TransactionID, WriteRequestData->AttributeOffset, ErrorCode);
+   }
+}
+
+   /* The following function queues a prepared write.  The offset and   */
+   /* the length are only checked when the queue is executed (Core 5.1  */
+   /* Vol 3 Part F 3.4.6.1).                                            */
+static void ProcessPrepareWrite(unsigned int BluetoothStackID, GATT_Prepare_Write_Request_Data_t *PrepareWriteRequestData, LongAttribute_t *Attribute)
+{
+   WriteQueue_t    *Queue;
+   PreparedWrite_t *PreparedWrite = NULL;
+
+   if((Queue = FindQueue(PrepareWriteRequestData->ConnectionID, TRUE)) != NULL)
+   {
+      if((PreparedWrite = (PreparedWrite_t *)AllocateFromArena(Queue, sizeof(PreparedWrite_t) + PrepareWriteRequestData->AttributeValueLength)) != NULL)
+      {
+         PreparedWrite->Attribute   = (Byte_t)(Attribute - Attributes);
+         PreparedWrite->Reserved    = 0;
+         PreparedWrite->ValueOffset = PrepareWriteRequestData->AttributeValueOffset;
+         PreparedWrite->ValueLength = PrepareWriteRequestData->AttributeValueLength;
+
+         if(PrepareWriteRequestData->AttributeValueLength)
+            BTPS_MemCopy(&PreparedWrite[1], PrepareWriteRequestData->AttributeValue, PrepareWriteRequestData->AttributeValueLength);
+
+         Queue->NumberWrites++;
+
+         GATTLongStatistics.PreparedWrites++;
+      }
+      else
+      {
+         /* A queue that was taken for this write is given back.        */
+         if(!Queue->NumberWrites)
+            ResetQueue(Queue);
+      }
+   }
+
+   if(PreparedWrite)
+      GATT_Write_Response(BluetoothStackID, PrepareWriteRequestData->TransactionID);
+   else
+   {
+      GATTLongStatistics.QueueFull++;
+
+      GATT_Error_Response(BluetoothStackID, PrepareWriteRequestData->TransactionID, PrepareWriteRequestData->AttributeOffset, ATT_PROTOCOL_ERROR_CODE_PREPARE_QUEUE_FULL);
+   }
+}
+
+   /* The following function executes (or cancels) the queue of a link. */
+   /* All parts are checked against the values as the earlier parts     */
+   /* leave them before any is written, so a rejected queue leaves every*/
+   /* value as it was.  The queue is discarded in any case.             */
+static void ProcessExecuteWrite(unsigned int BluetoothStackID, GATT_Execute_Write_Request_Data_t *ExecuteWriteRequestData)
+{
+   Byte_t           *Arena;
+   Byte_t            ErrorCode = 0;
+   Word_t            Lengths[GATT_LONG_MAXIMUM_ATTRIBUTES];
+   Boolean_t         Written[GATT_LONG_MAXIMUM_ATTRIBUTES];
+   unsigned int      Index;
+   unsigned int      Offset;
+   WriteQueue_t     *Queue;
+   LongAttribute_t  *Attribute = NULL;
+   PreparedWrite_t  *PreparedWrite;
+
+   Queue = FindQueue(ExecuteWriteRequestData->ConnectionID, FALSE);
+
+   if((Queue) && (!ExecuteWriteRequestData->CancelWrite))
+   {
+      Arena = (Byte_t *)Queue->Arena;
+
+      for(Index=0;Index<NumberAttributes;Index++)
+      {
+         Lengths[Index] = Attributes[Index].Length;
+         Written[Index] = FALSE;
+      }
+
+      /* Check every part first.                                        */
+      for(Index=0,Offset=0;(Index<Queue->NumberWrites) && (!ErrorCode);Index++)
+      {
+         PreparedWrite = (PreparedWrite_t *)&Arena[Offset];
+         Attribute     = &Attributes[PreparedWrite->Attribute];
+
+         if(PreparedWrite->ValueOffset > Lengths[PreparedWrite->Attribute])
+            ErrorCode = ATT_PROTOCOL_ERROR_CODE_INVALID_OFFSET;
+         else
+         {
+            if((PreparedWrite->ValueOffset + PreparedWrite->ValueLength) > Attribute->MaximumLength)
+               ErrorCode = ATT_PROTOCOL_ERROR_CODE_INVALID_ATTRIBUTE_VALUE_LENGTH;
+            else
+               Lengths[PreparedWrite->Attribute] = (Word_t)(PreparedWrite->ValueOffset + PreparedWrite->ValueLength);
+         }
+
+         Offset += ARENA_ALIGN(sizeof(PreparedWrite_t) + PreparedWrite->ValueLength);
+      }
+
+      /* Only then write them, none can fail from here on.              */
+      if(!ErrorCode)
+      {
+         for(Index=0,Offset=0;Index<Queue->NumberWrites;Index++)
+         {
+            PreparedWrite = (PreparedWrite_t *)&Arena[Offset];
+
+            if(PreparedWrite->ValueLength)
+               BTPS_MemCopy(&(Attributes[PreparedWrite->Attribute].Value[PreparedWrite->ValueOffset]), &PreparedWrite[1], PreparedWrite->ValueLength);
+
+            Written[PreparedWrite->Attribute] = TRUE;
+
+            Offset += ARENA_ALIGN(sizeof(PreparedWrite_t) + PreparedWrite->ValueLength);
+         }
+
+         for(Index=0;Index<NumberAttributes;Index++)
+         {
+            if(Written[Index])
+               Attributes[Index].Length = Lengths[Index];
+         }
+      }
+   }
+
+   if(Queue)
+   {
+      if(ExecuteWriteRequestData->CancelWrite)
+         GATTLongStatistics.Cancelled++;
+      else
+      {
+         if(ErrorCode)
+            GATTLongStatistics.Rejected++;
+         else
+            GATTLongStatistics.Executed++;
+      }
+
+      ResetQueue(Queue);
+   }
+
+   if(!ErrorCode)
+   {
+      GATT_Execute_Write_Response(BluetoothStackID, ExecuteWriteRequestData->TransactionID);
+
+      /* The values are told about once the client has the response.    */
+      for(Index=0;(Queue) && (!ExecuteWriteRequestData->CancelWrite) && (Index<NumberAttributes);Index++)
+      {
+         if((Written[Index]) && (Attributes[Index].CommitCallback))
+            (*Attributes[Index].CommitCallback)(ExecuteWriteRequestData->ConnectionID, Index + 1, Attributes[Index].Length, Attributes[Index].CallbackParameter);
+      }
+   }
+   else
+      GATT_Error_Response(BluetoothStackID, ExecuteWriteRequestData->TransactionID, Attribute->AttributeOffset, ErrorCode);
+}
+
+   /* The following function initializes the module (the registered     */
+   /* attributes and the queues are cleared).  This function returns    */
+   /* zero if successful or a negative error code.                      */
+int GATTLong_Initialize(unsigned int BluetoothStackID)
+{
+   int ret_val;
+
+   if(BluetoothStackID)
+   {
+      BTPS_MemInitialize(Attributes, 0, sizeof(Attributes));
+      BTPS_MemInitialize(Queues, 0, sizeof(Queues));
+
+      NumberAttributes                = 0;
+      ExecuteTransactionID            = 0;
+      GATTLongStatistics.Attributes   = 0;
+      GATTLongStatistics.Queues       = 0;
+      GATTLongStackID                 = BluetoothStackID;
+
+      ret_val                         = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function stops the module (the queues are           */
+   /* discarded).                                                       */
+void GATTLong_Cleanup(void)
+{
+   BTPS_MemInitialize(Queues, 0, sizeof(Queues));
+
+   GATTLongStatistics.Queues = 0;
+   GATTLongStackID           = 0;
+}
+
+   /* The following function registers a long attribute, the attribute  */
+   /* at AttributeOffset of the service ServiceID.  This function       */
+   /* returns the attribute ID (positive) or a negative error code.     */
+int GATTLong_RegisterAttribute(unsigned int ServiceID, Word_t AttributeOffset, Word_t MaximumLength, Byte_t *Value, Word_t Length, GATTLong_Commit_Callback_t CommitCallback, unsigned long CallbackParameter)
+{
+   int              ret_val;
+   LongAttribute_t *Attribute;
+
+   if((GATTLongStackID) && (ServiceID) && (Value) && (MaximumLength) && (MaximumLength <= GATT_LONG_MAXIMUM_VALUE_LENGTH) && (Length <= MaximumLength) && (!FindAttribute(ServiceID, AttributeOffset)))
+   {
+      if(NumberAttributes < GATT_LONG_MAXIMUM_ATTRIBUTES)
+      {
+         Attribute                    = &Attributes[NumberAttributes++];
+         Attribute->ServiceID         = ServiceID;
+         Attribute->AttributeOffset   = AttributeOffset;
+         Attribute->MaximumLength     = MaximumLength;
+         Attribute->Length            = Length;
+         Attribute->Value             = Value;
+         Attribute->CommitCallback    = CommitCallback;
+         Attribute->CallbackParameter = CallbackParameter;
+
+         GATTLongStatistics.Attributes = NumberAttributes;
+
+         ret_val                       = (int)NumberAttributes;
+      }
+      else
+         ret_val = -2;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function returns the length of the current value of */
+   /* a long attribute or a negative error code.                        */
+int GATTLong_QueryLength(unsigned int AttributeID)
+{
+   int ret_val;
+
+   if((AttributeID) && (AttributeID <= NumberAttributes))
+      ret_val = (int)Attributes[AttributeID - 1].Length;
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function must be called with the events of every    */
+   /* service that has long attributes.  This function returns TRUE if  */
+   /* the event was answered by this module.                            */
+Boolean_t GATTLong_ProcessServerEvent(unsigned int BluetoothStackID, GATT_Server_Event_Data_t *GATT_Server_Event_Data)
+{
+   Boolean_t        ret_val = FALSE;
+   WriteQueue_t    *Queue;
+   LongAttribute_t *Attribute;
+
+   if((GATTLongStackID) && (GATT_Server_Event_Data) && (GATT_Server_Event_Data->Event_Data.GATT_Read_Request_Data))
+   {
+      switch(GATT_Server_Event_Data->Event_Data_Type)
+      {
+         case etGATT_Server_Read_Request:
+            if((Attribute = FindAttribute(GATT_Server_Event_Data->Event_Data.GATT_Read_Request_Data->ServiceID, GATT_Server_Event_Data->Event_Data.GATT_Read_Request_Data->AttributeOffset)) != NULL)
+            {
+               ProcessRead(BluetoothStackID, GATT_Server_Event_Data->Event_Data.GATT_Read_Request_Data, Attribute);
+
+               ret_val = TRUE;
+            }
+            break;
+         case etGATT_Server_Write_Request:
+            if((Attribute = FindAttribute(GATT_Server_Event_Data->Event_Data.GATT_Write_Request_Data->ServiceID, GATT_Server_Event_Data->Event_Data.GATT_Write_Request_Data->AttributeOffset)) != NULL)
+            {
+               ProcessWrite(BluetoothStackID, GATT_Server_Event_Data->Event_Data.GATT_Write_Request_Data, Attribute);
+
+               ret_val = TRUE;
+            }
+            break;
+         case etGATT_Server_Prepare_Write_Request:
+            if((Attribute = FindAttribute(GATT_Server_Event_Data->Event_Data.GATT_Prepare_Write_Request_Data->ServiceID, GATT_Server_Event_Data->Event_Data.GATT_Prepare_Write_Request_Data->AttributeOffset)) != NULL)
+            {
+               ProcessPrepareWrite(BluetoothStackID, GATT_Server_Event_Data->Event_Data.GATT_Prepare_Write_Request_Data, Attribute);
+
+               ret_val = TRUE;
+            }
+            break;
+         case etGATT_Server_Execute_Write_Request:
+            /* The request is passed to every service, it is answered   */
+            /* once.                                                    */
+            if(GATT_Server_Event_Data->Event_Data.GATT_Execute_Write_Request_Data->TransactionID != ExecuteTransactionID)
+            {
+               ExecuteTransactionID = GATT_Server_Event_Data->Event_Data.GATT_Execute_Write_Request_Data->TransactionID;
+
+               ProcessExecuteWrite(BluetoothStackID, GATT_Server_Event_Data->Event_Data.GATT_Execute_Write_Request_Data);
+            }
+
+            ret_val = TRUE;
+            break;
+         case etGATT_Server_Device_Disconnection:
+            /* The prepared writes of a lost link are dropped.          */
+            if((Queue = FindQueue(GATT_Server_Event_Data->Event_Data.GATT_Device_Disconnection_Data->ConnectionID, FALSE)) != NULL)
+            {
+               GATTLongStatistics.Discarded++;
+
+               ResetQueue(Queue);
+            }
+            break;
+         default:
+            break;
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the statistics.  This function     */
+   /* returns zero if successful or a negative value if the parameter is*/
+   /* invalid.                                                          */
+int GATTLong_QueryStatistics(GATTLong_Statistics_t *Statistics)
+{
+   int ret_val;
+
+   if(Statistics)
+   {
+      *Statistics = GATTLongStatistics;
+
+      ret_val     = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function displays the long attributes, the queues   */
+   /* and the statistics.                                               */
+void GATTLong_Display(void)
+{
+   unsigned int Index;
+
+   Display(("GATT Long Attributes %s:\r\n", GATTLongStackID?"running":"stopped"));
+   Display(("   %-20s %lu (%lu blob)\r\n", "Reads", GATTLongStatistics.Reads + GATTLongStatistics.BlobReads, GATTLongStatistics.BlobReads));
+   Display(("   %-20s %lu\r\n", "Writes", GATTLongStatistics.Writes));
+   Display(("   %-20s %lu (%lu queue full)\r\n", "Prepared Writes", GATTLongStatistics.PreparedWrites, GATTLongStatistics.QueueFull));
+   Display(("   %-20s %lu executed, %lu rejected, %lu cancelled, %lu discarded\r\n", "Queues", GATTLongStatistics.Executed, GATTLongStatistics.Rejected, GATTLongStatistics.Cancelled, GATTLongStatistics.Discarded));
+   Display(("   %-20s %u of %u bytes\r\n", "Arena High Water", GATTLongStatistics.ArenaHighWater, (unsigned int)GATT_LONG_ARENA_SIZE));
+
+   for(Index=0;Index<NumberAttributes;Index++)
+      Display(("   Attribute %u (service %u, offset %u) %u of %u bytes\r\n", Index + 1, Attributes[Index].ServiceID, Attributes[Index].AttributeOffset, Attributes[Index].Length, Attributes[Index].MaximumLength));
+
+   for(Index=0;Index<GATT_LONG_MAXIMUM_LINKS;Index++)
+   {
+      if(Queues[Index].ConnectionID)
+         Display(("   Queue of connection %u: %u writes, %u bytes\r\n", Queues[Index].ConnectionID, Queues[Index].NumberWrites, Queues[Index].Used));
+   }
+}
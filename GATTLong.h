@@ -0,0 +1,127 @@
+/*****< gattlong.h >***********************************************************/
+/*                                                                            */
+/*  GATTLong - Long attribute values of the GATT server.                      */
+/*                                                                            */
+/*  Characteristic values larger than an ATT MTU are registered with this     */
+/*  module, which then answers the requests of the clients for them:          */
+/*                                                                            */
+/*     - Reads and Read Blob requests are answered from the value, at the     */
+/*       requested offset.                                                    */
+/*     - Prepare Write requests are queued per link in a fixed arena (each    */
+/*       part is placed behind the previous one, nothing is freed until the   */
+/*       queue ends).  No heap memory is used.                                */
+/*     - An Execute Write request checks every queued part first and only     */
+/*       then writes them, so either all parts reach the values or none.      */
+/*       Cancelling the queue or losing the link discards the whole arena at  */
+/*       once.                                                                */
+/*                                                                            */
+/*  The queue may hold parts of several long attributes (of any service), a   */
+/*  link may have one queue at a time as ATT allows.                          */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __GATTLONGH__
+#define __GATTLONGH__
+
+#include "SS1BTPS.h"       /* Includes for the SS1 Bluetooth Protocol Stack.  */
+#include "GATTAPI.h"       /* Includes for the GATT API.                      */
+
+#define GATT_LONG_MAXIMUM_ATTRIBUTES                 (4)  /* Denotes the number*/
+                                                         /* of long attributes*/
+                                                         /* that can be       */
+                                                         /* registered.       */
+
+#ifndef GATT_LONG_MAXIMUM_LINKS
+
+#define GATT_LONG_MAXIMUM_LINKS                      (1)  /* Denotes the number*/
+                                                         /* of links that may */
+                                                         /* have a queue of   */
+                                                         /* prepared writes at*/
+                                                         /* the same time.    */
+
+#endif
+
+#ifndef GATT_LONG_ARENA_SIZE
+
+#define GATT_LONG_ARENA_SIZE                       (384)  /* Denotes the size  */
+                                                         /* of the arena of a */
+                                                         /* queue (a part     */
+                                                         /* takes its length  */
+                                                         /* plus 6 bytes,     */
+                                                         /* rounded up to a   */
+                                                         /* multiple of 4).   */
+                                                         /* 384 holds the 256 */
+                                                         /* byte configuration*/
+                                                         /* of Main.c in 18   */
+                                                         /* byte parts.       */
+
+#endif
+
+#define GATT_LONG_MAXIMUM_VALUE_LENGTH             (512)  /* Denotes the       */
+                                                         /* largest value of  */
+                                                         /* an attribute      */
+                                                         /* (Core 5.1 Vol 3   */
+                                                         /* Part F 3.2.9).    */
+
+   /* The following type definition represents the function that is     */
+   /* called once a write reached the value of a long attribute (a      */
+   /* write request or an executed queue, ConnectionID is the link of   */
+   /* the client).  Length is the new length of the value.              */
+typedef void (*GATTLong_Commit_Callback_t)(unsigned int ConnectionID, unsigned int AttributeID, Word_t Length, unsigned long CallbackParameter);
+
+   /* The following structure holds the statistics of the module.       */
+   /* Queues is the number of links with prepared writes right now,     */
+   /* ArenaHighWater the most bytes one arena held.  Rejected counts the*/
+   /* executed queues that failed the checks (invalid offset or length).*/
+typedef struct _tagGATTLong_Statistics_t
+{
+   unsigned int  Attributes;
+   unsigned int  Queues;
+   unsigned int  ArenaHighWater;
+   unsigned long Reads;
+   unsigned long BlobReads;
+   unsigned long Writes;
+   unsigned long PreparedWrites;
+   unsigned long QueueFull;
+   unsigned long Executed;
+   unsigned long Rejected;
+   unsigned long Cancelled;
+   unsigned long Discarded;
+} GATTLong_Statistics_t;
+
+   /* The following function initializes the module (the registered     */
+   /* attributes and the queues are cleared).  This function returns    */
+   /* zero if successful or a negative error code.                      */
+int GATTLong_Initialize(unsigned int BluetoothStackID);
+
+   /* The following function stops the module (the queues are           */
+   /* discarded).                                                       */
+void GATTLong_Cleanup(void);
+
+   /* The following function registers a long attribute, the attribute  */
+   /* at AttributeOffset of the service ServiceID.  Value is the buffer */
+   /* of the value (MaximumLength bytes, it must stay valid and is      */
+   /* written by this module only), Length the length of its current    */
+   /* value.  This function returns the attribute ID (positive) or a    */
+   /* negative error code.                                              */
+int GATTLong_RegisterAttribute(unsigned int ServiceID, Word_t AttributeOffset, Word_t MaximumLength, Byte_t *Value, Word_t Length, GATTLong_Commit_Callback_t CommitCallback, unsigned long CallbackParameter);
+
+   /* The following function returns the length of the current value of */
+   /* a long attribute or a negative error code.                        */
+int GATTLong_QueryLength(unsigned int AttributeID);
+
+   /* The following function must be called with the events of every    */
+   /* service that has long attributes.  This function returns TRUE if  */
+   /* the event was answered by this module (the service must then      */
+   /* ignore it) or FALSE if the service has to handle it.              */
+Boolean_t GATTLong_ProcessServerEvent(unsigned int BluetoothStackID, GATT_Server_Event_Data_t *GATT_Server_Event_Data);
+
+   /* The following function returns the statistics.  This function     */
+   /* returns zero if successful or a negative value if the parameter is*/
+   /* invalid.                                                          */
+int GATTLong_QueryStatistics(GATTLong_Statistics_t *Statistics);
+
+   /* The following function displays the long attributes, the queues   */
+   /* and the statistics.                                               */
+void GATTLong_Display(void);
+
+#endif
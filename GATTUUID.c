@@ -0,0 +1,102 @@
+/*****< gattuuid.c >***********************************************************/
+/*                                                                            */
+/*  GATTUUID - Compile-time GATT UUIDs with automatic 16-bit compression.     */
+/*                                                                            */
+/******************************************************************************/
+#include "Main.h"          /* Application Interface Abstraction.              */
+#include "GATTUUID.h"      /* GATT UUID Prototypes/Constants.                 */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+
+   /* The following function fills a primary service entry.              */
+void GATTUUID_AssignPrimaryService(GATT_Service_Attribute_Entry_t *Entry, GATTUUID_Entry_Value_t *Value, const GATT_UUID_t *UUID)
+{
+   if((Entry) && (Value) && (UUID))
+   {
+      Entry->Attribute_Flags = GATT_ATTRIBUTE_FLAGS_READABLE;
+      Entry->Attribute_Value = Value;
+
+      if(UUID->UUID_Type == guUUID_16)
+      {
+         Entry->Attribute_Entry_Type          = aetPrimaryService16;
+         Value->PrimaryService16.Service_UUID = UUID->UUID.UUID_16;
+      }
+      else
+      {
+         Entry->Attribute_Entry_Type           = aetPrimaryService128;
+         Value->PrimaryService128.Service_UUID = UUID->UUID.UUID_128;
+      }
+   }
+}
+
+   /* The following function fills a characteristic declaration entry.   */
+void GATTUUID_AssignCharacteristicDeclaration(GATT_Service_Attribute_Entry_t *Entry, GATTUUID_Entry_Value_t *Value, const GATT_UUID_t *UUID, Byte_t Properties)
+{
+   if((Entry) && (Value) && (UUID))
+   {
+      Entry->Attribute_Flags = GATT_ATTRIBUTE_FLAGS_READABLE;
+      Entry->Attribute_Value = Value;
+
+      if(UUID->UUID_Type == guUUID_16)
+      {
+         Entry->Attribute_Entry_Type                                = aetCharacteristicDeclaration16;
+         Value->CharacteristicDeclaration16.Properties                = Properties;
+         Value->CharacteristicDeclaration16.Characteristic_Value_UUID = UUID->UUID.UUID_16;
+      }
+      else
+      {
+         Entry->Attribute_Entry_Type                                 = aetCharacteristicDeclaration128;
+         Value->CharacteristicDeclaration128.Properties                = Properties;
+         Value->CharacteristicDeclaration128.Characteristic_Value_UUID = UUID->UUID.UUID_128;
+      }
+   }
+}
+
+   /* The following function fills a characteristic value entry.         */
+void GATTUUID_AssignCharacteristicValue(GATT_Service_Attribute_Entry_t *Entry, GATTUUID_Entry_Value_t *Value, const GATT_UUID_t *UUID, Byte_t Flags, unsigned int Length, Byte_t *Data)
+{
+   if((Entry) && (Value) && (UUID))
+   {
+      Entry->Attribute_Flags = Flags;
+      Entry->Attribute_Value = Value;
+
+      if(UUID->UUID_Type == guUUID_16)
+      {
+         Entry->Attribute_Entry_Type                                = aetCharacteristicValue16;
+         Value->CharacteristicValue16.Characteristic_Value_UUID     = UUID->UUID.UUID_16;
+         Value->CharacteristicValue16.Characteristic_Value_Length   = Length;
+         Value->CharacteristicValue16.Characteristic_Value          = Data;
+      }
+      else
+      {
+         Entry->Attribute_Entry_Type                                = aetCharacteristicValue128;
+         Value->CharacteristicValue128.Characteristic_Value_UUID    = UUID->UUID.UUID_128;
+         Value->CharacteristicValue128.Characteristic_Value_Length  = Length;
+         Value->CharacteristicValue128.Characteristic_Value         = Data;
+      }
+   }
+}
+
+   /* The following function fills a characteristic descriptor entry.    */
+void GATTUUID_AssignCharacteristicDescriptor(GATT_Service_Attribute_Entry_t *Entry, GATTUUID_Entry_Value_t *Value, const GATT_UUID_t *UUID, Byte_t Flags, unsigned int Length, Byte_t *Data)
+{
+   if((Entry) && (Value) && (UUID))
+   {
+      Entry->Attribute_Flags = Flags;
+      Entry->Attribute_Value = Value;
+
+      if(UUID->UUID_Type == guUUID_16)
+      {
+         Entry->Attribute_Entry_Type                                          = aetCharacteristicDescriptor16;
+         Value->CharacteristicDescriptor16.Characteristic_Descriptor_UUID     = UUID->UUID.UUID_16;
+         Value->CharacteristicDescriptor16.Characteristic_Descriptor_Length   = Length;
+         Value->CharacteristicDescriptor16.Characteristic_Descriptor          = Data;
+      }
+      else
+      {
+         Entry->Attribute_Entry_Type                                          = aetCharacteristicDescriptor128;
+         Value->CharacteristicDescriptor128.Characteristic_Descriptor_UUID    = UUID->UUID.UUID_128;
+         Value->CharacteristicDescriptor128.Characteristic_Descriptor_Length  = Length;
+         Value->CharacteristicDescriptor128.Characteristic_Descriptor         = Data;
+      }
+   }
+}
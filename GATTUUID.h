@@ -0,0 +1,104 @@
+/*****< gattuuid.h >***********************************************************/
+/*                                                                            */
+/*  GATTUUID - Compile-time GATT UUIDs with automatic 16-bit compression.     */
+/*                                                                            */
+/*  A UUID is written as the five groups of its canonical string form, so    */
+/*  "0000180A-0000-1000-8000-00805F9B34FB" becomes                            */
+/*                                                                            */
+/*     GATT_UUID_INITIALIZER(0x0000180A, 0x0000, 0x1000, 0x8000,              */
+/*                           0x00805F9B34FB)                                  */
+/*                                                                            */
+/*  which is a constant initializer of a GATT_UUID_t (the groups are integer  */
+/*  constants, so the compiler does all the work and the UUID can live in    */
+/*  flash).  A UUID on the Bluetooth Base UUID (xxxx-0000-1000-8000-          */
+/*  00805F9B34FB with a 16-bit xxxx) is stored as a 16-bit UUID, every other */
+/*  as a 128-bit UUID.  Both are stored in the little endian order of ATT.   */
+/*                                                                            */
+/*  The GATTUUID_Assign functions fill an entry of a service table from such  */
+/*  a UUID, they pick the 16-bit entry type if the UUID is a 16-bit UUID.     */
+/*  16-bit entries make the discovery responses smaller (a Read By Type       */
+/*  response of 16-bit declarations holds 3 times as many entries as one of   */
+/*  128-bit declarations at the default MTU).  The value structures must stay */
+/*  valid while the service is registered (the stack keeps the pointers).     */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __GATTUUIDH__
+#define __GATTUUIDH__
+
+#include "SS1BTPS.h"       /* Includes for the SS1 Bluetooth Protocol Stack.  */
+#include "GATTAPI.h"       /* Includes for the GATT API.                      */
+
+   /* The following macro is TRUE if the UUID of the specified canonical*/
+   /* groups lies on the Bluetooth Base UUID.                           */
+#define GATT_UUID_IS_16_BIT(_Data1, _Data2, _Data3, _Data4, _Data5)                    \
+   ((((unsigned long)(_Data1) & 0xFFFF0000UL) == 0) && ((_Data2) == 0x0000) &&         \
+    ((_Data3) == 0x1000) && ((_Data4) == 0x8000) && ((_Data5) == 0x00805F9B34FBULL))
+
+   /* The following macro returns byte _Index (0 is the least          */
+   /* significant, as sent by ATT) of the 128-bit UUID of the specified */
+   /* canonical groups.                                                 */
+#define GATT_UUID_BYTE(_Data1, _Data2, _Data3, _Data4, _Data5, _Index)                 \
+   ((Byte_t)(((_Index) < 6)?((unsigned long long)(_Data5) >> (8 * ((_Index) % 6))):    \
+             ((_Index) < 8)?((unsigned long)(_Data4) >> (8 * ((_Index) % 2))):         \
+             ((_Index) < 10)?((unsigned long)(_Data3) >> (8 * ((_Index) % 2))):        \
+             ((_Index) < 12)?((unsigned long)(_Data2) >> (8 * ((_Index) % 2))):       \
+                             ((unsigned long)(_Data1) >> (8 * ((_Index) % 4)))))
+
+   /* The following macro returns byte _Index of the stored form: the    */
+   /* 16-bit UUID in bytes 0 and 1 (the rest zero) for a UUID on the    */
+   /* base, the 128-bit UUID otherwise.                                 */
+#define GATT_UUID_STORED_BYTE(_Data1, _Data2, _Data3, _Data4, _Data5, _Index)          \
+   ((Byte_t)(GATT_UUID_IS_16_BIT(_Data1, _Data2, _Data3, _Data4, _Data5)?              \
+             (((_Index) < 2)?((unsigned long)(_Data1) >> (8 * ((_Index) % 2))):0):     \
+             GATT_UUID_BYTE(_Data1, _Data2, _Data3, _Data4, _Data5, _Index)))
+
+#define GATT_UUID_STORED_BYTES(_a, _b, _c, _d, _e)                                     \
+   GATT_UUID_STORED_BYTE(_a, _b, _c, _d, _e,  0), GATT_UUID_STORED_BYTE(_a, _b, _c, _d, _e,  1), \
+   GATT_UUID_STORED_BYTE(_a, _b, _c, _d, _e,  2), GATT_UUID_STORED_BYTE(_a, _b, _c, _d, _e,  3), \
+   GATT_UUID_STORED_BYTE(_a, _b, _c, _d, _e,  4), GATT_UUID_STORED_BYTE(_a, _b, _c, _d, _e,  5), \
+   GATT_UUID_STORED_BYTE(_a, _b, _c, _d, _e,  6), GATT_UUID_STORED_BYTE(_a, _b, _c, _d, _e,  7), \
+   GATT_UUID_STORED_BYTE(_a, _b, _c, _d, _e,  8), GATT_UUID_STORED_BYTE(_a, _b, _c, _d, _e,  9), \
+   GATT_UUID_STORED_BYTE(_a, _b, _c, _d, _e, 10), GATT_UUID_STORED_BYTE(_a, _b, _c, _d, _e, 11), \
+   GATT_UUID_STORED_BYTE(_a, _b, _c, _d, _e, 12), GATT_UUID_STORED_BYTE(_a, _b, _c, _d, _e, 13), \
+   GATT_UUID_STORED_BYTE(_a, _b, _c, _d, _e, 14), GATT_UUID_STORED_BYTE(_a, _b, _c, _d, _e, 15)
+
+   /* The following macro is the initializer of a GATT_UUID_t from the   */
+   /* canonical groups of the UUID (see above).  The 16-bit UUID shares */
+   /* its bytes with the start of the 128-bit one in the union.         */
+#define GATT_UUID_INITIALIZER(_Data1, _Data2, _Data3, _Data4, _Data5)                  \
+   { (GATT_UUID_IS_16_BIT(_Data1, _Data2, _Data3, _Data4, _Data5)?guUUID_16:guUUID_128), \
+     { .UUID_128 = { GATT_UUID_STORED_BYTES(_Data1, _Data2, _Data3, _Data4, _Data5) } } }
+
+   /* The following macro is the initializer of a GATT_UUID_t of a 16-bit*/
+   /* UUID (e.g. GATT_UUID_16_INITIALIZER(0x2902) for the Client        */
+   /* Characteristic Configuration descriptor).                         */
+#define GATT_UUID_16_INITIALIZER(_UUID16)                                              \
+   GATT_UUID_INITIALIZER((_UUID16), 0x0000, 0x1000, 0x8000, 0x00805F9B34FBULL)
+
+   /* The following union holds the value of a service table entry of    */
+   /* either UUID size.                                                 */
+typedef union _tagGATTUUID_Entry_Value_t
+{
+   GATT_Primary_Service_16_Entry_t             PrimaryService16;
+   GATT_Primary_Service_128_Entry_t            PrimaryService128;
+   GATT_Characteristic_Declaration_16_Entry_t  CharacteristicDeclaration16;
+   GATT_Characteristic_Declaration_128_Entry_t CharacteristicDeclaration128;
+   GATT_Characteristic_Value_16_Entry_t        CharacteristicValue16;
+   GATT_Characteristic_Value_128_Entry_t       CharacteristicValue128;
+   GATT_Characteristic_Descriptor_16_Entry_t   CharacteristicDescriptor16;
+   GATT_Characteristic_Descriptor_128_Entry_t  CharacteristicDescriptor128;
+} GATTUUID_Entry_Value_t;
+
+   /* The following function fills a primary service entry.              */
+void GATTUUID_AssignPrimaryService(GATT_Service_Attribute_Entry_t *Entry, GATTUUID_Entry_Value_t *Value, const GATT_UUID_t *UUID);
+
+   /* The following function fills a characteristic declaration entry.   */
+void GATTUUID_AssignCharacteristicDeclaration(GATT_Service_Attribute_Entry_t *Entry, GATTUUID_Entry_Value_t *Value, const GATT_UUID_t *UUID, Byte_t Properties);
+
+   /* The following function fills a characteristic value entry.         */
+void GATTUUID_AssignCharacteristicValue(GATT_Service_Attribute_Entry_t *Entry, GATTUUID_Entry_Value_t *Value, const GATT_UUID_t *UUID, Byte_t Flags, unsigned int Length, Byte_t *Data);
+
+   /* The following function fills a characteristic descriptor entry.    */
+void GATTUUID_AssignCharacteristicDescriptor(GATT_Service_Attribute_Entry_t *Entry, GATTUUID_Entry_Value_t *Value, const GATT_UUID_t *UUID, Byte_t Flags, unsigned int Length, Byte_t *Data);
+
+#endif
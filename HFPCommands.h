@@ -0,0 +1,194 @@
+/*****< hfpcommands.h >********************************************************/
+/*                                                                            */
+/*  HFPCommands - Command schema of the HFP demo console.                     */
+/*                                                                            */
+/*  Every console command is declared once here, with its typed parameters.   */
+/*  The list is expanded by HFPDemo.c (X macros) into:                        */
+/*                                                                            */
+/*     - the command table that the parser looks the commands up in and       */
+/*       checks and converts the parameters with, in a single pass (the       */
+/*       command functions receive valid values only),                        */
+/*     - the largest number of parameters of a command (the size of the       */
+/*       parameter list),                                                     */
+/*     - the text of the Help command.                                        */
+/*                                                                            */
+/*  A command is COMMAND(Name, Function, Description), followed by one        */
+/*  PARAMETER(Name, Type, Minimum, Maximum, Names, Optional) per parameter    */
+/*  and closed by END.  Minimum and Maximum are the range of a number, or the */
+/*  length of a string.  Names are the '|' separated names of the values of   */
+/*  an enumeration (0 to N - 1).  Optional parameters must follow the         */
+/*  required ones.                                                            */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __HFPCOMMANDSH__
+#define __HFPCOMMANDSH__
+
+   /* The following enumerated type represents the types of the         */
+   /* parameters.  A number is decimal or hexadecimal (0x prefix), a    */
+   /* device is an index of the inquiry list (1 to the number of        */
+   /* results) or a BD_ADDR (0x followed by 12 hexadecimal digits, or   */
+   /* six ':' separated bytes).                                         */
+typedef enum
+{
+   ptNumber,
+   ptEnumeration,
+   ptString,
+   ptDevice
+} Parameter_Type_t;
+
+#ifdef PROFILE_ENABLE
+
+#define HFP_PROFILE_COMMANDS(COMMAND, PARAMETER, END)                                                                  \
+   COMMAND("Profile", DisplayProfile, "Displays the handler execution times (Reset 1 clears them).")                   \
+      PARAMETER("Reset", ptNumber, 0, 1, NULL, TRUE)                                                                   \
+   END
+
+#else
+
+#define HFP_PROFILE_COMMANDS(COMMAND, PARAMETER, END)
+
+#endif
+
+#ifdef SCAN_ENABLE
+
+#define HFP_SCAN_COMMANDS(COMMAND, PARAMETER, END)                                                                     \
+   COMMAND("Scan", ScanLE, "Starts or stops LE scanning (the results without a mode).")                                \
+      PARAMETER("Mode", ptEnumeration, 0, 2, "Stop|Passive|Active", TRUE)                                              \
+   END
+
+#else
+
+#define HFP_SCAN_COMMANDS(COMMAND, PARAMETER, END)
+
+#endif
+
+#ifdef GATT_CLIENT_ENABLE
+
+#define HFP_GATT_CLIENT_COMMANDS(COMMAND, PARAMETER, END)                                                              \
+   COMMAND("GATTClient", DisplayGATTClient, "Displays the GATT client cache (Clear 1 clears it).")                     \
+      PARAMETER("Clear", ptNumber, 0, 1, NULL, TRUE)                                                                   \
+   END
+
+#else
+
+#define HFP_GATT_CLIENT_COMMANDS(COMMAND, PARAMETER, END)
+
+#endif
+
+#ifdef MEM_POOL_ENABLE
+
+#define HFP_MEM_POOL_COMMANDS(COMMAND, PARAMETER, END)                                                                 \
+   COMMAND("MemPool", DisplayMemPool, "Displays the memory pool usage (Reset 1 clears the counters).")                 \
+      PARAMETER("Reset", ptNumber, 0, 1, NULL, TRUE)                                                                   \
+   END
+
+#else
+
+#define HFP_MEM_POOL_COMMANDS(COMMAND, PARAMETER, END)
+
+#endif
+
+   /* The following macro holds the commands of the console, in the     */
+   /* order they are listed by the Help command.                        */
+#define HFP_COMMANDS(COMMAND, PARAMETER, END)                                                                          \
+   COMMAND("Inquiry", Inquiry, "Starts an inquiry for nearby devices.")                                                \
+   END                                                                                                                 \
+   COMMAND("DisplayInquiryList", DisplayInquiryList, "Lists the devices found by the last inquiry.")                   \
+   END                                                                                                                 \
+   COMMAND("Pair", Pair, "Bonds with a device (dedicated bonding unless General is 1).")                               \
+      PARAMETER("Device", ptDevice, 0, 0, NULL, FALSE)                                                                 \
+      PARAMETER("General", ptNumber, 0, 1, NULL, TRUE)                                                                 \
+   END                                                                                                                 \
+   COMMAND("EndPairing", EndPairing, "Ends the bonding with a device.")                                                \
+      PARAMETER("Device", ptDevice, 0, 0, NULL, FALSE)                                                                 \
+   END                                                                                                                 \
+   COMMAND("PINCodeResponse", PINCodeResponse, "Answers a PIN code request.")                                          \
+      PARAMETER("PINCode", ptString, 1, 16, NULL, FALSE)                                                               \
+   END                                                                                                                 \
+   COMMAND("PassKeyResponse", PassKeyResponse, "Answers a passkey request.")                                           \
+      PARAMETER("Passkey", ptNumber, 0, 999999, NULL, FALSE)                                                           \
+   END                                                                                                                 \
+   COMMAND("UserConfirmationResponse", UserConfirmationResponse, "Answers a user confirmation request.")               \
+      PARAMETER("Confirm", ptNumber, 0, 1, NULL, FALSE)                                                                \
+   END                                                                                                                 \
+   COMMAND("SetDiscoverabilityMode", SetDiscoverabilityMode, "Sets the discoverability mode.")                         \
+      PARAMETER("Mode", ptEnumeration, 0, 2, "NonDiscoverable|Limited|General", FALSE)                                 \
+   END                                                                                                                 \
+   COMMAND("SetConnectabilityMode", SetConnectabilityMode, "Sets the connectability mode.")                            \
+      PARAMETER("Mode", ptEnumeration, 0, 1, "NonConnectable|Connectable", FALSE)                                      \
+   END                                                                                                                 \
+   COMMAND("SetPairabilityMode", SetPairabilityMode, "Sets the pairability mode.")                                     \
+      PARAMETER("Mode", ptEnumeration, 0, 2, "NonPairable|Pairable|SecureSimplePairing", FALSE)                        \
+   END                                                                                                                 \
+   COMMAND("ChangeSimplePairingParameters", ChangeSimplePairingParameters, "Sets the I/O capability and MITM protection of Secure Simple Pairing.") \
+      PARAMETER("IOCapability", ptEnumeration, 0, 3, "DisplayOnly|DisplayYesNo|KeyboardOnly|NoInputNoOutput", FALSE)   \
+      PARAMETER("MITM", ptNumber, 0, 1, NULL, FALSE)                                                                   \
+   END                                                                                                                 \
+   COMMAND("GetLocalAddress", GetLocalAddress, "Displays the local BD_ADDR.")                                          \
+   END                                                                                                                 \
+   COMMAND("GetLocalName", GetLocalName, "Displays the local device name.")                                            \
+   END                                                                                                                 \
+   COMMAND("SetLocalName", SetLocalName, "Sets the local device name.")                                                \
+      PARAMETER("Name", ptString, 1, 248, NULL, FALSE)                                                                 \
+   END                                                                                                                 \
+   COMMAND("GetClassOfDevice", GetClassOfDevice, "Displays the local class of device.")                                \
+   END                                                                                                                 \
+   COMMAND("SetClassOfDevice", SetClassOfDevice, "Sets the local class of device.")                                    \
+      PARAMETER("Class", ptNumber, 0, 0xFFFFFF, NULL, FALSE)                                                           \
+   END                                                                                                                 \
+   COMMAND("GetRemoteName", GetRemoteName, "Queries the name of a device.")                                            \
+      PARAMETER("Device", ptDevice, 0, 0, NULL, FALSE)                                                                 \
+   END                                                                                                                 \
+   COMMAND("OpenHFServer", OpenHFServer, "Opens the Hands-Free server on an RFCOMM channel.")                          \
+      PARAMETER("Channel", ptNumber, 1, 30, NULL, FALSE)                                                               \
+   END                                                                                                                 \
+   COMMAND("CloseHFServer", CloseHFServer, "Closes the Hands-Free server.")                                            \
+   END                                                                                                                 \
+   COMMAND("ManageAudio", ManageAudioConnection, "Sets up (1) or releases (0) the audio connection.")                  \
+      PARAMETER("Setup", ptNumber, 0, 1, NULL, FALSE)                                                                  \
+   END                                                                                                                 \
+   COMMAND("AnswerCall", AnswerIncomingCall, "Answers the incoming call.")                                             \
+   END                                                                                                                 \
+   COMMAND("HangUpCall", HangUpCall, "Hangs up the call.")                                                             \
+   END                                                                                                                 \
+   COMMAND("Close", ClosePort, "Closes the connection to the AG.")                                                     \
+   END                                                                                                                 \
+   COMMAND("PeerCache", DisplayPeerCache, "Displays the peer cache (Clear 1 clears it).")                              \
+      PARAMETER("Clear", ptNumber, 0, 1, NULL, TRUE)                                                                   \
+   END                                                                                                                 \
+   COMMAND("Recovery", DisplayRecovery, "Displays the recovery state.")                                                \
+   END                                                                                                                 \
+   COMMAND("BootTimes", DisplayBootTimes, "Displays the boot phase times.")                                            \
+   END                                                                                                                 \
+   COMMAND("Snoop", DumpSnoop, "Dumps the HCI capture (or sets the captured payload bytes).")                          \
+      PARAMETER("Truncation", ptNumber, 0, BTSNOOP_MAXIMUM_TRUNCATION, NULL, TRUE)                                     \
+   END                                                                                                                 \
+   COMMAND("Stack", DisplayStackUsage, "Displays the stack usage (Reset 1 clears the peaks).")                         \
+      PARAMETER("Reset", ptNumber, 0, 1, NULL, TRUE)                                                                   \
+   END                                                                                                                 \
+   COMMAND("Advert", DisplayAdvertising, "Displays the LE advertising state.")                                         \
+   END                                                                                                                 \
+   HFP_SCAN_COMMANDS(COMMAND, PARAMETER, END)                                                                          \
+   COMMAND("ConnParam", DisplayConnParam, "Displays the LE connection parameter policy.")                              \
+   END                                                                                                                 \
+   HFP_GATT_CLIENT_COMMANDS(COMMAND, PARAMETER, END)                                                                   \
+   COMMAND("GATTDB", DisplayGATTDatabase, "Displays the GATT database.")                                               \
+   END                                                                                                                 \
+   COMMAND("GATTLong", DisplayGATTLong, "Displays the long attributes and prepared writes.")                           \
+   END                                                                                                                 \
+   COMMAND("Sniff", DisplaySniff, "Displays the sniff mode of the links.")                                             \
+   END                                                                                                                 \
+   COMMAND("Audio", DisplayAudioLink, "Displays the audio parameter sets and the last audio link.")                    \
+   END                                                                                                                 \
+   COMMAND("Flows", DisplayFlows, "Displays the stack operations in progress (inquiry, bonding, audio setup).")        \
+   END                                                                                                                 \
+   COMMAND("Stats", DisplayMetrics, "Displays the runtime metrics (Reset 1 clears them).")                             \
+      PARAMETER("Reset", ptNumber, 0, 1, NULL, TRUE)                                                                   \
+   END                                                                                                                 \
+   HFP_PROFILE_COMMANDS(COMMAND, PARAMETER, END)                                                                       \
+   HFP_MEM_POOL_COMMANDS(COMMAND, PARAMETER, END)                                                                      \
+   COMMAND("Help", DisplayHelp, "Lists the commands, or describes one.")                                               \
+      PARAMETER("Command", ptString, 1, 32, NULL, TRUE)                                                                \
+   END
+
+#endif
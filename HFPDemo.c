@@ -20,17 +20,24 @@
 #include "SS1BTHFR.h"      /* Bluetooth HFRE API Prototypes/Constants.        */
 #include "SS1BTVS.h"       /* Vendor Specific Prototypes/Constants.           */
 #include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
-
-#define MAX_SUPPORTED_COMMANDS                     (32)  /* Denotes the       */
-                                                         /* maximum number of */
-                                                         /* User Commands that*/
-                                                         /* are supported by  */
-                                                         /* this application. */
-
-#define MAX_NUM_OF_PARAMETERS                       (6)  /* Denotes the max   */
-                                                         /* number of         */
-                                                         /* parameters a      */
-                                                         /* command can have. */
+#include "PeerCache.h"     /* Peer Paging Information Cache.                  */
+#include "Recovery.h"      /* Retry/Backoff Recovery Scheduler.               */
+#include "BootSeq.h"       /* Boot Phase Timing.                              */
+#include "BTSnoop.h"       /* HCI Traffic Capture Prototypes/Constants.       */
+#include "Profile.h"       /* Handler Latency Profiling.                      */
+#include "MemPool.h"       /* Pool Allocator Prototypes/Constants.            */
+#include "StackMark.h"     /* Stack High Watermark.                           */
+#include "Advertise.h"     /* LE Advertising Manager.                         */
+#include "Scan.h"          /* LE Scanner Prototypes/Constants.                */
+#include "ConnParam.h"     /* Connection Parameter Policy Prototypes.         */
+#include "GATTClient.h"    /* GATT Client Prototypes/Constants.               */
+#include "GATTDatabase.h"  /* GATT Database Prototypes/Constants.             */
+#include "GATTLong.h"      /* GATT Long Attribute Prototypes/Constants.       */
+#include "Sniff.h"         /* Sniff Manager Prototypes/Constants.             */
+#include "AudioLink.h"     /* Audio Link Prototypes/Constants.                */
+#include "Coroutine.h"     /* Coroutine Prototypes/Constants.                 */
+#include "Metrics.h"       /* Metrics Prototypes/Constants.                   */
+#include "HFPCommands.h"   /* Console Command Schema.                         */
 
 #define MAX_COMMAND_LENGTH                         (64)  /* Denotes the max   */
                                                          /* buffer size used  */
@@ -86,6 +93,10 @@
                                                          /* required params.  */
                                                          /* were invalid.     */
 
+#define MISSING_PARAMETER_ERROR                   (-10)  /* Denotes that a    */
+                                                         /* required parameter*/
+                                                         /* was not given.    */
+
 #define UNABLE_TO_INITIALIZE_STACK                 (-7)  /* Denotes that an   */
                                                          /* error occurred    */
                                                          /* while initializing*/
@@ -105,11 +116,41 @@
                                                          /* create a Serial   */
                                                          /* Port Server.      */
 
+#define HFRE_RECONNECT_MAXIMUM_ATTEMPTS             (8)  /* Denotes the number*/
+                                                         /* of attempts that  */
+                                                         /* are made to       */
+                                                         /* reconnect to an AG*/
+                                                         /* after link loss.  */
+
+#define FLOW_EVENT_INQUIRY                          (1)  /* Denotes the events */
+#define FLOW_EVENT_CONNECTION                       (2)  /* that the stack     */
+#define FLOW_EVENT_AUTHENTICATION                   (3)  /* operations await   */
+#define FLOW_EVENT_AUDIO                            (4)  /* (see Coroutine.h). */
+
+#define INQUIRY_FLOW_TIMEOUT_MS                 (15000)  /* Denotes how long   */
+                                                         /* the operations may*/
+#define BONDING_FLOW_PAGE_TIMEOUT_MS            (10000)  /* await the event    */
+#define BONDING_FLOW_TIMEOUT_MS                 (60000)  /* that completes     */
+#define AUDIO_SETUP_FLOW_TIMEOUT_MS             (10000)  /* them (bonding      */
+                                                         /* waits for the user*/
+                                                         /* to answer).       */
+
+#define HFRE_AG_PROTOCOL_DESCRIPTOR_LIST_ID      (0x0004)  /* Denotes the SDP   */
+                                                         /* Attribute ID that */
+                                                         /* holds the RFCOMM  */
+                                                         /* Server Channel of */
+                                                         /* the AG.           */
+
 #define HFRE_SUPPORTED_FEATURES                    (HFRE_CLI_SUPPORTED_BIT | HFRE_HF_ENHANCED_CALL_STATUS_SUPPORTED_BIT | HFRE_HF_SOUND_ENHANCEMENT_SUPPORTED_BIT | HFRE_HF_VOICE_RECOGNITION_SUPPORTED_BIT | HFRE_HF_CODEC_NEGOTIATION_SUPPORTED_BIT)
 
    /* The following converts an ASCII character to an integer value.    */
 #define ToInt(_x)                                  (((_x) > 0x39)?((_x)-0x37):((_x)-0x30))
 
+   /* The following returns the Port ID of the currently connected AG.  */
+   /* This is the Client Port if the connection was re-established by   */
+   /* the Recovery logic, otherwise it is the Server Port.              */
+#define CURRENT_PORT_ID()                          ((HFClientPortID)?HFClientPortID:HFServerPortID)
+
    /* Determine the Name we will use for this compilation.              */
 #define LOCAL_DEVICE_NAME                          "SS1-WBS-16KHz"
 
@@ -125,13 +166,33 @@ typedef struct _tagLinkKeyInfo_t
    Link_Key_t LinkKey;
 } LinkKeyInfo_t;
 
+   /* The following macros expand the command schema into a union with  */
+   /* one member per command, one byte long plus one byte per parameter */
+   /* of the command, so the size of the union is one more than the     */
+   /* largest number of parameters.                                     */
+#define COUNT_COMMAND(_Name, _Function, _Description)                   char _Function[1
+#define COUNT_PARAMETER(_Name, _Type, _Minimum, _Maximum, _Names, _Optional) + 1
+#define COUNT_END                                                       ];
+
+typedef union
+{
+   HFP_COMMANDS(COUNT_COMMAND, COUNT_PARAMETER, COUNT_END)
+} ParameterCount_t;
+
+   /* The following denotes the max number of parameters a command has. */
+#define MAX_NUM_OF_PARAMETERS                      (sizeof(ParameterCount_t) - 1)
+
    /* The following type definition represents the structure which holds*/
    /* all information about the parameter, in particular the parameter  */
-   /* as a string and the parameter as an unsigned int.                 */
+   /* as a string (and its length, as found by the tokenizer) and its   */
+   /* value (the number, or the index of an enumeration value).  BD_ADDR*/
+   /* holds the address of a device parameter.                          */
 typedef struct _tagParameter_t
 {
-   char     *strParam;
-   SDWord_t  intParam;
+   char         *strParam;
+   unsigned int  Length;
+   SDWord_t      intParam;
+   BD_ADDR_t     BD_ADDR;
 } Parameter_t;
 
    /* The following type definition represents the structure which holds*/
@@ -144,27 +205,53 @@ typedef struct _tagParameterList_t
    Parameter_t Params[MAX_NUM_OF_PARAMETERS];
 } ParameterList_t;
 
-   /* The following type definition represents the structure which holds*/
-   /* the command and parameters to be executed.                        */
-typedef struct _tagUserCommand_t
-{
-   char            *Command;
-   ParameterList_t  Parameters;
-} UserCommand_t;
-
    /* The following type definition represents the generic function     */
    /* pointer to be used by all commands that can be executed by the    */
    /* test program.                                                     */
 typedef int (*CommandFunction_t)(ParameterList_t *TempParam);
 
    /* The following type definition represents the structure which holds*/
-   /* information used in the interpretation and execution of Commands. */
+   /* an entry of the command table (the expanded command schema, see   */
+   /* HFPCommands.h).  The entry of a command has a CommandFunction and */
+   /* is followed by the entries of its parameters, which have none.    */
 typedef struct _tagCommandTable_t
 {
    char              *CommandName;
+   unsigned int       NameLength;
    CommandFunction_t  CommandFunction;
+   char              *Description;
+   Parameter_Type_t   Type;
+   DWord_t            Minimum;
+   DWord_t            Maximum;
+   char              *Names;
+   Boolean_t          Optional;
 } CommandTable_t;
 
+   /* The following type definition represents the structure which holds*/
+   /* the command and parameters to be executed.  CommandEntry is the   */
+   /* entry of the command (NULL for Quit).  If the parameters are      */
+   /* invalid, ErrorParameter is the index of the one that is wrong (or */
+   /* the number of parameters if one is missing or there are too many).*/
+typedef struct _tagUserCommand_t
+{
+   char                 *Command;
+   unsigned int          CommandLength;
+   const CommandTable_t *CommandEntry;
+   unsigned int          ErrorParameter;
+   ParameterList_t       Parameters;
+} UserCommand_t;
+
+   /* The following type definition represents the container type which */
+   /* holds the state of the bonding operation that is kept across its  */
+   /* awaits.                                                           */
+typedef struct _tagBonding_Context_t
+{
+   Coroutine_t        Coroutine;
+   BD_ADDR_t          BD_ADDR;
+   GAP_Bonding_Type_t BondingType;
+   Boolean_t          Paged;
+} Bonding_Context_t;
+
    /* User to represent a structure to hold a BD_ADDR return from       */
    /* BD_ADDRToStr.                                                     */
 typedef char BoardStr_t[16];
@@ -208,6 +295,10 @@ static BD_ADDR_t           ConnectedBD_ADDR;        /* Variable which holds the
                                                     /* current BD_ADDR of the currently*/
                                                     /* connected AG.                   */
 
+static AudioLink_Codec_t   AudioCodec;              /* Variable which holds the codec  */
+                                                    /* the AG selected last (an audio  */
+                                                    /* setup starts out with it).      */
+
 static GAP_IO_Capability_t IOCapability;            /* Variable which holds the        */
                                                     /* current I/O Capabilities that   */
                                                     /* are to be used for Secure Simple*/
@@ -223,15 +314,32 @@ static Boolean_t           MITMProtection;          /* Variable which flags whet
                                                     /* during a Secure Simple Pairing  */
                                                     /* procedure.                      */
 
-static unsigned int        NumberCommands;          /* Variable which is used to hold  */
-                                                    /* the number of Commands that are */
-                                                    /* supported by this application.  */
-                                                    /* Commands are added individually.*/
+static unsigned int        HCIEventCallbackID;      /* Variable which holds the ID of  */
+                                                    /* the registered HCI Event        */
+                                                    /* Callback.                       */
 
-static CommandTable_t      CommandTable[MAX_SUPPORTED_COMMANDS]; /* Variable which is  */
-                                                    /* used to hold the actual Commands*/
-                                                    /* that are supported by this      */
-                                                    /* application.                    */
+static Coroutine_t         InquiryCoroutine;        /* Variables which hold the        */
+static Coroutine_t         AudioSetupCoroutine;     /* coroutines of the stack         */
+static Bonding_Context_t   BondingContext;          /* operations (one of each runs at */
+static Coroutine_t         ReconnectCoroutine;      /* a time).                        */
+
+static int                 HFClientPortID;          /* Variable which contains the     */
+                                                    /* Handle of the HFP Client Port   */
+                                                    /* that was opened to reconnect to */
+                                                    /* an AG.                          */
+
+static BD_ADDR_t           LostBD_ADDR;             /* Variable which holds the BD_ADDR*/
+                                                    /* of the AG whose connection was  */
+                                                    /* most recently closed.           */
+
+static Boolean_t           LinkLossDetected;        /* Variable which flags that a     */
+                                                    /* connection was lost due to a    */
+                                                    /* Supervision Timeout (as opposed */
+                                                    /* to being closed by either side).*/
+
+static BD_ADDR_t           ReconnectBD_ADDR;        /* Variable which holds the BD_ADDR*/
+                                                    /* of the AG that is currently     */
+                                                    /* being reconnected.              */
 
    /* The following string table is used to map HCI Version information */
    /* to an easily displayable version string.                          */
@@ -260,16 +368,21 @@ static char *IOCapabilitiesStrings[] =
 } ;
 
    /* Internal function prototypes.                                     */
-static void UserInterface(void);
 static Boolean_t CommandLineInterpreter(char *Command);
 
-static unsigned long StringToUnsignedInteger(char *StringInteger);
-static char *StringParser(char *String);
+static int HexDigit(char Character);
+static Boolean_t StringToUnsignedInteger(char *StringInteger, DWord_t *Value);
+static Boolean_t StringToBD_ADDR(char *String, unsigned int Length, BD_ADDR_t *BD_ADDR);
+static Boolean_t StringCompare(char *String1, char *String2, unsigned int Length);
+static char *StringParser(char **String, unsigned int *Length);
+static Boolean_t ParameterParser(const CommandTable_t *ParameterEntry, char *String, unsigned int Length, Parameter_t *Parameter);
 static int CommandParser(UserCommand_t *TempCommand, char *UserInput);
 static int CommandInterpreter(UserCommand_t *TempCommand);
-static int AddCommand(char *CommandName, CommandFunction_t CommandFunction);
-static CommandFunction_t FindCommand(char *Command);
-static void ClearCommands(void);
+static const CommandTable_t *FindCommand(char *Command, unsigned int Length);
+static unsigned int NumberParameters(const CommandTable_t *CommandEntry);
+static void DisplayUsage(const CommandTable_t *CommandEntry);
+static void DisplayParameterRange(const CommandTable_t *ParameterEntry);
+static void DisplayUsageError(UserCommand_t *TempCommand, int Error);
 
 static void BD_ADDRToStr(BD_ADDR_t Board_Address, char *BoardStr);
 static void DisplayPrompt(void);
@@ -312,308 +425,471 @@ static int ClosePort(ParameterList_t *TempParam);
 static int ManageAudioConnection(ParameterList_t *TempParam);
 static int AnswerIncomingCall(ParameterList_t *TempParam);
 static int HangUpCall(ParameterList_t *TempParam);
+static int DisplayPeerCache(ParameterList_t *TempParam);
+static int DisplayRecovery(ParameterList_t *TempParam);
+static int DisplayBootTimes(ParameterList_t *TempParam);
+static int DumpSnoop(ParameterList_t *TempParam);
+static int DisplayStackUsage(ParameterList_t *TempParam);
+static int DisplayAdvertising(ParameterList_t *TempParam);
+
+#ifdef SCAN_ENABLE
+
+static int ScanLE(ParameterList_t *TempParam);
+
+#endif
+
+static int DisplayConnParam(ParameterList_t *TempParam);
+
+#ifdef GATT_CLIENT_ENABLE
+
+static int DisplayGATTClient(ParameterList_t *TempParam);
+
+#endif
+
+static int DisplayGATTDatabase(ParameterList_t *TempParam);
+static int DisplayGATTLong(ParameterList_t *TempParam);
+static int DisplaySniff(ParameterList_t *TempParam);
+static int DisplayAudioLink(ParameterList_t *TempParam);
+static int DisplayFlows(ParameterList_t *TempParam);
+static void DisplayEventCounts(char *Name, unsigned int NumberTypes, unsigned long *Counts);
+static int DisplayMetrics(ParameterList_t *TempParam);
+
+#ifdef PROFILE_ENABLE
+
+static int DisplayProfile(ParameterList_t *TempParam);
+
+#endif
+
+#ifdef MEM_POOL_ENABLE
+
+static int DisplayMemPool(ParameterList_t *TempParam);
+
+#endif
+
+static Boolean_t IsBonded(BD_ADDR_t BD_ADDR);
+static void ScheduleReconnect(BD_ADDR_t BD_ADDR);
+static int ReconnectAudioGateway(unsigned long CallbackParameter);
+static int InquiryFlow(Coroutine_t *Coroutine, unsigned long CallbackParameter);
+static int BondingFlow(Coroutine_t *Coroutine, unsigned long CallbackParameter);
+static int ReconnectFlow(Coroutine_t *Coroutine, unsigned long CallbackParameter);
+static Boolean_t PageCachedDevice(BD_ADDR_t BD_ADDR);
+static int QueryAudioGatewayChannel(void);
+static int AudioSetupFlow(Coroutine_t *Coroutine, unsigned long CallbackParameter);
+static int FindRFCOMMServerChannel(SDP_Data_Element_t *SDP_Data_Element);
 
    /* Callback Function Prototypes.                                     */
+static void BTPSAPI HCI_Event_Callback(unsigned int BluetoothStackID, HCI_Event_Data_t *HCI_Event_Data, unsigned long CallbackParameter);
 static void BTPSAPI GAP_Event_Callback(unsigned int BluetoothStackID, GAP_Event_Data_t *GAPEventData, unsigned long CallbackParameter);
 static void BTPSAPI HFRE_Event_Callback(unsigned int BluetoothStackID, HFRE_Event_Data_t *HFRE_Event_Data, unsigned long CallbackParameter);
+static void BTPSAPI SDP_Event_Callback(unsigned int BluetoothStackID, unsigned int SDPRequestID, SDP_Response_Data_t *SDP_Response_Data, unsigned long CallbackParameter);
+
+#ifdef SCAN_ENABLE
+
+static void Scan_Report_Callback(Scan_Report_t *Report, unsigned long CallbackParameter);
+
+#endif
+
+   /* The following macros expand the command schema (see HFPCommands.h)*/
+   /* into the command table, the entry of a command followed by the    */
+   /* entries of its parameters.  The lengths of the names are taken at */
+   /* compile time.  The table is defined here as it refers to the      */
+   /* command functions.                                                */
+#define TABLE_COMMAND(_Name, _Function, _Description)                   { _Name, sizeof(_Name) - 1, _Function, _Description, ptNumber, 0, 0, NULL, FALSE },
+#define TABLE_PARAMETER(_Name, _Type, _Minimum, _Maximum, _Names, _Optional) { _Name, sizeof(_Name) - 1, NULL, NULL, _Type, _Minimum, _Maximum, _Names, _Optional },
+#define TABLE_END
+
+static const CommandTable_t CommandTable[] =
+{
+   HFP_COMMANDS(TABLE_COMMAND, TABLE_PARAMETER, TABLE_END)
+};
+
+   /* The following denotes the number of entries of the command table.*/
+#define NUMBER_COMMAND_TABLE_ENTRIES               (sizeof(CommandTable)/sizeof(CommandTable_t))
 
-   /* This function is responsible for taking the users input and do the*/
-   /* appropriate thing with it.  First, this function get a string of  */
-   /* user input, parse the user input in to command and parameters, and*/
-   /* finally executing the command or display an error message if the  */
-   /* input is corrupt.                                                 */
-static void UserInterface(void)
-{
-   /* First Clear all of the commands in the Command Table.             */
-   ClearCommands();
-
-   /* Now add all of the commands that are associated with the HID      */
-   /* Device unit to the Command Table.                                 */
-   AddCommand("INQUIRY", Inquiry);
-   AddCommand("DISPLAYINQUIRYLIST", DisplayInquiryList);
-   AddCommand("PAIR", Pair);
-   AddCommand("ENDPAIRING", EndPairing);
-   AddCommand("PINCODERESPONSE", PINCodeResponse);
-   AddCommand("PASSKEYRESPONSE", PassKeyResponse);
-   AddCommand("USERCONFIRMATIONRESPONSE", UserConfirmationResponse);
-   AddCommand("SETDISCOVERABILITYMODE", SetDiscoverabilityMode);
-   AddCommand("SETCONNECTABILITYMODE", SetConnectabilityMode);
-   AddCommand("SETPAIRABILITYMODE", SetPairabilityMode);
-   AddCommand("CHANGESIMPLEPAIRINGPARAMETERS", ChangeSimplePairingParameters);
-   AddCommand("GETLOCALADDRESS", GetLocalAddress);
-   AddCommand("SETLOCALNAME", SetLocalName);
-   AddCommand("GETLOCALNAME", GetLocalName);
-   AddCommand("SETCLASSOFDEVICE", SetClassOfDevice);
-   AddCommand("GETCLASSOFDEVICE", GetClassOfDevice);
-   AddCommand("GETREMOTENAME", GetRemoteName);
-   AddCommand("OPENHFSERVER", OpenHFServer);
-   AddCommand("CLOSEHFSERVER", CloseHFServer);
-   AddCommand("CLOSE", ClosePort);
-   AddCommand("MANAGEAUDIO", ManageAudioConnection);
-   AddCommand("ANSWERCALL", AnswerIncomingCall);
-   AddCommand("HANGUPCALL", HangUpCall);
-   AddCommand("HELP", DisplayHelp);
-}
-
-   /* The following function is responsible for parsing user input      */
-   /* and call appropriate command function.                            */
+   /* The following function is responsible for parsing user input and  */
+   /* call appropriate command function.  Input that does not fit the   */
+   /* command schema is reported with the usage of the command.  This   */
+   /* function returns TRUE if a command was executed.                  */
 static Boolean_t CommandLineInterpreter(char *Command)
 {
-   int           Result = !EXIT_CODE;
+   int           Result;
    Boolean_t     ret_val = FALSE;
    UserCommand_t TempCommand;
 
    /* The string input by the user contains a value, now run the string */
-   /* through the Command Parser.                                       */
-   if(CommandParser(&TempCommand, Command) >= 0)
+   /* through the Command Parser (which also checks the parameters).    */
+   Result = CommandParser(&TempCommand, Command);
+   switch(Result)
    {
-      Display(("\r\n"));
+      case 0:
+         Display(("\r\n"));
 
-      /* The Command was successfully parsed run the Command.           */
-      Result = CommandInterpreter(&TempCommand);
-      switch(Result)
-      {
-         case INVALID_COMMAND_ERROR:
-            Display(("Invalid Command: %s.\r\n",TempCommand.Command));
-            break;
-         case FUNCTION_ERROR:
-            Display(("Function Error.\r\n"));
-            break;
-         case EXIT_CODE:
-            break;
-      }
+         /* The Command was successfully parsed run the Command.        */
+         Result = CommandInterpreter(&TempCommand);
+         switch(Result)
+         {
+            case FUNCTION_ERROR:
+               Display(("Function Error.\r\n"));
+               break;
+            case EXIT_CODE:
+               break;
+         }
 
-      /* Display a prompt.                                              */
-      DisplayPrompt();
+         ret_val = TRUE;
+         break;
+      case INVALID_COMMAND_ERROR:
+      case INVALID_PARAMETERS_ERROR:
+      case MISSING_PARAMETER_ERROR:
+      case TO_MANY_PARAMS:
+         /* The command or its parameters are wrong, tell the user what */
+         /* is wrong and how the command is used.                       */
+         METRICS_COUNT(mcCommandsRejected);
+
+         Display(("\r\n"));
 
-      ret_val = TRUE;
+         DisplayUsageError(&TempCommand, Result);
+         break;
+      default:
+         Display(("\r\nInvalid Command.\r\n"));
+         break;
    }
+
+   /* Display a prompt.                                                 */
+   if(Result != NO_COMMAND_ERROR)
+      DisplayPrompt();
+
+   return(ret_val);
+}
+
+   /* The following function returns the value of the specified         */
+   /* hexadecimal digit, or a negative value if the character is not a  */
+   /* hexadecimal digit.                                                */
+static int HexDigit(char Character)
+{
+   int ret_val;
+
+   if((Character >= '0') && (Character <= '9'))
+      ret_val = Character - '0';
    else
-      Display(("\r\nInvalid Command.\r\n"));
+   {
+      if((Character >= 'a') && (Character <= 'f'))
+         ret_val = Character - 'a' + 10;
+      else
+      {
+         if((Character >= 'A') && (Character <= 'F'))
+            ret_val = Character - 'A' + 10;
+         else
+            ret_val = -1;
+      }
+   }
 
    return(ret_val);
 }
 
    /* The following function is responsible for converting number       */
-   /* strings to their unsigned integer equivalent.  This function can  */
-   /* handle leading and tailing white space, however it does not handle*/
-   /* signed or comma delimited values.  This function takes as its     */
-   /* input the string which is to be converted.  The function returns  */
-   /* zero if an error occurs otherwise it returns the value parsed from*/
-   /* the string passed as the input parameter.                         */
-static unsigned long StringToUnsignedInteger(char *StringInteger)
+   /* strings to their unsigned integer equivalent.  A hexadecimal      */
+   /* number has the 0x prefix.  The first parameter is the string which*/
+   /* is to be converted, the second parameter receives the value.  This*/
+   /* function returns TRUE if the whole string is a number that fits a */
+   /* DWord_t, FALSE otherwise.                                         */
+static Boolean_t StringToUnsignedInteger(char *StringInteger, DWord_t *Value)
 {
-   int           IsHex;
-   unsigned long Index;
-   unsigned long ret_val = 0;
+   int       Digit;
+   DWord_t   Base;
+   Boolean_t ret_val = FALSE;
 
-   /* Before proceeding make sure that the parameter that was passed as */
-   /* an input appears to be at least semi-valid.                       */
-   if((StringInteger) && (BTPS_StringLength(StringInteger)))
+   /* Before proceeding make sure that the parameters that were passed  */
+   /* appear to be at least semi-valid.                                 */
+   if((StringInteger) && (Value))
    {
-      /* Initialize the variable.                                       */
-      Index = 0;
-
       /* Next check to see if this is a hexadecimal number.             */
-      if(BTPS_StringLength(StringInteger) > 2)
+      if((StringInteger[0] == '0') && ((StringInteger[1] == 'x') || (StringInteger[1] == 'X')))
       {
-         if((StringInteger[0] == '0') && ((StringInteger[1] == 'x') || (StringInteger[1] == 'X')))
-         {
-            IsHex = 1;
-
-            /* Increment the String passed the Hexadecimal prefix.      */
-            StringInteger += 2;
-         }
-         else
-            IsHex = 0;
+         Base           = 16;
+         StringInteger += 2;
       }
       else
-         IsHex = 0;
+         Base = 10;
 
-      /* Process the value differently depending on whether or not a    */
-      /* Hexadecimal Number has been specified.                         */
-      if(!IsHex)
+      /* A number has at least one digit, each character must be a digit*/
+      /* of the base and the value must not overflow.                   */
+      *Value  = 0;
+      ret_val = (Boolean_t)(*StringInteger != '\0');
+      while((ret_val) && (*StringInteger))
       {
-         /* Decimal Number has been specified.                          */
-         while(1)
-         {
-            /* First check to make sure that this is a valid decimal    */
-            /* digit.                                                   */
-            if((StringInteger[Index] >= '0') && (StringInteger[Index] <= '9'))
-            {
-               /* This is a valid digit, add it to the value being      */
-               /* built.                                                */
-               ret_val += (StringInteger[Index] & 0xF);
+         Digit = HexDigit(*StringInteger++);
+         if((Digit >= 0) && ((DWord_t)Digit < Base) && (*Value <= (((DWord_t)0xFFFFFFFF - (DWord_t)Digit) / Base)))
+            *Value = (*Value * Base) + (DWord_t)Digit;
+         else
+            ret_val = FALSE;
+      }
+   }
 
-               /* Determine if the next digit is valid.                 */
-               if(((Index + 1) < BTPS_StringLength(StringInteger)) && (StringInteger[Index+1] >= '0') && (StringInteger[Index+1] <= '9'))
-               {
-                  /* The next digit is valid so multiply the current    */
-                  /* return value by 10.                                */
-                  ret_val *= 10;
-               }
-               else
-               {
-                  /* The next value is invalid so break out of the loop.*/
-                  break;
-               }
-            }
+   return(ret_val);
+}
 
-            Index++;
-         }
-      }
-      else
+   /* The following function is responsible for converting a string of  */
+   /* the specified length to a BD_ADDR.  The string is 0x followed by  */
+   /* 12 hexadecimal digits, or the six bytes separated by ':' (most    */
+   /* significant byte first).  This function returns TRUE if the string*/
+   /* is a BD_ADDR, FALSE otherwise.                                    */
+static Boolean_t StringToBD_ADDR(char *String, unsigned int Length, BD_ADDR_t *BD_ADDR)
+{
+   int          Digit;
+   Byte_t       Address[6];
+   Boolean_t    Separated;
+   Boolean_t    ret_val = FALSE;
+   unsigned int Index;
+
+   /* Before proceeding make sure that the parameters that were passed  */
+   /* appear to be at least semi-valid.                                 */
+   if((String) && (BD_ADDR))
+   {
+      /* Determine the form of the address from its length.             */
+      Separated = (Boolean_t)(Length == 17);
+      if((Separated) || ((Length == 14) && (String[0] == '0') && ((String[1] == 'x') || (String[1] == 'X'))))
       {
-         /* Hexadecimal Number has been specified.                      */
-         while(1)
+         if(!Separated)
+            String += 2;
+
+         /* Convert the 12 digits, the separated form has a ':' after   */
+         /* each byte but the last.                                     */
+         for(Index=0,ret_val=TRUE;(ret_val) && (Index<12);Index++)
          {
-            /* First check to make sure that this is a valid Hexadecimal*/
-            /* digit.                                                   */
-            if(((StringInteger[Index] >= '0') && (StringInteger[Index] <= '9')) || ((StringInteger[Index] >= 'a') && (StringInteger[Index] <= 'f')) || ((StringInteger[Index] >= 'A') && (StringInteger[Index] <= 'F')))
+            if((Digit = HexDigit(*String++)) >= 0)
             {
-               /* This is a valid digit, add it to the value being      */
-               /* built.                                                */
-               if((StringInteger[Index] >= '0') && (StringInteger[Index] <= '9'))
-                  ret_val += (StringInteger[Index] & 0xF);
-               else
-               {
-                  if((StringInteger[Index] >= 'a') && (StringInteger[Index] <= 'f'))
-                     ret_val += (StringInteger[Index] - 'a' + 10);
-                  else
-                     ret_val += (StringInteger[Index] - 'A' + 10);
-               }
-
-               /* Determine if the next digit is valid.                 */
-               if(((Index + 1) < BTPS_StringLength(StringInteger)) && (((StringInteger[Index+1] >= '0') && (StringInteger[Index+1] <= '9')) || ((StringInteger[Index+1] >= 'a') && (StringInteger[Index+1] <= 'f')) || ((StringInteger[Index+1] >= 'A') && (StringInteger[Index+1] <= 'F'))))
-               {
-                  /* The next digit is valid so multiply the current    */
-                  /* return value by 16.                                */
-                  ret_val *= 16;
-               }
+               if(Index & 1)
+                  Address[Index / 2] |= (Byte_t)Digit;
                else
-               {
-                  /* The next value is invalid so break out of the loop.*/
-                  break;
-               }
+                  Address[Index / 2]  = (Byte_t)(Digit << 4);
             }
+            else
+               ret_val = FALSE;
 
-            Index++;
+            if((ret_val) && (Separated) && (Index & 1) && (Index < 11) && (*String++ != ':'))
+               ret_val = FALSE;
          }
+
+         if(ret_val)
+            ASSIGN_BD_ADDR(*BD_ADDR, Address[0], Address[1], Address[2], Address[3], Address[4], Address[5]);
       }
    }
 
+   return(ret_val);
+}
+
+   /* The following function compares the specified number of characters*/
+   /* of two strings, ignoring the case.  This function returns TRUE if */
+   /* they are the same.                                                */
+static Boolean_t StringCompare(char *String1, char *String2, unsigned int Length)
+{
+   char      Character1;
+   char      Character2;
+   Boolean_t ret_val = TRUE;
+
+   while((ret_val) && (Length--))
+   {
+      Character1 = *String1++;
+      Character2 = *String2++;
+
+      if((Character1 >= 'a') && (Character1 <= 'z'))
+         Character1 -= ('a' - 'A');
+
+      if((Character2 >= 'a') && (Character2 <= 'z'))
+         Character2 -= ('a' - 'A');
+
+      ret_val = (Boolean_t)(Character1 == Character2);
+   }
+
    return(ret_val);
 }
 
    /* The following function is responsible for parsing strings into    */
    /* components.  The first parameter of this function is a pointer to */
-   /* the String to be parsed.  This function will return the start of  */
-   /* the string upon success and a NULL pointer on all errors.         */
-static char *StringParser(char *String)
+   /* the position in the String to be parsed, it is moved past the     */
+   /* component.  White space around the components is skipped.  The    */
+   /* second parameter receives the length of the component, so that it */
+   /* is never measured again.  This function will return the start of  */
+   /* the component (in the string, no copy is made) upon success and a */
+   /* NULL pointer if there are no more components.                     */
+static char *StringParser(char **String, unsigned int *Length)
 {
-   int   Index;
    char *ret_val = NULL;
 
    /* Before proceeding make sure that the string passed in appears to  */
    /* be at least semi-valid.                                           */
-   if((String) && (BTPS_StringLength(String)))
+   if((String) && (*String))
    {
-      /* The string appears to be at least semi-valid.  Search for the  */
-      /* first space character and replace it with a NULL terminating   */
-      /* character.                                                     */
-      for(Index=0, ret_val=String;Index < BTPS_StringLength(String);Index++)
+      /* Skip the white space in front of the component.                */
+      while((**String == ' ') || (**String == '\t') || (**String == '\r') || (**String == '\n'))
+         (*String)++;
+
+      if(**String)
       {
-         /* Is this the space character.                                */
-         if((String[Index] == ' ') || (String[Index] == '\r') || (String[Index] == '\n'))
+         /* Search for the end of the component and replace the         */
+         /* character after it with a NULL terminating character.       */
+         ret_val = *String;
+         while((**String) && (**String != ' ') && (**String != '\t') && (**String != '\r') && (**String != '\n'))
+            (*String)++;
+
+         *Length = (unsigned int)(*String - ret_val);
+
+         if(**String)
+            *((*String)++) = '\0';
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for converting a component  */
+   /* of the user input (of the specified length) to a parameter of the */
+   /* type of the specified parameter entry and checking its value.     */
+   /* This function returns TRUE if the parameter is valid.             */
+static Boolean_t ParameterParser(const CommandTable_t *ParameterEntry, char *String, unsigned int Length, Parameter_t *Parameter)
+{
+   char         *Names;
+   DWord_t       Value;
+   Boolean_t     ret_val = FALSE;
+   unsigned int  Index;
+
+   Parameter->strParam = String;
+   Parameter->Length   = Length;
+   Parameter->intParam = 0;
+   ASSIGN_BD_ADDR(Parameter->BD_ADDR, 0, 0, 0, 0, 0, 0);
+
+   switch(ParameterEntry->Type)
+   {
+      case ptNumber:
+         if((StringToUnsignedInteger(String, &Value)) && (Value >= ParameterEntry->Minimum) && (Value <= ParameterEntry->Maximum))
          {
-            /* This is the space character, replace it with a NULL      */
-            /* terminating character and set the return value to the    */
-            /* begining character of the string.                        */
-            String[Index] = '\0';
-            break;
+            Parameter->intParam = (SDWord_t)Value;
+            ret_val             = TRUE;
          }
-      }
+         break;
+      case ptEnumeration:
+         /* Look for the name of the value (in any case), the value may */
+         /* also be given as its index.                                 */
+         for(Names=ParameterEntry->Names,Index=0;(Names) && (*Names) && (!ret_val);Index++)
+         {
+            if((StringCompare(Names, String, Length)) && ((Names[Length] == '|') || (Names[Length] == '\0')))
+            {
+               Parameter->intParam = (SDWord_t)Index;
+               ret_val             = TRUE;
+            }
+            else
+            {
+               while((*Names) && (*Names != '|'))
+                  Names++;
+
+               if(*Names)
+                  Names++;
+            }
+         }
+
+         if((!ret_val) && (StringToUnsignedInteger(String, &Value)) && (Value >= ParameterEntry->Minimum) && (Value <= ParameterEntry->Maximum))
+         {
+            Parameter->intParam = (SDWord_t)Value;
+            ret_val             = TRUE;
+         }
+         break;
+      case ptString:
+         ret_val = (Boolean_t)((Length >= ParameterEntry->Minimum) && (Length <= ParameterEntry->Maximum));
+         break;
+      case ptDevice:
+         /* A device is a BD_ADDR or the index of a valid result of the */
+         /* last inquiry.                                               */
+         if(StringToBD_ADDR(String, Length, &(Parameter->BD_ADDR)))
+            ret_val = TRUE;
+         else
+         {
+            if((StringToUnsignedInteger(String, &Value)) && (Value) && (Value <= NumberofValidResponses) && (!COMPARE_NULL_BD_ADDR(InquiryResultList[Value - 1])))
+            {
+               Parameter->intParam = (SDWord_t)Value;
+               Parameter->BD_ADDR  = InquiryResultList[Value - 1];
+               ret_val             = TRUE;
+            }
+         }
+         break;
    }
 
    return(ret_val);
 }
 
    /* This function is responsable for taking command strings and       */
-   /* parsing them into a command, param1, and param2.  After parsing   */
-   /* this string the data is stored into a UserCommand_t structure to  */
-   /* be used by the interpreter.  The first parameter of this function */
-   /* is the structure used to pass the parsed command string out of the*/
-   /* function.  The second parameter of this function is the string    */
-   /* that is parsed into the UserCommand structure.  Successful        */
-   /* execution of this function is denoted by a retrun value of zero.  */
-   /* Negative return values denote an error in the parsing of the      */
-   /* string parameter.                                                 */
+   /* parsing them into a command and its parameters, in a single pass. */
+   /* The command is looked up in the command table and each parameter  */
+   /* is converted and checked against the schema of the command.  After*/
+   /* parsing this string the data is stored into a UserCommand_t       */
+   /* structure to be used by the interpreter.  The first parameter of  */
+   /* this function is the structure used to pass the parsed command    */
+   /* string out of the function.  The second parameter of this function*/
+   /* is the string that is parsed into the UserCommand structure.      */
+   /* Successful execution of this function is denoted by a retrun value*/
+   /* of zero.  Negative return values denote an error in the parsing of*/
+   /* the string parameter (ErrorParameter tells which parameter is     */
+   /* wrong).                                                           */
 static int CommandParser(UserCommand_t *TempCommand, char *UserInput)
 {
-   int            ret_val;
-   int            StringLength;
-   char          *LastParameter;
-   unsigned int   Count         = 0;
+   int           ret_val;
+   char         *LastParameter;
+   unsigned int  Length;
+   unsigned int  Count;
+   unsigned int  MaximumCount;
 
    /* Before proceeding make sure that the passed parameters appear to  */
    /* be at least semi-valid.                                           */
-   if((TempCommand) && (UserInput) && (BTPS_StringLength(UserInput)))
+   if(TempCommand)
    {
-      /* First get the initial string length.                           */
-      StringLength = BTPS_StringLength(UserInput);
+      TempCommand->CommandEntry                  = NULL;
+      TempCommand->ErrorParameter                = 0;
+      TempCommand->Parameters.NumberofParameters = 0;
 
       /* Retrieve the first token in the string, this should be the     */
       /* commmand.                                                      */
-      TempCommand->Command = StringParser(UserInput);
-
-      /* Flag that there are NO Parameters for this Command Parse.      */
-      TempCommand->Parameters.NumberofParameters = 0;
-
-       /* Check to see if there is a Command                            */
-      if(TempCommand->Command)
+      if((TempCommand->Command = StringParser(&UserInput, &(TempCommand->CommandLength))) != NULL)
       {
-         /* Initialize the return value to zero to indicate success on  */
-         /* commands with no parameters.                                */
-         ret_val    = 0;
-
-         /* Adjust the UserInput pointer and StringLength to remove the */
-         /* Command from the data passed in before parsing the          */
-         /* parameters.                                                 */
-         UserInput    += BTPS_StringLength(TempCommand->Command)+1;
-         StringLength  = BTPS_StringLength(UserInput);
-
-         /* There was an available command, now parse out the parameters*/
-         while((StringLength > 0) && ((LastParameter = StringParser(UserInput)) != NULL))
+         /* Quit has no entry in the command table, everything else must*/
+         /* be found there.                                             */
+         if((TempCommand->CommandLength == (sizeof("QUIT") - 1)) && (StringCompare(TempCommand->Command, "QUIT", TempCommand->CommandLength)))
+            ret_val = 0;
+         else
          {
-            /* There is an available parameter, now check to see if     */
-            /* there is room in the UserCommand to store the parameter  */
-            if(Count < (sizeof(TempCommand->Parameters.Params)/sizeof(Parameter_t)))
+            if((TempCommand->CommandEntry = FindCommand(TempCommand->Command, TempCommand->CommandLength)) != NULL)
             {
-               /* Save the parameter as a string.                       */
-               TempCommand->Parameters.Params[Count].strParam = LastParameter;
-
-               /* Save the parameter as an unsigned int intParam will   */
-               /* have a value of zero if an error has occurred.        */
-               TempCommand->Parameters.Params[Count].intParam = StringToUnsignedInteger(LastParameter);
+               MaximumCount = NumberParameters(TempCommand->CommandEntry);
+               Count        = 0;
+               ret_val      = 0;
+
+               /* There was an available command, now parse out the     */
+               /* parameters, each one is converted and checked as it is*/
+               /* found.                                                */
+               while((!ret_val) && ((LastParameter = StringParser(&UserInput, &Length)) != NULL))
+               {
+                  if(Count < MaximumCount)
+                  {
+                     if(ParameterParser(&(TempCommand->CommandEntry[Count + 1]), LastParameter, Length, &(TempCommand->Parameters.Params[Count])))
+                        Count++;
+                     else
+                        ret_val = INVALID_PARAMETERS_ERROR;
+                  }
+                  else
+                     ret_val = TO_MANY_PARAMS;
+               }
 
-               Count++;
-               UserInput    += BTPS_StringLength(LastParameter)+1;
-               StringLength -= BTPS_StringLength(LastParameter)+1;
+               /* The parameters that were not given must be optional.  */
+               if((!ret_val) && (Count < MaximumCount) && (!TempCommand->CommandEntry[Count + 1].Optional))
+                  ret_val = MISSING_PARAMETER_ERROR;
 
-               ret_val = 0;
+               /* Set the number of parameters in the User Command to   */
+               /* the number of found parameters, a parameter that is   */
+               /* wrong is the one after them.                          */
+               TempCommand->Parameters.NumberofParameters = (int)Count;
+               TempCommand->ErrorParameter                = Count;
             }
             else
-            {
-               /* Be sure we exit out of the Loop.                      */
-               StringLength = 0;
-
-               ret_val      = TO_MANY_PARAMS;
-            }
+               ret_val = INVALID_COMMAND_ERROR;
          }
-
-         /* Set the number of parameters in the User Command to the     */
-         /* number of found parameters                                  */
-         TempCommand->Parameters.NumberofParameters = Count;
       }
       else
       {
@@ -630,51 +906,46 @@ static int CommandParser(UserCommand_t *TempCommand, char *UserInput)
    return(ret_val);
 }
 
-   /* This function is responsible for determining the command in which */
-   /* the user entered and running the appropriate function associated  */
-   /* with that command.  The first parameter of this function is a     */
-   /* structure containing information about the commmand to be issued. */
-   /* This information includes the command name and multiple parameters*/
-   /* which maybe be passed to the function to be executed.  Successful */
-   /* execution of this function is denoted by a return value of zero.  */
-   /* A negative return value implies that that command was not found   */
-   /* and is invalid.                                                   */
+   /* This function is responsible for running the function associated  */
+   /* with the command that the user entered.  The first parameter of   */
+   /* this function is a structure containing information about the     */
+   /* commmand to be issued, as it was parsed by the CommandParser()    */
+   /* function.  Successful execution of this function is denoted by a  */
+   /* return value of zero.  A negative return value implies that the   */
+   /* command failed or is exit.                                        */
 static int CommandInterpreter(UserCommand_t *TempCommand)
 {
-   int               i;
-   int               ret_val;
-   CommandFunction_t CommandFunction;
-
-   /* If the command is not found in the table return with an invaild   */
-   /* command error                                                     */
-   ret_val = INVALID_COMMAND_ERROR;
+   int ret_val;
+   PROFILE_DECLARE(ProfileStart)
+   STACK_MARK_DECLARE(StackMark)
 
    /* Let's make sure that the data passed to us appears semi-valid.    */
    if((TempCommand) && (TempCommand->Command))
    {
-      /* Now, let's make the Command string all upper case so that we   */
-      /* compare against it.                                            */
-      for(i=0;i<BTPS_StringLength(TempCommand->Command);i++)
+      /* Quit is the only command without an entry in the table.        */
+      if(TempCommand->CommandEntry)
       {
-         if((TempCommand->Command[i] >= 'a') && (TempCommand->Command[i] <= 'z'))
-            TempCommand->Command[i] -= ('a' - 'A');
-      }
+         /* Call the command.                                           */
+         STACK_MARK_START(StackMark);
+         PROFILE_START(ProfileStart);
 
-      /* Check to see if the command which was entered was exit.        */
-      if(BTPS_MemCompare(TempCommand->Command, "QUIT", BTPS_StringLength("QUIT")) != 0)
-      {
-         /* The command entered is not exit so search for command in    */
-         /* table.                                                      */
-         if((CommandFunction = FindCommand(TempCommand->Command)) != NULL)
+         ret_val = (*TempCommand->CommandEntry->CommandFunction)(&TempCommand->Parameters);
+
+         PROFILE_STOP(ProfileStart, TempCommand->CommandEntry->CommandName, 0);
+         STACK_MARK_STOP(StackMark, TempCommand->CommandEntry->CommandName, 0);
+
+         METRICS_COUNT(mcCommands);
+
+         if(!ret_val)
          {
-            /* The command was found in the table so call the command.  */
-            if(!((*CommandFunction)(&TempCommand->Parameters)))
-            {
-               /* Return success to the caller.                         */
-               ret_val = 0;
-            }
-            else
-               ret_val = FUNCTION_ERROR;
+            /* Return success to the caller.                            */
+            ret_val = 0;
+         }
+         else
+         {
+            METRICS_COUNT(mcCommandErrors);
+
+            ret_val = FUNCTION_ERROR;
          }
       }
       else
@@ -690,73 +961,116 @@ static int CommandInterpreter(UserCommand_t *TempCommand)
    return(ret_val);
 }
 
-   /* The following function is provided to allow a means to            */
-   /* programatically add Commands the Global (to this module) Command  */
-   /* Table.  The Command Table is simply a mapping of Command Name     */
-   /* (NULL terminated ASCII string) to a command function.  This       */
-   /* function returns zero if successful, or a non-zero value if the   */
-   /* command could not be added to the list.                           */
-static int AddCommand(char *CommandName, CommandFunction_t CommandFunction)
+   /* The following function searches the Command Table for the         */
+   /* specified Command of the specified length (the case of the name   */
+   /* does not matter, only names of the same length are compared).  If */
+   /* the Command is found, this function returns a NON-NULL pointer to */
+   /* the Command Table entry.  If the command is not found this        */
+   /* function returns NULL.                                            */
+static const CommandTable_t *FindCommand(char *Command, unsigned int Length)
 {
-   int ret_val;
+   unsigned int          Index;
+   const CommandTable_t *ret_val = NULL;
 
-   /* First, make sure that the parameters passed to us appear to be    */
-   /* semi-valid.                                                       */
-   if((CommandName) && (CommandFunction))
+   /* First, make sure that the command specified is semi-valid.        */
+   if(Command)
    {
-      /* Next, make sure that we still have room in the Command Table   */
-      /* to add commands.                                               */
-      if(NumberCommands < MAX_SUPPORTED_COMMANDS)
+      /* Now loop through the command entries in the table to see if    */
+      /* there is a match.                                              */
+      for(Index=0;((Index<NUMBER_COMMAND_TABLE_ENTRIES) && (!ret_val));Index++)
       {
-         /* Simply add the command data to the command table and        */
-         /* increment the number of supported commands.                 */
-         CommandTable[NumberCommands].CommandName       = CommandName;
-         CommandTable[NumberCommands++].CommandFunction = CommandFunction;
-
-         /* Return success to the caller.                               */
-         ret_val                                        = 0;
+         if((CommandTable[Index].CommandFunction) && (Length == CommandTable[Index].NameLength) && (StringCompare(Command, CommandTable[Index].CommandName, Length)))
+            ret_val = &CommandTable[Index];
       }
-      else
-         ret_val = 1;
    }
-   else
-      ret_val = 1;
 
    return(ret_val);
 }
 
-   /* The following function searches the Command Table for the         */
-   /* specified Command.  If the Command is found, this function returns*/
-   /* a NON-NULL Command Function Pointer.  If the command is not found */
-   /* this function returns NULL.                                       */
-static CommandFunction_t FindCommand(char *Command)
+   /* The following function returns the number of parameters of the    */
+   /* command with the specified entry (the parameter entries that      */
+   /* follow it).                                                       */
+static unsigned int NumberParameters(const CommandTable_t *CommandEntry)
 {
-   unsigned int      Index;
-   CommandFunction_t ret_val;
+   unsigned int ret_val = 0;
 
-   /* First, make sure that the command specified is semi-valid.        */
-   if(Command)
-   {
-      /* Now loop through each element in the table to see if there is  */
-      /* a match.                                                       */
-      for(Index=0,ret_val=NULL;((Index<NumberCommands) && (!ret_val));Index++)
-      {
-         if(BTPS_MemCompare(Command, CommandTable[Index].CommandName, BTPS_StringLength(CommandTable[Index].CommandName)) == 0)
-            ret_val = CommandTable[Index].CommandFunction;
-      }
-   }
-   else
-      ret_val = NULL;
+   while((&CommandEntry[ret_val + 1] < &CommandTable[NUMBER_COMMAND_TABLE_ENTRIES]) && (!CommandEntry[ret_val + 1].CommandFunction))
+      ret_val++;
 
    return(ret_val);
 }
 
-   /* The following function is provided to allow a means to clear out  */
-   /* all available commands from the command table.                    */
-static void ClearCommands(void)
+   /* The following function displays the usage of the command with the */
+   /* specified entry, the required parameters in <> and the optional   */
+   /* ones in [].                                                       */
+static void DisplayUsage(const CommandTable_t *CommandEntry)
+{
+   unsigned int Index;
+   unsigned int Count;
+
+   Display(("%s", CommandEntry->CommandName));
+
+   for(Index=1,Count=NumberParameters(CommandEntry);Index<=Count;Index++)
+      Display((CommandEntry[Index].Optional?" [%s]":" <%s>", CommandEntry[Index].CommandName));
+}
+
+   /* The following function displays the values that the parameter with*/
+   /* the specified entry accepts.                                      */
+static void DisplayParameterRange(const CommandTable_t *ParameterEntry)
+{
+   switch(ParameterEntry->Type)
+   {
+      case ptNumber:
+         Display(("a number from %lu to %lu", (unsigned long)ParameterEntry->Minimum, (unsigned long)ParameterEntry->Maximum));
+         break;
+      case ptEnumeration:
+         Display(("one of %s (or 0 to %lu)", ParameterEntry->Names, (unsigned long)ParameterEntry->Maximum));
+         break;
+      case ptString:
+         Display(("%lu to %lu characters", (unsigned long)ParameterEntry->Minimum, (unsigned long)ParameterEntry->Maximum));
+         break;
+      case ptDevice:
+         if(NumberofValidResponses)
+            Display(("a BD_ADDR or an inquiry result (1 to %u)", NumberofValidResponses));
+         else
+            Display(("a BD_ADDR (there are no inquiry results)"));
+         break;
+   }
+}
+
+   /* The following function tells the user what is wrong with the      */
+   /* command that was parsed with the specified error, followed by the */
+   /* usage of the command.                                             */
+static void DisplayUsageError(UserCommand_t *TempCommand, int Error)
 {
-   /* Simply flag that there are no commands present in the table.      */
-   NumberCommands = 0;
+   const CommandTable_t *CommandEntry = TempCommand->CommandEntry;
+   const CommandTable_t *ParameterEntry;
+
+   if(CommandEntry)
+   {
+      ParameterEntry = &CommandEntry[TempCommand->ErrorParameter + 1];
+
+      switch(Error)
+      {
+         case INVALID_PARAMETERS_ERROR:
+            Display(("%s: parameter %u (%s) \"%s\" is invalid, expected ", CommandEntry->CommandName, TempCommand->ErrorParameter + 1, ParameterEntry->CommandName, TempCommand->Parameters.Params[TempCommand->ErrorParameter].strParam));
+            DisplayParameterRange(ParameterEntry);
+            Display((".\r\n"));
+            break;
+         case MISSING_PARAMETER_ERROR:
+            Display(("%s: parameter %u (%s) is missing.\r\n", CommandEntry->CommandName, TempCommand->ErrorParameter + 1, ParameterEntry->CommandName));
+            break;
+         default:
+            Display(("%s: takes at most %u parameter%s.\r\n", CommandEntry->CommandName, NumberParameters(CommandEntry), (NumberParameters(CommandEntry) == 1)?"":"s"));
+            break;
+      }
+
+      Display(("Usage: "));
+      DisplayUsage(CommandEntry);
+      Display(("\r\n"));
+   }
+   else
+      Display(("Invalid Command: %s (Help lists the commands).\r\n", TempCommand->Command));
 }
 
    /* The following function is responsible for converting data of type */
@@ -782,36 +1096,74 @@ static void DisplayFunctionError(char *Function, int Status)
 }
 
    /* The following function is responsible for redisplaying the Menu   */
-   /* options to the user.  This function returns zero on successful    */
-   /* execution or a negative value on all errors.                      */
+   /* options to the user, generated from the command schema.  With a   */
+   /* command name as the parameter the command is described instead.   */
+   /* This function returns zero on successful execution or a negative  */
+   /* value on all errors.                                              */
 static int DisplayHelp(ParameterList_t *TempParam)
 {
-   Display(("\r\n"));
-   Display(("******************************************************************\r\n"));
-   Display(("* Command Options: Inquiry, DisplayInquiryList, Pair,            *\r\n"));
-   Display(("*                  EndPairing, PINCodeResponse, PassKeyResponse, *\r\n"));
-   Display(("*                  UserConfirmationResponse,                     *\r\n"));
-   Display(("*                  SetDiscoverabilityMode, SetConnectabilityMode,*\r\n"));
-   Display(("*                  SetPairabilityMode,                           *\r\n"));
-   Display(("*                  ChangeSimplePairingParameters,                *\r\n"));
-   Display(("*                  GetLocalAddress, GetLocalName, SetLocalName,  *\r\n"));
-   Display(("*                  GetClassOfDevice, SetClassOfDevice,           *\r\n"));
-   Display(("*                  GetRemoteName, OpenHFServer, CloseHFServer    *\r\n"));
-   Display(("*                  ManageAudio, AnswerCall, HangUpCall, Close,   *\r\n"));
-   Display(("*                  Help                                          *\r\n"));
-   Display(("******************************************************************\r\n"));
+   int                   ret_val = 0;
+   unsigned int          Index;
+   unsigned int          Count;
+   const CommandTable_t *CommandEntry;
 
-   return(0);
-}
+   if((TempParam) && (TempParam->NumberofParameters > 0))
+   {
+      /* Describe the command with its parameters.                      */
+      if((CommandEntry = FindCommand(TempParam->Params[0].strParam, TempParam->Params[0].Length)) != NULL)
+      {
+         Display(("\r\n"));
+         DisplayUsage(CommandEntry);
+         Display(("\r\n   %s\r\n", CommandEntry->Description));
 
-   /* The following function is responsible for opening the SS1         */
-   /* Bluetooth Protocol Stack.  This function accepts a pre-populated  */
-   /* HCI Driver Information structure that contains the HCI Driver     */
-   /* Transport Information.  This function returns zero on successful  */
-   /* execution and a negative value on all errors.                     */
-static int OpenStack(HCI_DriverInformation_t *HCI_DriverInformation, BTPS_Initialization_t *BTPS_Initialization)
-{
-   int                        Result;
+         for(Index=1,Count=NumberParameters(CommandEntry);Index<=Count;Index++)
+         {
+            Display(("   %-14s ", CommandEntry[Index].CommandName));
+            DisplayParameterRange(&CommandEntry[Index]);
+            Display(("%s\r\n", CommandEntry[Index].Optional?" (optional)":""));
+         }
+      }
+      else
+      {
+         Display(("Help: %s is not a command.\r\n", TempParam->Params[0].strParam));
+
+         ret_val = INVALID_PARAMETERS_ERROR;
+      }
+   }
+   else
+   {
+      /* List the usage of every command.                               */
+      Display(("\r\n"));
+      Display(("******************************************************************\r\n"));
+      Display(("* Command Options:                                               *\r\n"));
+      Display(("******************************************************************\r\n"));
+
+      for(Index=0;Index<NUMBER_COMMAND_TABLE_ENTRIES;Index++)
+      {
+         if(CommandTable[Index].CommandFunction)
+         {
+            Display(("   "));
+            DisplayUsage(&CommandTable[Index]);
+            Display(("\r\n"));
+         }
+      }
+
+      Display(("******************************************************************\r\n"));
+      Display(("* Help <Command> describes a command and its parameters.         *\r\n"));
+      Display(("******************************************************************\r\n"));
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for opening the SS1         */
+   /* Bluetooth Protocol Stack.  This function accepts a pre-populated  */
+   /* HCI Driver Information structure that contains the HCI Driver     */
+   /* Transport Information.  This function returns zero on successful  */
+   /* execution and a negative value on all errors.                     */
+static int OpenStack(HCI_DriverInformation_t *HCI_DriverInformation, BTPS_Initialization_t *BTPS_Initialization)
+{
+   int                        Result;
    int                        ret_val;
    char                       BluetoothAddress[16];
    Byte_t                     Status;
@@ -830,11 +1182,16 @@ static int OpenStack(HCI_DriverInformation_t *HCI_DriverInformation, BTPS_Initia
          /* Initialize BTPSKNRl.                                        */
          BTPS_Init((void *)BTPS_Initialization);
 
+         /* Start timing the boot phases.                               */
+         BootSeq_Start();
+
          Display(("\r\nOpenStack().\r\n"));
 
          /* Initialize the Stack.                                       */
          Result = BSC_Initialize(HCI_DriverInformation, 0);
 
+         BootSeq_MarkPhase("Controller", BOOT_SEQ_CONTROLLER_BUDGET);
+
          /* Next, check the return value of the initialization to see if*/
          /* it was successful.                                          */
          if(Result > 0)
@@ -882,8 +1239,10 @@ static int OpenStack(HCI_DriverInformation_t *HCI_DriverInformation, BTPS_Initia
 
             L2CA_Set_Link_Connection_Configuration(BluetoothStackID, &L2CA_Link_Connect_Params);
 
+            /* Allow sniff mode as well, the idle links to the AG are   */
+            /* put into it once the service level connection is up.     */
             if(HCI_Command_Supported(BluetoothStackID, HCI_SUPPORTED_COMMAND_WRITE_DEFAULT_LINK_POLICY_BIT_NUMBER) > 0)
-               HCI_Write_Default_Link_Policy_Settings(BluetoothStackID, HCI_LINK_POLICY_SETTINGS_ENABLE_MASTER_SLAVE_SWITCH, &Status);
+               HCI_Write_Default_Link_Policy_Settings(BluetoothStackID, (HCI_LINK_POLICY_SETTINGS_ENABLE_MASTER_SLAVE_SWITCH | HCI_LINK_POLICY_SETTINGS_ENABLE_SNIFF_MODE), &Status);
 
             /* Delete all Stored Link Keys.                          */
             ASSIGN_BD_ADDR(BD_ADDR, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
@@ -896,6 +1255,20 @@ static int OpenStack(HCI_DriverInformation_t *HCI_DriverInformation, BTPS_Initia
 
             /* Set the Local Device Name.                            */
             GAP_Set_Local_Device_Name(BluetoothStackID, LOCAL_DEVICE_NAME);
+
+            /* Load the cached paging information of known devices and  */
+            /* register for the HCI events that keep it up to date.     */
+            Display(("Peer Cache: %d device(s) restored.\r\n", PeerCache_Initialize()));
+
+            Sniff_Initialize(BluetoothStackID);
+            AudioLink_Initialize(BluetoothStackID);
+
+            if((Result = HCI_Register_Event_Callback(BluetoothStackID, HCI_Event_Callback, 0)) > 0)
+               HCIEventCallbackID = (unsigned int)Result;
+            else
+               DisplayFunctionError("HCI_Register_Event_Callback()", Result);
+
+            BootSeq_MarkPhase("Stack Config", 0);
          }
          else
          {
@@ -941,6 +1314,34 @@ static int CloseStack(void)
    /* First check to see if the Stack has been opened.                  */
    if(BluetoothStackID)
    {
+      /* Un-register the HCI Event Callback (if registered).            */
+      if(HCIEventCallbackID)
+      {
+         HCI_Un_Register_Callback(BluetoothStackID, HCIEventCallbackID);
+
+         HCIEventCallbackID = 0;
+      }
+
+      /* Stop reconnecting to any AG, the connection cannot be         */
+      /* re-established without the stack.                             */
+      Recovery_Cancel(RECOVERY_ID_HFP_PEER);
+
+      HFClientPortID   = 0;
+      LinkLossDetected = FALSE;
+
+      Sniff_Cleanup();
+      AudioLink_Cleanup();
+
+      /* The operations in progress cannot complete without the stack.  */
+      Coroutine_Cancel(&InquiryCoroutine);
+      Coroutine_Cancel(&(BondingContext.Coroutine));
+      Coroutine_Cancel(&AudioSetupCoroutine);
+      Coroutine_Cancel(&ReconnectCoroutine);
+
+      /* Make sure any cached paging information that was learned is    */
+      /* not lost.                                                      */
+      PeerCache_Flush();
+
       /* Simply close the Stack                                         */
       BSC_Shutdown(BluetoothStackID);
 
@@ -1143,12 +1544,56 @@ static int DeleteLinkKey(BD_ADDR_t BD_ADDR)
    return(Result);
 }
 
+   /* The following function is the coroutine of an audio setup.  The   */
+   /* audio connection is set up and the coroutine awaits its outcome (a*/
+   /* failed mSBC setup goes on with CVSD without resuming the          */
+   /* coroutine).                                                       */
+static int AudioSetupFlow(Coroutine_t *Coroutine, unsigned long CallbackParameter)
+{
+   int Result;
+
+   COROUTINE_BEGIN(Coroutine);
+
+   /* Leave sniff mode ahead of the audio setup (the controller holds   */
+   /* the setup until the link is active).                              */
+   Sniff_Wake(ConnectedBD_ADDR);
+
+   /* Now submit the command (the AG selects the codec and sets up the  */
+   /* audio connection with its parameter sets).                        */
+   Result = AudioLink_Setup(ConnectedBD_ADDR, CURRENT_PORT_ID(), AudioCodec);
+   if(Result)
+   {
+      /* There was an error submitting the function.                    */
+      Display(("HFRE_Setup_Audio_Connection() Failure: %d.\r\n", Result));
+
+      COROUTINE_EXIT(Coroutine, Result);
+   }
+
+   /* The function was submitted successfully.                          */
+   Display(("HFRE_Setup_Audio_Connection: Function Successful.\r\n"));
+
+   COROUTINE_AWAIT(Coroutine, FLOW_EVENT_AUDIO, &ConnectedBD_ADDR, AUDIO_SETUP_FLOW_TIMEOUT_MS);
+
+   if(COROUTINE_AWAIT_RESULT(Coroutine) == COROUTINE_RESULT_TIMEOUT)
+   {
+      Display(("Audio Setup Timed Out.\r\n"));
+
+      COROUTINE_EXIT(Coroutine, FUNCTION_ERROR);
+   }
+
+   Display(("Audio Setup %s: Status 0x%04X, %lu ms.\r\n", (COROUTINE_AWAIT_RESULT(Coroutine))?"Failed":"Complete", COROUTINE_AWAIT_RESULT(Coroutine), BTPS_GetTickCount() - Coroutine->StartTime));
+
+   if(COROUTINE_AWAIT_RESULT(Coroutine))
+      COROUTINE_EXIT(Coroutine, FUNCTION_ERROR);
+
+   COROUTINE_END(Coroutine);
+}
+
    /* The following function is responsible for Setting up an Audio     */
    /* Connection.  This function returns zero on successful execution   */
    /* and a negative value on all errors.                               */
 static int HFRESetupAudioConnection(void)
 {
-   int Result;
    int ret_val;
 
    /* First, check that valid Bluetooth Stack ID exists.                */
@@ -1156,26 +1601,18 @@ static int HFRESetupAudioConnection(void)
    {
       /* Now check to make sure that the Port ID appears to be          */
       /* semi-valid.                                                    */
-      if(HFServerPortID)
+      if(CURRENT_PORT_ID())
       {
-         /* The Port ID appears to be a semi-valid value.  Now submit   */
-         /* the command.                                                */
-         Result  = HFRE_Setup_Audio_Connection(BluetoothStackID, HFServerPortID);
-
-         /* Set the return value of this function equal to the Result of*/
-         /* the function call.                                          */
-         ret_val = Result;
-
-         /* Now check to see if the command was submitted successfully. */
-         if(!Result)
-         {
-            /* The function was submitted successfully.                 */
-            Display(("HFRE_Setup_Audio_Connection: Function Successful.\r\n"));
-         }
+         /* The Port ID appears to be a semi-valid value.  Start the    */
+         /* setup, it runs on (interleaved with the other operations)   */
+         /* until the audio connection is up or every set failed.       */
+         ret_val = Coroutine_Start(&AudioSetupCoroutine, "Audio Setup", AudioSetupFlow, 0);
+         if(ret_val == COROUTINE_WAITING)
+            ret_val = 0;
          else
          {
-            /* There was an error submitting the function.              */
-            Display(("HFRE_Setup_Audio_Connection() Failure: %d.\r\n", Result));
+            if(ret_val == COROUTINE_ERROR_BUSY)
+               Display(("An Audio Setup is already in progress.\r\n"));
          }
       }
       else
@@ -1210,11 +1647,11 @@ static int HFREReleaseAudioConnection(void)
    {
       /* Now check to make sure that the Port ID appears to be          */
       /* semi-valid.                                                    */
-      if(HFServerPortID)
+      if(CURRENT_PORT_ID())
       {
          /* The Port ID appears to be a semi-valid value.  Now submit   */
          /* the command.                                                */
-         Result  = HFRE_Release_Audio_Connection(BluetoothStackID, HFServerPortID);
+         Result  = HFRE_Release_Audio_Connection(BluetoothStackID, CURRENT_PORT_ID());
 
          /* Set the return value of this function equal to the Result of*/
          /* the function call.                                          */
@@ -1251,6 +1688,40 @@ static int HFREReleaseAudioConnection(void)
    return(ret_val);
 }
 
+   /* The following function is the coroutine of an inquiry.  The       */
+   /* inquiry is started and the coroutine awaits its completion (the   */
+   /* results are recorded by the GAP_Event_Callback as they come in).  */
+static int InquiryFlow(Coroutine_t *Coroutine, unsigned long CallbackParameter)
+{
+   int Result;
+
+   COROUTINE_BEGIN(Coroutine);
+
+   /* Use the GAP_Perform_Inquiry() function to perform an Inquiry.  The*/
+   /* Inquiry will last the specified amount of time or until the       */
+   /* specified number of Bluetooth Device are found.                   */
+   Result = GAP_Perform_Inquiry(BluetoothStackID, itGeneralInquiry, 0, 0, 10, MAX_INQUIRY_RESULTS, GAP_Event_Callback, 0);
+   if(Result)
+   {
+      /* A error occurred while performing the Inquiry.                 */
+      Display(("Return Value is %d GAP_Perform_Inquiry() FAILURE.\r\n", Result));
+
+      COROUTINE_EXIT(Coroutine, Result);
+   }
+
+   Display(("Return Value is %d GAP_Perform_Inquiry() SUCCESS.\r\n", Result));
+   NumberofValidResponses = 0;
+
+   COROUTINE_AWAIT(Coroutine, FLOW_EVENT_INQUIRY, NULL, INQUIRY_FLOW_TIMEOUT_MS);
+
+   if(COROUTINE_AWAIT_RESULT(Coroutine) != COROUTINE_RESULT_TIMEOUT)
+      Display(("Inquiry Complete: %u Devices, %lu ms.\r\n", NumberofValidResponses, BTPS_GetTickCount() - Coroutine->StartTime));
+   else
+      Display(("Inquiry Timed Out.\r\n"));
+
+   COROUTINE_END(Coroutine);
+}
+
    /* The following function is responsible for performing a General    */
    /* Inquiry for discovering Bluetooth Devices.  This function requires*/
    /* that a valid Bluetooth Stack ID exists before running.  This      */
@@ -1263,27 +1734,15 @@ static int Inquiry(ParameterList_t *TempParam)
    /* First, check that valid Bluetooth Stack ID exists.                */
    if(BluetoothStackID)
    {
-      /* Use the GAP_Perform_Inquiry() function to perform an Inquiry.  */
-      /* The Inquiry will last the specified amount of time or until the*/
-      /* specified number of Bluetooth Device are found.  When the      */
-      /* Inquiry Results become available the GAP_Event_Callback is     */
-      /* called.                                                        */
-      ret_val = GAP_Perform_Inquiry(BluetoothStackID, itGeneralInquiry, 0, 0, 10, MAX_INQUIRY_RESULTS, GAP_Event_Callback, 0);
-
-      /* Next, check to see if the GAP_Perform_Inquiry() function was   */
-      /* successful.                                                    */
-      if(!ret_val)
-      {
-         /* The Inquiry appears to have been sent successfully.         */
-         /* Processing of the results returned from this command occurs */
-         /* within the GAP_Event_Callback() function.                   */
-         Display(("Return Value is %d GAP_Perform_Inquiry() SUCCESS.\r\n", ret_val));
-         NumberofValidResponses = 0;
-      }
+      /* Start the inquiry, it runs on (interleaved with the other      */
+      /* operations) until the GAP_Event_Callback reports its results.  */
+      ret_val = Coroutine_Start(&InquiryCoroutine, "Inquiry", InquiryFlow, 0);
+      if(ret_val == COROUTINE_WAITING)
+         ret_val = 0;
       else
       {
-         /* A error occurred while performing the Inquiry.              */
-         Display(("Return Value is %d GAP_Perform_Inquiry() FAILURE.\r\n", ret_val));
+         if(ret_val == COROUTINE_ERROR_BUSY)
+            Display(("An Inquiry is already in progress.\r\n"));
       }
    }
    else
@@ -1346,50 +1805,38 @@ static int SetDiscoverabilityMode(ParameterList_t *TempParam)
    /* First, check that valid Bluetooth Stack ID exists.                */
    if(BluetoothStackID)
    {
-      /* Make sure that all of the parameters required for this function*/
-      /* appear to be at least semi-valid.                              */
-      if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam >= 0) && (TempParam->Params[0].intParam <= 2))
+      /* The parameters were checked by the parser, map the specified   */
+      /* parameters into the API specific parameters.                   */
+      if(TempParam->Params[0].intParam == 1)
+         DiscoverabilityMode = dmLimitedDiscoverableMode;
+      else
       {
-         /* Parameters appear to be valid, map the specified parameters */
-         /* into the API specific parameters.                           */
-         if(TempParam->Params[0].intParam == 1)
-            DiscoverabilityMode = dmLimitedDiscoverableMode;
+         if(TempParam->Params[0].intParam == 2)
+            DiscoverabilityMode = dmGeneralDiscoverableMode;
          else
-         {
-            if(TempParam->Params[0].intParam == 2)
-               DiscoverabilityMode = dmGeneralDiscoverableMode;
-            else
-               DiscoverabilityMode = dmNonDiscoverableMode;
-         }
-
-         /* Parameters mapped, now set the Discoverability Mode.        */
-         Result = GAP_Set_Discoverability_Mode(BluetoothStackID, DiscoverabilityMode, (DiscoverabilityMode == dmLimitedDiscoverableMode)?60:0);
+            DiscoverabilityMode = dmNonDiscoverableMode;
+      }
 
-         /* Next, check the return value to see if the command was      */
-         /* issued successfully.                                        */
-         if(Result >= 0)
-         {
-            /* The Mode was changed successfully.                       */
-            Display(("Discoverability Mode successfully set to: %s Discoverable.\r\n", (DiscoverabilityMode == dmNonDiscoverableMode)?"Non":((DiscoverabilityMode == dmGeneralDiscoverableMode)?"General":"Limited")));
+      /* Parameters mapped, now set the Discoverability Mode.           */
+      Result = GAP_Set_Discoverability_Mode(BluetoothStackID, DiscoverabilityMode, (DiscoverabilityMode == dmLimitedDiscoverableMode)?60:0);
 
-            /* Flag success to the caller.                              */
-            ret_val = 0;
-         }
-         else
-         {
-            /* There was an error setting the Mode.                     */
-            Display(("GAP_Set_Discoverability_Mode() Failure: %d.\r\n", Result));
+      /* Next, check the return value to see if the command was issued  */
+      /* successfully.                                                  */
+      if(Result >= 0)
+      {
+         /* The Mode was changed successfully.                          */
+         Display(("Discoverability Mode successfully set to: %s Discoverable.\r\n", (DiscoverabilityMode == dmNonDiscoverableMode)?"Non":((DiscoverabilityMode == dmGeneralDiscoverableMode)?"General":"Limited")));
 
-            /* Flag that an error occurred while submitting the command.*/
-            ret_val = FUNCTION_ERROR;
-         }
+         /* Flag success to the caller.                                 */
+         ret_val = 0;
       }
       else
       {
-         /* One or more of the necessary parameters is/are invalid.     */
-         Display(("Usage: SetDiscoverabilityMode [Mode (0 = Non Discoverable, 1 = Limited Discoverable, 2 = General Discoverable)].\r\n"));
+         /* There was an error setting the Mode.                        */
+         Display(("GAP_Set_Discoverability_Mode() Failure: %d.\r\n", Result));
 
-         ret_val = INVALID_PARAMETERS_ERROR;
+         /* Flag that an error occurred while submitting the command.   */
+         ret_val = FUNCTION_ERROR;
       }
    }
    else
@@ -1413,45 +1860,33 @@ static int SetConnectabilityMode(ParameterList_t *TempParam)
    /* First, check that valid Bluetooth Stack ID exists.                */
    if(BluetoothStackID)
    {
-      /* Make sure that all of the parameters required for this function*/
-      /* appear to be at least semi-valid.                              */
-      if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam >= 0) && (TempParam->Params[0].intParam <= 1))
-      {
-         /* Parameters appear to be valid, map the specified parameters */
-         /* into the API specific parameters.                           */
-         if(TempParam->Params[0].intParam == 0)
-            ConnectableMode = cmNonConnectableMode;
-         else
-            ConnectableMode = cmConnectableMode;
-
-         /* Parameters mapped, now set the Connectabilty Mode.          */
-         Result = GAP_Set_Connectability_Mode(BluetoothStackID, ConnectableMode);
+      /* The parameters were checked by the parser, map the specified   */
+      /* parameters into the API specific parameters.                   */
+      if(TempParam->Params[0].intParam == 0)
+         ConnectableMode = cmNonConnectableMode;
+      else
+         ConnectableMode = cmConnectableMode;
 
-         /* Next, check the return value to see if the command was      */
-         /* issued successfully.                                        */
-         if(Result >= 0)
-         {
-            /* The Mode was changed successfully.                       */
-            Display(("Connectability Mode successfully set to: %s.\r\n", (ConnectableMode == cmNonConnectableMode)?"Non Connectable":"Connectable"));
+      /* Parameters mapped, now set the Connectabilty Mode.             */
+      Result = GAP_Set_Connectability_Mode(BluetoothStackID, ConnectableMode);
 
-            /* Flag success to the caller.                              */
-            ret_val = 0;
-         }
-         else
-         {
-            /* There was an error setting the Mode.                     */
-            Display(("GAP_Set_Connectability_Mode() Failure: %d.\r\n", Result));
+      /* Next, check the return value to see if the command was issued  */
+      /* successfully.                                                  */
+      if(Result >= 0)
+      {
+         /* The Mode was changed successfully.                          */
+         Display(("Connectability Mode successfully set to: %s.\r\n", (ConnectableMode == cmNonConnectableMode)?"Non Connectable":"Connectable"));
 
-            /* Flag that an error occurred while submitting the command.*/
-            ret_val = FUNCTION_ERROR;
-         }
+         /* Flag success to the caller.                                 */
+         ret_val = 0;
       }
       else
       {
-         /* One or more of the necessary parameters is/are invalid.     */
-         Display(("Usage: SetConnectabilityMode [Mode (0 = Non Conectable, 1 = Connectable)].\r\n"));
+         /* There was an error setting the Mode.                        */
+         Display(("GAP_Set_Connectability_Mode() Failure: %d.\r\n", Result));
 
-         ret_val = INVALID_PARAMETERS_ERROR;
+         /* Flag that an error occurred while submitting the command.   */
+         ret_val = FUNCTION_ERROR;
       }
    }
    else
@@ -1475,55 +1910,43 @@ static int SetPairabilityMode(ParameterList_t *TempParam)
    /* First, check that valid Bluetooth Stack ID exists.                */
    if(BluetoothStackID)
    {
-      /* Make sure that all of the parameters required for this function*/
-      /* appear to be at least semi-valid.                              */
-      if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam >= 0) && (TempParam->Params[0].intParam <= 2))
+      /* The parameters were checked by the parser, map the specified   */
+      /* parameters into the API specific parameters.                   */
+      if(TempParam->Params[0].intParam == 0)
+         PairabilityMode = pmNonPairableMode;
+      else
       {
-         /* Parameters appear to be valid, map the specified parameters */
-         /* into the API specific parameters.                           */
-         if(TempParam->Params[0].intParam == 0)
-            PairabilityMode = pmNonPairableMode;
+         if(TempParam->Params[0].intParam == 1)
+            PairabilityMode = pmPairableMode;
          else
-         {
-            if(TempParam->Params[0].intParam == 1)
-               PairabilityMode = pmPairableMode;
-            else
-               PairabilityMode = pmPairableMode_EnableSecureSimplePairing;
-         }
-
-         /* Parameters mapped, now set the Pairability Mode.            */
-         Result = GAP_Set_Pairability_Mode(BluetoothStackID, PairabilityMode);
+            PairabilityMode = pmPairableMode_EnableSecureSimplePairing;
+      }
 
-         /* Next, check the return value to see if the command was      */
-         /* issued successfully.                                        */
-         if(Result >= 0)
-         {
-            /* The Mode was changed successfully.                       */
-            Display(("Pairability Mode successfully set to: %s.\r\n", (PairabilityMode == pmNonPairableMode)?"Non Pairable":((PairabilityMode == pmPairableMode)?"Pairable":"Pairable (Secure Simple Pairing)")));
+      /* Parameters mapped, now set the Pairability Mode.               */
+      Result = GAP_Set_Pairability_Mode(BluetoothStackID, PairabilityMode);
 
-            /* If Secure Simple Pairing has been enabled, inform the    */
-            /* user of the current Secure Simple Pairing parameters.    */
-            if(PairabilityMode == pmPairableMode_EnableSecureSimplePairing)
-               Display(("Current I/O Capabilities: %s, MITM Protection: %s.\r\n", IOCapabilitiesStrings[(unsigned int)IOCapability], MITMProtection?"TRUE":"FALSE"));
+      /* Next, check the return value to see if the command was issued  */
+      /* successfully.                                                  */
+      if(Result >= 0)
+      {
+         /* The Mode was changed successfully.                          */
+         Display(("Pairability Mode successfully set to: %s.\r\n", (PairabilityMode == pmNonPairableMode)?"Non Pairable":((PairabilityMode == pmPairableMode)?"Pairable":"Pairable (Secure Simple Pairing)")));
 
-            /* Flag success to the caller.                              */
-            ret_val = 0;
-         }
-         else
-         {
-            /* There was an error setting the Mode.                     */
-            Display(("GAP_Set_Pairability_Mode() Failure: %d.\r\n", Result));
+         /* If Secure Simple Pairing has been enabled, inform the user  */
+         /* of the current Secure Simple Pairing parameters.            */
+         if(PairabilityMode == pmPairableMode_EnableSecureSimplePairing)
+            Display(("Current I/O Capabilities: %s, MITM Protection: %s.\r\n", IOCapabilitiesStrings[(unsigned int)IOCapability], MITMProtection?"TRUE":"FALSE"));
 
-            /* Flag that an error occurred while submitting the command.*/
-            ret_val = FUNCTION_ERROR;
-         }
+         /* Flag success to the caller.                                 */
+         ret_val = 0;
       }
       else
       {
-         /* One or more of the necessary parameters is/are invalid.     */
-         Display(("Usage: SetPairabilityMode [Mode (0 = Non Pairable, 1 = Pairable, 2 = Pairable (Secure Simple Pairing)].\r\n"));
+         /* There was an error setting the Mode.                        */
+         Display(("GAP_Set_Pairability_Mode() Failure: %d.\r\n", Result));
 
-         ret_val = INVALID_PARAMETERS_ERROR;
+         /* Flag that an error occurred while submitting the command.   */
+         ret_val = FUNCTION_ERROR;
       }
    }
    else
@@ -1547,43 +1970,31 @@ static int ChangeSimplePairingParameters(ParameterList_t *TempParam)
    /* First, check that valid Bluetooth Stack ID exists.                */
    if(BluetoothStackID)
    {
-      /* Make sure that all of the parameters required for this function*/
-      /* appear to be at least semi-valid.                              */
-      if((TempParam) && (TempParam->NumberofParameters >= 2) && (TempParam->Params[0].intParam >= 0) && (TempParam->Params[0].intParam <= 3))
+      /* The parameters were checked by the parser, map the specified   */
+      /* parameters into the API specific parameters.                   */
+      if(TempParam->Params[0].intParam == 0)
+         IOCapability = icDisplayOnly;
+      else
       {
-         /* Parameters appear to be valid, map the specified parameters */
-         /* into the API specific parameters.                           */
-         if(TempParam->Params[0].intParam == 0)
-            IOCapability = icDisplayOnly;
+         if(TempParam->Params[0].intParam == 1)
+            IOCapability = icDisplayYesNo;
          else
          {
-            if(TempParam->Params[0].intParam == 1)
-               IOCapability = icDisplayYesNo;
+            if(TempParam->Params[0].intParam == 2)
+               IOCapability = icKeyboardOnly;
             else
-            {
-               if(TempParam->Params[0].intParam == 2)
-                  IOCapability = icKeyboardOnly;
-               else
-                  IOCapability = icNoInputNoOutput;
-            }
+               IOCapability = icNoInputNoOutput;
          }
+      }
 
-         /* Finally map the Man in the Middle (MITM) Protection valud.  */
-         MITMProtection = (Boolean_t)(TempParam->Params[1].intParam?TRUE:FALSE);
-
-         /* Inform the user of the New I/O Capablities.                 */
-         Display(("Current I/O Capabilities: %s, MITM Protection: %s.\r\n", IOCapabilitiesStrings[(unsigned int)IOCapability], MITMProtection?"TRUE":"FALSE"));
+      /* Finally map the Man in the Middle (MITM) Protection valud.     */
+      MITMProtection = (Boolean_t)(TempParam->Params[1].intParam?TRUE:FALSE);
 
-         /* Flag success to the caller.                                 */
-         ret_val = 0;
-      }
-      else
-      {
-         /* One or more of the necessary parameters is/are invalid.     */
-         Display(("Usage: ChangeSimplePairingParameters [I/O Capability (0 = Display Only, 1 = Display Yes/No, 2 = Keyboard Only, 3 = No Input/Output)] [MITM Requirement (0 = No, 1 = Yes)].\r\n"));
+      /* Inform the user of the New I/O Capablities.                    */
+      Display(("Current I/O Capabilities: %s, MITM Protection: %s.\r\n", IOCapabilitiesStrings[(unsigned int)IOCapability], MITMProtection?"TRUE":"FALSE"));
 
-         ret_val = INVALID_PARAMETERS_ERROR;
-      }
+      /* Flag success to the caller.                                    */
+      ret_val = 0;
    }
    else
    {
@@ -1591,6 +2002,105 @@ static int ChangeSimplePairingParameters(ParameterList_t *TempParam)
       ret_val = INVALID_STACK_ID_ERROR;
    }
 
+   return(ret_val);
+}
+
+   /* The following function is the coroutine of a bond.  If the paging */
+   /* parameters of the device are known, the device is paged directly  */
+   /* with them (this is much faster than a blind page) and bonding is  */
+   /* initiated once the connection is complete, otherwise GAP pages the*/
+   /* device as part of the bonding procedure.  The coroutine then      */
+   /* awaits the status of the authentication.                          */
+static int BondingFlow(Coroutine_t *Coroutine, unsigned long CallbackParameter)
+{
+   int                Result;
+   Bonding_Context_t *Context;
+
+   Context = (Bonding_Context_t *)CallbackParameter;
+
+   COROUTINE_BEGIN(Coroutine);
+
+   Context->Paged = PageCachedDevice(Context->BD_ADDR);
+
+   if(Context->Paged)
+      Display(("Bonding (%s) will be initiated when connected.\r\n", (Context->BondingType == btDedicated)?"Dedicated":"General"));
+
+   if(Context->Paged)
+   {
+      COROUTINE_AWAIT(Coroutine, FLOW_EVENT_CONNECTION, &(Context->BD_ADDR), BONDING_FLOW_PAGE_TIMEOUT_MS);
+
+      /* If the cached page failed GAP will simply page the device again*/
+      /* (blind).                                                       */
+      if(COROUTINE_AWAIT_RESULT(Coroutine) != HCI_ERROR_CODE_NO_ERROR)
+         PeerCache_PageStarted(Context->BD_ADDR, FALSE);
+   }
+   else
+      PeerCache_PageStarted(Context->BD_ADDR, FALSE);
+
+   /* Attempt to submit the command.                                    */
+   Result = GAP_Initiate_Bonding(BluetoothStackID, Context->BD_ADDR, Context->BondingType, GAP_Event_Callback, (unsigned long)0);
+
+   /* Check the return value of the submitted command for success.      */
+   if(!Result)
+      Display(("GAP_Initiate_Bonding (%s): Function Successful.\r\n", (Context->BondingType == btDedicated)?"Dedicated":"General"));
+   else
+      Display(("GAP_Initiate_Bonding() Failure: %d.\r\n", Result));
+
+   /* The bonding was initiated from the callback of the connection,    */
+   /* show the prompt again.                                            */
+   if(Context->Paged)
+      DisplayPrompt();
+
+   if(Result)
+      COROUTINE_EXIT(Coroutine, FUNCTION_ERROR);
+
+   COROUTINE_AWAIT(Coroutine, FLOW_EVENT_AUTHENTICATION, &(Context->BD_ADDR), BONDING_FLOW_TIMEOUT_MS);
+
+   if(COROUTINE_AWAIT_RESULT(Coroutine) == COROUTINE_RESULT_TIMEOUT)
+   {
+      Display(("Bonding Timed Out.\r\n"));
+
+      COROUTINE_EXIT(Coroutine, FUNCTION_ERROR);
+   }
+
+   Display(("Bonding %s: Status %d, %lu ms.\r\n", (COROUTINE_AWAIT_RESULT(Coroutine))?"Failed":"Complete", COROUTINE_AWAIT_RESULT(Coroutine), BTPS_GetTickCount() - Coroutine->StartTime));
+
+   if(COROUTINE_AWAIT_RESULT(Coroutine))
+      COROUTINE_EXIT(Coroutine, FUNCTION_ERROR);
+
+   COROUTINE_END(Coroutine);
+}
+
+   /* The following function is a utility function that pages the       */
+   /* specified device with its cached paging parameters (much faster   */
+   /* than a blind page).  This function returns TRUE if the page was   */
+   /* started, the Connection Complete event is then signalled as       */
+   /* FLOW_EVENT_CONNECTION.  FALSE is returned if nothing is cached for*/
+   /* the device or the page could not be started.                      */
+static Boolean_t PageCachedDevice(BD_ADDR_t BD_ADDR)
+{
+   int              Result;
+   Byte_t           Status;
+   Boolean_t        ret_val;
+   PeerCacheEntry_t PeerCacheEntry;
+
+   ret_val = FALSE;
+
+   if(PeerCache_Query(BD_ADDR, &PeerCacheEntry))
+   {
+      Result = HCI_Create_Connection(BluetoothStackID, PeerCacheEntry.BD_ADDR, (HCI_PACKET_ACL_TYPE_DM1 | HCI_PACKET_ACL_TYPE_DH1 | HCI_PACKET_ACL_TYPE_DM3 | HCI_PACKET_ACL_TYPE_DH3 | HCI_PACKET_ACL_TYPE_DM5 | HCI_PACKET_ACL_TYPE_DH5), PeerCacheEntry.Page_Scan_Repetition_Mode, 0, (Word_t)(PeerCacheEntry.Clock_Offset | 0x8000), HCI_ROLE_SWITCH_LOCAL_MASTER_ACCEPT_ROLE_SWITCH, &Status);
+      if((!Result) && (Status == HCI_ERROR_CODE_NO_ERROR))
+      {
+         PeerCache_PageStarted(PeerCacheEntry.BD_ADDR, TRUE);
+
+         Display(("HCI_Create_Connection (Clock Offset 0x%04X, PSRM %u): Function Successful.\r\n", PeerCacheEntry.Clock_Offset, PeerCacheEntry.Page_Scan_Repetition_Mode));
+
+         ret_val = TRUE;
+      }
+      else
+         Display(("HCI_Create_Connection() Failure: %d, 0x%02X.\r\n", Result, Status));
+   }
+
    return(ret_val);
 }
 
@@ -1599,12 +2109,7 @@ static int ChangeSimplePairingParameters(ParameterList_t *TempParam)
    /* execution and a negative value on all errors.                     */
 static int Pair(ParameterList_t *TempParam)
 {
-   int                Result;
-   int                ret_val;
-   BD_ADDR_t          NullADDR;
-   GAP_Bonding_Type_t BondingType;
-
-   ASSIGN_BD_ADDR(NullADDR, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+   int ret_val;
 
    /* First, check that valid Bluetooth Stack ID exists.                */
    if(BluetoothStackID)
@@ -1612,51 +2117,35 @@ static int Pair(ParameterList_t *TempParam)
       /* Next, make sure that we are not already connected.             */
       if(COMPARE_NULL_BD_ADDR(ConnectedBD_ADDR))
       {
-         /* There is no currently active connection, make sure that all */
-         /* of the parameters required for this function appear to be at*/
-         /* least semi-valid.                                           */
-         if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam) && (NumberofValidResponses) && (TempParam->Params[0].intParam <= NumberofValidResponses) && (!COMPARE_BD_ADDR(InquiryResultList[(TempParam->Params[0].intParam - 1)], NullADDR)))
+         /* Only one bond is initiated at a time.                       */
+         if(!Coroutine_Running(&(BondingContext.Coroutine)))
          {
+            BondingContext.BD_ADDR = TempParam->Params[0].BD_ADDR;
+
             /* Check to see if General Bonding was specified.           */
             if(TempParam->NumberofParameters > 1)
-               BondingType = TempParam->Params[1].intParam?btGeneral:btDedicated;
+               BondingContext.BondingType = TempParam->Params[1].intParam?btGeneral:btDedicated;
             else
-               BondingType = btDedicated;
+               BondingContext.BondingType = btDedicated;
 
             /* Before we submit the command to the stack, we need to    */
             /* make sure that we clear out any Link Key we have stored  */
             /* for the specified device.                                */
-            DeleteLinkKey(InquiryResultList[(TempParam->Params[0].intParam - 1)]);
-
-            /* Attempt to submit the command.                           */
-            Result = GAP_Initiate_Bonding(BluetoothStackID, InquiryResultList[(TempParam->Params[0].intParam - 1)], BondingType, GAP_Event_Callback, (unsigned long)0);
+            DeleteLinkKey(TempParam->Params[0].BD_ADDR);
 
-            /* Check the return value of the submitted command for      */
-            /* success.                                                 */
-            if(!Result)
-            {
-               /* Display a messsage indicating that Bonding was        */
-               /* initiated successfully.                               */
-               Display(("GAP_Initiate_Bonding (%s): Function Successful.\r\n", (BondingType == btDedicated)?"Dedicated":"General"));
-
-               /* Flag success to the caller.                           */
+            /* Start the bond, it runs on (interleaved with the other   */
+            /* operations) until the authentication completes.          */
+            ret_val = Coroutine_Start(&(BondingContext.Coroutine), "Bonding", BondingFlow, (unsigned long)&BondingContext);
+            if(ret_val == COROUTINE_WAITING)
                ret_val = 0;
-            }
             else
-            {
-               /* Display a message indicating that an error occured    */
-               /* while initiating bonding.                             */
-               Display(("GAP_Initiate_Bonding() Failure: %d.\r\n", Result));
-
                ret_val = FUNCTION_ERROR;
-            }
          }
          else
          {
-            /* One or more of the necessary parameters is/are invalid.  */
-            Display(("Usage: Pair [Inquiry Index] [Bonding Type (0 = Dedicated, 1 = General) (optional).\r\n"));
+            Display(("Bonding is already in progress.\r\n"));
 
-            ret_val = INVALID_PARAMETERS_ERROR;
+            ret_val = FUNCTION_ERROR;
          }
       }
       else
@@ -1683,51 +2172,36 @@ static int Pair(ParameterList_t *TempParam)
    /* errors.                                                           */
 static int EndPairing(ParameterList_t *TempParam)
 {
-   int       Result;
-   int       ret_val;
-   BD_ADDR_t NullADDR;
-
-   ASSIGN_BD_ADDR(NullADDR, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+   int Result;
+   int ret_val;
 
    /* First, check that valid Bluetooth Stack ID exists.                */
    if(BluetoothStackID)
    {
-      /* Make sure that all of the parameters required for this function*/
-      /* appear to be at least semi-valid.                              */
-      if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam) && (NumberofValidResponses) && (TempParam->Params[0].intParam <= NumberofValidResponses) && (!COMPARE_BD_ADDR(InquiryResultList[(TempParam->Params[0].intParam - 1)], NullADDR)))
+      /* Attempt to submit the command.                                 */
+      Result = GAP_End_Bonding(BluetoothStackID, TempParam->Params[0].BD_ADDR);
+
+      /* Check the return value of the submitted command for success.   */
+      if(!Result)
       {
-         /* Attempt to submit the command.                              */
-         Result = GAP_End_Bonding(BluetoothStackID, InquiryResultList[(TempParam->Params[0].intParam - 1)]);
+         /* Display a messsage indicating that the End bonding was      */
+         /* successfully submitted.                                     */
+         Display(("GAP_End_Bonding: Function Successful.\r\n"));
 
-         /* Check the return value of the submitted command for success.*/
-         if(!Result)
-         {
-            /* Display a messsage indicating that the End bonding was   */
-            /* successfully submitted.                                  */
-            Display(("GAP_End_Bonding: Function Successful.\r\n"));
+         /* Flag success to the caller.                                 */
+         ret_val = 0;
 
-            /* Flag success to the caller.                              */
-            ret_val = 0;
+         /* Flag that there is no longer a current Authentication       */
+         /* procedure in progress.                                      */
+         ASSIGN_BD_ADDR(CurrentRemoteBD_ADDR, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+      }
+      else
+      {
+         /* Display a message indicating that an error occured while    */
+         /* ending bonding.                                             */
+         Display(("GAP_End_Bonding() Failure: %d.\r\n", Result));
 
-            /* Flag that there is no longer a current Authentication    */
-            /* procedure in progress.                                   */
-            ASSIGN_BD_ADDR(CurrentRemoteBD_ADDR, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
-         }
-         else
-         {
-            /* Display a message indicating that an error occured while */
-            /* ending bonding.                                          */
-            Display(("GAP_End_Bonding() Failure: %d.\r\n", Result));
-
-            ret_val = FUNCTION_ERROR;
-         }
-      }
-      else
-      {
-         /* One or more of the necessary parameters is/are invalid.     */
-         Display(("Usage: EndPairing [Inquiry Index].\r\n"));
-
-         ret_val = INVALID_PARAMETERS_ERROR;
+         ret_val = FUNCTION_ERROR;
       }
    }
    else
@@ -1760,56 +2234,44 @@ static int PINCodeResponse(ParameterList_t *TempParam)
       /* active.                                                        */
       if(!COMPARE_BD_ADDR(CurrentRemoteBD_ADDR, NullADDR))
       {
-         /* Make sure that all of the parameters required for this      */
-         /* function appear to be at least semi-valid.                  */
-         if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].strParam) && (BTPS_StringLength(TempParam->Params[0].strParam) > 0) && (BTPS_StringLength(TempParam->Params[0].strParam) <= sizeof(PIN_Code_t)))
-         {
-            /* Parameters appear to be valid, go ahead and convert the  */
-            /* input parameter into a PIN Code.                         */
-
-            /* Initialize the PIN code.                                 */
-            ASSIGN_PIN_CODE(PINCode, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+         /* The parameters were checked by the parser, go ahead and     */
+         /* convert the input parameter into a PIN Code.                */
 
-            BTPS_MemCopy(&PINCode, TempParam->Params[0].strParam, BTPS_StringLength(TempParam->Params[0].strParam));
+         /* Initialize the PIN code.                                    */
+         ASSIGN_PIN_CODE(PINCode, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
 
-            /* Populate the response structure.                         */
-            GAP_Authentication_Information.GAP_Authentication_Type      = atPINCode;
-            GAP_Authentication_Information.Authentication_Data_Length   = (Byte_t)(BTPS_StringLength(TempParam->Params[0].strParam));
-            GAP_Authentication_Information.Authentication_Data.PIN_Code = PINCode;
+         BTPS_MemCopy(&PINCode, TempParam->Params[0].strParam, TempParam->Params[0].Length);
 
-            /* Submit the Authentication Response.                      */
-            Result = GAP_Authentication_Response(BluetoothStackID, CurrentRemoteBD_ADDR, &GAP_Authentication_Information);
-
-            /* Check the return value for the submitted command for     */
-            /* success.                                                 */
-            if(!Result)
-            {
-               /* Operation was successful, inform the user.            */
-               Display(("GAP_Authentication_Response(), Pin Code Response Success.\r\n"));
+         /* Populate the response structure.                            */
+         GAP_Authentication_Information.GAP_Authentication_Type      = atPINCode;
+         GAP_Authentication_Information.Authentication_Data_Length   = (Byte_t)(TempParam->Params[0].Length);
+         GAP_Authentication_Information.Authentication_Data.PIN_Code = PINCode;
 
-               /* Flag success to the caller.                           */
-               ret_val = 0;
-            }
-            else
-            {
-               /* Inform the user that the Authentication Response was  */
-               /* not successful.                                       */
-               Display(("GAP_Authentication_Response() Failure: %d.\r\n", Result));
+         /* Submit the Authentication Response.                         */
+         Result = GAP_Authentication_Response(BluetoothStackID, CurrentRemoteBD_ADDR, &GAP_Authentication_Information);
 
-               ret_val = FUNCTION_ERROR;
-            }
+         /* Check the return value for the submitted command for        */
+         /* success.                                                    */
+         if(!Result)
+         {
+            /* Operation was successful, inform the user.               */
+            Display(("GAP_Authentication_Response(), Pin Code Response Success.\r\n"));
 
-            /* Flag that there is no longer a current Authentication    */
-            /* procedure in progress.                                   */
-            ASSIGN_BD_ADDR(CurrentRemoteBD_ADDR, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+            /* Flag success to the caller.                              */
+            ret_val = 0;
          }
          else
          {
-            /* One or more of the necessary parameters is/are invalid.  */
-            Display(("Usage: PINCodeResponse [PIN Code].\r\n"));
+            /* Inform the user that the Authentication Response was not */
+            /* successful.                                              */
+            Display(("GAP_Authentication_Response() Failure: %d.\r\n", Result));
 
-            ret_val = INVALID_PARAMETERS_ERROR;
+            ret_val = FUNCTION_ERROR;
          }
+
+         /* Flag that there is no longer a current Authentication       */
+         /* procedure in progress.                                      */
+         ASSIGN_BD_ADDR(CurrentRemoteBD_ADDR, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
       }
       else
       {
@@ -1849,49 +2311,37 @@ static int PassKeyResponse(ParameterList_t *TempParam)
       /* active.                                                        */
       if(!COMPARE_BD_ADDR(CurrentRemoteBD_ADDR, NullADDR))
       {
-         /* Make sure that all of the parameters required for this      */
-         /* function appear to be at least semi-valid.                  */
-         if((TempParam) && (TempParam->NumberofParameters > 0) && (BTPS_StringLength(TempParam->Params[0].strParam) <= GAP_PASSKEY_MAXIMUM_NUMBER_OF_DIGITS))
-         {
-            /* Parameters appear to be valid, go ahead and populate the */
-            /* response structure.                                      */
-            GAP_Authentication_Information.GAP_Authentication_Type     = atPassKey;
-            GAP_Authentication_Information.Authentication_Data_Length  = (Byte_t)(sizeof(DWord_t));
-            GAP_Authentication_Information.Authentication_Data.Passkey = (DWord_t)(TempParam->Params[0].intParam);
-
-            /* Submit the Authentication Response.                      */
-            Result = GAP_Authentication_Response(BluetoothStackID, CurrentRemoteBD_ADDR, &GAP_Authentication_Information);
-
-            /* Check the return value for the submitted command for     */
-            /* success.                                                 */
-            if(!Result)
-            {
-               /* Operation was successful, inform the user.            */
-               Display(("GAP_Authentication_Response(), Passkey Response Success.\r\n"));
+         /* The parameters were checked by the parser, go ahead and     */
+         /* populate the response structure.                            */
+         GAP_Authentication_Information.GAP_Authentication_Type     = atPassKey;
+         GAP_Authentication_Information.Authentication_Data_Length  = (Byte_t)(sizeof(DWord_t));
+         GAP_Authentication_Information.Authentication_Data.Passkey = (DWord_t)(TempParam->Params[0].intParam);
 
-               /* Flag success to the caller.                           */
-               ret_val = 0;
-            }
-            else
-            {
-               /* Inform the user that the Authentication Response was  */
-               /* not successful.                                       */
-               Display(("GAP_Authentication_Response() Failure: %d.\r\n", Result));
+         /* Submit the Authentication Response.                         */
+         Result = GAP_Authentication_Response(BluetoothStackID, CurrentRemoteBD_ADDR, &GAP_Authentication_Information);
 
-               ret_val = FUNCTION_ERROR;
-            }
+         /* Check the return value for the submitted command for        */
+         /* success.                                                    */
+         if(!Result)
+         {
+            /* Operation was successful, inform the user.               */
+            Display(("GAP_Authentication_Response(), Passkey Response Success.\r\n"));
 
-            /* Flag that there is no longer a current Authentication    */
-            /* procedure in progress.                                   */
-            ASSIGN_BD_ADDR(CurrentRemoteBD_ADDR, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+            /* Flag success to the caller.                              */
+            ret_val = 0;
          }
          else
          {
-            /* One or more of the necessary parameters is/are invalid.  */
-            Display(("Usage: PassKeyResponse [Numeric Passkey (0 - 999999)].\r\n"));
+            /* Inform the user that the Authentication Response was not */
+            /* successful.                                              */
+            Display(("GAP_Authentication_Response() Failure: %d.\r\n", Result));
 
-            ret_val = INVALID_PARAMETERS_ERROR;
+            ret_val = FUNCTION_ERROR;
          }
+
+         /* Flag that there is no longer a current Authentication       */
+         /* procedure in progress.                                      */
+         ASSIGN_BD_ADDR(CurrentRemoteBD_ADDR, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
       }
       else
       {
@@ -1931,49 +2381,37 @@ static int UserConfirmationResponse(ParameterList_t *TempParam)
       /* active.                                                        */
       if(!COMPARE_BD_ADDR(CurrentRemoteBD_ADDR, NullADDR))
       {
-         /* Make sure that all of the parameters required for this      */
-         /* function appear to be at least semi-valid.                  */
-         if((TempParam) && (TempParam->NumberofParameters > 0))
-         {
-            /* Parameters appear to be valid, go ahead and populate the */
-            /* response structure.                                      */
-            GAP_Authentication_Information.GAP_Authentication_Type          = atUserConfirmation;
-            GAP_Authentication_Information.Authentication_Data_Length       = (Byte_t)(sizeof(Byte_t));
-            GAP_Authentication_Information.Authentication_Data.Confirmation = (Boolean_t)(TempParam->Params[0].intParam?TRUE:FALSE);
-
-            /* Submit the Authentication Response.                      */
-            Result = GAP_Authentication_Response(BluetoothStackID, CurrentRemoteBD_ADDR, &GAP_Authentication_Information);
+         /* The parameters were checked by the parser, go ahead and     */
+         /* populate the response structure.                            */
+         GAP_Authentication_Information.GAP_Authentication_Type          = atUserConfirmation;
+         GAP_Authentication_Information.Authentication_Data_Length       = (Byte_t)(sizeof(Byte_t));
+         GAP_Authentication_Information.Authentication_Data.Confirmation = (Boolean_t)(TempParam->Params[0].intParam?TRUE:FALSE);
 
-            /* Check the return value for the submitted command for     */
-            /* success.                                                 */
-            if(!Result)
-            {
-               /* Operation was successful, inform the user.            */
-               Display(("GAP_Authentication_Response(), User Confirmation Response Success.\r\n"));
-
-               /* Flag success to the caller.                           */
-               ret_val = 0;
-            }
-            else
-            {
-               /* Inform the user that the Authentication Response was  */
-               /* not successful.                                       */
-               Display(("GAP_Authentication_Response() Failure: %d.\r\n", Result));
+         /* Submit the Authentication Response.                         */
+         Result = GAP_Authentication_Response(BluetoothStackID, CurrentRemoteBD_ADDR, &GAP_Authentication_Information);
 
-               ret_val = FUNCTION_ERROR;
-            }
+         /* Check the return value for the submitted command for        */
+         /* success.                                                    */
+         if(!Result)
+         {
+            /* Operation was successful, inform the user.               */
+            Display(("GAP_Authentication_Response(), User Confirmation Response Success.\r\n"));
 
-            /* Flag that there is no longer a current Authentication    */
-            /* procedure in progress.                                   */
-            ASSIGN_BD_ADDR(CurrentRemoteBD_ADDR, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+            /* Flag success to the caller.                              */
+            ret_val = 0;
          }
          else
          {
-            /* One or more of the necessary parameters is/are invalid.  */
-            Display(("Usage: UserConfirmationResponse [Confirmation (0 = No, 1 = Yes)].\r\n"));
+            /* Inform the user that the Authentication Response was not */
+            /* successful.                                              */
+            Display(("GAP_Authentication_Response() Failure: %d.\r\n", Result));
 
-            ret_val = INVALID_PARAMETERS_ERROR;
+            ret_val = FUNCTION_ERROR;
          }
+
+         /* Flag that there is no longer a current Authentication       */
+         /* procedure in progress.                                      */
+         ASSIGN_BD_ADDR(CurrentRemoteBD_ADDR, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
       }
       else
       {
@@ -2049,38 +2487,26 @@ static int SetLocalName(ParameterList_t *TempParam)
    /* First, check that valid Bluetooth Stack ID exists.                */
    if(BluetoothStackID)
    {
-      /* Make sure that all of the parameters required for this function*/
-      /* appear to be at least semi-valid.                              */
-      if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].strParam))
-      {
-         /* Attempt to submit the command.                              */
-         Result = GAP_Set_Local_Device_Name(BluetoothStackID, TempParam->Params[0].strParam);
-
-         /* Check the return value of the submitted command for success.*/
-         if(!Result)
-         {
-            /* Display a messsage indicating that the Device Name was   */
-            /* successfully submitted.                                  */
-            Display(("Local Device Name set to: %s.\r\n", TempParam->Params[0].strParam));
+      /* Attempt to submit the command.                                 */
+      Result = GAP_Set_Local_Device_Name(BluetoothStackID, TempParam->Params[0].strParam);
 
-            /* Flag success to the caller.                              */
-            ret_val = 0;
-         }
-         else
-         {
-            /* Display a message indicating that an error occured while */
-            /* attempting to set the local Device Name.                 */
-            Display(("GAP_Set_Local_Device_Name() Failure: %d.\r\n", Result));
+      /* Check the return value of the submitted command for success.   */
+      if(!Result)
+      {
+         /* Display a messsage indicating that the Device Name was      */
+         /* successfully submitted.                                     */
+         Display(("Local Device Name set to: %s.\r\n", TempParam->Params[0].strParam));
 
-            ret_val = FUNCTION_ERROR;
-         }
+         /* Flag success to the caller.                                 */
+         ret_val = 0;
       }
       else
       {
-         /* One or more of the necessary parameters is/are invalid.     */
-         Display(("Usage: SetLocalName [Local Name (no spaces allowed)].\r\n"));
+         /* Display a message indicating that an error occured while    */
+         /* attempting to set the local Device Name.                    */
+         Display(("GAP_Set_Local_Device_Name() Failure: %d.\r\n", Result));
 
-         ret_val = INVALID_PARAMETERS_ERROR;
+         ret_val = FUNCTION_ERROR;
       }
    }
    else
@@ -2146,40 +2572,28 @@ static int SetClassOfDevice(ParameterList_t *TempParam)
    /* First, check that valid Bluetooth Stack ID exists.                */
    if(BluetoothStackID)
    {
-      /* Make sure that all of the parameters required for this function*/
-      /* appear to be at least semi-valid.                              */
-      if((TempParam) && (TempParam->NumberofParameters > 0))
-      {
-         /* Attempt to submit the command.                              */
-         ASSIGN_CLASS_OF_DEVICE(Class_of_Device, (Byte_t)((TempParam->Params[0].intParam) & 0xFF), (Byte_t)(((TempParam->Params[0].intParam) >> 8) & 0xFF), (Byte_t)(((TempParam->Params[0].intParam) >> 16) & 0xFF));
-
-         Result = GAP_Set_Class_Of_Device(BluetoothStackID, Class_of_Device);
+      /* Attempt to submit the command.                                 */
+      ASSIGN_CLASS_OF_DEVICE(Class_of_Device, (Byte_t)((TempParam->Params[0].intParam) & 0xFF), (Byte_t)(((TempParam->Params[0].intParam) >> 8) & 0xFF), (Byte_t)(((TempParam->Params[0].intParam) >> 16) & 0xFF));
 
-         /* Check the return value of the submitted command for success.*/
-         if(!Result)
-         {
-            /* Display a messsage indicating that the Class of Device   */
-            /* was successfully submitted.                              */
-            Display(("Set Class of Device to 0x%02X%02X%02X.\r\n", Class_of_Device.Class_of_Device0, Class_of_Device.Class_of_Device1, Class_of_Device.Class_of_Device2));
+      Result = GAP_Set_Class_Of_Device(BluetoothStackID, Class_of_Device);
 
-            /* Flag success to the caller.                              */
-            ret_val = 0;
-         }
-         else
-         {
-            /* Display a message indicating that an error occured while */
-            /* attempting to set the local Class of Device.             */
-            Display(("GAP_Set_Class_Of_Device() Failure: %d.\r\n", Result));
+      /* Check the return value of the submitted command for success.   */
+      if(!Result)
+      {
+         /* Display a messsage indicating that the Class of Device was  */
+         /* successfully submitted.                                     */
+         Display(("Set Class of Device to 0x%02X%02X%02X.\r\n", Class_of_Device.Class_of_Device0, Class_of_Device.Class_of_Device1, Class_of_Device.Class_of_Device2));
 
-            ret_val = FUNCTION_ERROR;
-         }
+         /* Flag success to the caller.                                 */
+         ret_val = 0;
       }
       else
       {
-         /* One or more of the necessary parameters is/are invalid.     */
-         Display(("Usage: SetClassOfDevice [Class of Device].\r\n"));
+         /* Display a message indicating that an error occured while    */
+         /* attempting to set the local Class of Device.                */
+         Display(("GAP_Set_Class_Of_Device() Failure: %d.\r\n", Result));
 
-         ret_val = INVALID_PARAMETERS_ERROR;
+         ret_val = FUNCTION_ERROR;
       }
    }
    else
@@ -2239,47 +2653,32 @@ static int GetClassOfDevice(ParameterList_t *TempParam)
    /* on all errors.                                                    */
 static int GetRemoteName(ParameterList_t *TempParam)
 {
-   int       Result;
-   int       ret_val;
-   BD_ADDR_t NullADDR;
-
-   ASSIGN_BD_ADDR(NullADDR, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+   int Result;
+   int ret_val;
 
    /* First, check that valid Bluetooth Stack ID exists.                */
    if(BluetoothStackID)
    {
-      /* Make sure that all of the parameters required for this function*/
-      /* appear to be at least semi-valid.                              */
-      if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam) && (NumberofValidResponses) && (TempParam->Params[0].intParam <= NumberofValidResponses) && (!COMPARE_BD_ADDR(InquiryResultList[(TempParam->Params[0].intParam - 1)], NullADDR)))
-      {
-         /* Attempt to submit the command.                              */
-         Result = GAP_Query_Remote_Device_Name(BluetoothStackID, InquiryResultList[(TempParam->Params[0].intParam - 1)], GAP_Event_Callback, (unsigned long)0);
-
-         /* Check the return value of the submitted command for success.*/
-         if(!Result)
-         {
-            /* Display a messsage indicating that Remote Name request   */
-            /* was initiated successfully.                              */
-            Display(("GAP_Query_Remote_Device_Name: Function Successful.\r\n"));
+      /* Attempt to submit the command.                                 */
+      Result = GAP_Query_Remote_Device_Name(BluetoothStackID, TempParam->Params[0].BD_ADDR, GAP_Event_Callback, (unsigned long)0);
 
-            /* Flag success to the caller.                              */
-            ret_val = 0;
-         }
-         else
-         {
-            /* Display a message indicating that an error occured while */
-            /* initiating the Remote Name request.                      */
-            Display(("GAP_Query_Remote_Device_Name() Failure: %d.\r\n", Result));
+      /* Check the return value of the submitted command for success.   */
+      if(!Result)
+      {
+         /* Display a messsage indicating that Remote Name request was  */
+         /* initiated successfully.                                     */
+         Display(("GAP_Query_Remote_Device_Name: Function Successful.\r\n"));
 
-            ret_val = FUNCTION_ERROR;
-         }
+         /* Flag success to the caller.                                 */
+         ret_val = 0;
       }
       else
       {
-         /* One or more of the necessary parameters is/are invalid.     */
-         Display(("Usage: GetRemoteName [Inquiry Index].\r\n"));
+         /* Display a message indicating that an error occured while    */
+         /* initiating the Remote Name request.                         */
+         Display(("GAP_Query_Remote_Device_Name() Failure: %d.\r\n", Result));
 
-         ret_val = INVALID_PARAMETERS_ERROR;
+         ret_val = FUNCTION_ERROR;
       }
    }
    else
@@ -2309,97 +2708,85 @@ static int OpenHFServer(ParameterList_t *TempParam)
       /* Verify that the Server is not already open.                    */
       if(!HFServerPortID)
       {
-         /* Next, check to see if the parameters specified are valid.   */
-         if((TempParam) && (TempParam->NumberofParameters >= 1) && (TempParam->Params[0].intParam))
+         /* Now try and open an Audio Gateway Server Port.              */
+         ret_val = HFRE_Open_HandsFree_Server_Port(BluetoothStackID, TempParam->Params[0].intParam, HFRE_SUPPORTED_FEATURES, 0, NULL, HFRE_Event_Callback, (unsigned long)0);
+
+         /* Check to see if the call was executed successfully.         */
+         if(ret_val > 0)
          {
-            /* Now try and open an Audio Gateway Server Port.           */
-            ret_val = HFRE_Open_HandsFree_Server_Port(BluetoothStackID, TempParam->Params[0].intParam, HFRE_SUPPORTED_FEATURES, 0, NULL, HFRE_Event_Callback, (unsigned long)0);
+            /* The Server was successfully opened.  Save the returned   */
+            /* result as the Current Server Port ID because it will be  */
+            /* used by later function calls.                            */
+            HFServerPortID = ret_val;
 
-            /* Check to see if the call was executed successfully.      */
-            if(ret_val > 0)
+            Display(("HFRE_Open_HandsFree_Server_Port: Function Successful.\r\n"));
+
+            /* Let's make sure the Class of Device is set correctly.    */
+            if(!GAP_Query_Class_Of_Device(BluetoothStackID, &ClassOfDevice))
             {
-               /* The Server was successfully opened.  Save the returned*/
-               /* result as the Current Server Port ID because it will  */
-               /* be used by later function calls.                      */
-               HFServerPortID = ret_val;
+               SET_MAJOR_DEVICE_CLASS(ClassOfDevice, HCI_LMP_CLASS_OF_DEVICE_MAJOR_DEVICE_CLASS_AUDIO_VIDEO);
+               SET_MINOR_DEVICE_CLASS(ClassOfDevice, HCI_LMP_CLASS_OF_DEVICE_MINOR_DEVICE_CLASS_AUDIO_VIDEO_HANDS_FREE);
+
+               /* Write out the Class of Device.                        */
+               GAP_Set_Class_Of_Device(BluetoothStackID, ClassOfDevice);
+            }
 
-               Display(("HFRE_Open_HandsFree_Server_Port: Function Successful.\r\n"));
+            /* The Server was opened successfully, now register a SDP   */
+            /* Record indicating that an Audio Gateway Server exists.   */
+            /* Do this by first creating a Service Name.                */
+            BTPS_SprintF(ServiceName, "HandsFree Port %u", TempParam->Params[0].intParam);
 
-               /* Let's make sure the Class of Device is set correctly. */
-               if(!GAP_Query_Class_Of_Device(BluetoothStackID, &ClassOfDevice))
-               {
-                  SET_MAJOR_DEVICE_CLASS(ClassOfDevice, HCI_LMP_CLASS_OF_DEVICE_MAJOR_DEVICE_CLASS_AUDIO_VIDEO);
-                  SET_MINOR_DEVICE_CLASS(ClassOfDevice, HCI_LMP_CLASS_OF_DEVICE_MINOR_DEVICE_CLASS_AUDIO_VIDEO_HANDS_FREE);
+            /* Now that a Service Name has been created try and Register*/
+            /* the SDP Record.                                          */
+            Result = HFRE_Register_HandsFree_SDP_Record(BluetoothStackID, HFServerPortID, ServiceName, &HFServerSDPHandle);
 
-                  /* Write out the Class of Device.                     */
-                  GAP_Set_Class_Of_Device(BluetoothStackID, ClassOfDevice);
-               }
+            /* Check the result of the above function call for success. */
+            if(!Result)
+            {
+               /* Display a message indicating that the SDP Record for  */
+               /* the Audio Gateway Server was registered successfully. */
+               Display(("HFRE_Register_HandsFree_SDP_Record: Function Successful.\r\n"));
+
+               ret_val = Result;
+            }
+            else
+            {
+               /* Display an Error Message and make sure the Audio      */
+               /* Gateway Server SDP Handle is invalid, and close the   */
+               /* Audio Gateway Server Port we just opened because we   */
+               /* weren't able to register a SDP Record.                */
+               Display(("HFRE_Register_HandsFree_SDP_Record: Function Failure. %d\r\n", Result));
+
+               HFServerSDPHandle = 0;
 
-               /* The Server was opened successfully, now register a SDP*/
-               /* Record indicating that an Audio Gateway Server exists.*/
-               /* Do this by first creating a Service Name.             */
-               BTPS_SprintF(ServiceName, "HandsFree Port %u", TempParam->Params[0].intParam);
+               ret_val         = Result;
 
-               /* Now that a Service Name has been created try and      */
-               /* Register the SDP Record.                              */
-               Result = HFRE_Register_HandsFree_SDP_Record(BluetoothStackID, HFServerPortID, ServiceName, &HFServerSDPHandle);
+               /* Now try and close the opened Port.                    */
+               Result = HFRE_Close_Server_Port(BluetoothStackID, HFServerPortID);
 
-               /* Check the result of the above function call for       */
-               /* success.                                              */
+               HFServerPortID = 0;
+
+               /* Next check the return value of the issued command see */
+               /* if it was successful.                                 */
                if(!Result)
                {
-                  /* Display a message indicating that the SDP Record   */
-                  /* for the Audio Gateway Server was registered        */
-                  /* successfully.                                      */
-                  Display(("HFRE_Register_HandsFree_SDP_Record: Function Successful.\r\n"));
-
-                  ret_val = Result;
+                  /* Display a message indicating that the Port was     */
+                  /* successfully closed.                               */
+                  Display(("HFRE_Close_Server_Port: Function Successful.\r\n"));
                }
                else
                {
-                  /* Display an Error Message and make sure the Audio   */
-                  /* Gateway Server SDP Handle is invalid, and close the*/
-                  /* Audio Gateway Server Port we just opened because we*/
-                  /* weren't able to register a SDP Record.             */
-                  Display(("HFRE_Register_HandsFree_SDP_Record: Function Failure. %d\r\n", Result));
-
-                  HFServerSDPHandle = 0;
-
-                  ret_val         = Result;
-
-                  /* Now try and close the opened Port.                 */
-                  Result = HFRE_Close_Server_Port(BluetoothStackID, HFServerPortID);
-
-                  HFServerPortID = 0;
-
-                  /* Next check the return value of the issued command  */
-                  /* see if it was successful.                          */
-                  if(!Result)
-                  {
-                     /* Display a message indicating that the Port was  */
-                     /* successfully closed.                            */
-                     Display(("HFRE_Close_Server_Port: Function Successful.\r\n"));
-                  }
-                  else
-                  {
-                     /* An error occurred while attempting to close the */
-                     /* Port.                                           */
-                     Display(("HFRE_Close_Server_Port() Failure: %d.\r\n", Result));
-                  }
+                  /* An error occurred while attempting to close the    */
+                  /* Port.                                              */
+                  Display(("HFRE_Close_Server_Port() Failure: %d.\r\n", Result));
                }
             }
-            else
-            {
-               Display(("Unable to Open Server on: %d, Error = %d.\r\n", TempParam->Params[0].intParam, ret_val));
-
-               ret_val = UNABLE_TO_REGISTER_SERVER;
-            }
          }
          else
          {
-            Display(("Usage: OpenHFServer [Port Number]\r\n"));
+            Display(("Unable to Open Server on: %d, Error = %d.\r\n", TempParam->Params[0].intParam, ret_val));
 
-            ret_val = INVALID_PARAMETERS_ERROR;
+            ret_val = UNABLE_TO_REGISTER_SERVER;
          }
       }
       else
@@ -2493,11 +2880,11 @@ static int ClosePort(ParameterList_t *TempParam)
    {
       /* Check to see if the Current Port ID appears to be semi-valid.  */
       /* This parameter will only be valid if a Client Port is open.    */
-      if(HFServerPortID)
+      if(CURRENT_PORT_ID())
       {
          /* The Port ID appears to be semi-valid.  Now try to close the */
          /* Port.                                                       */
-         Result  = HFRE_Close_Port(BluetoothStackID, HFServerPortID);
+         Result  = HFRE_Close_Port(BluetoothStackID, CURRENT_PORT_ID());
 
          /* Set the return value of this function equal to the Result of*/
          /* the function call.                                          */
@@ -2529,170 +2916,855 @@ static int ClosePort(ParameterList_t *TempParam)
       /* No valid Bluetooth Stack ID exists.                            */
       Display(("Stack ID Invalid.\r\n"));
 
-      ret_val = INVALID_STACK_ID_ERROR;
+      ret_val = INVALID_STACK_ID_ERROR;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for setting up or releasing */
+   /* an audio connection.  This function returns zero on successful    */
+   /* execution and a negative value on all errors.                     */
+static int ManageAudioConnection(ParameterList_t *TempParam)
+{
+   int ret_val;
+
+   /* First check to see if a valid Bluetooth Stack ID exists.          */
+   if(BluetoothStackID)
+   {
+      /* Check to see if this is a request to setup an audio connection */
+      /* or disconnect an audio connection.                             */
+      if(TempParam->Params[0].intParam)
+      {
+         /* This is a request to setup an audio connection, call the    */
+         /* Setup Audio Connection function.                            */
+         ret_val = HFRESetupAudioConnection();
+      }
+      else
+      {
+         /* This is a request to disconnect an audio connection, call   */
+         /* the Release Audio Connection function.                      */
+         ret_val = HFREReleaseAudioConnection();
+      }
+   }
+   else
+   {
+      /* No valid Bluetooth Stack ID exists.                            */
+      Display(("Stack ID Invalid.\r\n"));
+
+      ret_val = INVALID_STACK_ID_ERROR;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for sending the command to  */
+   /* Anwser an Incoming Call on the Remote Audio Gateway.  This        */
+   /* function returns zero on successful execution and a negative value*/
+   /* on all errors.                                                    */
+static int AnswerIncomingCall(ParameterList_t *TempParam)
+{
+   int Result;
+   int ret_val;
+
+   /* First, check that valid Bluetooth Stack ID exists.                */
+   if(BluetoothStackID)
+   {
+      /* Now check to make sure that the Port ID appears to be          */
+      /* semi-valid.                                                    */
+      if(CURRENT_PORT_ID())
+      {
+         /* The AG sets up the audio of the call right after it is      */
+         /* answered.                                                   */
+         Sniff_Wake(ConnectedBD_ADDR);
+
+         /* The Port ID appears to be a semi-valid value.  Now submit   */
+         /* the command.                                                */
+         Result  = HFRE_Answer_Incoming_Call(BluetoothStackID, CURRENT_PORT_ID());
+
+         /* Set the return value of this function equal to the Result of*/
+         /* the function call.                                          */
+         ret_val = Result;
+
+         /* Now check to see if the command was submitted successfully. */
+         if(!Result)
+         {
+            /* The function was submitted successfully.                 */
+            Display(("HFRE_Answer_Incoming_Call: Function Successful.\r\n"));
+         }
+         else
+         {
+            /* There was an error submitting the function.              */
+            Display(("HFRE_Answer_Incoming_Call() Failure: %d.\r\n", Result));
+         }
+      }
+      else
+      {
+         /* One or more of the parameters are invalid.                  */
+         Display(("Answer Incoming Call: Invalid Port ID.\r\n"));
+
+         ret_val = FUNCTION_ERROR;
+      }
+   }
+   else
+   {
+      /* No valid Bluetooth Stack ID exists.                            */
+      ret_val = INVALID_STACK_ID_ERROR;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for sending the command to  */
+   /* HangUp ongoing calls or reject incoming calls on the Remote Audio */
+   /* Gateway.  This function returns zero on successful execution and a*/
+   /* negative value on all errors.                                     */
+static int HangUpCall(ParameterList_t *TempParam)
+{
+   int Result;
+   int ret_val;
+
+   /* First, check that valid Bluetooth Stack ID exists.                */
+   if(BluetoothStackID)
+   {
+      /* Now check to make sure that the Port ID appears to be          */
+      /* semi-valid.                                                    */
+      if(CURRENT_PORT_ID())
+      {
+         /* The Port ID appears to be a semi-valid value.  Now submit   */
+         /* the command.                                                */
+         Result  = HFRE_Hang_Up_Call(BluetoothStackID, CURRENT_PORT_ID());
+
+         /* Set the return value of this function equal to the Result of*/
+         /* the function call.                                          */
+         ret_val = Result;
+
+         /* Now check to see if the command was submitted successfully. */
+         if(!Result)
+         {
+            /* The function was submitted successfully.                 */
+            Display(("HFRE_Hang_Up_Call: Function Successful.\r\n"));
+         }
+         else
+         {
+            /* There was an error submitting the function.              */
+            Display(("HFRE_Hang_Up_Call() Failure: %d.\r\n", Result));
+         }
+      }
+      else
+      {
+         /* One or more of the parameters are invalid.                  */
+         Display(("Hang Up Call: Invalid Port ID.\r\n"));
+
+         ret_val = FUNCTION_ERROR;
+      }
+   }
+   else
+   {
+      /* No valid Bluetooth Stack ID exists.                            */
+      ret_val = INVALID_STACK_ID_ERROR;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for displaying the contents */
+   /* of the Peer Cache together with the page latency that was measured*/
+   /* for cached and blind pages.  The cache can be cleared by          */
+   /* specifying a non-zero parameter.  This function returns zero on   */
+   /* successful execution and a negative value on all errors.          */
+static int DisplayPeerCache(ParameterList_t *TempParam)
+{
+   int                   Index;
+   int                   NumberEntries;
+   BoardStr_t            BoardStr;
+   PeerCacheEntry_t      EntryList[PEER_CACHE_MAX_ENTRIES];
+   PeerCacheStatistics_t Statistics;
+
+   /* Check to see if this is a request to clear the cache.             */
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
+   {
+      PeerCache_Clear();
+
+      Display(("Peer Cache Cleared.\r\n"));
+   }
+
+   NumberEntries = PeerCache_QueryStatistics(&Statistics, PEER_CACHE_MAX_ENTRIES, EntryList);
+
+   Display(("Peer Cache: %d device(s).\r\n", NumberEntries));
+
+   for(Index=0;Index<NumberEntries;Index++)
+   {
+      BD_ADDRToStr(EntryList[Index].BD_ADDR, BoardStr);
+
+      Display(("%2d: %s PSRM: %u Clock Offset: 0x%04X Last Page: %u ms%s\r\n", (Index + 1), BoardStr, EntryList[Index].Page_Scan_Repetition_Mode, EntryList[Index].Clock_Offset, EntryList[Index].PageTime, (EntryList[Index].Flags & PEER_CACHE_FLAGS_FEATURES_VALID)?" (Features)":""));
+   }
+
+   /* Display the page latency statistics, including the average latency*/
+   /* saved by cached pages when both kinds of pages have been measured.*/
+   Display(("Cached Pages: %u, Average: %lu ms.\r\n", Statistics.CachedPages, (Statistics.CachedPages)?(Statistics.CachedPageTime/Statistics.CachedPages):0));
+   Display(("Blind Pages:  %u, Average: %lu ms.\r\n", Statistics.BlindPages, (Statistics.BlindPages)?(Statistics.BlindPageTime/Statistics.BlindPages):0));
+   Display(("Failed Pages: %u, Flash Writes: %u.\r\n", Statistics.FailedPages, Statistics.FlashWrites));
+
+   if((Statistics.CachedPages) && (Statistics.BlindPages))
+      Display(("Page Latency Saved: %ld ms per connection.\r\n", (long)(Statistics.BlindPageTime/Statistics.BlindPages) - (long)(Statistics.CachedPageTime/Statistics.CachedPages)));
+
+   return(0);
+}
+
+   /* The following function is responsible for displaying the          */
+   /* statistics of the Recovery logic (stack bring-up and AG           */
+   /* reconnection), including the time that was needed to recover.    */
+   /* This function returns zero on successful execution and a negative */
+   /* value on all errors.                                              */
+static int DisplayRecovery(ParameterList_t *TempParam)
+{
+   unsigned int          Index;
+   Recovery_Statistics_t Statistics;
+
+   for(Index=0;Index<RECOVERY_MAX_OPERATIONS;Index++)
+   {
+      if(!Recovery_QueryStatistics(Index, &Statistics))
+      {
+         Display(("%s: %s, Faults: %u, Attempts: %u, Recovered: %u, Abandoned: %u.\r\n", (Index == RECOVERY_ID_STACK)?"Stack":"AG Link", (Recovery_InProgress(Index))?"Recovering":"Idle", Statistics.Faults, Statistics.Attempts, Statistics.Recoveries, Statistics.Abandoned));
+         Display(("   Time To Recover Last: %lu ms, Max: %lu ms, Average: %lu ms.\r\n", Statistics.LastTimeToRecover, Statistics.MaximumTimeToRecover, (Statistics.Recoveries)?(Statistics.TotalTimeToRecover/Statistics.Recoveries):0));
+      }
+   }
+
+   return(0);
+}
+
+   /* The following function is a utility function that is used to     */
+   /* determine if a Link Key is held for the specified device.  This   */
+   /* function returns TRUE if the device is bonded or FALSE otherwise. */
+static Boolean_t IsBonded(BD_ADDR_t BD_ADDR)
+{
+   unsigned int Index;
+   Boolean_t    ret_val = FALSE;
+
+   for(Index=0;(Index<(sizeof(LinkKeyInfo)/sizeof(LinkKeyInfo_t))) && (!ret_val);Index++)
+   {
+      if(COMPARE_BD_ADDR(LinkKeyInfo[Index].BD_ADDR, BD_ADDR))
+         ret_val = TRUE;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for starting the           */
+   /* reconnection of the specified AG after its link was lost.  Only   */
+   /* bonded AGs are reconnected (anything else would require the user  */
+   /* to pair again).                                                   */
+static void ScheduleReconnect(BD_ADDR_t BD_ADDR)
+{
+   BoardStr_t BoardStr;
+
+   LinkLossDetected = FALSE;
+   ASSIGN_BD_ADDR(LostBD_ADDR, 0, 0, 0, 0, 0, 0);
+
+   if((BluetoothStackID) && (!COMPARE_NULL_BD_ADDR(BD_ADDR)) && (IsBonded(BD_ADDR)) && (!Recovery_InProgress(RECOVERY_ID_HFP_PEER)))
+   {
+      ReconnectBD_ADDR = BD_ADDR;
+
+      BD_ADDRToStr(BD_ADDR, BoardStr);
+      Display(("\r\nLink to %s lost, reconnecting.\r\n", BoardStr));
+
+      Recovery_Start(RECOVERY_ID_HFP_PEER, ReconnectAudioGateway, 0, HFRE_RECONNECT_MAXIMUM_ATTEMPTS);
+   }
+}
+
+   /* The following function is the Recovery Action that performs a     */
+   /* single reconnection attempt to the AG that was lost.  The RFCOMM  */
+   /* Server Channel of the AG is not known (it may change between      */
+   /* connections) so it is queried via SDP first (see ReconnectFlow()) */
+   /* and the port is opened when the SDP response arrives.  This       */
+   /* function returns a positive value if the AG is already connected, */
+   /* zero if the attempt was started, or a negative value if the       */
+   /* attempt failed.                                                   */
+static int ReconnectAudioGateway(unsigned long CallbackParameter)
+{
+   int ret_val;
+
+   if(BluetoothStackID)
+   {
+      /* The AG may have reconnected on its own.                        */
+      if(!COMPARE_NULL_BD_ADDR(ConnectedBD_ADDR))
+         ret_val = 1;
+      else
+      {
+         /* An attempt that is still paging reports its own result.     */
+         ret_val = Coroutine_Start(&ReconnectCoroutine, "Reconnect", ReconnectFlow, 0);
+         if((!ret_val) || (ret_val == COROUTINE_WAITING) || (ret_val == COROUTINE_ERROR_BUSY))
+            ret_val = 0;
+         else
+            ret_val = FUNCTION_ERROR;
+      }
+   }
+   else
+      ret_val = INVALID_STACK_ID_ERROR;
+
+   return(ret_val);
+}
+
+   /* The following function is the coroutine of a reconnection attempt.*/
+   /* If the paging parameters of the AG are cached the AG is paged with*/
+   /* them first, the SDP query then runs on the connection that is     */
+   /* already up (otherwise SDP pages the AG blind).  A failure before  */
+   /* the first await is returned to the Recovery Action, a later one is*/
+   /* reported with Recovery_Complete().                                */
+static int ReconnectFlow(Coroutine_t *Coroutine, unsigned long CallbackParameter)
+{
+   int Result;
+
+   COROUTINE_BEGIN(Coroutine);
+
+   if(PageCachedDevice(ReconnectBD_ADDR))
+   {
+      COROUTINE_AWAIT(Coroutine, FLOW_EVENT_CONNECTION, &ReconnectBD_ADDR, BONDING_FLOW_PAGE_TIMEOUT_MS);
+
+      if(COROUTINE_AWAIT_RESULT(Coroutine) != HCI_ERROR_CODE_NO_ERROR)
+         PeerCache_PageStarted(ReconnectBD_ADDR, FALSE);
+
+      if((Result = QueryAudioGatewayChannel()) < 0)
+         Recovery_Complete(RECOVERY_ID_HFP_PEER, FALSE);
+   }
+   else
+   {
+      PeerCache_PageStarted(ReconnectBD_ADDR, FALSE);
+
+      Result = QueryAudioGatewayChannel();
+   }
+
+   if(Result < 0)
+      COROUTINE_EXIT(Coroutine, Result);
+
+   COROUTINE_END(Coroutine);
+}
+
+   /* The following function is a utility function that queries the     */
+   /* RFCOMM Server Channel of the AG that is being reconnected, the    */
+   /* port is opened when the SDP response arrives.  This function      */
+   /* returns zero if the query was started or a negative value if it   */
+   /* failed.                                                           */
+static int QueryAudioGatewayChannel(void)
+{
+   int                           ret_val;
+   SDP_UUID_Entry_t              SDPUUIDEntry;
+   SDP_Attribute_ID_List_Entry_t AttributeID;
+
+   /* Search for the Handsfree Audio Gateway service (0x111F) and       */
+   /* request only its Protocol Descriptor List.                        */
+   SDPUUIDEntry.SDP_Data_Element_Type = deUUID_16;
+   ASSIGN_SDP_UUID_16(SDPUUIDEntry.UUID_Value.UUID_16, 0x11, 0x1F);
+
+   AttributeID.Attribute_Range        = FALSE;
+   AttributeID.Start_Attribute_ID     = HFRE_AG_PROTOCOL_DESCRIPTOR_LIST_ID;
+   AttributeID.End_Attribute_ID       = 0;
+
+   ret_val = SDP_Service_Search_Attribute_Request(BluetoothStackID, ReconnectBD_ADDR, 1, &SDPUUIDEntry, 1, &AttributeID, SDP_Event_Callback, (unsigned long)0);
+   if(ret_val > 0)
+      ret_val = 0;
+   else
+   {
+      Display(("SDP_Service_Search_Attribute_Request() Failure: %d.\r\n", ret_val));
+
+      ret_val = FUNCTION_ERROR;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is a utility function that searches a     */
+   /* Protocol Descriptor List for the RFCOMM Server Channel.  A        */
+   /* protocol descriptor is a sequence that starts with the protocol   */
+   /* UUID followed by the protocol parameters, the only RFCOMM (0x0003)*/
+   /* parameter is the Server Channel.  This function returns the Server*/
+   /* Channel or a negative value if it was not found.                  */
+static int FindRFCOMMServerChannel(SDP_Data_Element_t *SDP_Data_Element)
+{
+   int                 ret_val = -1;
+   unsigned int        Index;
+   SDP_Data_Element_t *Sequence;
+
+   if((SDP_Data_Element) && (SDP_Data_Element->SDP_Data_Element_Type == deSequence))
+   {
+      Sequence = SDP_Data_Element->SDP_Data_Element.SDP_Data_Element_Sequence;
+
+      if((SDP_Data_Element->SDP_Data_Element_Length >= 2) && (Sequence[0].SDP_Data_Element_Type == deUUID_16) && (Sequence[0].SDP_Data_Element.UUID_16.UUID_Byte0 == 0x00) && (Sequence[0].SDP_Data_Element.UUID_16.UUID_Byte1 == 0x03) && (Sequence[1].SDP_Data_Element_Type == deUnsignedInteger1Byte))
+         ret_val = Sequence[1].SDP_Data_Element.UnsignedInteger1Byte;
+      else
+      {
+         /* Not an RFCOMM descriptor, search any nested sequences.      */
+         for(Index=0;(Index<SDP_Data_Element->SDP_Data_Element_Length) && (ret_val < 0);Index++)
+            ret_val = FindRFCOMMServerChannel(&(Sequence[Index]));
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for displaying the timing  */
+   /* of each phase of the last stack bring-up together with the time   */
+   /* it took until the device was connectable.  This function returns  */
+   /* zero on successful execution and a negative value on all errors.  */
+static int DisplayBootTimes(ParameterList_t *TempParam)
+{
+   BootSeq_Display();
+
+   return(0);
+}
+
+   /* The following function is responsible for draining the HCI        */
+   /* traffic capture to the console as hex (a BTSnoop file header      */
+   /* followed by the captured records, so every dump can be converted  */
+   /* into a BTSnoop file on its own, e.g. with xxd -r -p).  If a       */
+   /* parameter is specified it sets the number of ACL/SCO payload bytes*/
+   /* that are captured instead.  This function returns zero on         */
+   /* successful execution and a negative value on all errors.          */
+static int DumpSnoop(ParameterList_t *TempParam)
+{
+   unsigned int         Index;
+   unsigned int         Length;
+   unsigned char        Buffer[BTSNOOP_FILE_HEADER_SIZE * 2];
+   BTSnoop_Statistics_t Statistics;
+
+   if((TempParam) && (TempParam->NumberofParameters > 0))
+   {
+      BTSnoop_SetTruncation((unsigned int)TempParam->Params[0].intParam);
+      BTSnoop_QueryStatistics(&Statistics);
+
+      Display(("ACL/SCO payload truncated to %u bytes.\r\n", Statistics.Truncation));
+   }
+   else
+   {
+      BTSnoop_QueryStatistics(&Statistics);
+
+      Display(("Captured: %lu, Dropped: %lu, Overwritten: %lu, Queued: %u bytes.\r\n", Statistics.Packets, Statistics.DroppedPackets, Statistics.OverwrittenPackets, Statistics.BytesQueued));
+      Display(("--- BTSnoop Start ---\r\n"));
+
+      BTSnoop_ReadFileHeader(Buffer);
+      Length = BTSNOOP_FILE_HEADER_SIZE;
+
+      do
+      {
+         for(Index=0;Index<Length;Index++)
+            Display(("%02X", Buffer[Index]));
+
+         Display(("\r\n"));
+      } while((Length = BTSnoop_Read(sizeof(Buffer), Buffer)) != 0);
+
+      Display(("--- BTSnoop End ---\r\n"));
+   }
+
+   return(0);
+}
+
+   /* The following function is responsible for displaying the stack    */
+   /* high watermark and the peak stack usage of every callback and     */
+   /* command.  If a non-zero parameter is specified the peaks are      */
+   /* cleared afterwards.  This function returns zero on successful     */
+   /* execution and a negative value on all errors.                     */
+static int DisplayStackUsage(ParameterList_t *TempParam)
+{
+   StackMark_Display();
+
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
+   {
+      StackMark_Reset();
+
+      Display(("Peaks cleared.\r\n"));
+   }
+
+   return(0);
+}
+
+   /* The following function is responsible for displaying the LE      */
+   /* advertising payloads, the advertising profile in use and the time */
+   /* it took centrals to connect.  This function returns zero on       */
+   /* successful execution and a negative value on all errors.          */
+static int DisplayAdvertising(ParameterList_t *TempParam)
+{
+   Advertise_Display();
+
+   return(0);
+}
+
+#ifdef SCAN_ENABLE
+
+   /* The following function is responsible for starting and stopping  */
+   /* the LE scanning (0 = Stop, 1 = Passive, 2 = Active).  Without a   */
+   /* parameter the scanner statistics and the tracked devices are      */
+   /* displayed.  This function returns zero on successful execution and*/
+   /* a negative value on all errors.                                   */
+static int ScanLE(ParameterList_t *TempParam)
+{
+   int ret_val;
+   int Result;
+
+   /* First, check that valid Bluetooth Stack ID exists.                */
+   if(BluetoothStackID)
+   {
+      if((!TempParam) || (TempParam->NumberofParameters == 0))
+      {
+         Scan_Display();
+
+         ret_val = 0;
+      }
+      else
+      {
+         if(TempParam->Params[0].intParam)
+         {
+            Result = Scan_Start(BluetoothStackID, (Boolean_t)(TempParam->Params[0].intParam == 2), SCAN_DEFAULT_INTERVAL, SCAN_DEFAULT_WINDOW, Scan_Report_Callback, 0);
+            if(!Result)
+            {
+               Display(("%s scanning started.\r\n", (TempParam->Params[0].intParam == 2)?"Active":"Passive"));
+
+               ret_val = 0;
+            }
+            else
+            {
+               Display(("Scan_Start() Failure: %d.\r\n", Result));
+
+               ret_val = FUNCTION_ERROR;
+            }
+         }
+         else
+         {
+            Scan_Stop();
+
+            Display(("Scanning stopped.\r\n"));
+
+            ret_val = 0;
+         }
+      }
+   }
+   else
+   {
+      /* No valid Bluetooth Stack ID exists.                            */
+      ret_val = INVALID_STACK_ID_ERROR;
+   }
+
+   return(ret_val);
+}
+
+#endif
+
+   /* The following function is responsible for displaying the LE links */
+   /* with the connection parameters the centrals applied and the       */
+   /* update requests of the connection parameter policy.  This function*/
+   /* returns zero on successful execution and a negative value on all  */
+   /* errors.                                                           */
+static int DisplayConnParam(ParameterList_t *TempParam)
+{
+   ConnParam_Display();
+
+   return(0);
+}
+
+#ifdef GATT_CLIENT_ENABLE
+
+   /* The following function is responsible for displaying the peers    */
+   /* whose GATT database is cached, the links of the GATT client and   */
+   /* how many discoveries the cache saved.  The cache can be cleared by*/
+   /* specifying a non-zero parameter.  This function returns zero on   */
+   /* successful execution and a negative value on all errors.          */
+static int DisplayGATTClient(ParameterList_t *TempParam)
+{
+   GATTClient_Display();
+
+   /* Check to see if this is a request to clear the cache.             */
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
+   {
+      GATTClient_Clear();
+
+      Display(("GATT client cache cleared.\r\n"));
+   }
+
+   return(0);
+}
+
+#endif
+
+   /* The following function is responsible for displaying the state of */
+   /* the GATT database (whether the Database Hash is readable and      */
+   /* whether the database changed at this boot) and the clients        */
+   /* subscribed to Service Changed.  This function returns zero on     */
+   /* successful execution and a negative value on all errors.          */
+static int DisplayGATTDatabase(ParameterList_t *TempParam)
+{
+   GATTDatabase_Display();
+
+   return(0);
+}
+
+   /* The following function is responsible for displaying the long     */
+   /* attributes of the GATT server, the queues of prepared writes and  */
+   /* how many were executed, rejected or discarded.  This function     */
+   /* returns zero on successful execution and a negative value on all  */
+   /* errors.                                                           */
+static int DisplayGATTLong(ParameterList_t *TempParam)
+{
+   GATTLong_Display();
+
+   return(0);
+}
+
+   /* The following function is responsible for displaying the mode of  */
+   /* the ACL links (active or sniff), the time spent in each mode and  */
+   /* the wake-up latencies.  This function returns zero on successful  */
+   /* execution and a negative value on all errors.                     */
+static int DisplaySniff(ParameterList_t *TempParam)
+{
+   Sniff_Display();
+
+   return(0);
+}
+
+   /* The following function is responsible for displaying the parameter*/
+   /* sets of the audio connections, the packet type and latency of the */
+   /* last one and how often a set had to be fallen back from.  This    */
+   /* function returns zero on successful execution and a negative value*/
+   /* on all errors.                                                    */
+static int DisplayAudioLink(ParameterList_t *TempParam)
+{
+   AudioLink_Display();
+
+   return(0);
+}
+
+   /* The following function is responsible for displaying the stack    */
+   /* operations that are in progress and the event each one awaits.    */
+   /* This function returns zero on successful execution and a negative */
+   /* value on all errors.                                              */
+static int DisplayFlows(ParameterList_t *TempParam)
+{
+   char         BoardStr[16];
+   unsigned int Count;
+   Coroutine_t *Coroutine;
+
+   Count     = 0;
+   Coroutine = Coroutine_QueryNext(NULL);
+
+   while(Coroutine)
+   {
+      BD_ADDRToStr(Coroutine->BD_ADDR, BoardStr);
+
+      Display(("   %-12s event %u, %s, %lu ms.\r\n", Coroutine->Name, Coroutine->Event, (COMPARE_NULL_BD_ADDR(Coroutine->BD_ADDR))?"any device":BoardStr, BTPS_GetTickCount() - Coroutine->StartTime));
+
+      Count++;
+
+      Coroutine = Coroutine_QueryNext(Coroutine);
    }
 
-   return(ret_val);
+   Display(("%u Operations in Progress.\r\n", Count));
+
+   return(0);
 }
 
-   /* The following function is responsible for setting up or releasing */
-   /* an audio connection.  This function returns zero on successful    */
-   /* execution and a negative value on all errors.                     */
-static int ManageAudioConnection(ParameterList_t *TempParam)
+   /* The following function is a utility function that displays the   */
+   /* event types of the specified table of the metrics that were       */
+   /* counted at least once (nothing if none was).  The table holds     */
+   /* NumberTypes entries followed by the one of the other types.       */
+static void DisplayEventCounts(char *Name, unsigned int NumberTypes, unsigned long *Counts)
 {
-   int ret_val;
+   unsigned int Index;
+   Boolean_t    Header;
 
-   /* First check to see if a valid Bluetooth Stack ID exists.          */
-   if(BluetoothStackID)
+   Header = FALSE;
+
+   for(Index=0;Index<=NumberTypes;Index++)
    {
-      /* The Port ID appears to be at least semi-valid, now check the   */
-      /* required parameters for this command.                          */
-      if((TempParam) && (TempParam->NumberofParameters > 0))
+      if(Counts[Index])
       {
-         /* Check to see if this is a request to setup an audio         */
-         /* connection or disconnect an audio connection.               */
-         if(TempParam->Params[0].intParam)
-         {
-            /* This is a request to setup an audio connection, call the */
-            /* Setup Audio Connection function.                         */
-            ret_val = HFRESetupAudioConnection();
-         }
-         else
+         if(!Header)
          {
-            /* This is a request to disconnect an audio connection, call*/
-            /* the Release Audio Connection function.                   */
-            ret_val = HFREReleaseAudioConnection();
+            Display(("   %s Events:\r\n", Name));
+
+            Header = TRUE;
          }
-      }
-      else
-      {
-         /* The required parameter is invalid.                          */
-         Display(("Usage: Audio [Release = 0, Setup = 1].\r\n"));
 
-         ret_val = INVALID_PARAMETERS_ERROR;
+         if(Index < NumberTypes)
+            Display(("      Type %-3u %10lu\r\n", Index, Counts[Index]));
+         else
+            Display(("      Other    %10lu\r\n", Counts[Index]));
       }
    }
-   else
+}
+
+   /* The following function is responsible for displaying the runtime  */
+   /* metrics (the counters, the high watermarks and the events counted */
+   /* per type).  If a non-zero parameter is specified the metrics are  */
+   /* cleared afterwards.  This function returns zero on successful     */
+   /* execution and a negative value on all errors.                     */
+static int DisplayMetrics(ParameterList_t *TempParam)
+{
+   unsigned int Index;
+
+   Display(("Metrics:\r\n"));
+
+   for(Index=0;Index<mcNumberCounters;Index++)
+      Display(("   %-22s %10lu\r\n", Metrics_CounterName((Metrics_Counter_t)Index), Metrics.Counters[Index]));
+
+   Display(("High Watermarks:\r\n"));
+
+   for(Index=0;Index<mwNumberWatermarks;Index++)
+      Display(("   %-22s %10lu\r\n", Metrics_WatermarkName((Metrics_Watermark_t)Index), Metrics.Watermarks[Index]));
+
+   DisplayEventCounts("GAP", METRICS_GAP_EVENT_TYPES, Metrics.GAPEvents);
+   DisplayEventCounts("HFRE", METRICS_HFRE_EVENT_TYPES, Metrics.HFREEvents);
+   DisplayEventCounts("GATT Server", METRICS_GATT_SERVER_EVENT_TYPES, Metrics.GATTServerEvents);
+   DisplayEventCounts("GATT Connection", METRICS_GATT_CONNECTION_EVENT_TYPES, Metrics.GATTConnectionEvents);
+
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
    {
-      /* No valid Bluetooth Stack ID exists.                            */
-      Display(("Stack ID Invalid.\r\n"));
+      Metrics_Reset();
 
-      ret_val = INVALID_STACK_ID_ERROR;
+      Display(("Metrics cleared.\r\n"));
    }
 
-   return(ret_val);
+   return(0);
 }
 
-   /* The following function is responsible for sending the command to  */
-   /* Anwser an Incoming Call on the Remote Audio Gateway.  This        */
-   /* function returns zero on successful execution and a negative value*/
-   /* on all errors.                                                    */
-static int AnswerIncomingCall(ParameterList_t *TempParam)
+#ifdef PROFILE_ENABLE
+
+   /* The following function is responsible for displaying the handler  */
+   /* latency histograms.  If a non-zero parameter is specified the     */
+   /* measurements are cleared afterwards.  This function returns zero  */
+   /* on successful execution and a negative value on all errors.       */
+static int DisplayProfile(ParameterList_t *TempParam)
 {
-   int Result;
-   int ret_val;
+   Profile_Display();
 
-   /* First, check that valid Bluetooth Stack ID exists.                */
-   if(BluetoothStackID)
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
    {
-      /* Now check to make sure that the Port ID appears to be          */
-      /* semi-valid.                                                    */
-      if(HFServerPortID)
-      {
-         /* The Port ID appears to be a semi-valid value.  Now submit   */
-         /* the command.                                                */
-         Result  = HFRE_Answer_Incoming_Call(BluetoothStackID, HFServerPortID);
+      Profile_Reset();
 
-         /* Set the return value of this function equal to the Result of*/
-         /* the function call.                                          */
-         ret_val = Result;
+      Display(("Measurements cleared.\r\n"));
+   }
 
-         /* Now check to see if the command was submitted successfully. */
-         if(!Result)
-         {
-            /* The function was submitted successfully.                 */
-            Display(("HFRE_Answer_Incoming_Call: Function Successful.\r\n"));
-         }
-         else
-         {
-            /* There was an error submitting the function.              */
-            Display(("HFRE_Answer_Incoming_Call() Failure: %d.\r\n", Result));
-         }
-      }
-      else
-      {
-         /* One or more of the parameters are invalid.                  */
-         Display(("Answer Incoming Call: Invalid Port ID.\r\n"));
+   return(0);
+}
 
-         ret_val = FUNCTION_ERROR;
-      }
-   }
-   else
+#endif
+
+#ifdef MEM_POOL_ENABLE
+
+   /* The following function is responsible for displaying the counters */
+   /* of the memory pool.  If a non-zero parameter is specified the     */
+   /* counters are cleared afterwards.  This function returns zero on   */
+   /* successful execution and a negative value on all errors.          */
+static int DisplayMemPool(ParameterList_t *TempParam)
+{
+   MemPool_Display();
+
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
    {
-      /* No valid Bluetooth Stack ID exists.                            */
-      ret_val = INVALID_STACK_ID_ERROR;
+      MemPool_ResetStatistics();
+
+      Display(("Counters cleared.\r\n"));
    }
 
-   return(ret_val);
+   return(0);
 }
 
-   /* The following function is responsible for sending the command to  */
-   /* HangUp ongoing calls or reject incoming calls on the Remote Audio */
-   /* Gateway.  This function returns zero on successful execution and a*/
-   /* negative value on all errors.                                     */
-static int HangUpCall(ParameterList_t *TempParam)
+#endif
+
+   /*********************************************************************/
+   /*                         Event Callbacks                           */
+   /*********************************************************************/
+
+   /* The following function is for the HCI Event Callback.  This       */
+   /* function will be called whenever an HCI Event is received from the*/
+   /* Local Bluetooth Device.  It is used to keep the Peer Cache up to  */
+   /* date (Connection Handles, Clock Offsets, Page Scan Repetition     */
+   /* Modes and Remote Features) and to measure the page latency of     */
+   /* outgoing connections.  Bonding that is waiting on a connection    */
+   /* that was paged with cached parameters is also initiated from here.*/
+   /* * NOTE * This function MUST NOT Block and wait for events that    */
+   /*          can only be satisfied by Receiving other HCI Events.     */
+static void BTPSAPI HCI_Event_Callback(unsigned int BluetoothStackID, HCI_Event_Data_t *HCI_Event_Data, unsigned long CallbackParameter)
 {
-   int Result;
-   int ret_val;
+   long       PageTime;
+   Byte_t     Status;
+   BoardStr_t BoardStr;
 
-   /* First, check that valid Bluetooth Stack ID exists.                */
-   if(BluetoothStackID)
+   if((BluetoothStackID) && (HCI_Event_Data))
    {
-      /* Now check to make sure that the Port ID appears to be          */
-      /* semi-valid.                                                    */
-      if(HFServerPortID)
-      {
-         /* The Port ID appears to be a semi-valid value.  Now submit   */
-         /* the command.                                                */
-         Result  = HFRE_Hang_Up_Call(BluetoothStackID, HFServerPortID);
+      /* Track the ACL links and their modes for the sniff manager.     */
+      Sniff_ProcessHCIEvent(HCI_Event_Data);
 
-         /* Set the return value of this function equal to the Result of*/
-         /* the function call.                                          */
-         ret_val = Result;
+      /* Record the attempts and the negotiated set of the audio links. */
+      AudioLink_ProcessHCIEvent(HCI_Event_Data);
 
-         /* Now check to see if the command was submitted successfully. */
-         if(!Result)
-         {
-            /* The function was submitted successfully.                 */
-            Display(("HFRE_Hang_Up_Call: Function Successful.\r\n"));
-         }
-         else
-         {
-            /* There was an error submitting the function.              */
-            Display(("HFRE_Hang_Up_Call() Failure: %d.\r\n", Result));
-         }
-      }
-      else
+      switch(HCI_Event_Data->Event_Data_Type)
       {
-         /* One or more of the parameters are invalid.                  */
-         Display(("Hang Up Call: Invalid Port ID.\r\n"));
+         case etConnection_Complete_Event:
+            if(HCI_Event_Data->Event_Data.HCI_Connection_Complete_Event_Data)
+            {
+               /* Note the page latency if this was a connection that we*/
+               /* initiated.                                            */
+               PageTime = PeerCache_PageComplete(HCI_Event_Data->Event_Data.HCI_Connection_Complete_Event_Data->BD_ADDR, HCI_Event_Data->Event_Data.HCI_Connection_Complete_Event_Data->Status);
+               if(PageTime >= 0)
+               {
+                  BD_ADDRToStr(HCI_Event_Data->Event_Data.HCI_Connection_Complete_Event_Data->BD_ADDR, BoardStr);
+                  Display(("\r\nPage %s: %s, %ld ms.\r\n", BoardStr, (HCI_Event_Data->Event_Data.HCI_Connection_Complete_Event_Data->Status)?"Failed":"Complete", PageTime));
+               }
 
-         ret_val = FUNCTION_ERROR;
+               if(HCI_Event_Data->Event_Data.HCI_Connection_Complete_Event_Data->Status == HCI_ERROR_CODE_NO_ERROR)
+               {
+                  PeerCache_ConnectionEstablished(HCI_Event_Data->Event_Data.HCI_Connection_Complete_Event_Data->BD_ADDR, HCI_Event_Data->Event_Data.HCI_Connection_Complete_Event_Data->Connection_Handle);
+
+                  /* Refresh the Clock Offset and Remote Features of the*/
+                  /* device (the results are delivered as events).      */
+                  HCI_Read_Clock_Offset(BluetoothStackID, HCI_Event_Data->Event_Data.HCI_Connection_Complete_Event_Data->Connection_Handle, &Status);
+                  HCI_Read_Remote_Supported_Features(BluetoothStackID, HCI_Event_Data->Event_Data.HCI_Connection_Complete_Event_Data->Connection_Handle, &Status);
+               }
+
+               /* Resume a bond that waits on this connection.          */
+               Coroutine_Signal(FLOW_EVENT_CONNECTION, &(HCI_Event_Data->Event_Data.HCI_Connection_Complete_Event_Data->BD_ADDR), HCI_Event_Data->Event_Data.HCI_Connection_Complete_Event_Data->Status);
+            }
+            break;
+         case etDisconnection_Complete_Event:
+            if(HCI_Event_Data->Event_Data.HCI_Disconnection_Complete_Event_Data)
+            {
+               PeerCache_ConnectionTerminated(HCI_Event_Data->Event_Data.HCI_Disconnection_Complete_Event_Data->Connection_Handle);
+
+               /* A Supervision Timeout means the link was lost rather  */
+               /* than closed by either side.  If the AG port is still  */
+               /* open the Close Port Indication that follows starts the*/
+               /* reconnection, otherwise it has already been closed and*/
+               /* the reconnection is started now.                      */
+               if(HCI_Event_Data->Event_Data.HCI_Disconnection_Complete_Event_Data->Reason == HCI_ERROR_CODE_CONNECTION_TIMEOUT)
+               {
+                  if(!COMPARE_NULL_BD_ADDR(ConnectedBD_ADDR))
+                     LinkLossDetected = TRUE;
+                  else
+                  {
+                     if(!COMPARE_NULL_BD_ADDR(LostBD_ADDR))
+                        ScheduleReconnect(LostBD_ADDR);
+                  }
+               }
+            }
+            break;
+         case etRead_Clock_Offset_Complete_Event:
+            if((HCI_Event_Data->Event_Data.HCI_Read_Clock_Offset_Complete_Event_Data) && (HCI_Event_Data->Event_Data.HCI_Read_Clock_Offset_Complete_Event_Data->Status == HCI_ERROR_CODE_NO_ERROR))
+               PeerCache_UpdateClockOffsetByHandle(HCI_Event_Data->Event_Data.HCI_Read_Clock_Offset_Complete_Event_Data->Connection_Handle, HCI_Event_Data->Event_Data.HCI_Read_Clock_Offset_Complete_Event_Data->Clock_Offset);
+            break;
+         case etRead_Remote_Supported_Features_Complete_Event:
+            if((HCI_Event_Data->Event_Data.HCI_Read_Remote_Supported_Features_Complete_Event_Data) && (HCI_Event_Data->Event_Data.HCI_Read_Remote_Supported_Features_Complete_Event_Data->Status == HCI_ERROR_CODE_NO_ERROR))
+               PeerCache_UpdateFeaturesByHandle(HCI_Event_Data->Event_Data.HCI_Read_Remote_Supported_Features_Complete_Event_Data->Connection_Handle, &(HCI_Event_Data->Event_Data.HCI_Read_Remote_Supported_Features_Complete_Event_Data->LMP_Features));
+            break;
+         case etPage_Scan_Repetition_Mode_Change_Event:
+            if(HCI_Event_Data->Event_Data.HCI_Page_Scan_Repetition_Mode_Change_Event_Data)
+               PeerCache_UpdatePageScanMode(HCI_Event_Data->Event_Data.HCI_Page_Scan_Repetition_Mode_Change_Event_Data->BD_ADDR, HCI_Event_Data->Event_Data.HCI_Page_Scan_Repetition_Mode_Change_Event_Data->Page_Scan_Repetition_Mode);
+            break;
+         default:
+            /* All other HCI Events are handled by the stack.           */
+            break;
       }
    }
-   else
-   {
-      /* No valid Bluetooth Stack ID exists.                            */
-      ret_val = INVALID_STACK_ID_ERROR;
-   }
-
-   return(ret_val);
 }
 
-   /*********************************************************************/
-   /*                         Event Callbacks                           */
-   /*********************************************************************/
-
    /* The following function is for the GAP Event Receive Data Callback.*/
    /* This function will be called whenever a Callback has been         */
    /* registered for the specified GAP Action that is associated with   */
@@ -2730,11 +3802,18 @@ static void BTPSAPI GAP_Event_Callback(unsigned int BluetoothStackID, GAP_Event_
    GAP_Inquiry_Event_Data_t         *GAP_Inquiry_Event_Data;
    GAP_Remote_Name_Event_Data_t     *GAP_Remote_Name_Event_Data;
    GAP_Authentication_Information_t  GAP_Authentication_Information;
+   PROFILE_DECLARE(ProfileStart)
+   STACK_MARK_DECLARE(StackMark)
 
    /* First, check to see if the required parameters appear to be       */
    /* semi-valid.                                                       */
    if((BluetoothStackID) && (GAP_Event_Data))
    {
+      STACK_MARK_START(StackMark);
+      PROFILE_START(ProfileStart);
+
+      METRICS_COUNT_EVENT(GAPEvents, GAP_Event_Data->Event_Data_Type);
+
       Display(("\r\n"));
 
       /* The parameters appear to be semi-valid, now check to see what  */
@@ -2764,12 +3843,19 @@ static void BTPSAPI GAP_Event_Callback(unsigned int BluetoothStackID, GAP_Event_
                      InquiryResultList[Index] = GAP_Inquiry_Event_Data->GAP_Inquiry_Data[Index].BD_ADDR;
                      BD_ADDRToStr(GAP_Inquiry_Event_Data->GAP_Inquiry_Data[Index].BD_ADDR, BoardStr);
 
+                     /* Remember how to page this device quickly.       */
+                     PeerCache_UpdatePageInformation(GAP_Inquiry_Event_Data->GAP_Inquiry_Data[Index].BD_ADDR, GAP_Inquiry_Event_Data->GAP_Inquiry_Data[Index].Page_Scan_Repetition_Mode, GAP_Inquiry_Event_Data->GAP_Inquiry_Data[Index].Clock_Offset);
+                     PeerCache_UpdateClassOfDevice(GAP_Inquiry_Event_Data->GAP_Inquiry_Data[Index].BD_ADDR, GAP_Inquiry_Event_Data->GAP_Inquiry_Data[Index].Class_of_Device);
+
                      Display(("GAP Inquiry Result: %d, %s.\r\n", (Index+1), BoardStr));
                   }
 
                   NumberofValidResponses = GAP_Inquiry_Event_Data->Number_Devices;
                }
             }
+
+            /* Resume the inquiry that waits on the results.            */
+            Coroutine_Signal(FLOW_EVENT_INQUIRY, NULL, 0);
             break;
          case etInquiry_Entry_Result:
             /* Next convert the BD_ADDR to a string.                    */
@@ -2777,6 +3863,9 @@ static void BTPSAPI GAP_Event_Callback(unsigned int BluetoothStackID, GAP_Event_
 
             /* Display this GAP Inquiry Entry Result.                   */
             Display(("GAP Inquiry Entry Result: %s.\r\n", BoardStr));
+
+            /* Remember how to page this device quickly.                */
+            PeerCache_UpdatePageInformation(GAP_Event_Data->Event_Data.GAP_Inquiry_Entry_Event_Data->BD_ADDR, GAP_Event_Data->Event_Data.GAP_Inquiry_Entry_Event_Data->Page_Scan_Repetition_Mode, GAP_Event_Data->Event_Data.GAP_Inquiry_Entry_Event_Data->Clock_Offset);
             break;
          case etAuthentication:
             /* An authentication event occurred, determine which type of*/
@@ -2839,6 +3928,9 @@ static void BTPSAPI GAP_Event_Callback(unsigned int BluetoothStackID, GAP_Event_
                   /* Flag that there is no longer a current             */
                   /* Authentication procedure in progress.              */
                   ASSIGN_BD_ADDR(CurrentRemoteBD_ADDR, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+
+                  /* Resume a bond that waits on this status.           */
+                  Coroutine_Signal(FLOW_EVENT_AUTHENTICATION, &(GAP_Event_Data->Event_Data.GAP_Authentication_Event_Data->Remote_Device), GAP_Event_Data->Event_Data.GAP_Authentication_Event_Data->Authentication_Event_Data.Authentication_Status);
                   break;
                case atLinkKeyCreation:
                   /* A link key creation event occurred, first display  */
@@ -3024,6 +4116,9 @@ static void BTPSAPI GAP_Event_Callback(unsigned int BluetoothStackID, GAP_Event_
             break;
       }
 
+      PROFILE_STOP(ProfileStart, "GAP_Event_Callback", GAP_Event_Data->Event_Data_Type);
+      STACK_MARK_STOP(StackMark, "GAP_Event_Callback", GAP_Event_Data->Event_Data_Type);
+
       DisplayPrompt();
    }
    else
@@ -3063,17 +4158,25 @@ static void BTPSAPI GAP_Event_Callback(unsigned int BluetoothStackID, GAP_Event_
    /*          be issued while this function is currently outstanding.  */
 static void BTPSAPI HFRE_Event_Callback(unsigned int BluetoothStackID, HFRE_Event_Data_t *HFREEventData, unsigned long CallbackParameter)
 {
-   int           Result;
-   Word_t        ConnectionHandle;
-   BoardStr_t    BoardStr;
-   unsigned int  SelectedCodecID;
-   unsigned char AvailableCode;
-   unsigned long ActiveFeatures;
+   int                     Result;
+   Word_t                  ConnectionHandle;
+   BoardStr_t              BoardStr;
+   unsigned int            SelectedCodecID;
+   unsigned char           AvailableCode;
+   unsigned long           ActiveFeatures;
+   AudioLink_Information_t AudioInformation;
+   PROFILE_DECLARE(ProfileStart)
+   STACK_MARK_DECLARE(StackMark)
 
    /* First, check to see if the required parameters appear to be       */
    /* semi-valid.                                                       */
    if(HFREEventData != NULL)
    {
+      STACK_MARK_START(StackMark);
+      PROFILE_START(ProfileStart);
+
+      METRICS_COUNT_EVENT(HFREEvents, HFREEventData->Event_Data_Type);
+
       /* The parameters appear to be semi-valid, now check to see what  */
       /* type the incoming event is.                                    */
       switch(HFREEventData->Event_Data_Type)
@@ -3084,6 +4187,31 @@ static void BTPSAPI HFRE_Event_Callback(unsigned int BluetoothStackID, HFRE_Even
             BD_ADDRToStr(HFREEventData->Event_Data.HFRE_Open_Port_Indication_Data->BD_ADDR, BoardStr);
             Display(("\r\nHFRE Open Port Indication, ID: 0x%04X, Board: %s.\r\n", HFREEventData->Event_Data.HFRE_Open_Port_Indication_Data->HFREPortID, BoardStr));
             ConnectedBD_ADDR = HFREEventData->Event_Data.HFRE_Open_Port_Indication_Data->BD_ADDR;
+
+            /* If the AG reconnected on its own while we were trying to */
+            /* reconnect to it, the link has been recovered.            */
+            if((Recovery_InProgress(RECOVERY_ID_HFP_PEER)) && (COMPARE_BD_ADDR(ConnectedBD_ADDR, ReconnectBD_ADDR)))
+               Recovery_Complete(RECOVERY_ID_HFP_PEER, TRUE);
+            break;
+         case etHFRE_Open_Port_Confirmation:
+            /* The result of a reconnection attempt to an AG was        */
+            /* received.                                                */
+            Display(("\r\nHFRE Open Port Confirmation, ID: 0x%04X, Status: 0x%04X.\r\n", HFREEventData->Event_Data.HFRE_Open_Port_Confirmation_Data->HFREPortID, HFREEventData->Event_Data.HFRE_Open_Port_Confirmation_Data->PortOpenStatus));
+
+            if(HFREEventData->Event_Data.HFRE_Open_Port_Confirmation_Data->PortOpenStatus == HFRE_OPEN_PORT_STATUS_SUCCESS)
+            {
+               ConnectedBD_ADDR = ReconnectBD_ADDR;
+
+               Recovery_Complete(RECOVERY_ID_HFP_PEER, TRUE);
+
+               DisplayRecovery(NULL);
+            }
+            else
+            {
+               HFClientPortID = 0;
+
+               Recovery_Complete(RECOVERY_ID_HFP_PEER, FALSE);
+            }
             break;
          case etHFRE_Open_Service_Level_Connection_Indication:
             /* A Open Service Level Indication was received, display    */
@@ -3096,6 +4224,9 @@ static void BTPSAPI HFRE_Event_Callback(unsigned int BluetoothStackID, HFRE_Even
             /* Enabled Caller ID information,                           */
             HFRE_Enable_Remote_Call_Line_Identification_Notification(BluetoothStackID, HFREEventData->Event_Data.HFRE_Open_Service_Level_Connection_Indication_Data->HFREPortID, TRUE);
             Display(("HFRE_Enable Call Line Identification\r\n"));
+
+            /* The link may go into sniff mode from now on.             */
+            Sniff_EnableLink(ConnectedBD_ADDR, TRUE);
             break;
          case etHFRE_Control_Indicator_Status_Indication:
             /* A Control Indicator Status Indication was received,      */
@@ -3153,6 +4284,10 @@ static void BTPSAPI HFRE_Event_Callback(unsigned int BluetoothStackID, HFRE_Even
             /* A Ring Indication was received, display all relevant     */
             /* information.                                             */
             Display(("\r\nHFRE Ring Indication, ID: 0x%04X.\r\n", HFREEventData->Event_Data.HFRE_Ring_Indication_Data->HFREPortID));
+
+            /* The call is likely answered and its audio set up next,   */
+            /* leave sniff mode now rather than at the audio setup.     */
+            Sniff_Wake(ConnectedBD_ADDR);
             break;
          case etHFRE_InBand_Ring_Tone_Setting_Indication:
             /* An InBand Ring Tone Setting Indication was received,     */
@@ -3184,9 +4319,24 @@ static void BTPSAPI HFRE_Event_Callback(unsigned int BluetoothStackID, HFRE_Even
             Display(("\r\nHFRE Close Port Indication, ID: 0x%04X, Status: 0x%04X.\r\n", HFREEventData->Event_Data.HFRE_Close_Port_Indication_Data->HFREPortID,
                                                                                         HFREEventData->Event_Data.HFRE_Close_Port_Indication_Data->PortCloseStatus));
 
+            if(HFREEventData->Event_Data.HFRE_Close_Port_Indication_Data->HFREPortID == (unsigned int)HFClientPortID)
+               HFClientPortID = 0;
+
+            /* Reconnect to the AG if the link was lost (the HCI        */
+            /* Disconnection may also arrive after this event, in which */
+            /* case the reconnection is started from there).            */
+            LostBD_ADDR = ConnectedBD_ADDR;
+
+            if(LinkLossDetected)
+               ScheduleReconnect(LostBD_ADDR);
+
+            Sniff_EnableLink(ConnectedBD_ADDR, FALSE);
+
             /* Flag that an Audio Connection is no longer present.      */
             ASSIGN_BD_ADDR(ConnectedBD_ADDR, 0, 0, 0, 0, 0, 0);
 
+            AudioCodec = acCVSD;
+
             /* Make sure the WBS is Disabled and the Codec is setup for */
             /* 8KHz.                                                    */
             if((Result = VS_DisableWBS(BluetoothStackID)) < 0)
@@ -3196,11 +4346,33 @@ static void BTPSAPI HFRE_Event_Callback(unsigned int BluetoothStackID, HFRE_Even
             /* An Audio Connection Indication was received, display all */
             /* relevant information.                                    */
             Display(("\r\nHFRE Audio Connection Indication, ID: 0x%04X, Status: 0x%04X.\r\n", HFREEventData->Event_Data.HFRE_Audio_Connection_Indication_Data->HFREPortID, HFREEventData->Event_Data.HFRE_Audio_Connection_Indication_Data->AudioConnectionOpenStatus));
+
+            /* The link stays active while the audio connection is up.  */
+            if(HFREEventData->Event_Data.HFRE_Audio_Connection_Indication_Data->AudioConnectionOpenStatus == HFRE_AUDIO_CONNECTION_STATUS_SUCCESS)
+            {
+               Sniff_NoteAudio(ConnectedBD_ADDR, TRUE);
+
+               if(!AudioLink_QueryLink(&AudioInformation))
+                  Display(("Audio Link: %s set %s, %s, latency %lu.%03lu ms.\r\n", (AudioInformation.Codec == acMSBC)?"mSBC":"CVSD", AudioLink_SetName(AudioInformation.Set), AudioLink_PacketName(&AudioInformation), AudioInformation.Latency / 1000, AudioInformation.Latency % 1000));
+            }
+
+            /* A failed setup goes on with the next set (or with CVSD   */
+            /* after mSBC), the setup is resumed once it is over.       */
+            if(AudioLink_ProcessAudioConnection(ConnectedBD_ADDR, HFREEventData->Event_Data.HFRE_Audio_Connection_Indication_Data->AudioConnectionOpenStatus))
+               Display(("Audio Link: setup failed, retrying with the next set.\r\n"));
+            else
+               Coroutine_Signal(FLOW_EVENT_AUDIO, &ConnectedBD_ADDR, HFREEventData->Event_Data.HFRE_Audio_Connection_Indication_Data->AudioConnectionOpenStatus);
             break;
          case etHFRE_Audio_Disconnection_Indication:
             /* An Audio Disconnection Indication was received, display  */
             /* all relevant information.                                */
             Display(("\r\nHFRE Audio Disconnection Indication, ID: 0x%04X.\r\n", HFREEventData->Event_Data.HFRE_Audio_Disconnection_Indication_Data->HFREPortID));
+
+            Sniff_NoteAudio(ConnectedBD_ADDR, FALSE);
+
+            /* A codec list limited to CVSD for the connection is       */
+            /* restored, so the AG may select mSBC for the next one.    */
+            AudioLink_ProcessAudioDisconnection(ConnectedBD_ADDR);
             break;
          case etHFRE_Subscriber_Number_Information_Indication:
             Display(("\r\nHFRE Subscriber Number Information Indication, ID: 0x%04X.\r\n", HFREEventData->Event_Data.HFRE_Subscriber_Number_Information_Indication_Data->HFREPortID));
@@ -3229,6 +4401,9 @@ static void BTPSAPI HFRE_Event_Callback(unsigned int BluetoothStackID, HFRE_Even
          case etHFRE_Codec_Select_Request_Indication:
             Display(("\r\netHFRE_Codec_Select_Indication, ID: 0x%04X Codec ID: %d.\r\n", HFREEventData->Event_Data.HFRE_Codec_Select_Indication_Data->HFREPortID, HFREEventData->Event_Data.HFRE_Codec_Select_Indication_Data->CodecID));
 
+            /* The codec selection precedes the audio setup of the AG.  */
+            Sniff_Wake(ConnectedBD_ADDR);
+
             /* * NOTE * Here is where the AG suggests a Codec to use.   */
             /*          Codec ID 1 is for CVSD and CodecID 2 is for     */
             /*          mSBC.  If anything other than a 1 or 2 is       */
@@ -3299,6 +4474,12 @@ static void BTPSAPI HFRE_Event_Callback(unsigned int BluetoothStackID, HFRE_Even
 
                HFRE_Send_Select_Codec(BluetoothStackID, HFREEventData->Event_Data.HFRE_Codec_Select_Indication_Data->HFREPortID, SelectedCodecID);
             }
+
+            /* The audio connection that follows is one of the selected */
+            /* codec.                                                   */
+            AudioCodec = (SelectedCodecID == HFRE_MSBC_CODEC_ID)?acMSBC:acCVSD;
+
+            AudioLink_ProcessCodecSelection(ConnectedBD_ADDR, AudioCodec);
             break;
          default:
             /* An unknown/unexpected HFRE event was received.           */
@@ -3306,6 +4487,13 @@ static void BTPSAPI HFRE_Event_Callback(unsigned int BluetoothStackID, HFRE_Even
             break;
       }
 
+      /* Every event of the AG is AT traffic on its link (it restarts   */
+      /* the idle time of the sniff manager).                           */
+      Sniff_NoteActivity(ConnectedBD_ADDR);
+
+      PROFILE_STOP(ProfileStart, "HFRE_Event_Callback", HFREEventData->Event_Data_Type);
+      STACK_MARK_STOP(StackMark, "HFRE_Event_Callback", HFREEventData->Event_Data_Type);
+
       DisplayPrompt();
    }
    else
@@ -3315,6 +4503,96 @@ static void BTPSAPI HFRE_Event_Callback(unsigned int BluetoothStackID, HFRE_Even
    }
 }
 
+   /* The following function is for the SDP Event Receive Data         */
+   /* Callback.  This function will be called whenever a response to the*/
+   /* SDP request issued by ReconnectAudioGateway() is received (or the */
+   /* request fails).  If the RFCOMM Server Channel of the AG was found */
+   /* the HFP port to the AG is opened, otherwise the reconnection      */
+   /* attempt is flagged as failed so that it is retried later.         */
+   /* * NOTE * This function MUST NOT Block and wait for events that    */
+   /*          can only be satisfied by Receiving other SDP Events.     */
+static void BTPSAPI SDP_Event_Callback(unsigned int BluetoothStackID, unsigned int SDPRequestID, SDP_Response_Data_t *SDP_Response_Data, unsigned long CallbackParameter)
+{
+   int                                    Result;
+   int                                    ServerChannel;
+   unsigned int                           Index;
+   unsigned int                           Index1;
+   SDP_Service_Attribute_Response_Data_t *ServiceRecord;
+
+   ServerChannel = -1;
+
+   if(SDP_Response_Data)
+   {
+      if(SDP_Response_Data->SDP_Response_Data_Type == rdServiceSearchAttributeResponse)
+      {
+         for(Index=0;(Index<SDP_Response_Data->SDP_Response_Data.SDP_Service_Search_Attribute_Response_Data.Number_Service_Records) && (ServerChannel < 0);Index++)
+         {
+            ServiceRecord = &(SDP_Response_Data->SDP_Response_Data.SDP_Service_Search_Attribute_Response_Data.SDP_Service_Attribute_Response_Data[Index]);
+
+            for(Index1=0;(Index1<ServiceRecord->Number_Attribute_Values) && (ServerChannel < 0);Index1++)
+            {
+               if(ServiceRecord->SDP_Service_Attribute_Value_Data[Index1].Attribute_ID == HFRE_AG_PROTOCOL_DESCRIPTOR_LIST_ID)
+                  ServerChannel = FindRFCOMMServerChannel(ServiceRecord->SDP_Service_Attribute_Value_Data[Index1].SDP_Data_Element);
+            }
+         }
+      }
+
+      if(ServerChannel > 0)
+      {
+         Result = HFRE_Open_Remote_Audio_Gateway_Port(BluetoothStackID, ReconnectBD_ADDR, (unsigned int)ServerChannel, HFRE_SUPPORTED_FEATURES, 0, NULL, HFRE_Event_Callback, (unsigned long)0);
+         if(Result > 0)
+         {
+            /* The result of the open is delivered as an Open Port      */
+            /* Confirmation event.                                      */
+            HFClientPortID = Result;
+
+            Display(("\r\nHFRE_Open_Remote_Audio_Gateway_Port: Function Successful (Channel %d).\r\n", ServerChannel));
+         }
+         else
+         {
+            Display(("\r\nHFRE_Open_Remote_Audio_Gateway_Port() Failure: %d.\r\n", Result));
+
+            Recovery_Complete(RECOVERY_ID_HFP_PEER, FALSE);
+         }
+      }
+      else
+      {
+         Display(("\r\nAG Service Discovery Failed, Response Type: %d.\r\n", SDP_Response_Data->SDP_Response_Data_Type));
+
+         Recovery_Complete(RECOVERY_ID_HFP_PEER, FALSE);
+      }
+
+      DisplayPrompt();
+   }
+}
+
+#ifdef SCAN_ENABLE
+
+   /* The following function is the LE scanner report callback.  It     */
+   /* displays the reports the scanner delivers (new devices, changed   */
+   /* data, changed average RSSI and lost devices).                     */
+static void Scan_Report_Callback(Scan_Report_t *Report, unsigned long CallbackParameter)
+{
+   static char *ReasonStrings[] = { "New", "Data", "RSSI", "Lost" };
+   BoardStr_t   BoardStr;
+
+   if(Report)
+   {
+      BD_ADDRToStr(Report->BD_ADDR, BoardStr);
+
+      Display(("\r\nScan %-4s %s %4d dBm", ReasonStrings[Report->Reason], BoardStr, Report->RSSI));
+
+      if(Report->Data)
+         Display((" %u bytes%s", Report->Data_Length, (Report->Report_Type == rtScanResponse)?" (scan response)":""));
+
+      Display(("%s\r\n", (Report->Tracked)?"":" (not tracked)"));
+
+      DisplayPrompt();
+   }
+}
+
+#endif
+
    /* The following function is used to initialize the application      */
    /* instance.  This function should open the stack and prepare to     */
    /* execute commands based on user input.  The first parameter passed */
@@ -3341,6 +4619,9 @@ int InitializeApplication(HCI_DriverInformation_t *HCI_DriverInformation, BTPS_I
          /* Connectable.                                                */
          if(!ret_val)
          {
+            BootSeq_MarkPhase("Connectable", 0);
+            BootSeq_MarkConnectable();
+
             /* Now that the device is Connectable attempt to make it    */
             /* Discoverable.                                            */
             ret_val = SetDisc();
@@ -3354,8 +4635,11 @@ int InitializeApplication(HCI_DriverInformation_t *HCI_DriverInformation, BTPS_I
                ret_val = SetPairable();
                if(!ret_val)
                {
-                  /* Set up the Selection Interface.                    */
-                  UserInterface();
+                  BootSeq_MarkPhase("GAP Config", 0);
+
+                  /* Show how long the boot took (phases that exceeded  */
+                  /* their budget are flagged).                         */
+                  BootSeq_Display();
 
                   /* Display a list of available commands.              */
                   DisplayHelp(NULL);
@@ -3394,6 +4678,15 @@ int InitializeApplication(HCI_DriverInformation_t *HCI_DriverInformation, BTPS_I
    return(ret_val);
 }
 
+   /* The following function is used to close the stack that was opened */
+   /* by InitializeApplication() (the application can be initialized    */
+   /* again afterwards).  This function returns zero if successful or a */
+   /* negative error code if the stack was not open.                    */
+int CloseApplication(void)
+{
+   return(CloseStack());
+}
+
    /* The following function is used to process a command line string.  */
    /* This function takes as it's only parameter the command line string*/
    /* to be parsed and returns TRUE if a command was parsed and executed*/
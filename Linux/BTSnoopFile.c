@@ -0,0 +1,201 @@
+/*****< btsnoopfile.c >********************************************************/
+/*                                                                            */
+/*  BTSnoopFile - Streams the BTSnoop capture ring to a file (Linux).  The    */
+/*                ring is drained from the main loop into large buffers that  */
+/*                a writer thread writes to the file, so the main loop never  */
+/*                waits on the file system.                                   */
+/*                                                                            */
+/******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "BTSnoopFile.h"   /* BTSnoop File Writer Prototypes/Constants.       */
+#include "../BTSnoop.h"    /* HCI Traffic Capture Prototypes/Constants.       */
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static FILE            *SnoopFile;                  /* Variable which holds the file   */
+                                                    /* that is written.                */
+
+static pthread_t        WriterThread;               /* Variables which hold the writer */
+static pthread_mutex_t  WriterMutex = PTHREAD_MUTEX_INITIALIZER; /* thread and the     */
+static pthread_cond_t   WriterCondition = PTHREAD_COND_INITIALIZER; /* signalling of   */
+static int              WriterExit;                 /* the buffers that are handed to  */
+                                                    /* it.                             */
+
+static unsigned char    BufferList[2][BTSNOOP_FILE_BUFFER_SIZE]; /* Variables which    */
+static unsigned int     BufferLength[2];            /* hold the write buffers.  The    */
+static int              BufferFull[2];              /* main loop fills one buffer while*/
+static unsigned int     FillIndex;                  /* the writer thread writes the    */
+                                                    /* other.                          */
+
+static struct timespec  FillStartTime;              /* Variable which holds the time   */
+                                                    /* the first data was put into the */
+                                                    /* buffer being filled.            */
+
+   /* Internal function prototypes.                                     */
+static void *WriterThreadMain(void *Parameter);
+static unsigned long ElapsedTime(struct timespec *Start);
+static void HandOffBuffer(void);
+
+   /* The following function is the writer thread, it writes each buffer */
+   /* that is handed to it and marks it free again.                     */
+static void *WriterThreadMain(void *Parameter)
+{
+   unsigned int Index;
+
+   pthread_mutex_lock(&WriterMutex);
+
+   Index = 0;
+
+   while((!WriterExit) || (BufferFull[Index]))
+   {
+      if(BufferFull[Index])
+      {
+         /* Write the buffer without holding the lock.                  */
+         pthread_mutex_unlock(&WriterMutex);
+
+         fwrite(BufferList[Index], 1, BufferLength[Index], SnoopFile);
+         fflush(SnoopFile);
+
+         pthread_mutex_lock(&WriterMutex);
+
+         BufferLength[Index] = 0;
+         BufferFull[Index]   = 0;
+         Index              ^= 1;
+
+         pthread_cond_broadcast(&WriterCondition);
+      }
+      else
+         pthread_cond_wait(&WriterCondition, &WriterMutex);
+   }
+
+   pthread_mutex_unlock(&WriterMutex);
+
+   return(NULL);
+}
+
+   /* The following function returns the time (in ms) since the         */
+   /* specified time.                                                   */
+static unsigned long ElapsedTime(struct timespec *Start)
+{
+   struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+
+   return((unsigned long)(((Now.tv_sec - Start->tv_sec) * 1000) + ((Now.tv_nsec - Start->tv_nsec) / 1000000)));
+}
+
+   /* The following function passes the buffer being filled to the      */
+   /* writer thread and continues with the other buffer (waiting for it */
+   /* to be written if the writer thread has fallen behind).            */
+static void HandOffBuffer(void)
+{
+   pthread_mutex_lock(&WriterMutex);
+
+   BufferFull[FillIndex] = 1;
+   FillIndex            ^= 1;
+
+   pthread_cond_broadcast(&WriterCondition);
+
+   while(BufferFull[FillIndex])
+      pthread_cond_wait(&WriterCondition, &WriterMutex);
+
+   pthread_mutex_unlock(&WriterMutex);
+}
+
+   /* The following function creates the specified file, writes the      */
+   /* BTSnoop file header and starts the writer thread.  This function  */
+   /* returns zero if successful or a negative value if the file could  */
+   /* not be created.                                                   */
+int BTSnoopFile_Open(char *FileName)
+{
+   int ret_val;
+
+   if((!SnoopFile) && (FileName) && ((SnoopFile = fopen(FileName, "wb")) != NULL))
+   {
+      memset(BufferLength, 0, sizeof(BufferLength));
+      memset(BufferFull, 0, sizeof(BufferFull));
+
+      FillIndex  = 0;
+      WriterExit = 0;
+
+      /* The file header goes out with the first buffer.                */
+      BTSnoop_ReadFileHeader(BufferList[0]);
+      BufferLength[0] = BTSNOOP_FILE_HEADER_SIZE;
+
+      clock_gettime(CLOCK_MONOTONIC, &FillStartTime);
+
+      if(!pthread_create(&WriterThread, NULL, WriterThreadMain, NULL))
+         ret_val = 0;
+      else
+      {
+         fclose(SnoopFile);
+
+         SnoopFile = NULL;
+         ret_val   = -1;
+      }
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function drains the capture ring.  It must be called*/
+   /* periodically from the main loop (the same context that feeds the  */
+   /* capture).  A buffer is passed to the writer thread when it is full*/
+   /* or has been held for BTSNOOP_FILE_FLUSH_INTERVAL.                 */
+void BTSnoopFile_Process(void)
+{
+   unsigned int Count;
+
+   if(SnoopFile)
+   {
+      do
+      {
+         if(!BufferLength[FillIndex])
+            clock_gettime(CLOCK_MONOTONIC, &FillStartTime);
+
+         Count = BTSnoop_Read(BTSNOOP_FILE_BUFFER_SIZE - BufferLength[FillIndex], &BufferList[FillIndex][BufferLength[FillIndex]]);
+
+         BufferLength[FillIndex] += Count;
+
+         if(BufferLength[FillIndex] == BTSNOOP_FILE_BUFFER_SIZE)
+            HandOffBuffer();
+      } while(Count);
+
+      if((BufferLength[FillIndex]) && (ElapsedTime(&FillStartTime) >= BTSNOOP_FILE_FLUSH_INTERVAL))
+         HandOffBuffer();
+   }
+}
+
+   /* The following function drains the ring, waits until all data has   */
+   /* been written and closes the file.                                 */
+void BTSnoopFile_Close(void)
+{
+   if(SnoopFile)
+   {
+      BTSnoopFile_Process();
+
+      pthread_mutex_lock(&WriterMutex);
+
+      if(BufferLength[FillIndex])
+         BufferFull[FillIndex] = 1;
+
+      WriterExit = 1;
+
+      pthread_cond_broadcast(&WriterCondition);
+      pthread_mutex_unlock(&WriterMutex);
+
+      pthread_join(WriterThread, NULL);
+
+      fclose(SnoopFile);
+
+      SnoopFile = NULL;
+   }
+}
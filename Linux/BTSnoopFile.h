@@ -0,0 +1,42 @@
+/*****< btsnoopfile.h >********************************************************/
+/*                                                                            */
+/*  BTSnoopFile - Streams the BTSnoop capture ring to a file (Linux).  The    */
+/*                ring is drained from the main loop into large buffers that  */
+/*                a writer thread writes to the file, so the main loop never  */
+/*                waits on the file system.                                   */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __BTSNOOPFILEH__
+#define __BTSNOOPFILEH__
+
+#ifndef BTSNOOP_FILE_BUFFER_SIZE
+
+#define BTSNOOP_FILE_BUFFER_SIZE                 (65536)  /* Denotes the size  */
+                                                         /* of each of the two*/
+                                                         /* write buffers.    */
+
+#endif
+
+#define BTSNOOP_FILE_FLUSH_INTERVAL               (1000)  /* Denotes the max   */
+                                                         /* time (in ms) that */
+                                                         /* captured data is  */
+                                                         /* held before it is */
+                                                         /* written.          */
+
+   /* The following function creates the specified file, writes the      */
+   /* BTSnoop file header and starts the writer thread.  This function  */
+   /* returns zero if successful or a negative value if the file could  */
+   /* not be created.                                                   */
+int BTSnoopFile_Open(char *FileName);
+
+   /* The following function drains the capture ring.  It must be called*/
+   /* periodically from the main loop (the same context that feeds the  */
+   /* capture).  A buffer is passed to the writer thread when it is full*/
+   /* or has been held for BTSNOOP_FILE_FLUSH_INTERVAL.                 */
+void BTSnoopFile_Process(void);
+
+   /* The following function drains the ring, waits until all data has   */
+   /* been written and closes the file.                                 */
+void BTSnoopFile_Close(void);
+
+#endif
@@ -0,0 +1,26 @@
+/*****< btpskrnl.h >***********************************************************/
+/*                                                                            */
+/*  BTPSKRNL - Host stand-in for the Bluetopia kernel API (Linux replay       */
+/*             build).  Implemented by StandIn.c on top of the C library.     */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __BTPSKRNLH__
+#define __BTPSKRNLH__
+
+#include "SS1BTPS.h"       /* Bluetopia API Stand-in Types/Prototypes.    */
+
+int BTPSAPI BTPS_Init(void *UserParam);
+int BTPSAPI BTPS_OutputMessage(const char *Format, ...);
+int BTPSAPI BTPS_SprintF(char *Buffer, const char *Format, ...);
+unsigned int BTPSAPI BTPS_StringLength(const char *Source);
+unsigned long BTPSAPI BTPS_GetTickCount(void);
+void *BTPSAPI BTPS_AllocateMemory(unsigned long MemorySize);
+void BTPSAPI BTPS_FreeMemory(void *MemoryPointer);
+void BTPSAPI BTPS_MemInitialize(void *Destination, int Value, unsigned long Size);
+void BTPSAPI BTPS_MemCopy(void *Destination, const void *Source, unsigned long Size);
+int BTPSAPI BTPS_MemCompare(const void *Source1, const void *Source2, unsigned long Size);
+void BTPSAPI BTPS_Delay(unsigned long MilliSeconds);
+
+#define BTPS_MemMove                      BTPS_MemCopy
+
+#endif
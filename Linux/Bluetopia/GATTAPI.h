@@ -0,0 +1,13 @@
+/*****< gattapi.h >************************************************************/
+/*                                                                            */
+/*  GATTAPI - Host stand-in for the Bluetopia GATT API (Linux replay          */
+/*            build).                                                         */
+/*    Everything is declared by SS1BTPS.h.                                    */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __GATTAPIH__
+#define __GATTAPIH__
+
+#include "SS1BTPS.h"       /* Bluetopia API Stand-in Types/Prototypes.    */
+
+#endif
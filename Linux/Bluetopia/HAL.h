@@ -0,0 +1,18 @@
+/*****< hal.h >****************************************************************/
+/*                                                                            */
+/*  HAL - Host stand-in for the board Hardware Abstraction Layer (Linux       */
+/*        replay build).  Implemented by StandIn.c.                           */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __HALH__
+#define __HALH__
+
+#include <stdio.h>          /* The target toolchain provides these to the  */
+#include <stdbool.h>        /* application implicitly (Main.c).            */
+#include "SS1BTPS.h"       /* Bluetopia API Stand-in Types/Prototypes.    */
+
+void HAL_ConfigureHardware(int EnablePLL);
+unsigned long HAL_GetTickCount(void);
+void HAL_LedToggle(int LED_ID);
+
+#endif
@@ -0,0 +1,11 @@
+/*****< halcfg.h >*************************************************************/
+/*                                                                            */
+/*  HALCFG - Host stand-in for the HAL configuration constants (Linux         */
+/*           replay build).  Nothing is configurable on the host.             */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __HALCFGH__
+#define __HALCFGH__
+
+
+#endif
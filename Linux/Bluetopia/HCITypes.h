@@ -0,0 +1,13 @@
+/*****< hcitypes.h >***********************************************************/
+/*                                                                            */
+/*  HCITypes - Host stand-in for the Bluetopia HCI type definitions (Linux    */
+/*             replay build).                                                 */
+/*    Everything is declared by SS1BTPS.h.                                    */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __HCITYPESH__
+#define __HCITYPESH__
+
+#include "SS1BTPS.h"       /* Bluetopia API Stand-in Types/Prototypes.    */
+
+#endif
@@ -0,0 +1,13 @@
+/*****< sdpapi.h >*************************************************************/
+/*                                                                            */
+/*  SDPAPI - Host stand-in for the Bluetopia SDP API (Linux replay            */
+/*            build).                                                         */
+/*    Everything is declared by SS1BTPS.h.                                    */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __SDPAPIH__
+#define __SDPAPIH__
+
+#include "SS1BTPS.h"       /* Bluetopia API Stand-in Types/Prototypes.    */
+
+#endif
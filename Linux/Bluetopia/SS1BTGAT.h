@@ -0,0 +1,13 @@
+/*****< ss1btgat.h >***********************************************************/
+/*                                                                            */
+/*  SS1BTGAT - Host stand-in for the Bluetopia GATT API (Linux replay         */
+/*            build).                                                         */
+/*    Everything is declared by SS1BTPS.h.                                    */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __SS1BTGATH__
+#define __SS1BTGATH__
+
+#include "SS1BTPS.h"       /* Bluetopia API Stand-in Types/Prototypes.    */
+
+#endif
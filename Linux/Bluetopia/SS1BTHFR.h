@@ -0,0 +1,212 @@
+/*****< ss1bthfr.h >***********************************************************/
+/*                                                                            */
+/*  SS1BTHFR - Host stand-in for the Bluetopia Hands-Free API (Linux replay   */
+/*             build).                                                        */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __SS1BTHFRH__
+#define __SS1BTHFRH__
+
+#include "SS1BTPS.h"       /* Bluetopia API Stand-in Types/Prototypes.    */
+
+#define HFRE_CLI_SUPPORTED_BIT 1
+#define HFRE_HF_ENHANCED_CALL_STATUS_SUPPORTED_BIT 2
+#define HFRE_HF_SOUND_ENHANCEMENT_SUPPORTED_BIT 4
+#define HFRE_HF_VOICE_RECOGNITION_SUPPORTED_BIT 8
+#define HFRE_HF_CODEC_NEGOTIATION_SUPPORTED_BIT 16
+#define HFRE_CVSD_CODEC_ID 1
+#define HFRE_MSBC_CODEC_ID 2
+typedef enum
+{
+   ciBoolean,
+   ciRange
+} HFRE_Control_Indicator_Type_t;
+typedef struct
+{
+   HFRE_Control_Indicator_Type_t ControlIndicatorType;
+   char *IndicatorDescription;
+   union
+   {
+      struct
+      {
+         Boolean_t CurrentIndicatorValue;
+      } ControlIndicatorBooleanType;
+      struct
+      {
+         unsigned int CurrentIndicatorValue;
+      } ControlIndicatorRangeType;
+   } Control_Indicator_Data;
+} HFRE_Control_Indicator_Entry_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+   BD_ADDR_t BD_ADDR;
+} HFRE_Open_Port_Indication_Data_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+   Boolean_t RemoteSupportedFeaturesValid;
+   unsigned long RemoteSupportedFeatures;
+   unsigned long RemoteCallHoldMultipartySupport;
+} HFRE_Open_Service_Level_Connection_Indication_Data_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+   HFRE_Control_Indicator_Entry_t HFREControlIndicatorEntry;
+} HFRE_Control_Indicator_Status_Indication_Data_t;
+typedef HFRE_Control_Indicator_Status_Indication_Data_t HFRE_Control_Indicator_Status_Confirmation_Data_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+   unsigned long CallHoldSupportMask;
+} HFRE_Call_Hold_Multiparty_Support_Confirmation_Data_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+   char *PhoneNumber;
+} HFRE_Call_Waiting_Notification_Indication_Data_t;
+typedef HFRE_Call_Waiting_Notification_Indication_Data_t HFRE_Call_Line_Identification_Notification_Indication_Data_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+} HFRE_Ring_Indication_Data_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+   Boolean_t Enabled;
+} HFRE_InBand_Ring_Tone_Setting_Indication_Data_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+} HFRE_Voice_Tag_Request_Indication_Data_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+   char *PhoneNumber;
+} HFRE_Voice_Tag_Request_Confirmation_Data_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+   unsigned int PortCloseStatus;
+} HFRE_Close_Port_Indication_Data_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+   unsigned int AudioConnectionOpenStatus;
+} HFRE_Audio_Connection_Indication_Data_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+} HFRE_Audio_Disconnection_Indication_Data_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+   unsigned int ServiceType;
+   unsigned int NumberFormat;
+   char *PhoneNumber;
+} HFRE_Subscriber_Number_Information_Indication_Data_t;
+typedef HFRE_Subscriber_Number_Information_Indication_Data_t HFRE_Subscriber_Number_Information_Confirmation_Data_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+   unsigned int CallState;
+} HFRE_Response_Hold_Status_Confirmation_Data_t;
+typedef HFRE_Response_Hold_Status_Confirmation_Data_t HFRE_Incoming_Call_State_Indication_Data_t;
+typedef HFRE_Response_Hold_Status_Confirmation_Data_t HFRE_Incoming_Call_State_Confirmation_Data_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+   unsigned int ResultType;
+   unsigned int ResultValue;
+} HFRE_Command_Result_Data_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+   unsigned int CodecID;
+} HFRE_Codec_Select_Indication_Data_t;
+typedef struct
+{
+   unsigned int HFREPortID;
+   unsigned int PortOpenStatus;
+} HFRE_Open_Port_Confirmation_Data_t;
+#define HFRE_OPEN_PORT_STATUS_SUCCESS 0
+#define HFRE_AUDIO_CONNECTION_STATUS_SUCCESS 0
+typedef enum
+{
+   etHFRE_Open_Port_Indication,
+   etHFRE_Open_Port_Confirmation,
+   etHFRE_Open_Service_Level_Connection_Indication,
+   etHFRE_Control_Indicator_Status_Indication,
+   etHFRE_Control_Indicator_Status_Confirmation,
+   etHFRE_Call_Hold_Multiparty_Support_Confirmation,
+   etHFRE_Call_Waiting_Notification_Indication,
+   etHFRE_Call_Line_Identification_Notification_Indication,
+   etHFRE_Ring_Indication,
+   etHFRE_InBand_Ring_Tone_Setting_Indication,
+   etHFRE_Voice_Tag_Request_Indication,
+   etHFRE_Voice_Tag_Request_Confirmation,
+   etHFRE_Close_Port_Indication,
+   etHFRE_Audio_Connection_Indication,
+   etHFRE_Audio_Disconnection_Indication,
+   etHFRE_Subscriber_Number_Information_Indication,
+   etHFRE_Subscriber_Number_Information_Confirmation,
+   etHFRE_Response_Hold_Status_Confirmation,
+   etHFRE_Incoming_Call_State_Indication,
+   etHFRE_Incoming_Call_State_Confirmation,
+   etHFRE_Command_Result,
+   etHFRE_Codec_Select_Request_Indication,
+   etHFRE_Audio_Data_Indication,
+   etHFRE_Voice_Recognition_Indication
+} HFRE_Event_Type_t;
+typedef struct
+{
+   HFRE_Event_Type_t Event_Data_Type;
+   Word_t Event_Data_Size;
+   union
+   {
+      HFRE_Open_Port_Indication_Data_t *HFRE_Open_Port_Indication_Data;
+      HFRE_Open_Port_Confirmation_Data_t *HFRE_Open_Port_Confirmation_Data;
+      HFRE_Open_Service_Level_Connection_Indication_Data_t *HFRE_Open_Service_Level_Connection_Indication_Data;
+      HFRE_Control_Indicator_Status_Indication_Data_t *HFRE_Control_Indicator_Status_Indication_Data;
+      HFRE_Control_Indicator_Status_Confirmation_Data_t *HFRE_Control_Indicator_Status_Confirmation_Data;
+      HFRE_Call_Hold_Multiparty_Support_Confirmation_Data_t *HFRE_Call_Hold_Multiparty_Support_Confirmation_Data;
+      HFRE_Call_Waiting_Notification_Indication_Data_t *HFRE_Call_Waiting_Notification_Indication_Data;
+      HFRE_Call_Line_Identification_Notification_Indication_Data_t *HFRE_Call_Line_Identification_Notification_Indication_Data;
+      HFRE_Ring_Indication_Data_t *HFRE_Ring_Indication_Data;
+      HFRE_InBand_Ring_Tone_Setting_Indication_Data_t *HFRE_InBand_Ring_Tone_Setting_Indication_Data;
+      HFRE_Voice_Tag_Request_Indication_Data_t *HFRE_Voice_Tag_Request_Indication_Data;
+      HFRE_Voice_Tag_Request_Confirmation_Data_t *HFRE_Voice_Tag_Request_Confirmation_Data;
+      HFRE_Close_Port_Indication_Data_t *HFRE_Close_Port_Indication_Data;
+      HFRE_Audio_Connection_Indication_Data_t *HFRE_Audio_Connection_Indication_Data;
+      HFRE_Audio_Disconnection_Indication_Data_t *HFRE_Audio_Disconnection_Indication_Data;
+      HFRE_Subscriber_Number_Information_Indication_Data_t *HFRE_Subscriber_Number_Information_Indication_Data;
+      HFRE_Subscriber_Number_Information_Confirmation_Data_t *HFRE_Subscriber_Number_Information_Confirmation_Data;
+      HFRE_Response_Hold_Status_Confirmation_Data_t *HFRE_Response_Hold_Status_Confirmation_Data;
+      HFRE_Incoming_Call_State_Indication_Data_t *HFRE_Incoming_Call_State_Indication_Data;
+      HFRE_Incoming_Call_State_Confirmation_Data_t *HFRE_Incoming_Call_State_Confirmation_Data;
+      HFRE_Command_Result_Data_t *HFRE_Command_Result_Data;
+      HFRE_Codec_Select_Indication_Data_t *HFRE_Codec_Select_Indication_Data;
+   } Event_Data;
+} HFRE_Event_Data_t;
+
+typedef void (BTPSAPI *HFRE_Event_Callback_t)(unsigned int BluetoothStackID, HFRE_Event_Data_t *HFRE_Event_Data, unsigned long CallbackParameter);
+
+int BTPSAPI HFRE_Open_HandsFree_Server_Port(unsigned int BluetoothStackID, unsigned int ServerPort, unsigned long SupportedFeatures, unsigned int NumberAdditionalIndicators, HFRE_Control_Indicator_Entry_t *AdditionalSupportedIndicators, HFRE_Event_Callback_t EventCallback, unsigned long CallbackParameter);
+int BTPSAPI HFRE_Open_Remote_Audio_Gateway_Port(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, unsigned int RemoteServerPort, unsigned long SupportedFeatures, unsigned int NumberAdditionalIndicators, HFRE_Control_Indicator_Entry_t *AdditionalSupportedIndicators, HFRE_Event_Callback_t EventCallback, unsigned long CallbackParameter);
+int BTPSAPI HFRE_Close_Server_Port(unsigned int BluetoothStackID, unsigned int HFREPortID);
+int BTPSAPI HFRE_Close_Port(unsigned int BluetoothStackID, unsigned int HFREPortID);
+int BTPSAPI HFRE_Register_HandsFree_SDP_Record(unsigned int BluetoothStackID, unsigned int HFREPortID, char *ServiceName, DWord_t *SDPServiceRecordHandle);
+int BTPSAPI HFRE_Setup_Audio_Connection(unsigned int BluetoothStackID, unsigned int HFREPortID);
+int BTPSAPI HFRE_Release_Audio_Connection(unsigned int BluetoothStackID, unsigned int HFREPortID);
+int BTPSAPI HFRE_Answer_Incoming_Call(unsigned int BluetoothStackID, unsigned int HFREPortID);
+int BTPSAPI HFRE_Hang_Up_Call(unsigned int BluetoothStackID, unsigned int HFREPortID);
+int BTPSAPI HFRE_Enable_Remote_Call_Line_Identification_Notification(unsigned int BluetoothStackID, unsigned int HFREPortID, Boolean_t EnableNotification);
+int BTPSAPI HFRE_Send_Available_Codecs(unsigned int BluetoothStackID, unsigned int HFREPortID, unsigned int NumberSupportedCodecs, unsigned char *AvailableCodecList);
+int BTPSAPI HFRE_Send_Select_Codec(unsigned int BluetoothStackID, unsigned int HFREPortID, unsigned char CodecID);
+
+   /* As in Bluetopia the SDP record is removed directly with SDP (the  */
+   /* port is not needed).                                              */
+#define HFRE_Un_Register_SDP_Record(__BluetoothStackID, __HFREPortID, __SDPRecordHandle) \
+        (SDP_Delete_Service_Record(__BluetoothStackID, __SDPRecordHandle))
+
+#endif
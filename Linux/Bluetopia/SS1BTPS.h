@@ -0,0 +1,1248 @@
+/*****< ss1btps.h >************************************************************/
+/*                                                                            */
+/*  SS1BTPS - Host stand-in for the Bluetopia API (Linux replay build).       */
+/*                                                                            */
+/*  Declares the subset of the Bluetopia types, constants and functions that  */
+/*  the application uses, so that the application sources can be built on    */
+/*  the host against StandIn.c.  The layouts only need to be self consistent, */
+/*  they do not match the binary layout of the real stack.                    */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __SS1BTPSH__
+#define __SS1BTPSH__
+
+#include <stdint.h>
+#include <stddef.h>
+#define BTPSAPI
+#define BTPSCONST const
+typedef unsigned char Byte_t;
+typedef unsigned short Word_t;
+typedef unsigned int DWord_t;
+typedef signed char SByte_t;
+typedef short SWord_t;
+typedef int SDWord_t;
+typedef unsigned long long QWord_t;
+typedef char Boolean_t;
+#define TRUE 1
+#define FALSE 0
+#ifndef NULL
+#define NULL ((void*)0)
+#endif
+
+typedef struct
+{
+   Byte_t BD_ADDR0,BD_ADDR1,BD_ADDR2,BD_ADDR3,BD_ADDR4,BD_ADDR5;
+} BD_ADDR_t;
+
+typedef struct
+{
+   Byte_t Class_of_Device0,Class_of_Device1,Class_of_Device2;
+} Class_of_Device_t;
+
+typedef struct
+{
+   Byte_t b[16];
+} Link_Key_t;
+
+typedef struct
+{
+   Byte_t b[16];
+} PIN_Code_t;
+
+typedef struct
+{
+   Byte_t LMP_Features0,LMP_Features1,LMP_Features2,LMP_Features3,LMP_Features4,LMP_Features5,LMP_Features6,LMP_Features7;
+} LMP_Features_t;
+
+typedef struct
+{
+   Byte_t UUID_Byte0,UUID_Byte1;
+} UUID_16_t;
+
+typedef struct
+{
+   Byte_t UUID_Byte0,UUID_Byte1,UUID_Byte2,UUID_Byte3,UUID_Byte4,UUID_Byte5,UUID_Byte6,UUID_Byte7,UUID_Byte8,UUID_Byte9,UUID_Byte10,UUID_Byte11,UUID_Byte12,UUID_Byte13,UUID_Byte14,UUID_Byte15;
+} UUID_128_t;
+
+typedef struct
+{
+   Byte_t b[16];
+} Encryption_Key_t;
+
+#define ASSIGN_BD_ADDR(_d,_5,_4,_3,_2,_1,_0) { (_d).BD_ADDR0=_0; (_d).BD_ADDR1=_1; (_d).BD_ADDR2=_2; (_d).BD_ADDR3=_3; (_d).BD_ADDR4=_4; (_d).BD_ADDR5=_5; }
+#define COMPARE_BD_ADDR(_a,_b) (((_a).BD_ADDR0==(_b).BD_ADDR0)&&((_a).BD_ADDR1==(_b).BD_ADDR1)&&((_a).BD_ADDR2==(_b).BD_ADDR2)&&((_a).BD_ADDR3==(_b).BD_ADDR3)&&((_a).BD_ADDR4==(_b).BD_ADDR4)&&((_a).BD_ADDR5==(_b).BD_ADDR5))
+#define ASSIGN_PIN_CODE(_d,_0,_1,_2,_3,_4,_5,_6,_7,_8,_9,_10,_11,_12,_13,_14,_15) { Byte_t __p[16] = {_0,_1,_2,_3,_4,_5,_6,_7,_8,_9,_10,_11,_12,_13,_14,_15}; BTPS_MemCopy(&(_d), __p, sizeof(__p)); }
+#define COMPARE_NULL_BD_ADDR(_a) (!((_a).BD_ADDR0|(_a).BD_ADDR1|(_a).BD_ADDR2|(_a).BD_ADDR3|(_a).BD_ADDR4|(_a).BD_ADDR5))
+#define ASSIGN_CLASS_OF_DEVICE(_d,_2,_1,_0) { (_d).Class_of_Device0=_0; (_d).Class_of_Device1=_1; (_d).Class_of_Device2=_2; }
+#define SET_MAJOR_DEVICE_CLASS(_c,_x)
+#define SET_MINOR_DEVICE_CLASS(_c,_x)
+#define HCI_LMP_CLASS_OF_DEVICE_MAJOR_DEVICE_CLASS_AUDIO_VIDEO 4
+#define HCI_LMP_CLASS_OF_DEVICE_MINOR_DEVICE_CLASS_AUDIO_VIDEO_HANDS_FREE 2
+#define ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(_p,_x) { ((Byte_t*)(_p))[0]=(Byte_t)(_x); ((Byte_t*)(_p))[1]=(Byte_t)((_x)>>8); }
+#define READ_UNALIGNED_WORD_LITTLE_ENDIAN(_p) ((Word_t)(((Byte_t*)(_p))[0] | (((Byte_t*)(_p))[1]<<8)))
+#define ASSIGN_HOST_DWORD_TO_LITTLE_ENDIAN_UNALIGNED_DWORD(_p,_x) { ((Byte_t*)(_p))[0]=(Byte_t)(_x); ((Byte_t*)(_p))[1]=(Byte_t)((_x)>>8); ((Byte_t*)(_p))[2]=(Byte_t)((_x)>>16); ((Byte_t*)(_p))[3]=(Byte_t)((_x)>>24); }
+#define READ_UNALIGNED_DWORD_LITTLE_ENDIAN(_p) ((DWord_t)(((Byte_t*)(_p))[0] | (((Byte_t*)(_p))[1]<<8) | (((Byte_t*)(_p))[2]<<16) | ((DWord_t)((Byte_t*)(_p))[3]<<24)))
+#define ASSIGN_HOST_DWORD_TO_BIG_ENDIAN_UNALIGNED_DWORD(_p,_x) { ((Byte_t*)(_p))[3]=(Byte_t)(_x); ((Byte_t*)(_p))[2]=(Byte_t)((_x)>>8); ((Byte_t*)(_p))[1]=(Byte_t)((_x)>>16); ((Byte_t*)(_p))[0]=(Byte_t)((_x)>>24); }
+#define ASSIGN_HOST_WORD_TO_BIG_ENDIAN_UNALIGNED_WORD(_p,_x) { ((Byte_t*)(_p))[1]=(Byte_t)(_x); ((Byte_t*)(_p))[0]=(Byte_t)((_x)>>8); }
+
+typedef int HCI_Version_t;
+typedef enum
+{
+   hdtCOMM,
+   hdtUSB
+} HCI_DriverType_t;
+
+typedef enum
+{
+   cpUART,
+   cpBCSP,
+   cpHCILL,
+   cpHCILL_RTS_CTS,
+   cpUART_RTS_CTS
+} HCI_COMM_Protocol_t;
+
+typedef struct
+{
+   unsigned int DriverInformationSize;
+   unsigned int COMPortNumber;
+   unsigned long BaudRate;
+   HCI_COMM_Protocol_t Protocol;
+   unsigned int InitializationDelay;
+   char *COMDeviceName;
+} HCI_COMMDriverInformation_t;
+
+typedef struct
+{
+   HCI_DriverType_t DriverType;
+   union
+   {
+      HCI_COMMDriverInformation_t COMMDriverInformation;
+   } DriverInformation;
+} HCI_DriverInformation_t;
+
+#define HCI_DRIVER_SET_COMM_INFORMATION(_d,_p,_b,_pr) { (_d)->DriverType=hdtCOMM; (_d)->DriverInformation.COMMDriverInformation.COMPortNumber=_p; (_d)->DriverInformation.COMMDriverInformation.BaudRate=_b; (_d)->DriverInformation.COMMDriverInformation.Protocol=_pr; }
+#define VENDOR_BAUD_RATE 115200
+typedef struct
+{
+   unsigned int ReconfigureCommand;
+   void *ReconfigureData;
+} HCI_Driver_Reconfigure_Data_t;
+
+#define HCI_COMM_DRIVER_RECONFIGURE_DATA_COMMAND_CHANGE_PARAMETERS 1
+typedef struct
+{
+   unsigned long ReconfigureFlags;
+   unsigned long BaudRate;
+   HCI_COMM_Protocol_t Protocol;
+} HCI_COMMReconfigureInformation_t;
+
+#define HCI_COMM_RECONFIGURE_INFORMATION_RECONFIGURE_FLAGS_CHANGE_BAUDRATE 1
+typedef unsigned long (*BTPS_GetTickCountCallback_t)(void);
+typedef void (*BTPS_MessageOutputCallback_t)(char);
+typedef struct
+{
+   BTPS_GetTickCountCallback_t GetTickCountCallback;
+   BTPS_MessageOutputCallback_t MessageOutputCallback;
+} BTPS_Initialization_t;
+
+/* HCI */
+#define HCI_SUPPORTED_COMMAND_WRITE_DEFAULT_LINK_POLICY_BIT_NUMBER 1
+#define HCI_LINK_POLICY_SETTINGS_ENABLE_MASTER_SLAVE_SWITCH 1
+#define HCI_LINK_POLICY_SETTINGS_ENABLE_SNIFF_MODE 4
+#define HCI_SUPPORTED_COMMAND_SNIFF_SUBRATING_BIT_NUMBER 140
+#define HCI_LINK_TYPE_SCO_CONNECTION 0
+#define HCI_LINK_TYPE_ACL_CONNECTION 1
+#define HCI_LINK_TYPE_ESCO_CONNECTION 2
+#define HCI_AIR_MODE_TRANSPARENT_DATA 3
+#define HCI_CURRENT_MODE_ACTIVE_MODE 0
+#define HCI_CURRENT_MODE_HOLD_MODE 1
+#define HCI_CURRENT_MODE_SNIFF_MODE 2
+#define HCI_CURRENT_MODE_PARK_MODE 3
+#define HCI_PACKET_ACL_TYPE_DM1 0x0008
+#define HCI_PACKET_ACL_TYPE_DH1 0x0010
+#define HCI_PACKET_ACL_TYPE_DM3 0x0400
+#define HCI_PACKET_ACL_TYPE_DH3 0x0800
+#define HCI_PACKET_ACL_TYPE_DM5 0x4000
+#define HCI_PACKET_ACL_TYPE_DH5 0x8000
+#define HCI_ROLE_SWITCH_LOCAL_MASTER_ACCEPT_ROLE_SWITCH 1
+#define HCI_ERROR_CODE_NO_ERROR 0
+#define HCI_COMMAND_PACKET 1
+#define HCI_ACL_PACKET 2
+#define HCI_SCO_PACKET 3
+#define HCI_EVENT_PACKET 4
+typedef enum
+{
+   ptHCICommandPacket=1,
+   ptHCIACLDataPacket,
+   ptHCISCODataPacket,
+   ptHCIEventPacket
+} HCI_PacketType_t;
+
+typedef struct
+{
+   Byte_t Status;
+   Word_t Connection_Handle;
+   BD_ADDR_t BD_ADDR;
+   Byte_t Link_Type;
+   Byte_t Encryption_Mode;
+} HCI_Connection_Complete_Event_Data_t;
+
+typedef struct
+{
+   Byte_t Status;
+   Word_t Connection_Handle;
+   Byte_t Reason;
+} HCI_Disconnection_Complete_Event_Data_t;
+
+typedef struct
+{
+   Byte_t Status;
+   Word_t Connection_Handle;
+   Word_t Clock_Offset;
+} HCI_Read_Clock_Offset_Complete_Event_Data_t;
+
+typedef struct
+{
+   Byte_t Status;
+   Word_t Connection_Handle;
+   LMP_Features_t LMP_Features;
+} HCI_Read_Remote_Supported_Features_Complete_Event_Data_t;
+
+typedef struct
+{
+   BD_ADDR_t BD_ADDR;
+   Byte_t Page_Scan_Repetition_Mode;
+} HCI_Page_Scan_Repetition_Mode_Change_Event_Data_t;
+
+typedef struct
+{
+   Byte_t Status;
+   Word_t Connection_Handle;
+   Byte_t Current_Mode;
+   Word_t Interval;
+} HCI_Mode_Change_Event_Data_t;
+
+typedef struct
+{
+   Byte_t Status;
+   Word_t Connection_Handle;
+   Word_t Maximum_Transmit_Latency;
+   Word_t Maximum_Receive_Latency;
+   Word_t Minimum_Remote_Timeout;
+   Word_t Minimum_Local_Timeout;
+} HCI_Sniff_Subrating_Event_Data_t;
+
+typedef struct
+{
+   Byte_t Status;
+   Word_t Connection_Handle;
+   BD_ADDR_t BD_ADDR;
+   Byte_t Link_Type;
+   Byte_t Transmission_Interval;
+   Byte_t Retransmission_Window;
+   Word_t Rx_Packet_Length;
+   Word_t Tx_Packet_Length;
+   Byte_t Air_Mode;
+} HCI_Synchronous_Connection_Complete_Event_Data_t;
+
+typedef enum
+{
+   etConnection_Complete_Event,
+   etDisconnection_Complete_Event,
+   etRead_Clock_Offset_Complete_Event,
+   etRead_Remote_Supported_Features_Complete_Event,
+   etPage_Scan_Repetition_Mode_Change_Event,
+   etMode_Change_Event,
+   etSniff_Subrating_Event,
+   etSynchronous_Connection_Complete_Event
+} HCI_Event_Type_t;
+
+typedef struct
+{
+   HCI_Event_Type_t Event_Data_Type;
+   Word_t Event_Data_Size;
+   union
+   {
+      HCI_Connection_Complete_Event_Data_t *HCI_Connection_Complete_Event_Data;
+      HCI_Disconnection_Complete_Event_Data_t *HCI_Disconnection_Complete_Event_Data;
+      HCI_Read_Clock_Offset_Complete_Event_Data_t *HCI_Read_Clock_Offset_Complete_Event_Data;
+      HCI_Read_Remote_Supported_Features_Complete_Event_Data_t *HCI_Read_Remote_Supported_Features_Complete_Event_Data;
+      HCI_Page_Scan_Repetition_Mode_Change_Event_Data_t *HCI_Page_Scan_Repetition_Mode_Change_Event_Data;
+      HCI_Mode_Change_Event_Data_t *HCI_Mode_Change_Event_Data;
+      HCI_Sniff_Subrating_Event_Data_t *HCI_Sniff_Subrating_Event_Data;
+      HCI_Synchronous_Connection_Complete_Event_Data_t *HCI_Synchronous_Connection_Complete_Event_Data;
+      void *Void;
+   } Event_Data;
+} HCI_Event_Data_t;
+typedef void (*HCI_Event_Callback_t)(unsigned int, HCI_Event_Data_t *, unsigned long);
+typedef struct
+{
+   Byte_t HCIPacketType;
+   unsigned int HCIPacketLength;
+   Byte_t HCIPacketData[1];
+} HCI_Packet_t;
+
+/* L2CA */
+typedef enum
+{
+   cqAllowRoleSwitch
+} L2CA_Link_Connect_Request_Config_t;
+
+typedef enum
+{
+   csMaintainCurrentRole
+} L2CA_Link_Connect_Response_Config_t;
+
+typedef struct
+{
+   L2CA_Link_Connect_Request_Config_t L2CA_Link_Connect_Request_Config;
+   L2CA_Link_Connect_Response_Config_t L2CA_Link_Connect_Response_Config;
+} L2CA_Link_Connect_Params_t;
+
+/* BSC */
+#define BSC_FEATURE_BLUETOOTH_LOW_ENERGY 1
+#define BSC_FEATURE_WIDE_BAND_SPEECH 2
+
+/* GAP */
+typedef enum
+{
+   dmNonDiscoverableMode,
+   dmLimitedDiscoverableMode,
+   dmGeneralDiscoverableMode
+} GAP_Discoverability_Mode_t;
+
+typedef enum
+{
+   cmNonConnectableMode,
+   cmConnectableMode
+} GAP_Connectability_Mode_t;
+
+typedef enum
+{
+   pmNonPairableMode,
+   pmPairableMode,
+   pmPairableMode_EnableSecureSimplePairing
+} GAP_Pairability_Mode_t;
+
+typedef enum
+{
+   btDedicated,
+   btGeneral
+} GAP_Bonding_Type_t;
+
+typedef enum
+{
+   icDisplayOnly,
+   icDisplayYesNo,
+   icKeyboardOnly,
+   icNoInputNoOutput
+} GAP_IO_Capability_t;
+
+typedef enum
+{
+   itGeneralInquiry,
+   itLimitedInquiry
+} GAP_Inquiry_Type_t;
+
+typedef struct
+{
+   GAP_IO_Capability_t IO_Capability;
+   Boolean_t OOB_Data_Present;
+   Boolean_t MITM_Protection_Required;
+   int Bonding_Type;
+} GAP_IO_Capabilities_t;
+
+typedef enum
+{
+   atLinkKeyRequest,
+   atPINCodeRequest,
+   atAuthenticationStatus,
+   atLinkKeyCreation,
+   atIOCapabilityRequest,
+   atIOCapabilityResponse,
+   atUserConfirmationRequest,
+   atPasskeyRequest,
+   atRemoteOutOfBandDataRequest,
+   atPasskeyNotification,
+   atKeypressNotification,
+   atLinkKey,
+   atPINCode,
+   atIOCapabilities,
+   atUserConfirmation,
+   atPassKey,
+   atOutOfBandData
+} GAP_Authentication_Event_Type_t;
+
+typedef GAP_Authentication_Event_Type_t GAP_Authentication_Type_t;
+typedef struct
+{
+   Link_Key_t Link_Key;
+   int Key_Type;
+} GAP_Link_Key_Info_t;
+
+typedef struct
+{
+   GAP_Authentication_Event_Type_t GAP_Authentication_Event_Type;
+   BD_ADDR_t Remote_Device;
+   union
+   {
+      Byte_t Authentication_Status;
+      GAP_Link_Key_Info_t Link_Key_Info;
+      GAP_IO_Capabilities_t IO_Capabilities;
+      DWord_t Numeric_Value;
+      int Keypress_Type;
+   } Authentication_Event_Data;
+} GAP_Authentication_Event_Data_t;
+
+typedef struct
+{
+   GAP_Authentication_Type_t GAP_Authentication_Type;
+   Byte_t Authentication_Data_Length;
+   union
+   {
+      PIN_Code_t PIN_Code;
+      Link_Key_t Link_Key;
+      Boolean_t Confirmation;
+      DWord_t Passkey;
+      GAP_IO_Capabilities_t IO_Capabilities;
+   } Authentication_Data;
+} GAP_Authentication_Information_t;
+
+typedef struct
+{
+   BD_ADDR_t BD_ADDR;
+   Byte_t Page_Scan_Repetition_Mode;
+   Byte_t Page_Scan_Period_Mode;
+   Byte_t Page_Scan_Mode;
+   Class_of_Device_t Class_of_Device;
+   Word_t Clock_Offset;
+} GAP_Inquiry_Data_t;
+
+typedef struct
+{
+   Word_t Number_Devices;
+   GAP_Inquiry_Data_t *GAP_Inquiry_Data;
+} GAP_Inquiry_Event_Data_t;
+
+typedef struct
+{
+   BD_ADDR_t BD_ADDR;
+   Byte_t Page_Scan_Repetition_Mode;
+   Byte_t Page_Scan_Period_Mode;
+   Class_of_Device_t Class_of_Device;
+   Word_t Clock_Offset;
+   SByte_t RSSI;
+} GAP_Inquiry_Entry_Event_Data_t;
+
+typedef struct
+{
+   Byte_t Remote_Name_Status;
+   BD_ADDR_t Remote_Device;
+   char *Remote_Name;
+} GAP_Remote_Name_Event_Data_t;
+
+typedef enum
+{
+   etInquiry_Result,
+   etInquiry_Entry_Result,
+   etAuthentication,
+   etRemote_Name_Result,
+   etEncryption_Change_Result
+} GAP_Event_Type_t;
+
+typedef struct
+{
+   GAP_Event_Type_t Event_Data_Type;
+   Word_t Event_Data_Size;
+   union
+   {
+      GAP_Inquiry_Event_Data_t *GAP_Inquiry_Event_Data;
+      GAP_Inquiry_Entry_Event_Data_t *GAP_Inquiry_Entry_Event_Data;
+      GAP_Authentication_Event_Data_t *GAP_Authentication_Event_Data;
+      GAP_Remote_Name_Event_Data_t *GAP_Remote_Name_Event_Data;
+   } Event_Data;
+} GAP_Event_Data_t;
+
+typedef void (*GAP_Event_Callback_t)(unsigned int, GAP_Event_Data_t *, unsigned long);
+
+/* GAP LE */
+typedef enum
+{
+   latPublic,
+   latRandom
+} GAP_LE_Address_Type_t;
+
+typedef enum
+{
+   lpmNonPairableMode,
+   lpmPairableMode
+} GAP_LE_Pairability_Mode_t;
+
+typedef enum
+{
+   lcmNonConnectable,
+   lcmConnectable
+} GAP_LE_Connectability_Mode_t;
+
+typedef enum
+{
+   fpNoFilter,
+   fpWhiteList
+} GAP_LE_Filter_Policy_t;
+
+typedef enum
+{
+   stPassive,
+   stActive
+} GAP_LE_Scan_Type_t;
+
+typedef enum
+{
+   rtConnectableUndirected,
+   rtConnectableDirected,
+   rtScanableUndirected,
+   rtNonConnectableUndirected,
+   rtScanResponse
+} GAP_LE_Advertising_Report_Type_t;
+
+#define HCI_LE_ADVERTISING_CHANNEL_MAP_DEFAULT 7
+#define HCI_LE_ADVERTISING_CHANNEL_MAP_ENABLE_CHANNEL_37 1
+#define HCI_LE_ADVERTISING_CHANNEL_MAP_ENABLE_CHANNEL_38 2
+#define HCI_LE_ADVERTISING_CHANNEL_MAP_ENABLE_CHANNEL_39 4
+typedef struct
+{
+   Word_t Advertising_Interval_Min;
+   Word_t Advertising_Interval_Max;
+   Byte_t Advertising_Channel_Map;
+   GAP_LE_Filter_Policy_t Scan_Request_Filter;
+   GAP_LE_Filter_Policy_t Connect_Request_Filter;
+} GAP_LE_Advertising_Parameters_t;
+
+typedef struct
+{
+   GAP_LE_Connectability_Mode_t Connectability_Mode;
+   GAP_LE_Address_Type_t Own_Address_Type;
+   GAP_LE_Address_Type_t Direct_Address_Type;
+   BD_ADDR_t Direct_Address;
+} GAP_LE_Connectability_Parameters_t;
+
+typedef struct
+{
+   Byte_t Advertising_Data[31];
+} Advertising_Data_t;
+
+typedef struct
+{
+   Byte_t Scan_Response_Data[31];
+} Scan_Response_Data_t;
+
+typedef struct
+{
+   Word_t Connection_Interval_Min;
+   Word_t Connection_Interval_Max;
+   Word_t Slave_Latency;
+   Word_t Supervision_Timeout;
+   Word_t Minimum_Connection_Length;
+   Word_t Maximum_Connection_Length;
+} GAP_LE_Connection_Parameters_t;
+
+typedef struct
+{
+   Byte_t AD_Type;
+   Byte_t AD_Data_Length;
+   Byte_t *AD_Data_Buffer;
+} GAP_LE_Advertising_Data_Entry_t;
+
+typedef struct
+{
+   unsigned int Number_Data_Entries;
+   GAP_LE_Advertising_Data_Entry_t *Data_Entries;
+} GAP_LE_Advertising_Data_t;
+
+typedef struct
+{
+   GAP_LE_Advertising_Report_Type_t Advertising_Report_Type;
+   GAP_LE_Address_Type_t Address_Type;
+   BD_ADDR_t BD_ADDR;
+   SByte_t RSSI;
+   Byte_t Raw_Report_Length;
+   Byte_t *Raw_Report_Data;
+   GAP_LE_Advertising_Data_t Advertising_Data;
+} GAP_LE_Advertising_Report_Data_t;
+
+typedef struct
+{
+   unsigned int Number_Device_Entries;
+   GAP_LE_Advertising_Report_Data_t *Advertising_Data;
+} GAP_LE_Advertising_Report_Event_Data_t;
+
+typedef struct
+{
+   Byte_t Status;
+   Boolean_t Master;
+   GAP_LE_Address_Type_t Peer_Address_Type;
+   BD_ADDR_t Peer_Address;
+   Word_t Connection_Interval;
+   Word_t Slave_Latency;
+   Word_t Supervision_Timeout;
+} GAP_LE_Connection_Complete_Event_Data_t;
+
+typedef struct
+{
+   Byte_t Status;
+   BD_ADDR_t BD_ADDR;
+   Byte_t Reason;
+} GAP_LE_Disconnection_Complete_Event_Data_t;
+
+typedef struct
+{
+   Byte_t Status;
+   BD_ADDR_t BD_ADDR;
+   Word_t Connection_Interval;
+   Word_t Slave_Latency;
+   Word_t Supervision_Timeout;
+} GAP_LE_Connection_Parameter_Updated_Event_Data_t;
+
+typedef struct
+{
+   BD_ADDR_t BD_ADDR;
+   Word_t Connection_Interval_Min;
+   Word_t Connection_Interval_Max;
+   Word_t Slave_Latency;
+   Word_t Supervision_Timeout;
+} GAP_LE_Connection_Parameter_Update_Request_Event_Data_t;
+
+typedef struct
+{
+   BD_ADDR_t BD_ADDR;
+   Boolean_t Accepted;
+} GAP_LE_Connection_Parameter_Update_Response_Event_Data_t;
+
+typedef enum
+{
+   etLE_Remote_Features_Result,
+   etLE_Advertising_Report,
+   etLE_Connection_Complete,
+   etLE_Disconnection_Complete,
+   etLE_Connection_Parameter_Update_Request,
+   etLE_Connection_Parameter_Update_Response,
+   etLE_Connection_Parameter_Updated,
+   etLE_Encryption_Change,
+   etLE_Authentication
+} GAP_LE_Event_Type_t;
+
+typedef struct
+{
+   GAP_LE_Event_Type_t Event_Data_Type;
+   Word_t Event_Data_Size;
+   union
+   {
+      GAP_LE_Advertising_Report_Event_Data_t *GAP_LE_Advertising_Report_Event_Data;
+      GAP_LE_Connection_Complete_Event_Data_t *GAP_LE_Connection_Complete_Event_Data;
+      GAP_LE_Disconnection_Complete_Event_Data_t *GAP_LE_Disconnection_Complete_Event_Data;
+      GAP_LE_Connection_Parameter_Updated_Event_Data_t *GAP_LE_Connection_Parameter_Updated_Event_Data;
+      GAP_LE_Connection_Parameter_Update_Request_Event_Data_t *GAP_LE_Connection_Parameter_Update_Request_Event_Data;
+      GAP_LE_Connection_Parameter_Update_Response_Event_Data_t *GAP_LE_Connection_Parameter_Update_Response_Event_Data;
+   } Event_Data;
+} GAP_LE_Event_Data_t;
+
+typedef void (*GAP_LE_Event_Callback_t)(unsigned int, GAP_LE_Event_Data_t *, unsigned long);
+#define HCI_LE_ADVERTISING_REPORT_DATA_MAX_DATA_ENTRIES 31
+#define HCI_LE_ADVERTISING_DATA_TYPE_FLAGS 0x01
+#define HCI_LE_ADVERTISING_DATA_TYPE_16_BIT_SERVICE_UUID_PARTIAL 0x02
+#define HCI_LE_ADVERTISING_DATA_TYPE_16_BIT_SERVICE_UUID_COMPLETE 0x03
+#define HCI_LE_ADVERTISING_DATA_TYPE_128_BIT_SERVICE_UUID_PARTIAL 0x06
+#define HCI_LE_ADVERTISING_DATA_TYPE_128_BIT_SERVICE_UUID_COMPLETE 0x07
+#define HCI_LE_ADVERTISING_DATA_TYPE_LOCAL_NAME_SHORTENED 0x08
+#define HCI_LE_ADVERTISING_DATA_TYPE_LOCAL_NAME_COMPLETE 0x09
+#define HCI_LE_ADVERTISING_DATA_TYPE_TX_POWER_LEVEL 0x0A
+#define HCI_LE_ADVERTISING_FLAGS_GENERAL_DISCOVERABLE_MODE_FLAGS_BIT_MASK 0x02
+#define HCI_LE_ADVERTISING_FLAGS_BR_EDR_NOT_SUPPORTED_FLAGS_BIT_MASK 0x04
+#define HCI_LE_ADVERTISING_FLAGS_SIMULTANEOUS_LE_BR_EDR_TO_SAME_DEVICE_CONTROLLER_BIT_MASK 0x08
+#define HCI_LE_ADVERTISING_FLAGS_SIMULTANEOUS_LE_BR_EDR_TO_SAME_DEVICE_HOST_BIT_MASK 0x10
+
+/* GATT */
+#define GATT_INITIALIZATION_FLAGS_SUPPORT_LE 1
+#define GATT_SERVICE_FLAGS_LE_SERVICE 1
+#define GATT_ATTRIBUTE_FLAGS_READABLE 1
+#define GATT_ATTRIBUTE_FLAGS_WRITABLE 2
+#define GATT_ATTRIBUTE_FLAGS_READABLE_WRITABLE 3
+#define GATT_ATTRIBUTE_FLAGS_HIDDEN 4
+#define GATT_CHARACTERISTIC_PROPERTIES_READ 0x02
+#define GATT_CHARACTERISTIC_PROPERTIES_WRITE_WITHOUT_RESPONSE 0x04
+#define GATT_CHARACTERISTIC_PROPERTIES_WRITE 0x08
+#define GATT_CHARACTERISTIC_PROPERTIES_NOTIFY 0x10
+#define GATT_CHARACTERISTIC_PROPERTIES_INDICATE 0x20
+#define GATT_CLIENT_CONFIGURATION_CHARACTERISTIC_NOTIFY_ENABLE 1
+#define GATT_CLIENT_CONFIGURATION_CHARACTERISTIC_INDICATE_ENABLE 2
+#define GATT_CONFIRMATION_STATUS_SUCCESS 0x00
+#define GATT_CONFIRMATION_STATUS_TIMEOUT 0x01
+#define ATT_PROTOCOL_ERROR_CODE_READ_NOT_PERMITTED 0x02
+#define ATT_PROTOCOL_ERROR_CODE_WRITE_NOT_PERMITTED 0x03
+#define ATT_PROTOCOL_ERROR_CODE_INVALID_OFFSET 0x07
+#define ATT_PROTOCOL_ERROR_CODE_INVALID_ATTRIBUTE_VALUE_LENGTH 0x0D
+#define ATT_PROTOCOL_ERROR_CODE_PREPARE_QUEUE_FULL 0x09
+#define ATT_PROTOCOL_ERROR_CODE_INSUFFICIENT_RESOURCES 0x11
+#define ATT_PROTOCOL_ERROR_CODE_ATTRIBUTE_NOT_LONG 0x0B
+#define ATT_PROTOCOL_ERROR_CODE_UNLIKELY_ERROR 0x0E
+#define ATT_PROTOCOL_ERROR_CODE_ATTRIBUTE_NOT_FOUND 0x0A
+#define ATT_PROTOCOL_ERROR_CODE_REQUEST_NOT_SUPPORTED 0x06
+#define ATT_PROTOCOL_ERROR_CODE_INVALID_HANDLE 0x01
+#define ATT_PROTOCOL_MTU_MINIMUM_LE 23
+typedef enum
+{
+   aetPrimaryService16,
+   aetPrimaryService128,
+   aetSecondaryService16,
+   aetSecondaryService128,
+   aetIncludeDefinition,
+   aetCharacteristicDeclaration16,
+   aetCharacteristicDeclaration128,
+   aetCharacteristicValue16,
+   aetCharacteristicValue128,
+   aetCharacteristicDescriptor16,
+   aetCharacteristicDescriptor128
+} GATT_Service_Attribute_Entry_Type_t;
+
+typedef struct
+{
+   Byte_t Attribute_Flags;
+   GATT_Service_Attribute_Entry_Type_t Attribute_Entry_Type;
+   void *Attribute_Value;
+} GATT_Service_Attribute_Entry_t;
+
+typedef struct
+{
+   UUID_16_t Service_UUID;
+} GATT_Primary_Service_16_Entry_t;
+
+typedef struct
+{
+   UUID_128_t Service_UUID;
+} GATT_Primary_Service_128_Entry_t;
+
+typedef struct
+{
+   Byte_t Properties;
+   UUID_16_t Characteristic_Value_UUID;
+} GATT_Characteristic_Declaration_16_Entry_t;
+
+typedef struct
+{
+   Byte_t Properties;
+   UUID_128_t Characteristic_Value_UUID;
+} GATT_Characteristic_Declaration_128_Entry_t;
+
+typedef struct
+{
+   UUID_16_t Characteristic_Value_UUID;
+   unsigned int Characteristic_Value_Length;
+   Byte_t *Characteristic_Value;
+} GATT_Characteristic_Value_16_Entry_t;
+
+typedef struct
+{
+   UUID_128_t Characteristic_Value_UUID;
+   unsigned int Characteristic_Value_Length;
+   Byte_t *Characteristic_Value;
+} GATT_Characteristic_Value_128_Entry_t;
+
+typedef struct
+{
+   UUID_16_t Characteristic_Descriptor_UUID;
+   unsigned int Characteristic_Descriptor_Length;
+   Byte_t *Characteristic_Descriptor;
+} GATT_Characteristic_Descriptor_16_Entry_t;
+
+typedef struct
+{
+   UUID_128_t Characteristic_Descriptor_UUID;
+   unsigned int Characteristic_Descriptor_Length;
+   Byte_t *Characteristic_Descriptor;
+} GATT_Characteristic_Descriptor_128_Entry_t;
+
+typedef struct
+{
+   Word_t Starting_Handle;
+   Word_t Ending_Handle;
+} GATT_Attribute_Handle_Group_t;
+
+typedef enum
+{
+   gctLE,
+   gctBR_EDR
+} GATT_Connection_Type_t;
+
+typedef enum
+{
+   etGATT_Connection_Device_Connection,
+   etGATT_Connection_Device_Disconnection,
+   etGATT_Connection_Device_Buffer_Empty,
+   etGATT_Connection_Server_Notification,
+   etGATT_Connection_Server_Indication,
+   etGATT_Connection_Device_Connection_MTU_Update
+} GATT_Connection_Event_Type_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   GATT_Connection_Type_t ConnectionType;
+   BD_ADDR_t RemoteDevice;
+   Word_t MTU;
+} GATT_Device_Connection_Data_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   GATT_Connection_Type_t ConnectionType;
+   BD_ADDR_t RemoteDevice;
+} GATT_Device_Disconnection_Data_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   GATT_Connection_Type_t ConnectionType;
+   BD_ADDR_t RemoteDevice;
+   Word_t MTU;
+} GATT_Device_Connection_MTU_Update_Data_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   GATT_Connection_Type_t ConnectionType;
+   BD_ADDR_t RemoteDevice;
+} GATT_Device_Buffer_Empty_Data_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   GATT_Connection_Type_t ConnectionType;
+   BD_ADDR_t RemoteDevice;
+   Word_t AttributeHandle;
+   Word_t AttributeValueLength;
+   Byte_t *AttributeValue;
+} GATT_Server_Notification_Data_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   unsigned int TransactionID;
+   GATT_Connection_Type_t ConnectionType;
+   BD_ADDR_t RemoteDevice;
+   Word_t AttributeHandle;
+   Word_t AttributeValueLength;
+   Byte_t *AttributeValue;
+} GATT_Server_Indication_Data_t;
+
+typedef struct
+{
+   GATT_Connection_Event_Type_t Event_Data_Type;
+   Word_t Event_Data_Size;
+   union
+   {
+      GATT_Device_Connection_Data_t *GATT_Device_Connection_Data;
+      GATT_Device_Disconnection_Data_t *GATT_Device_Disconnection_Data;
+      GATT_Device_Connection_MTU_Update_Data_t *GATT_Device_Connection_MTU_Update_Data;
+      GATT_Device_Buffer_Empty_Data_t *GATT_Device_Buffer_Empty_Data;
+      GATT_Server_Notification_Data_t *GATT_Server_Notification_Data;
+      GATT_Server_Indication_Data_t *GATT_Server_Indication_Data;
+   } Event_Data;
+} GATT_Connection_Event_Data_t;
+
+typedef enum
+{
+   etGATT_Server_Device_Connection,
+   etGATT_Server_Device_Disconnection,
+   etGATT_Server_Read_Request,
+   etGATT_Server_Write_Request,
+   etGATT_Server_Signed_Write_Request,
+   etGATT_Server_Execute_Write_Request,
+   etGATT_Server_Execute_Write_Confirmation,
+   etGATT_Server_Confirmation_Response,
+   etGATT_Server_Prepare_Write_Request
+} GATT_Server_Event_Type_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   unsigned int TransactionID;
+   GATT_Connection_Type_t ConnectionType;
+   BD_ADDR_t RemoteDevice;
+   Word_t ServiceID;
+   Word_t AttributeOffset;
+   Word_t AttributeValueOffset;
+   Boolean_t AttributeValueLengthRequest;
+} GATT_Read_Request_Data_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   unsigned int TransactionID;
+   GATT_Connection_Type_t ConnectionType;
+   BD_ADDR_t RemoteDevice;
+   Word_t ServiceID;
+   Word_t AttributeOffset;
+   Word_t AttributeValueLength;
+   Word_t AttributeValueOffset;
+   Byte_t *AttributeValue;
+   Boolean_t DelayWrite;
+} GATT_Write_Request_Data_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   unsigned int TransactionID;
+   GATT_Connection_Type_t ConnectionType;
+   BD_ADDR_t RemoteDevice;
+   Word_t ServiceID;
+   Word_t AttributeOffset;
+   Word_t AttributeValueLength;
+   Word_t AttributeValueOffset;
+   Byte_t *AttributeValue;
+} GATT_Prepare_Write_Request_Data_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   unsigned int TransactionID;
+   GATT_Connection_Type_t ConnectionType;
+   BD_ADDR_t RemoteDevice;
+   Boolean_t CancelWrite;
+} GATT_Execute_Write_Request_Data_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   unsigned int TransactionID;
+   GATT_Connection_Type_t ConnectionType;
+   BD_ADDR_t RemoteDevice;
+   Byte_t Status;
+} GATT_Execute_Write_Confirmation_Data_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   unsigned int TransactionID;
+   GATT_Connection_Type_t ConnectionType;
+   BD_ADDR_t RemoteDevice;
+   Byte_t Status;
+} GATT_Confirmation_Data_t;
+
+typedef struct
+{
+   GATT_Server_Event_Type_t Event_Data_Type;
+   Word_t Event_Data_Size;
+   union
+   {
+      GATT_Device_Connection_Data_t *GATT_Device_Connection_Data;
+      GATT_Device_Disconnection_Data_t *GATT_Device_Disconnection_Data;
+      GATT_Read_Request_Data_t *GATT_Read_Request_Data;
+      GATT_Write_Request_Data_t *GATT_Write_Request_Data;
+      GATT_Prepare_Write_Request_Data_t *GATT_Prepare_Write_Request_Data;
+      GATT_Execute_Write_Request_Data_t *GATT_Execute_Write_Request_Data;
+      GATT_Execute_Write_Confirmation_Data_t *GATT_Execute_Write_Confirmation_Data;
+      GATT_Confirmation_Data_t *GATT_Confirmation_Data;
+   } Event_Data;
+} GATT_Server_Event_Data_t;
+
+typedef void (*GATT_Connection_Event_Callback_t)(unsigned int, GATT_Connection_Event_Data_t *, unsigned long);
+typedef void (*GATT_Server_Event_Callback_t)(unsigned int, GATT_Server_Event_Data_t *, unsigned long);
+/* GATT client */
+typedef enum
+{
+   guUUID_16,
+   guUUID_128
+} GATT_UUID_Type_t;
+
+typedef struct
+{
+   GATT_UUID_Type_t UUID_Type;
+   union
+   {
+      UUID_16_t UUID_16;
+      UUID_128_t UUID_128;
+   } UUID;
+} GATT_UUID_t;
+
+typedef struct
+{
+   Word_t Characteristic_Descriptor_Handle;
+   GATT_UUID_t Characteristic_Descriptor_UUID;
+} GATT_Characteristic_Descriptor_Information_t;
+
+typedef struct
+{
+   Word_t Characteristic_Handle;
+   GATT_UUID_t Characteristic_UUID;
+   Byte_t Characteristic_Properties;
+   unsigned int NumberOfDescriptors;
+   GATT_Characteristic_Descriptor_Information_t *DescriptorList;
+} GATT_Characteristic_Information_t;
+
+typedef struct
+{
+   Word_t Service_Handle;
+   Word_t End_Group_Handle;
+   GATT_UUID_t UUID;
+} GATT_Service_Information_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   GATT_Service_Information_t ServiceInformation;
+   unsigned int NumberOfIncludedService;
+   void *IncludedServiceList;
+   unsigned int NumberOfCharacteristics;
+   GATT_Characteristic_Information_t *CharacteristicInformationList;
+} GATT_Service_Discovery_Indication_Data_t;
+
+#define GATT_SERVICE_DISCOVERY_STATUS_SUCCESS 0x00
+#define GATT_SERVICE_DISCOVERY_STATUS_RESPONSE_ERROR 0x01
+#define GATT_SERVICE_DISCOVERY_STATUS_RESPONSE_TIMEOUT 0x02
+#define GATT_SERVICE_DISCOVERY_STATUS_UNKNOWN_ERROR 0x03
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   Byte_t Status;
+} GATT_Service_Discovery_Complete_Data_t;
+
+typedef enum
+{
+   etGATT_Service_Discovery_Indication,
+   etGATT_Service_Discovery_Complete
+} GATT_Service_Discovery_Event_Type_t;
+
+typedef struct
+{
+   GATT_Service_Discovery_Event_Type_t Event_Data_Type;
+   Word_t Event_Data_Size;
+   union
+   {
+      GATT_Service_Discovery_Indication_Data_t *GATT_Service_Discovery_Indication_Data;
+      GATT_Service_Discovery_Complete_Data_t *GATT_Service_Discovery_Complete_Data;
+   } Event_Data;
+} GATT_Service_Discovery_Event_Data_t;
+
+typedef void (*GATT_Service_Discovery_Event_Callback_t)(unsigned int, GATT_Service_Discovery_Event_Data_t *, unsigned long);
+typedef enum
+{
+   etGATT_Client_Error_Response,
+   etGATT_Client_Read_Response,
+   etGATT_Client_Read_By_UUID_Response,
+   etGATT_Client_Write_Response,
+   etGATT_Client_Exchange_MTU_Response
+} GATT_Client_Event_Type_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   unsigned int TransactionID;
+   Word_t AttributeHandle;
+   Word_t AttributeValueLength;
+   Byte_t *AttributeValue;
+} GATT_Read_Response_Data_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   unsigned int TransactionID;
+   int ErrorType;
+   Byte_t AttributeProtocolErrorCode;
+   Word_t RequestOpCode;
+   Word_t RequestHandle;
+} GATT_Request_Error_Data_t;
+
+typedef struct
+{
+   Word_t AttributeHandle;
+   Word_t AttributeValueLength;
+   Byte_t *AttributeValue;
+} GATT_Read_By_UUID_Data_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   unsigned int TransactionID;
+   GATT_Connection_Type_t ConnectionType;
+   BD_ADDR_t RemoteDevice;
+   Byte_t NumberOfAttributes;
+   GATT_Read_By_UUID_Data_t *AttributeList;
+} GATT_Read_By_UUID_Response_Data_t;
+
+typedef struct
+{
+   unsigned int ConnectionID;
+   unsigned int TransactionID;
+   GATT_Connection_Type_t ConnectionType;
+   BD_ADDR_t RemoteDevice;
+} GATT_Write_Response_Data_t;
+
+typedef struct
+{
+   GATT_Client_Event_Type_t Event_Data_Type;
+   Word_t Event_Data_Size;
+   union
+   {
+      GATT_Read_Response_Data_t *GATT_Read_Response_Data;
+      GATT_Read_By_UUID_Response_Data_t *GATT_Read_By_UUID_Response_Data;
+      GATT_Write_Response_Data_t *GATT_Write_Response_Data;
+      GATT_Request_Error_Data_t *GATT_Request_Error_Data;
+   } Event_Data;
+} GATT_Client_Event_Data_t;
+
+typedef void (*GATT_Client_Event_Callback_t)(unsigned int, GATT_Client_Event_Data_t *, unsigned long);
+
+#define GAP_PASSKEY_MAXIMUM_NUMBER_OF_DIGITS 6
+#define HCI_SUPPORTED_COMMAND_WRITE_DEFAULT_LINK_POLICY_BIT_NUMBER_X 0
+#define HCI_ERROR_CODE_CONNECTION_TIMEOUT 0x08
+#define ASSIGN_SDP_UUID_16(_x,_a,_b) do { (_x).UUID_Byte0=(_a); (_x).UUID_Byte1=(_b); } while(0)
+typedef enum
+{
+   deNIL,
+   deUnsignedInteger1Byte,
+   deUUID_16,
+   deSequence
+} SDP_Data_Element_Type_t;
+
+typedef struct
+{
+   SDP_Data_Element_Type_t SDP_Data_Element_Type;
+   union
+   {
+      UUID_16_t UUID_16;
+   } UUID_Value;
+} SDP_UUID_Entry_t;
+
+typedef struct
+{
+   Boolean_t Attribute_Range;
+   Word_t Start_Attribute_ID;
+   Word_t End_Attribute_ID;
+} SDP_Attribute_ID_List_Entry_t;
+
+typedef struct _tagSDP_Data_Element_t
+{
+   SDP_Data_Element_Type_t SDP_Data_Element_Type;
+   DWord_t SDP_Data_Element_Length;
+   union
+   {
+      Byte_t UnsignedInteger1Byte;
+      UUID_16_t UUID_16;
+      struct _tagSDP_Data_Element_t *SDP_Data_Element_Sequence;
+   } SDP_Data_Element;
+} SDP_Data_Element_t;
+
+typedef struct
+{
+   Word_t Attribute_ID;
+   SDP_Data_Element_t *SDP_Data_Element;
+} SDP_Service_Attribute_Value_Data_t;
+
+typedef struct
+{
+   unsigned int Number_Attribute_Values;
+   SDP_Service_Attribute_Value_Data_t *SDP_Service_Attribute_Value_Data;
+} SDP_Service_Attribute_Response_Data_t;
+
+typedef struct
+{
+   unsigned int Number_Service_Records;
+   SDP_Service_Attribute_Response_Data_t *SDP_Service_Attribute_Response_Data;
+} SDP_Service_Search_Attribute_Response_Data_t;
+
+typedef enum
+{
+   rdError,
+   rdServiceSearchAttributeResponse,
+   rdTimeout,
+   rdConnectionError
+} SDP_Response_Data_Type_t;
+
+typedef struct
+{
+   SDP_Response_Data_Type_t SDP_Response_Data_Type;
+   union
+   {
+      SDP_Service_Search_Attribute_Response_Data_t SDP_Service_Search_Attribute_Response_Data;
+   } SDP_Response_Data;
+} SDP_Response_Data_t;
+
+typedef void (*SDP_Response_Callback_t)(unsigned int, unsigned int, SDP_Response_Data_t *, unsigned long);
+
+   /* Bluetooth Stack Controller (BSC) API.                             */
+int BTPSAPI BSC_Initialize(HCI_DriverInformation_t *HCI_DriverInformation, unsigned long Flags);
+void BTPSAPI BSC_Shutdown(unsigned int BluetoothStackID);
+int BTPSAPI BSC_EnableFeature(unsigned int BluetoothStackID, unsigned long Feature);
+int BTPSAPI BSC_QueryActiveFeatures(unsigned int BluetoothStackID, unsigned long *ActiveFeatures);
+
+   /* Host Controller Interface (HCI) API.                              */
+int BTPSAPI HCI_Version_Supported(unsigned int BluetoothStackID, HCI_Version_t *HCI_Version);
+int BTPSAPI HCI_Command_Supported(unsigned int BluetoothStackID, unsigned int SupportedCommandBitNumber);
+int BTPSAPI HCI_Register_Event_Callback(unsigned int BluetoothStackID, HCI_Event_Callback_t HCI_EventCallback, unsigned long CallbackParameter);
+int BTPSAPI HCI_Un_Register_Callback(unsigned int BluetoothStackID, unsigned int CallbackID);
+int BTPSAPI HCI_Write_Default_Link_Policy_Settings(unsigned int BluetoothStackID, Word_t Link_Policy_Settings, Byte_t *StatusResult);
+int BTPSAPI HCI_Sniff_Mode(unsigned int BluetoothStackID, Word_t Connection_Handle, Word_t Sniff_Max_Interval, Word_t Sniff_Min_Interval, Word_t Sniff_Attempt, Word_t Sniff_Timeout, Byte_t *StatusResult);
+int BTPSAPI HCI_Exit_Sniff_Mode(unsigned int BluetoothStackID, Word_t Connection_Handle, Byte_t *StatusResult);
+int BTPSAPI HCI_Sniff_Subrating(unsigned int BluetoothStackID, Word_t Connection_Handle, Word_t Maximum_Latency, Word_t Minimum_Remote_Timeout, Word_t Minimum_Local_Timeout, Byte_t *StatusResult, Word_t *Connection_HandleResult);
+int BTPSAPI HCI_Read_Clock_Offset(unsigned int BluetoothStackID, Word_t Connection_Handle, Byte_t *StatusResult);
+int BTPSAPI HCI_Read_Remote_Supported_Features(unsigned int BluetoothStackID, Word_t Connection_Handle, Byte_t *StatusResult);
+int BTPSAPI HCI_Create_Connection(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, Word_t Packet_Type, Byte_t Page_Scan_Repetition_Mode, Byte_t Page_Scan_Mode, Word_t Clock_Offset, Byte_t Allow_Role_Switch, Byte_t *StatusResult);
+int BTPSAPI HCI_Delete_Stored_Link_Key(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, Byte_t Delete_All_Flag, Byte_t *StatusResult, Word_t *Num_Keys_DeletedResult);
+
+   /* Synchronous Connection Oriented (SCO) API.  The parameters are   */
+   /* the ones of the audio connections that HFRE sets up and accepts.  */
+int BTPSAPI SCO_Set_Synchronous_Parameters(unsigned int BluetoothStackID, Word_t Packet_Type, Word_t Max_Latency, Byte_t Retransmission_Effort);
+
+   /* Logical Link Control and Adaptation Protocol (L2CAP) API.         */
+int BTPSAPI L2CA_Connection_Parameter_Update_Request(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, Word_t IntervalMin, Word_t IntervalMax, Word_t SlaveLatency, Word_t TimeoutMultiplier);
+int BTPSAPI L2CA_Set_Link_Connection_Configuration(unsigned int BluetoothStackID, L2CA_Link_Connect_Params_t *L2CA_Link_Connect_Params);
+
+   /* Generic Access Profile (GAP) API.                                 */
+int BTPSAPI GAP_Set_Discoverability_Mode(unsigned int BluetoothStackID, GAP_Discoverability_Mode_t GAP_Discoverability_Mode, unsigned int Max_Discoverable_Time);
+int BTPSAPI GAP_Set_Connectability_Mode(unsigned int BluetoothStackID, GAP_Connectability_Mode_t GAP_Connectability_Mode);
+int BTPSAPI GAP_Set_Pairability_Mode(unsigned int BluetoothStackID, GAP_Pairability_Mode_t GAP_Pairability_Mode);
+int BTPSAPI GAP_Register_Remote_Authentication(unsigned int BluetoothStackID, GAP_Event_Callback_t GAP_Event_Callback, unsigned long CallbackParameter);
+int BTPSAPI GAP_Authentication_Response(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, GAP_Authentication_Information_t *GAP_Authentication_Information);
+int BTPSAPI GAP_Perform_Inquiry(unsigned int BluetoothStackID, GAP_Inquiry_Type_t GAP_Inquiry_Type, unsigned int MinimumPeriodLength, unsigned int MaximumPeriodLength, unsigned int InquiryLength, unsigned int MaximumResponses, GAP_Event_Callback_t GAP_Event_Callback, unsigned long CallbackParameter);
+int BTPSAPI GAP_Query_Remote_Device_Name(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, GAP_Event_Callback_t GAP_Event_Callback, unsigned long CallbackParameter);
+int BTPSAPI GAP_Initiate_Bonding(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, GAP_Bonding_Type_t GAP_Bonding_Type, GAP_Event_Callback_t GAP_Event_Callback, unsigned long CallbackParameter);
+int BTPSAPI GAP_End_Bonding(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR);
+int BTPSAPI GAP_Query_Local_BD_ADDR(unsigned int BluetoothStackID, BD_ADDR_t *BD_ADDR);
+int BTPSAPI GAP_Set_Local_Device_Name(unsigned int BluetoothStackID, char *Name);
+int BTPSAPI GAP_Query_Local_Device_Name(unsigned int BluetoothStackID, unsigned int NameBufferLength, char *NameBuffer);
+int BTPSAPI GAP_Set_Class_Of_Device(unsigned int BluetoothStackID, Class_of_Device_t Class_of_Device);
+int BTPSAPI GAP_Query_Class_Of_Device(unsigned int BluetoothStackID, Class_of_Device_t *Class_of_Device);
+int BTPSAPI GAP_Query_Connection_Handle(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, Word_t *Connection_Handle);
+int BTPSAPI GAP_LE_Set_Pairability_Mode(unsigned int BluetoothStackID, GAP_LE_Pairability_Mode_t PairableMode);
+int BTPSAPI GAP_LE_Register_Remote_Authentication(unsigned int BluetoothStackID, GAP_LE_Event_Callback_t GAP_LE_Event_Callback, unsigned long CallbackParameter);
+int BTPSAPI GAP_LE_Set_Advertising_Data(unsigned int BluetoothStackID, unsigned int Length, Advertising_Data_t *Advertising_Data);
+int BTPSAPI GAP_LE_Set_Scan_Response_Data(unsigned int BluetoothStackID, unsigned int Length, Scan_Response_Data_t *Scan_Response_Data);
+int BTPSAPI GAP_LE_Advertising_Enable(unsigned int BluetoothStackID, Boolean_t EnableScanResponse, GAP_LE_Advertising_Parameters_t *GAP_LE_Advertising_Parameters, GAP_LE_Connectability_Parameters_t *GAP_LE_Connectability_Parameters, GAP_LE_Event_Callback_t GAP_LE_Event_Callback, unsigned long CallbackParameter);
+int BTPSAPI GAP_LE_Advertising_Disable(unsigned int BluetoothStackID);
+int BTPSAPI GAP_LE_Perform_Scan(unsigned int BluetoothStackID, GAP_LE_Scan_Type_t ScanType, unsigned int ScanInterval, unsigned int ScanWindow, GAP_LE_Address_Type_t LocalAddressType, GAP_LE_Filter_Policy_t FilterPolicy, Boolean_t FilterDuplicates, GAP_LE_Event_Callback_t GAP_LE_Event_Callback, unsigned long CallbackParameter);
+int BTPSAPI GAP_LE_Cancel_Scan(unsigned int BluetoothStackID);
+
+   /* Service Discovery Protocol (SDP) API.                             */
+int BTPSAPI SDP_Service_Search_Attribute_Request(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, unsigned int NumberServiceUUID, SDP_UUID_Entry_t *SDP_UUID_Entry, unsigned int NumberAttributeListElements, SDP_Attribute_ID_List_Entry_t *AttributeIDList, SDP_Response_Callback_t SDP_Response_Callback, unsigned long CallbackParameter);
+int BTPSAPI SDP_Delete_Service_Record(unsigned int BluetoothStackID, DWord_t Service_Record_Handle);
+
+   /* Generic Attribute Profile (GATT) API.                             */
+int BTPSAPI GATT_Initialize(unsigned int BluetoothStackID, unsigned long Flags, GATT_Connection_Event_Callback_t ConnectionEventCallback, unsigned long CallbackParameter);
+int BTPSAPI GATT_Register_Service(unsigned int BluetoothStackID, Byte_t ServiceFlags, unsigned int NumberOfServiceAttributeEntries, GATT_Service_Attribute_Entry_t *ServiceTable, GATT_Attribute_Handle_Group_t *ServiceHandleGroupResult, GATT_Server_Event_Callback_t ServerEventCallback, unsigned long CallbackParameter);
+int BTPSAPI GATT_Read_Response(unsigned int BluetoothStackID, unsigned int TransactionID, unsigned int DataLength, Byte_t *Data);
+int BTPSAPI GATT_Write_Response(unsigned int BluetoothStackID, unsigned int TransactionID);
+int BTPSAPI GATT_Execute_Write_Response(unsigned int BluetoothStackID, unsigned int TransactionID);
+int BTPSAPI GATT_Error_Response(unsigned int BluetoothStackID, unsigned int TransactionID, Word_t AttributeOffset, Byte_t ErrorCode);
+int BTPSAPI GATT_Handle_Value_Indication(unsigned int BluetoothStackID, unsigned int ServiceID, unsigned int ConnectionID, Word_t AttributeOffset, Word_t AttributeValueLength, Byte_t *AttributeValue);
+int BTPSAPI GATT_Handle_Value_Notification(unsigned int BluetoothStackID, unsigned int ServiceID, unsigned int ConnectionID, Word_t AttributeOffset, Word_t AttributeValueLength, Byte_t *AttributeValue);
+int BTPSAPI GATT_Query_Connection_MTU(unsigned int BluetoothStackID, unsigned int ConnectionID, Word_t *MTU);
+int BTPSAPI GATT_Start_Service_Discovery(unsigned int BluetoothStackID, unsigned int ConnectionID, unsigned int NumberOfUUID, GATT_UUID_t *UUIDList, GATT_Service_Discovery_Event_Callback_t ServiceDiscoveryCallback, unsigned long CallbackParameter);
+int BTPSAPI GATT_Stop_Service_Discovery(unsigned int BluetoothStackID, unsigned int ConnectionID);
+int BTPSAPI GATT_Read_Using_Characteristic_UUID(unsigned int BluetoothStackID, unsigned int ConnectionID, GATT_UUID_t *AttributeUUID, Word_t StartingHandle, Word_t EndingHandle, GATT_Client_Event_Callback_t ClientEventCallback, unsigned long CallbackParameter);
+int BTPSAPI GATT_Write_Request(unsigned int BluetoothStackID, unsigned int ConnectionID, Word_t AttributeHandle, Word_t AttributeLength, void *AttributeValue, GATT_Client_Event_Callback_t ClientEventCallback, unsigned long CallbackParameter);
+int BTPSAPI GATT_Handle_Value_Confirmation(unsigned int BluetoothStackID, unsigned int ConnectionID, unsigned int TransactionID);
+
+#include "BTPSKRNL.h"       /* Kernel API (BTPS_Init() and friends).       */
+
+#endif
@@ -0,0 +1,15 @@
+/*****< ss1btvs.h >************************************************************/
+/*                                                                            */
+/*  SS1BTVS - Host stand-in for the CC256x vendor specific API (Linux         */
+/*            replay build).                                                  */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __SS1BTVSH__
+#define __SS1BTVSH__
+
+#include "SS1BTPS.h"       /* Bluetopia API Stand-in Types/Prototypes.    */
+
+int BTPSAPI VS_EnableWBS(unsigned int BluetoothStackID, Word_t ConnectionHandle);
+int BTPSAPI VS_DisableWBS(unsigned int BluetoothStackID);
+
+#endif
@@ -0,0 +1,30 @@
+/*****< flash.h >**************************************************************/
+/*                                                                            */
+/*  flash - Host stand-in for the TivaWare flash driver (Linux replay         */
+/*          build).  The flash is a RAM array in StandIn.c, the replay build  */
+/*          defines PEER_CACHE_FLASH_ADDRESS as ((uintptr_t)StandIn_Flash)    */
+/*          (the first page) and GATT_CLIENT_FLASH_ADDRESS as                 */
+/*          ((uintptr_t)StandIn_Flash + 0x400) (the two pages after it),      */
+/*          and GATT_DATABASE_FLASH_ADDRESS as                                */
+/*          ((uintptr_t)StandIn_Flash + 0xC00) (the last page).               */
+/*          Addresses are host pointers, so they are passed as uintptr_t.     */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __FLASHH__
+#define __FLASHH__
+
+#include <stdint.h>
+
+extern uint32_t StandIn_Flash[];
+
+#define STAND_IN_FLASH_PAGE_SIZE                (1024)
+
+#define STAND_IN_FLASH_SIZE                     (4 * STAND_IN_FLASH_PAGE_SIZE)
+
+int32_t StandIn_FlashErase(uintptr_t Address);
+int32_t StandIn_FlashProgram(uint32_t *Data, uintptr_t Address, uint32_t Count);
+
+#define FlashErase(__Address)                   StandIn_FlashErase((uintptr_t)(__Address))
+#define FlashProgram(__Data, __Address, __Count) StandIn_FlashProgram((__Data), (uintptr_t)(__Address), (__Count))
+
+#endif
@@ -0,0 +1,1097 @@
+/*****< centralsim.c >*********************************************************/
+/*                                                                            */
+/*  CentralSim - Simulated LE centrals that load the GATT service of          */
+/*               configureGATT() (NoOS/Main.c) on the host.                   */
+/*                                                                            */
+/*               One instance of the application runs on top of the          */
+/*               Bluetopia stand-in (StandIn.c).  Many virtual clients are    */
+/*               connected to it at the same time, each with its own         */
+/*               connection interval.  At every connection event a client    */
+/*               receives the response the server queued at the previous     */
+/*               event and sends its next ATT operation if it has none       */
+/*               outstanding (ATT allows one request per bearer).  The        */
+/*               operation is picked from a configurable mix of reads,       */
+/*               write requests, write commands and CCCD subscriptions.      */
+/*               Every PDU is lost with a configurable probability and is    */
+/*               retransmitted at the next connection event, as the link     */
+/*               layer does.  A request that is not answered within the ATT  */
+/*               timeout ends the connection, the client then reconnects.    */
+/*               A connection parameter update request of the server is      */
+/*               answered at the next connection event (rejected with a      */
+/*               configurable probability), an accepted one applies the      */
+/*               largest interval of the request six events later.  Clients  */
+/*               may alternate between active and quiet periods, so the     */
+/*               connection parameter policy sees idle links.                */
+/*                                                                            */
+/*               The time is simulated, so a run with the same options and   */
+/*               seed is repeatable.  The response latency of each operation */
+/*               (simulated, from the first transmission until the response  */
+/*               arrives at the client), the outcome of the operations, and  */
+/*               the host time spent in the GATT callbacks of the            */
+/*               application are reported.                                   */
+/*                                                                            */
+/*  Build (from this directory):                                              */
+/*                                                                            */
+/*     gcc -c -IBluetopia -I.. -I../NoOS -Dmain=TargetMain                    */
+/*         -DVALUE_MAXIMUM_SUBSCRIBERS=512 -o Main.o ../NoOS/Main.c           */
+/*     gcc -O2 -IBluetopia -I.. -DMAXIMUM_CONNECTIONS=512                     */
+/*         -DCONN_PARAM_MAXIMUM_LINKS=512                                     */
+/*         -DPEER_CACHE_FLASH_ADDRESS='((uintptr_t)StandIn_Flash)'            */
+/*         -DGATT_CLIENT_FLASH_ADDRESS='((uintptr_t)StandIn_Flash + 0x400)'   */
+/*         -DGATT_DATABASE_FLASH_ADDRESS='((uintptr_t)StandIn_Flash + 0xC00)' */
+/*         -o CentralSim CentralSim.c StandIn.c Main.o ../HFPDemo.c           */
+/*         ../PeerCache.c ../Recovery.c ../BootSeq.c ../BTSnoop.c             */
+/*         ../Profile.c ../StackMark.c ../GATTUUID.c ../Advertise.c           */
+/*         ../Scan.c ../ConnParam.c ../GATTClient.c ../GATTDatabase.c         */
+/*         ../GATTLong.c ../Sniff.c ../AudioLink.c ../Coroutine.c             */
+/*         ../Metrics.c                                                       */
+/*                                                                            */
+/*  The stand-in tracks MAXIMUM_CONNECTIONS links, the connection parameter   */
+/*  policy CONN_PARAM_MAXIMUM_LINKS and the service VALUE_MAXIMUM_SUBSCRIBERS */
+/*  subscriptions, all must be at least the number of clients.                */
+/*                                                                            */
+/*  Usage: CentralSim [-n Clients] [-d Seconds] [-i Min[:Max]] [-m Mix]       */
+/*                    [-l Loss] [-t Timeout] [-u MTU] [-r Handle]             */
+/*                    [-w Handle] [-c Handle] [-p Reject]                     */
+/*                    [-a Active:Quiet] [-s Seed] [-v]                        */
+/*                                                                            */
+/*     -n  Number of clients (default 64).                                    */
+/*     -d  Simulated duration in seconds (default 60).                        */
+/*     -i  Range of the connection intervals in ms, each client picks one    */
+/*         (default 7.5:50, rounded to 1.25 ms).                              */
+/*     -m  Weights of Read:Write:WriteCommand:Subscribe (default              */
+/*         60:10:20:10).                                                      */
+/*     -l  Probability that a PDU is lost in percent (default 0).             */
+/*     -t  ATT timeout in ms (default 30000).                                 */
+/*     -u  MTU the clients request (default 247).                             */
+/*     -r  Handle that is read (default 0x000C, the BTSnoop value).           */
+/*     -w  Handle that is written (default 0x0009).                           */
+/*     -c  Handle of the CCCD the clients subscribe to (default 0x000A).      */
+/*     -p  Probability that a connection parameter update is rejected in      */
+/*         percent (default 0).                                               */
+/*     -a  Seconds a client is active and quiet in turn (default always       */
+/*         active).                                                           */
+/*     -s  Seed of the simulation (default 1).                                */
+/*     -v  Show the output of the application.                                */
+/*                                                                            */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "StandIn.h"       /* Bluetopia Stand-in Prototypes/Constants.        */
+#include "../Main.h"       /* Application Prototypes.                         */
+#include "../Recovery.h"   /* Retry/backoff of failed operations.             */
+#include "../PeerCache.h"  /* Peer paging information cache.                  */
+#include "../BTSnoop.h"    /* HCI Traffic Capture Prototypes/Constants.       */
+#include "../Advertise.h"  /* LE Advertising Manager.                         */
+#include "../ConnParam.h"  /* Connection Parameter Policy.                    */
+
+#define MAXIMUM_CLIENTS                             (4096)  /* Denotes the      */
+                                                         /* largest number of*/
+                                                         /* clients.         */
+
+#define DEFAULT_CLIENTS                              (64)  /* Denotes the      */
+                                                         /* default number of*/
+                                                         /* clients.         */
+
+#define DEFAULT_DURATION                             (60)  /* Denotes the      */
+                                                         /* default simulated*/
+                                                         /* duration (s).    */
+
+#define DEFAULT_MINIMUM_INTERVAL                   (7500)  /* Denotes the      */
+#define DEFAULT_MAXIMUM_INTERVAL                  (50000)  /* default range of */
+                                                         /* the connection   */
+                                                         /* intervals (us).  */
+
+#define DEFAULT_ATT_TIMEOUT                       (30000)  /* Denotes the ATT  */
+                                                         /* transaction      */
+                                                         /* timeout (ms).    */
+
+#define DEFAULT_CLIENT_MTU                          (247)  /* Denotes the      */
+                                                         /* default MTU the  */
+                                                         /* clients request. */
+
+#define GATT_VALUE_HANDLE                        (0x0009)  /* The following    */
+#define GATT_SNOOP_HANDLE                        (0x000C)  /* constants are the*/
+#define GATT_CCCD_HANDLE                         (0x000A)  /* default handles  */
+                                                         /* of configureGATT()*/
+                                                         /* (behind the      */
+                                                         /* Generic Attribute*/
+                                                         /* service of       */
+                                                         /* GATTDatabase.c). */
+
+#define LE_CONNECTION_HANDLE                     (0x0040)  /* Denotes the      */
+                                                         /* handle of the    */
+                                                         /* link of the first*/
+                                                         /* client.          */
+
+#define CONNECTION_INTERVAL_UNIT                   (1250)  /* Denotes the unit */
+                                                         /* of the connection*/
+                                                         /* interval (us).   */
+
+#define MAXIMUM_PDU_SIZE                             (16)  /* Denotes the size */
+                                                         /* of the PDUs the  */
+                                                         /* clients send.    */
+
+#define MAXIMUM_CALLBACK_NAMES                       (32)  /* Denotes the      */
+                                                         /* number of callback*/
+                                                         /* names that are   */
+                                                         /* reported.        */
+
+#define UPDATE_INSTANT_EVENTS                         (6)  /* Denotes the number*/
+                                                         /* of events after  */
+                                                         /* which accepted   */
+                                                         /* parameters apply.*/
+
+#define L2CAP_CODE_CONNECTION_PARAMETER_UPDATE_REQUEST   (0x12)  /* The        */
+#define L2CAP_CODE_CONNECTION_PARAMETER_UPDATE_RESPONSE  (0x13)  /* following  */
+                                                         /* constants are the*/
+                                                         /* LE signalling    */
+                                                         /* codes that are   */
+                                                         /* used.            */
+
+#define ATT_OPCODE_ERROR_RESPONSE                   (0x01)  /* The following   */
+#define ATT_OPCODE_EXCHANGE_MTU_REQUEST             (0x02)  /* constants are   */
+#define ATT_OPCODE_READ_REQUEST                     (0x0A)  /* the ATT opcodes */
+#define ATT_OPCODE_WRITE_REQUEST                    (0x12)  /* that are used.  */
+#define ATT_OPCODE_WRITE_COMMAND                    (0x52)
+#define ATT_OPCODE_HANDLE_VALUE_NOTIFICATION        (0x1B)
+
+#define HISTOGRAM_SUB_BUCKET_BITS                     (3)  /* Denotes the      */
+                                                         /* resolution of the*/
+                                                         /* latency histogram*/
+                                                         /* (8 buckets per   */
+                                                         /* power of two).   */
+
+#define HISTOGRAM_LINEAR_BUCKETS      (1 << (HISTOGRAM_SUB_BUCKET_BITS + 1))
+#define HISTOGRAM_NUMBER_BUCKETS      (HISTOGRAM_LINEAR_BUCKETS + ((40 - (HISTOGRAM_SUB_BUCKET_BITS + 1)) << HISTOGRAM_SUB_BUCKET_BITS))
+                                                         /* Up to 2^40.      */
+
+   /* The following enumerated type represents the ATT operations of the*/
+   /* clients.                                                          */
+typedef enum
+{
+   okExchangeMTU,
+   okRead,
+   okWrite,
+   okWriteCommand,
+   okSubscribe,
+   okNumberKinds
+} Operation_Kind_t;
+
+   /* The following structure holds the outcome of the operations of one */
+   /* kind.  The latency histogram counts microseconds.                 */
+typedef struct _tagOperation_Statistics_t
+{
+   unsigned long      Issued;
+   unsigned long      Answered;
+   unsigned long      Errors;
+   unsigned long      Timeouts;
+   unsigned long long MaximumLatency;
+   unsigned long      Histogram[HISTOGRAM_NUMBER_BUCKETS];
+} Operation_Statistics_t;
+
+   /* The following structure holds the host time of the application    */
+   /* callbacks of one name (see StandIn_SetDispatchCallback()).        */
+typedef struct _tagCallback_Statistics_t
+{
+   const char         *Name;
+   unsigned long       Count;
+   unsigned long long  Time;
+   unsigned long long  MaximumTime;
+} Callback_Statistics_t;
+
+   /* The following structure holds a virtual client.  Uplink holds the  */
+   /* PDU that is (re)transmitted at the next connection event.  The    */
+   /* Update members hold the connection parameter update request of the*/
+   /* server that is being answered (UpdateCountdown counts the events  */
+   /* until accepted parameters apply).                                 */
+typedef struct _tagClient_t
+{
+   unsigned int       Number;
+   Word_t             Handle;
+   Boolean_t          Connected;
+   unsigned long long Interval;
+   unsigned long long NextEvent;
+   Operation_Kind_t   Kind;
+   Boolean_t          Outstanding;
+   unsigned long long IssueTime;
+   unsigned int       UplinkLength;
+   Byte_t             Uplink[MAXIMUM_PDU_SIZE];
+   Boolean_t          ResponseQueued;
+   Byte_t             ResponseOpCode;
+   unsigned long long ActiveOffset;
+   Boolean_t          UpdateRequested;
+   Byte_t             UpdateIdentifier;
+   Word_t             UpdateInterval;
+   Word_t             UpdateLatency;
+   Word_t             UpdateTimeout;
+   unsigned int       UpdateCountdown;
+} Client_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static Client_t           *Clients;                 /* Variables which hold  */
+static unsigned int        NumberClients;           /* the clients and the   */
+static unsigned int       *EventQueue;              /* heap of their next    */
+                                                    /* connection events.    */
+
+static unsigned long long  Duration;                /* Variables which hold  */
+static unsigned long long  MinimumInterval;         /* the options.          */
+static unsigned long long  MaximumInterval;
+static unsigned long long  ATTTimeout;
+static unsigned int        Weights[okNumberKinds];
+static double              LossProbability;
+static Word_t              ClientMTU;
+static Word_t              ReadHandle;
+static Word_t              WriteHandle;
+static Word_t              CCCDHandle;
+static unsigned long       RandomState;
+static double              RejectProbability;
+static unsigned long long  ActiveTime;
+static unsigned long long  QuietTime;
+
+static Operation_Statistics_t OperationStatistics[okNumberKinds];
+                                                    /* Variables which hold  */
+static Callback_Statistics_t CallbackStatistics[MAXIMUM_CALLBACK_NAMES];
+static unsigned int        NumberCallbackNames;     /* the results.          */
+static unsigned long       Connections;
+static unsigned long       LostPDUs;
+static unsigned long       DeliveredPDUs;
+static unsigned long       StrayResponses;
+static unsigned long       ClientRequests;
+static unsigned long       Notifications;
+static unsigned long       UntrackedLinks;
+static unsigned long       UpdateRequests;
+static unsigned long       UpdatesRejected;
+static unsigned long       UpdatesApplied;
+
+static const char *KindNames[okNumberKinds] =
+{
+   "MTU", "Read", "Write", "WriteCmd", "Subscribe"
+};
+
+   /* The following function registers the GATT service of the         */
+   /* application (NoOS/Main.c).                                        */
+void configureGATT(int bluetoothStackID);
+
+   /* The following function starts the LE advertising of the           */
+   /* application (NoOS/Main.c).                                        */
+void configureAdvertising(int bluetoothStackID);
+
+   /* Internal function prototypes.                                     */
+static unsigned long Random(void);
+static Boolean_t Lost(void);
+static unsigned int BucketIndex(unsigned long long Time);
+static unsigned long long BucketLimit(unsigned int Index);
+static unsigned long long SnoopTimestamp(void);
+static void CommandCallback(Word_t OpCode, unsigned int ParameterLength, Byte_t *Parameters, unsigned long CallbackParameter);
+static void ResponseCallback(Word_t ConnectionHandle, unsigned int Length, Byte_t *PDU, unsigned long CallbackParameter);
+static void SignallingCallback(Word_t ConnectionHandle, unsigned int Length, Byte_t *Command, unsigned long CallbackParameter);
+static void DispatchCallback(const char *Name, unsigned long long Time, unsigned long CallbackParameter);
+static void DeliverPacket(Byte_t PacketType, unsigned int Length, Byte_t *Packet);
+static void DeliverConnection(Client_t *Client);
+static void DeliverDisconnection(Client_t *Client);
+static void DeliverATT(Client_t *Client);
+static void DeliverUpdateResponse(Client_t *Client, Boolean_t Accepted);
+static void DeliverUpdateComplete(Client_t *Client);
+static void IssueOperation(Client_t *Client, unsigned long long Time);
+static void CompleteOperation(Client_t *Client, unsigned long long Time);
+static void ConnectionEvent(Client_t *Client, unsigned long long Time);
+static void SiftDown(unsigned int Position);
+static void DisplayConnectionParameters(FILE *Report);
+static void DisplayResults(FILE *Report, double Seconds);
+
+   /* The following function returns a pseudo random number (xorshift).  */
+static unsigned long Random(void)
+{
+   RandomState ^= (RandomState << 13) & 0xFFFFFFFFUL;
+   RandomState ^= RandomState >> 17;
+   RandomState ^= RandomState << 5;
+   RandomState &= 0xFFFFFFFFUL;
+
+   return(RandomState);
+}
+
+   /* The following function decides whether a PDU is lost.              */
+static Boolean_t Lost(void)
+{
+   return((Boolean_t)((LossProbability > 0) && (((double)Random() / 4294967296.0) < LossProbability)));
+}
+
+   /* The following function returns the histogram bucket of a latency.  */
+   /* Small values have a bucket each, above that every power of two is*/
+   /* split in 2^HISTOGRAM_SUB_BUCKET_BITS buckets.                     */
+static unsigned int BucketIndex(unsigned long long Time)
+{
+   unsigned int ret_val;
+   unsigned int Exponent;
+
+   if(Time < HISTOGRAM_LINEAR_BUCKETS)
+      ret_val = (unsigned int)Time;
+   else
+   {
+      for(Exponent=HISTOGRAM_SUB_BUCKET_BITS + 1;(Exponent < 63) && (Time >> (Exponent + 1));Exponent++)
+         ;
+
+      ret_val = HISTOGRAM_LINEAR_BUCKETS + ((Exponent - (HISTOGRAM_SUB_BUCKET_BITS + 1)) << HISTOGRAM_SUB_BUCKET_BITS) + (unsigned int)((Time >> (Exponent - HISTOGRAM_SUB_BUCKET_BITS)) & ((1 << HISTOGRAM_SUB_BUCKET_BITS) - 1));
+
+      if(ret_val >= HISTOGRAM_NUMBER_BUCKETS)
+         ret_val = HISTOGRAM_NUMBER_BUCKETS - 1;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the largest latency of the          */
+   /* specified histogram bucket.                                       */
+static unsigned long long BucketLimit(unsigned int Index)
+{
+   unsigned long long ret_val;
+   unsigned int       Exponent;
+
+   if(Index < HISTOGRAM_LINEAR_BUCKETS)
+      ret_val = Index;
+   else
+   {
+      Exponent = ((Index - HISTOGRAM_LINEAR_BUCKETS) >> HISTOGRAM_SUB_BUCKET_BITS) + HISTOGRAM_SUB_BUCKET_BITS + 1;
+      ret_val  = (1ULL << Exponent) + ((unsigned long long)((Index - HISTOGRAM_LINEAR_BUCKETS) & ((1 << HISTOGRAM_SUB_BUCKET_BITS) - 1)) << (Exponent - HISTOGRAM_SUB_BUCKET_BITS));
+      ret_val += (1ULL << (Exponent - HISTOGRAM_SUB_BUCKET_BITS)) - 1;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the simulated time in microseconds */
+   /* (the timestamps of the capture of the application).               */
+static unsigned long long SnoopTimestamp(void)
+{
+   return((unsigned long long)StandIn_GetTime() * 1000ULL);
+}
+
+   /* The following function is called by the stand-in with every HCI   */
+   /* command of the application.  The command is captured, so the      */
+   /* BTSnoop value the clients read holds the traffic as on the target.*/
+static void CommandCallback(Word_t OpCode, unsigned int ParameterLength, Byte_t *Parameters, unsigned long CallbackParameter)
+{
+   Byte_t Packet[4 + 255];
+
+   if(ParameterLength > 255)
+      ParameterLength = 255;
+
+   Packet[0] = HCI_COMMAND_PACKET;
+   Packet[1] = (Byte_t)OpCode;
+   Packet[2] = (Byte_t)(OpCode >> 8);
+   Packet[3] = (Byte_t)ParameterLength;
+
+   memcpy(&Packet[4], Parameters, ParameterLength);
+
+   BTSnoop_CaptureData(BTSNOOP_DIRECTION_SENT, 4 + ParameterLength, Packet);
+}
+
+   /* The following function is called by the stand-in with every ATT    */
+   /* response.  The response is sent at the next connection event of  */
+   /* the client.  The requests of the GATT client of the application  */
+   /* (even opcodes) are only counted, the clients have no database.   */
+   /* Notifications are counted as well, they are not responses.        */
+static void ResponseCallback(Word_t ConnectionHandle, unsigned int Length, Byte_t *PDU, unsigned long CallbackParameter)
+{
+   Client_t *Client;
+
+   if((Length) && (!(PDU[0] & 0x01)))
+      ClientRequests++;
+   else if((Length) && (PDU[0] == ATT_OPCODE_HANDLE_VALUE_NOTIFICATION))
+      Notifications++;
+   else if((Length) && (ConnectionHandle >= LE_CONNECTION_HANDLE) && (ConnectionHandle < (LE_CONNECTION_HANDLE + NumberClients)))
+   {
+      Client = &Clients[ConnectionHandle - LE_CONNECTION_HANDLE];
+
+      if((Client->Outstanding) && (!Client->ResponseQueued))
+      {
+         Client->ResponseQueued = TRUE;
+         Client->ResponseOpCode = PDU[0];
+      }
+      else
+         StrayResponses++;
+   }
+   else
+      StrayResponses++;
+}
+
+   /* The following function is called by the stand-in with every LE     */
+   /* signalling command.  The connection parameter update request is   */
+   /* answered at the next connection event of the client.              */
+static void SignallingCallback(Word_t ConnectionHandle, unsigned int Length, Byte_t *Command, unsigned long CallbackParameter)
+{
+   Client_t *Client;
+
+   if((Length >= 12) && (Command[0] == L2CAP_CODE_CONNECTION_PARAMETER_UPDATE_REQUEST) && (ConnectionHandle >= LE_CONNECTION_HANDLE) && (ConnectionHandle < (LE_CONNECTION_HANDLE + NumberClients)))
+   {
+      Client = &Clients[ConnectionHandle - LE_CONNECTION_HANDLE];
+
+      Client->UpdateRequested  = TRUE;
+      Client->UpdateIdentifier = Command[1];
+      Client->UpdateInterval   = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Command[6]);
+      Client->UpdateLatency    = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Command[8]);
+      Client->UpdateTimeout    = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Command[10]);
+
+      UpdateRequests++;
+   }
+}
+
+   /* The following function records the host time of an application     */
+   /* callback.                                                         */
+static void DispatchCallback(const char *Name, unsigned long long Time, unsigned long CallbackParameter)
+{
+   unsigned int Index;
+
+   for(Index=0;(Index<NumberCallbackNames) && (CallbackStatistics[Index].Name != Name);Index++)
+      ;
+
+   if(Index < MAXIMUM_CALLBACK_NAMES)
+   {
+      if(Index == NumberCallbackNames)
+      {
+         CallbackStatistics[Index].Name = Name;
+
+         NumberCallbackNames++;
+      }
+
+      CallbackStatistics[Index].Count++;
+      CallbackStatistics[Index].Time += Time;
+
+      if(Time > CallbackStatistics[Index].MaximumTime)
+         CallbackStatistics[Index].MaximumTime = Time;
+   }
+}
+
+   /* The following function passes a packet of the controller to the    */
+   /* stand-in (and to the capture, as the HCI driver of the target     */
+   /* does).                                                            */
+static void DeliverPacket(Byte_t PacketType, unsigned int Length, Byte_t *Packet)
+{
+   Byte_t Captured[MAXIMUM_PDU_SIZE + 16];
+
+   if(Length < sizeof(Captured))
+   {
+      Captured[0] = PacketType;
+
+      memcpy(&Captured[1], Packet, Length);
+
+      BTSnoop_CaptureData(BTSNOOP_DIRECTION_RECEIVED, Length + 1, Captured);
+   }
+
+   StandIn_ProcessPacket(BTSNOOP_DIRECTION_RECEIVED, PacketType, Length, Packet);
+
+   /* Give the main loop of the application a pass.                     */
+   Recovery_Process();
+   PeerCache_Flush();
+   Advertise_Process();
+   ConnParam_Process();
+}
+
+   /* The following function delivers the LE Connection Complete event of*/
+   /* a client (the server is slave).                                   */
+static void DeliverConnection(Client_t *Client)
+{
+   Byte_t Packet[21];
+
+   memset(Packet, 0, sizeof(Packet));
+
+   Packet[0] = 0x3E;
+   Packet[1] = 19;
+   Packet[2] = 0x01;
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[4], Client->Handle);
+   Packet[6] = 0x01;
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[8], Client->Number);
+   Packet[13] = 0xC0;
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[14], (Word_t)(Client->Interval / CONNECTION_INTERVAL_UNIT));
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[18], 400);
+
+   DeliverPacket(HCI_EVENT_PACKET, sizeof(Packet), Packet);
+}
+
+   /* The following function delivers the Disconnection Complete event of*/
+   /* a client.                                                         */
+static void DeliverDisconnection(Client_t *Client)
+{
+   Byte_t Packet[6];
+
+   Packet[0] = 0x05;
+   Packet[1] = 4;
+   Packet[2] = 0x00;
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[3], Client->Handle);
+   Packet[5] = 0x13;
+
+   DeliverPacket(HCI_EVENT_PACKET, sizeof(Packet), Packet);
+}
+
+   /* The following function delivers the uplink PDU of a client on the */
+   /* fixed ATT channel of its link.                                    */
+static void DeliverATT(Client_t *Client)
+{
+   Byte_t Packet[8 + MAXIMUM_PDU_SIZE];
+
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[0], Client->Handle | 0x2000);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[2], Client->UplinkLength + 4);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[4], Client->UplinkLength);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[6], 0x0004);
+
+   memcpy(&Packet[8], Client->Uplink, Client->UplinkLength);
+
+   DeliverPacket(HCI_ACL_PACKET, Client->UplinkLength + 8, Packet);
+
+   DeliveredPDUs++;
+}
+
+   /* The following function delivers the answer of a client to the     */
+   /* connection parameter update request on the LE signalling channel. */
+static void DeliverUpdateResponse(Client_t *Client, Boolean_t Accepted)
+{
+   Byte_t Packet[14];
+
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[0], Client->Handle | 0x2000);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[2], 10);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[4], 6);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[6], 0x0005);
+
+   Packet[8] = L2CAP_CODE_CONNECTION_PARAMETER_UPDATE_RESPONSE;
+   Packet[9] = Client->UpdateIdentifier;
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[10], 2);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[12], Accepted?0:1);
+
+   DeliverPacket(HCI_ACL_PACKET, sizeof(Packet), Packet);
+}
+
+   /* The following function delivers the LE Connection Update Complete  */
+   /* event of a client whose new parameters apply.                     */
+static void DeliverUpdateComplete(Client_t *Client)
+{
+   Byte_t Packet[12];
+
+   Packet[0] = 0x3E;
+   Packet[1] = 10;
+   Packet[2] = 0x03;
+   Packet[3] = 0x00;
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[4], Client->Handle);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[6], (Word_t)(Client->Interval / CONNECTION_INTERVAL_UNIT));
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[8], Client->UpdateLatency);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[10], Client->UpdateTimeout);
+
+   DeliverPacket(HCI_EVENT_PACKET, sizeof(Packet), Packet);
+}
+
+   /* The following function builds the next operation of a client.  The */
+   /* first operation of a connection is the MTU exchange, the others   */
+   /* are picked from the mix.                                          */
+static void IssueOperation(Client_t *Client, unsigned long long Time)
+{
+   unsigned int Index;
+   unsigned long Pick;
+   unsigned long Total;
+
+   if(Client->Kind == okNumberKinds)
+      Client->Kind = okExchangeMTU;
+   else
+   {
+      for(Index=okRead,Total=0;Index<okNumberKinds;Index++)
+         Total += Weights[Index];
+
+      Pick = Random() % Total;
+
+      for(Index=okRead;(Index < (okNumberKinds - 1)) && (Pick >= Weights[Index]);Index++)
+         Pick -= Weights[Index];
+
+      Client->Kind = (Operation_Kind_t)Index;
+   }
+
+   switch(Client->Kind)
+   {
+      case okExchangeMTU:
+         Client->Uplink[0] = ATT_OPCODE_EXCHANGE_MTU_REQUEST;
+         ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Client->Uplink[1], ClientMTU);
+         Client->UplinkLength = 3;
+         break;
+      case okRead:
+         Client->Uplink[0] = ATT_OPCODE_READ_REQUEST;
+         ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Client->Uplink[1], ReadHandle);
+         Client->UplinkLength = 3;
+         break;
+      case okWrite:
+      case okWriteCommand:
+         Client->Uplink[0] = (Byte_t)((Client->Kind == okWrite)?ATT_OPCODE_WRITE_REQUEST:ATT_OPCODE_WRITE_COMMAND);
+         ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Client->Uplink[1], WriteHandle);
+         Client->Uplink[3]    = (Byte_t)(Random() & 0x01);
+         Client->UplinkLength = 4;
+         break;
+      default:
+         /* Enable notifications.                                       */
+         Client->Uplink[0] = ATT_OPCODE_WRITE_REQUEST;
+         ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Client->Uplink[1], CCCDHandle);
+         ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Client->Uplink[3], 0x0001);
+         Client->UplinkLength = 5;
+         break;
+   }
+
+   Client->IssueTime = Time;
+
+   OperationStatistics[Client->Kind].Issued++;
+}
+
+   /* The following function records the response of the operation of a */
+   /* client that arrived at the specified time.                        */
+static void CompleteOperation(Client_t *Client, unsigned long long Time)
+{
+   Operation_Statistics_t *Statistics;
+
+   Statistics = &OperationStatistics[Client->Kind];
+
+   if(Client->ResponseOpCode == ATT_OPCODE_ERROR_RESPONSE)
+      Statistics->Errors++;
+   else
+      Statistics->Answered++;
+
+   Statistics->Histogram[BucketIndex(Time - Client->IssueTime)]++;
+
+   if((Time - Client->IssueTime) > Statistics->MaximumLatency)
+      Statistics->MaximumLatency = Time - Client->IssueTime;
+
+   Client->Outstanding    = FALSE;
+   Client->ResponseQueued = FALSE;
+}
+
+   /* The following function runs a connection event of a client.        */
+static void ConnectionEvent(Client_t *Client, unsigned long long Time)
+{
+   StandIn_SetTime((unsigned long)(Time / 1000ULL));
+
+   if(!Client->Connected)
+   {
+      /* The data exchange starts at the next connection event.         */
+      DeliverConnection(Client);
+
+      Client->Connected = TRUE;
+      Client->Kind      = okNumberKinds;
+
+      Connections++;
+      return;
+   }
+
+   /* Downlink: the response the server queued at an earlier event.     */
+   if(Client->ResponseQueued)
+   {
+      if(!Lost())
+         CompleteOperation(Client, Time);
+      else
+         LostPDUs++;
+   }
+
+   /* A transaction that is not answered in time ends the connection.   */
+   if((Client->Outstanding) && ((Time - Client->IssueTime) >= ATTTimeout))
+   {
+      OperationStatistics[Client->Kind].Timeouts++;
+
+      DeliverDisconnection(Client);
+
+      Client->Connected       = FALSE;
+      Client->Outstanding     = FALSE;
+      Client->ResponseQueued  = FALSE;
+      Client->UplinkLength    = 0;
+      Client->UpdateRequested = FALSE;
+      Client->UpdateCountdown = 0;
+      return;
+   }
+
+   /* Accepted parameters apply at the instant, the new interval is used*/
+   /* from this event on.                                               */
+   if((Client->UpdateCountdown) && (!--Client->UpdateCountdown))
+   {
+      Client->Interval = (unsigned long long)Client->UpdateInterval * CONNECTION_INTERVAL_UNIT;
+
+      DeliverUpdateComplete(Client);
+
+      UpdatesApplied++;
+   }
+
+   /* The answer to an update request of the server (a new request      */
+   /* replaces one that is not yet applied).                            */
+   if((Client->UpdateRequested) && (!Lost()))
+   {
+      Client->UpdateRequested = FALSE;
+
+      if(((double)(Random() % 10000) / 10000.0) >= RejectProbability)
+      {
+         DeliverUpdateResponse(Client, TRUE);
+
+         Client->UpdateCountdown = UPDATE_INSTANT_EVENTS;
+      }
+      else
+      {
+         DeliverUpdateResponse(Client, FALSE);
+
+         UpdatesRejected++;
+      }
+   }
+
+   /* Uplink: the next operation (or the retransmission of the lost     */
+   /* one).  Write commands need no response, the next one may follow at*/
+   /* the next event.                                                   */
+   if((!Client->Outstanding) && (!Client->UplinkLength) && (Time < Duration) && ((!QuietTime) || (((Time + Client->ActiveOffset) % (ActiveTime + QuietTime)) < ActiveTime)))
+      IssueOperation(Client, Time);
+
+   if(Client->UplinkLength)
+   {
+      if(!Lost())
+      {
+         Client->Outstanding = (Boolean_t)(Client->Kind != okWriteCommand);
+
+         DeliverATT(Client);
+
+         if(Client->Kind == okWriteCommand)
+            OperationStatistics[okWriteCommand].Answered++;
+
+         /* The stack always answers the MTU exchange, no answer means  */
+         /* the stand-in does not track the link.                       */
+         if((Client->Kind == okExchangeMTU) && (!Client->ResponseQueued))
+            UntrackedLinks++;
+
+         Client->UplinkLength = 0;
+      }
+      else
+         LostPDUs++;
+   }
+}
+
+   /* The following function restores the order of the event heap below */
+   /* the specified position.                                           */
+static void SiftDown(unsigned int Position)
+{
+   unsigned int Child;
+   unsigned int Entry;
+
+   Entry = EventQueue[Position];
+
+   while((Child = (2 * Position) + 1) < NumberClients)
+   {
+      if(((Child + 1) < NumberClients) && (Clients[EventQueue[Child + 1]].NextEvent < Clients[EventQueue[Child]].NextEvent))
+         Child++;
+
+      if(Clients[EventQueue[Child]].NextEvent >= Clients[Entry].NextEvent)
+         break;
+
+      EventQueue[Position] = EventQueue[Child];
+      Position             = Child;
+   }
+
+   EventQueue[Position] = Entry;
+}
+
+   /* The following function writes the connection parameter updates and */
+   /* the share of the link time in each profile.                       */
+static void DisplayConnectionParameters(FILE *Report)
+{
+   unsigned int                  Index;
+   unsigned long long            ProfileTime[cpNumberProfiles];
+   BD_ADDR_t                     BD_ADDR;
+   ConnParam_Statistics_t        Statistics;
+   ConnParam_Link_Information_t  Information;
+
+   ProfileTime[cpBurst] = 0;
+   ProfileTime[cpIdle]  = 0;
+
+   for(Index=0;Index<NumberClients;Index++)
+   {
+      ASSIGN_BD_ADDR(BD_ADDR, 0xC0, 0, 0, 0, (Byte_t)(Clients[Index].Number >> 8), (Byte_t)Clients[Index].Number);
+
+      if(!ConnParam_QueryLink(BD_ADDR, &Information))
+      {
+         ProfileTime[cpBurst] += Information.ProfileTime[cpBurst];
+         ProfileTime[cpIdle]  += Information.ProfileTime[cpIdle];
+      }
+   }
+
+   fprintf(Report, "%lu parameter update requests, %lu rejected, %lu applied", UpdateRequests, UpdatesRejected, UpdatesApplied);
+
+   if(!ConnParam_QueryStatistics(&Statistics))
+      fprintf(Report, " (%lu deferred by the throttle, %lu send backlogs, %lu profiles given up)", Statistics.Deferred, Statistics.Backlogs, Statistics.GivenUp);
+
+   fprintf(Report, ".\n");
+
+   if(ProfileTime[cpBurst] + ProfileTime[cpIdle])
+      fprintf(Report, "Link time: %.1f%% burst, %.1f%% idle parameters.\n", (double)ProfileTime[cpBurst] * 100.0 / (double)(ProfileTime[cpBurst] + ProfileTime[cpIdle]), (double)ProfileTime[cpIdle] * 100.0 / (double)(ProfileTime[cpBurst] + ProfileTime[cpIdle]));
+}
+
+   /* The following function writes the report.                          */
+static void DisplayResults(FILE *Report, double Seconds)
+{
+   static const double Percentiles[] = { 50.0, 90.0, 99.0 };
+
+   unsigned int            Index;
+   unsigned int            Kind;
+   unsigned int            Bucket;
+   unsigned long           Count;
+   unsigned long           Target;
+   unsigned long           Completed;
+   unsigned long           Callbacks;
+   unsigned long long      CallbackTime;
+   Operation_Statistics_t *Statistics;
+
+   fprintf(Report, "%u clients, %.1f to %.1f ms intervals, %llu s simulated, %.2f%% PDU loss, mix %u:%u:%u:%u.\n\n", NumberClients, (double)MinimumInterval / 1000.0, (double)MaximumInterval / 1000.0, Duration / 1000000ULL, LossProbability * 100.0, Weights[okRead], Weights[okWrite], Weights[okWriteCommand], Weights[okSubscribe]);
+
+   fprintf(Report, "%-10s %9s %9s %9s %9s %9s %9s %9s %9s\n", "Operation", "Issued", "Answered", "Errors", "Timeouts", "p50 ms", "p90 ms", "p99 ms", "max ms");
+
+   for(Kind=0;Kind<okNumberKinds;Kind++)
+   {
+      Statistics = &OperationStatistics[Kind];
+      Completed  = Statistics->Answered + Statistics->Errors;
+
+      fprintf(Report, "%-10s %9lu %9lu %9lu %9lu", KindNames[Kind], Statistics->Issued, Statistics->Answered, Statistics->Errors, Statistics->Timeouts);
+
+      /* Write commands have no response, so no latency.                */
+      for(Index=0;Index<sizeof(Percentiles)/sizeof(Percentiles[0]);Index++)
+      {
+         if((Kind != okWriteCommand) && (Completed))
+         {
+            Target = (unsigned long)(((double)Completed * Percentiles[Index]) / 100.0);
+
+            for(Bucket=0,Count=0;(Bucket<HISTOGRAM_NUMBER_BUCKETS - 1) && ((Count += Statistics->Histogram[Bucket]) < Target);Bucket++)
+               ;
+
+            /* The bucket limit may lie above the largest latency.       */
+            fprintf(Report, " %9.2f", (double)((BucketLimit(Bucket) < Statistics->MaximumLatency)?BucketLimit(Bucket):Statistics->MaximumLatency) / 1000.0);
+         }
+         else
+            fprintf(Report, " %9s", "-");
+      }
+
+      if((Kind != okWriteCommand) && (Completed))
+         fprintf(Report, " %9.2f\n", (double)Statistics->MaximumLatency / 1000.0);
+      else
+         fprintf(Report, " %9s\n", "-");
+   }
+
+   fprintf(Report, "\n%lu connections, %lu PDUs delivered, %lu lost", Connections, DeliveredPDUs, LostPDUs);
+
+   if(Notifications)
+      fprintf(Report, ", %lu notifications", Notifications);
+
+   if(StrayResponses)
+      fprintf(Report, ", %lu responses without a request", StrayResponses);
+
+   if(ClientRequests)
+      fprintf(Report, ", %lu GATT client requests not answered", ClientRequests);
+
+   fprintf(Report, ".\n");
+
+   if(UntrackedLinks)
+      fprintf(Report, "%lu MTU exchanges were not answered, build the stand-in with a larger MAXIMUM_CONNECTIONS.\n", UntrackedLinks);
+
+   DisplayConnectionParameters(Report);
+
+   fprintf(Report, "\n%-32s %10s %10s %10s\n", "Callback", "Count", "Mean us", "Max us");
+
+   for(Index=0,Callbacks=0,CallbackTime=0;Index<NumberCallbackNames;Index++)
+   {
+      fprintf(Report, "%-32s %10lu %10.2f %10.2f\n", CallbackStatistics[Index].Name, CallbackStatistics[Index].Count, (double)CallbackStatistics[Index].Time / (double)CallbackStatistics[Index].Count / 1000.0, (double)CallbackStatistics[Index].MaximumTime / 1000.0);
+
+      if(!strncmp(CallbackStatistics[Index].Name, "GATT Server", 11) || !strncmp(CallbackStatistics[Index].Name, "GATT Read", 9) || !strncmp(CallbackStatistics[Index].Name, "GATT Write", 10))
+      {
+         Callbacks    += CallbackStatistics[Index].Count;
+         CallbackTime += CallbackStatistics[Index].Time;
+      }
+   }
+
+   fprintf(Report, "\nGATTServiceCallback(): %lu calls, %.0f calls/s of callback time.\n", Callbacks, CallbackTime?((double)Callbacks * 1e9 / (double)CallbackTime):0.0);
+   fprintf(Report, "Host: %.3f s for the run, %.0f PDUs/s.\n", Seconds, (Seconds > 0)?((double)DeliveredPDUs / Seconds):0.0);
+}
+
+int main(int argc, char *argv[])
+{
+   int                     ret_val;
+   int                     Option;
+   int                     StackID;
+   char                   *Separator;
+   FILE                   *Report;
+   double                  Seconds;
+   Boolean_t               Verbose;
+   unsigned int            Index;
+   unsigned long long      Time;
+   struct timespec         Start;
+   struct timespec         End;
+   BTPS_Initialization_t   BTPSInitialization;
+   HCI_DriverInformation_t DriverInformation;
+
+   NumberClients           = DEFAULT_CLIENTS;
+   Duration                = DEFAULT_DURATION * 1000000ULL;
+   MinimumInterval         = DEFAULT_MINIMUM_INTERVAL;
+   MaximumInterval         = DEFAULT_MAXIMUM_INTERVAL;
+   ATTTimeout              = DEFAULT_ATT_TIMEOUT * 1000ULL;
+   ClientMTU               = DEFAULT_CLIENT_MTU;
+   ReadHandle              = GATT_SNOOP_HANDLE;
+   WriteHandle             = GATT_VALUE_HANDLE;
+   CCCDHandle              = GATT_CCCD_HANDLE;
+   RandomState             = 1;
+   Verbose                 = FALSE;
+   Weights[okRead]         = 60;
+   Weights[okWrite]        = 10;
+   Weights[okWriteCommand] = 20;
+   Weights[okSubscribe]    = 10;
+
+   while((Option = getopt(argc, argv, "n:d:i:m:l:t:u:r:w:c:p:a:s:v")) != -1)
+   {
+      switch(Option)
+      {
+         case 'n':
+            NumberClients = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 'd':
+            Duration = (unsigned long long)(strtod(optarg, NULL) * 1e6);
+            break;
+         case 'i':
+            MinimumInterval = (unsigned long long)(strtod(optarg, &Separator) * 1000.0);
+            MaximumInterval = (*Separator == ':')?(unsigned long long)(strtod(Separator + 1, NULL) * 1000.0):MinimumInterval;
+            break;
+         case 'm':
+            if(sscanf(optarg, "%u:%u:%u:%u", &Weights[okRead], &Weights[okWrite], &Weights[okWriteCommand], &Weights[okSubscribe]) != 4)
+               Weights[okRead] = Weights[okWrite] = Weights[okWriteCommand] = Weights[okSubscribe] = 0;
+            break;
+         case 'l':
+            LossProbability = strtod(optarg, NULL) / 100.0;
+            break;
+         case 't':
+            ATTTimeout = strtoull(optarg, NULL, 0) * 1000ULL;
+            break;
+         case 'u':
+            ClientMTU = (Word_t)strtoul(optarg, NULL, 0);
+            break;
+         case 'r':
+            ReadHandle = (Word_t)strtoul(optarg, NULL, 0);
+            break;
+         case 'w':
+            WriteHandle = (Word_t)strtoul(optarg, NULL, 0);
+            break;
+         case 'c':
+            CCCDHandle = (Word_t)strtoul(optarg, NULL, 0);
+            break;
+         case 'p':
+            RejectProbability = strtod(optarg, NULL) / 100.0;
+            break;
+         case 'a':
+            ActiveTime = (unsigned long long)(strtod(optarg, &Separator) * 1e6);
+            QuietTime  = (*Separator == ':')?(unsigned long long)(strtod(Separator + 1, NULL) * 1e6):0;
+            break;
+         case 's':
+            RandomState = strtoul(optarg, NULL, 0);
+            break;
+         case 'v':
+            Verbose = TRUE;
+            break;
+         default:
+            fprintf(stderr, "Usage: %s [-n Clients] [-d Seconds] [-i Min[:Max]] [-m Mix] [-l Loss] [-t Timeout] [-u MTU] [-r Handle] [-w Handle] [-c Handle] [-p Reject] [-a Active:Quiet] [-s Seed] [-v]\n", argv[0]);
+            return(2);
+      }
+   }
+
+   /* Connection intervals are multiples of 1.25 ms from 7.5 ms to 4 s.  */
+   MinimumInterval = ((MinimumInterval + (CONNECTION_INTERVAL_UNIT / 2)) / CONNECTION_INTERVAL_UNIT) * CONNECTION_INTERVAL_UNIT;
+   MaximumInterval = ((MaximumInterval + (CONNECTION_INTERVAL_UNIT / 2)) / CONNECTION_INTERVAL_UNIT) * CONNECTION_INTERVAL_UNIT;
+
+   if((!NumberClients) || (NumberClients > MAXIMUM_CLIENTS) || (MinimumInterval < 7500) || (MaximumInterval > 4000000) || (MinimumInterval > MaximumInterval) || (!(Weights[okRead] + Weights[okWrite] + Weights[okWriteCommand] + Weights[okSubscribe])) || (LossProbability < 0) || (LossProbability >= 1.0) || (RejectProbability < 0) || (RejectProbability > 1.0) || ((QuietTime) && (!ActiveTime)) || (!ATTTimeout) || (ClientMTU < 23) || (!RandomState))
+   {
+      fprintf(stderr, "Invalid options.\n");
+      return(2);
+   }
+
+   /* The report goes to the original stdout, the output of the         */
+   /* application is discarded unless it was asked for.                 */
+   if((Report = fdopen(dup(fileno(stdout)), "w")) == NULL)
+      return(2);
+
+   if(!Verbose)
+   {
+      fflush(stdout);
+
+      if(!freopen("/dev/null", "w", stdout))
+         return(2);
+   }
+
+   Clients    = calloc(NumberClients, sizeof(Client_t));
+   EventQueue = calloc(NumberClients, sizeof(unsigned int));
+
+   if((!Clients) || (!EventQueue))
+   {
+      fprintf(Report, "Out of memory.\n");
+      return(2);
+   }
+
+   /* Bring up the application the way the target does.                 */
+   StandIn_Initialize(CommandCallback, 0);
+   StandIn_SetVerbose(Verbose);
+   StandIn_SetResponseCallback(ResponseCallback, 0);
+   StandIn_SetSignallingCallback(SignallingCallback, 0);
+   StandIn_SetDispatchCallback(DispatchCallback, 0);
+
+   BTSnoop_Initialize(SnoopTimestamp, BTSNOOP_DEFAULT_TRUNCATION);
+
+   memset(&BTPSInitialization, 0, sizeof(BTPSInitialization));
+   memset(&DriverInformation, 0, sizeof(DriverInformation));
+
+   if((StackID = InitializeApplication(&DriverInformation, &BTPSInitialization)) <= 0)
+   {
+      fprintf(Report, "Unable to initialize the application (%d).\n", StackID);
+      return(2);
+   }
+
+   configureGATT(StackID);
+   configureAdvertising(StackID);
+
+   /* The clients connect at a random point of their first interval.    */
+   for(Index=0;Index<NumberClients;Index++)
+   {
+      Clients[Index].Number    = Index;
+      Clients[Index].Handle    = (Word_t)(LE_CONNECTION_HANDLE + Index);
+      Clients[Index].Interval  = MinimumInterval + (((Random() % (((MaximumInterval - MinimumInterval) / CONNECTION_INTERVAL_UNIT) + 1))) * CONNECTION_INTERVAL_UNIT);
+      Clients[Index].NextEvent = Random() % Clients[Index].Interval;
+
+      if(QuietTime)
+         Clients[Index].ActiveOffset = (unsigned long long)Random() % (ActiveTime + QuietTime);
+
+      EventQueue[Index] = Index;
+   }
+
+   for(Index=NumberClients/2;Index>0;Index--)
+      SiftDown(Index - 1);
+
+   clock_gettime(CLOCK_MONOTONIC, &Start);
+
+   /* Run the earliest connection event until the duration is over and  */
+   /* the last responses had the chance to arrive.                      */
+   while((Time = Clients[EventQueue[0]].NextEvent) < (Duration + MaximumInterval))
+   {
+      ConnectionEvent(&Clients[EventQueue[0]], Time);
+
+      Clients[EventQueue[0]].NextEvent += Clients[EventQueue[0]].Interval;
+
+      SiftDown(0);
+   }
+
+   clock_gettime(CLOCK_MONOTONIC, &End);
+
+   Seconds = (double)(End.tv_sec - Start.tv_sec) + ((double)(End.tv_nsec - Start.tv_nsec) / 1e9);
+
+   DisplayResults(Report, Seconds);
+
+   ret_val = UntrackedLinks?1:0;
+
+   fclose(Report);
+
+   free(EventQueue);
+   free(Clients);
+
+   return(ret_val);
+}
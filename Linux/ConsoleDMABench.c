@@ -0,0 +1,499 @@
+/*****< consoledmabench.c >****************************************************/
+/*                                                                            */
+/*  ConsoleDMABench - Host benchmark of the console input.  A simulated       */
+/*                    UART at 115200 baud sends a scripted burst of command   */
+/*                    lines (as the test hosts do) through two models:        */
+/*                                                                            */
+/*                       - the interrupt per character model of the HAL (the  */
+/*                         handler moves each character into the input buffer */
+/*                         of the HAL, the main loop copies them into a line  */
+/*                         buffer).                                           */
+/*                       - the uDMA model of ConsoleDMA.c (the uDMA fills the */
+/*                         receive ring, the lines are handed off in place).  */
+/*                                                                            */
+/*                The main loop runs every 100 ms (as NoOS/Main.c) and every  */
+/*                command takes the specified time to run (its output at     */
+/*                115200 baud is most of it), the input keeps arriving        */
+/*                meanwhile.  For each model the lines that arrived intact,   */
+/*                the lost characters, the interrupts per KB and the line     */
+/*                copies are reported.                                        */
+/*                                                                            */
+/*  Build (from this directory):                                              */
+/*                                                                            */
+/*     gcc -O2 -I../NoOS -o ConsoleDMABench ConsoleDMABench.c                 */
+/*         ../NoOS/ConsoleDMA.c ../Metrics.c                                  */
+/*                                                                            */
+/*  Usage: ConsoleDMABench [Lines] [Command Time (ms)] [HAL Buffer Size]      */
+/*                                                                            */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ConsoleDMA.h"    /* Console DMA Receive Core Prototypes/Constants.  */
+
+#define DEFAULT_NUMBER_LINES                        (120)  /* Denotes the      */
+                                                         /* default number of */
+                                                         /* lines of the      */
+                                                         /* script.           */
+
+#define DEFAULT_COMMAND_TIME                         (10)  /* Denotes the      */
+                                                         /* default time (ms) */
+                                                         /* a command takes.  */
+
+#define DEFAULT_HAL_BUFFER_SIZE                      (64)  /* Denotes the      */
+                                                         /* default size of   */
+                                                         /* the input buffer  */
+                                                         /* of the HAL.       */
+
+#define BAUD_RATE                                (115200)  /* Denotes the baud */
+                                                         /* rate of the       */
+                                                         /* console (10 bits  */
+                                                         /* per character).   */
+
+#define MAIN_LOOP_DELAY                             (0.1)  /* Denotes the time */
+                                                         /* (s) the main loop */
+                                                         /* waits per pass.   */
+
+#define UART_FIFO_SIZE                               (16)  /* Denotes the size */
+                                                         /* of the UART       */
+                                                         /* receive FIFO.     */
+
+#define LINE_BUFFER_SIZE                             (64)  /* Denotes the size */
+                                                         /* of the line buffer*/
+                                                         /* of the interrupt  */
+                                                         /* model.            */
+
+   /* The following structure holds the results of a single run.         */
+typedef struct _tagBenchResult_t
+{
+   char          *ModelName;
+   double         Seconds;
+   unsigned long  Bytes;
+   unsigned long  Interrupts;
+   unsigned long  LostCharacters;
+   unsigned long  Lines;
+   unsigned long  IntactLines;
+   unsigned long  LineCopies;
+   unsigned long  MaximumBacklog;
+   unsigned long  Stalls;
+} BenchResult_t;
+
+   /* The following type definition represents the function that       */
+   /* receives each character arriving on the simulated UART.           */
+typedef void (*CharacterSink_t)(unsigned char Character);
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static char *CommandList[] =
+{
+   "GATTDB",
+   "Sniff",
+   "Audio",
+   "PeerCache",
+   "Help Pair",
+   "SetLocalName BenchDevice",
+   "Pair 0x0022334455AA 1",
+   "Scan Passive",
+   "Snoop 32",
+   "Stack",
+   "ConnParam",
+   "SetClassOfDevice 0x240404"
+} ;
+
+#define NUMBER_COMMANDS                            (sizeof(CommandList)/sizeof(char *))
+
+static char           *Script;                      /* Variables which hold the script */
+static unsigned long   ScriptLength;                /* (CR LF terminated lines) and the*/
+static unsigned long  *LineOffset;                  /* offset of each line in it.      */
+static unsigned long   NumberLines;
+
+static unsigned long   RandomState = 0x2545F491;    /* Variable which holds the state  */
+                                                    /* of the random number generator. */
+
+static double          CharacterTime;               /* Variables which hold the        */
+static double          CommandTime;                 /* simulated time (s), the time a  */
+static double          SimulatedTime;               /* character takes on the line and */
+                                                    /* the time a command takes.       */
+
+static unsigned long   NextCharacter;               /* Variables which hold the next   */
+static CharacterSink_t CharacterSink;               /* character of the script to send */
+                                                    /* and the model that receives it. */
+
+static BenchResult_t  *CurrentResult;               /* Variables which are used to     */
+static unsigned long   ExpectedLine;                /* check the lines handed to the   */
+                                                    /* interpreter against the script. */
+
+static unsigned char  *HALBuffer;                   /* Variables which hold the input  */
+static unsigned int    HALBufferSize;               /* buffer of the HAL (interrupt    */
+static unsigned int    HALIn;                       /* model).                         */
+static unsigned int    HALOut;
+static unsigned int    HALCount;
+
+static unsigned char  *DMABuffer[CONSOLE_DMA_NUMBER_STRUCTURES]; /* Variables which    */
+static unsigned int    DMALength[CONSOLE_DMA_NUMBER_STRUCTURES]; /* hold the segments  */
+static unsigned int    DMAReceived[CONSOLE_DMA_NUMBER_STRUCTURES]; /* armed on the     */
+static int             DMAArmed[CONSOLE_DMA_NUMBER_STRUCTURES];  /* simulated uDMA and */
+static unsigned int    DMAActive;                   /* the receive FIFO of the UART.   */
+static unsigned char   FIFO[UART_FIFO_SIZE];
+static unsigned int    FIFOCount;
+
+   /* Internal function prototypes.                                     */
+static unsigned long Random(void);
+static void GenerateScript(unsigned long Lines);
+static void AdvanceTime(double Seconds);
+static void CheckLine(char *Line, unsigned int Length, unsigned long CallbackParameter);
+static void HALCharacter(unsigned char Character);
+static void RunInterruptModel(BenchResult_t *Result);
+static void SimStartRx(unsigned int StructureIndex, unsigned char *Buffer, unsigned int Length);
+static unsigned int SimQueryRx(unsigned int StructureIndex);
+static void SimLock(void);
+static void SimUnlock(void);
+static void DrainFIFO(void);
+static void DMACharacter(unsigned char Character);
+static void RunDMAModel(BenchResult_t *Result);
+static void DisplayResult(BenchResult_t *Result);
+
+   /* The following function returns a pseudo random number (xorshift).  */
+static unsigned long Random(void)
+{
+   RandomState ^= (RandomState << 13) & 0xFFFFFFFFUL;
+   RandomState ^= RandomState >> 17;
+   RandomState ^= RandomState << 5;
+   RandomState &= 0xFFFFFFFFUL;
+
+   return(RandomState);
+}
+
+   /* The following function generates the script, random commands of  */
+   /* the console terminated with CR LF (as sent by the test hosts).    */
+static void GenerateScript(unsigned long Lines)
+{
+   unsigned long Index;
+   unsigned long Length;
+   char         *Command;
+
+   Script       = malloc((Lines * 32) + 1);
+   LineOffset   = malloc(sizeof(unsigned long) * (Lines + 1));
+   ScriptLength = 0;
+   NumberLines  = 0;
+
+   for(Index=0;(Script) && (LineOffset) && (Index<Lines);Index++)
+   {
+      Command = CommandList[Random() % NUMBER_COMMANDS];
+      Length  = strlen(Command);
+
+      LineOffset[NumberLines++] = ScriptLength;
+
+      memcpy(&Script[ScriptLength], Command, Length);
+
+      ScriptLength           += Length;
+      Script[ScriptLength++]  = '\r';
+      Script[ScriptLength++]  = '\n';
+   }
+
+   if(LineOffset)
+      LineOffset[NumberLines] = ScriptLength;
+}
+
+   /* The following function advances the simulated time by the         */
+   /* specified amount, the characters of the script that arrive        */
+   /* meanwhile (back to back from the start) are given to the model.   */
+static void AdvanceTime(double Seconds)
+{
+   double EndTime;
+
+   EndTime = SimulatedTime + Seconds;
+
+   while((NextCharacter < ScriptLength) && (((double)NextCharacter * CharacterTime) <= EndTime))
+   {
+      SimulatedTime = (double)NextCharacter * CharacterTime;
+
+      (*CharacterSink)((unsigned char)Script[NextCharacter++]);
+   }
+
+   SimulatedTime = EndTime;
+}
+
+   /* The following function stands in for the interpreter.  It checks  */
+   /* the line against the script (a line that lost characters matches  */
+   /* none) and takes the time of a command.                            */
+static void CheckLine(char *Line, unsigned int Length, unsigned long CallbackParameter)
+{
+   unsigned long Index;
+
+   CurrentResult->Lines++;
+
+   for(Index=ExpectedLine;Index<NumberLines;Index++)
+   {
+      if((Length == (LineOffset[Index + 1] - LineOffset[Index] - 2)) && (!memcmp(Line, &Script[LineOffset[Index]], Length)) && (Line[Length] == '\0'))
+      {
+         CurrentResult->IntactLines++;
+
+         ExpectedLine = Index + 1;
+         break;
+      }
+   }
+
+   AdvanceTime(CommandTime);
+}
+
+   /* The following function is the receive interrupt of the interrupt  */
+   /* model (one per character), the character is moved into the input  */
+   /* buffer of the HAL or lost if it is full.                          */
+static void HALCharacter(unsigned char Character)
+{
+   CurrentResult->Interrupts++;
+
+   if(HALCount < HALBufferSize)
+   {
+      HALBuffer[HALIn] = Character;
+      HALIn            = (HALIn + 1) % HALBufferSize;
+      HALCount++;
+
+      if(HALCount > CurrentResult->MaximumBacklog)
+         CurrentResult->MaximumBacklog = HALCount;
+   }
+   else
+      CurrentResult->LostCharacters++;
+}
+
+   /* The following function runs the interrupt model.  Each pass of the */
+   /* main loop reads the input buffer of the HAL, copies the characters*/
+   /* into the line buffer and runs every complete line.                */
+static void RunInterruptModel(BenchResult_t *Result)
+{
+   char          Line[LINE_BUFFER_SIZE + 1];
+   unsigned int  LineLength;
+   unsigned long Passes;
+   unsigned char Character;
+
+   memset(Result, 0, sizeof(BenchResult_t));
+
+   CurrentResult = Result;
+   CharacterSink = HALCharacter;
+   SimulatedTime = 0;
+   NextCharacter = 0;
+   ExpectedLine  = 0;
+   HALIn         = 0;
+   HALOut        = 0;
+   HALCount      = 0;
+   LineLength    = 0;
+
+   for(Passes=0;(NextCharacter < ScriptLength) || (Passes < 2);)
+   {
+      while(HALCount)
+      {
+         Character = HALBuffer[HALOut];
+         HALOut    = (HALOut + 1) % HALBufferSize;
+         HALCount--;
+
+         if((Character == '\r') || (Character == '\n'))
+         {
+            if(LineLength)
+            {
+               Line[LineLength] = '\0';
+
+               Result->LineCopies++;
+
+               CheckLine(Line, LineLength, 0);
+            }
+
+            LineLength = 0;
+         }
+         else
+         {
+            if(LineLength < LINE_BUFFER_SIZE)
+               Line[LineLength++] = (char)Character;
+         }
+      }
+
+      AdvanceTime(MAIN_LOOP_DELAY);
+
+      if(NextCharacter == ScriptLength)
+         Passes++;
+   }
+
+   Result->ModelName = "Interrupt per character (HAL)";
+   Result->Seconds   = SimulatedTime;
+   Result->Bytes     = ScriptLength;
+}
+
+   /* The following functions are the simulated uDMA port of the DMA     */
+   /* model.                                                            */
+static void SimStartRx(unsigned int StructureIndex, unsigned char *Buffer, unsigned int Length)
+{
+   DMABuffer[StructureIndex]   = Buffer;
+   DMALength[StructureIndex]   = Length;
+   DMAReceived[StructureIndex] = 0;
+   DMAArmed[StructureIndex]    = 1;
+
+   if(!DMAArmed[DMAActive])
+      DMAActive = StructureIndex;
+}
+
+static unsigned int SimQueryRx(unsigned int StructureIndex)
+{
+   return(DMAArmed[StructureIndex]?DMAReceived[StructureIndex]:0);
+}
+
+static void SimLock(void)
+{
+}
+
+static void SimUnlock(void)
+{
+}
+
+   /* The following function moves the characters waiting in the FIFO   */
+   /* into the active segment (as the uDMA does as soon as one is       */
+   /* armed).  A full segment raises the interrupt.                     */
+static void DrainFIFO(void)
+{
+   unsigned int Index;
+
+   while((FIFOCount) && (DMAArmed[DMAActive]))
+   {
+      DMABuffer[DMAActive][DMAReceived[DMAActive]++] = FIFO[0];
+
+      memmove(FIFO, &FIFO[1], --FIFOCount);
+
+      if(DMAReceived[DMAActive] == DMALength[DMAActive])
+      {
+         ConsoleDMA_CountInterrupt();
+
+         Index            = DMAActive;
+         DMAArmed[Index]  = 0;
+         DMAActive       ^= 1;
+
+         ConsoleDMA_RxComplete();
+      }
+   }
+}
+
+   /* The following function receives a character of the DMA model, it  */
+   /* waits in the FIFO (lost if the FIFO is full) until the uDMA moves */
+   /* it.                                                               */
+static void DMACharacter(unsigned char Character)
+{
+   if(FIFOCount < UART_FIFO_SIZE)
+      FIFO[FIFOCount++] = Character;
+   else
+      ConsoleDMA_CountOverrun();
+
+   DrainFIFO();
+}
+
+   /* The following function runs the uDMA model.  Each pass of the main */
+   /* loop runs ConsoleDMA_Process(), which hands the lines to the      */
+   /* interpreter.                                                      */
+static void RunDMAModel(BenchResult_t *Result)
+{
+   static ConsoleDMA_Port_t Port = { SimStartRx, SimQueryRx, NULL, SimLock, SimUnlock };
+
+   unsigned long           Passes;
+   ConsoleDMA_Statistics_t Statistics;
+
+   memset(Result, 0, sizeof(BenchResult_t));
+
+   CurrentResult = Result;
+   CharacterSink = DMACharacter;
+   SimulatedTime = 0;
+   NextCharacter = 0;
+   ExpectedLine  = 0;
+   DMAActive     = 0;
+   FIFOCount     = 0;
+
+   ConsoleDMA_Initialize(&Port, CheckLine, 0);
+
+   for(Passes=0;(NextCharacter < ScriptLength) || (Passes < 2);)
+   {
+      ConsoleDMA_Process();
+
+      DrainFIFO();
+
+      AdvanceTime(MAIN_LOOP_DELAY);
+
+      if(NextCharacter == ScriptLength)
+         Passes++;
+   }
+
+   ConsoleDMA_QueryStatistics(&Statistics);
+
+   Result->ModelName      = "uDMA ring (ConsoleDMA)";
+   Result->Seconds        = SimulatedTime;
+   Result->Bytes          = Statistics.RxBytes;
+   Result->Interrupts     = Statistics.Interrupts;
+   Result->LostCharacters = Statistics.Overruns;
+   Result->LineCopies     = Statistics.WrappedLines;
+   Result->MaximumBacklog = Statistics.MaximumBacklog;
+   Result->Stalls         = Statistics.Stalls;
+}
+
+   /* The following function displays the results of a run.             */
+static void DisplayResult(BenchResult_t *Result)
+{
+   double KBytes = (double)Result->Bytes / 1024.0;
+
+   printf("%s:\n", Result->ModelName);
+   printf("   Bytes received:     %lu\n", Result->Bytes);
+   printf("   Lost characters:    %lu\n", Result->LostCharacters);
+   printf("   Lines intact:       %lu of %lu (%lu handed off)\n", Result->IntactLines, NumberLines, Result->Lines);
+   printf("   Interrupts per KB:  %.2f\n", (KBytes > 0)?((double)Result->Interrupts / KBytes):0.0);
+   printf("   Line copies:        %lu\n", Result->LineCopies);
+   printf("   Maximum backlog:    %lu bytes\n", Result->MaximumBacklog);
+   printf("   Script done after:  %.2f s\n", Result->Seconds);
+}
+
+int main(int argc, char *argv[])
+{
+   int           ret_val;
+   unsigned long Lines;
+   BenchResult_t InterruptResult;
+   BenchResult_t DMAResult;
+
+   Lines         = DEFAULT_NUMBER_LINES;
+   CommandTime   = DEFAULT_COMMAND_TIME / 1000.0;
+   HALBufferSize = DEFAULT_HAL_BUFFER_SIZE;
+
+   if((argc > 1) && (strtoul(argv[1], NULL, 0)))
+      Lines = strtoul(argv[1], NULL, 0);
+
+   if(argc > 2)
+      CommandTime = strtoul(argv[2], NULL, 0) / 1000.0;
+
+   if((argc > 3) && (strtoul(argv[3], NULL, 0)))
+      HALBufferSize = (unsigned int)strtoul(argv[3], NULL, 0);
+
+   CharacterTime = 10.0 / BAUD_RATE;
+   HALBuffer     = malloc(HALBufferSize);
+
+   GenerateScript(Lines);
+
+   if((Script) && (LineOffset) && (HALBuffer))
+   {
+      printf("Script: %lu lines, %lu bytes (%.0f ms on the line), %.0f ms per command\n\n", NumberLines, ScriptLength, ScriptLength * CharacterTime * 1000.0, CommandTime * 1000.0);
+
+      RunInterruptModel(&InterruptResult);
+      DisplayResult(&InterruptResult);
+
+      printf("\n");
+
+      RunDMAModel(&DMAResult);
+      DisplayResult(&DMAResult);
+
+      printf("   Ring stalls:        %lu (%u segments of %u bytes)\n", DMAResult.Stalls, CONSOLE_DMA_NUMBER_SEGMENTS, CONSOLE_DMA_SEGMENT_SIZE);
+
+      ret_val = ((DMAResult.IntactLines == NumberLines) && (!DMAResult.LostCharacters))?0:1;
+   }
+   else
+   {
+      printf("Unable to allocate the script.\n");
+
+      ret_val = 1;
+   }
+
+   return(ret_val);
+}
@@ -0,0 +1,948 @@
+/*****< devicefarm.c >*********************************************************/
+/*                                                                            */
+/*  DeviceFarm - Runs many instances of the application (HFPDemo.c and the    */
+/*               GATT server of NoOS/Main.c) on the host at the same time.   */
+/*                                                                            */
+/*               The application keeps its state in globals, so every         */
+/*               instance is a private copy of the application image (a       */
+/*               shared object of the application and the Bluetopia stand-in, */
+/*               see StandIn.c) that is loaded on its own.  Each instance is  */
+/*               driven by its own simulated controller, which generates the  */
+/*               HCI events and ATT requests of a series of sessions: LE      */
+/*               connections with an MTU exchange and a mix of reads, writes  */
+/*               and write commands on the service of configureGATT(), and    */
+/*               every few sessions an incoming BR/EDR connection.            */
+/*                                                                            */
+/*               The instances are run in slices of a few packets by a pool   */
+/*               of worker threads.  Every worker has its own queue of        */
+/*               instances, an idle worker steals from the other queues.  An  */
+/*               instance is only run by one worker at a time.                */
+/*                                                                            */
+/*               The event throughput, the latency distribution of the        */
+/*               application callbacks and the memory per instance (data and */
+/*               bss of the image and the growth of the resident set) are     */
+/*               reported.                                                    */
+/*                                                                            */
+/*  Build (from this directory):                                              */
+/*                                                                            */
+/*     gcc -O2 -shared -fPIC -Wl,-Bsymbolic -IBluetopia -I.. -I../NoOS        */
+/*         -Dmain=TargetMain -DPEER_CACHE_FLASH_ADDRESS=                      */
+/*         '((uintptr_t)StandIn_Flash)' -DGATT_CLIENT_FLASH_ADDRESS=          */
+/*         '((uintptr_t)StandIn_Flash + 0x400)' -DGATT_DATABASE_FLASH_ADDRESS=*/
+/*         '((uintptr_t)StandIn_Flash + 0xC00)' -o FarmImage.so StandIn.c     */
+/*         ../NoOS/Main.c ../HFPDemo.c ../PeerCache.c ../Recovery.c           */
+/*         ../BootSeq.c ../BTSnoop.c ../Profile.c ../StackMark.c              */
+/*         ../GATTUUID.c ../Advertise.c ../Scan.c ../ConnParam.c              */
+/*         ../GATTClient.c ../GATTDatabase.c ../GATTLong.c ../Sniff.c         */
+/*         ../AudioLink.c ../Coroutine.c ../Metrics.c                         */
+/*     gcc -O2 -IBluetopia -I.. -o DeviceFarm DeviceFarm.c -ldl -lpthread     */
+/*                                                                            */
+/*  Usage: DeviceFarm [-n Instances] [-t Threads] [-s Sessions]               */
+/*                    [-o Operations] [-c Classic Interval] [-i Image]        */
+/*                                                                            */
+/*     -n  Number of instances (default 256).                                 */
+/*     -t  Number of worker threads (default the number of CPUs).             */
+/*     -s  Sessions per instance (default 20).                                */
+/*     -o  ATT operations per LE session (default 16).                        */
+/*     -c  Every n-th session is a BR/EDR connection (default 4, 0 for none). */
+/*     -i  Application image (default ./FarmImage.so).                        */
+/*                                                                            */
+/******************************************************************************/
+#define _GNU_SOURCE        /* dl_iterate_phdr().                              */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <dlfcn.h>
+#include <link.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+#include "StandIn.h"       /* Bluetopia Stand-in Prototypes/Constants.        */
+#include "../Main.h"       /* Application Prototypes.                         */
+#include "../BTSnoop.h"    /* HCI Traffic Capture Prototypes/Constants.       */
+
+#define DEFAULT_INSTANCES                           (256)  /* Denotes the      */
+                                                         /* default number of*/
+                                                         /* instances.       */
+
+#define DEFAULT_SESSIONS                             (20)  /* Denotes the      */
+                                                         /* default number of*/
+                                                         /* sessions of an   */
+                                                         /* instance.        */
+
+#define DEFAULT_OPERATIONS                           (16)  /* Denotes the      */
+                                                         /* default number of*/
+                                                         /* ATT operations of*/
+                                                         /* an LE session.   */
+
+#define DEFAULT_CLASSIC_INTERVAL                      (4)  /* Denotes the      */
+                                                         /* default interval */
+                                                         /* of the BR/EDR    */
+                                                         /* sessions.        */
+
+#define DEFAULT_IMAGE                    "./FarmImage.so"  /* Denotes the      */
+                                                         /* default image.   */
+
+#define SLICE_PACKETS                                 (8)  /* Denotes the      */
+                                                         /* number of packets*/
+                                                         /* an instance is   */
+                                                         /* given per slice. */
+
+#define PACKET_INTERVAL                               (8)  /* Denotes the time */
+                                                         /* (ms) between two */
+                                                         /* packets of an    */
+                                                         /* instance (about  */
+                                                         /* one connection   */
+                                                         /* event).          */
+
+#define MAXIMUM_PACKET_SIZE                          (64)  /* Denotes the size */
+                                                         /* of the generated */
+                                                         /* packets.         */
+
+#define GATT_VALUE_HANDLE                        (0x0009)  /* The following    */
+#define GATT_SNOOP_HANDLE                        (0x000C)  /* constants are the*/
+                                                         /* handles of the   */
+                                                         /* characteristic   */
+                                                         /* values of        */
+                                                         /* configureGATT()  */
+                                                         /* (behind the      */
+                                                         /* Generic Attribute*/
+                                                         /* service of       */
+                                                         /* GATTDatabase.c). */
+
+#define LE_CONNECTION_HANDLE                     (0x0040)  /* The following    */
+#define ACL_CONNECTION_HANDLE                    (0x0001)  /* constants are the*/
+                                                         /* handles of the   */
+                                                         /* simulated links. */
+
+#define HISTOGRAM_SUB_BUCKET_BITS                     (3)  /* Denotes the      */
+                                                         /* resolution of the*/
+                                                         /* latency histogram*/
+                                                         /* (8 buckets per   */
+                                                         /* power of two).   */
+
+#define HISTOGRAM_LINEAR_BUCKETS      (1 << (HISTOGRAM_SUB_BUCKET_BITS + 1))
+#define HISTOGRAM_NUMBER_BUCKETS      (HISTOGRAM_LINEAR_BUCKETS + ((40 - (HISTOGRAM_SUB_BUCKET_BITS + 1)) << HISTOGRAM_SUB_BUCKET_BITS))
+                                                         /* Up to 2^40 ns.   */
+
+   /* The following structure holds the functions of an instance of the */
+   /* application image.                                                */
+typedef struct _tagImageFunctions_t
+{
+   void          (*StandIn_Initialize)(StandIn_Command_Callback_t CommandCallback, unsigned long CallbackParameter);
+   void          (*StandIn_SetDispatchCallback)(StandIn_Dispatch_Callback_t DispatchCallback, unsigned long CallbackParameter);
+   void          (*StandIn_SetVerbose)(Boolean_t Verbose);
+   void          (*StandIn_SetTime)(unsigned long Time);
+   void          (*StandIn_ProcessPacket)(unsigned int Direction, Byte_t PacketType, unsigned int Length, Byte_t *Packet);
+   void          (*BTSnoop_Initialize)(BTSnoop_Timestamp_t TimestampFunction, unsigned int Truncation);
+   int           (*InitializeApplication)(HCI_DriverInformation_t *HCI_DriverInformation, BTPS_Initialization_t *BTPS_Initialization);
+   void          (*configureGATT)(int bluetoothStackID);
+   void          (*Recovery_Process)(void);
+   void          (*PeerCache_Flush)(void);
+} ImageFunctions_t;
+
+   /* The following structure holds a simulated device.                  */
+typedef struct _tagInstance_t
+{
+   unsigned int        Number;
+   void               *Handle;
+   ImageFunctions_t    Functions;
+   unsigned long       ImageMemory;
+   Boolean_t           Initialized;
+   Boolean_t           Failed;
+   unsigned long       Session;
+   unsigned long       Step;
+   unsigned long       Time;
+   unsigned long       RandomState;
+   unsigned long       Packets;
+   unsigned long       Events;
+   unsigned long       Commands;
+   unsigned long long  BusyTime;
+   unsigned long long  MaximumTime;
+   unsigned long       Histogram[HISTOGRAM_NUMBER_BUCKETS];
+} Instance_t;
+
+   /* The following structure holds a worker thread and its queue.  The  */
+   /* owner takes instances from the tail, thieves from the head.       */
+typedef struct _tagWorker_t
+{
+   pthread_t        Thread;
+   pthread_mutex_t  Mutex;
+   Instance_t     **Queue;
+   unsigned long    Head;
+   unsigned long    Tail;
+   unsigned long    RandomState;
+   unsigned long    Slices;
+   unsigned long    Steals;
+} Worker_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static Instance_t         *Instances;               /* Variables which hold  */
+static unsigned int        NumberInstances;         /* the simulated devices.*/
+
+static Worker_t           *Workers;                 /* Variables which hold  */
+static unsigned int        NumberWorkers;           /* the worker threads and*/
+static unsigned int        RemainingInstances;      /* the instances that are*/
+                                                    /* not finished.         */
+
+static unsigned long       NumberSessions;          /* Variables which hold  */
+static unsigned long       NumberOperations;        /* the workload options. */
+static unsigned long       ClassicInterval;
+
+static __thread Instance_t *CurrentInstance;        /* Variable which holds  */
+                                                    /* the instance the      */
+                                                    /* worker is running.    */
+
+   /* Internal function prototypes.                                     */
+static unsigned long Random(unsigned long *State);
+static unsigned int BucketIndex(unsigned long long Time);
+static unsigned long long BucketLimit(unsigned int Index);
+static unsigned long long SnoopTimestamp(void);
+static void CommandCallback(Word_t OpCode, unsigned int ParameterLength, Byte_t *Parameters, unsigned long CallbackParameter);
+static void DispatchCallback(const char *Name, unsigned long long Time, unsigned long CallbackParameter);
+static int FindImageMemory(struct dl_phdr_info *Info, size_t Size, void *Data);
+static int CopyFile(const char *Source, const char *Destination);
+static int LoadInstance(Instance_t *Instance, const char *Image, const char *Directory);
+static unsigned int GeneratePacket(Instance_t *Instance, Byte_t *PacketType, Byte_t *Packet);
+static Boolean_t RunSlice(Instance_t *Instance);
+static Instance_t *TakeInstance(Worker_t *Worker);
+static void *WorkerThread(void *Parameter);
+static unsigned long ResidentSetSize(void);
+static void DisplayResults(FILE *Report, double Seconds, unsigned long BaseResidentSetSize);
+
+   /* The following function returns a pseudo random number (xorshift).  */
+static unsigned long Random(unsigned long *State)
+{
+   *State ^= (*State << 13) & 0xFFFFFFFFUL;
+   *State ^= *State >> 17;
+   *State ^= *State << 5;
+   *State &= 0xFFFFFFFFUL;
+
+   return(*State);
+}
+
+   /* The following function returns the histogram bucket of a latency   */
+   /* (in ns).  Small values have a bucket each, above that every power */
+   /* of two is split in 2^HISTOGRAM_SUB_BUCKET_BITS buckets.           */
+static unsigned int BucketIndex(unsigned long long Time)
+{
+   unsigned int ret_val;
+   unsigned int Exponent;
+
+   if(Time < HISTOGRAM_LINEAR_BUCKETS)
+      ret_val = (unsigned int)Time;
+   else
+   {
+      for(Exponent=HISTOGRAM_SUB_BUCKET_BITS + 1;(Exponent < 63) && (Time >> (Exponent + 1));Exponent++)
+         ;
+
+      ret_val = HISTOGRAM_LINEAR_BUCKETS + ((Exponent - (HISTOGRAM_SUB_BUCKET_BITS + 1)) << HISTOGRAM_SUB_BUCKET_BITS) + (unsigned int)((Time >> (Exponent - HISTOGRAM_SUB_BUCKET_BITS)) & ((1 << HISTOGRAM_SUB_BUCKET_BITS) - 1));
+
+      if(ret_val >= HISTOGRAM_NUMBER_BUCKETS)
+         ret_val = HISTOGRAM_NUMBER_BUCKETS - 1;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the largest latency (in ns) of the  */
+   /* specified histogram bucket.                                       */
+static unsigned long long BucketLimit(unsigned int Index)
+{
+   unsigned long long ret_val;
+   unsigned int       Exponent;
+
+   if(Index < HISTOGRAM_LINEAR_BUCKETS)
+      ret_val = Index;
+   else
+   {
+      Exponent = ((Index - HISTOGRAM_LINEAR_BUCKETS) >> HISTOGRAM_SUB_BUCKET_BITS) + HISTOGRAM_SUB_BUCKET_BITS + 1;
+      ret_val  = (1ULL << Exponent) + ((unsigned long long)((Index - HISTOGRAM_LINEAR_BUCKETS) & ((1 << HISTOGRAM_SUB_BUCKET_BITS) - 1)) << (Exponent - HISTOGRAM_SUB_BUCKET_BITS));
+      ret_val += (1ULL << (Exponent - HISTOGRAM_SUB_BUCKET_BITS)) - 1;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the time stamp of the captured      */
+   /* packets (the simulated time of the instance).                     */
+static unsigned long long SnoopTimestamp(void)
+{
+   return(CurrentInstance?((unsigned long long)CurrentInstance->Time * 1000ULL):0);
+}
+
+   /* The following function counts the HCI commands an instance issues.*/
+static void CommandCallback(Word_t OpCode, unsigned int ParameterLength, Byte_t *Parameters, unsigned long CallbackParameter)
+{
+   ((Instance_t *)CallbackParameter)->Commands++;
+}
+
+   /* The following function records the latency of an application       */
+   /* callback of an instance.                                          */
+static void DispatchCallback(const char *Name, unsigned long long Time, unsigned long CallbackParameter)
+{
+   Instance_t *Instance;
+
+   Instance = (Instance_t *)CallbackParameter;
+
+   Instance->Events++;
+   Instance->BusyTime += Time;
+   Instance->Histogram[BucketIndex(Time)]++;
+
+   if(Time > Instance->MaximumTime)
+      Instance->MaximumTime = Time;
+}
+
+   /* The following function adds the size of the writable segments     */
+   /* (data and bss) of the loaded copy of the image.                   */
+static int FindImageMemory(struct dl_phdr_info *Info, size_t Size, void *Data)
+{
+   int         Index;
+   Instance_t *Instance;
+
+   Instance = (Instance_t *)Data;
+
+   if((Info->dlpi_name) && (strstr(Info->dlpi_name, "/Instance.")) && ((unsigned int)strtoul(strstr(Info->dlpi_name, "/Instance.") + 10, NULL, 10) == Instance->Number))
+   {
+      for(Index=0;Index<Info->dlpi_phnum;Index++)
+      {
+         if((Info->dlpi_phdr[Index].p_type == PT_LOAD) && (Info->dlpi_phdr[Index].p_flags & PF_W))
+            Instance->ImageMemory += Info->dlpi_phdr[Index].p_memsz;
+      }
+   }
+
+   return(0);
+}
+
+   /* The following function copies a file.  This function returns zero */
+   /* if successful or a negative value if the copy failed.             */
+static int CopyFile(const char *Source, const char *Destination)
+{
+   int     ret_val;
+   int     Input;
+   int     Output;
+   char    Buffer[65536];
+   ssize_t Length;
+
+   ret_val = -1;
+
+   if((Input = open(Source, O_RDONLY)) >= 0)
+   {
+      if((Output = open(Destination, O_WRONLY | O_CREAT | O_TRUNC, 0700)) >= 0)
+      {
+         while(((Length = read(Input, Buffer, sizeof(Buffer))) > 0) && (write(Output, Buffer, (size_t)Length) == Length))
+            ;
+
+         if(!Length)
+            ret_val = 0;
+
+         close(Output);
+      }
+
+      close(Input);
+   }
+
+   return(ret_val);
+}
+
+   /* The following function loads a private copy of the image for the   */
+   /* specified instance.  The copy is needed because the loader shares */
+   /* a file that is loaded twice.  This function returns zero if       */
+   /* successful or a negative value if the image could not be loaded.  */
+static int LoadInstance(Instance_t *Instance, const char *Image, const char *Directory)
+{
+   int   ret_val;
+   char  Path[512];
+   void *Handle;
+
+   snprintf(Path, sizeof(Path), "%s/Instance.%u.so", Directory, Instance->Number);
+
+   if(!CopyFile(Image, Path))
+   {
+      if((Handle = dlopen(Path, RTLD_NOW | RTLD_LOCAL)) != NULL)
+      {
+         Instance->Handle = Handle;
+
+         *(void **)&Instance->Functions.StandIn_Initialize          = dlsym(Handle, "StandIn_Initialize");
+         *(void **)&Instance->Functions.StandIn_SetDispatchCallback = dlsym(Handle, "StandIn_SetDispatchCallback");
+         *(void **)&Instance->Functions.StandIn_SetVerbose          = dlsym(Handle, "StandIn_SetVerbose");
+         *(void **)&Instance->Functions.StandIn_SetTime             = dlsym(Handle, "StandIn_SetTime");
+         *(void **)&Instance->Functions.StandIn_ProcessPacket       = dlsym(Handle, "StandIn_ProcessPacket");
+         *(void **)&Instance->Functions.BTSnoop_Initialize          = dlsym(Handle, "BTSnoop_Initialize");
+         *(void **)&Instance->Functions.InitializeApplication       = dlsym(Handle, "InitializeApplication");
+         *(void **)&Instance->Functions.configureGATT               = dlsym(Handle, "configureGATT");
+         *(void **)&Instance->Functions.Recovery_Process            = dlsym(Handle, "Recovery_Process");
+         *(void **)&Instance->Functions.PeerCache_Flush             = dlsym(Handle, "PeerCache_Flush");
+
+         if((Instance->Functions.StandIn_Initialize) && (Instance->Functions.StandIn_SetDispatchCallback) && (Instance->Functions.StandIn_SetVerbose) && (Instance->Functions.StandIn_SetTime) && (Instance->Functions.StandIn_ProcessPacket) && (Instance->Functions.BTSnoop_Initialize) && (Instance->Functions.InitializeApplication) && (Instance->Functions.configureGATT) && (Instance->Functions.Recovery_Process) && (Instance->Functions.PeerCache_Flush))
+         {
+            dl_iterate_phdr(FindImageMemory, Instance);
+
+            ret_val = 0;
+         }
+         else
+         {
+            fprintf(stderr, "%s is not an application image.\n", Image);
+
+            ret_val = -1;
+         }
+      }
+      else
+      {
+         fprintf(stderr, "%s\n", dlerror());
+
+         ret_val = -1;
+      }
+
+      /* The mapping stays valid after the copy is removed.             */
+      unlink(Path);
+   }
+   else
+   {
+      fprintf(stderr, "Unable to copy %s to %s.\n", Image, Path);
+
+      ret_val = -1;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function generates the next packet the simulated     */
+   /* controller of an instance delivers.  This function returns the    */
+   /* length of the packet or zero if all sessions are done.            */
+static unsigned int GeneratePacket(Instance_t *Instance, Byte_t *PacketType, Byte_t *Packet)
+{
+   unsigned int ret_val;
+   unsigned int Kind;
+   Byte_t      *ATT;
+
+   /* Advance to the next session after the disconnection.              */
+   while(Instance->Session < NumberSessions)
+   {
+      if((ClassicInterval) && ((Instance->Session % ClassicInterval) == (ClassicInterval - 1)))
+      {
+         if(Instance->Step < 3)
+            break;
+      }
+      else
+      {
+         if(Instance->Step < (NumberOperations + 3))
+            break;
+      }
+
+      Instance->Session++;
+      Instance->Step = 0;
+   }
+
+   if(Instance->Session == NumberSessions)
+      return(0);
+
+   memset(Packet, 0, MAXIMUM_PACKET_SIZE);
+
+   ret_val     = 0;
+   *PacketType = HCI_EVENT_PACKET;
+
+   if((ClassicInterval) && ((Instance->Session % ClassicInterval) == (ClassicInterval - 1)))
+   {
+      switch(Instance->Step)
+      {
+         case 0:
+            /* Connection Request: BD_ADDR, Class of Device, Link Type. */
+            Packet[0] = 0x04;
+            Packet[1] = 10;
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[2], Instance->Number);
+            Packet[4] = (Byte_t)Instance->Session;
+            Packet[7] = 0x00;
+            Packet[8] = 0x04;
+            Packet[9] = 0x20;
+            Packet[11] = 0x01;
+            ret_val    = 12;
+            break;
+         case 1:
+            /* Connection Complete.                                     */
+            Packet[0] = 0x03;
+            Packet[1] = 11;
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[3], ACL_CONNECTION_HANDLE);
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[5], Instance->Number);
+            Packet[7]  = (Byte_t)Instance->Session;
+            Packet[11] = 0x01;
+            ret_val    = 13;
+            break;
+         default:
+            /* Disconnection Complete (remote user terminated).         */
+            Packet[0] = 0x05;
+            Packet[1] = 4;
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[3], ACL_CONNECTION_HANDLE);
+            Packet[5] = 0x13;
+            ret_val   = 6;
+            break;
+      }
+   }
+   else
+   {
+      if(!Instance->Step)
+      {
+         /* LE Connection Complete (slave, 7.5 ms interval).            */
+         Packet[0] = 0x3E;
+         Packet[1] = 19;
+         Packet[2] = 0x01;
+         ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[4], LE_CONNECTION_HANDLE);
+         Packet[6] = 0x01;
+         ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[8], Instance->Number);
+         Packet[10] = (Byte_t)Instance->Session;
+         Packet[13] = 0xC0;
+         ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[14], 6);
+         ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[18], 200);
+         ret_val = 21;
+      }
+      else
+      {
+         if(Instance->Step == (NumberOperations + 2))
+         {
+            Packet[0] = 0x05;
+            Packet[1] = 4;
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[3], LE_CONNECTION_HANDLE);
+            Packet[5] = 0x13;
+            ret_val   = 6;
+         }
+         else
+         {
+            /* ATT PDU on the fixed channel of the LE link.             */
+            *PacketType = HCI_ACL_PACKET;
+            ATT         = &Packet[8];
+
+            if(Instance->Step == 1)
+            {
+               ATT[0]  = 0x02;
+               ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&ATT[1], 158);
+               ret_val = 3;
+            }
+            else
+            {
+               Kind = (unsigned int)(Random(&Instance->RandomState) % 100);
+
+               if(Kind < 40)
+               {
+                  ATT[0]  = 0x0A;
+                  ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&ATT[1], GATT_VALUE_HANDLE);
+                  ret_val = 3;
+               }
+               else
+               {
+                  if(Kind < 60)
+                  {
+                     ATT[0]  = 0x0A;
+                     ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&ATT[1], GATT_SNOOP_HANDLE);
+                     ret_val = 3;
+                  }
+                  else
+                  {
+                     ATT[0]  = (Byte_t)((Kind < 85)?0x12:0x52);
+                     ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&ATT[1], GATT_VALUE_HANDLE);
+                     ATT[3]  = (Byte_t)Kind;
+                     ret_val = 4;
+                  }
+               }
+            }
+
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[0], LE_CONNECTION_HANDLE | 0x2000);
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[2], ret_val + 4);
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[4], ret_val);
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[6], 0x0004);
+
+            ret_val += 8;
+         }
+      }
+   }
+
+   Instance->Step++;
+
+   return(ret_val);
+}
+
+   /* The following function runs one slice of an instance (initializing */
+   /* it first if needed).  This function returns TRUE if the instance  */
+   /* has more work.                                                    */
+static Boolean_t RunSlice(Instance_t *Instance)
+{
+   int                     StackID;
+   Byte_t                  PacketType;
+   Byte_t                  Packet[MAXIMUM_PACKET_SIZE];
+   Boolean_t               ret_val;
+   unsigned int            Index;
+   unsigned int            Length;
+   BTPS_Initialization_t   BTPSInitialization;
+   HCI_DriverInformation_t DriverInformation;
+
+   CurrentInstance = Instance;
+   ret_val         = TRUE;
+
+   if(!Instance->Initialized)
+   {
+      Instance->Initialized = TRUE;
+
+      (*Instance->Functions.StandIn_Initialize)(CommandCallback, (unsigned long)Instance);
+      (*Instance->Functions.StandIn_SetVerbose)(FALSE);
+      (*Instance->Functions.StandIn_SetDispatchCallback)(DispatchCallback, (unsigned long)Instance);
+      (*Instance->Functions.BTSnoop_Initialize)(SnoopTimestamp, BTSNOOP_DEFAULT_TRUNCATION);
+
+      memset(&BTPSInitialization, 0, sizeof(BTPSInitialization));
+      memset(&DriverInformation, 0, sizeof(DriverInformation));
+
+      if((StackID = (*Instance->Functions.InitializeApplication)(&DriverInformation, &BTPSInitialization)) > 0)
+         (*Instance->Functions.configureGATT)(StackID);
+      else
+      {
+         Instance->Failed = TRUE;
+
+         ret_val = FALSE;
+      }
+   }
+
+   for(Index=0;(ret_val) && (Index<SLICE_PACKETS);Index++)
+   {
+      if((Length = GeneratePacket(Instance, &PacketType, Packet)) != 0)
+      {
+         Instance->Time += PACKET_INTERVAL;
+         Instance->Packets++;
+
+         (*Instance->Functions.StandIn_SetTime)(Instance->Time);
+         (*Instance->Functions.StandIn_ProcessPacket)(BTSNOOP_DIRECTION_RECEIVED, PacketType, Length, Packet);
+
+         /* Give the main loop of the application a pass.               */
+         (*Instance->Functions.Recovery_Process)();
+         (*Instance->Functions.PeerCache_Flush)();
+      }
+      else
+         ret_val = FALSE;
+   }
+
+   CurrentInstance = NULL;
+
+   return(ret_val);
+}
+
+   /* The following function takes the next instance for a worker: the   */
+   /* last one of its own queue, else the first one of the queue of a   */
+   /* random other worker.  This function returns NULL if no instance   */
+   /* was found.                                                        */
+static Instance_t *TakeInstance(Worker_t *Worker)
+{
+   Instance_t   *ret_val;
+   Worker_t     *Victim;
+   unsigned int  Index;
+   unsigned int  First;
+
+   ret_val = NULL;
+
+   pthread_mutex_lock(&Worker->Mutex);
+
+   if(Worker->Head != Worker->Tail)
+      ret_val = Worker->Queue[--Worker->Tail % NumberInstances];
+
+   pthread_mutex_unlock(&Worker->Mutex);
+
+   if((!ret_val) && (NumberWorkers > 1))
+   {
+      First = (unsigned int)(Random(&Worker->RandomState) % NumberWorkers);
+
+      for(Index=0;(!ret_val) && (Index<NumberWorkers);Index++)
+      {
+         Victim = &Workers[(First + Index) % NumberWorkers];
+
+         if(Victim == Worker)
+            continue;
+
+         pthread_mutex_lock(&Victim->Mutex);
+
+         if(Victim->Head != Victim->Tail)
+            ret_val = Victim->Queue[Victim->Head++ % NumberInstances];
+
+         pthread_mutex_unlock(&Victim->Mutex);
+      }
+
+      if(ret_val)
+         Worker->Steals++;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is the main function of a worker thread.   */
+static void *WorkerThread(void *Parameter)
+{
+   Worker_t   *Worker;
+   Instance_t *Instance;
+
+   Worker = (Worker_t *)Parameter;
+
+   while(__atomic_load_n(&RemainingInstances, __ATOMIC_ACQUIRE))
+   {
+      if((Instance = TakeInstance(Worker)) != NULL)
+      {
+         Worker->Slices++;
+
+         if(RunSlice(Instance))
+         {
+            pthread_mutex_lock(&Worker->Mutex);
+
+            Worker->Queue[Worker->Tail++ % NumberInstances] = Instance;
+
+            pthread_mutex_unlock(&Worker->Mutex);
+         }
+         else
+            __atomic_sub_fetch(&RemainingInstances, 1, __ATOMIC_RELEASE);
+      }
+      else
+         sched_yield();
+   }
+
+   return(NULL);
+}
+
+   /* The following function returns the resident set size of the        */
+   /* process (in bytes).                                               */
+static unsigned long ResidentSetSize(void)
+{
+   unsigned long  ret_val;
+   unsigned long  Pages;
+   FILE          *File;
+
+   ret_val = 0;
+
+   if((File = fopen("/proc/self/statm", "r")) != NULL)
+   {
+      if(fscanf(File, "%*u %lu", &Pages) == 1)
+         ret_val = Pages * (unsigned long)sysconf(_SC_PAGESIZE);
+
+      fclose(File);
+   }
+
+   return(ret_val);
+}
+
+   /* The following function displays the results of the run.            */
+static void DisplayResults(FILE *Report, double Seconds, unsigned long BaseResidentSetSize)
+{
+   static const double Percentiles[] = { 50.0, 90.0, 99.0, 99.9, 99.99 };
+
+   unsigned int        Index;
+   unsigned int        Bucket;
+   unsigned int        Failed;
+   unsigned long       Packets;
+   unsigned long       Events;
+   unsigned long       Commands;
+   unsigned long       Count;
+   unsigned long       Target;
+   unsigned long       ImageMemory;
+   unsigned long long  BusyTime;
+   unsigned long long  MaximumTime;
+   unsigned long      *Histogram;
+
+   Histogram   = calloc(HISTOGRAM_NUMBER_BUCKETS, sizeof(unsigned long));
+   Packets     = 0;
+   Events      = 0;
+   Commands    = 0;
+   Failed      = 0;
+   BusyTime    = 0;
+   MaximumTime = 0;
+   ImageMemory = 0;
+
+   for(Index=0;Index<NumberInstances;Index++)
+   {
+      Packets  += Instances[Index].Packets;
+      Events   += Instances[Index].Events;
+      Commands += Instances[Index].Commands;
+      BusyTime += Instances[Index].BusyTime;
+      Failed   += Instances[Index].Failed?1:0;
+
+      if(Instances[Index].MaximumTime > MaximumTime)
+         MaximumTime = Instances[Index].MaximumTime;
+
+      if(Instances[Index].ImageMemory > ImageMemory)
+         ImageMemory = Instances[Index].ImageMemory;
+
+      for(Bucket=0;(Histogram) && (Bucket<HISTOGRAM_NUMBER_BUCKETS);Bucket++)
+         Histogram[Bucket] += Instances[Index].Histogram[Bucket];
+   }
+
+   fprintf(Report, "%u instances on %u threads, %lu sessions of %lu ATT operations each", NumberInstances, NumberWorkers, NumberSessions, NumberOperations);
+
+   if(ClassicInterval)
+      fprintf(Report, " (every %lu. BR/EDR)", ClassicInterval);
+
+   fprintf(Report, ".\n");
+
+   if(Failed)
+      fprintf(Report, "%u instances failed to initialize.\n", Failed);
+
+   fprintf(Report, "\n%lu packets, %lu events, %lu HCI commands in %.3f s\n", Packets, Events, Commands, Seconds);
+   fprintf(Report, "   %.0f events/s in total, %.0f events/s per instance\n", (Seconds > 0)?((double)Events / Seconds):0.0, ((Seconds > 0) && (NumberInstances))?((double)Events / Seconds / (double)NumberInstances):0.0);
+   fprintf(Report, "   %.1f%% of the worker time spent in application callbacks\n\n", ((Seconds > 0) && (NumberWorkers))?(100.0 * ((double)BusyTime / 1e9) / (Seconds * (double)NumberWorkers)):0.0);
+
+   fprintf(Report, "Callback latency (us):");
+
+   for(Index=0;(Histogram) && (Events) && (Index<sizeof(Percentiles)/sizeof(Percentiles[0]));Index++)
+   {
+      Target = (unsigned long)(((double)Events * Percentiles[Index]) / 100.0);
+
+      for(Bucket=0,Count=0;(Bucket<HISTOGRAM_NUMBER_BUCKETS - 1) && ((Count += Histogram[Bucket]) < Target);Bucket++)
+         ;
+
+      fprintf(Report, " p%g %.2f,", Percentiles[Index], (double)BucketLimit(Bucket) / 1000.0);
+   }
+
+   fprintf(Report, " max %.2f\n\n", (double)MaximumTime / 1000.0);
+
+   fprintf(Report, "Memory per instance: %lu bytes data/bss of the image", ImageMemory);
+
+   if((NumberInstances) && (ResidentSetSize() > BaseResidentSetSize))
+      fprintf(Report, ", %lu bytes resident", (ResidentSetSize() - BaseResidentSetSize) / NumberInstances);
+
+   fprintf(Report, "\n\n%-8s %10s %10s\n", "Worker", "Slices", "Steals");
+
+   for(Index=0;Index<NumberWorkers;Index++)
+      fprintf(Report, "%-8u %10lu %10lu\n", Index, Workers[Index].Slices, Workers[Index].Steals);
+
+   free(Histogram);
+}
+
+int main(int argc, char *argv[])
+{
+   int              ret_val;
+   int              Option;
+   char            *Image;
+   char             Directory[] = "/tmp/DeviceFarm.XXXXXX";
+   FILE            *Report;
+   double           Seconds;
+   unsigned int     Index;
+   unsigned long    BaseResidentSetSize;
+   struct timespec  Start;
+   struct timespec  End;
+
+   NumberInstances  = DEFAULT_INSTANCES;
+   NumberWorkers    = (unsigned int)sysconf(_SC_NPROCESSORS_ONLN);
+   NumberSessions   = DEFAULT_SESSIONS;
+   NumberOperations = DEFAULT_OPERATIONS;
+   ClassicInterval  = DEFAULT_CLASSIC_INTERVAL;
+   Image            = DEFAULT_IMAGE;
+
+   while((Option = getopt(argc, argv, "n:t:s:o:c:i:")) != -1)
+   {
+      switch(Option)
+      {
+         case 'n':
+            NumberInstances = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 't':
+            NumberWorkers = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 's':
+            NumberSessions = strtoul(optarg, NULL, 0);
+            break;
+         case 'o':
+            NumberOperations = strtoul(optarg, NULL, 0);
+            break;
+         case 'c':
+            ClassicInterval = strtoul(optarg, NULL, 0);
+            break;
+         case 'i':
+            Image = optarg;
+            break;
+         default:
+            fprintf(stderr, "Usage: %s [-n Instances] [-t Threads] [-s Sessions] [-o Operations] [-c Classic Interval] [-i Image]\n", argv[0]);
+            return(2);
+      }
+   }
+
+   if((!NumberInstances) || (!NumberWorkers))
+   {
+      fprintf(stderr, "At least one instance and one thread are needed.\n");
+      return(2);
+   }
+
+   /* The report goes to the original stdout, the output of the         */
+   /* application is discarded.                                         */
+   if((Report = fdopen(dup(fileno(stdout)), "w")) == NULL)
+      return(2);
+
+   fflush(stdout);
+
+   if(!freopen("/dev/null", "w", stdout))
+      return(2);
+
+   Instances = calloc(NumberInstances, sizeof(Instance_t));
+   Workers   = calloc(NumberWorkers, sizeof(Worker_t));
+
+   if((!Instances) || (!Workers) || (!mkdtemp(Directory)))
+   {
+      fprintf(Report, "Unable to set up the farm.\n");
+      return(2);
+   }
+
+   BaseResidentSetSize = ResidentSetSize();
+   ret_val             = 0;
+
+   for(Index=0;(!ret_val) && (Index<NumberInstances);Index++)
+   {
+      Instances[Index].Number      = Index;
+      Instances[Index].RandomState = 0x2545F491UL + Index;
+
+      if(LoadInstance(&Instances[Index], Image, Directory))
+         ret_val = 2;
+   }
+
+   rmdir(Directory);
+
+   if(!ret_val)
+   {
+      /* Deal the instances to the workers.                             */
+      for(Index=0;Index<NumberWorkers;Index++)
+      {
+         pthread_mutex_init(&Workers[Index].Mutex, NULL);
+
+         Workers[Index].Queue       = calloc(NumberInstances, sizeof(Instance_t *));
+         Workers[Index].RandomState = 0x9E3779B9UL + Index;
+      }
+
+      for(Index=0;Index<NumberInstances;Index++)
+         Workers[Index % NumberWorkers].Queue[Workers[Index % NumberWorkers].Tail++] = &Instances[Index];
+
+      RemainingInstances = NumberInstances;
+
+      clock_gettime(CLOCK_MONOTONIC, &Start);
+
+      for(Index=0;Index<NumberWorkers;Index++)
+         pthread_create(&Workers[Index].Thread, NULL, WorkerThread, &Workers[Index]);
+
+      for(Index=0;Index<NumberWorkers;Index++)
+         pthread_join(Workers[Index].Thread, NULL);
+
+      clock_gettime(CLOCK_MONOTONIC, &End);
+
+      Seconds = (double)(End.tv_sec - Start.tv_sec) + ((double)(End.tv_nsec - Start.tv_nsec) / 1e9);
+
+      DisplayResults(Report, Seconds, BaseResidentSetSize);
+
+      for(Index=0;Index<NumberWorkers;Index++)
+      {
+         pthread_mutex_destroy(&Workers[Index].Mutex);
+         free(Workers[Index].Queue);
+      }
+   }
+
+   fclose(Report);
+
+   free(Workers);
+   free(Instances);
+
+   return(ret_val);
+}
@@ -0,0 +1,1053 @@
+/*****< gattcachebench.c >*****************************************************/
+/*                                                                            */
+/*  GATTCacheBench - Simulated LE servers that load the GATT client           */
+/*                   (GATTClient.c) and its discovery cache on the host.      */
+/*                                                                            */
+/*                   Each peer has its own attribute database (GAP and GATT   */
+/*                   services, a Service Changed characteristic, optionally   */
+/*                   a Database Hash, and a few random 16 and 128-bit         */
+/*                   services).  The peers connect one session after the      */
+/*                   other, a few at a time, and stay connected for a while   */
+/*                   once the client reported their database ready.  The      */
+/*                   database of a peer may change between two sessions (the  */
+/*                   handles move), a subscribed peer then indicates Service  */
+/*                   Changed after the connection.  The requests of the       */
+/*                   client are answered from the database of the peer at     */
+/*                   the next connection event.  The time is simulated, so a  */
+/*                   run with the same options and seed is repeatable.        */
+/*                                                                            */
+/*                   Reported are the discoveries and ATT requests per        */
+/*                   session, the time until the database was ready, the      */
+/*                   lookups that returned a stale handle, and the size of    */
+/*                   the cache and its flash writes.                          */
+/*                                                                            */
+/*  Build (from this directory):                                              */
+/*                                                                            */
+/*     gcc -O2 -IBluetopia -I.. -DGATT_CLIENT_ENABLE                          */
+/*         -DGATT_CLIENT_FLASH_ADDRESS='((uintptr_t)StandIn_Flash + 0x400)'   */
+/*         -o GATTCacheBench GATTCacheBench.c StandIn.c ../GATTClient.c       */
+/*         ../GATTUUID.c ../BTSnoop.c ../Profile.c ../StackMark.c             */
+/*                                                                            */
+/*  Usage: GATTCacheBench [-n Peers] [-l Links] [-e Sessions] [-i Interval]   */
+/*                        [-c Percent] [-h Percent] [-r Sessions] [-x]        */
+/*                        [-s Seed]                                           */
+/*                                                                            */
+/*     -n  Number of peers (default 6).                                       */
+/*     -l  Number of peers connected at the same time (default 2).            */
+/*     -e  Number of sessions (default 500).                                  */
+/*     -i  Connection interval in ms (default 30).                            */
+/*     -c  Percentage of sessions before which the database of the peer       */
+/*         changes (default 5).                                               */
+/*     -h  Percentage of peers with a Database Hash (default 50).             */
+/*     -r  Restart the client (flush, cleanup, initialize) every n sessions   */
+/*         (default 0, never).                                                */
+/*     -x  Clear the cache before each session (no caching).                  */
+/*     -s  Seed of the simulation (default 1).                                */
+/*                                                                            */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "StandIn.h"       /* Bluetopia Stand-in Prototypes/Constants.        */
+#include "../BTSnoop.h"    /* HCI Traffic Capture Prototypes/Constants.       */
+#include "../GATTClient.h" /* GATT Client Prototypes/Constants.               */
+
+#define MAXIMUM_PEERS                              (4096)  /* Denotes the      */
+                                                         /* largest number of*/
+                                                         /* peers.           */
+
+#define MAXIMUM_ATTRIBUTES                           (96)  /* Denotes the      */
+                                                         /* largest database */
+                                                         /* of a peer.       */
+
+#define MAXIMUM_RANDOM_SERVICES                       (4)  /* Denotes the      */
+#define MAXIMUM_RANDOM_CHARACTERISTICS                (5)  /* random part of a */
+                                                         /* database.        */
+
+#define MAXIMUM_QUEUED_PDUS                           (4)  /* Denotes the PDUs */
+                                                         /* a link holds for */
+                                                         /* the next events. */
+
+#define ATT_MTU                                      (23)  /* Denotes the ATT  */
+                                                         /* MTU (the client  */
+                                                         /* does not exchange*/
+                                                         /* it).             */
+
+#define LE_CONNECTION_HANDLE                     (0x0040)  /* Denotes the      */
+                                                         /* handle of the    */
+                                                         /* first link.      */
+
+#define HOLD_TIME                                  (2000)  /* Denotes how long */
+                                                         /* a peer stays     */
+                                                         /* connected once   */
+                                                         /* its database is  */
+                                                         /* ready (ms).      */
+
+#define READY_TIMEOUT                             (30000)  /* Denotes how long */
+                                                         /* the database may */
+                                                         /* take (ms, the ATT*/
+                                                         /* timeout).        */
+
+   /* The following enumerated type represents the kinds of attributes. */
+typedef enum
+{
+   akService,
+   akCharacteristic,
+   akValue,
+   akDescriptor
+} Attribute_Kind_t;
+
+   /* The following structure holds an attribute of a simulated         */
+   /* database.  The UUID is in the order of the air interface, it is   */
+   /* the service UUID of a service, the characteristic UUID of a       */
+   /* declaration and of a value, and the type of a descriptor.  End is */
+   /* the last handle of a service.                                     */
+typedef struct _tagAttribute_t
+{
+   Attribute_Kind_t Kind;
+   Word_t           Handle;
+   Word_t           End;
+   Byte_t           Properties;
+   GATT_UUID_t      UUID;
+} Attribute_t;
+
+   /* The following structure holds a simulated peer.  Version counts   */
+   /* the changes of its database, KnownVersion is the version the      */
+   /* client discovered last (-1 for none).  Subscribed is the Service  */
+   /* Changed configuration the client wrote (kept across sessions, the */
+   /* peer is bonded).                                                  */
+typedef struct _tagPeer_t
+{
+   BD_ADDR_t     BD_ADDR;
+   Boolean_t     Hash;
+   Boolean_t     Connected;
+   Boolean_t     Subscribed;
+   long          Version;
+   long          KnownVersion;
+   Word_t        ServiceChangedHandle;
+   unsigned int  NumberAttributes;
+   Attribute_t   Attributes[MAXIMUM_ATTRIBUTES];
+} Peer_t;
+
+   /* The following structure holds a PDU a link sends at a later event.*/
+typedef struct _tagQueued_PDU_t
+{
+   unsigned int Length;
+   Byte_t       PDU[ATT_MTU];
+} Queued_PDU_t;
+
+   /* The following structure holds a link to a peer.                   */
+typedef struct _tagLink_t
+{
+   Peer_t        *Peer;
+   Word_t         Handle;
+   unsigned long  ConnectTime;
+   unsigned long  ReadyTime;
+   Boolean_t      Ready;
+   unsigned int   NumberQueued;
+   Queued_PDU_t   Queue[MAXIMUM_QUEUED_PDUS];
+} Link_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static Peer_t             *Peers;                   /* Variables which hold  */
+static unsigned int        NumberPeers;             /* the peers and the     */
+static Link_t             *Links;                   /* links.                */
+static unsigned int        NumberLinks;
+
+static unsigned long       RandomState;             /* Variable which holds  */
+                                                    /* the random state.     */
+
+static unsigned long       Time;                    /* Variable which holds  */
+                                                    /* the simulated time.   */
+
+static unsigned int        ChangePercent;           /* Variable which holds  */
+                                                    /* the change option.    */
+
+static unsigned long       Sessions;                /* Variables which hold  */
+static unsigned long       ReadySessions;           /* the results.          */
+static unsigned long       TimedOut;
+static unsigned long       Changes;
+static unsigned long       Requests;
+static unsigned long       Indications;
+static unsigned long       Confirmations;
+static unsigned long       ReadyEvents;
+static unsigned long       CachedReady;
+static unsigned long       StaleReady;
+static unsigned long       Lookups;
+static unsigned long       WrongLookups;
+static unsigned long       Restarts;
+static unsigned long long  ReadyTimeSum;
+static unsigned long       MaximumReadyTime;
+static unsigned long long  CallbackTime;
+static unsigned long       CallbackCount;
+
+   /* Internal function prototypes.                                     */
+static unsigned long Random(void);
+static void CommandCallback(Word_t OpCode, unsigned int ParameterLength, Byte_t *Parameters, unsigned long CallbackParameter);
+static void DispatchCallback(const char *Name, unsigned long long Time, unsigned long CallbackParameter);
+static void BTPSAPI GAP_LE_Event_Callback(unsigned int BluetoothStackID, GAP_LE_Event_Data_t *GAP_LE_Event_Data, unsigned long CallbackParameter);
+static void BTPSAPI GATT_Connection_Event_Callback(unsigned int BluetoothStackID, GATT_Connection_Event_Data_t *GATT_Connection_Event_Data, unsigned long CallbackParameter);
+static void ReadyCallback(unsigned int ConnectionID, BD_ADDR_t BD_ADDR, Boolean_t Cached, unsigned long CallbackParameter);
+static void ResponseCallback(Word_t ConnectionHandle, unsigned int Length, Byte_t *PDU, unsigned long CallbackParameter);
+static void SetUUID16(GATT_UUID_t *UUID, Word_t Value);
+static void SetRandomUUID(GATT_UUID_t *UUID, Word_t Base);
+static unsigned int UUIDSize(GATT_UUID_t *UUID);
+static Attribute_t *AddAttribute(Peer_t *Peer, Attribute_Kind_t Kind, Word_t *Handle, GATT_UUID_t *UUID, Byte_t Properties);
+static void AddCharacteristic(Peer_t *Peer, Word_t *Handle, GATT_UUID_t *UUID, Byte_t Properties);
+static void BuildDatabase(Peer_t *Peer);
+static void AttributeType(Attribute_t *Attribute, GATT_UUID_t *Type);
+static Queued_PDU_t *QueuePDU(Link_t *Link);
+static void QueueError(Link_t *Link, Byte_t OpCode, Word_t Handle, Byte_t ErrorCode);
+static void AnswerReadByGroupType(Link_t *Link, Word_t Start, Word_t End);
+static void AnswerReadByType(Link_t *Link, Word_t Start, Word_t End, Word_t Type);
+static void AnswerFindInformation(Link_t *Link, Word_t Start, Word_t End);
+static void AnswerWrite(Link_t *Link, unsigned int Length, Byte_t *PDU);
+static void DeliverPacket(Byte_t PacketType, unsigned int Length, Byte_t *Packet);
+static void Connect(Link_t *Link, Peer_t *Peer);
+static void Disconnect(Link_t *Link);
+static void DeliverQueued(Link_t *Link);
+
+   /* The following function returns a pseudo random number (xorshift). */
+static unsigned long Random(void)
+{
+   RandomState ^= (RandomState << 13) & 0xFFFFFFFFUL;
+   RandomState ^= RandomState >> 17;
+   RandomState ^= RandomState << 5;
+   RandomState &= 0xFFFFFFFFUL;
+
+   return(RandomState);
+}
+
+   /* The following function receives the HCI commands of the stand-in, */
+   /* the simulated controller ignores them.                            */
+static void CommandCallback(Word_t OpCode, unsigned int ParameterLength, Byte_t *Parameters, unsigned long CallbackParameter)
+{
+}
+
+   /* The following function accounts the host time of the callbacks of */
+   /* the stack.                                                        */
+static void DispatchCallback(const char *Name, unsigned long long Time, unsigned long CallbackParameter)
+{
+   CallbackTime += Time;
+   CallbackCount++;
+}
+
+   /* The following function passes the GAP LE events to the client, as */
+   /* the callback of GAP_LE_Create_Connection() of an application does */
+   /* (the simulated links are connected as the master).                */
+static void BTPSAPI GAP_LE_Event_Callback(unsigned int BluetoothStackID, GAP_LE_Event_Data_t *GAP_LE_Event_Data, unsigned long CallbackParameter)
+{
+   GATTClient_ProcessGAPLEEvent(GAP_LE_Event_Data);
+}
+
+   /* The following function passes the GATT connection events to the   */
+   /* client, as the application does.                                  */
+static void BTPSAPI GATT_Connection_Event_Callback(unsigned int BluetoothStackID, GATT_Connection_Event_Data_t *GATT_Connection_Event_Data, unsigned long CallbackParameter)
+{
+   GATTClient_ProcessGATTConnectionEvent(GATT_Connection_Event_Data);
+}
+
+   /* The following function is the ready callback of the client.  The  */
+   /* database the client reports is checked against the one of the     */
+   /* peer with the lookup of each characteristic.                      */
+static void ReadyCallback(unsigned int ConnectionID, BD_ADDR_t BD_ADDR, Boolean_t Cached, unsigned long CallbackParameter)
+{
+   Byte_t        Properties;
+   Word_t        ValueHandle;
+   Word_t        ConfigurationHandle;
+   Link_t       *Link;
+   Peer_t       *Peer;
+   unsigned int  Index;
+   unsigned int  First;
+   Boolean_t     Stale;
+
+   if((ConnectionID >= LE_CONNECTION_HANDLE) && (ConnectionID < (LE_CONNECTION_HANDLE + NumberLinks)) && ((Peer = (Link = &Links[ConnectionID - LE_CONNECTION_HANDLE])->Peer) != NULL))
+   {
+      ReadyEvents++;
+
+      if(Cached)
+         CachedReady++;
+      else
+         Peer->KnownVersion = Peer->Version;
+
+      if(!Link->Ready)
+      {
+         Link->Ready     = TRUE;
+         Link->ReadyTime = Time;
+
+         ReadySessions++;
+         ReadyTimeSum += Time - Link->ConnectTime;
+
+         if((Time - Link->ConnectTime) > MaximumReadyTime)
+            MaximumReadyTime = Time - Link->ConnectTime;
+      }
+
+      /* A lookup must return the value handle of the first             */
+      /* characteristic with that UUID.                                 */
+      for(Index=0,Stale=FALSE;Index<Peer->NumberAttributes;Index++)
+      {
+         if(Peer->Attributes[Index].Kind != akCharacteristic)
+            continue;
+
+         for(First=0;First<Index;First++)
+         {
+            if((Peer->Attributes[First].Kind == akCharacteristic) && (!memcmp(&Peer->Attributes[First].UUID, &Peer->Attributes[Index].UUID, sizeof(GATT_UUID_t))))
+               break;
+         }
+
+         if(First < Index)
+            continue;
+
+         Lookups++;
+
+         if((GATTClient_FindCharacteristic(ConnectionID, NULL, &Peer->Attributes[Index].UUID, &ValueHandle, &Properties, &ConfigurationHandle)) || (ValueHandle != Peer->Attributes[Index + 1].Handle) || (Properties != Peer->Attributes[Index].Properties))
+         {
+            WrongLookups++;
+
+            Stale = TRUE;
+         }
+      }
+
+      if(Stale)
+         StaleReady++;
+   }
+}
+
+   /* The following function is called by the stand-in with every ATT   */
+   /* PDU the application sends.  The requests of the client are        */
+   /* answered at the next connection event, the confirmation ends the  */
+   /* indication.                                                       */
+static void ResponseCallback(Word_t ConnectionHandle, unsigned int Length, Byte_t *PDU, unsigned long CallbackParameter)
+{
+   Link_t *Link;
+
+   if((Length) && (ConnectionHandle >= LE_CONNECTION_HANDLE) && (ConnectionHandle < (LE_CONNECTION_HANDLE + NumberLinks)) && ((Link = &Links[ConnectionHandle - LE_CONNECTION_HANDLE])->Peer))
+   {
+      if(PDU[0] == 0x1E)
+         Confirmations++;
+      else
+      {
+         Requests++;
+
+         switch(PDU[0])
+         {
+            case 0x10:
+               if(Length >= 7)
+                  AnswerReadByGroupType(Link, READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[1]), READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[3]));
+               break;
+            case 0x08:
+               if(Length >= 7)
+                  AnswerReadByType(Link, READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[1]), READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[3]), READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[5]));
+               break;
+            case 0x04:
+               if(Length >= 5)
+                  AnswerFindInformation(Link, READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[1]), READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[3]));
+               break;
+            case 0x12:
+               AnswerWrite(Link, Length, PDU);
+               break;
+            default:
+               QueueError(Link, PDU[0], 0, 0x06);
+               break;
+         }
+      }
+   }
+}
+
+   /* The following function sets a 16-bit UUID (air interface order).  */
+static void SetUUID16(GATT_UUID_t *UUID, Word_t Value)
+{
+   memset(UUID, 0, sizeof(GATT_UUID_t));
+
+   UUID->UUID_Type = guUUID_16;
+
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&UUID->UUID.UUID_16, Value);
+}
+
+   /* The following function sets a random UUID, half of them are       */
+   /* vendor specific 128-bit UUIDs, the others 16-bit UUIDs from the   */
+   /* specified range.                                                  */
+static void SetRandomUUID(GATT_UUID_t *UUID, Word_t Base)
+{
+   unsigned int  Index;
+   Byte_t       *Bytes;
+
+   if(Random() % 2)
+   {
+      memset(UUID, 0, sizeof(GATT_UUID_t));
+
+      UUID->UUID_Type = guUUID_128;
+      Bytes           = (Byte_t *)&UUID->UUID.UUID_128;
+
+      for(Index=0;Index<sizeof(UUID_128_t);Index++)
+         Bytes[Index] = (Byte_t)Random();
+   }
+   else
+      SetUUID16(UUID, (Word_t)(Base + (Random() % 0xC0)));
+}
+
+   /* The following function returns the size of a UUID on the air.     */
+static unsigned int UUIDSize(GATT_UUID_t *UUID)
+{
+   return((UUID->UUID_Type == guUUID_128)?sizeof(UUID_128_t):sizeof(UUID_16_t));
+}
+
+   /* The following function appends an attribute to the database of a  */
+   /* peer.  This function returns the attribute or NULL if the database*/
+   /* is full.                                                          */
+static Attribute_t *AddAttribute(Peer_t *Peer, Attribute_Kind_t Kind, Word_t *Handle, GATT_UUID_t *UUID, Byte_t Properties)
+{
+   Attribute_t *ret_val = NULL;
+
+   if(Peer->NumberAttributes < MAXIMUM_ATTRIBUTES)
+   {
+      ret_val = &Peer->Attributes[Peer->NumberAttributes++];
+
+      ret_val->Kind       = Kind;
+      ret_val->Handle     = (*Handle)++;
+      ret_val->End        = ret_val->Handle;
+      ret_val->Properties = Properties;
+      ret_val->UUID       = *UUID;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function appends a characteristic (declaration,     */
+   /* value and a configuration descriptor if it notifies or indicates).*/
+static void AddCharacteristic(Peer_t *Peer, Word_t *Handle, GATT_UUID_t *UUID, Byte_t Properties)
+{
+   GATT_UUID_t Descriptor;
+
+   if((Peer->NumberAttributes + 3) <= MAXIMUM_ATTRIBUTES)
+   {
+      AddAttribute(Peer, akCharacteristic, Handle, UUID, Properties);
+      AddAttribute(Peer, akValue, Handle, UUID, Properties);
+
+      if(Properties & 0x30)
+      {
+         SetUUID16(&Descriptor, 0x2902);
+
+         AddAttribute(Peer, akDescriptor, Handle, &Descriptor, 0);
+      }
+   }
+}
+
+   /* The following function builds the database of a peer for its      */
+   /* current version.  The random services start at a random handle,   */
+   /* so a change moves the handles.                                    */
+static void BuildDatabase(Peer_t *Peer)
+{
+   Word_t        Handle;
+   GATT_UUID_t   UUID;
+   Attribute_t  *Service;
+   unsigned int  Index;
+   unsigned int  NumberServices;
+   unsigned int  NumberCharacteristics;
+   Byte_t        Properties;
+
+   static const Byte_t PropertyChoices[] = { 0x02, 0x0A, 0x08, 0x12, 0x22, 0x1A, 0x04 };
+
+   Peer->NumberAttributes = 0;
+   Handle                 = 1;
+
+   SetUUID16(&UUID, 0x1800);
+   Service = AddAttribute(Peer, akService, &Handle, &UUID, 0);
+
+   SetUUID16(&UUID, 0x2A00);
+   AddCharacteristic(Peer, &Handle, &UUID, 0x02);
+   SetUUID16(&UUID, 0x2A01);
+   AddCharacteristic(Peer, &Handle, &UUID, 0x02);
+
+   Service->End = (Word_t)(Handle - 1);
+
+   SetUUID16(&UUID, 0x1801);
+   Service = AddAttribute(Peer, akService, &Handle, &UUID, 0);
+
+   SetUUID16(&UUID, 0x2A05);
+   AddCharacteristic(Peer, &Handle, &UUID, 0x20);
+
+   Peer->ServiceChangedHandle = (Word_t)(Handle - 2);
+
+   if(Peer->Hash)
+   {
+      SetUUID16(&UUID, 0x2B2A);
+      AddCharacteristic(Peer, &Handle, &UUID, 0x02);
+   }
+
+   Service->End = (Word_t)(Handle - 1);
+
+   Handle         = (Word_t)(Handle + (Random() % 16));
+   NumberServices = 1 + (Random() % MAXIMUM_RANDOM_SERVICES);
+
+   for(Index=0;Index<NumberServices;Index++)
+   {
+      SetRandomUUID(&UUID, 0x1810);
+
+      if((Service = AddAttribute(Peer, akService, &Handle, &UUID, 0)) == NULL)
+         break;
+
+      NumberCharacteristics = 1 + (Random() % MAXIMUM_RANDOM_CHARACTERISTICS);
+
+      while(NumberCharacteristics--)
+      {
+         Properties = PropertyChoices[Random() % sizeof(PropertyChoices)];
+
+         SetRandomUUID(&UUID, 0x2A10);
+         AddCharacteristic(Peer, &Handle, &UUID, Properties);
+      }
+
+      Service->End = (Word_t)(Handle - 1);
+   }
+}
+
+   /* The following function returns the attribute type of an attribute.*/
+static void AttributeType(Attribute_t *Attribute, GATT_UUID_t *Type)
+{
+   if(Attribute->Kind == akService)
+      SetUUID16(Type, 0x2800);
+   else
+   {
+      if(Attribute->Kind == akCharacteristic)
+         SetUUID16(Type, 0x2803);
+      else
+         *Type = Attribute->UUID;
+   }
+}
+
+   /* The following function returns the next free PDU of the queue of a*/
+   /* link (NULL if the queue is full).                                 */
+static Queued_PDU_t *QueuePDU(Link_t *Link)
+{
+   Queued_PDU_t *ret_val = NULL;
+
+   if(Link->NumberQueued < MAXIMUM_QUEUED_PDUS)
+      ret_val = &Link->Queue[Link->NumberQueued++];
+
+   return(ret_val);
+}
+
+   /* The following function queues an Error Response.                  */
+static void QueueError(Link_t *Link, Byte_t OpCode, Word_t Handle, Byte_t ErrorCode)
+{
+   Queued_PDU_t *Queued;
+
+   if((Queued = QueuePDU(Link)) != NULL)
+   {
+      Queued->Length = 5;
+      Queued->PDU[0] = 0x01;
+      Queued->PDU[1] = OpCode;
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Queued->PDU[2], Handle);
+      Queued->PDU[4] = ErrorCode;
+   }
+}
+
+   /* The following function answers a Read By Group Type Request (the  */
+   /* primary services in the range with the UUID size of the first).   */
+static void AnswerReadByGroupType(Link_t *Link, Word_t Start, Word_t End)
+{
+   Peer_t       *Peer = Link->Peer;
+   Attribute_t  *Attribute;
+   Queued_PDU_t *Queued;
+   unsigned int  Index;
+   unsigned int  Size;
+
+   for(Index=0,Size=0,Queued=NULL;Index<Peer->NumberAttributes;Index++)
+   {
+      Attribute = &Peer->Attributes[Index];
+
+      if((Attribute->Kind != akService) || (Attribute->Handle < Start) || (Attribute->Handle > End))
+         continue;
+
+      if(!Size)
+      {
+         if((Queued = QueuePDU(Link)) == NULL)
+            return;
+
+         Size           = UUIDSize(&Attribute->UUID);
+         Queued->PDU[0] = 0x11;
+         Queued->PDU[1] = (Byte_t)(4 + Size);
+         Queued->Length = 2;
+      }
+
+      if((UUIDSize(&Attribute->UUID) != Size) || ((Queued->Length + 4 + Size) > ATT_MTU))
+         break;
+
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Queued->PDU[Queued->Length], Attribute->Handle);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Queued->PDU[Queued->Length + 2], Attribute->End);
+      memcpy(&Queued->PDU[Queued->Length + 4], &Attribute->UUID.UUID, Size);
+
+      Queued->Length += 4 + Size;
+   }
+
+   if(!Size)
+      QueueError(Link, 0x10, Start, 0x0A);
+}
+
+   /* The following function answers a Read By Type Request, either the */
+   /* characteristic declarations in the range or the values of a       */
+   /* 16-bit characteristic (the Database Hash is the only one that is  */
+   /* read, the other values are two bytes).                            */
+static void AnswerReadByType(Link_t *Link, Word_t Start, Word_t End, Word_t Type)
+{
+   Peer_t       *Peer = Link->Peer;
+   Attribute_t  *Attribute;
+   Queued_PDU_t *Queued;
+   GATT_UUID_t   UUID;
+   unsigned int  Index;
+   unsigned int  Size;
+   unsigned int  EntrySize;
+
+   SetUUID16(&UUID, Type);
+
+   for(Index=0,EntrySize=0,Queued=NULL;Index<Peer->NumberAttributes;Index++)
+   {
+      Attribute = &Peer->Attributes[Index];
+
+      if((Attribute->Handle < Start) || (Attribute->Handle > End))
+         continue;
+
+      if(Type == 0x2803)
+      {
+         if(Attribute->Kind != akCharacteristic)
+            continue;
+
+         Size = 5 + UUIDSize(&Attribute->UUID);
+      }
+      else
+      {
+         if((Attribute->Kind != akValue) || (memcmp(&Attribute->UUID, &UUID, sizeof(GATT_UUID_t))))
+            continue;
+
+         Size = 2 + ((Type == 0x2B2A)?16:2);
+      }
+
+      if(!EntrySize)
+      {
+         if((Queued = QueuePDU(Link)) == NULL)
+            return;
+
+         EntrySize      = Size;
+         Queued->PDU[0] = 0x09;
+         Queued->PDU[1] = (Byte_t)EntrySize;
+         Queued->Length = 2;
+      }
+
+      if((Size != EntrySize) || ((Queued->Length + Size) > ATT_MTU))
+         break;
+
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Queued->PDU[Queued->Length], Attribute->Handle);
+
+      if(Type == 0x2803)
+      {
+         Queued->PDU[Queued->Length + 2] = Attribute->Properties;
+         ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Queued->PDU[Queued->Length + 3], Attribute->Handle + 1);
+         memcpy(&Queued->PDU[Queued->Length + 5], &Attribute->UUID.UUID, Size - 5);
+      }
+      else
+      {
+         /* The hash follows the version of the database.               */
+         memset(&Queued->PDU[Queued->Length + 2], 0, Size - 2);
+         memcpy(&Queued->PDU[Queued->Length + 2], &Peer->Version, ((Size - 2) < sizeof(Peer->Version))?(Size - 2):sizeof(Peer->Version));
+      }
+
+      Queued->Length += Size;
+   }
+
+   if(!EntrySize)
+      QueueError(Link, 0x08, Start, 0x0A);
+}
+
+   /* The following function answers a Find Information Request.        */
+static void AnswerFindInformation(Link_t *Link, Word_t Start, Word_t End)
+{
+   Peer_t       *Peer = Link->Peer;
+   Queued_PDU_t *Queued;
+   GATT_UUID_t   Type;
+   unsigned int  Index;
+   unsigned int  Size;
+
+   for(Index=0,Size=0,Queued=NULL;Index<Peer->NumberAttributes;Index++)
+   {
+      if((Peer->Attributes[Index].Handle < Start) || (Peer->Attributes[Index].Handle > End))
+         continue;
+
+      AttributeType(&Peer->Attributes[Index], &Type);
+
+      if(!Size)
+      {
+         if((Queued = QueuePDU(Link)) == NULL)
+            return;
+
+         Size           = UUIDSize(&Type);
+         Queued->PDU[0] = 0x05;
+         Queued->PDU[1] = (Byte_t)((Size == sizeof(UUID_16_t))?1:2);
+         Queued->Length = 2;
+      }
+
+      if((UUIDSize(&Type) != Size) || ((Queued->Length + 2 + Size) > ATT_MTU))
+         break;
+
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Queued->PDU[Queued->Length], Peer->Attributes[Index].Handle);
+      memcpy(&Queued->PDU[Queued->Length + 2], &Type.UUID, Size);
+
+      Queued->Length += 2 + Size;
+   }
+
+   if(!Size)
+      QueueError(Link, 0x04, Start, 0x0A);
+}
+
+   /* The following function answers a Write Request, the configuration */
+   /* of Service Changed is remembered.                                 */
+static void AnswerWrite(Link_t *Link, unsigned int Length, Byte_t *PDU)
+{
+   Word_t        Handle;
+   Peer_t       *Peer = Link->Peer;
+   Queued_PDU_t *Queued;
+   unsigned int  Index;
+
+   Handle = (Word_t)((Length >= 3)?READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[1]):0);
+
+   for(Index=0;(Index<Peer->NumberAttributes) && (Peer->Attributes[Index].Handle != Handle);Index++)
+      ;
+
+   if((Index == Peer->NumberAttributes) || (Peer->Attributes[Index].Kind == akService) || (Peer->Attributes[Index].Kind == akCharacteristic))
+      QueueError(Link, 0x12, Handle, 0x01);
+   else
+   {
+      if((Handle == (Peer->ServiceChangedHandle + 1)) && (Length >= 5))
+         Peer->Subscribed = (Boolean_t)((PDU[3] & 0x02)?TRUE:FALSE);
+
+      if((Queued = QueuePDU(Link)) != NULL)
+      {
+         Queued->Length = 1;
+         Queued->PDU[0] = 0x13;
+      }
+   }
+}
+
+   /* The following function passes a packet of the controller to the   */
+   /* stand-in.                                                         */
+static void DeliverPacket(Byte_t PacketType, unsigned int Length, Byte_t *Packet)
+{
+   StandIn_ProcessPacket(BTSNOOP_DIRECTION_RECEIVED, PacketType, Length, Packet);
+}
+
+   /* The following function connects a peer on a link (LE Connection   */
+   /* Complete, the application is master).  A subscribed peer whose    */
+   /* database changed indicates Service Changed after the connection.  */
+static void Connect(Link_t *Link, Peer_t *Peer)
+{
+   Byte_t        Packet[21];
+   Queued_PDU_t *Queued;
+   Boolean_t     Changed;
+
+   Changed = FALSE;
+
+   if((Peer->KnownVersion >= 0) && ((Random() % 100) < ChangePercent))
+   {
+      Peer->Version++;
+
+      BuildDatabase(Peer);
+
+      Changes++;
+      Changed = TRUE;
+   }
+
+   Link->Peer         = Peer;
+   Link->ConnectTime  = Time;
+   Link->ReadyTime    = 0;
+   Link->Ready        = FALSE;
+   Link->NumberQueued = 0;
+   Peer->Connected    = TRUE;
+
+   Sessions++;
+
+   memset(Packet, 0, sizeof(Packet));
+
+   Packet[0] = 0x3E;
+   Packet[1] = 19;
+   Packet[2] = 0x01;
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[4], Link->Handle);
+   Packet[7] = 0x01;
+   memcpy(&Packet[8], &Peer->BD_ADDR, sizeof(BD_ADDR_t));
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[14], 24);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[18], 400);
+
+   DeliverPacket(HCI_EVENT_PACKET, sizeof(Packet), Packet);
+
+   if((Changed) && (Peer->Subscribed) && ((Queued = QueuePDU(Link)) != NULL))
+   {
+      Queued->Length = 7;
+      Queued->PDU[0] = 0x1D;
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Queued->PDU[1], Peer->ServiceChangedHandle);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Queued->PDU[3], 0x0001);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Queued->PDU[5], 0xFFFF);
+
+      Indications++;
+   }
+}
+
+   /* The following function disconnects the peer of a link.            */
+static void Disconnect(Link_t *Link)
+{
+   Byte_t Packet[6];
+
+   Packet[0] = 0x05;
+   Packet[1] = 4;
+   Packet[2] = 0x00;
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[3], Link->Handle);
+   Packet[5] = 0x13;
+
+   DeliverPacket(HCI_EVENT_PACKET, sizeof(Packet), Packet);
+
+   if(!Link->Ready)
+      TimedOut++;
+
+   Link->Peer->Connected = FALSE;
+   Link->Peer            = NULL;
+   Link->NumberQueued    = 0;
+}
+
+   /* The following function delivers the first queued PDU of a link on */
+   /* the fixed ATT channel.                                            */
+static void DeliverQueued(Link_t *Link)
+{
+   Byte_t       Packet[8 + ATT_MTU];
+   Queued_PDU_t PDU;
+
+   if(Link->NumberQueued)
+   {
+      PDU = Link->Queue[0];
+
+      memmove(&Link->Queue[0], &Link->Queue[1], (--Link->NumberQueued) * sizeof(Queued_PDU_t));
+
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[0], Link->Handle | 0x2000);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[2], PDU.Length + 4);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[4], PDU.Length);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Packet[6], 0x0004);
+
+      memcpy(&Packet[8], PDU.PDU, PDU.Length);
+
+      DeliverPacket(HCI_ACL_PACKET, PDU.Length + 8, Packet);
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   int                     Option;
+   double                  Seconds;
+   Link_t                 *Link;
+   Peer_t                 *Peer;
+   unsigned int            Index;
+   unsigned int            Connected;
+   unsigned int            HashPercent;
+   unsigned long           NumberSessions;
+   unsigned long           Interval;
+   unsigned long           RestartPeriod;
+   unsigned long           NextRestart;
+   Boolean_t               NoCache;
+   struct timespec         Start;
+   struct timespec         End;
+   GATTClient_Statistics_t Statistics;
+
+   NumberPeers    = 6;
+   NumberLinks    = 2;
+   NumberSessions = 500;
+   Interval       = 30;
+   ChangePercent  = 5;
+   HashPercent    = 50;
+   RestartPeriod  = 0;
+   NoCache        = FALSE;
+   RandomState    = 1;
+
+   while((Option = getopt(argc, argv, "n:l:e:i:c:h:r:xs:")) != -1)
+   {
+      switch(Option)
+      {
+         case 'n':
+            NumberPeers = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 'l':
+            NumberLinks = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 'e':
+            NumberSessions = strtoul(optarg, NULL, 0);
+            break;
+         case 'i':
+            Interval = strtoul(optarg, NULL, 0);
+            break;
+         case 'c':
+            ChangePercent = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 'h':
+            HashPercent = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 'r':
+            RestartPeriod = strtoul(optarg, NULL, 0);
+            break;
+         case 'x':
+            NoCache = TRUE;
+            break;
+         case 's':
+            RandomState = strtoul(optarg, NULL, 0);
+            break;
+         default:
+            fprintf(stderr, "Usage: %s [-n Peers] [-l Links] [-e Sessions] [-i Interval] [-c Percent] [-h Percent] [-r Sessions] [-x] [-s Seed]\n", argv[0]);
+            return(2);
+      }
+   }
+
+   /* Every link needs a peer that is not connected, connection         */
+   /* intervals range from 7.5 ms to 4 s.                               */
+   if((!NumberPeers) || (NumberPeers > MAXIMUM_PEERS) || (!NumberLinks) || (NumberLinks > GATT_CLIENT_MAXIMUM_LINKS) || (NumberLinks > NumberPeers) || (!NumberSessions) || (Interval < 8) || (Interval > 4000) || (ChangePercent > 100) || (HashPercent > 100) || (!RandomState))
+   {
+      fprintf(stderr, "Invalid options.\n");
+      return(2);
+   }
+
+   Peers = calloc(NumberPeers, sizeof(Peer_t));
+   Links = calloc(NumberLinks, sizeof(Link_t));
+
+   if((!Peers) || (!Links))
+   {
+      fprintf(stderr, "Out of memory.\n");
+      return(2);
+   }
+
+   StandIn_Initialize(CommandCallback, 0);
+   StandIn_SetResponseCallback(ResponseCallback, 0);
+   StandIn_SetDispatchCallback(DispatchCallback, 0);
+   StandIn_SetTime(0);
+
+   GATT_Initialize(STAND_IN_BLUETOOTH_STACK_ID, 0, GATT_Connection_Event_Callback, 0);
+
+   /* The stand-in passes the GAP LE events to this callback.           */
+   GAP_LE_Register_Remote_Authentication(STAND_IN_BLUETOOTH_STACK_ID, GAP_LE_Event_Callback, 0);
+
+   /* The flash of the stand-in starts erased, so does the cache.       */
+   if((GATTClient_Initialize(STAND_IN_BLUETOOTH_STACK_ID, ReadyCallback, 0) < 0) || (GATTClient_Flush() < 0))
+   {
+      fprintf(stderr, "Unable to start the client.\n");
+      return(2);
+   }
+
+   /* Random static addresses, the number of the peer in the low bytes. */
+   for(Index=0;Index<NumberPeers;Index++)
+   {
+      Peer = &Peers[Index];
+
+      ASSIGN_BD_ADDR(Peer->BD_ADDR, 0xC0 | (Random() & 0x3F), (Byte_t)Random(), (Byte_t)Random(), (Byte_t)Random(), (Byte_t)(Index >> 8), (Byte_t)Index);
+
+      Peer->Hash         = (Boolean_t)((Random() % 100) < HashPercent);
+      Peer->KnownVersion = -1;
+
+      BuildDatabase(Peer);
+   }
+
+   for(Index=0;Index<NumberLinks;Index++)
+      Links[Index].Handle = (Word_t)(LE_CONNECTION_HANDLE + Index);
+
+   Time        = 0;
+   NextRestart = RestartPeriod;
+
+   clock_gettime(CLOCK_MONOTONIC, &Start);
+
+   /* One pass is one connection event of all links.                    */
+   do
+   {
+      StandIn_SetTime(Time);
+
+      for(Index=0,Connected=0;Index<NumberLinks;Index++)
+      {
+         Link = &Links[Index];
+
+         if(Link->Peer)
+         {
+            DeliverQueued(Link);
+
+            if(((Link->Ready) && ((Time - Link->ReadyTime) >= HOLD_TIME)) || ((!Link->Ready) && ((Time - Link->ConnectTime) >= READY_TIMEOUT)))
+               Disconnect(Link);
+         }
+
+         if(Link->Peer)
+            Connected++;
+      }
+
+      /* The client is restarted once the links are down, as after a    */
+      /* reset of the target.                                           */
+      if((RestartPeriod) && (Sessions >= NextRestart))
+      {
+         if(!Connected)
+         {
+            GATTClient_Flush();
+            GATTClient_Cleanup();
+            GATTClient_Initialize(STAND_IN_BLUETOOTH_STACK_ID, ReadyCallback, 0);
+
+            Restarts++;
+            NextRestart += RestartPeriod;
+         }
+      }
+      else
+      {
+         for(Index=0;(Index<NumberLinks) && (Sessions < NumberSessions);Index++)
+         {
+            if(!Links[Index].Peer)
+            {
+               while((Peer = &Peers[Random() % NumberPeers])->Connected)
+                  ;
+
+               if(NoCache)
+                  GATTClient_Clear();
+
+               Connect(&Links[Index], Peer);
+
+               Connected++;
+            }
+         }
+      }
+
+      /* The main loop of the application writes the cache back.        */
+      GATTClient_Flush();
+
+      Time += Interval;
+   }
+   while((Connected) || (Sessions < NumberSessions));
+
+   clock_gettime(CLOCK_MONOTONIC, &End);
+
+   Seconds = (double)(End.tv_sec - Start.tv_sec) + ((double)(End.tv_nsec - Start.tv_nsec) / 1e9);
+
+   GATTClient_QueryStatistics(&Statistics);
+
+   printf("%u peers, %u links, %lu sessions, %lu ms interval, %u%% changing, %u%% with hash%s.\n\n", NumberPeers, NumberLinks, Sessions, Interval, ChangePercent, HashPercent, NoCache?", no cache":"");
+
+   printf("%-24s %10lu (%lu timed out)\n", "Sessions", Sessions, TimedOut);
+   printf("%-24s %10lu (%lu indicated)\n", "Database Changes", Changes, Indications);
+   printf("%-24s %10lu (%.2f per session)\n", "Discoveries", Statistics.Discoveries, (double)Statistics.Discoveries / (double)Sessions);
+   printf("%-24s %10lu (%lu hash checks, %lu mismatched)\n", "Cache Hits", Statistics.CacheHits, Statistics.HashChecks, Statistics.HashMismatches);
+   printf("%-24s %10lu (%.1f per session)\n", "ATT Requests", Requests, (double)Requests / (double)Sessions);
+   printf("%-24s %10.1f ms mean, %lu ms worst\n", "Time To Ready", ReadySessions?((double)ReadyTimeSum / (double)ReadySessions):0.0, MaximumReadyTime);
+   printf("%-24s %10lu (%lu from the cache, %lu stale)\n", "Ready", ReadyEvents, CachedReady, StaleReady);
+   printf("%-24s %10lu (%lu wrong)\n", "Lookups", Lookups, WrongLookups);
+   printf("%-24s %10lu (%lu confirmed)\n", "Service Changed", Statistics.ServiceChanged, Confirmations);
+   printf("%-24s %10u peers, %u bytes (%.1f per peer)\n", "Cache", Statistics.Peers, Statistics.CacheBytes, Statistics.Peers?((double)Statistics.CacheBytes / (double)Statistics.Peers):0.0);
+   printf("%-24s %10lu stored, %lu evicted, %lu too large, %lu without hash\n", "Databases", Statistics.Stored, Statistics.Evicted, Statistics.Overflows, Statistics.Unverified);
+   printf("%-24s %10u (%lu restarts)\n", "Flash Writes", Statistics.FlashWrites, Restarts);
+   printf("\n%-24s %10.1f ns per callback\n", "Stack Callbacks", CallbackCount?((double)CallbackTime / (double)CallbackCount):0.0);
+   printf("Host: %.3f s for the run.\n", Seconds);
+
+   GATTClient_Cleanup();
+
+   free(Links);
+   free(Peers);
+
+   return(0);
+}
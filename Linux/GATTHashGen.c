@@ -0,0 +1,552 @@
+/*****< gatthashgen.c >********************************************************/
+/*                                                                            */
+/*  GATTHashGen - Generates GATTHash.h, the Database Hash of the GATT server  */
+/*                (GATTDatabase.c), from the service tables of the            */
+/*                application.                                                */
+/*                                                                            */
+/*                The application sets up its GATT services on the stand-in   */
+/*                stack (configureGATT() of NoOS/Main.c), which passes every  */
+/*                registered table to this tool.  The hash input of each      */
+/*                attribute is taken from GATTDatabase_HashInput() (the       */
+/*                function the target uses for its checksum), the inputs are  */
+/*                concatenated in handle order and hashed with AES-CMAC and a */
+/*                key of zeros (Core 5.1 Vol 3 Part G 7.3).  A service that   */
+/*                was not registered through GATTDatabase_RegisterService()   */
+/*                is an error (it would not be covered by the checksum of the */
+/*                target).                                                    */
+/*                                                                            */
+/*  Build (from this directory):                                              */
+/*                                                                            */
+/*     gcc -c -IBluetopia -I.. -I../NoOS -Dmain=TargetMain -o Main.o          */
+/*         ../NoOS/Main.c                                                     */
+/*     gcc -O2 -IBluetopia -I..                                               */
+/*         -DPEER_CACHE_FLASH_ADDRESS='((uintptr_t)StandIn_Flash)'            */
+/*         -DGATT_CLIENT_FLASH_ADDRESS='((uintptr_t)StandIn_Flash + 0x400)'   */
+/*         -DGATT_DATABASE_FLASH_ADDRESS='((uintptr_t)StandIn_Flash + 0xC00)' */
+/*         -o GATTHashGen GATTHashGen.c Main.o StandIn.c ../HFPDemo.c         */
+/*         ../PeerCache.c ../Recovery.c ../BootSeq.c ../BTSnoop.c             */
+/*         ../Profile.c ../StackMark.c ../GATTUUID.c ../Advertise.c           */
+/*         ../Scan.c ../ConnParam.c ../GATTClient.c ../GATTDatabase.c         */
+/*         ../GATTLong.c ../Sniff.c ../AudioLink.c ../Coroutine.c             */
+/*         ../Metrics.c                                                       */
+/*                                                                            */
+/*  Usage: GATTHashGen [-t] [-c] Header                                       */
+/*                                                                            */
+/*     -t  Check the AES-CMAC implementation against the examples of RFC      */
+/*         4493 first.                                                        */
+/*     -c  Only check that Header is current (exit status 1 if it is not).    */
+/*                                                                            */
+/*  Header is only written if it changed.                                     */
+/*                                                                            */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "StandIn.h"       /* Bluetopia Stand-in Prototypes/Constants.        */
+#include "../GATTDatabase.h" /* GATT Database Prototypes/Constants.           */
+
+#define MAXIMUM_SERVICES                             (16)  /* Denotes the      */
+                                                         /* largest number of */
+                                                         /* services.         */
+
+#define MAXIMUM_HASH_INPUT                         (4096)  /* Denotes the      */
+                                                         /* largest hash      */
+                                                         /* input of all      */
+                                                         /* services.         */
+
+#define MAXIMUM_HEADER_SIZE                        (4096)  /* Denotes the      */
+                                                         /* largest header    */
+                                                         /* that is checked.  */
+
+#define AES_BLOCK_SIZE                               (16)  /* Denotes the AES  */
+#define AES_ROUNDS                                   (10)  /* block size and   */
+                                                         /* the rounds of     */
+                                                         /* AES-128.          */
+
+   /* The following structure holds a registered service.  Its hash     */
+   /* input is at Offset in HashInput.                                  */
+typedef struct _tagService_t
+{
+   Word_t       StartingHandle;
+   unsigned int NumberOfAttributes;
+   unsigned int Offset;
+   unsigned int Length;
+} Service_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static Service_t    Services[MAXIMUM_SERVICES];     /* Variables which hold   */
+static unsigned int NumberServices;                 /* the registered         */
+                                                    /* services.              */
+
+static Byte_t       HashInput[MAXIMUM_HASH_INPUT];  /* Variables which hold   */
+static unsigned int HashInputLength;                /* the hash input in the  */
+                                                    /* order of registration. */
+
+static Boolean_t    Overflow;                       /* Variable which flags   */
+                                                    /* that a limit was hit.  */
+
+static const Byte_t SBox[256] =
+{
+   0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76,
+   0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0,
+   0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15,
+   0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75,
+   0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F, 0x84,
+   0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF,
+   0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8,
+   0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2,
+   0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73,
+   0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB,
+   0xE0, 0x32, 0x3A, 0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79,
+   0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08,
+   0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A,
+   0x70, 0x3E, 0xB5, 0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E,
+   0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF,
+   0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16
+};
+
+   /* The GATT services of the application (NoOS/Main.c).               */
+void configureGATT(int bluetoothStackID);
+
+   /* Internal function prototypes.                                     */
+static void CommandCallback(Word_t OpCode, unsigned int ParameterLength, Byte_t *Parameters, unsigned long CallbackParameter);
+static void ServiceCallback(unsigned int ServiceID, Word_t StartingHandle, unsigned int NumberOfAttributes, GATT_Service_Attribute_Entry_t *ServiceTable, unsigned long CallbackParameter);
+static int CompareServices(const void *Service1, const void *Service2);
+static Byte_t MultiplyByTwo(Byte_t Value);
+static void AESEncrypt(const Byte_t *Key, const Byte_t *Input, Byte_t *Output);
+static void ShiftSubkey(Byte_t *Subkey);
+static void AESCMAC(const Byte_t *Key, const Byte_t *Message, unsigned int Length, Byte_t *MAC);
+static int ParseHex(const char *String, Byte_t *Data, unsigned int MaximumLength);
+static int SelfTest(void);
+static unsigned int FormatHeader(char *Buffer, unsigned int BufferSize, DWord_t Layout, Byte_t *Hash);
+
+   /* The following function receives the HCI commands of the stand-in  */
+   /* (none are expected, the stack is not brought up).                 */
+static void CommandCallback(Word_t OpCode, unsigned int ParameterLength, Byte_t *Parameters, unsigned long CallbackParameter)
+{
+}
+
+   /* The following function collects the hash input of a registered    */
+   /* service.                                                          */
+static void ServiceCallback(unsigned int ServiceID, Word_t StartingHandle, unsigned int NumberOfAttributes, GATT_Service_Attribute_Entry_t *ServiceTable, unsigned long CallbackParameter)
+{
+   Byte_t       Input[GATT_DATABASE_MAXIMUM_HASH_INPUT];
+   unsigned int Index;
+   unsigned int Length;
+   Service_t   *Service;
+
+   if(NumberServices < MAXIMUM_SERVICES)
+   {
+      Service                     = &Services[NumberServices++];
+      Service->StartingHandle     = StartingHandle;
+      Service->NumberOfAttributes = NumberOfAttributes;
+      Service->Offset             = HashInputLength;
+      Service->Length             = 0;
+
+      for(Index=0;Index<NumberOfAttributes;Index++)
+      {
+         Length = GATTDatabase_HashInput((Word_t)(StartingHandle + Index), &ServiceTable[Index], Input);
+
+         if((HashInputLength + Length) <= sizeof(HashInput))
+         {
+            memcpy(&HashInput[HashInputLength], Input, Length);
+
+            HashInputLength += Length;
+            Service->Length += Length;
+         }
+         else
+            Overflow = TRUE;
+      }
+   }
+   else
+      Overflow = TRUE;
+}
+
+   /* The following function orders the services by their handles.      */
+static int CompareServices(const void *Service1, const void *Service2)
+{
+   return((int)((const Service_t *)Service1)->StartingHandle - (int)((const Service_t *)Service2)->StartingHandle);
+}
+
+   /* The following function multiplies a byte by two in the field of   */
+   /* AES.                                                              */
+static Byte_t MultiplyByTwo(Byte_t Value)
+{
+   return((Byte_t)((Value << 1) ^ ((Value & 0x80)?0x1B:0x00)));
+}
+
+   /* The following function encrypts one block with AES-128.  The state*/
+   /* is kept column by column (the order of the block).                */
+static void AESEncrypt(const Byte_t *Key, const Byte_t *Input, Byte_t *Output)
+{
+   Byte_t       RoundKeys[AES_BLOCK_SIZE * (AES_ROUNDS + 1)];
+   Byte_t       State[AES_BLOCK_SIZE];
+   Byte_t       Shifted[AES_BLOCK_SIZE];
+   Byte_t       Word[4];
+   Byte_t       Temp;
+   Byte_t       RoundConstant;
+   unsigned int Round;
+   unsigned int Index;
+   unsigned int Column;
+
+   /* Key expansion.                                                    */
+   memcpy(RoundKeys, Key, AES_BLOCK_SIZE);
+
+   for(Index=AES_BLOCK_SIZE,RoundConstant=0x01;Index<sizeof(RoundKeys);Index+=4)
+   {
+      memcpy(Word, &RoundKeys[Index - 4], sizeof(Word));
+
+      if(!(Index % AES_BLOCK_SIZE))
+      {
+         Temp    = Word[0];
+         Word[0] = (Byte_t)(SBox[Word[1]] ^ RoundConstant);
+         Word[1] = SBox[Word[2]];
+         Word[2] = SBox[Word[3]];
+         Word[3] = SBox[Temp];
+
+         RoundConstant = MultiplyByTwo(RoundConstant);
+      }
+
+      for(Column=0;Column<4;Column++)
+         RoundKeys[Index + Column] = (Byte_t)(RoundKeys[Index + Column - AES_BLOCK_SIZE] ^ Word[Column]);
+   }
+
+   for(Index=0;Index<AES_BLOCK_SIZE;Index++)
+      State[Index] = (Byte_t)(Input[Index] ^ RoundKeys[Index]);
+
+   for(Round=1;Round<=AES_ROUNDS;Round++)
+   {
+      /* SubBytes and ShiftRows (row r moves r columns to the left).    */
+      for(Index=0;Index<AES_BLOCK_SIZE;Index++)
+         Shifted[Index] = SBox[State[(Index + 4 * (Index % 4)) % AES_BLOCK_SIZE]];
+
+      /* MixColumns (not in the last round).                            */
+      for(Column=0;Column<4;Column++)
+      {
+         memcpy(Word, &Shifted[Column * 4], sizeof(Word));
+
+         if(Round < AES_ROUNDS)
+         {
+            Temp                 = (Byte_t)(Word[0] ^ Word[1] ^ Word[2] ^ Word[3]);
+            State[Column * 4]     = (Byte_t)(Word[0] ^ Temp ^ MultiplyByTwo((Byte_t)(Word[0] ^ Word[1])));
+            State[Column * 4 + 1] = (Byte_t)(Word[1] ^ Temp ^ MultiplyByTwo((Byte_t)(Word[1] ^ Word[2])));
+            State[Column * 4 + 2] = (Byte_t)(Word[2] ^ Temp ^ MultiplyByTwo((Byte_t)(Word[2] ^ Word[3])));
+            State[Column * 4 + 3] = (Byte_t)(Word[3] ^ Temp ^ MultiplyByTwo((Byte_t)(Word[3] ^ Word[0])));
+         }
+         else
+            memcpy(&State[Column * 4], Word, sizeof(Word));
+      }
+
+      for(Index=0;Index<AES_BLOCK_SIZE;Index++)
+         State[Index] ^= RoundKeys[Round * AES_BLOCK_SIZE + Index];
+   }
+
+   memcpy(Output, State, AES_BLOCK_SIZE);
+}
+
+   /* The following function derives the next CMAC subkey (a shift to   */
+   /* the left by one bit, the constant is added if the top bit was     */
+   /* set).                                                             */
+static void ShiftSubkey(Byte_t *Subkey)
+{
+   Byte_t       Carry;
+   unsigned int Index;
+
+   Carry = (Byte_t)(Subkey[0] & 0x80);
+
+   for(Index=0;Index<(AES_BLOCK_SIZE - 1);Index++)
+      Subkey[Index] = (Byte_t)((Subkey[Index] << 1) | (Subkey[Index + 1] >> 7));
+
+   Subkey[AES_BLOCK_SIZE - 1] = (Byte_t)((Subkey[AES_BLOCK_SIZE - 1] << 1) ^ (Carry?0x87:0x00));
+}
+
+   /* The following function calculates the AES-CMAC (RFC 4493) of the  */
+   /* specified message.  The MAC is in the order of the RFC (most      */
+   /* significant byte first).                                          */
+static void AESCMAC(const Byte_t *Key, const Byte_t *Message, unsigned int Length, Byte_t *MAC)
+{
+   Byte_t       Subkey[AES_BLOCK_SIZE];
+   Byte_t       Block[AES_BLOCK_SIZE];
+   Byte_t       Chain[AES_BLOCK_SIZE];
+   unsigned int Blocks;
+   unsigned int Index;
+   unsigned int Offset;
+   unsigned int Last;
+
+   memset(Block, 0, sizeof(Block));
+   memset(Chain, 0, sizeof(Chain));
+
+   /* K1 is used for a complete last block, K2 for a padded one.        */
+   AESEncrypt(Key, Block, Subkey);
+   ShiftSubkey(Subkey);
+
+   Blocks = (Length + AES_BLOCK_SIZE - 1)/AES_BLOCK_SIZE;
+
+   if((!Blocks) || (Length % AES_BLOCK_SIZE))
+      ShiftSubkey(Subkey);
+
+   if(!Blocks)
+      Blocks = 1;
+
+   for(Index=0,Offset=0;Index<(Blocks - 1);Index++,Offset+=AES_BLOCK_SIZE)
+   {
+      for(Last=0;Last<AES_BLOCK_SIZE;Last++)
+         Block[Last] = (Byte_t)(Chain[Last] ^ Message[Offset + Last]);
+
+      AESEncrypt(Key, Block, Chain);
+   }
+
+   for(Index=0;Index<AES_BLOCK_SIZE;Index++)
+   {
+      if((Offset + Index) < Length)
+         Block[Index] = Message[Offset + Index];
+      else
+         Block[Index] = (Byte_t)(((Offset + Index) == Length)?0x80:0x00);
+
+      Block[Index] ^= (Byte_t)(Chain[Index] ^ Subkey[Index]);
+   }
+
+   AESEncrypt(Key, Block, MAC);
+}
+
+   /* The following function converts a string of hex digits.  This     */
+   /* function returns the number of bytes or a negative value if the   */
+   /* string is invalid or too long.                                    */
+static int ParseHex(const char *String, Byte_t *Data, unsigned int MaximumLength)
+{
+   int          ret_val = 0;
+   unsigned int Value;
+
+   while((ret_val >= 0) && (*String))
+   {
+      if(((unsigned int)ret_val < MaximumLength) && (sscanf(String, "%2x", &Value) == 1) && (String[1]))
+      {
+         Data[ret_val++]  = (Byte_t)Value;
+         String          += 2;
+      }
+      else
+         ret_val = -1;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function checks the AES-CMAC implementation against */
+   /* the examples of RFC 4493.  This function returns zero if all      */
+   /* match.                                                            */
+static int SelfTest(void)
+{
+   static const char *Vectors[][2] =
+   {
+      { "",                                                                                 "bb1d6929e95937287fa37d129b756746" },
+      { "6bc1bee22e409f96e93d7e117393172a",                                                 "070a16b46b4d4144f79bdd9dd04a287c" },
+      { "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e5130c81c46a35ce411", "dfa66747de9ae63030ca32611497c827" }
+   };
+
+   int          ret_val = 0;
+   int          Length;
+   Byte_t       Key[AES_BLOCK_SIZE];
+   Byte_t       Message[64];
+   Byte_t       Expected[AES_BLOCK_SIZE];
+   Byte_t       MAC[AES_BLOCK_SIZE];
+   unsigned int Index;
+
+   ParseHex("2b7e151628aed2a6abf7158809cf4f3c", Key, sizeof(Key));
+
+   for(Index=0;Index<(sizeof(Vectors)/sizeof(Vectors[0]));Index++)
+   {
+      Length = ParseHex(Vectors[Index][0], Message, sizeof(Message));
+
+      ParseHex(Vectors[Index][1], Expected, sizeof(Expected));
+
+      AESCMAC(Key, Message, (unsigned int)Length, MAC);
+
+      if(memcmp(MAC, Expected, sizeof(MAC)))
+      {
+         fprintf(stderr, "AES-CMAC of example %u (%d bytes) is wrong\n", Index + 1, Length);
+
+         ret_val = -1;
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function formats the header.  The hash is passed in */
+   /* the order of the CMAC and written in the little endian order of   */
+   /* ATT.  This function returns the length of the header.             */
+static unsigned int FormatHeader(char *Buffer, unsigned int BufferSize, DWord_t Layout, Byte_t *Hash)
+{
+   unsigned int Length;
+   unsigned int Index;
+
+   Length = (unsigned int)snprintf(Buffer, BufferSize,
+      "/*****< gatthash.h >***********************************************************/\n"
+      "/*                                                                            */\n"
+      "/*  GATTHash - Database Hash of the GATT server.                              */\n"
+      "/*                                                                            */\n"
+      "/*  Generated by Linux/GATTHashGen.c from the service tables, do not edit.    */\n"
+      "/*  Regenerate it whenever a table changes (the gatthash target of            */\n"
+      "/*  CMakeLists.txt does so before each build).  A stale header is detected    */\n"
+      "/*  at run time (the Database Hash is then not readable).                     */\n"
+      "/*                                                                            */\n"
+      "/******************************************************************************/\n"
+      "#ifndef __GATTHASHH__\n"
+      "#define __GATTHASHH__\n"
+      "\n"
+      "#define GATT_HASH_LAYOUT                   (0x%08lX)  /* Denotes the       */\n"
+      "                                                         /* checksum of the   */\n"
+      "                                                         /* hash input (see   */\n"
+      "                                                         /* GATTDatabase.c).  */\n"
+      "\n"
+      "   /* The following constant is the initializer of the Database Hash    */\n"
+      "   /* (in the little endian order of ATT).                              */\n"
+      "#define GATT_HASH_INITIALIZER                                                   \\\n"
+      "   {", (unsigned long)Layout);
+
+   for(Index=0;(Index<AES_BLOCK_SIZE) && (Length < BufferSize);Index++)
+      Length += (unsigned int)snprintf(&Buffer[Length], BufferSize - Length, "%s0x%02X%s", (Index == 8)?"     ":" ", Hash[AES_BLOCK_SIZE - 1 - Index], (Index == 7)?",                            \\\n":(Index < 15)?",":" }\n");
+
+   if(Length < BufferSize)
+      Length += (unsigned int)snprintf(&Buffer[Length], BufferSize - Length, "\n#endif\n");
+
+   return(Length);
+}
+
+int main(int argc, char *argv[])
+{
+   int                       Option;
+   int                       ret_val = 0;
+   char                      Header[MAXIMUM_HEADER_SIZE];
+   char                      Current[MAXIMUM_HEADER_SIZE];
+   FILE                     *File;
+   Byte_t                    Key[AES_BLOCK_SIZE];
+   Byte_t                    Hash[AES_BLOCK_SIZE];
+   Byte_t                    Input[MAXIMUM_HASH_INPUT];
+   Boolean_t                 Test  = FALSE;
+   Boolean_t                 Check = FALSE;
+   unsigned int              Length;
+   unsigned int              Index;
+   GATTDatabase_Statistics_t Statistics;
+
+   while((Option = getopt(argc, argv, "tc")) != -1)
+   {
+      switch(Option)
+      {
+         case 't':
+            Test = TRUE;
+            break;
+         case 'c':
+            Check = TRUE;
+            break;
+         default:
+            ret_val = 2;
+            break;
+      }
+   }
+
+   if((ret_val) || (optind != (argc - 1)))
+   {
+      fprintf(stderr, "Usage: %s [-t] [-c] Header\n", argv[0]);
+
+      return(2);
+   }
+
+   if((Test) && (SelfTest()))
+      return(1);
+
+   /* The application registers its services as it would on the target, */
+   /* its output is not of interest.                                    */
+   if(!freopen("/dev/null", "w", stdout))
+      fprintf(stderr, "The output of the application is not suppressed\n");
+
+   StandIn_Initialize(CommandCallback, 0);
+   StandIn_SetVerbose(FALSE);
+   StandIn_SetServiceCallback(ServiceCallback, 0);
+
+   configureGATT(STAND_IN_BLUETOOTH_STACK_ID);
+
+   if((GATTDatabase_QueryStatistics(&Statistics)) || (!Statistics.Services) || (Overflow))
+   {
+      fprintf(stderr, "The GATT services could not be collected\n");
+
+      return(1);
+   }
+
+   if(Statistics.Services != NumberServices)
+   {
+      fprintf(stderr, "%u of %u services were not registered through GATTDatabase_RegisterService()\n", NumberServices - Statistics.Services, NumberServices);
+
+      return(1);
+   }
+
+   /* The inputs are concatenated in the order of the handles.          */
+   qsort(Services, NumberServices, sizeof(Service_t), CompareServices);
+
+   for(Index=0,Length=0;Index<NumberServices;Index++)
+   {
+      memcpy(&Input[Length], &HashInput[Services[Index].Offset], Services[Index].Length);
+
+      Length += Services[Index].Length;
+   }
+
+   memset(Key, 0, sizeof(Key));
+
+   AESCMAC(Key, Input, Length, Hash);
+
+   if(FormatHeader(Header, sizeof(Header), Statistics.Layout, Hash) >= sizeof(Header))
+   {
+      fprintf(stderr, "The header does not fit\n");
+
+      return(1);
+   }
+
+   fprintf(stderr, "%u services, %u attributes (0x%04X - 0x%04X), %u bytes hashed\n", NumberServices, Statistics.Attributes, Services[0].StartingHandle, (unsigned int)(Services[NumberServices - 1].StartingHandle + Services[NumberServices - 1].NumberOfAttributes - 1), Length);
+   fprintf(stderr, "Database Hash ");
+
+   for(Index=0;Index<AES_BLOCK_SIZE;Index++)
+      fprintf(stderr, "%02X", Hash[Index]);
+
+   fprintf(stderr, ", layout 0x%08lX\n", (unsigned long)Statistics.Layout);
+
+   /* A header that is current is not rewritten (so the build does not  */
+   /* recompile what includes it).                                      */
+   memset(Current, 0, sizeof(Current));
+
+   if((File = fopen(argv[optind], "rb")) != NULL)
+   {
+      Length = (unsigned int)fread(Current, 1, sizeof(Current) - 1, File);
+
+      fclose(File);
+   }
+
+   if(!strcmp(Current, Header))
+      ret_val = 0;
+   else
+   {
+      if(Check)
+      {
+         fprintf(stderr, "%s is stale\n", argv[optind]);
+
+         ret_val = 1;
+      }
+      else
+      {
+         if(((File = fopen(argv[optind], "wb")) != NULL) && (fputs(Header, File) >= 0) && (!fclose(File)))
+            ret_val = 0;
+         else
+         {
+            fprintf(stderr, "%s could not be written\n", argv[optind]);
+
+            ret_val = 1;
+         }
+      }
+   }
+
+   return(ret_val);
+}
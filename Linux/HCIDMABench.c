@@ -0,0 +1,531 @@
+/*****< hcidmabench.c >********************************************************/
+/*                                                                            */
+/*  HCIDMABench - Host benchmark of the HCI UART transport.  A simulated UART */
+/*                feeds a synthetic H4 stream (events, ACL and SCO data with  */
+/*                idle gaps between bursts) through two receive models:       */
+/*                                                                            */
+/*                   - the interrupt driven model of the SDK HCITRANS.c (one  */
+/*                     interrupt per FIFO threshold, the CPU moves each byte  */
+/*                     into a ring buffer that the main loop delivers).       */
+/*                   - the uDMA ping-pong model of HCIDMA.c (one interrupt    */
+/*                     per filled buffer or idle line).                       */
+/*                                                                            */
+/*                For each model the throughput of the transport code, the    */
+/*                interrupts and CPU byte moves per KB are reported and the   */
+/*                delivered data is checked against the generated stream.     */
+/*                If a file name is given the uDMA model is run a second time */
+/*                with the BTSnoop capture streaming to that file (to measure */
+/*                the capture overhead).                                      */
+/*                                                                            */
+/*  Build (from this directory):                                              */
+/*                                                                            */
+/*     gcc -O2 -I../NoOS -o HCIDMABench HCIDMABench.c BTSnoopFile.c           */
+/*         ../NoOS/HCIDMA.c ../BTSnoop.c ../Metrics.c -lpthread               */
+/*                                                                            */
+/*  Usage: HCIDMABench [Stream Size (KB)] [BTSnoop File]                      */
+/*                                                                            */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "HCIDMA.h"        /* HCI DMA Transport Core Prototypes/Constants.    */
+#include "../BTSnoop.h"    /* HCI Traffic Capture Prototypes/Constants.       */
+#include "BTSnoopFile.h"   /* BTSnoop File Writer Prototypes/Constants.       */
+
+#define DEFAULT_STREAM_SIZE_KB                     (4096)  /* Denotes the      */
+                                                         /* default amount of */
+                                                         /* data that is      */
+                                                         /* streamed.         */
+
+#define UART_FIFO_THRESHOLD                           (8)  /* Denotes the RX   */
+                                                         /* FIFO level that   */
+                                                         /* raises an         */
+                                                         /* interrupt (4/8 of */
+                                                         /* the 16 byte FIFO).*/
+
+#define RING_BUFFER_SIZE                           (1024)  /* Denotes the size */
+                                                         /* of the receive    */
+                                                         /* ring of the       */
+                                                         /* interrupt driven  */
+                                                         /* model.            */
+
+#define MAXIMUM_BURST_PACKETS                         (4)  /* Denotes the max  */
+                                                         /* number of packets */
+                                                         /* sent back to back */
+                                                         /* before the line   */
+                                                         /* goes idle.        */
+
+#define ACL_MAXIMUM_PAYLOAD                        (1021)  /* Denotes the max  */
+                                                         /* ACL payload of the*/
+                                                         /* CC256x.           */
+
+#define SCO_PAYLOAD                                  (60)  /* Denotes the SCO  */
+                                                         /* payload (CVSD at  */
+                                                         /* 64 kbps).         */
+
+   /* The following structure holds the results of a single run.         */
+typedef struct _tagBenchResult_t
+{
+   char          *ModelName;
+   double         Seconds;
+   unsigned long  Bytes;
+   unsigned long  Interrupts;
+   unsigned long  CPUBytes;
+   unsigned long  Deliveries;
+   unsigned long  Packets;
+   unsigned long  IdleLineHandoffs;
+   int            Verified;
+} BenchResult_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static unsigned char  *Stream;                      /* Variables which hold the        */
+static unsigned long   StreamLength;                /* generated H4 stream and the     */
+static unsigned long   StreamPackets;               /* number of packets in it.        */
+
+static unsigned long  *BurstEnd;                    /* Variables which hold the offset */
+static unsigned long   NumberBursts;                /* at which each burst ends (the   */
+                                                    /* line goes idle).                */
+
+static unsigned long   RandomState = 0x2545F491;    /* Variable which holds the state  */
+                                                    /* of the random number generator. */
+
+static unsigned long   VerifyOffset;                /* Variables which are used to     */
+static int             VerifyFailed;                /* check the delivered data against*/
+static unsigned long   DeliveryCount;               /* the stream.                     */
+
+static volatile unsigned char UARTDataRegister;     /* Variable which simulates the    */
+                                                    /* UART data register.             */
+
+static unsigned char   RingBuffer[RING_BUFFER_SIZE]; /* Variables which hold the      */
+static unsigned int    RingIn;                      /* receive ring of the interrupt   */
+static unsigned int    RingOut;                     /* driven model.                   */
+static unsigned int    RingCount;
+
+static unsigned char  *DMABuffer[HCI_DMA_NUMBER_BUFFERS]; /* Variables which hold the */
+static unsigned int    DMALength[HCI_DMA_NUMBER_BUFFERS]; /* buffers that are armed on*/
+static int             DMAArmed[HCI_DMA_NUMBER_BUFFERS];  /* the simulated uDMA.      */
+static unsigned int    DMAActive;
+static unsigned int    DMAReceived;
+
+   /* Internal function prototypes.                                     */
+static unsigned long Random(void);
+static void GenerateStream(unsigned long Size);
+static double Now(void);
+static void VerifyData(unsigned int DataLength, unsigned char *DataBuffer, unsigned long CallbackParameter);
+static void RingDeliver(void);
+static void RunInterruptModel(BenchResult_t *Result);
+static void SimStartRx(unsigned int BufferIndex, unsigned char *Buffer, unsigned int Length);
+static void SimStartTx(unsigned char *Buffer, unsigned int Length);
+static void SimLock(void);
+static void SimUnlock(void);
+static unsigned long long SnoopTimestamp(void);
+static void RunDMAModel(char *ModelName, BenchResult_t *Result);
+static void DisplayResult(BenchResult_t *Result);
+
+   /* The following function returns a pseudo random number (xorshift).  */
+static unsigned long Random(void)
+{
+   RandomState ^= (RandomState << 13) & 0xFFFFFFFFUL;
+   RandomState ^= RandomState >> 17;
+   RandomState ^= RandomState << 5;
+   RandomState &= 0xFFFFFFFFUL;
+
+   return(RandomState);
+}
+
+   /* The following function generates the synthetic H4 stream.  The mix*/
+   /* is roughly that of an HFP/GATT device: mostly SCO audio, some ACL */
+   /* data and events, with the odd HCILL sleep message.                */
+static void GenerateStream(unsigned long Size)
+{
+   unsigned long Kind;
+   unsigned long Length;
+   unsigned long Index;
+   unsigned long BurstPackets;
+
+   Stream       = malloc(Size + ACL_MAXIMUM_PAYLOAD + 8);
+   BurstEnd     = malloc(sizeof(unsigned long) * (Size + 1));
+   StreamLength = 0;
+   BurstPackets = 1 + (Random() % MAXIMUM_BURST_PACKETS);
+
+   while((Stream) && (BurstEnd) && (StreamLength < Size))
+   {
+      Kind = Random() % 100;
+
+      if(Kind < 55)
+      {
+         Stream[StreamLength++] = 0x03;
+         Stream[StreamLength++] = 0x06;
+         Stream[StreamLength++] = 0x00;
+         Stream[StreamLength++] = SCO_PAYLOAD;
+         Length                 = SCO_PAYLOAD;
+      }
+      else
+      {
+         if(Kind < 80)
+         {
+            Length                 = 1 + (Random() % ACL_MAXIMUM_PAYLOAD);
+            Stream[StreamLength++] = 0x02;
+            Stream[StreamLength++] = 0x01;
+            Stream[StreamLength++] = 0x20;
+            Stream[StreamLength++] = (unsigned char)(Length & 0xFF);
+            Stream[StreamLength++] = (unsigned char)(Length >> 8);
+         }
+         else
+         {
+            if(Kind < 99)
+            {
+               Length                 = Random() % 256;
+               Stream[StreamLength++] = 0x04;
+               Stream[StreamLength++] = 0x13;
+               Stream[StreamLength++] = (unsigned char)Length;
+            }
+            else
+            {
+               /* HCILL wake up indication (not a packet).              */
+               Stream[StreamLength++] = 0x32;
+               Length                 = 0;
+               StreamPackets--;
+            }
+         }
+      }
+
+      for(Index=0;Index<Length;Index++)
+         Stream[StreamLength++] = (unsigned char)Random();
+
+      StreamPackets++;
+
+      if(!--BurstPackets)
+      {
+         BurstEnd[NumberBursts++] = StreamLength;
+         BurstPackets             = 1 + (Random() % MAXIMUM_BURST_PACKETS);
+      }
+   }
+
+   if((Stream) && (BurstEnd) && ((!NumberBursts) || (BurstEnd[NumberBursts - 1] != StreamLength)))
+      BurstEnd[NumberBursts++] = StreamLength;
+}
+
+   /* The following function returns the current time in seconds.       */
+static double Now(void)
+{
+   struct timespec TimeSpec;
+
+   clock_gettime(CLOCK_MONOTONIC, &TimeSpec);
+
+   return((double)TimeSpec.tv_sec + ((double)TimeSpec.tv_nsec / 1e9));
+}
+
+   /* The following function stands in for the stack, it checks the     */
+   /* delivered data against the generated stream.                      */
+static void VerifyData(unsigned int DataLength, unsigned char *DataBuffer, unsigned long CallbackParameter)
+{
+   DeliveryCount++;
+
+   if((VerifyOffset + DataLength > StreamLength) || (memcmp(&Stream[VerifyOffset], DataBuffer, DataLength)))
+      VerifyFailed = 1;
+
+   VerifyOffset += DataLength;
+}
+
+   /* The following function is the main loop part of the interrupt      */
+   /* driven model, it delivers the contiguous data in the ring.        */
+static void RingDeliver(void)
+{
+   unsigned int Length;
+
+   while(RingCount)
+   {
+      Length = RING_BUFFER_SIZE - RingOut;
+      if(Length > RingCount)
+         Length = RingCount;
+
+      VerifyData(Length, &RingBuffer[RingOut], 0);
+
+      RingOut    = (RingOut + Length) % RING_BUFFER_SIZE;
+      RingCount -= Length;
+   }
+}
+
+   /* The following function runs the interrupt driven model.  An        */
+   /* interrupt is raised each time the FIFO reaches the threshold and  */
+   /* on the receive timeout at the end of each burst, the handler reads*/
+   /* the FIFO one byte at a time.                                      */
+static void RunInterruptModel(BenchResult_t *Result)
+{
+   unsigned long Offset;
+   unsigned long Burst;
+   unsigned long Count;
+   double        StartTime;
+
+   memset(Result, 0, sizeof(BenchResult_t));
+
+   VerifyOffset  = 0;
+   VerifyFailed  = 0;
+   DeliveryCount = 0;
+   RingIn        = 0;
+   RingOut       = 0;
+   RingCount     = 0;
+   Offset        = 0;
+
+   StartTime = Now();
+
+   for(Burst=0;Burst<NumberBursts;Burst++)
+   {
+      while(Offset < BurstEnd[Burst])
+      {
+         /* Interrupt: drain the FIFO.                                  */
+         Count = BurstEnd[Burst] - Offset;
+         if(Count > UART_FIFO_THRESHOLD)
+            Count = UART_FIFO_THRESHOLD;
+
+         Result->Interrupts++;
+
+         while(Count--)
+         {
+            /* The ring is sized so that the main loop (run once per    */
+            /* burst) always keeps up, as on the target where RTS would */
+            /* otherwise hold off the controller.                       */
+            if(RingCount == RING_BUFFER_SIZE)
+               RingDeliver();
+
+            UARTDataRegister    = Stream[Offset++];
+            RingBuffer[RingIn]  = UARTDataRegister;
+            RingIn              = (RingIn + 1) % RING_BUFFER_SIZE;
+            RingCount++;
+
+            Result->CPUBytes++;
+         }
+      }
+
+      /* Main loop.                                                     */
+      RingDeliver();
+   }
+
+   Result->Seconds    = Now() - StartTime;
+   Result->ModelName  = "Interrupt per FIFO threshold";
+   Result->Bytes      = StreamLength;
+   Result->Deliveries = DeliveryCount;
+   Result->Packets    = StreamPackets;
+   Result->Verified   = ((!VerifyFailed) && (VerifyOffset == StreamLength));
+}
+
+   /* The following functions are the simulated uDMA port of the DMA     */
+   /* model.                                                            */
+static void SimStartRx(unsigned int BufferIndex, unsigned char *Buffer, unsigned int Length)
+{
+   DMABuffer[BufferIndex] = Buffer;
+   DMALength[BufferIndex] = Length;
+   DMAArmed[BufferIndex]  = 1;
+}
+
+static void SimStartTx(unsigned char *Buffer, unsigned int Length)
+{
+}
+
+static void SimLock(void)
+{
+}
+
+static void SimUnlock(void)
+{
+}
+
+   /* The following function returns the capture timestamp (in         */
+   /* microseconds since January 1st 1970).                             */
+static unsigned long long SnoopTimestamp(void)
+{
+   struct timespec TimeSpec;
+
+   clock_gettime(CLOCK_REALTIME, &TimeSpec);
+
+   return(((unsigned long long)TimeSpec.tv_sec * 1000000ULL) + (unsigned long long)(TimeSpec.tv_nsec / 1000));
+}
+
+   /* The following function runs the uDMA model.  The simulated uDMA    */
+   /* fills the active buffer and raises an interrupt when it is full or*/
+   /* when the line goes idle at the end of a burst.  Copies made by the*/
+   /* simulated uDMA are not counted as CPU byte moves.                 */
+static void RunDMAModel(char *ModelName, BenchResult_t *Result)
+{
+   static HCIDMA_Port_t Port = { SimStartRx, SimStartTx, SimLock, SimUnlock };
+
+   unsigned long       Offset;
+   unsigned long       Burst;
+   unsigned int        Count;
+   unsigned int        Index;
+   double              StartTime;
+   HCIDMA_Statistics_t Statistics;
+
+   memset(Result, 0, sizeof(BenchResult_t));
+
+   VerifyOffset  = 0;
+   VerifyFailed  = 0;
+   DeliveryCount = 0;
+   DMAActive     = 0;
+   DMAReceived   = 0;
+   Offset        = 0;
+
+   StartTime = Now();
+
+   HCIDMA_Initialize(&Port, VerifyData, 0);
+
+   for(Burst=0;Burst<NumberBursts;Burst++)
+   {
+      while(Offset < BurstEnd[Burst])
+      {
+         /* With no buffer armed the controller is held off by RTS until*/
+         /* the main loop has delivered a buffer.                       */
+         if(!DMAArmed[DMAActive])
+            HCIDMA_Process();
+
+         Count = DMALength[DMAActive] - DMAReceived;
+         if(Count > BurstEnd[Burst] - Offset)
+            Count = (unsigned int)(BurstEnd[Burst] - Offset);
+
+         memcpy(&(DMABuffer[DMAActive][DMAReceived]), &Stream[Offset], Count);
+
+         Offset      += Count;
+         DMAReceived += Count;
+
+         if(DMAReceived == DMALength[DMAActive])
+         {
+            /* Buffer full interrupt, the uDMA continues on the other   */
+            /* buffer.                                                  */
+            HCIDMA_CountInterrupt();
+
+            Index               = DMAActive;
+            DMAArmed[Index]     = 0;
+            DMAActive          ^= 1;
+            DMAReceived         = 0;
+
+            HCIDMA_RxComplete(Index, DMALength[Index], 0);
+         }
+      }
+
+      /* Receive timeout interrupt, the tail of the burst (at most the  */
+      /* FIFO threshold) is moved by the CPU.                           */
+      if(DMAReceived)
+      {
+         HCIDMA_CountInterrupt();
+
+         Result->CPUBytes += (DMAReceived % UART_FIFO_THRESHOLD);
+
+         Index               = DMAActive;
+         DMAArmed[Index]     = 0;
+         DMAActive          ^= 1;
+
+         HCIDMA_RxComplete(Index, DMAReceived, 1);
+
+         DMAReceived         = 0;
+      }
+
+      /* Main loop.                                                     */
+      HCIDMA_Process();
+
+      BTSnoopFile_Process();
+   }
+
+   Result->Seconds    = Now() - StartTime;
+
+   HCIDMA_QueryStatistics(&Statistics);
+
+   Result->ModelName  = ModelName;
+   Result->Bytes      = Statistics.RxBytes;
+   Result->Interrupts = Statistics.Interrupts;
+   Result->Deliveries = DeliveryCount;
+   Result->Packets    = Statistics.Packets;
+   Result->IdleLineHandoffs = Statistics.IdleLineHandoffs;
+   Result->Verified   = ((!VerifyFailed) && (VerifyOffset == StreamLength) && (Statistics.Packets == StreamPackets) && (!Statistics.FramingErrors));
+
+}
+
+   /* The following function displays the results of a run.             */
+static void DisplayResult(BenchResult_t *Result)
+{
+   double KBytes = (double)Result->Bytes / 1024.0;
+
+   printf("%s:\n", Result->ModelName);
+   printf("   Bytes:              %lu (%lu packets)\n", Result->Bytes, Result->Packets);
+   printf("   Deliveries:         %lu (%lu on idle line)\n", Result->Deliveries, Result->IdleLineHandoffs);
+   printf("   Throughput:         %.1f MB/s\n", (Result->Seconds > 0)?((KBytes / 1024.0) / Result->Seconds):0.0);
+   printf("   Host ns per byte:   %.2f\n", (Result->Bytes)?((Result->Seconds * 1e9) / (double)Result->Bytes):0.0);
+   printf("   Interrupts per KB:  %.2f\n", (KBytes > 0)?((double)Result->Interrupts / KBytes):0.0);
+   printf("   CPU bytes per KB:   %.2f\n", (KBytes > 0)?((double)Result->CPUBytes / KBytes):0.0);
+   printf("   Data verified:      %s\n", Result->Verified?"yes":"NO");
+}
+
+int main(int argc, char *argv[])
+{
+   int                  ret_val;
+   unsigned long        Size;
+   BenchResult_t        InterruptResult;
+   BenchResult_t        DMAResult;
+   BenchResult_t        CaptureResult;
+   BTSnoop_Statistics_t SnoopStatistics;
+
+   Size = DEFAULT_STREAM_SIZE_KB;
+   if(argc > 1)
+      Size = strtoul(argv[1], NULL, 0);
+
+   if(!Size)
+      Size = DEFAULT_STREAM_SIZE_KB;
+
+   GenerateStream(Size * 1024);
+
+   if((Stream) && (BurstEnd))
+   {
+      printf("Stream: %lu bytes, %lu packets, %lu bursts\n\n", StreamLength, StreamPackets, NumberBursts);
+
+      RunInterruptModel(&InterruptResult);
+      DisplayResult(&InterruptResult);
+
+      printf("\n");
+
+      RunDMAModel("uDMA ping-pong", &DMAResult);
+      DisplayResult(&DMAResult);
+
+      if(argc > 2)
+      {
+         BTSnoop_Initialize(SnoopTimestamp, BTSNOOP_DEFAULT_TRUNCATION);
+
+         if(!BTSnoopFile_Open(argv[2]))
+         {
+            printf("\n");
+
+            RunDMAModel("uDMA ping-pong + BTSnoop capture", &CaptureResult);
+
+            BTSnoopFile_Close();
+
+            DisplayResult(&CaptureResult);
+            BTSnoop_QueryStatistics(&SnoopStatistics);
+
+            printf("   Captured packets:   %lu (%lu dropped, %lu overwritten)\n", SnoopStatistics.Packets, SnoopStatistics.DroppedPackets, SnoopStatistics.OverwrittenPackets);
+            printf("   Capture overhead:   %.2f ns per byte\n", ((CaptureResult.Seconds - DMAResult.Seconds) * 1e9) / (double)StreamLength);
+         }
+         else
+            printf("Unable to create %s.\n", argv[2]);
+      }
+
+      if((InterruptResult.Interrupts) && (DMAResult.Interrupts))
+         printf("\nInterrupt reduction: %.1fx\n", (double)InterruptResult.Interrupts / (double)DMAResult.Interrupts);
+
+      ret_val = ((InterruptResult.Verified) && (DMAResult.Verified))?0:1;
+   }
+   else
+   {
+      printf("Unable to allocate the stream.\n");
+
+      ret_val = 1;
+   }
+
+   free(Stream);
+   free(BurstEnd);
+
+   return(ret_val);
+}
@@ -0,0 +1,634 @@
+/*****< hcireplay.c >**********************************************************/
+/*                                                                            */
+/*  HCIReplay - Replays a recorded HCI trace (BTSnoop file) through the       */
+/*              application on the host.  The application (HFPDemo.c and the */
+/*              GATT server of NoOS/Main.c) runs on top of the Bluetopia      */
+/*              stand-in (StandIn.c) which turns the received packets of the  */
+/*              trace into stack events.  The trace is replayed as fast as    */
+/*              possible (or with the recorded timing), the HCI commands of   */
+/*              the application are compared against the recorded ones and   */
+/*              the event rate and the handler latency of each event type are */
+/*              reported.                                                     */
+/*                                                                            */
+/*              Only the commands the stand-in models are compared            */
+/*              (commands of the controller setup, vendor specific commands   */
+/*              and commands of other hosts are skipped) and the parameters   */
+/*              the stand-in cannot know (e.g. paging information of a        */
+/*              previous session) may differ, use -o to compare the opcodes   */
+/*              only.                                                         */
+/*                                                                            */
+/*  Build (from this directory):                                              */
+/*                                                                            */
+/*     gcc -c -IBluetopia -I.. -I../NoOS -Dmain=TargetMain -o Main.o          */
+/*         ../NoOS/Main.c                                                     */
+/*     gcc -O2 -IBluetopia -I.. -DPEER_CACHE_FLASH_ADDRESS=                   */
+/*         '((uintptr_t)StandIn_Flash)' -DGATT_CLIENT_FLASH_ADDRESS=          */
+/*         '((uintptr_t)StandIn_Flash + 0x400)' -DGATT_DATABASE_FLASH_ADDRESS=*/
+/*         '((uintptr_t)StandIn_Flash + 0xC00)' -o HCIReplay HCIReplay.c      */
+/*         StandIn.c Main.o ../HFPDemo.c ../PeerCache.c ../Recovery.c         */
+/*         ../BootSeq.c ../BTSnoop.c ../Profile.c ../StackMark.c              */
+/*         ../GATTUUID.c ../Advertise.c ../Scan.c ../ConnParam.c              */
+/*         ../GATTClient.c ../GATTDatabase.c ../GATTLong.c ../Sniff.c         */
+/*         ../AudioLink.c ../Coroutine.c ../Metrics.c BTSnoopFile.c -lpthread */
+/*                                                                            */
+/*  Add -DPROFILE_ENABLE to both steps for the handler histograms of the      */
+/*  application (shown with -c ms@PROFILE).                                   */
+/*                                                                            */
+/*  Usage: HCIReplay [-r] [-o] [-I] [-v] [-g Handle] [-c [ms@]Command]        */
+/*                   [-S Snoop] File                                          */
+/*                                                                            */
+/*     -r  Replay with the recorded timing (default is as fast as possible).  */
+/*     -o  Compare the opcodes of the commands only.                          */
+/*     -I  Do not compare the commands of the initialization.                 */
+/*     -v  Show the output of the application.                                */
+/*     -g  Handle the GATT services registered without a handle range start   */
+/*         at (the services placed by GATTDatabase.c keep their handles).     */
+/*     -c  Console command to run after the initialization (or when the trace */
+/*         reaches the specified time), may be repeated.                      */
+/*     -S  Write the HCI traffic the application captures (BTSnoop.c, the     */
+/*         commands it issued and the events of the trace) to the BTSnoop     */
+/*         file Snoop.  The file can be opened in Wireshark or replayed.      */
+/*                                                                            */
+/*  The exit code is zero if the commands matched.                            */
+/*                                                                            */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "StandIn.h"       /* Bluetopia Stand-in Prototypes/Constants.        */
+#include "../Main.h"       /* Application Prototypes.                         */
+#include "../Recovery.h"   /* Retry/backoff of failed operations.             */
+#include "../PeerCache.h"  /* Peer paging information cache.                  */
+#include "../BTSnoop.h"    /* HCI Traffic Capture Prototypes/Constants.       */
+#include "BTSnoopFile.h"   /* BTSnoop File Writer Prototypes/Constants.       */
+#include "../Coroutine.h"  /* Coroutine Prototypes/Constants.                 */
+
+#define BTSNOOP_DATALINK_HCI_UNENCAPSULATED        (1001)  /* Denotes the      */
+                                                         /* data link types  */
+#define BTSNOOP_DATALINK_HCI_UART                  (1002)  /* that can be      */
+                                                         /* replayed.        */
+
+#define BTSNOOP_FLAGS_RECEIVED               (0x00000001)  /* The following    */
+#define BTSNOOP_FLAGS_COMMAND_EVENT          (0x00000002)  /* constants are the*/
+                                                         /* flags of a       */
+                                                         /* record.          */
+
+#define MAXIMUM_PACKET_SIZE                        (1100)  /* Denotes the      */
+                                                         /* largest record   */
+                                                         /* that is replayed.*/
+
+#define MAXIMUM_CONSOLE_COMMANDS                     (16)  /* Denotes the      */
+                                                         /* number of -c     */
+                                                         /* options.         */
+
+#define MAXIMUM_REPORTED_MISMATCHES                  (10)  /* Denotes the      */
+                                                         /* number of        */
+                                                         /* command          */
+                                                         /* mismatches that  */
+                                                         /* are listed.      */
+
+#define MAXIMUM_COMMAND_PARAMETERS                  (255)  /* Denotes the size */
+                                                         /* of the parameters*/
+                                                         /* of an HCI        */
+                                                         /* command.         */
+
+   /* The following structure holds an HCI command (recorded or issued).*/
+typedef struct _tagCommand_t
+{
+   unsigned long Time;
+   Word_t        OpCode;
+   unsigned int  ParameterLength;
+   Byte_t        Parameters[MAXIMUM_COMMAND_PARAMETERS];
+} Command_t;
+
+   /* The following structure holds a list of HCI commands.             */
+typedef struct _tagCommandList_t
+{
+   unsigned int  NumberCommands;
+   unsigned int  MaximumCommands;
+   Command_t    *Commands;
+} CommandList_t;
+
+   /* The following structure holds a console command given with -c.    */
+typedef struct _tagConsoleCommand_t
+{
+   Boolean_t      Timed;
+   unsigned long  Time;
+   Boolean_t      Done;
+   char          *Command;
+} ConsoleCommand_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static CommandList_t       RecordedCommands;        /* Variables which hold  */
+static CommandList_t       IssuedCommands;          /* the commands of the   */
+                                                    /* trace and of the      */
+                                                    /* application.          */
+
+static ConsoleCommand_t    ConsoleCommands[MAXIMUM_CONSOLE_COMMANDS]; /* Vars */
+static unsigned int        NumberConsoleCommands;   /* which hold the -c     */
+                                                    /* options.              */
+
+static Boolean_t           InitializationDone;      /* Variable which holds  */
+                                                    /* whether the issued    */
+                                                    /* commands are compared.*/
+
+static Boolean_t           ExcludeInitialization;   /* Variables which hold  */
+static Boolean_t           CompareOpCodesOnly;      /* the options.          */
+static Boolean_t           RealTime;
+static Boolean_t           Verbose;
+static Word_t              GATTStartingHandle;
+static char               *SnoopFileName;
+
+static FILE               *Report;                  /* Variable which holds  */
+                                                    /* the stream the report */
+                                                    /* is written to.        */
+
+   /* The following function registers the GATT service of the         */
+   /* application (NoOS/Main.c).                                        */
+void configureGATT(int bluetoothStackID);
+
+   /* Internal function prototypes.                                     */
+static unsigned long ReadBigEndian32(unsigned char *Data);
+static unsigned long long SnoopTimestamp(void);
+static void AddCommand(CommandList_t *List, unsigned long Time, Word_t OpCode, unsigned int ParameterLength, Byte_t *Parameters);
+static void CommandCallback(Word_t OpCode, unsigned int ParameterLength, Byte_t *Parameters, unsigned long CallbackParameter);
+static void RunConsoleCommands(Boolean_t AfterInitialization, unsigned long Time);
+static void WaitUntil(struct timespec *Start, unsigned long Time);
+static double ElapsedSeconds(struct timespec *Start);
+static unsigned int CompareCommands(void);
+static void DisplayStatistics(unsigned long Packets, double Seconds);
+static int ReplayFile(FILE *File);
+
+   /* The following function reads a big endian 32 bit value (the byte  */
+   /* order of the BTSnoop file).                                       */
+static unsigned long ReadBigEndian32(unsigned char *Data)
+{
+   return(((unsigned long)Data[0] << 24) | ((unsigned long)Data[1] << 16) | ((unsigned long)Data[2] << 8) | (unsigned long)Data[3]);
+}
+
+   /* The following function returns the replay time in microseconds   */
+   /* (the timestamps of the capture of the application).               */
+static unsigned long long SnoopTimestamp(void)
+{
+   return((unsigned long long)StandIn_GetTime() * 1000ULL);
+}
+
+   /* The following function appends a command to the specified list.   */
+static void AddCommand(CommandList_t *List, unsigned long Time, Word_t OpCode, unsigned int ParameterLength, Byte_t *Parameters)
+{
+   Command_t *Commands;
+
+   if(List->NumberCommands == List->MaximumCommands)
+   {
+      if((Commands = (Command_t *)realloc(List->Commands, (List->MaximumCommands + 256) * sizeof(Command_t))) == NULL)
+         return;
+
+      List->Commands         = Commands;
+      List->MaximumCommands += 256;
+   }
+
+   if(ParameterLength > MAXIMUM_COMMAND_PARAMETERS)
+      ParameterLength = MAXIMUM_COMMAND_PARAMETERS;
+
+   List->Commands[List->NumberCommands].Time            = Time;
+   List->Commands[List->NumberCommands].OpCode          = OpCode;
+   List->Commands[List->NumberCommands].ParameterLength = ParameterLength;
+
+   if(ParameterLength)
+      memcpy(List->Commands[List->NumberCommands].Parameters, Parameters, ParameterLength);
+
+   List->NumberCommands++;
+}
+
+   /* The following function is called by the stand-in with every HCI   */
+   /* command of the application.  The command is also captured, so the */
+   /* SNOOP command of the application works as on the target (and -S   */
+   /* writes it to the file).                                           */
+static void CommandCallback(Word_t OpCode, unsigned int ParameterLength, Byte_t *Parameters, unsigned long CallbackParameter)
+{
+   Byte_t Packet[4 + MAXIMUM_COMMAND_PARAMETERS];
+
+   if(ParameterLength > MAXIMUM_COMMAND_PARAMETERS)
+      ParameterLength = MAXIMUM_COMMAND_PARAMETERS;
+
+   Packet[0] = HCI_COMMAND_PACKET;
+   Packet[1] = (Byte_t)OpCode;
+   Packet[2] = (Byte_t)(OpCode >> 8);
+   Packet[3] = (Byte_t)ParameterLength;
+
+   memcpy(&Packet[4], Parameters, ParameterLength);
+
+   BTSnoop_CaptureData(BTSNOOP_DIRECTION_SENT, 4 + ParameterLength, Packet);
+   BTSnoopFile_Process();
+
+   if((InitializationDone) || (!ExcludeInitialization))
+      AddCommand(&IssuedCommands, StandIn_GetTime(), OpCode, ParameterLength, Parameters);
+}
+
+   /* The following function runs the console commands that are due.    */
+static void RunConsoleCommands(Boolean_t AfterInitialization, unsigned long Time)
+{
+   char         Buffer[128];
+   unsigned int Index;
+
+   for(Index=0;Index<NumberConsoleCommands;Index++)
+   {
+      if((!ConsoleCommands[Index].Done) && (((!ConsoleCommands[Index].Timed) && (AfterInitialization)) || ((ConsoleCommands[Index].Timed) && (Time >= ConsoleCommands[Index].Time))))
+      {
+         ConsoleCommands[Index].Done = TRUE;
+
+         /* The command line is tokenized in place.                     */
+         strncpy(Buffer, ConsoleCommands[Index].Command, sizeof(Buffer) - 1);
+         Buffer[sizeof(Buffer) - 1] = '\0';
+
+         if(!ProcessCommandLine(Buffer))
+            fprintf(Report, "Console command \"%s\" was not executed.\n", ConsoleCommands[Index].Command);
+      }
+   }
+}
+
+   /* The following function waits until the specified trace time (in   */
+   /* ms) has passed since the start of the replay.                     */
+static void WaitUntil(struct timespec *Start, unsigned long Time)
+{
+   struct timespec Target;
+
+   Target.tv_sec  = Start->tv_sec + (time_t)(Time / 1000);
+   Target.tv_nsec = Start->tv_nsec + (long)((Time % 1000) * 1000000L);
+
+   if(Target.tv_nsec >= 1000000000L)
+   {
+      Target.tv_sec++;
+      Target.tv_nsec -= 1000000000L;
+   }
+
+   while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &Target, NULL))
+      ;
+}
+
+   /* The following function returns the time (in seconds) since the     */
+   /* specified start.                                                  */
+static double ElapsedSeconds(struct timespec *Start)
+{
+   struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+
+   return((double)(Now.tv_sec - Start->tv_sec) + ((double)(Now.tv_nsec - Start->tv_nsec) / 1e9));
+}
+
+   /* The following function compares the issued commands against the   */
+   /* recorded ones (in order) and lists the first mismatches.  This    */
+   /* function returns the number of mismatches.                        */
+static unsigned int CompareCommands(void)
+{
+   unsigned int  Index;
+   unsigned int  Byte;
+   unsigned int  ret_val = 0;
+   unsigned int  Count;
+   Command_t    *Recorded;
+   Command_t    *Issued;
+
+   Count = (RecordedCommands.NumberCommands > IssuedCommands.NumberCommands)?RecordedCommands.NumberCommands:IssuedCommands.NumberCommands;
+
+   for(Index=0;Index<Count;Index++)
+   {
+      Recorded = (Index < RecordedCommands.NumberCommands)?&RecordedCommands.Commands[Index]:NULL;
+      Issued   = (Index < IssuedCommands.NumberCommands)?&IssuedCommands.Commands[Index]:NULL;
+
+      if((Recorded) && (Issued) && (Recorded->OpCode == Issued->OpCode) && ((CompareOpCodesOnly) || ((Recorded->ParameterLength == Issued->ParameterLength) && (!memcmp(Recorded->Parameters, Issued->Parameters, Recorded->ParameterLength)))))
+         continue;
+
+      if(ret_val++ < MAXIMUM_REPORTED_MISMATCHES)
+      {
+         fprintf(Report, "Command %u:\n", Index + 1);
+
+         if(Recorded)
+         {
+            fprintf(Report, "   Recorded: 0x%04X at %lu ms:", Recorded->OpCode, Recorded->Time);
+
+            for(Byte=0;Byte<Recorded->ParameterLength;Byte++)
+               fprintf(Report, " %02X", Recorded->Parameters[Byte]);
+
+            fprintf(Report, "\n");
+         }
+         else
+            fprintf(Report, "   Recorded: none\n");
+
+         if(Issued)
+         {
+            fprintf(Report, "   Issued:   0x%04X at %lu ms:", Issued->OpCode, Issued->Time);
+
+            for(Byte=0;Byte<Issued->ParameterLength;Byte++)
+               fprintf(Report, " %02X", Issued->Parameters[Byte]);
+
+            fprintf(Report, "\n");
+         }
+         else
+            fprintf(Report, "   Issued:   none\n");
+      }
+   }
+
+   if(ret_val > MAXIMUM_REPORTED_MISMATCHES)
+      fprintf(Report, "(%u more mismatches not shown)\n", ret_val - MAXIMUM_REPORTED_MISMATCHES);
+
+   return(ret_val);
+}
+
+   /* The following function displays the event rate and the handler    */
+   /* latency of each event type.                                       */
+static void DisplayStatistics(unsigned long Packets, double Seconds)
+{
+   unsigned int               Index;
+   unsigned int               NumberEntries;
+   unsigned long              Events;
+   StandIn_Event_Statistics_t Statistics[STAND_IN_MAXIMUM_EVENT_TYPES];
+
+   NumberEntries = StandIn_QueryEventStatistics(STAND_IN_MAXIMUM_EVENT_TYPES, Statistics);
+
+   for(Index=0,Events=0;Index<NumberEntries;Index++)
+      Events += Statistics[Index].Count;
+
+   fprintf(Report, "Replayed %lu packets, %lu events in %.3f s (%.0f events/s)\n\n", Packets, Events, Seconds, (Seconds > 0)?((double)Events / Seconds):0.0);
+
+   fprintf(Report, "%-40s %8s %10s %10s\n", "Event", "Count", "Mean (us)", "Max (us)");
+
+   for(Index=0;Index<NumberEntries;Index++)
+      fprintf(Report, "%-40s %8lu %10.2f %10.2f\n", Statistics[Index].Name, Statistics[Index].Count, ((double)Statistics[Index].TotalTime / (double)Statistics[Index].Count) / 1000.0, (double)Statistics[Index].MaximumTime / 1000.0);
+
+   fprintf(Report, "\n");
+}
+
+   /* The following function replays the records of the specified file   */
+   /* (positioned after the file header).  This function returns the    */
+   /* exit code of the program.                                         */
+static int ReplayFile(FILE *File)
+{
+   int                     ret_val;
+   int                     StackID;
+   Byte_t                  Header[BTSNOOP_RECORD_HEADER_SIZE];
+   Byte_t                  Packet[MAXIMUM_PACKET_SIZE + 1];
+   Byte_t                 *Data;
+   Byte_t                  PacketType;
+   Boolean_t               H4;
+   unsigned int            Length;
+   unsigned int            Direction;
+   unsigned long           Flags;
+   unsigned long           Packets;
+   unsigned long           Time;
+   unsigned long           Mismatches;
+   unsigned long long      Timestamp;
+   unsigned long long      FirstTimestamp;
+   struct timespec         Start;
+   BTPS_Initialization_t   BTPSInitialization;
+   HCI_DriverInformation_t DriverInformation;
+
+   if(fread(Header, 1, BTSNOOP_FILE_HEADER_SIZE, File) != BTSNOOP_FILE_HEADER_SIZE)
+      return(2);
+
+   if((memcmp(Header, "btsnoop", 8)) || (ReadBigEndian32(&Header[8]) != 1))
+   {
+      fprintf(Report, "Not a BTSnoop file.\n");
+
+      return(2);
+   }
+
+   switch(ReadBigEndian32(&Header[12]))
+   {
+      case BTSNOOP_DATALINK_HCI_UART:
+         H4 = TRUE;
+         break;
+      case BTSNOOP_DATALINK_HCI_UNENCAPSULATED:
+         H4 = FALSE;
+         break;
+      default:
+         fprintf(Report, "Unsupported data link type %lu.\n", ReadBigEndian32(&Header[12]));
+         return(2);
+   }
+
+   /* Bring up the application the way the target does.                 */
+   BTSnoop_Initialize(SnoopTimestamp, BTSNOOP_DEFAULT_TRUNCATION);
+
+   if((SnoopFileName) && (BTSnoopFile_Open(SnoopFileName)))
+      fprintf(Report, "Unable to create %s.\n", SnoopFileName);
+
+   memset(&BTPSInitialization, 0, sizeof(BTPSInitialization));
+   memset(&DriverInformation, 0, sizeof(DriverInformation));
+
+   if((StackID = InitializeApplication(&DriverInformation, &BTPSInitialization)) <= 0)
+   {
+      fprintf(Report, "Unable to initialize the application (%d).\n", StackID);
+
+      return(2);
+   }
+
+   configureGATT(StackID);
+
+   RunConsoleCommands(TRUE, 0);
+
+   Packets        = 0;
+   FirstTimestamp = 0;
+
+   clock_gettime(CLOCK_MONOTONIC, &Start);
+
+   while(fread(Header, 1, BTSNOOP_RECORD_HEADER_SIZE, File) == BTSNOOP_RECORD_HEADER_SIZE)
+   {
+      Length    = (unsigned int)ReadBigEndian32(&Header[4]);
+      Flags     = ReadBigEndian32(&Header[8]);
+      Timestamp = ((unsigned long long)ReadBigEndian32(&Header[16]) << 32) | (unsigned long long)ReadBigEndian32(&Header[20]);
+
+      if(Length > MAXIMUM_PACKET_SIZE)
+      {
+         fprintf(Report, "Record %lu is too long (%u bytes).\n", Packets + 1, Length);
+
+         break;
+      }
+
+      if(fread(Packet, 1, Length, File) != Length)
+         break;
+
+      if(!Packets)
+         FirstTimestamp = Timestamp;
+
+      Time      = (unsigned long)((Timestamp - FirstTimestamp) / 1000ULL);
+      Direction = (Flags & BTSNOOP_FLAGS_RECEIVED)?BTSNOOP_DIRECTION_RECEIVED:BTSNOOP_DIRECTION_SENT;
+
+      Packets++;
+
+      if(RealTime)
+         WaitUntil(&Start, Time);
+
+      /* The time never goes back (the application may have delayed).   */
+      if(Time > StandIn_GetTime())
+         StandIn_SetTime(Time);
+
+      RunConsoleCommands(FALSE, Time);
+
+      /* Find the H4 packet type of the record.                          */
+      if(H4)
+      {
+         if(!Length)
+            continue;
+
+         PacketType = Packet[0];
+         Data       = &Packet[1];
+         Length--;
+      }
+      else
+      {
+         if(Flags & BTSNOOP_FLAGS_COMMAND_EVENT)
+            PacketType = (Byte_t)((Direction == BTSNOOP_DIRECTION_SENT)?HCI_COMMAND_PACKET:HCI_EVENT_PACKET);
+         else
+            PacketType = HCI_ACL_PACKET;
+
+         /* Prefix the packet type as in an H4 record.                  */
+         memmove(&Packet[1], Packet, Length);
+
+         Packet[0] = PacketType;
+         Data      = &Packet[1];
+      }
+
+      /* The capture holds the packets of the controller and the        */
+      /* commands the application issues (CommandCallback()), as on the */
+      /* target, the recorded commands are not captured.                */
+      if(Direction == BTSNOOP_DIRECTION_RECEIVED)
+         BTSnoop_CaptureData(Direction, Length + 1, Packet);
+
+      if(PacketType == HCI_COMMAND_PACKET)
+      {
+         /* The commands of the trace are compared, the initialization  */
+         /* ends with the first event that is not a command response.   */
+         if((Length >= 3) && (StandIn_IsModeledCommand(READ_UNALIGNED_WORD_LITTLE_ENDIAN(Data))) && ((InitializationDone) || (!ExcludeInitialization)))
+            AddCommand(&RecordedCommands, Time, READ_UNALIGNED_WORD_LITTLE_ENDIAN(Data), (Data[2] < (Length - 3))?Data[2]:(Length - 3), &Data[3]);
+      }
+      else
+      {
+         if((PacketType == HCI_EVENT_PACKET) && (Length) && (Data[0] != 0x0E) && (Data[0] != 0x0F))
+            InitializationDone = TRUE;
+
+         StandIn_ProcessPacket(Direction, PacketType, Length, Data);
+      }
+
+      /* Give the main loop of the application a pass.                  */
+      Recovery_Process();
+      PeerCache_Flush();
+      Coroutine_Process();
+      BTSnoopFile_Process();
+   }
+
+   BTSnoopFile_Close();
+
+   DisplayStatistics(Packets, ElapsedSeconds(&Start));
+
+   Mismatches = CompareCommands();
+
+   fprintf(Report, "Commands: %u recorded, %u issued, %lu mismatches\n", RecordedCommands.NumberCommands, IssuedCommands.NumberCommands, Mismatches);
+
+   ret_val = Mismatches?1:0;
+
+   return(ret_val);
+}
+
+int main(int argc, char *argv[])
+{
+   int     ret_val;
+   int     Option;
+   char   *Separator;
+   FILE   *File;
+
+   while((Option = getopt(argc, argv, "roIvg:c:S:")) != -1)
+   {
+      switch(Option)
+      {
+         case 'r':
+            RealTime = TRUE;
+            break;
+         case 'o':
+            CompareOpCodesOnly = TRUE;
+            break;
+         case 'I':
+            ExcludeInitialization = TRUE;
+            break;
+         case 'v':
+            Verbose = TRUE;
+            break;
+         case 'g':
+            GATTStartingHandle = (Word_t)strtoul(optarg, NULL, 0);
+            break;
+         case 'c':
+            if(NumberConsoleCommands < MAXIMUM_CONSOLE_COMMANDS)
+            {
+               ConsoleCommands[NumberConsoleCommands].Command = optarg;
+
+               /* "ms@Command" runs the command at the specified time.  */
+               if(((Separator = strchr(optarg, '@')) != NULL) && (Separator != optarg) && (strspn(optarg, "0123456789") == (size_t)(Separator - optarg)))
+               {
+                  ConsoleCommands[NumberConsoleCommands].Timed   = TRUE;
+                  ConsoleCommands[NumberConsoleCommands].Time    = strtoul(optarg, NULL, 10);
+                  ConsoleCommands[NumberConsoleCommands].Command = Separator + 1;
+               }
+
+               NumberConsoleCommands++;
+            }
+            break;
+         case 'S':
+            SnoopFileName = optarg;
+            break;
+         default:
+            fprintf(stderr, "Usage: %s [-r] [-o] [-I] [-v] [-g Handle] [-c [ms@]Command] [-S Snoop] File\n", argv[0]);
+            return(2);
+      }
+   }
+
+   if(optind >= argc)
+   {
+      fprintf(stderr, "Usage: %s [-r] [-o] [-I] [-v] [-g Handle] [-c [ms@]Command] [-S Snoop] File\n", argv[0]);
+      return(2);
+   }
+
+   if((File = fopen(argv[optind], "rb")) == NULL)
+   {
+      fprintf(stderr, "Unable to open %s.\n", argv[optind]);
+      return(2);
+   }
+
+   /* The report goes to the original stdout, the output of the         */
+   /* application is discarded unless it was asked for.                 */
+   Report = fdopen(dup(fileno(stdout)), "w");
+
+   if(!Verbose)
+   {
+      fflush(stdout);
+
+      if(!freopen("/dev/null", "w", stdout))
+         Verbose = TRUE;
+   }
+
+   if(Report)
+   {
+      StandIn_Initialize(CommandCallback, 0);
+      StandIn_SetVerbose(Verbose);
+
+      if(GATTStartingHandle)
+         StandIn_SetGATTStartingHandle(GATTStartingHandle);
+
+      ret_val = ReplayFile(File);
+
+      fclose(Report);
+   }
+   else
+      ret_val = 2;
+
+   fclose(File);
+
+   free(RecordedCommands.Commands);
+   free(IssuedCommands.Commands);
+
+   return(ret_val);
+}
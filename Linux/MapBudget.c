@@ -0,0 +1,1078 @@
+/*****< mapbudget.c >**********************************************************/
+/*                                                                            */
+/*  MapBudget - RAM/flash budget report of a linked image.  The linker map    */
+/*              (TI armcl map of the CCS build or GNU ld map of the GCC       */
+/*              build) is parsed into the sizes of .text, .rodata, .data and  */
+/*              .bss of every object (module) and every input section         */
+/*              (symbol), and the sizes are compared against the budget file  */
+/*              (NoOS/Budget.txt).                                            */
+/*                                                                            */
+/*              Input sections are classified by their name (.text*, i.* ->  */
+/*              text, .const*, .rodata*, .cinit, vectors -> rodata, .data* -> */
+/*              data, .bss*, COMMON -> bss, .stack -> stack) and unknown      */
+/*              sections by the address they are placed at.  The flash usage  */
+/*              is text + rodata (+ the .data load image of GNU maps, the TI  */
+/*              load image is the .cinit section), the SRAM usage is data +   */
+/*              bss + stack.                                                  */
+/*                                                                            */
+/*              Objects that are compiled without function subsections (TI    */
+/*              --gen_func_subsections, GCC -ffunction-sections) are reported */
+/*              as a single symbol per section.                               */
+/*                                                                            */
+/*  Build (from this directory):                                              */
+/*                                                                            */
+/*     gcc -O2 -o MapBudget MapBudget.c                                       */
+/*                                                                            */
+/*  Usage: MapBudget [-s Count] [-g Percent -o Output] Map [Budget]           */
+/*                                                                            */
+/*     -s  Number of symbols listed (largest first, default 25, 0 = all).     */
+/*     -g  Generate the limits from the map: the budget file is written to    */
+/*         the output with every limit of a line that has modules in the map  */
+/*         set to the size plus the percentage of headroom (rounded up to 8   */
+/*         bytes for data and bss, 64 bytes for text and rodata).  Lines      */
+/*         without modules (options that are off) and '-' limits are kept.    */
+/*     -o  File the generated budget is written to.                           */
+/*                                                                            */
+/*  The exit code is zero if no module and no total is over budget (or the    */
+/*  budget was generated).                                                    */
+/*                                                                            */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAXIMUM_MODULES                             (512)  /* Denotes the max  */
+                                                         /* number of objects */
+                                                         /* in the map.       */
+
+#define MAXIMUM_SYMBOLS                            (8192)  /* Denotes the max  */
+                                                         /* number of input   */
+                                                         /* sections in the   */
+                                                         /* map.              */
+
+#define MAXIMUM_BUDGETS                             (128)  /* Denotes the max  */
+                                                         /* number of module  */
+                                                         /* lines of the      */
+                                                         /* budget file.      */
+
+#define MAXIMUM_NAME_LENGTH                          (96)  /* Denotes the max  */
+                                                         /* length of module  */
+                                                         /* and symbol names. */
+
+#define MAXIMUM_LINE_LENGTH                         (512)  /* Denotes the max  */
+                                                         /* length of a line  */
+                                                         /* of the map.       */
+
+#define DEFAULT_NUMBER_SYMBOLS                       (25)  /* Denotes the      */
+                                                         /* default number of */
+                                                         /* listed symbols.   */
+
+#define SRAM_BASE_ADDRESS                   (0x20000000UL)  /* Denotes the start*/
+                                                         /* of the SRAM (used */
+                                                         /* to classify       */
+                                                         /* unknown sections).*/
+
+#define GENERATED_RAM_ALIGNMENT                       (8)  /* Denotes the      */
+#define GENERATED_FLASH_ALIGNMENT                    (64)  /* rounding of the  */
+                                                         /* generated limits.*/
+
+#define NO_LIMIT                                     (-1L)  /* Denotes a size   */
+                                                         /* without a limit.  */
+
+#define LINKER_MODULE_NAME                   "(linker)"  /* Denotes the module */
+                                                         /* of linker         */
+                                                         /* generated tables. */
+
+   /* The following enumerated type represents the size classes the     */
+   /* sections are accounted to.                                        */
+typedef enum
+{
+   scText,
+   scRodata,
+   scData,
+   scBss,
+   scStack,
+   scIgnore
+} Size_Class_t;
+
+#define NUMBER_BUDGET_CLASSES                         (4)  /* Denotes the size */
+                                                         /* classes a module */
+                                                         /* is budgeted in    */
+                                                         /* (text to bss).    */
+
+#define NUMBER_SIZE_CLASSES                           (5)  /* Denotes the      */
+                                                         /* number of size    */
+                                                         /* classes (with the */
+                                                         /* stack).           */
+
+   /* The following structure holds the sizes of one object.             */
+typedef struct _tagModule_t
+{
+   char          Name[MAXIMUM_NAME_LENGTH];
+   unsigned int  Order;
+   unsigned long Size[NUMBER_SIZE_CLASSES];
+} Module_t;
+
+   /* The following structure holds one input section.                  */
+typedef struct _tagSymbol_t
+{
+   char          Name[MAXIMUM_NAME_LENGTH];
+   unsigned int  ModuleIndex;
+   Size_Class_t  Class;
+   unsigned long Size;
+} Symbol_t;
+
+   /* The following structure holds one module line of the budget file.  */
+   /* The pattern matches the module name exactly or, if it ends with a */
+   /* '*', every module that starts with the pattern.  Every module is  */
+   /* accounted to the first line that matches.                         */
+typedef struct _tagBudget_t
+{
+   char          Pattern[MAXIMUM_NAME_LENGTH];
+   long          Limit[NUMBER_BUDGET_CLASSES];
+   unsigned long Used[NUMBER_BUDGET_CLASSES];
+   unsigned int  NumberModules;
+} Budget_t;
+
+   /* The following structure maps a section name prefix to the size     */
+   /* class of the section.                                             */
+typedef struct _tagSection_Class_t
+{
+   const char   *Prefix;
+   Size_Class_t  Class;
+} Section_Class_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static const Section_Class_t SectionClassTable[] =
+{
+   { ".debug",          scIgnore },
+   { ".comment",        scIgnore },
+   { ".ARM.attributes", scIgnore },
+   { ".note",           scIgnore },
+   { ".stab",           scIgnore },
+   { ".text",           scText   },
+   { "i.",              scText   },
+   { ".init_array",     scRodata },
+   { ".init",           scText   },
+   { ".fini_array",     scRodata },
+   { ".fini",           scText   },
+   { ".glue_7",         scText   },
+   { ".vfp11_veneer",   scText   },
+   { ".v4_bx",          scText   },
+   { ".const",          scRodata },
+   { ".rodata",         scRodata },
+   { ".cinit",          scRodata },
+   { ".intvecs",        scRodata },
+   { ".isr_vector",     scRodata },
+   { ".ctors",          scRodata },
+   { ".dtors",          scRodata },
+   { ".ARM.exidx",      scRodata },
+   { ".ARM.extab",      scRodata },
+   { ".data",           scData   },
+   { ".vtable",         scData   },
+   { ".bss",            scBss    },
+   { ".shbss",          scBss    },
+   { "COMMON",          scBss    },
+   { ".sysmem",         scBss    },
+   { ".heap",           scBss    },
+   { ".stack",          scStack  }
+} ;
+
+static const char *ClassNames[NUMBER_SIZE_CLASSES] = { "text", "rodata", "data", "bss", "stack" } ;
+
+static Module_t      ModuleList[MAXIMUM_MODULES];   /* Variables which hold  */
+static unsigned int  NumberModules;                 /* the objects of the    */
+                                                    /* map.                  */
+
+static Symbol_t      SymbolList[MAXIMUM_SYMBOLS];   /* Variables which hold  */
+static unsigned int  NumberSymbols;                 /* the input sections of */
+static unsigned long DroppedSymbols;                /* the map.              */
+
+static Budget_t      BudgetList[MAXIMUM_BUDGETS];   /* Variables which hold  */
+static unsigned int  NumberBudgets;                 /* the budget file.      */
+static long          FlashLimit = NO_LIMIT;
+static long          SRAMLimit  = NO_LIMIT;
+
+static int           GNUFormat;                     /* Variable which flags  */
+                                                    /* a GNU ld map (the     */
+                                                    /* .data load image is   */
+                                                    /* part of the flash).   */
+
+   /* Internal function prototypes.                                     */
+static Size_Class_t ClassifySection(const char *SectionName, const char *OutputName, unsigned long Address);
+static const char *SymbolName(const char *SectionName);
+static unsigned int FindModule(const char *Name);
+static void AddSection(const char *Module, const char *SectionName, const char *OutputName, unsigned long Address, unsigned long Size);
+static void CopyName(char *Destination, const char *Source, size_t Length);
+static const char *BaseName(const char *Path);
+static void StripExtension(char *Name);
+static void ParseTIInputLine(char *Line, const char *OutputName, char *Library, unsigned long Address, unsigned long Size);
+static int ParseTIMap(FILE *File);
+static void ParseGNUInputLine(char *SectionName, char *Rest, const char *OutputName);
+static int ParseGNUMap(FILE *File);
+static int ReadBudget(FILE *File);
+static long GeneratedLimit(unsigned long Used, unsigned int Class, unsigned int Percent);
+static int GenerateBudget(FILE *Template, FILE *Output, unsigned int Percent);
+static int CompareModules(const void *Left, const void *Right);
+static int CompareSymbols(const void *Left, const void *Right);
+static unsigned long FlashSize(const unsigned long *Size);
+static unsigned long RAMSize(const unsigned long *Size);
+static void DisplayModules(void);
+static void DisplaySymbols(unsigned int Count);
+static int CheckBudget(void);
+static void SortLists(void);
+
+   /* The following function returns the size class of an input section. */
+   /* The name of the section is used first, then the name of the output*/
+   /* section and then the address (flash or SRAM).                     */
+static Size_Class_t ClassifySection(const char *SectionName, const char *OutputName, unsigned long Address)
+{
+   unsigned int Index;
+
+   for(Index=0;Index<(sizeof(SectionClassTable)/sizeof(SectionClassTable[0]));Index++)
+   {
+      if(!strncmp(SectionName, SectionClassTable[Index].Prefix, strlen(SectionClassTable[Index].Prefix)))
+         return(SectionClassTable[Index].Class);
+   }
+
+   for(Index=0;Index<(sizeof(SectionClassTable)/sizeof(SectionClassTable[0]));Index++)
+   {
+      if(!strncmp(OutputName, SectionClassTable[Index].Prefix, strlen(SectionClassTable[Index].Prefix)))
+         return(SectionClassTable[Index].Class);
+   }
+
+   return((Address < SRAM_BASE_ADDRESS)?scRodata:scBss);
+}
+
+   /* The following function returns the symbol part of an input section */
+   /* name (".bss:Table" and ".bss.Table" -> "Table", "i.Function" ->   */
+   /* "Function").  The section name is returned for sections without a */
+   /* symbol part.                                                      */
+static const char *SymbolName(const char *SectionName)
+{
+   const char *ret_val;
+   const char *Separator;
+
+   if(!strncmp(SectionName, "i.", 2))
+      ret_val = SectionName + 2;
+   else
+   {
+      /* TI sub sections are separated by ':' (the last part is the     */
+      /* symbol, e.g. .const:.string:Table), GNU sub sections by '.'.   */
+      if((Separator = strrchr(SectionName, ':')) != NULL)
+         ret_val = Separator + 1;
+      else
+      {
+         if((SectionName[0] == '.') && ((Separator = strchr(SectionName + 1, '.')) != NULL))
+            ret_val = Separator + 1;
+         else
+            ret_val = SectionName;
+      }
+
+      if((ret_val[0] == '.') || (ret_val[0] == '\0'))
+         ret_val = SectionName;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the index of the specified module, */
+   /* the module is added if it is not in the list.  MAXIMUM_MODULES is  */
+   /* returned if the list is full.                                     */
+static unsigned int FindModule(const char *Name)
+{
+   unsigned int ret_val;
+
+   for(ret_val=0;(ret_val<NumberModules) && (strcmp(ModuleList[ret_val].Name, Name));ret_val++)
+      ;
+
+   if((ret_val == NumberModules) && (NumberModules < MAXIMUM_MODULES))
+   {
+      CopyName(ModuleList[ret_val].Name, Name, sizeof(ModuleList[ret_val].Name));
+
+      ModuleList[ret_val].Order = ret_val;
+
+      NumberModules++;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function accounts an input section to its module and */
+   /* adds it to the symbol list.                                       */
+static void AddSection(const char *Module, const char *SectionName, const char *OutputName, unsigned long Address, unsigned long Size)
+{
+   unsigned int ModuleIndex;
+   Size_Class_t Class;
+
+   if((Size) && ((Class = ClassifySection(SectionName, OutputName, Address)) != scIgnore))
+   {
+      if((ModuleIndex = FindModule(Module)) < MAXIMUM_MODULES)
+      {
+         ModuleList[ModuleIndex].Size[Class] += Size;
+
+         if(NumberSymbols < MAXIMUM_SYMBOLS)
+         {
+            CopyName(SymbolList[NumberSymbols].Name, SymbolName(SectionName), sizeof(SymbolList[NumberSymbols].Name));
+
+            SymbolList[NumberSymbols].ModuleIndex = ModuleIndex;
+            SymbolList[NumberSymbols].Class       = Class;
+            SymbolList[NumberSymbols].Size        = Size;
+
+            NumberSymbols++;
+         }
+         else
+            DroppedSymbols++;
+      }
+      else
+         DroppedSymbols++;
+   }
+}
+
+   /* The following function copies a (possibly truncated) name.        */
+static void CopyName(char *Destination, const char *Source, size_t Length)
+{
+   size_t Count;
+
+   if((Count = strlen(Source)) >= Length)
+      Count = Length - 1;
+
+   memcpy(Destination, Source, Count);
+
+   Destination[Count] = '\0';
+}
+
+   /* The following function returns the file name part of a path.       */
+static const char *BaseName(const char *Path)
+{
+   const char *ret_val;
+
+   ret_val = Path;
+
+   while(*Path)
+   {
+      if((*Path == '/') || (*Path == '\\'))
+         ret_val = Path + 1;
+
+      Path++;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function strips the extension of an object name     */
+   /* (HFPDemo.obj -> HFPDemo).                                         */
+static void StripExtension(char *Name)
+{
+   char *Extension;
+
+   if(((Extension = strrchr(Name, '.')) != NULL) && (Extension != Name))
+      *Extension = '\0';
+}
+
+   /* The following function parses an input section line of a TI map   */
+   /* (after the origin and length), which is one of:                   */
+   /*                                                                   */
+   /*    Object.obj (.section)                                          */
+   /*    Library.lib : Member.o (.section)                              */
+   /*                : Member.o (.section)  (same library as above)     */
+   /*    (.linker_generated) [...]                                      */
+   /*    --HOLE-- [...]                                                 */
+   /*                                                                   */
+   /* Library holds the library of the previous line and is updated.    */
+static void ParseTIInputLine(char *Line, const char *OutputName, char *Library, unsigned long Address, unsigned long Size)
+{
+   char  Module[MAXIMUM_NAME_LENGTH];
+   char *Object;
+   char *Section;
+   char *End;
+   char *Separator;
+
+   if(!strncmp(Line, "--HOLE--", 8))
+      return;
+
+   if(Line[0] == '(')
+   {
+      if((End = strchr(Line, ')')) != NULL)
+         *End = '\0';
+
+      AddSection(LINKER_MODULE_NAME, Line + 1, OutputName, Address, Size);
+   }
+   else
+   {
+      if(((Section = strstr(Line, " (")) != NULL) && ((End = strrchr(Section, ')')) != NULL))
+      {
+         *Section  = '\0';
+         *End      = '\0';
+         Section  += 2;
+
+         /* Split the library part (if any) from the object.            */
+         if((Separator = strstr(Line, ": ")) != NULL)
+         {
+            Object = Separator + 2;
+
+            if(Separator != Line)
+            {
+               while((Separator > Line) && ((Separator[-1] == ' ') || (Separator[-1] == ':')))
+                  Separator--;
+
+               *Separator = '\0';
+
+               CopyName(Library, BaseName(Line), MAXIMUM_NAME_LENGTH);
+            }
+         }
+         else
+         {
+            Object     = Line;
+            Library[0] = '\0';
+         }
+
+         while(*Object == ' ')
+            Object++;
+
+         if(Library[0])
+            snprintf(Module, sizeof(Module), "%s(%s)", Library, BaseName(Object));
+         else
+            CopyName(Module, BaseName(Object), sizeof(Module));
+
+         if(!Library[0])
+            StripExtension(Module);
+
+         AddSection(Module, Section, OutputName, Address, Size);
+      }
+   }
+}
+
+   /* The following function parses the SECTION ALLOCATION MAP of a TI   */
+   /* map.  This function returns zero if successful.                   */
+static int ParseTIMap(FILE *File)
+{
+   int           ret_val;
+   int           InSections;
+   char          Line[MAXIMUM_LINE_LENGTH];
+   char          OutputName[MAXIMUM_NAME_LENGTH];
+   char          Library[MAXIMUM_NAME_LENGTH];
+   char         *Rest;
+   unsigned long Address;
+   unsigned long Size;
+
+   ret_val       = -1;
+   InSections    = 0;
+   OutputName[0] = '\0';
+   Library[0]    = '\0';
+
+   while(fgets(Line, sizeof(Line), File))
+   {
+      Line[strcspn(Line, "\r\n")] = '\0';
+
+      if(!InSections)
+      {
+         if(!strncmp(Line, "SECTION ALLOCATION MAP", 22))
+         {
+            InSections = 1;
+            ret_val    = 0;
+         }
+
+         continue;
+      }
+
+      if((!strncmp(Line, "MODULE SUMMARY", 14)) || (!strncmp(Line, "LINKER GENERATED", 16)) || (!strncmp(Line, "GLOBAL SYMBOLS", 14)))
+         break;
+
+      if((Line[0] == '.') || (Line[0] == '*'))
+      {
+         /* Output section: name page origin length.  The .stack has no */
+         /* input sections and the .sysmem (heap) is mostly a hole      */
+         /* behind the 8 bytes of memory.obj, so both are accounted     */
+         /* here by the length of the output section.                   */
+         sscanf(Line, "%95s", OutputName);
+
+         if(((!strcmp(OutputName, ".stack")) || (!strcmp(OutputName, ".sysmem"))) && (sscanf(Line, "%*s %*s %lx %lx", &Address, &Size) == 2))
+            AddSection(LINKER_MODULE_NAME, OutputName, OutputName, Address, Size);
+
+         Library[0] = '\0';
+      }
+      else
+      {
+         if((Line[0] == ' ') && (sscanf(Line, "%lx %lx", &Address, &Size) == 2))
+         {
+            /* Skip the origin and the length.                          */
+            Rest = Line + strspn(Line, " ");
+            Rest = Rest + strcspn(Rest, " ");
+            Rest = Rest + strspn(Rest, " ");
+            Rest = Rest + strcspn(Rest, " ");
+            Rest = Rest + strspn(Rest, " ");
+
+            if((*Rest) && (strcmp(OutputName, ".stack")) && (strcmp(OutputName, ".sysmem")))
+               ParseTIInputLine(Rest, OutputName, Library, Address, Size);
+         }
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function parses the address, size and object of an  */
+   /* input section line of a GNU map.                                  */
+static void ParseGNUInputLine(char *SectionName, char *Rest, const char *OutputName)
+{
+   char           Module[MAXIMUM_NAME_LENGTH];
+   char          *Object;
+   char          *Member;
+   char          *End;
+   unsigned long  Address;
+   unsigned long  Size;
+   int            Consumed;
+
+   if(sscanf(Rest, " %lx %lx %n", &Address, &Size, &Consumed) == 2)
+   {
+      Object = Rest + Consumed;
+
+      if(*Object)
+      {
+         /* Archive members are listed as /path/libx.a(member.o).       */
+         if(((Member = strchr(Object, '(')) != NULL) && ((End = strrchr(Member, ')')) != NULL))
+         {
+            *Member++ = '\0';
+            *End      = '\0';
+
+            snprintf(Module, sizeof(Module), "%s(%s)", BaseName(Object), Member);
+         }
+         else
+         {
+            CopyName(Module, BaseName(Object), sizeof(Module));
+
+            StripExtension(Module);
+         }
+      }
+      else
+         CopyName(Module, LINKER_MODULE_NAME, sizeof(Module));
+
+      AddSection(Module, SectionName, OutputName, Address, Size);
+   }
+}
+
+   /* The following function parses the memory map of a GNU ld map.     */
+   /* Input section lines start with a single space and either hold the */
+   /* address, size and object or continue on the next line (long       */
+   /* section names).  This function returns zero if successful.        */
+static int ParseGNUMap(FILE *File)
+{
+   int   ret_val;
+   char  Line[MAXIMUM_LINE_LENGTH];
+   char  OutputName[MAXIMUM_NAME_LENGTH];
+   char  SectionName[MAXIMUM_NAME_LENGTH];
+   char *Rest;
+
+   ret_val        = -1;
+   OutputName[0]  = '\0';
+   SectionName[0] = '\0';
+
+   while(fgets(Line, sizeof(Line), File))
+   {
+      Line[strcspn(Line, "\r\n")] = '\0';
+
+      if(ret_val)
+      {
+         if(!strncmp(Line, "Linker script and memory map", 28))
+            ret_val = 0;
+
+         continue;
+      }
+
+      if(!strncmp(Line, "OUTPUT(", 7))
+         break;
+
+      if(SectionName[0])
+      {
+         /* Continuation of a long section name.                        */
+         ParseGNUInputLine(SectionName, Line, OutputName);
+
+         SectionName[0] = '\0';
+      }
+      else
+      {
+         if(Line[0] == '.')
+            sscanf(Line, "%95s", OutputName);
+         else
+         {
+            if((Line[0] == ' ') && (Line[1] != ' ') && (Line[1] != '*') && (Line[1] != '\0'))
+            {
+               Rest = Line + 1 + strcspn(Line + 1, " ");
+
+               if(*Rest)
+               {
+                  *Rest++ = '\0';
+
+                  ParseGNUInputLine(Line + 1, Rest, OutputName);
+               }
+               else
+                  CopyName(SectionName, Line + 1, sizeof(SectionName));
+            }
+         }
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function reads the budget file, which holds lines of */
+   /* the forms:                                                        */
+   /*                                                                   */
+   /*    FLASH Limit                                                    */
+   /*    SRAM  Limit                                                    */
+   /*    Pattern Text Rodata Data Bss                                   */
+   /*                                                                   */
+   /* Limits are in bytes ('-' for no limit), '#' starts a comment.     */
+   /* This function returns zero if successful.                         */
+static int ReadBudget(FILE *File)
+{
+   int           ret_val;
+   char          Line[MAXIMUM_LINE_LENGTH];
+   char          Field[5][MAXIMUM_NAME_LENGTH];
+   unsigned int  LineNumber;
+   unsigned int  Index;
+   int           NumberFields;
+   long         *Limit;
+
+   ret_val    = 0;
+   LineNumber = 0;
+
+   while((!ret_val) && (fgets(Line, sizeof(Line), File)))
+   {
+      LineNumber++;
+
+      Line[strcspn(Line, "#\r\n")] = '\0';
+
+      if((NumberFields = sscanf(Line, "%95s %95s %95s %95s %95s", Field[0], Field[1], Field[2], Field[3], Field[4])) <= 0)
+         continue;
+
+      if((!strcmp(Field[0], "FLASH")) || (!strcmp(Field[0], "SRAM")))
+      {
+         Limit = (Field[0][0] == 'F')?&FlashLimit:&SRAMLimit;
+
+         if(NumberFields == 2)
+            *Limit = (Field[1][0] == '-')?NO_LIMIT:strtol(Field[1], NULL, 0);
+         else
+            ret_val = -1;
+      }
+      else
+      {
+         if((NumberFields == 5) && (NumberBudgets < MAXIMUM_BUDGETS))
+         {
+            CopyName(BudgetList[NumberBudgets].Pattern, Field[0], sizeof(BudgetList[NumberBudgets].Pattern));
+
+            for(Index=0;Index<NUMBER_BUDGET_CLASSES;Index++)
+               BudgetList[NumberBudgets].Limit[Index] = (Field[Index + 1][0] == '-')?NO_LIMIT:strtol(Field[Index + 1], NULL, 0);
+
+            NumberBudgets++;
+         }
+         else
+            ret_val = -1;
+      }
+
+      if(ret_val)
+         fprintf(stderr, "Invalid budget line %u.\n", LineNumber);
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the limit that is generated for the*/
+   /* specified size of a class.                                        */
+static long GeneratedLimit(unsigned long Used, unsigned int Class, unsigned int Percent)
+{
+   unsigned long Alignment;
+
+   Alignment = ((Class == scData) || (Class == scBss))?GENERATED_RAM_ALIGNMENT:GENERATED_FLASH_ALIGNMENT;
+
+   Used += (Used * Percent + 99) / 100;
+
+   return((long)(((Used + Alignment - 1) / Alignment) * Alignment));
+}
+
+   /* The following function writes the budget file (read before with   */
+   /* ReadBudget() and accounted with CheckBudget()) to the output with */
+   /* the limits generated from the map.  Comments, the totals and the  */
+   /* lines without modules are copied.  This function returns zero if  */
+   /* successful.                                                       */
+static int GenerateBudget(FILE *Template, FILE *Output, unsigned int Percent)
+{
+   char          Line[MAXIMUM_LINE_LENGTH];
+   char          Fields[MAXIMUM_LINE_LENGTH];
+   char          Field[MAXIMUM_NAME_LENGTH];
+   char          Limit[NUMBER_BUDGET_CLASSES][16];
+   unsigned int  Budget;
+   unsigned int  Class;
+
+   Budget = 0;
+
+   while(fgets(Line, sizeof(Line), Template))
+   {
+      strcpy(Fields, Line);
+
+      Fields[strcspn(Fields, "#\r\n")] = '\0';
+
+      /* The module lines are in the order ReadBudget() read them.       */
+      if((sscanf(Fields, "%95s", Field) == 1) && (strcmp(Field, "FLASH")) && (strcmp(Field, "SRAM")) && (Budget < NumberBudgets))
+      {
+         if(BudgetList[Budget].NumberModules)
+         {
+            for(Class=0;Class<NUMBER_BUDGET_CLASSES;Class++)
+            {
+               if(BudgetList[Budget].Limit[Class] == NO_LIMIT)
+                  strcpy(Limit[Class], "-");
+               else
+                  sprintf(Limit[Class], "%ld", GeneratedLimit(BudgetList[Budget].Used[Class], Class, Percent));
+            }
+
+            fprintf(Output, "%-24s%9s%8s%8s%8s\n", BudgetList[Budget].Pattern, Limit[0], Limit[1], Limit[2], Limit[3]);
+         }
+         else
+            fputs(Line, Output);
+
+         Budget++;
+      }
+      else
+         fputs(Line, Output);
+   }
+
+   return(ferror(Output)?-1:0);
+}
+
+   /* The following function returns the flash used by the specified     */
+   /* sizes.                                                            */
+static unsigned long FlashSize(const unsigned long *Size)
+{
+   return(Size[scText] + Size[scRodata] + (GNUFormat?Size[scData]:0));
+}
+
+   /* The following function returns the SRAM used by the specified      */
+   /* sizes.                                                            */
+static unsigned long RAMSize(const unsigned long *Size)
+{
+   return(Size[scData] + Size[scBss] + Size[scStack]);
+}
+
+   /* The following function is the qsort() comparison of modules       */
+   /* (largest flash + SRAM first).                                     */
+static int CompareModules(const void *Left, const void *Right)
+{
+   unsigned long LeftSize;
+   unsigned long RightSize;
+
+   LeftSize  = FlashSize(((const Module_t *)Left)->Size) + RAMSize(((const Module_t *)Left)->Size);
+   RightSize = FlashSize(((const Module_t *)Right)->Size) + RAMSize(((const Module_t *)Right)->Size);
+
+   return((LeftSize < RightSize)?1:((LeftSize > RightSize)?-1:strcmp(((const Module_t *)Left)->Name, ((const Module_t *)Right)->Name)));
+}
+
+   /* The following function is the qsort() comparison of symbols       */
+   /* (largest first).                                                  */
+static int CompareSymbols(const void *Left, const void *Right)
+{
+   unsigned long LeftSize;
+   unsigned long RightSize;
+
+   LeftSize  = ((const Symbol_t *)Left)->Size;
+   RightSize = ((const Symbol_t *)Right)->Size;
+
+   return((LeftSize < RightSize)?1:((LeftSize > RightSize)?-1:0));
+}
+
+   /* The following function displays the sizes of every module and the  */
+   /* totals.                                                           */
+static void DisplayModules(void)
+{
+   unsigned int  Index;
+   unsigned int  Class;
+   unsigned long Total[NUMBER_SIZE_CLASSES];
+
+   memset(Total, 0, sizeof(Total));
+
+   printf("%-48s %8s %8s %8s %8s %8s %8s\n", "Module", "text", "rodata", "data", "bss", "flash", "sram");
+
+   for(Index=0;Index<NumberModules;Index++)
+   {
+      printf("%-48s %8lu %8lu %8lu %8lu %8lu %8lu\n", ModuleList[Index].Name, ModuleList[Index].Size[scText], ModuleList[Index].Size[scRodata], ModuleList[Index].Size[scData], ModuleList[Index].Size[scBss], FlashSize(ModuleList[Index].Size), RAMSize(ModuleList[Index].Size));
+
+      for(Class=0;Class<NUMBER_SIZE_CLASSES;Class++)
+         Total[Class] += ModuleList[Index].Size[Class];
+   }
+
+   printf("%-48s %8lu %8lu %8lu %8lu %8lu %8lu\n", "Total", Total[scText], Total[scRodata], Total[scData], Total[scBss], FlashSize(Total), RAMSize(Total));
+   if(Total[scStack])
+      printf("(the sram of %s includes the %lu byte stack)\n", LINKER_MODULE_NAME, Total[scStack]);
+
+   printf("\n");
+}
+
+   /* The following function displays the largest input sections.       */
+static void DisplaySymbols(unsigned int Count)
+{
+   unsigned int Index;
+
+   if((!Count) || (Count > NumberSymbols))
+      Count = NumberSymbols;
+
+   printf("%-40s %-48s %-6s %8s\n", "Symbol", "Module", "Class", "Size");
+
+   for(Index=0;Index<Count;Index++)
+      printf("%-40s %-48s %-6s %8lu\n", SymbolList[Index].Name, ModuleList[SymbolList[Index].ModuleIndex].Name, ClassNames[SymbolList[Index].Class], SymbolList[Index].Size);
+
+   if(DroppedSymbols)
+      printf("(%lu sections dropped, increase MAXIMUM_SYMBOLS)\n", DroppedSymbols);
+
+   printf("\n");
+}
+
+   /* The following function accounts every module to its budget line   */
+   /* and displays the budget.  This function returns the number of     */
+   /* limits that are exceeded.                                         */
+static int CheckBudget(void)
+{
+   int           ret_val;
+   unsigned int  Index;
+   unsigned int  Budget;
+   unsigned int  Class;
+   unsigned int  Length;
+   unsigned long Total[NUMBER_SIZE_CLASSES];
+   const char   *Mark;
+
+   ret_val = 0;
+
+   memset(Total, 0, sizeof(Total));
+
+   for(Index=0;Index<NumberModules;Index++)
+   {
+      for(Class=0;Class<NUMBER_SIZE_CLASSES;Class++)
+         Total[Class] += ModuleList[Index].Size[Class];
+
+      for(Budget=0;Budget<NumberBudgets;Budget++)
+      {
+         Length = strlen(BudgetList[Budget].Pattern);
+
+         if((Length) && (BudgetList[Budget].Pattern[Length - 1] == '*'))
+         {
+            if(!strncmp(ModuleList[Index].Name, BudgetList[Budget].Pattern, Length - 1))
+               break;
+         }
+         else
+         {
+            if(!strcmp(ModuleList[Index].Name, BudgetList[Budget].Pattern))
+               break;
+         }
+      }
+
+      if(Budget < NumberBudgets)
+      {
+         for(Class=0;Class<NUMBER_BUDGET_CLASSES;Class++)
+            BudgetList[Budget].Used[Class] += ModuleList[Index].Size[Class];
+
+         BudgetList[Budget].NumberModules++;
+      }
+      else
+      {
+         if((ModuleList[Index].Size[scText]) || (ModuleList[Index].Size[scRodata]) || (ModuleList[Index].Size[scData]) || (ModuleList[Index].Size[scBss]))
+            printf("Warning: %s has no budget.\n", ModuleList[Index].Name);
+      }
+   }
+
+   printf("%-48s %17s %17s %17s %17s\n", "Budget", "text", "rodata", "data", "bss");
+
+   for(Budget=0;Budget<NumberBudgets;Budget++)
+   {
+      Mark = "";
+
+      printf("%-48s", BudgetList[Budget].Pattern);
+
+      for(Class=0;Class<NUMBER_BUDGET_CLASSES;Class++)
+      {
+         if(BudgetList[Budget].Limit[Class] == NO_LIMIT)
+            printf(" %8lu/%8s", BudgetList[Budget].Used[Class], "-");
+         else
+         {
+            printf(" %8lu/%8ld", BudgetList[Budget].Used[Class], BudgetList[Budget].Limit[Class]);
+
+            if(BudgetList[Budget].Used[Class] > (unsigned long)BudgetList[Budget].Limit[Class])
+            {
+               Mark = "  OVER";
+               ret_val++;
+            }
+         }
+      }
+
+      if(!BudgetList[Budget].NumberModules)
+         Mark = "  (no modules)";
+
+      printf("%s\n", Mark);
+   }
+
+   if(FlashLimit != NO_LIMIT)
+   {
+      printf("\nFLASH %8lu of %8ld bytes (%ld free)%s\n", FlashSize(Total), FlashLimit, FlashLimit - (long)FlashSize(Total), (FlashSize(Total) > (unsigned long)FlashLimit)?"  OVER":"");
+
+      if(FlashSize(Total) > (unsigned long)FlashLimit)
+         ret_val++;
+   }
+
+   if(SRAMLimit != NO_LIMIT)
+   {
+      printf("SRAM  %8lu of %8ld bytes (%ld free, stack %lu)%s\n", RAMSize(Total), SRAMLimit, SRAMLimit - (long)RAMSize(Total), Total[scStack], (RAMSize(Total) > (unsigned long)SRAMLimit)?"  OVER":"");
+
+      if(RAMSize(Total) > (unsigned long)SRAMLimit)
+         ret_val++;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function sorts the modules and the symbols (largest */
+   /* first).  The symbols refer to the modules by index, so the index  */
+   /* is updated to the sorted position of the module.                  */
+static void SortLists(void)
+{
+   unsigned int Index;
+   unsigned int Position[MAXIMUM_MODULES];
+
+   qsort(ModuleList, NumberModules, sizeof(Module_t), CompareModules);
+
+   for(Index=0;Index<NumberModules;Index++)
+      Position[ModuleList[Index].Order] = Index;
+
+   for(Index=0;Index<NumberSymbols;Index++)
+      SymbolList[Index].ModuleIndex = Position[SymbolList[Index].ModuleIndex];
+
+   qsort(SymbolList, NumberSymbols, sizeof(Symbol_t), CompareSymbols);
+}
+
+int main(int argc, char *argv[])
+{
+   int           ret_val;
+   int           Option;
+   int           Percent;
+   unsigned int  Count;
+   char          Line[MAXIMUM_LINE_LENGTH];
+   const char   *OutputName;
+   FILE         *File;
+   FILE         *Output;
+
+   Count      = DEFAULT_NUMBER_SYMBOLS;
+   Percent    = -1;
+   OutputName = NULL;
+
+   while((Option = getopt(argc, argv, "s:g:o:")) != -1)
+   {
+      switch(Option)
+      {
+         case 's':
+            Count = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 'g':
+            Percent = (int)strtol(optarg, NULL, 0);
+            break;
+         case 'o':
+            OutputName = optarg;
+            break;
+         default:
+            fprintf(stderr, "Usage: %s [-s Count] [-g Percent -o Output] Map [Budget]\n", argv[0]);
+            return(2);
+      }
+   }
+
+   /* A budget is generated from the budget file into another file.     */
+   if((optind >= argc) || ((Percent >= 0) != (OutputName != NULL)) || ((Percent >= 0) && (optind + 1 >= argc)))
+   {
+      fprintf(stderr, "Usage: %s [-s Count] [-g Percent -o Output] Map [Budget]\n", argv[0]);
+      return(2);
+   }
+
+   if((File = fopen(argv[optind], "r")) == NULL)
+   {
+      fprintf(stderr, "Unable to open %s.\n", argv[optind]);
+      return(2);
+   }
+
+   /* TI maps start with a banner of the TI linker.                     */
+   GNUFormat = 1;
+
+   while(fgets(Line, sizeof(Line), File))
+   {
+      if(strstr(Line, "TI ARM Linker"))
+      {
+         GNUFormat = 0;
+         break;
+      }
+
+      if(strstr(Line, "Memory Configuration"))
+         break;
+   }
+
+   rewind(File);
+
+   ret_val = GNUFormat?ParseGNUMap(File):ParseTIMap(File);
+
+   fclose(File);
+
+   if(ret_val)
+   {
+      fprintf(stderr, "%s is not a linker map.\n", argv[optind]);
+      return(2);
+   }
+
+   SortLists();
+
+   ret_val = 0;
+
+   DisplayModules();
+   DisplaySymbols(Count);
+
+   if(optind + 1 < argc)
+   {
+      if((File = fopen(argv[optind + 1], "r")) == NULL)
+      {
+         fprintf(stderr, "Unable to open %s.\n", argv[optind + 1]);
+         return(2);
+      }
+
+      ret_val = ReadBudget(File);
+
+      if(ret_val)
+      {
+         fclose(File);
+         return(2);
+      }
+
+      ret_val = CheckBudget()?1:0;
+
+      if(Percent >= 0)
+      {
+         if((Output = fopen(OutputName, "w")) == NULL)
+         {
+            fprintf(stderr, "Unable to create %s.\n", OutputName);
+            fclose(File);
+            return(2);
+         }
+
+         rewind(File);
+
+         ret_val = GenerateBudget(File, Output, (unsigned int)Percent);
+
+         if((fclose(Output)) || (ret_val))
+         {
+            fprintf(stderr, "Unable to write %s.\n", OutputName);
+            ret_val = 2;
+         }
+         else
+            printf("\nBudget generated with %d%% headroom: %s\n", Percent, OutputName);
+      }
+
+      fclose(File);
+   }
+
+   return(ret_val);
+}
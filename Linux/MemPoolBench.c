@@ -0,0 +1,754 @@
+/*****< mempoolbench.c >*******************************************************/
+/*                                                                            */
+/*  MemPoolBench - Host benchmark of the memory pool.  An allocation trace is */
+/*                 replayed against three allocators:                         */
+/*                                                                            */
+/*                    - the fixed-block pool of MemPool.c.                    */
+/*                    - a model of the heap of the kernel (address ordered    */
+/*                      free list, first fit, coalescing on free) of the same */
+/*                      size as the pool.                                     */
+/*                    - malloc() of the host (as a reference).                */
+/*                                                                            */
+/*                 For each allocator the mean and worst case time of an      */
+/*                 allocation and a free, the failed allocations and the      */
+/*                 worst fragmentation of the free memory (1 - largest free   */
+/*                 block / free memory) are reported.                         */
+/*                                                                            */
+/*                 The trace is a console log of a target built with          */
+/*                 MEM_POOL_TRACE ("MP A Address Size" / "MP F Address"       */
+/*                 lines, all other lines are ignored).  Without a file a     */
+/*                 synthetic trace of connect/disconnect cycles is used.      */
+/*                                                                            */
+/*  Build (from this directory):                                              */
+/*                                                                            */
+/*     gcc -O2 -DMEM_POOL_ENABLE -IBluetopia -I.. -o MemPoolBench             */
+/*         MemPoolBench.c ../MemPool.c                                       */
+/*                                                                            */
+/*  Usage: MemPoolBench [-r Repeats] [-n Cycles] [Trace File]                 */
+/*                                                                            */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+#include "Main.h"          /* Application Interface Abstraction.              */
+#include "MemPool.h"       /* Pool Allocator Prototypes/Constants.            */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+
+#define DEFAULT_REPEATS                              (20)  /* Denotes the      */
+                                                         /* default number of */
+                                                         /* times the trace is*/
+                                                         /* replayed.         */
+
+#define DEFAULT_CYCLES                             (2000)  /* Denotes the      */
+                                                         /* default number of */
+                                                         /* connect/disconnect*/
+                                                         /* cycles of the     */
+                                                         /* synthetic trace.  */
+
+#define HEAP_SIZE                  (MEM_POOL_BUFFER_SIZE)  /* Denotes the size */
+                                                         /* of the heap model.*/
+
+#define HEAP_ALIGNMENT                                (8)  /* Denotes the      */
+                                                         /* alignment of the  */
+                                                         /* heap model.       */
+
+#define MAXIMUM_LINE_LENGTH                         (512)  /* Denotes the max  */
+                                                         /* length of a line  */
+                                                         /* of the trace.     */
+
+   /* The following structure holds a single operation of the trace.     */
+   /* Handle is the number of the allocation (a free refers to the      */
+   /* allocation it releases).                                          */
+typedef struct _tagTraceOperation_t
+{
+   int           Free;
+   unsigned long Size;
+   unsigned long Handle;
+} TraceOperation_t;
+
+   /* The following structure holds the functions of an allocator.       */
+   /* Largest Free and Total Free are NULL if the free memory of the    */
+   /* allocator is not known.                                           */
+typedef struct _tagAllocator_t
+{
+   char           *Name;
+   void          *(*Allocate)(unsigned long Size);
+   void           (*Free)(void *Block);
+   unsigned long  (*LargestFree)(void);
+   unsigned long  (*TotalFree)(void);
+} Allocator_t;
+
+   /* The following structure holds the results of an allocator.         */
+typedef struct _tagBenchResult_t
+{
+   double        AllocateTime;
+   double        AllocateMaximum;
+   double        FreeTime;
+   double        FreeMaximum;
+   unsigned long Failures;
+   double        Fragmentation;
+} BenchResult_t;
+
+   /* The following structure is the header of a block of the heap      */
+   /* model (Size includes the header).                                 */
+typedef struct _tagHeapHeader_t
+{
+   struct _tagHeapHeader_t *NextBlock;
+   unsigned long            Size;
+} HeapHeader_t;
+
+#define HEAP_HEADER_SIZE   ((sizeof(HeapHeader_t) + HEAP_ALIGNMENT - 1) & ~(HEAP_ALIGNMENT - 1))
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static TraceOperation_t  *Trace;                    /* Variables which hold the*/
+static unsigned long      NumberOperations;         /* trace and the number of */
+static unsigned long      NumberAllocations;        /* allocations in it.      */
+
+static void             **Handles;                  /* Variable which holds the*/
+                                                    /* blocks of a replay.     */
+
+static double            *OperationTime;            /* Variables which hold the*/
+static double             TimerOverhead;            /* fastest time of every   */
+                                                    /* operation and the time  */
+                                                    /* of reading the clock.   */
+
+static unsigned long      RandomState = 0x2545F491; /* Variable which holds the*/
+                                                    /* state of the random     */
+                                                    /* number generator.       */
+
+static unsigned long long HeapBuffer[HEAP_SIZE / sizeof(unsigned long long)];
+                                                    /* Variables which hold the*/
+static HeapHeader_t      *HeapFreeList;             /* heap model.             */
+
+   /* Internal function prototypes.                                     */
+static unsigned long Random(void);
+static void AddOperation(int Free, unsigned long Size, unsigned long Handle);
+static int ReadTrace(FILE *File);
+static void GenerateTrace(unsigned long Cycles);
+static void HeapInitialize(void);
+static void *HeapAllocate(unsigned long Size);
+static void HeapFree(void *Block);
+static unsigned long HeapLargestFree(void);
+static unsigned long HeapTotalFree(void);
+static unsigned long PoolLargestFree(void);
+static unsigned long PoolTotalFree(void);
+static double Now(void);
+static void Replay(Allocator_t *Allocator, unsigned long Repeats, BenchResult_t *Result);
+
+   /* The following function returns a pseudo random number (xorshift).  */
+static unsigned long Random(void)
+{
+   RandomState ^= (RandomState << 13) & 0xFFFFFFFFUL;
+   RandomState ^= RandomState >> 17;
+   RandomState ^= RandomState << 5;
+   RandomState &= 0xFFFFFFFFUL;
+
+   return(RandomState);
+}
+
+   /* The following function appends an operation to the trace.         */
+static void AddOperation(int Free, unsigned long Size, unsigned long Handle)
+{
+   static unsigned long MaximumOperations;
+
+   if(NumberOperations == MaximumOperations)
+   {
+      MaximumOperations = (MaximumOperations)?(MaximumOperations * 2):4096;
+
+      if((Trace = realloc(Trace, MaximumOperations * sizeof(TraceOperation_t))) == NULL)
+      {
+         fprintf(stderr, "Out of memory.\n");
+         exit(2);
+      }
+   }
+
+   Trace[NumberOperations].Free   = Free;
+   Trace[NumberOperations].Size   = Size;
+   Trace[NumberOperations].Handle = Handle;
+
+   NumberOperations++;
+}
+
+   /* The following function reads a trace from a console log.  The      */
+   /* recorded addresses are mapped to allocation numbers, frees of     */
+   /* blocks that were allocated before the log started are skipped.    */
+   /* This function returns the number of skipped frees.                */
+static int ReadTrace(FILE *File)
+{
+   int            ret_val;
+   char           Line[MAXIMUM_LINE_LENGTH];
+   char          *Record;
+   unsigned long  Address;
+   unsigned long  Size;
+   unsigned long  Index;
+   unsigned long  NumberLive;
+   unsigned long  MaximumLive;
+   unsigned long *LiveAddress;
+   unsigned long *LiveHandle;
+
+   ret_val     = 0;
+   NumberLive  = 0;
+   MaximumLive = 0;
+   LiveAddress = NULL;
+   LiveHandle  = NULL;
+
+   while(fgets(Line, sizeof(Line), File))
+   {
+      if(((Record = strstr(Line, "MP A ")) != NULL) && (sscanf(Record + 5, "%lx %lu", &Address, &Size) == 2))
+      {
+         /* A failed allocation is replayed, but never freed.           */
+         if(Address)
+         {
+            if(NumberLive == MaximumLive)
+            {
+               MaximumLive = (MaximumLive)?(MaximumLive * 2):256;
+               LiveAddress = realloc(LiveAddress, MaximumLive * sizeof(unsigned long));
+               LiveHandle  = realloc(LiveHandle, MaximumLive * sizeof(unsigned long));
+
+               if((!LiveAddress) || (!LiveHandle))
+               {
+                  fprintf(stderr, "Out of memory.\n");
+                  exit(2);
+               }
+            }
+
+            LiveAddress[NumberLive] = Address;
+            LiveHandle[NumberLive]  = NumberAllocations;
+            NumberLive++;
+         }
+
+         AddOperation(0, Size, NumberAllocations++);
+      }
+      else
+      {
+         if(((Record = strstr(Line, "MP F ")) != NULL) && (sscanf(Record + 5, "%lx", &Address) == 1) && (Address))
+         {
+            for(Index=NumberLive;(Index > 0) && (LiveAddress[Index - 1] != Address);Index--)
+               ;
+
+            if(Index)
+            {
+               AddOperation(1, 0, LiveHandle[Index - 1]);
+
+               NumberLive--;
+               LiveAddress[Index - 1] = LiveAddress[NumberLive];
+               LiveHandle[Index - 1]  = LiveHandle[NumberLive];
+            }
+            else
+               ret_val++;
+         }
+      }
+   }
+
+   free(LiveAddress);
+   free(LiveHandle);
+
+   return(ret_val);
+}
+
+   /* The following function generates a synthetic trace.  Each cycle    */
+   /* allocates the control blocks of a connection, passes packets of   */
+   /* mixed sizes (mostly small events, some ACL data) through a short  */
+   /* queue and frees everything in a shuffled order on disconnect.     */
+static void GenerateTrace(unsigned long Cycles)
+{
+   static const unsigned long ControlSizes[] = { 24, 40, 96, 180 };
+
+   unsigned long Cycle;
+   unsigned long Packet;
+   unsigned long Kind;
+   unsigned long Size;
+   unsigned long Index;
+   unsigned long Swap;
+   unsigned long NumberQueued;
+   unsigned long Queue[4];
+   unsigned long NumberOwned;
+   unsigned long Owned[sizeof(ControlSizes)/sizeof(ControlSizes[0]) + 8];
+
+   for(Cycle=0;Cycle<Cycles;Cycle++)
+   {
+      NumberOwned = 0;
+
+      for(Index=0;Index<sizeof(ControlSizes)/sizeof(ControlSizes[0]);Index++)
+      {
+         Owned[NumberOwned++] = NumberAllocations;
+
+         AddOperation(0, ControlSizes[Index], NumberAllocations++);
+      }
+
+      NumberQueued = 0;
+
+      for(Packet=0;Packet<100 + (Random() % 200);Packet++)
+      {
+         Kind = Random() % 100;
+
+         if(Kind < 60)
+            Size = 8 + (Random() % 56);
+         else
+         {
+            if(Kind < 92)
+               Size = 64 + (Random() % 192);
+            else
+               Size = 256 + (Random() % 770);
+         }
+
+         /* The queue drains in order, the allocations of a busy link   */
+         /* stay outstanding longer.                                    */
+         if(NumberQueued == 1 + (Random() % (sizeof(Queue)/sizeof(Queue[0]))))
+         {
+            AddOperation(1, 0, Queue[0]);
+
+            memmove(Queue, &Queue[1], (--NumberQueued) * sizeof(Queue[0]));
+         }
+
+         if(NumberQueued < sizeof(Queue)/sizeof(Queue[0]))
+         {
+            Queue[NumberQueued++] = NumberAllocations;
+
+            AddOperation(0, Size, NumberAllocations++);
+         }
+      }
+
+      for(Index=0;Index<NumberQueued;Index++)
+         Owned[NumberOwned++] = Queue[Index];
+
+      for(Index=NumberOwned;Index>1;Index--)
+      {
+         Swap               = Random() % Index;
+         Kind               = Owned[Index - 1];
+         Owned[Index - 1]   = Owned[Swap];
+         Owned[Swap]        = Kind;
+      }
+
+      for(Index=0;Index<NumberOwned;Index++)
+         AddOperation(1, 0, Owned[Index]);
+   }
+}
+
+   /* The following function initializes the heap model to a single free */
+   /* block.                                                            */
+static void HeapInitialize(void)
+{
+   HeapFreeList            = (HeapHeader_t *)HeapBuffer;
+   HeapFreeList->NextBlock = NULL;
+   HeapFreeList->Size      = sizeof(HeapBuffer);
+}
+
+   /* The following function allocates from the heap model (first fit).  */
+static void *HeapAllocate(unsigned long Size)
+{
+   void          *ret_val;
+   unsigned long  BlockSize;
+   HeapHeader_t  *Block;
+   HeapHeader_t  *Remainder;
+   HeapHeader_t **Previous;
+
+   BlockSize = HEAP_HEADER_SIZE + ((Size + HEAP_ALIGNMENT - 1) & ~(HEAP_ALIGNMENT - 1));
+
+   for(Previous=&HeapFreeList;(*Previous) && ((*Previous)->Size < BlockSize);Previous=&((*Previous)->NextBlock))
+      ;
+
+   if((Block = *Previous) != NULL)
+   {
+      /* Split the block if the remainder can hold an allocation.       */
+      if(Block->Size >= BlockSize + HEAP_HEADER_SIZE + HEAP_ALIGNMENT)
+      {
+         Remainder            = (HeapHeader_t *)((unsigned char *)Block + BlockSize);
+         Remainder->NextBlock = Block->NextBlock;
+         Remainder->Size      = Block->Size - BlockSize;
+         Block->Size          = BlockSize;
+         *Previous            = Remainder;
+      }
+      else
+         *Previous = Block->NextBlock;
+
+      ret_val = (unsigned char *)Block + HEAP_HEADER_SIZE;
+   }
+   else
+      ret_val = NULL;
+
+   return(ret_val);
+}
+
+   /* The following function returns a block to the heap model and       */
+   /* merges it with the adjacent free blocks.                          */
+static void HeapFree(void *Block)
+{
+   HeapHeader_t  *Header;
+   HeapHeader_t  *Next;
+   HeapHeader_t **Previous;
+   HeapHeader_t  *PreviousBlock;
+
+   if(Block)
+   {
+      Header        = (HeapHeader_t *)((unsigned char *)Block - HEAP_HEADER_SIZE);
+      PreviousBlock = NULL;
+
+      for(Previous=&HeapFreeList;(*Previous) && (*Previous < Header);Previous=&((*Previous)->NextBlock))
+         PreviousBlock = *Previous;
+
+      Next              = *Previous;
+      Header->NextBlock = Next;
+      *Previous         = Header;
+
+      if((Next) && ((unsigned char *)Header + Header->Size == (unsigned char *)Next))
+      {
+         Header->Size      += Next->Size;
+         Header->NextBlock  = Next->NextBlock;
+      }
+
+      if((PreviousBlock) && ((unsigned char *)PreviousBlock + PreviousBlock->Size == (unsigned char *)Header))
+      {
+         PreviousBlock->Size      += Header->Size;
+         PreviousBlock->NextBlock  = Header->NextBlock;
+      }
+   }
+}
+
+   /* The following function returns the largest allocation the heap     */
+   /* model can serve.                                                  */
+static unsigned long HeapLargestFree(void)
+{
+   unsigned long  ret_val;
+   HeapHeader_t  *Block;
+
+   for(ret_val=0,Block=HeapFreeList;Block;Block=Block->NextBlock)
+   {
+      if(Block->Size - HEAP_HEADER_SIZE > ret_val)
+         ret_val = Block->Size - HEAP_HEADER_SIZE;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the free memory of the heap model.  */
+static unsigned long HeapTotalFree(void)
+{
+   unsigned long  ret_val;
+   HeapHeader_t  *Block;
+
+   for(ret_val=0,Block=HeapFreeList;Block;Block=Block->NextBlock)
+      ret_val += Block->Size - HEAP_HEADER_SIZE;
+
+   return(ret_val);
+}
+
+   /* The following function returns the largest allocation the pool can */
+   /* serve.                                                            */
+static unsigned long PoolLargestFree(void)
+{
+   unsigned long        ret_val;
+   unsigned int         Index;
+   MemPool_Statistics_t Statistics;
+
+   MemPool_QueryStatistics(&Statistics);
+
+   for(ret_val=0,Index=0;Index<Statistics.NumberClasses;Index++)
+   {
+      if(Statistics.ClassStatistics[Index].InUse < Statistics.ClassStatistics[Index].NumberBlocks)
+         ret_val = Statistics.ClassStatistics[Index].BlockSize;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the free memory of the pool.        */
+static unsigned long PoolTotalFree(void)
+{
+   unsigned long        ret_val;
+   unsigned int         Index;
+   MemPool_Statistics_t Statistics;
+
+   MemPool_QueryStatistics(&Statistics);
+
+   for(ret_val=0,Index=0;Index<Statistics.NumberClasses;Index++)
+      ret_val += (unsigned long)(Statistics.ClassStatistics[Index].NumberBlocks - Statistics.ClassStatistics[Index].InUse) * Statistics.ClassStatistics[Index].BlockSize;
+
+   return(ret_val);
+}
+
+   /* The following function returns the monotonic time in nanoseconds.  */
+static double Now(void)
+{
+   struct timespec Time;
+
+   clock_gettime(CLOCK_MONOTONIC, &Time);
+
+   return((double)Time.tv_sec * 1e9 + (double)Time.tv_nsec);
+}
+
+   /* The following function replays the trace against an allocator.     */
+   /* The timed replays are followed by one replay that measures the    */
+   /* fragmentation after every operation.  The worst case is that of   */
+   /* the operation with the longest fastest time, so that preemption of*/
+   /* the benchmark by the host does not count.                         */
+static void Replay(Allocator_t *Allocator, unsigned long Repeats, BenchResult_t *Result)
+{
+   unsigned long     Repeat;
+   unsigned long     Index;
+   unsigned long     Allocations;
+   unsigned long     Frees;
+   unsigned long     TotalFree;
+   double            Start;
+   double            Elapsed;
+   double            Fragmentation;
+   TraceOperation_t *Operation;
+
+   memset(Result, 0, sizeof(BenchResult_t));
+
+   Allocations = 0;
+   Frees       = 0;
+
+   for(Repeat=0;Repeat<=Repeats;Repeat++)
+   {
+      memset(Handles, 0, NumberAllocations * sizeof(void *));
+
+      for(Index=0,Operation=Trace;Index<NumberOperations;Index++,Operation++)
+      {
+         if(Repeat < Repeats)
+         {
+            if(Operation->Free)
+            {
+               Start = Now();
+               Allocator->Free(Handles[Operation->Handle]);
+               Elapsed = Now() - Start - TimerOverhead;
+
+               Handles[Operation->Handle] = NULL;
+
+               Result->FreeTime += Elapsed;
+
+               Frees++;
+            }
+            else
+            {
+               Start = Now();
+               Handles[Operation->Handle] = Allocator->Allocate(Operation->Size);
+               Elapsed = Now() - Start - TimerOverhead;
+
+               Result->AllocateTime += Elapsed;
+
+               if((!Repeat) && (!Handles[Operation->Handle]))
+                  Result->Failures++;
+
+               Allocations++;
+            }
+
+            if((!Repeat) || (Elapsed < OperationTime[Index]))
+               OperationTime[Index] = Elapsed;
+         }
+         else
+         {
+            if(Operation->Free)
+            {
+               Allocator->Free(Handles[Operation->Handle]);
+
+               Handles[Operation->Handle] = NULL;
+            }
+            else
+               Handles[Operation->Handle] = Allocator->Allocate(Operation->Size);
+
+            if((Allocator->TotalFree) && ((TotalFree = Allocator->TotalFree()) != 0))
+            {
+               Fragmentation = 1.0 - ((double)Allocator->LargestFree() / (double)TotalFree);
+
+               if(Fragmentation > Result->Fragmentation)
+                  Result->Fragmentation = Fragmentation;
+            }
+         }
+      }
+
+      /* Release what the trace left allocated.                         */
+      for(Index=0;Index<NumberAllocations;Index++)
+         Allocator->Free(Handles[Index]);
+   }
+
+   for(Index=0,Operation=Trace;Index<NumberOperations;Index++,Operation++)
+   {
+      if(Operation->Free)
+      {
+         if(OperationTime[Index] > Result->FreeMaximum)
+            Result->FreeMaximum = OperationTime[Index];
+      }
+      else
+      {
+         if(OperationTime[Index] > Result->AllocateMaximum)
+            Result->AllocateMaximum = OperationTime[Index];
+      }
+   }
+
+   if(Allocations)
+      Result->AllocateTime /= (double)Allocations;
+
+   if(Frees)
+      Result->FreeTime /= (double)Frees;
+
+   if(!Allocator->TotalFree)
+      Result->Fragmentation = -1.0;
+}
+
+   /* The following functions are the kernel functions used by the pool. */
+int BTPSAPI BTPS_OutputMessage(const char *Format, ...)
+{
+   int     ret_val;
+   va_list Arguments;
+
+   va_start(Arguments, Format);
+   ret_val = vprintf(Format, Arguments);
+   va_end(Arguments);
+
+   return(ret_val);
+}
+
+void BTPSAPI BTPS_MemInitialize(void *Destination, int Value, unsigned long Size)
+{
+   memset(Destination, Value, Size);
+}
+
+void BTPSAPI BTPS_MemCopy(void *Destination, const void *Source, unsigned long Size)
+{
+   memcpy(Destination, Source, Size);
+}
+
+int main(int argc, char *argv[])
+{
+   int           ret_val;
+   int           Index;
+   int           Skipped;
+   unsigned long Repeats;
+   unsigned long Cycles;
+   unsigned int  Allocator;
+   char         *FileName;
+   double        Elapsed;
+   FILE         *File;
+   BenchResult_t Result;
+   Allocator_t   AllocatorList[] =
+   {
+      { "MemPool", MemPool_Allocate, MemPool_Free, PoolLargestFree, PoolTotalFree },
+      { "Heap",    HeapAllocate,     HeapFree,     HeapLargestFree, HeapTotalFree },
+      { "malloc",  malloc,           free,         NULL,            NULL          }
+   };
+
+   Repeats  = DEFAULT_REPEATS;
+   Cycles   = DEFAULT_CYCLES;
+   FileName = NULL;
+   ret_val  = 0;
+
+   for(Index=1;Index<argc;Index++)
+   {
+      if((!strcmp(argv[Index], "-r")) && (Index + 1 < argc))
+         Repeats = strtoul(argv[++Index], NULL, 0);
+      else
+      {
+         if((!strcmp(argv[Index], "-n")) && (Index + 1 < argc))
+            Cycles = strtoul(argv[++Index], NULL, 0);
+         else
+         {
+            if((argv[Index][0] != '-') && (!FileName))
+               FileName = argv[Index];
+            else
+            {
+               fprintf(stderr, "Usage: %s [-r Repeats] [-n Cycles] [Trace File]\n", argv[0]);
+               return(2);
+            }
+         }
+      }
+   }
+
+   if(!Repeats)
+      Repeats = 1;
+
+   if(FileName)
+   {
+      if((File = fopen(FileName, "r")) == NULL)
+      {
+         perror(FileName);
+         return(2);
+      }
+
+      Skipped = ReadTrace(File);
+
+      fclose(File);
+
+      printf("Trace %s: %lu operations, %lu allocations", FileName, NumberOperations, NumberAllocations);
+
+      if(Skipped)
+         printf(", %d frees of earlier blocks skipped", Skipped);
+
+      printf(".\n");
+   }
+   else
+   {
+      GenerateTrace(Cycles);
+
+      printf("Synthetic trace: %lu cycles, %lu operations, %lu allocations.\n", Cycles, NumberOperations, NumberAllocations);
+   }
+
+   if(!NumberAllocations)
+   {
+      fprintf(stderr, "No allocations in the trace.\n");
+      return(2);
+   }
+
+   Handles       = malloc(NumberAllocations * sizeof(void *));
+   OperationTime = malloc(NumberOperations * sizeof(double));
+
+   if((!Handles) || (!OperationTime))
+   {
+      fprintf(stderr, "Out of memory.\n");
+      return(2);
+   }
+
+   for(Index=0,TimerOverhead=1e9;Index<1000;Index++)
+   {
+      Elapsed = Now();
+      Elapsed = Now() - Elapsed;
+
+      if(Elapsed < TimerOverhead)
+         TimerOverhead = Elapsed;
+   }
+
+   HeapInitialize();
+
+   printf("Pool and heap model: %u bytes each, %lu replays, times in ns less %.0f ns clock overhead.\n\n", (unsigned int)HEAP_SIZE, Repeats, TimerOverhead);
+   printf("%-10s %12s %12s %12s %12s %9s %14s\n", "Allocator", "Alloc mean", "Alloc worst", "Free mean", "Free worst", "Failures", "Fragmentation");
+
+   for(Allocator=0;Allocator<sizeof(AllocatorList)/sizeof(AllocatorList[0]);Allocator++)
+   {
+      Replay(&AllocatorList[Allocator], Repeats, &Result);
+
+      printf("%-10s %12.1f %12.0f %12.1f %12.0f %9lu ", AllocatorList[Allocator].Name, Result.AllocateTime, Result.AllocateMaximum, Result.FreeTime, Result.FreeMaximum, Result.Failures);
+
+      if(Result.Fragmentation >= 0.0)
+         printf("%13.1f%%\n", Result.Fragmentation * 100.0);
+      else
+         printf("%14s\n", "-");
+   }
+
+   /* Show the class usage of a single replay.                          */
+   MemPool_ResetStatistics();
+
+   memset(Handles, 0, NumberAllocations * sizeof(void *));
+
+   for(Index=0;(unsigned long)Index<NumberOperations;Index++)
+   {
+      if(Trace[Index].Free)
+         MemPool_Free(Handles[Trace[Index].Handle]);
+      else
+         Handles[Trace[Index].Handle] = MemPool_Allocate(Trace[Index].Size);
+   }
+
+   printf("\n");
+   MemPool_Display();
+
+   free(OperationTime);
+   free(Handles);
+   free(Trace);
+
+   return(ret_val);
+}
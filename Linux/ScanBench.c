@@ -0,0 +1,501 @@
+/*****< scanbench.c >**********************************************************/
+/*                                                                            */
+/*  ScanBench - Simulated beacons that load the LE scanner (Scan.c) on the    */
+/*              host.                                                         */
+/*                                                                            */
+/*              Each beacon advertises at its own interval (plus the 0-10 ms */
+/*              random delay of the link layer) with a noisy RSSI around its  */
+/*              own level.  Some beacons walk (their level drifts) and some   */
+/*              change their data now and then.  The reports are delivered   */
+/*              through the stand-in in LE Advertising Report events the way */
+/*              a controller batches them.  The time is simulated, so a run  */
+/*              with the same options and seed is repeatable.                 */
+/*                                                                            */
+/*              Reported are the reports the application received for each   */
+/*              reason, the first data and the data changes that never        */
+/*              reached it, the error of the delivered RSSI of the tracked    */
+/*              beacons against their level, and the host time spent in the   */
+/*              scan callback per report.                                     */
+/*                                                                            */
+/*  Build (from this directory):                                              */
+/*                                                                            */
+/*     gcc -O2 -IBluetopia -I.. -DSCAN_ENABLE -o ScanBench ScanBench.c        */
+/*         StandIn.c ../Scan.c ../BTSnoop.c ../Profile.c ../StackMark.c       */
+/*                                                                            */
+/*  Add -DSCAN_MAXIMUM_DEVICES=n or -DSCAN_BLOOM_BITS=n to the build to try   */
+/*  other table and filter sizes.                                             */
+/*                                                                            */
+/*  Usage: ScanBench [-n Beacons] [-d Seconds] [-i Min[:Max]] [-w Percent]    */
+/*                   [-c Percent] [-b Reports] [-s Seed]                      */
+/*                                                                            */
+/*     -n  Number of beacons (default 2000).                                  */
+/*     -d  Simulated duration in seconds (default 60).                        */
+/*     -i  Range of the advertising intervals in ms, each beacon picks one    */
+/*         (default 100:1000).                                                */
+/*     -w  Percentage of beacons that walk (default 10).                      */
+/*     -c  Percentage of beacons that change their data about every 10 s      */
+/*         (default 10).                                                      */
+/*     -b  Largest number of reports per event (default 4).                   */
+/*     -s  Seed of the simulation (default 1).                                */
+/*                                                                            */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "StandIn.h"       /* Bluetopia Stand-in Prototypes/Constants.        */
+#include "../BTSnoop.h"    /* HCI Traffic Capture Prototypes/Constants.       */
+#include "../Scan.h"       /* LE Scanner Prototypes/Constants.                */
+
+#define MAXIMUM_BEACONS                           (65536)  /* Denotes the      */
+                                                         /* largest number of*/
+                                                         /* beacons.         */
+
+#define DEFAULT_BEACONS                            (2000)  /* Denotes the      */
+                                                         /* default number of*/
+                                                         /* beacons.         */
+
+#define DEFAULT_DURATION                             (60)  /* Denotes the      */
+                                                         /* default simulated*/
+                                                         /* duration (s).    */
+
+#define DEFAULT_MINIMUM_INTERVAL                    (100)  /* Denotes the      */
+#define DEFAULT_MAXIMUM_INTERVAL                   (1000)  /* default range of */
+                                                         /* the advertising  */
+                                                         /* intervals (ms).  */
+
+#define DEFAULT_REPORTS_PER_EVENT                     (4)  /* Denotes the      */
+                                                         /* default number of*/
+                                                         /* reports per event*/
+
+#define MAXIMUM_REPORTS_PER_EVENT                     (6)  /* Denotes the      */
+                                                         /* largest number of*/
+                                                         /* reports per event*/
+                                                         /* (that fit into   */
+                                                         /* 255 bytes).      */
+
+#define CHANGE_PERIOD                             (10000)  /* Denotes the mean */
+                                                         /* time between data*/
+                                                         /* changes (ms).    */
+
+#define PROCESS_PERIOD                               (10)  /* Denotes how often*/
+                                                         /* the main loop of */
+                                                         /* the application  */
+                                                         /* runs (ms).       */
+
+#define BEACON_DATA_LENGTH                           (30)  /* Denotes the size */
+                                                         /* of the data (an  */
+                                                         /* iBeacon).        */
+
+#define BEACON_MAJOR_OFFSET                          (25)  /* Denotes where the*/
+                                                         /* data holds the   */
+                                                         /* number of the    */
+                                                         /* beacon (major)   */
+                                                         /* and the data     */
+                                                         /* version (minor). */
+
+   /* The following structure holds a simulated beacon.  Level is the    */
+   /* RSSI the noise is added to.  Version counts the data changes (Sent*/
+   /* is set once a report carried it), FirstVersion is the first one a */
+   /* report carried and DeliveredVersion the last one the application  */
+   /* received (-1 for none).                                           */
+typedef struct _tagBeacon_t
+{
+   BD_ADDR_t     BD_ADDR;
+   unsigned long Interval;
+   unsigned long NextEvent;
+   int           Level;
+   int           Walk;
+   Boolean_t     Changes;
+   unsigned long NextChange;
+   long          Version;
+   Boolean_t     Sent;
+   long          FirstVersion;
+   long          DeliveredVersion;
+   Boolean_t     Tracked;
+   int           DeliveredRSSI;
+} Beacon_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static Beacon_t           *Beacons;                 /* Variables which hold  */
+static unsigned int        NumberBeacons;           /* the beacons and the   */
+static unsigned int       *EventQueue;              /* heap of their next    */
+                                                    /* advertising events.   */
+
+static unsigned long       RandomState;             /* Variable which holds  */
+                                                    /* the random state.     */
+
+static unsigned long       Received[srLost + 1];    /* Variables which hold  */
+static unsigned long       MissedChanges;           /* the results.          */
+static unsigned long       Changes;
+static unsigned long       MissedFirst;
+static unsigned long       Heard;
+static unsigned long       Reports;
+static unsigned long       Events;
+static unsigned long long  CallbackTime;
+static unsigned long long  MaximumCallbackTime;
+
+   /* Internal function prototypes.                                     */
+static unsigned long Random(void);
+static void CommandCallback(Word_t OpCode, unsigned int ParameterLength, Byte_t *Parameters, unsigned long CallbackParameter);
+static void DispatchCallback(const char *Name, unsigned long long Time, unsigned long CallbackParameter);
+static void ReportCallback(Scan_Report_t *Report, unsigned long CallbackParameter);
+static void CountMissed(Beacon_t *Beacon);
+static unsigned int AddReport(Byte_t *Packet, Beacon_t *Beacon, unsigned long Time);
+static void SiftDown(unsigned int Position);
+
+   /* The following function returns a pseudo random number (xorshift).  */
+static unsigned long Random(void)
+{
+   RandomState ^= (RandomState << 13) & 0xFFFFFFFFUL;
+   RandomState ^= RandomState >> 17;
+   RandomState ^= RandomState << 5;
+   RandomState &= 0xFFFFFFFFUL;
+
+   return(RandomState);
+}
+
+   /* The following function receives the HCI commands of the stand-in, */
+   /* the simulated controller ignores them.                            */
+static void CommandCallback(Word_t OpCode, unsigned int ParameterLength, Byte_t *Parameters, unsigned long CallbackParameter)
+{
+}
+
+   /* The following function accounts the host time of the scan callback*/
+   /* for each event.                                                   */
+static void DispatchCallback(const char *Name, unsigned long long Time, unsigned long CallbackParameter)
+{
+   CallbackTime += Time;
+
+   if(Time > MaximumCallbackTime)
+      MaximumCallbackTime = Time;
+}
+
+   /* The following function is the report callback of the application, */
+   /* it checks the delivered reports against the beacons.              */
+static void ReportCallback(Scan_Report_t *Report, unsigned long CallbackParameter)
+{
+   unsigned int Number;
+
+   Received[Report->Reason]++;
+
+   Number = ((unsigned int)Report->BD_ADDR.BD_ADDR1 << 8) | Report->BD_ADDR.BD_ADDR0;
+
+   if(Number < NumberBeacons)
+   {
+      if((Report->Data) && (Report->Data_Length == BEACON_DATA_LENGTH))
+         Beacons[Number].DeliveredVersion = ((long)Report->Data[BEACON_MAJOR_OFFSET + 2] << 8) | Report->Data[BEACON_MAJOR_OFFSET + 3];
+
+      Beacons[Number].Tracked = (Boolean_t)((Report->Tracked) && (Report->Reason != srLost));
+
+      if(Report->Reason != srLost)
+         Beacons[Number].DeliveredRSSI = Report->RSSI;
+   }
+}
+
+   /* The following function counts the current data of a beacon as    */
+   /* missed if a report carried it and the application did not receive*/
+   /* it.  The first data of a beacon is counted apart from the changes.*/
+static void CountMissed(Beacon_t *Beacon)
+{
+   if((Beacon->Sent) && (Beacon->DeliveredVersion != Beacon->Version))
+   {
+      if(Beacon->Version == Beacon->FirstVersion)
+         MissedFirst++;
+      else
+         MissedChanges++;
+   }
+}
+
+   /* The following function adds the report of a beacon to an LE       */
+   /* Advertising Report event and returns its length.                  */
+static unsigned int AddReport(Byte_t *Packet, Beacon_t *Beacon, unsigned long Time)
+{
+   int          RSSI;
+   unsigned int Number;
+
+   Number = (unsigned int)(Beacon - Beacons);
+
+   /* The data changes before the report that carries it.               */
+   if((Beacon->Changes) && (Time >= Beacon->NextChange))
+   {
+      CountMissed(Beacon);
+
+      Beacon->Sent = FALSE;
+      Beacon->Version++;
+      Beacon->NextChange = Time + (CHANGE_PERIOD / 2) + (Random() % CHANGE_PERIOD);
+
+      /* Only a change after the first data is counted as one.          */
+      if(Beacon->FirstVersion >= 0)
+         Changes++;
+   }
+
+   /* A walking beacon drifts by a dB per second and turns around at    */
+   /* -40/-95 dBm, the noise is +/- 4 dB (triangular).                  */
+   if(Beacon->Walk)
+   {
+      Beacon->Level += (Beacon->Walk * (int)Beacon->Interval) / 1000;
+
+      if((Beacon->Level >= -40) || (Beacon->Level <= -95))
+         Beacon->Walk = -Beacon->Walk;
+   }
+
+   RSSI         = Beacon->Level + (int)(Random() % 5) + (int)(Random() % 5) - 4;
+   Beacon->Sent = TRUE;
+
+   if(Beacon->FirstVersion < 0)
+   {
+      Beacon->FirstVersion = Beacon->Version;
+
+      Heard++;
+   }
+
+   Packet[0] = 0x00;
+   Packet[1] = 0x01;
+
+   memcpy(&Packet[2], &Beacon->BD_ADDR, sizeof(BD_ADDR_t));
+
+   Packet[8] = BEACON_DATA_LENGTH;
+
+   /* Flags and an iBeacon with the number as major and the version as  */
+   /* minor.                                                            */
+   memcpy(&Packet[9], "\x02\x01\x06\x1A\xFF\x4C\x00\x02\x15\x53\x53\x31\x2D\x47\x41\x54\x54\x2D\x42\x65\x61\x63\x6F\x6E\x21", 25);
+
+   Packet[9 + BEACON_MAJOR_OFFSET]     = (Byte_t)(Number >> 8);
+   Packet[9 + BEACON_MAJOR_OFFSET + 1] = (Byte_t)Number;
+   Packet[9 + BEACON_MAJOR_OFFSET + 2] = (Byte_t)(Beacon->Version >> 8);
+   Packet[9 + BEACON_MAJOR_OFFSET + 3] = (Byte_t)Beacon->Version;
+   Packet[9 + BEACON_MAJOR_OFFSET + 4] = 0xC5;
+   Packet[9 + BEACON_DATA_LENGTH]      = (Byte_t)(SByte_t)RSSI;
+
+   return(10 + BEACON_DATA_LENGTH);
+}
+
+   /* The following function restores the heap order of the event queue */
+   /* from the specified position down.                                 */
+static void SiftDown(unsigned int Position)
+{
+   unsigned int Child;
+   unsigned int Entry;
+
+   Entry = EventQueue[Position];
+
+   while((Child = (2 * Position) + 1) < NumberBeacons)
+   {
+      if(((Child + 1) < NumberBeacons) && (Beacons[EventQueue[Child + 1]].NextEvent < Beacons[EventQueue[Child]].NextEvent))
+         Child++;
+
+      if(Beacons[EventQueue[Child]].NextEvent >= Beacons[Entry].NextEvent)
+         break;
+
+      EventQueue[Position] = EventQueue[Child];
+      Position             = Child;
+   }
+
+   EventQueue[Position] = Entry;
+}
+
+int main(int argc, char *argv[])
+{
+   int                Option;
+   int                Error;
+   char              *Separator;
+   double             Seconds;
+   Byte_t             Packet[3 + (MAXIMUM_REPORTS_PER_EVENT * (10 + BEACON_DATA_LENGTH))];
+   unsigned int       Index;
+   unsigned int       Length;
+   unsigned int       NumberReports;
+   unsigned int       ReportsPerEvent;
+   unsigned int       WalkPercent;
+   unsigned int       ChangePercent;
+   unsigned int       Tracked;
+   unsigned long      Duration;
+   unsigned long      MinimumInterval;
+   unsigned long      MaximumInterval;
+   unsigned long      Time;
+   unsigned long      ProcessTime;
+   unsigned long long ErrorSum;
+   struct timespec    Start;
+   struct timespec    End;
+   Scan_Statistics_t  Statistics;
+
+   NumberBeacons   = DEFAULT_BEACONS;
+   Duration        = DEFAULT_DURATION * 1000UL;
+   MinimumInterval = DEFAULT_MINIMUM_INTERVAL;
+   MaximumInterval = DEFAULT_MAXIMUM_INTERVAL;
+   ReportsPerEvent = DEFAULT_REPORTS_PER_EVENT;
+   WalkPercent     = 10;
+   ChangePercent   = 10;
+   RandomState     = 1;
+
+   while((Option = getopt(argc, argv, "n:d:i:w:c:b:s:")) != -1)
+   {
+      switch(Option)
+      {
+         case 'n':
+            NumberBeacons = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 'd':
+            Duration = (unsigned long)(strtod(optarg, NULL) * 1000.0);
+            break;
+         case 'i':
+            MinimumInterval = strtoul(optarg, &Separator, 0);
+            MaximumInterval = (*Separator == ':')?strtoul(Separator + 1, NULL, 0):MinimumInterval;
+            break;
+         case 'w':
+            WalkPercent = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 'c':
+            ChangePercent = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 'b':
+            ReportsPerEvent = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 's':
+            RandomState = strtoul(optarg, NULL, 0);
+            break;
+         default:
+            fprintf(stderr, "Usage: %s [-n Beacons] [-d Seconds] [-i Min[:Max]] [-w Percent] [-c Percent] [-b Reports] [-s Seed]\n", argv[0]);
+            return(2);
+      }
+   }
+
+   /* Advertising intervals range from 20 ms to 10.24 s.                */
+   if((!NumberBeacons) || (NumberBeacons > MAXIMUM_BEACONS) || (MinimumInterval < 20) || (MaximumInterval > 10240) || (MinimumInterval > MaximumInterval) || (WalkPercent > 100) || (ChangePercent > 100) || (!ReportsPerEvent) || (ReportsPerEvent > MAXIMUM_REPORTS_PER_EVENT) || (!RandomState))
+   {
+      fprintf(stderr, "Invalid options.\n");
+      return(2);
+   }
+
+   Beacons    = calloc(NumberBeacons, sizeof(Beacon_t));
+   EventQueue = calloc(NumberBeacons, sizeof(unsigned int));
+
+   if((!Beacons) || (!EventQueue))
+   {
+      fprintf(stderr, "Out of memory.\n");
+      return(2);
+   }
+
+   StandIn_Initialize(CommandCallback, 0);
+   StandIn_SetDispatchCallback(DispatchCallback, 0);
+   StandIn_SetTime(0);
+
+   if(Scan_Start(1, FALSE, SCAN_DEFAULT_INTERVAL, SCAN_DEFAULT_WINDOW, ReportCallback, 0))
+   {
+      fprintf(stderr, "Unable to start the scan.\n");
+      return(2);
+   }
+
+   /* Random static addresses, the number of the beacon in the low      */
+   /* bytes.                                                            */
+   for(Index=0;Index<NumberBeacons;Index++)
+   {
+      ASSIGN_BD_ADDR(Beacons[Index].BD_ADDR, 0xC0 | (Random() & 0x3F), (Byte_t)Random(), (Byte_t)Random(), (Byte_t)Random(), (Byte_t)(Index >> 8), (Byte_t)Index);
+
+      Beacons[Index].Interval         = MinimumInterval + (Random() % ((MaximumInterval - MinimumInterval) + 1));
+      Beacons[Index].NextEvent        = Random() % Beacons[Index].Interval;
+      Beacons[Index].Level            = -40 - (int)(Random() % 56);
+      Beacons[Index].Walk             = ((Random() % 100) < WalkPercent)?(((Random() % 2)?1:-1)):0;
+      Beacons[Index].Changes          = (Boolean_t)((Random() % 100) < ChangePercent);
+      Beacons[Index].NextChange       = Random() % CHANGE_PERIOD;
+      Beacons[Index].FirstVersion     = -1;
+      Beacons[Index].DeliveredVersion = -1;
+
+      EventQueue[Index] = Index;
+   }
+
+   for(Index=NumberBeacons/2;Index>0;Index--)
+      SiftDown(Index - 1);
+
+   ProcessTime = 0;
+
+   clock_gettime(CLOCK_MONOTONIC, &Start);
+
+   while((Time = Beacons[EventQueue[0]].NextEvent) < Duration)
+   {
+      /* The main loop of the application runs in between.              */
+      while(ProcessTime <= Time)
+      {
+         StandIn_SetTime(ProcessTime);
+         Scan_Process();
+
+         ProcessTime += PROCESS_PERIOD;
+      }
+
+      StandIn_SetTime(Time);
+
+      /* The reports that are due within a millisecond share an event.  */
+      Packet[0]     = 0x3E;
+      Packet[2]     = 0x02;
+      Length        = 4;
+      NumberReports = 0;
+
+      while((NumberReports < ReportsPerEvent) && (Beacons[EventQueue[0]].NextEvent <= (Time + 1)))
+      {
+         Length += AddReport(&Packet[Length], &Beacons[EventQueue[0]], Time);
+
+         NumberReports++;
+
+         Beacons[EventQueue[0]].NextEvent += Beacons[EventQueue[0]].Interval + (Random() % 11);
+
+         SiftDown(0);
+      }
+
+      Packet[1] = (Byte_t)(Length - 2);
+      Packet[3] = (Byte_t)NumberReports;
+
+      StandIn_ProcessPacket(BTSNOOP_DIRECTION_RECEIVED, HCI_EVENT_PACKET, Length, Packet);
+
+      Reports += NumberReports;
+      Events++;
+   }
+
+   clock_gettime(CLOCK_MONOTONIC, &End);
+
+   Seconds = (double)(End.tv_sec - Start.tv_sec) + ((double)(End.tv_nsec - Start.tv_nsec) / 1e9);
+
+   /* The data is also missed if the last version never arrived.        */
+   for(Index=0,Tracked=0,ErrorSum=0;Index<NumberBeacons;Index++)
+   {
+      CountMissed(&Beacons[Index]);
+
+      if(Beacons[Index].Tracked)
+      {
+         Error     = Beacons[Index].DeliveredRSSI - Beacons[Index].Level;
+         ErrorSum += (Error < 0)?-Error:Error;
+
+         Tracked++;
+      }
+   }
+
+   Scan_QueryStatistics(&Statistics);
+
+   printf("%u beacons, %lu to %lu ms intervals, %lu s simulated, %u%% walking, %u%% changing.\n\n", NumberBeacons, MinimumInterval, MaximumInterval, Duration / 1000, WalkPercent, ChangePercent);
+
+   printf("%-24s %10lu in %lu events\n", "Reports", Reports, Events);
+   printf("%-24s %10lu (%.2f%% of the reports)\n", "Delivered", Statistics.Delivered, Reports?(100.0 * (double)Statistics.Delivered / (double)Reports):0.0);
+   printf("%-24s %10lu\n", "   New", Received[srNew]);
+   printf("%-24s %10lu\n", "   Data Changed", Received[srDataChanged]);
+   printf("%-24s %10lu\n", "   RSSI Changed", Received[srRSSIChanged]);
+   printf("%-24s %10lu\n", "   Lost", Received[srLost]);
+   printf("%-24s %10lu tracked, %lu bloom\n", "Suppressed", Statistics.SuppressedTracked, Statistics.SuppressedBloom);
+   printf("%-24s %10lu\n", "Untracked", Statistics.Untracked);
+   printf("%-24s %10lu\n", "Evicted", Statistics.Evicted);
+   printf("%-24s %10lu of %lu beacons heard\n", "Missed First Data", MissedFirst, Heard);
+   printf("%-24s %10lu of %lu\n", "Missed Changes", MissedChanges, Changes);
+   printf("%-24s %10u beacons, %.2f dB mean error of the delivered RSSI\n", "Tracked", Tracked, Tracked?((double)ErrorSum / (double)Tracked):0.0);
+   printf("\n%-24s %10.1f ns per report, %.1f us worst event\n", "Scan Callback", Reports?((double)CallbackTime / (double)Reports):0.0, (double)MaximumCallbackTime / 1000.0);
+   printf("Host: %.3f s for the run.\n", Seconds);
+
+   Scan_Stop();
+
+   free(EventQueue);
+   free(Beacons);
+
+   return(0);
+}
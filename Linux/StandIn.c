@@ -0,0 +1,4569 @@
+/*****< standin.c >************************************************************/
+/*                                                                            */
+/*  StandIn - Host stand-in for the Bluetopia stack (Linux replay build).     */
+/*                                                                            */
+/*  Only the parts of the stack the application depends on are modeled:       */
+/*  the connection table, the GAP inquiry/name/authentication events, the     */
+/*  ATT requests of the GATT server, the GATT client procedures (service      */
+/*  discovery, read by UUID, write and server indications) and the            */
+/*  RFCOMM/AT level of the Hands-Free profile.  RFCOMM frames are recognized  */
+/*  by their header (the L2CAP signalling is not followed) and the            */
+/*  Hands-Free service level connection is considered open when the AG        */
+/*  acknowledges the last AT command of the setup that the stack sent         */
+/*  (AT+CHLD=? or AT+CMER).                                                   */
+/*                                                                            */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+
+#include "StandIn.h"          /* Bluetopia Stand-in Prototypes/Constants.     */
+#include "SS1BTHFR.h"         /* Hands-Free Stand-in Types/Prototypes.        */
+#include "SS1BTVS.h"          /* Vendor Specific Stand-in Prototypes.         */
+#include "HAL.h"              /* HAL Stand-in Prototypes.                     */
+#include "driverlib/flash.h"  /* Flash Driver Stand-in Prototypes.            */
+#include "../BTSnoop.h"       /* HCI Traffic Capture Constants.               */
+
+#define MAXIMUM_HCI_CALLBACKS                        (4)  /* Denotes the      */
+                                                         /* number of HCI    */
+                                                         /* event callbacks  */
+                                                         /* that can be      */
+                                                         /* registered.      */
+
+#ifndef MAXIMUM_CONNECTIONS
+
+#define MAXIMUM_CONNECTIONS                          (8)  /* Denotes the      */
+                                                         /* number of ACL,   */
+                                                         /* SCO and LE links */
+                                                         /* that are tracked.*/
+
+#endif
+
+#define MAXIMUM_PENDING_REQUESTS                     (4)  /* Denotes the      */
+                                                         /* number of        */
+                                                         /* outstanding name */
+                                                         /* requests and     */
+                                                         /* bonding          */
+                                                         /* procedures.      */
+
+#define MAXIMUM_INQUIRY_RESULTS                     (16)  /* Denotes the      */
+                                                         /* number of devices*/
+                                                         /* that are         */
+                                                         /* collected during */
+                                                         /* an inquiry.      */
+
+#define MAXIMUM_GATT_SERVICES                        (4)  /* Denotes the      */
+                                                         /* number of GATT   */
+                                                         /* services that can*/
+                                                         /* be registered.   */
+
+#define MAXIMUM_SERVICE_ATTRIBUTES                  (32)  /* Denotes the      */
+                                                         /* number of        */
+                                                         /* attributes of a  */
+                                                         /* service whose    */
+                                                         /* permissions are  */
+                                                         /* checked.         */
+
+#define MAXIMUM_HFRE_PORTS                           (4)  /* Denotes the      */
+                                                         /* number of HFRE   */
+                                                         /* server and client*/
+                                                         /* ports.           */
+
+#define MAXIMUM_INDICATORS                          (20)  /* Denotes the      */
+                                                         /* number of AG     */
+                                                         /* indicators that  */
+                                                         /* are tracked per  */
+                                                         /* port.            */
+
+#define MAXIMUM_INDICATOR_NAME                      (16)  /* Denotes the      */
+                                                         /* longest indicator*/
+                                                         /* name (including  */
+                                                         /* the terminator). */
+
+#define MAXIMUM_AT_LINE                            (256)  /* Denotes the      */
+                                                         /* longest AT line  */
+                                                         /* that is decoded  */
+                                                         /* (including the   */
+                                                         /* terminator).     */
+
+#define MAXIMUM_DEVICE_NAME                        (248)  /* Denotes the size */
+                                                         /* of the name      */
+                                                         /* parameter of the */
+                                                         /* HCI name         */
+                                                         /* commands/events. */
+
+#define MAXIMUM_ATT_MTU                            (517)  /* Denotes the      */
+                                                         /* largest ATT MTU. */
+
+#define MAXIMUM_ADVERTISING_REPORTS                 (25)  /* Denotes the      */
+                                                         /* number of reports*/
+                                                         /* that are decoded */
+                                                         /* from one LE      */
+                                                         /* Advertising      */
+                                                         /* Report event.    */
+
+#define MAXIMUM_DISCOVERY_SERVICES                  (32)  /* The following    */
+#define MAXIMUM_DISCOVERY_CHARACTERISTICS           (32)  /* constants denote */
+#define MAXIMUM_DISCOVERY_DESCRIPTORS               (64)  /* the services of a*/
+#define MAXIMUM_DISCOVERY_UUIDS                      (4)  /* service discovery*/
+                                                         /* and the          */
+                                                         /* characteristics  */
+                                                         /* and descriptors  */
+                                                         /* of one service   */
+                                                         /* that are kept,   */
+                                                         /* and the largest  */
+                                                         /* UUID filter.     */
+
+#define DEFAULT_ATT_MTU                             (23)  /* Denotes the ATT  */
+                                                         /* MTU of an LE link*/
+                                                         /* before it is     */
+                                                         /* exchanged.       */
+
+#define LINK_TYPE_SCO                             (0x00)  /* The following    */
+#define LINK_TYPE_ACL                             (0x01)  /* constants are the*/
+#define LINK_TYPE_ESCO                            (0x02)  /* link types of the*/
+#define LINK_TYPE_LE                              (0x80)  /* connection table */
+                                                         /* (LE is not an HCI*/
+                                                         /* value).          */
+
+#define L2CAP_CID_ATT                           (0x0004)  /* Denotes the fixed*/
+                                                         /* channel of ATT.  */
+
+#define L2CAP_CID_LE_SIGNALLING                 (0x0005)  /* Denotes the fixed*/
+                                                         /* channel of the LE*/
+                                                         /* signalling.      */
+
+#define L2CAP_CID_DYNAMIC_START                 (0x0040)  /* Denotes the first*/
+                                                         /* dynamically      */
+                                                         /* allocated        */
+                                                         /* channel.         */
+
+   /* The following constants are the LE signalling commands that are  */
+   /* used.                                                             */
+#define L2CAP_CODE_CONNECTION_PARAMETER_UPDATE_REQUEST   (0x12)
+#define L2CAP_CODE_CONNECTION_PARAMETER_UPDATE_RESPONSE  (0x13)
+
+   /* The following constants are the RFCOMM frame types (Poll/Final bit */
+   /* masked out).                                                      */
+#define RFCOMM_FRAME_SABM                         (0x2F)
+#define RFCOMM_FRAME_UA                           (0x63)
+#define RFCOMM_FRAME_DM                           (0x0F)
+#define RFCOMM_FRAME_DISC                         (0x43)
+#define RFCOMM_FRAME_UIH                          (0xEF)
+#define RFCOMM_POLL_FINAL_BIT                     (0x10)
+
+   /* The following constants are the HCI commands that are issued by the*/
+   /* stand-in.                                                         */
+#define HCI_OPCODE_INQUIRY                        (0x0401)
+#define HCI_OPCODE_CREATE_CONNECTION              (0x0405)
+#define HCI_OPCODE_DISCONNECT                     (0x0406)
+#define HCI_OPCODE_ACCEPT_CONNECTION_REQUEST      (0x0409)
+#define HCI_OPCODE_LINK_KEY_REQUEST_REPLY         (0x040B)
+#define HCI_OPCODE_LINK_KEY_REQUEST_NEGATIVE      (0x040C)
+#define HCI_OPCODE_PIN_CODE_REQUEST_REPLY         (0x040D)
+#define HCI_OPCODE_PIN_CODE_REQUEST_NEGATIVE      (0x040E)
+#define HCI_OPCODE_AUTHENTICATION_REQUESTED       (0x0411)
+#define HCI_OPCODE_REMOTE_NAME_REQUEST            (0x0419)
+#define HCI_OPCODE_READ_REMOTE_FEATURES           (0x041B)
+#define HCI_OPCODE_READ_CLOCK_OFFSET              (0x041F)
+#define HCI_OPCODE_SETUP_SYNCHRONOUS_CONNECTION   (0x0428)
+#define HCI_OPCODE_ACCEPT_SYNCHRONOUS_CONNECTION  (0x0429)
+#define HCI_OPCODE_IO_CAPABILITY_REQUEST_REPLY    (0x042B)
+#define HCI_OPCODE_USER_CONFIRMATION_REPLY        (0x042C)
+#define HCI_OPCODE_USER_CONFIRMATION_NEGATIVE     (0x042D)
+#define HCI_OPCODE_USER_PASSKEY_REPLY             (0x042E)
+#define HCI_OPCODE_REMOTE_OOB_DATA_NEGATIVE       (0x0433)
+#define HCI_OPCODE_SNIFF_MODE                     (0x0803)
+#define HCI_OPCODE_EXIT_SNIFF_MODE                (0x0804)
+#define HCI_OPCODE_WRITE_DEFAULT_LINK_POLICY      (0x080F)
+#define HCI_OPCODE_SNIFF_SUBRATING                (0x0811)
+#define HCI_OPCODE_DELETE_STORED_LINK_KEY         (0x0C12)
+#define HCI_OPCODE_WRITE_LOCAL_NAME               (0x0C13)
+#define HCI_OPCODE_WRITE_SCAN_ENABLE              (0x0C1A)
+#define HCI_OPCODE_WRITE_CLASS_OF_DEVICE          (0x0C24)
+#define HCI_OPCODE_WRITE_SIMPLE_PAIRING_MODE      (0x0C56)
+#define HCI_OPCODE_LE_SET_ADVERTISING_PARAMETERS  (0x2006)
+#define HCI_OPCODE_LE_SET_ADVERTISING_DATA        (0x2008)
+#define HCI_OPCODE_LE_SET_SCAN_RESPONSE_DATA      (0x2009)
+#define HCI_OPCODE_LE_SET_ADVERTISE_ENABLE        (0x200A)
+#define HCI_OPCODE_LE_SET_SCAN_PARAMETERS         (0x200B)
+#define HCI_OPCODE_LE_SET_SCAN_ENABLE             (0x200C)
+
+   /* The following constants are the HCI events that are decoded.       */
+#define HCI_EVENT_INQUIRY_COMPLETE                  (0x01)
+#define HCI_EVENT_INQUIRY_RESULT                    (0x02)
+#define HCI_EVENT_CONNECTION_COMPLETE               (0x03)
+#define HCI_EVENT_CONNECTION_REQUEST                (0x04)
+#define HCI_EVENT_DISCONNECTION_COMPLETE            (0x05)
+#define HCI_EVENT_AUTHENTICATION_COMPLETE           (0x06)
+#define HCI_EVENT_REMOTE_NAME_REQUEST_COMPLETE      (0x07)
+#define HCI_EVENT_READ_REMOTE_FEATURES_COMPLETE     (0x0B)
+#define HCI_EVENT_MODE_CHANGE                       (0x14)
+#define HCI_EVENT_PIN_CODE_REQUEST                  (0x16)
+#define HCI_EVENT_LINK_KEY_REQUEST                  (0x17)
+#define HCI_EVENT_LINK_KEY_NOTIFICATION             (0x18)
+#define HCI_EVENT_READ_CLOCK_OFFSET_COMPLETE        (0x1C)
+#define HCI_EVENT_PAGE_SCAN_REPETITION_MODE_CHANGE  (0x20)
+#define HCI_EVENT_INQUIRY_RESULT_WITH_RSSI          (0x22)
+#define HCI_EVENT_SYNCHRONOUS_CONNECTION_COMPLETE   (0x2C)
+#define HCI_EVENT_SNIFF_SUBRATING                   (0x2E)
+#define HCI_EVENT_EXTENDED_INQUIRY_RESULT           (0x2F)
+#define HCI_EVENT_IO_CAPABILITY_REQUEST             (0x31)
+#define HCI_EVENT_IO_CAPABILITY_RESPONSE            (0x32)
+#define HCI_EVENT_USER_CONFIRMATION_REQUEST         (0x33)
+#define HCI_EVENT_USER_PASSKEY_REQUEST              (0x34)
+#define HCI_EVENT_REMOTE_OOB_DATA_REQUEST           (0x35)
+#define HCI_EVENT_USER_PASSKEY_NOTIFICATION         (0x3B)
+#define HCI_EVENT_KEYPRESS_NOTIFICATION             (0x3C)
+#define HCI_EVENT_LE_META                           (0x3E)
+#define HCI_LE_SUBEVENT_CONNECTION_COMPLETE         (0x01)
+#define HCI_LE_SUBEVENT_ADVERTISING_REPORT          (0x02)
+#define HCI_LE_SUBEVENT_CONNECTION_UPDATE_COMPLETE  (0x03)
+
+   /* The following constants are the ATT requests that are decoded.     */
+#define ATT_OPCODE_EXCHANGE_MTU_REQUEST             (0x02)
+#define ATT_OPCODE_EXCHANGE_MTU_RESPONSE            (0x03)
+#define ATT_OPCODE_FIND_INFORMATION_REQUEST         (0x04)
+#define ATT_OPCODE_READ_BY_TYPE_REQUEST             (0x08)
+#define ATT_OPCODE_READ_REQUEST                     (0x0A)
+#define ATT_OPCODE_READ_BLOB_REQUEST                (0x0C)
+#define ATT_OPCODE_WRITE_REQUEST                    (0x12)
+#define ATT_OPCODE_PREPARE_WRITE_REQUEST            (0x16)
+#define ATT_OPCODE_EXECUTE_WRITE_REQUEST            (0x18)
+#define ATT_OPCODE_READ_BY_GROUP_TYPE_REQUEST       (0x10)
+#define ATT_OPCODE_HANDLE_VALUE_CONFIRMATION        (0x1E)
+#define ATT_OPCODE_WRITE_COMMAND                    (0x52)
+
+   /* The following constants are the ATT responses that are sent.       */
+#define ATT_OPCODE_ERROR_RESPONSE                   (0x01)
+#define ATT_OPCODE_READ_RESPONSE                    (0x0B)
+#define ATT_OPCODE_READ_BLOB_RESPONSE               (0x0D)
+#define ATT_OPCODE_WRITE_RESPONSE                   (0x13)
+#define ATT_OPCODE_PREPARE_WRITE_RESPONSE           (0x17)
+#define ATT_OPCODE_EXECUTE_WRITE_RESPONSE           (0x19)
+
+   /* The following constants are the ATT responses and server initiated */
+   /* PDUs the GATT client decodes (responses have odd opcodes).        */
+#define ATT_OPCODE_FIND_INFORMATION_RESPONSE        (0x05)
+#define ATT_OPCODE_READ_BY_TYPE_RESPONSE            (0x09)
+#define ATT_OPCODE_READ_BY_GROUP_TYPE_RESPONSE      (0x11)
+#define ATT_OPCODE_HANDLE_VALUE_NOTIFICATION        (0x1B)
+#define ATT_OPCODE_HANDLE_VALUE_INDICATION          (0x1D)
+
+#define ATT_UUID_PRIMARY_SERVICE                  (0x2800)
+#define ATT_UUID_CHARACTERISTIC                   (0x2803)
+
+#define ATT_ERROR_READ_NOT_PERMITTED                (0x02)
+#define ATT_ERROR_WRITE_NOT_PERMITTED               (0x03)
+
+   /* The following constants are the result types of the HFRE Command   */
+   /* Result event.                                                     */
+#define HFRE_RESULT_TYPE_OK                            (0)
+#define HFRE_RESULT_TYPE_ERROR                         (1)
+
+   /* The following constant is the Close/Open Port status that is       */
+   /* reported when the AG refused the connection or dropped the link.  */
+#define HFRE_PORT_STATUS_FAILURE                       (1)
+
+   /* The following enumerated type represents the phase of a service   */
+   /* discovery.                                                        */
+typedef enum
+{
+   dpServices,
+   dpCharacteristics,
+   dpDescriptors
+} DiscoveryPhase_t;
+
+   /* The following structure holds a service discovery in progress.  The*/
+   /* primary services are found first, then the characteristics and    */
+   /* descriptors of one service after the other (each service is       */
+   /* reported when it is complete).                                    */
+typedef struct _tagDiscovery_t
+{
+   GATT_Service_Discovery_Event_Callback_t      Callback;
+   unsigned long                                CallbackParameter;
+   unsigned int                                 NumberOfUUID;
+   GATT_UUID_t                                  UUIDList[MAXIMUM_DISCOVERY_UUIDS];
+   DiscoveryPhase_t                             Phase;
+   Word_t                                       NextHandle;
+   unsigned int                                 NumberServices;
+   unsigned int                                 ServiceIndex;
+   GATT_Service_Information_t                   Services[MAXIMUM_DISCOVERY_SERVICES];
+   unsigned int                                 NumberCharacteristics;
+   unsigned int                                 CharacteristicIndex;
+   Word_t                                       DeclarationHandle[MAXIMUM_DISCOVERY_CHARACTERISTICS];
+   GATT_Characteristic_Information_t            Characteristics[MAXIMUM_DISCOVERY_CHARACTERISTICS];
+   unsigned int                                 NumberDescriptors;
+   GATT_Characteristic_Descriptor_Information_t Descriptors[MAXIMUM_DISCOVERY_DESCRIPTORS];
+} Discovery_t;
+
+   /* The following structure holds a tracked link.  The members after   */
+   /* RequestHandle hold the GATT client side (the request outstanding  */
+   /* to the remote server, its callback and a discovery in progress).  */
+typedef struct _tagConnection_t
+{
+   Boolean_t InUse;
+   Word_t    Handle;
+   BD_ADDR_t BD_ADDR;
+   Byte_t    LinkType;
+   Word_t    MTU;
+   unsigned int TransactionID;
+   Byte_t    RequestOpCode;
+   Word_t    RequestHandle;
+   Byte_t    ClientOpCode;
+   unsigned int ClientTransactionID;
+   unsigned int IndicationTransactionID;
+   unsigned int ServerIndicationTransactionID;
+   unsigned int ServerIndicationServiceID;
+   Boolean_t ServerIndicationRefused;
+   Word_t    PrepareOffset;
+   Word_t    PrepareLength;
+   Byte_t    PrepareValue[MAXIMUM_ATT_MTU];
+   GATT_Client_Event_Callback_t ClientCallback;
+   unsigned long ClientCallbackParameter;
+   Discovery_t *Discovery;
+} Connection_t;
+
+   /* The following structure holds an outstanding name request or       */
+   /* bonding procedure.                                                */
+typedef struct _tagPendingRequest_t
+{
+   Boolean_t            InUse;
+   BD_ADDR_t            BD_ADDR;
+   Boolean_t            WaitingForConnection;
+   GAP_Event_Callback_t Callback;
+   unsigned long        CallbackParameter;
+} PendingRequest_t;
+
+   /* The following structure holds a registered GATT service.  The type */
+   /* and flags of the attributes are kept to answer the requests the   */
+   /* stack answers itself (declarations and missing permissions).      */
+typedef struct _tagGATTService_t
+{
+   Boolean_t                    InUse;
+   unsigned int                 ServiceID;
+   Word_t                       StartingHandle;
+   unsigned int                 NumberOfAttributes;
+   Byte_t                       AttributeType[MAXIMUM_SERVICE_ATTRIBUTES];
+   Byte_t                       AttributeFlags[MAXIMUM_SERVICE_ATTRIBUTES];
+   GATT_Server_Event_Callback_t Callback;
+   unsigned long                CallbackParameter;
+} GATTService_t;
+
+   /* The following structure holds an HFRE server or client port.  The  */
+   /* indicator names and ranges are learned from the +CIND test        */
+   /* response of the AG.                                               */
+typedef struct _tagHFREPort_t
+{
+   Boolean_t             InUse;
+   unsigned int          PortID;
+   Boolean_t             ServerPort;
+   unsigned int          ServerChannel;
+   BD_ADDR_t             BD_ADDR;
+   HFRE_Event_Callback_t Callback;
+   unsigned long         CallbackParameter;
+   Boolean_t             Connecting;
+   Boolean_t             Connected;
+   Word_t                Handle;
+   Boolean_t             ServiceLevelConnection;
+   unsigned long         RemoteFeatures;
+   unsigned long         CallHoldSupport;
+   char                  LastCommand[MAXIMUM_AT_LINE];
+   unsigned int          NumberIndicators;
+   char                  IndicatorName[MAXIMUM_INDICATORS][MAXIMUM_INDICATOR_NAME];
+   unsigned int          IndicatorMaximum[MAXIMUM_INDICATORS];
+   Word_t                SCOHandle;
+} HFREPort_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+uint32_t StandIn_Flash[STAND_IN_FLASH_SIZE/sizeof(uint32_t)]; /* RAM that     */
+                                                    /* stands in for the  */
+                                                    /* flash pages of the */
+                                                    /* Peer Cache, the    */
+                                                    /* GATT client cache  */
+                                                    /* and the GATT       */
+                                                    /* database.          */
+
+static StandIn_Command_Callback_t CommandCallback;  /* Variables which hold  */
+static unsigned long       CommandCallbackParameter; /* the receiver of the   */
+                                                    /* issued commands.      */
+
+static StandIn_Response_Callback_t ResponseCallback; /* Variables which hold */
+static unsigned long       ResponseCallbackParameter; /* the receiver of the  */
+                                                    /* ATT responses.        */
+
+static StandIn_Signalling_Callback_t SignallingCallback; /* Variables which */
+static unsigned long       SignallingCallbackParameter; /* hold the receiver */
+static Byte_t              SignallingIdentifier;    /* of the LE signalling  */
+                                                    /* commands and the last */
+                                                    /* identifier used.      */
+
+static StandIn_Dispatch_Callback_t DispatchCallback; /* Variables which hold */
+static unsigned long       DispatchCallbackParameter; /* the receiver of the  */
+                                                    /* callback timing.      */
+
+static StandIn_Service_Callback_t ServiceCallback;  /* Variables which hold  */
+static unsigned long       ServiceCallbackParameter; /* the receiver of the   */
+                                                    /* registered services.  */
+
+static unsigned long       CurrentTime;             /* Variable which holds  */
+                                                    /* the replay time (ms). */
+
+static Boolean_t           Verbose;                 /* Variable which holds  */
+                                                    /* whether application   */
+                                                    /* output is shown.      */
+
+static Word_t              NextGATTHandle;          /* Variable which holds  */
+                                                    /* the handle of the next*/
+                                                    /* registered service.   */
+
+static HCI_Event_Callback_t HCICallback[MAXIMUM_HCI_CALLBACKS]; /* Variables  */
+static unsigned long       HCICallbackParameter[MAXIMUM_HCI_CALLBACKS]; /* which*/
+                                                    /* hold the registered   */
+                                                    /* HCI event callbacks.  */
+
+static GAP_Event_Callback_t AuthenticationCallback; /* Variables which hold  */
+static unsigned long       AuthenticationCallbackParameter; /* the remote     */
+                                                    /* authentication        */
+                                                    /* callback.             */
+
+static GAP_LE_Event_Callback_t LEAuthenticationCallback; /* Variables which   */
+static unsigned long       LEAuthenticationCallbackParameter; /* hold the LE  */
+                                                    /* remote authentication */
+                                                    /* callback.             */
+
+static GAP_LE_Event_Callback_t LEAdvertisingCallback; /* Variables which hold*/
+static unsigned long       LEAdvertisingCallbackParameter; /* the advertising*/
+static Boolean_t           Advertising;             /* in progress and its   */
+                                                    /* callback.             */
+
+static GAP_LE_Event_Callback_t LEScanCallback;      /* Variables which hold  */
+static unsigned long       LEScanCallbackParameter; /* the callback of the   */
+                                                    /* LE scan in progress.  */
+
+static GAP_LE_Advertising_Report_Data_t AdvertisingReports[MAXIMUM_ADVERTISING_REPORTS]; /* Variables*/
+static GAP_LE_Advertising_Data_Entry_t  AdvertisingDataEntries[MAXIMUM_ADVERTISING_REPORTS][HCI_LE_ADVERTISING_REPORT_DATA_MAX_DATA_ENTRIES]; /* which*/
+                                                    /* hold the decoded      */
+                                                    /* reports of an event.  */
+
+static GAP_Event_Callback_t InquiryCallback;        /* Variables which hold  */
+static unsigned long       InquiryCallbackParameter; /* the inquiry in        */
+static unsigned int        NumberInquiryResults;    /* progress and the      */
+static GAP_Inquiry_Data_t  InquiryResults[MAXIMUM_INQUIRY_RESULTS]; /* devices*/
+                                                    /* found so far.         */
+
+static PendingRequest_t    NameRequests[MAXIMUM_PENDING_REQUESTS]; /* Variables */
+static PendingRequest_t    BondingRequests[MAXIMUM_PENDING_REQUESTS]; /* which */
+                                                    /* hold the outstanding  */
+                                                    /* name requests and     */
+                                                    /* bonding procedures.   */
+
+static Connection_t        Connections[MAXIMUM_CONNECTIONS]; /* Variable which */
+                                                    /* holds the open links. */
+
+static GATT_Connection_Event_Callback_t GATTConnectionCallback; /* Variables  */
+static unsigned long       GATTConnectionCallbackParameter; /* which hold the */
+static GATTService_t       GATTServices[MAXIMUM_GATT_SERVICES]; /* GATT       */
+static unsigned int        NextGATTServiceID;       /* callbacks and the     */
+static unsigned int        NextTransactionID;       /* registered services.  */
+
+static HFREPort_t          HFREPorts[MAXIMUM_HFRE_PORTS]; /* Variables which  */
+static unsigned int        NextHFREPortID;          /* hold the HFRE ports.  */
+
+static Word_t              SCOPacketType;           /* Variables which hold  */
+static Word_t              SCOMaxLatency;           /* the parameters of the */
+static Byte_t              SCORetransmissionEffort; /* audio connections.    */
+
+static Boolean_t           Discoverable;            /* Variables which hold  */
+static Boolean_t           Connectable;             /* the local GAP         */
+static Boolean_t           SimplePairingEnabled;    /* settings.             */
+static Boolean_t           MaintainRole;
+static char                LocalName[MAXIMUM_DEVICE_NAME + 1];
+static Class_of_Device_t   LocalClassOfDevice;
+static unsigned long       ActiveFeatures;
+
+static unsigned int        NumberEventTypes;        /* Variables which hold  */
+static StandIn_Event_Statistics_t EventStatistics[STAND_IN_MAXIMUM_EVENT_TYPES];
+                                                    /* the handler timing of */
+                                                    /* each event type.      */
+
+static struct timespec     DispatchStartTime;       /* Variable which holds  */
+                                                    /* the start time of the */
+                                                    /* callback being timed. */
+
+   /* Internal function prototypes.                                     */
+static void SendCommand(Word_t OpCode, unsigned int Length, Byte_t *Parameters);
+static void SendHandleCommand(Word_t OpCode, Word_t Handle);
+static void SendScanEnable(void);
+static void BeginDispatch(void);
+static void EndDispatch(const char *Name);
+static BD_ADDR_t ReadBD_ADDR(Byte_t *Data);
+static void WriteBD_ADDR(Byte_t *Data, BD_ADDR_t BD_ADDR);
+static Connection_t *FindConnectionByHandle(Word_t Handle);
+static Connection_t *FindConnectionByBD_ADDR(BD_ADDR_t BD_ADDR, Byte_t LinkType);
+static Connection_t *AddConnection(Word_t Handle, BD_ADDR_t BD_ADDR, Byte_t LinkType);
+static PendingRequest_t *FindPendingRequest(PendingRequest_t *List, BD_ADDR_t BD_ADDR);
+static PendingRequest_t *AddPendingRequest(PendingRequest_t *List, BD_ADDR_t BD_ADDR, GAP_Event_Callback_t Callback, unsigned long CallbackParameter);
+static HFREPort_t *FindPortByID(unsigned int PortID);
+static HFREPort_t *FindPortByChannel(Word_t Handle, unsigned int ServerChannel);
+static HFREPort_t *FindPortByBD_ADDR(BD_ADDR_t BD_ADDR);
+static HFREPort_t *AddPort(void);
+static void DispatchHCIEvent(HCI_Event_Type_t Type, unsigned int Size, void *Data, const char *Name);
+static void DispatchGAPEvent(GAP_Event_Callback_t Callback, unsigned long CallbackParameter, GAP_Event_Type_t Type, unsigned int Size, void *Data, const char *Name);
+static void DispatchAuthenticationEvent(GAP_Authentication_Event_Data_t *AuthenticationData, const char *Name);
+static void DispatchGAPLEEvent(GAP_LE_Event_Type_t Type, unsigned int Size, void *Data, const char *Name);
+static void DispatchHFREEvent(HFREPort_t *Port, HFRE_Event_Type_t Type, unsigned int Size, void *Data, const char *Name);
+static void DispatchGATTConnectionEvent(GATT_Connection_Event_Type_t Type, void *Data, const char *Name);
+static void DispatchGATTServerEvent(GATTService_t *Service, GATT_Server_Event_Type_t Type, void *Data, const char *Name);
+static void DispatchGATTClientEvent(Connection_t *Connection, GATT_Client_Event_Type_t Type, void *Data, const char *Name);
+static void AddInquiryResult(BD_ADDR_t BD_ADDR, Byte_t PageScanRepetitionMode, Byte_t *ClassOfDevice, Word_t ClockOffset, SByte_t RSSI);
+static void ProcessAdvertisingReports(unsigned int Length, Byte_t *Data);
+static void ProcessEvent(unsigned int Length, Byte_t *Event);
+static void SendATTResponse(Connection_t *Connection, unsigned int Length, Byte_t *PDU);
+static void SendATTError(Connection_t *Connection, Byte_t RequestOpCode, Word_t Handle, Byte_t ErrorCode);
+static Connection_t *FindConnectionByTransactionID(unsigned int TransactionID);
+static void ProcessATTRequest(Connection_t *Connection, unsigned int Length, Byte_t *PDU);
+static void SendClientRequest(Connection_t *Connection, unsigned int Length, Byte_t *PDU);
+static void SendDiscoveryRequest(Connection_t *Connection, Byte_t OpCode, Word_t StartingHandle, Word_t EndingHandle, Word_t UUID);
+static Boolean_t MatchDiscoveryUUID(Discovery_t *Discovery, GATT_UUID_t *UUID);
+static void ReadUUID(GATT_UUID_t *UUID, unsigned int Length, Byte_t *Data);
+static void ContinueDiscovery(Connection_t *Connection);
+static void CompleteDiscovery(Connection_t *Connection, Byte_t Status);
+static void ProcessDiscoveryResponse(Connection_t *Connection, unsigned int Length, Byte_t *PDU);
+static void ProcessATTResponse(Connection_t *Connection, unsigned int Length, Byte_t *PDU);
+static void ProcessRFCOMMFrame(unsigned int Direction, Connection_t *Connection, unsigned int Length, Byte_t *Frame);
+static void ProcessATLine(HFREPort_t *Port, char *Line);
+static void ProcessACLData(unsigned int Direction, unsigned int Length, Byte_t *Packet);
+
+   /* The following function reports an HCI command the stack would     */
+   /* issue to the replay engine.                                       */
+static void SendCommand(Word_t OpCode, unsigned int Length, Byte_t *Parameters)
+{
+   if(CommandCallback)
+      (*CommandCallback)(OpCode, Length, Parameters, CommandCallbackParameter);
+}
+
+   /* The following function issues a command that only has a Connection */
+   /* Handle parameter.                                                 */
+static void SendHandleCommand(Word_t OpCode, Word_t Handle)
+{
+   Byte_t Parameters[2];
+
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(Parameters, Handle);
+
+   SendCommand(OpCode, sizeof(Parameters), Parameters);
+}
+
+   /* The following function issues the Write Scan Enable command for the*/
+   /* current discoverability and connectability.                       */
+static void SendScanEnable(void)
+{
+   Byte_t ScanEnable;
+
+   ScanEnable = (Byte_t)((Discoverable?0x01:0x00) | (Connectable?0x02:0x00));
+
+   SendCommand(HCI_OPCODE_WRITE_SCAN_ENABLE, sizeof(ScanEnable), &ScanEnable);
+}
+
+   /* The following function notes the start of an application callback.*/
+static void BeginDispatch(void)
+{
+   clock_gettime(CLOCK_MONOTONIC, &DispatchStartTime);
+}
+
+   /* The following function accounts the time since BeginDispatch() to  */
+   /* the specified event type.  The names are constant strings, so they*/
+   /* are compared by address.                                          */
+static void EndDispatch(const char *Name)
+{
+   unsigned int       Index;
+   struct timespec    Now;
+   unsigned long long Elapsed;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+
+   Elapsed = ((unsigned long long)(Now.tv_sec - DispatchStartTime.tv_sec) * 1000000000ULL) + (unsigned long long)Now.tv_nsec - (unsigned long long)DispatchStartTime.tv_nsec;
+
+   if(DispatchCallback)
+      (*DispatchCallback)(Name, Elapsed, DispatchCallbackParameter);
+
+   for(Index=0;(Index<NumberEventTypes) && (EventStatistics[Index].Name != Name);Index++)
+      ;
+
+   if(Index == NumberEventTypes)
+   {
+      if(NumberEventTypes == STAND_IN_MAXIMUM_EVENT_TYPES)
+         return;
+
+      EventStatistics[Index].Name = Name;
+      NumberEventTypes++;
+   }
+
+   EventStatistics[Index].Count++;
+   EventStatistics[Index].TotalTime += Elapsed;
+
+   if(Elapsed > EventStatistics[Index].MaximumTime)
+      EventStatistics[Index].MaximumTime = Elapsed;
+}
+
+   /* The following function reads a BD_ADDR in HCI (little endian)      */
+   /* order.                                                            */
+static BD_ADDR_t ReadBD_ADDR(Byte_t *Data)
+{
+   BD_ADDR_t BD_ADDR;
+
+   ASSIGN_BD_ADDR(BD_ADDR, Data[5], Data[4], Data[3], Data[2], Data[1], Data[0]);
+
+   return(BD_ADDR);
+}
+
+   /* The following function writes a BD_ADDR in HCI (little endian)     */
+   /* order.                                                            */
+static void WriteBD_ADDR(Byte_t *Data, BD_ADDR_t BD_ADDR)
+{
+   Data[0] = BD_ADDR.BD_ADDR0;
+   Data[1] = BD_ADDR.BD_ADDR1;
+   Data[2] = BD_ADDR.BD_ADDR2;
+   Data[3] = BD_ADDR.BD_ADDR3;
+   Data[4] = BD_ADDR.BD_ADDR4;
+   Data[5] = BD_ADDR.BD_ADDR5;
+}
+
+   /* The following function returns the link with the specified handle  */
+   /* or NULL if there is none.                                         */
+static Connection_t *FindConnectionByHandle(Word_t Handle)
+{
+   unsigned int  Index;
+   Connection_t *ret_val = NULL;
+
+   for(Index=0;(Index<MAXIMUM_CONNECTIONS) && (!ret_val);Index++)
+   {
+      if((Connections[Index].InUse) && (Connections[Index].Handle == Handle))
+         ret_val = &Connections[Index];
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the link of the specified type to   */
+   /* the specified device or NULL if there is none.                    */
+static Connection_t *FindConnectionByBD_ADDR(BD_ADDR_t BD_ADDR, Byte_t LinkType)
+{
+   unsigned int  Index;
+   Connection_t *ret_val = NULL;
+
+   for(Index=0;(Index<MAXIMUM_CONNECTIONS) && (!ret_val);Index++)
+   {
+      if((Connections[Index].InUse) && (Connections[Index].LinkType == LinkType) && (COMPARE_BD_ADDR(Connections[Index].BD_ADDR, BD_ADDR)))
+         ret_val = &Connections[Index];
+   }
+
+   return(ret_val);
+}
+
+   /* The following function adds a link to the connection table.  This */
+   /* function returns NULL if the table is full.                       */
+static Connection_t *AddConnection(Word_t Handle, BD_ADDR_t BD_ADDR, Byte_t LinkType)
+{
+   unsigned int  Index;
+   Connection_t *ret_val = NULL;
+
+   for(Index=0;(Index<MAXIMUM_CONNECTIONS) && (!ret_val);Index++)
+   {
+      if(!Connections[Index].InUse)
+      {
+         ret_val           = &Connections[Index];
+         ret_val->InUse    = TRUE;
+         ret_val->Handle   = Handle;
+         ret_val->BD_ADDR  = BD_ADDR;
+         ret_val->LinkType = LinkType;
+         ret_val->MTU      = DEFAULT_ATT_MTU;
+
+         ret_val->TransactionID           = 0;
+         ret_val->ClientOpCode            = 0;
+         ret_val->ClientTransactionID     = 0;
+         ret_val->IndicationTransactionID = 0;
+
+         ret_val->ServerIndicationTransactionID = 0;
+         ret_val->ServerIndicationServiceID     = 0;
+         ret_val->ServerIndicationRefused       = FALSE;
+         ret_val->ClientCallback          = NULL;
+         ret_val->Discovery               = NULL;
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the outstanding request of the      */
+   /* specified list for the specified device or NULL if there is none. */
+static PendingRequest_t *FindPendingRequest(PendingRequest_t *List, BD_ADDR_t BD_ADDR)
+{
+   unsigned int      Index;
+   PendingRequest_t *ret_val = NULL;
+
+   for(Index=0;(Index<MAXIMUM_PENDING_REQUESTS) && (!ret_val);Index++)
+   {
+      if((List[Index].InUse) && (COMPARE_BD_ADDR(List[Index].BD_ADDR, BD_ADDR)))
+         ret_val = &List[Index];
+   }
+
+   return(ret_val);
+}
+
+   /* The following function adds (or replaces) the outstanding request  */
+   /* for the specified device.  This function returns NULL if the list */
+   /* is full.                                                          */
+static PendingRequest_t *AddPendingRequest(PendingRequest_t *List, BD_ADDR_t BD_ADDR, GAP_Event_Callback_t Callback, unsigned long CallbackParameter)
+{
+   unsigned int      Index;
+   PendingRequest_t *ret_val;
+
+   if((ret_val = FindPendingRequest(List, BD_ADDR)) == NULL)
+   {
+      for(Index=0;(Index<MAXIMUM_PENDING_REQUESTS) && (!ret_val);Index++)
+      {
+         if(!List[Index].InUse)
+            ret_val = &List[Index];
+      }
+   }
+
+   if(ret_val)
+   {
+      ret_val->InUse                = TRUE;
+      ret_val->BD_ADDR              = BD_ADDR;
+      ret_val->WaitingForConnection = FALSE;
+      ret_val->Callback             = Callback;
+      ret_val->CallbackParameter    = CallbackParameter;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the HFRE port with the specified ID */
+   /* or NULL if there is none.                                         */
+static HFREPort_t *FindPortByID(unsigned int PortID)
+{
+   unsigned int  Index;
+   HFREPort_t   *ret_val = NULL;
+
+   for(Index=0;(Index<MAXIMUM_HFRE_PORTS) && (!ret_val);Index++)
+   {
+      if((HFREPorts[Index].InUse) && (HFREPorts[Index].PortID == PortID))
+         ret_val = &HFREPorts[Index];
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the HFRE port that handles the      */
+   /* specified server channel on the specified link.  A connected (or  */
+   /* connecting) port is preferred over a listening server port.       */
+static HFREPort_t *FindPortByChannel(Word_t Handle, unsigned int ServerChannel)
+{
+   unsigned int  Index;
+   HFREPort_t   *ret_val = NULL;
+   Connection_t *Connection;
+
+   Connection = FindConnectionByHandle(Handle);
+
+   for(Index=0;(Index<MAXIMUM_HFRE_PORTS) && (!ret_val);Index++)
+   {
+      if((HFREPorts[Index].InUse) && (HFREPorts[Index].ServerChannel == ServerChannel))
+      {
+         if(((HFREPorts[Index].Connected) && (HFREPorts[Index].Handle == Handle)) || ((HFREPorts[Index].Connecting) && (Connection) && (COMPARE_BD_ADDR(HFREPorts[Index].BD_ADDR, Connection->BD_ADDR))))
+            ret_val = &HFREPorts[Index];
+      }
+   }
+
+   for(Index=0;(Index<MAXIMUM_HFRE_PORTS) && (!ret_val);Index++)
+   {
+      if((HFREPorts[Index].InUse) && (HFREPorts[Index].ServerPort) && (!HFREPorts[Index].Connected) && (HFREPorts[Index].ServerChannel == ServerChannel))
+         ret_val = &HFREPorts[Index];
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the connected HFRE port of the      */
+   /* specified device or NULL if there is none.                        */
+static HFREPort_t *FindPortByBD_ADDR(BD_ADDR_t BD_ADDR)
+{
+   unsigned int  Index;
+   HFREPort_t   *ret_val = NULL;
+
+   for(Index=0;(Index<MAXIMUM_HFRE_PORTS) && (!ret_val);Index++)
+   {
+      if((HFREPorts[Index].InUse) && (HFREPorts[Index].Connected) && (COMPARE_BD_ADDR(HFREPorts[Index].BD_ADDR, BD_ADDR)))
+         ret_val = &HFREPorts[Index];
+   }
+
+   return(ret_val);
+}
+
+   /* The following function allocates an HFRE port.  This function     */
+   /* returns NULL if all ports are in use.                             */
+static HFREPort_t *AddPort(void)
+{
+   unsigned int  Index;
+   HFREPort_t   *ret_val = NULL;
+
+   for(Index=0;(Index<MAXIMUM_HFRE_PORTS) && (!ret_val);Index++)
+   {
+      if(!HFREPorts[Index].InUse)
+      {
+         ret_val = &HFREPorts[Index];
+
+         BTPS_MemInitialize(ret_val, 0, sizeof(HFREPort_t));
+
+         ret_val->InUse  = TRUE;
+         ret_val->PortID = ++NextHFREPortID;
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function passes an HCI event to every registered HCI */
+   /* event callback.                                                   */
+static void DispatchHCIEvent(HCI_Event_Type_t Type, unsigned int Size, void *Data, const char *Name)
+{
+   unsigned int     Index;
+   HCI_Event_Data_t EventData;
+
+   EventData.Event_Data_Type     = Type;
+   EventData.Event_Data_Size     = (Word_t)Size;
+   EventData.Event_Data.Void     = Data;
+
+   for(Index=0;Index<MAXIMUM_HCI_CALLBACKS;Index++)
+   {
+      if(HCICallback[Index])
+      {
+         BeginDispatch();
+         (*HCICallback[Index])(STAND_IN_BLUETOOTH_STACK_ID, &EventData, HCICallbackParameter[Index]);
+         EndDispatch(Name);
+      }
+   }
+}
+
+   /* The following function passes a GAP event to the specified         */
+   /* callback.                                                         */
+static void DispatchGAPEvent(GAP_Event_Callback_t Callback, unsigned long CallbackParameter, GAP_Event_Type_t Type, unsigned int Size, void *Data, const char *Name)
+{
+   GAP_Event_Data_t EventData;
+
+   if(Callback)
+   {
+      EventData.Event_Data_Type = Type;
+      EventData.Event_Data_Size = (Word_t)Size;
+
+      /* All members of the union are pointers.                         */
+      EventData.Event_Data.GAP_Inquiry_Event_Data = (GAP_Inquiry_Event_Data_t *)Data;
+
+      BeginDispatch();
+      (*Callback)(STAND_IN_BLUETOOTH_STACK_ID, &EventData, CallbackParameter);
+      EndDispatch(Name);
+   }
+}
+
+   /* The following function passes an authentication event to the      */
+   /* bonding procedure of the device or (if none is in progress) to the*/
+   /* remote authentication callback.                                   */
+static void DispatchAuthenticationEvent(GAP_Authentication_Event_Data_t *AuthenticationData, const char *Name)
+{
+   PendingRequest_t *Bonding;
+
+   if((Bonding = FindPendingRequest(BondingRequests, AuthenticationData->Remote_Device)) != NULL)
+      DispatchGAPEvent(Bonding->Callback, Bonding->CallbackParameter, etAuthentication, sizeof(GAP_Authentication_Event_Data_t), AuthenticationData, Name);
+   else
+      DispatchGAPEvent(AuthenticationCallback, AuthenticationCallbackParameter, etAuthentication, sizeof(GAP_Authentication_Event_Data_t), AuthenticationData, Name);
+}
+
+   /* The following function passes a GAP LE event to the remote         */
+   /* authentication callback and the callback of the advertising (if   */
+   /* that is a different one).                                         */
+static void DispatchGAPLEEvent(GAP_LE_Event_Type_t Type, unsigned int Size, void *Data, const char *Name)
+{
+   GAP_LE_Event_Data_t EventData;
+
+   EventData.Event_Data_Type = Type;
+   EventData.Event_Data_Size = (Word_t)Size;
+
+   /* All members of the union are pointers.                            */
+   EventData.Event_Data.GAP_LE_Connection_Complete_Event_Data = (GAP_LE_Connection_Complete_Event_Data_t *)Data;
+
+   if(LEAuthenticationCallback)
+   {
+      BeginDispatch();
+      (*LEAuthenticationCallback)(STAND_IN_BLUETOOTH_STACK_ID, &EventData, LEAuthenticationCallbackParameter);
+      EndDispatch(Name);
+   }
+
+   if((LEAdvertisingCallback) && ((LEAdvertisingCallback != LEAuthenticationCallback) || (LEAdvertisingCallbackParameter != LEAuthenticationCallbackParameter)))
+   {
+      BeginDispatch();
+      (*LEAdvertisingCallback)(STAND_IN_BLUETOOTH_STACK_ID, &EventData, LEAdvertisingCallbackParameter);
+      EndDispatch(Name);
+   }
+}
+
+   /* The following function passes an HFRE event to the callback of the*/
+   /* specified port.  The port ID is the first member of every HFRE    */
+   /* event structure.                                                  */
+static void DispatchHFREEvent(HFREPort_t *Port, HFRE_Event_Type_t Type, unsigned int Size, void *Data, const char *Name)
+{
+   HFRE_Event_Data_t EventData;
+
+   if((Port) && (Port->Callback))
+   {
+      *((unsigned int *)Data) = Port->PortID;
+
+      EventData.Event_Data_Type = Type;
+      EventData.Event_Data_Size = (Word_t)Size;
+
+      /* All members of the union are pointers.                         */
+      EventData.Event_Data.HFRE_Open_Port_Indication_Data = (HFRE_Open_Port_Indication_Data_t *)Data;
+
+      BeginDispatch();
+      (*Port->Callback)(STAND_IN_BLUETOOTH_STACK_ID, &EventData, Port->CallbackParameter);
+      EndDispatch(Name);
+   }
+}
+
+   /* The following function passes a GATT connection event to the      */
+   /* connection callback.                                              */
+static void DispatchGATTConnectionEvent(GATT_Connection_Event_Type_t Type, void *Data, const char *Name)
+{
+   GATT_Connection_Event_Data_t EventData;
+
+   if(GATTConnectionCallback)
+   {
+      EventData.Event_Data_Type = Type;
+      EventData.Event_Data_Size = 0;
+
+      /* All members of the union are pointers.                         */
+      EventData.Event_Data.GATT_Device_Connection_Data = (GATT_Device_Connection_Data_t *)Data;
+
+      BeginDispatch();
+      (*GATTConnectionCallback)(STAND_IN_BLUETOOTH_STACK_ID, &EventData, GATTConnectionCallbackParameter);
+      EndDispatch(Name);
+   }
+}
+
+   /* The following function passes a GATT server event to the callback */
+   /* of the specified service.                                         */
+static void DispatchGATTServerEvent(GATTService_t *Service, GATT_Server_Event_Type_t Type, void *Data, const char *Name)
+{
+   GATT_Server_Event_Data_t EventData;
+
+   if((Service) && (Service->Callback))
+   {
+      EventData.Event_Data_Type = Type;
+      EventData.Event_Data_Size = 0;
+
+      /* All members of the union are pointers.                         */
+      EventData.Event_Data.GATT_Read_Request_Data = (GATT_Read_Request_Data_t *)Data;
+
+      BeginDispatch();
+      (*Service->Callback)(STAND_IN_BLUETOOTH_STACK_ID, &EventData, Service->CallbackParameter);
+      EndDispatch(Name);
+   }
+}
+
+   /* The following function passes the answer to the request of the GATT*/
+   /* client outstanding on the specified link to its callback (the      */
+   /* request is done before the callback runs, so the callback may issue*/
+   /* the next one).                                                    */
+static void DispatchGATTClientEvent(Connection_t *Connection, GATT_Client_Event_Type_t Type, void *Data, const char *Name)
+{
+   unsigned long                ClientCallbackParameter;
+   GATT_Client_Event_Data_t     EventData;
+   GATT_Client_Event_Callback_t ClientCallback;
+
+   ClientCallback          = Connection->ClientCallback;
+   ClientCallbackParameter = Connection->ClientCallbackParameter;
+
+   Connection->ClientOpCode        = 0;
+   Connection->ClientTransactionID = 0;
+   Connection->ClientCallback      = NULL;
+
+   if(ClientCallback)
+   {
+      EventData.Event_Data_Type = Type;
+      EventData.Event_Data_Size = 0;
+
+      /* All members of the union are pointers.                         */
+      EventData.Event_Data.GATT_Read_Response_Data = (GATT_Read_Response_Data_t *)Data;
+
+      BeginDispatch();
+      (*ClientCallback)(STAND_IN_BLUETOOTH_STACK_ID, &EventData, ClientCallbackParameter);
+      EndDispatch(Name);
+   }
+}
+
+   /* The following function reports a device found by the inquiry in    */
+   /* progress (Inquiry Entry Result) and collects it for the Inquiry   */
+   /* Result that is reported when the inquiry completes.               */
+static void AddInquiryResult(BD_ADDR_t BD_ADDR, Byte_t PageScanRepetitionMode, Byte_t *ClassOfDevice, Word_t ClockOffset, SByte_t RSSI)
+{
+   unsigned int                   Index;
+   GAP_Inquiry_Entry_Event_Data_t EntryData;
+
+   BTPS_MemInitialize(&EntryData, 0, sizeof(EntryData));
+
+   EntryData.BD_ADDR                   = BD_ADDR;
+   EntryData.Page_Scan_Repetition_Mode = PageScanRepetitionMode;
+   EntryData.Clock_Offset              = ClockOffset;
+   EntryData.RSSI                      = RSSI;
+
+   ASSIGN_CLASS_OF_DEVICE(EntryData.Class_of_Device, ClassOfDevice[2], ClassOfDevice[1], ClassOfDevice[0]);
+
+   DispatchGAPEvent(InquiryCallback, InquiryCallbackParameter, etInquiry_Entry_Result, sizeof(EntryData), &EntryData, "GAP Inquiry Entry Result");
+
+   for(Index=0;(Index<NumberInquiryResults) && (!COMPARE_BD_ADDR(InquiryResults[Index].BD_ADDR, BD_ADDR));Index++)
+      ;
+
+   if(Index < MAXIMUM_INQUIRY_RESULTS)
+   {
+      InquiryResults[Index].BD_ADDR                   = BD_ADDR;
+      InquiryResults[Index].Page_Scan_Repetition_Mode = PageScanRepetitionMode;
+      InquiryResults[Index].Class_of_Device           = EntryData.Class_of_Device;
+      InquiryResults[Index].Clock_Offset              = ClockOffset;
+
+      if(Index == NumberInquiryResults)
+         NumberInquiryResults++;
+   }
+}
+
+   /* The following function decodes the reports of an LE Advertising   */
+   /* Report event (after the subevent code) and passes them to the scan*/
+   /* callback.  The controller sends the fields of each report together*/
+   /* (type, address type, address, data length, data, RSSI).  The      */
+   /* decoding stops at the first report that does not fit the event.  */
+static void ProcessAdvertisingReports(unsigned int Length, Byte_t *Data)
+{
+   unsigned int                           Index;
+   unsigned int                           Offset;
+   unsigned int                           DataOffset;
+   unsigned int                           NumberReports;
+   unsigned int                           NumberEntries;
+   Byte_t                                 DataLength;
+   GAP_LE_Event_Data_t                    EventData;
+   GAP_LE_Advertising_Report_Event_Data_t ReportData;
+
+   if((LEScanCallback) && (Length))
+   {
+      NumberReports = Data[0];
+      Offset        = 1;
+
+      if(NumberReports > MAXIMUM_ADVERTISING_REPORTS)
+         NumberReports = MAXIMUM_ADVERTISING_REPORTS;
+
+      for(Index=0;Index<NumberReports;Index++)
+      {
+         if((Offset + 9) > Length)
+            break;
+
+         DataLength = Data[Offset + 8];
+
+         if((DataLength > 31) || ((Offset + 10 + DataLength) > Length))
+            break;
+
+         AdvertisingReports[Index].Advertising_Report_Type = (GAP_LE_Advertising_Report_Type_t)Data[Offset];
+         AdvertisingReports[Index].Address_Type            = (GAP_LE_Address_Type_t)Data[Offset + 1];
+         AdvertisingReports[Index].BD_ADDR                 = ReadBD_ADDR(&Data[Offset + 2]);
+         AdvertisingReports[Index].Raw_Report_Length       = DataLength;
+         AdvertisingReports[Index].Raw_Report_Data         = &Data[Offset + 9];
+         AdvertisingReports[Index].RSSI                    = (SByte_t)Data[Offset + 9 + DataLength];
+
+         /* The stack also splits the data into its AD structures.      */
+         NumberEntries = 0;
+         DataOffset    = 0;
+
+         while(((DataOffset + 1) < DataLength) && (Data[Offset + 9 + DataOffset]) && ((DataOffset + 1 + Data[Offset + 9 + DataOffset]) <= DataLength) && (NumberEntries < HCI_LE_ADVERTISING_REPORT_DATA_MAX_DATA_ENTRIES))
+         {
+            AdvertisingDataEntries[Index][NumberEntries].AD_Type        = Data[Offset + 10 + DataOffset];
+            AdvertisingDataEntries[Index][NumberEntries].AD_Data_Length = (Byte_t)(Data[Offset + 9 + DataOffset] - 1);
+            AdvertisingDataEntries[Index][NumberEntries].AD_Data_Buffer = &Data[Offset + 11 + DataOffset];
+
+            NumberEntries++;
+            DataOffset += 1 + Data[Offset + 9 + DataOffset];
+         }
+
+         AdvertisingReports[Index].Advertising_Data.Number_Data_Entries = NumberEntries;
+         AdvertisingReports[Index].Advertising_Data.Data_Entries        = AdvertisingDataEntries[Index];
+
+         Offset += 10 + DataLength;
+      }
+
+      if(Index)
+      {
+         ReportData.Number_Device_Entries = Index;
+         ReportData.Advertising_Data      = AdvertisingReports;
+
+         EventData.Event_Data_Type                                 = etLE_Advertising_Report;
+         EventData.Event_Data_Size                                 = sizeof(ReportData);
+         EventData.Event_Data.GAP_LE_Advertising_Report_Event_Data = &ReportData;
+
+         BeginDispatch();
+         (*LEScanCallback)(STAND_IN_BLUETOOTH_STACK_ID, &EventData, LEScanCallbackParameter);
+         EndDispatch("GAP LE Advertising Report");
+      }
+   }
+}
+
+   /* The following function decodes a received HCI event (without the   */
+   /* packet type) and dispatches the resulting stack events.           */
+static void ProcessEvent(unsigned int Length, Byte_t *Event)
+{
+   Byte_t                                                    Parameters[21];
+   Byte_t                                                   *Data;
+   Word_t                                                    Handle;
+   BD_ADDR_t                                                 BD_ADDR;
+   HFREPort_t                                               *Port;
+   unsigned int                                              Index;
+   unsigned int                                              Count;
+   unsigned int                                              DataLength;
+   Connection_t                                             *Connection;
+   PendingRequest_t                                         *Request;
+   char                                                      RemoteName[MAXIMUM_DEVICE_NAME + 1];
+   GAP_Inquiry_Event_Data_t                                  InquiryData;
+   GAP_Remote_Name_Event_Data_t                              RemoteNameData;
+   GAP_Authentication_Event_Data_t                           AuthenticationData;
+   GAP_LE_Disconnection_Complete_Event_Data_t                LEDisconnectionData;
+   GAP_LE_Connection_Complete_Event_Data_t                   LEConnectionData;
+   GAP_LE_Connection_Parameter_Updated_Event_Data_t          LEUpdatedData;
+   GATT_Device_Connection_Data_t                             GATTConnectionData;
+   HCI_Connection_Complete_Event_Data_t                      ConnectionCompleteData;
+   HCI_Disconnection_Complete_Event_Data_t                   DisconnectionCompleteData;
+   HCI_Read_Clock_Offset_Complete_Event_Data_t               ClockOffsetData;
+   HCI_Read_Remote_Supported_Features_Complete_Event_Data_t  FeaturesData;
+   HCI_Page_Scan_Repetition_Mode_Change_Event_Data_t         PageScanData;
+   HCI_Mode_Change_Event_Data_t                              ModeChangeData;
+   HCI_Sniff_Subrating_Event_Data_t                          SniffSubratingData;
+   HCI_Synchronous_Connection_Complete_Event_Data_t          SynchronousData;
+   HFRE_Open_Port_Confirmation_Data_t                        OpenPortConfirmationData;
+   HFRE_Close_Port_Indication_Data_t                         ClosePortData;
+   HFRE_Audio_Connection_Indication_Data_t                   AudioConnectionData;
+   HFRE_Audio_Disconnection_Indication_Data_t                AudioDisconnectionData;
+
+   /* Make sure the event is complete (events are never truncated by   */
+   /* the capture).                                                    */
+   if((Length < 2) || (Length < (unsigned int)(2 + Event[1])))
+      return;
+
+   Data       = &Event[2];
+   DataLength = Event[1];
+
+   BTPS_MemInitialize(&AuthenticationData, 0, sizeof(AuthenticationData));
+
+   switch(Event[0])
+   {
+      case HCI_EVENT_INQUIRY_RESULT:
+         if((DataLength >= 1) && (DataLength >= (1 + ((unsigned int)Data[0] * 14))))
+         {
+            /* The parameters are arrays of Num_Responses entries.      */
+            Count = Data[0];
+
+            for(Index=0;Index<Count;Index++)
+               AddInquiryResult(ReadBD_ADDR(&Data[1 + (Index * 6)]), Data[1 + (Count * 6) + Index], &Data[1 + (Count * 9) + (Index * 3)], READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[1 + (Count * 12) + (Index * 2)]), 0);
+         }
+         break;
+      case HCI_EVENT_INQUIRY_RESULT_WITH_RSSI:
+         if((DataLength >= 1) && (DataLength >= (1 + ((unsigned int)Data[0] * 14))))
+         {
+            Count = Data[0];
+
+            for(Index=0;Index<Count;Index++)
+               AddInquiryResult(ReadBD_ADDR(&Data[1 + (Index * 6)]), Data[1 + (Count * 6) + Index], &Data[1 + (Count * 8) + (Index * 3)], READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[1 + (Count * 11) + (Index * 2)]), (SByte_t)Data[1 + (Count * 13) + Index]);
+         }
+         break;
+      case HCI_EVENT_EXTENDED_INQUIRY_RESULT:
+         if(DataLength >= 15)
+            AddInquiryResult(ReadBD_ADDR(&Data[1]), Data[7], &Data[9], READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[12]), (SByte_t)Data[14]);
+         break;
+      case HCI_EVENT_INQUIRY_COMPLETE:
+         InquiryData.Number_Devices   = (Word_t)NumberInquiryResults;
+         InquiryData.GAP_Inquiry_Data = InquiryResults;
+
+         DispatchGAPEvent(InquiryCallback, InquiryCallbackParameter, etInquiry_Result, sizeof(InquiryData), &InquiryData, "GAP Inquiry Result");
+
+         InquiryCallback      = NULL;
+         NumberInquiryResults = 0;
+         break;
+      case HCI_EVENT_REMOTE_NAME_REQUEST_COMPLETE:
+         if(DataLength >= 7)
+         {
+            BD_ADDR = ReadBD_ADDR(&Data[1]);
+
+            if((Request = FindPendingRequest(NameRequests, BD_ADDR)) != NULL)
+            {
+               BTPS_MemInitialize(RemoteName, 0, sizeof(RemoteName));
+               BTPS_MemCopy(RemoteName, &Data[7], ((DataLength - 7) < MAXIMUM_DEVICE_NAME)?(DataLength - 7):MAXIMUM_DEVICE_NAME);
+
+               RemoteNameData.Remote_Name_Status = Data[0];
+               RemoteNameData.Remote_Device      = BD_ADDR;
+               RemoteNameData.Remote_Name        = (Data[0] == HCI_ERROR_CODE_NO_ERROR)?RemoteName:NULL;
+
+               Request->InUse = FALSE;
+
+               DispatchGAPEvent(Request->Callback, Request->CallbackParameter, etRemote_Name_Result, sizeof(RemoteNameData), &RemoteNameData, "GAP Remote Name Result");
+            }
+         }
+         break;
+      case HCI_EVENT_CONNECTION_REQUEST:
+         if(DataLength >= 10)
+         {
+            /* The stack accepts every connection, SCO links are        */
+            /* accepted by HFRE (8 kHz CVSD with the parameters set     */
+            /* through the SCO API).                                    */
+            if(Data[9] == LINK_TYPE_ACL)
+            {
+               BTPS_MemCopy(Parameters, Data, 6);
+               Parameters[6] = (Byte_t)(MaintainRole?0x01:0x00);
+
+               SendCommand(HCI_OPCODE_ACCEPT_CONNECTION_REQUEST, 7, Parameters);
+            }
+            else
+            {
+               BTPS_MemCopy(Parameters, Data, 6);
+               ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[6], 0x1F40);
+               ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[8], 0x0000);
+               ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[10], 0x1F40);
+               ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[12], 0x0000);
+               ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[14], SCOMaxLatency);
+               ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[16], 0x0060);
+               Parameters[18] = SCORetransmissionEffort;
+               ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[19], SCOPacketType);
+
+               SendCommand(HCI_OPCODE_ACCEPT_SYNCHRONOUS_CONNECTION, sizeof(Parameters), Parameters);
+            }
+         }
+         break;
+      case HCI_EVENT_CONNECTION_COMPLETE:
+         if(DataLength >= 11)
+         {
+            ConnectionCompleteData.Status            = Data[0];
+            ConnectionCompleteData.Connection_Handle = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[1]);
+            ConnectionCompleteData.BD_ADDR           = ReadBD_ADDR(&Data[3]);
+            ConnectionCompleteData.Link_Type         = Data[9];
+            ConnectionCompleteData.Encryption_Mode   = Data[10];
+
+            if(ConnectionCompleteData.Status == HCI_ERROR_CODE_NO_ERROR)
+               AddConnection(ConnectionCompleteData.Connection_Handle, ConnectionCompleteData.BD_ADDR, ConnectionCompleteData.Link_Type);
+
+            DispatchHCIEvent(etConnection_Complete_Event, sizeof(ConnectionCompleteData), &ConnectionCompleteData, "HCI Connection Complete");
+
+            if(ConnectionCompleteData.Link_Type == LINK_TYPE_ACL)
+            {
+               /* A bonding procedure that waited for the link starts   */
+               /* the authentication now.                               */
+               if(((Request = FindPendingRequest(BondingRequests, ConnectionCompleteData.BD_ADDR)) != NULL) && (Request->WaitingForConnection))
+               {
+                  Request->WaitingForConnection = FALSE;
+
+                  if(ConnectionCompleteData.Status == HCI_ERROR_CODE_NO_ERROR)
+                     SendHandleCommand(HCI_OPCODE_AUTHENTICATION_REQUESTED, ConnectionCompleteData.Connection_Handle);
+                  else
+                  {
+                     AuthenticationData.GAP_Authentication_Event_Type                    = atAuthenticationStatus;
+                     AuthenticationData.Remote_Device                                    = ConnectionCompleteData.BD_ADDR;
+                     AuthenticationData.Authentication_Event_Data.Authentication_Status = ConnectionCompleteData.Status;
+
+                     DispatchAuthenticationEvent(&AuthenticationData, "GAP Authentication Status");
+
+                     Request->InUse = FALSE;
+                  }
+               }
+
+               /* A client port that waited for the link fails if the   */
+               /* page failed.                                          */
+               if(ConnectionCompleteData.Status != HCI_ERROR_CODE_NO_ERROR)
+               {
+                  for(Index=0;Index<MAXIMUM_HFRE_PORTS;Index++)
+                  {
+                     if((HFREPorts[Index].InUse) && (HFREPorts[Index].Connecting) && (COMPARE_BD_ADDR(HFREPorts[Index].BD_ADDR, ConnectionCompleteData.BD_ADDR)))
+                     {
+                        HFREPorts[Index].Connecting             = FALSE;
+                        OpenPortConfirmationData.PortOpenStatus = HFRE_PORT_STATUS_FAILURE;
+
+                        DispatchHFREEvent(&HFREPorts[Index], etHFRE_Open_Port_Confirmation, sizeof(OpenPortConfirmationData), &OpenPortConfirmationData, "HFRE Open Port Confirmation");
+                     }
+                  }
+               }
+            }
+         }
+         break;
+      case HCI_EVENT_SYNCHRONOUS_CONNECTION_COMPLETE:
+         if(DataLength >= 17)
+         {
+            SynchronousData.Status                = Data[0];
+            SynchronousData.Connection_Handle     = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[1]);
+            SynchronousData.BD_ADDR               = ReadBD_ADDR(&Data[3]);
+            SynchronousData.Link_Type             = Data[9];
+            SynchronousData.Transmission_Interval = Data[10];
+            SynchronousData.Retransmission_Window = Data[11];
+            SynchronousData.Rx_Packet_Length      = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[12]);
+            SynchronousData.Tx_Packet_Length      = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[14]);
+            SynchronousData.Air_Mode              = Data[16];
+
+            if(SynchronousData.Status == HCI_ERROR_CODE_NO_ERROR)
+               AddConnection(SynchronousData.Connection_Handle, SynchronousData.BD_ADDR, SynchronousData.Link_Type);
+
+            DispatchHCIEvent(etSynchronous_Connection_Complete_Event, sizeof(SynchronousData), &SynchronousData, "HCI Synchronous Connection Complete");
+
+            if((Port = FindPortByBD_ADDR(SynchronousData.BD_ADDR)) != NULL)
+            {
+               if(SynchronousData.Status == HCI_ERROR_CODE_NO_ERROR)
+                  Port->SCOHandle = SynchronousData.Connection_Handle;
+
+               AudioConnectionData.AudioConnectionOpenStatus = SynchronousData.Status;
+
+               DispatchHFREEvent(Port, etHFRE_Audio_Connection_Indication, sizeof(AudioConnectionData), &AudioConnectionData, "HFRE Audio Connection Indication");
+            }
+         }
+         break;
+      case HCI_EVENT_DISCONNECTION_COMPLETE:
+         if(DataLength >= 4)
+         {
+            DisconnectionCompleteData.Status            = Data[0];
+            DisconnectionCompleteData.Connection_Handle = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[1]);
+            DisconnectionCompleteData.Reason            = Data[3];
+
+            Connection = FindConnectionByHandle(DisconnectionCompleteData.Connection_Handle);
+
+            DispatchHCIEvent(etDisconnection_Complete_Event, sizeof(DisconnectionCompleteData), &DisconnectionCompleteData, "HCI Disconnection Complete");
+
+            if((Connection) && (DisconnectionCompleteData.Status == HCI_ERROR_CODE_NO_ERROR))
+            {
+               Connection->InUse = FALSE;
+
+               /* A discovery in progress ends with the link (the client */
+               /* sees the disconnection).                               */
+               if(Connection->Discovery)
+               {
+                  BTPS_FreeMemory(Connection->Discovery);
+
+                  Connection->Discovery = NULL;
+               }
+
+               switch(Connection->LinkType)
+               {
+                  case LINK_TYPE_SCO:
+                  case LINK_TYPE_ESCO:
+                     if(((Port = FindPortByBD_ADDR(Connection->BD_ADDR)) != NULL) && (Port->SCOHandle == Connection->Handle))
+                     {
+                        Port->SCOHandle = 0;
+
+                        DispatchHFREEvent(Port, etHFRE_Audio_Disconnection_Indication, sizeof(AudioDisconnectionData), &AudioDisconnectionData, "HFRE Audio Disconnection Indication");
+                     }
+                     break;
+                  case LINK_TYPE_ACL:
+                     /* The ports on the link are closed with it.       */
+                     for(Index=0;Index<MAXIMUM_HFRE_PORTS;Index++)
+                     {
+                        if((HFREPorts[Index].InUse) && (HFREPorts[Index].Connected) && (HFREPorts[Index].Handle == Connection->Handle))
+                        {
+                           HFREPorts[Index].Connected              = FALSE;
+                           HFREPorts[Index].ServiceLevelConnection = FALSE;
+                           ClosePortData.PortCloseStatus           = HFRE_PORT_STATUS_FAILURE;
+
+                           DispatchHFREEvent(&HFREPorts[Index], etHFRE_Close_Port_Indication, sizeof(ClosePortData), &ClosePortData, "HFRE Close Port Indication");
+                        }
+                     }
+                     break;
+                  case LINK_TYPE_LE:
+                     LEDisconnectionData.Status  = DisconnectionCompleteData.Status;
+                     LEDisconnectionData.BD_ADDR = Connection->BD_ADDR;
+                     LEDisconnectionData.Reason  = DisconnectionCompleteData.Reason;
+
+                     DispatchGAPLEEvent(etLE_Disconnection_Complete, sizeof(LEDisconnectionData), &LEDisconnectionData, "GAP LE Disconnection Complete");
+
+                     BTPS_MemInitialize(&GATTConnectionData, 0, sizeof(GATTConnectionData));
+
+                     GATTConnectionData.ConnectionID   = Connection->Handle;
+                     GATTConnectionData.ConnectionType = gctLE;
+                     GATTConnectionData.RemoteDevice   = Connection->BD_ADDR;
+
+                     DispatchGATTConnectionEvent(etGATT_Connection_Device_Disconnection, &GATTConnectionData, "GATT Device Disconnection");
+
+                     for(Index=0;Index<MAXIMUM_GATT_SERVICES;Index++)
+                     {
+                        if(GATTServices[Index].InUse)
+                           DispatchGATTServerEvent(&GATTServices[Index], etGATT_Server_Device_Disconnection, &GATTConnectionData, "GATT Server Device Disconnection");
+                     }
+                     break;
+               }
+            }
+         }
+         break;
+      case HCI_EVENT_AUTHENTICATION_COMPLETE:
+         if((DataLength >= 3) && ((Connection = FindConnectionByHandle(READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[1]))) != NULL))
+         {
+            AuthenticationData.GAP_Authentication_Event_Type                    = atAuthenticationStatus;
+            AuthenticationData.Remote_Device                                    = Connection->BD_ADDR;
+            AuthenticationData.Authentication_Event_Data.Authentication_Status = Data[0];
+
+            DispatchAuthenticationEvent(&AuthenticationData, "GAP Authentication Status");
+
+            if((Request = FindPendingRequest(BondingRequests, Connection->BD_ADDR)) != NULL)
+               Request->InUse = FALSE;
+         }
+         break;
+      case HCI_EVENT_LINK_KEY_REQUEST:
+      case HCI_EVENT_PIN_CODE_REQUEST:
+      case HCI_EVENT_IO_CAPABILITY_REQUEST:
+      case HCI_EVENT_USER_PASSKEY_REQUEST:
+      case HCI_EVENT_REMOTE_OOB_DATA_REQUEST:
+         if(DataLength >= 6)
+         {
+            AuthenticationData.Remote_Device = ReadBD_ADDR(Data);
+
+            switch(Event[0])
+            {
+               case HCI_EVENT_LINK_KEY_REQUEST:
+                  AuthenticationData.GAP_Authentication_Event_Type = atLinkKeyRequest;
+                  DispatchAuthenticationEvent(&AuthenticationData, "GAP Link Key Request");
+                  break;
+               case HCI_EVENT_PIN_CODE_REQUEST:
+                  AuthenticationData.GAP_Authentication_Event_Type = atPINCodeRequest;
+                  DispatchAuthenticationEvent(&AuthenticationData, "GAP PIN Code Request");
+                  break;
+               case HCI_EVENT_IO_CAPABILITY_REQUEST:
+                  AuthenticationData.GAP_Authentication_Event_Type = atIOCapabilityRequest;
+                  DispatchAuthenticationEvent(&AuthenticationData, "GAP IO Capability Request");
+                  break;
+               case HCI_EVENT_USER_PASSKEY_REQUEST:
+                  AuthenticationData.GAP_Authentication_Event_Type = atPasskeyRequest;
+                  DispatchAuthenticationEvent(&AuthenticationData, "GAP Passkey Request");
+                  break;
+               default:
+                  AuthenticationData.GAP_Authentication_Event_Type = atRemoteOutOfBandDataRequest;
+                  DispatchAuthenticationEvent(&AuthenticationData, "GAP Remote OOB Data Request");
+                  break;
+            }
+         }
+         break;
+      case HCI_EVENT_LINK_KEY_NOTIFICATION:
+         if(DataLength >= 23)
+         {
+            AuthenticationData.GAP_Authentication_Event_Type              = atLinkKeyCreation;
+            AuthenticationData.Remote_Device                              = ReadBD_ADDR(Data);
+            AuthenticationData.Authentication_Event_Data.Link_Key_Info.Key_Type = Data[22];
+
+            BTPS_MemCopy(&AuthenticationData.Authentication_Event_Data.Link_Key_Info.Link_Key, &Data[6], sizeof(Link_Key_t));
+
+            DispatchAuthenticationEvent(&AuthenticationData, "GAP Link Key Creation");
+         }
+         break;
+      case HCI_EVENT_IO_CAPABILITY_RESPONSE:
+         if(DataLength >= 9)
+         {
+            AuthenticationData.GAP_Authentication_Event_Type                                      = atIOCapabilityResponse;
+            AuthenticationData.Remote_Device                                                      = ReadBD_ADDR(Data);
+            AuthenticationData.Authentication_Event_Data.IO_Capabilities.IO_Capability            = (GAP_IO_Capability_t)Data[6];
+            AuthenticationData.Authentication_Event_Data.IO_Capabilities.OOB_Data_Present         = (Boolean_t)(Data[7]?TRUE:FALSE);
+            AuthenticationData.Authentication_Event_Data.IO_Capabilities.MITM_Protection_Required = (Boolean_t)((Data[8] & 0x01)?TRUE:FALSE);
+            AuthenticationData.Authentication_Event_Data.IO_Capabilities.Bonding_Type             = (Data[8] >> 1);
+
+            DispatchAuthenticationEvent(&AuthenticationData, "GAP IO Capability Response");
+         }
+         break;
+      case HCI_EVENT_USER_CONFIRMATION_REQUEST:
+      case HCI_EVENT_USER_PASSKEY_NOTIFICATION:
+         if(DataLength >= 10)
+         {
+            AuthenticationData.GAP_Authentication_Event_Type           = (Event[0] == HCI_EVENT_USER_CONFIRMATION_REQUEST)?atUserConfirmationRequest:atPasskeyNotification;
+            AuthenticationData.Remote_Device                           = ReadBD_ADDR(Data);
+            AuthenticationData.Authentication_Event_Data.Numeric_Value = READ_UNALIGNED_DWORD_LITTLE_ENDIAN(&Data[6]);
+
+            DispatchAuthenticationEvent(&AuthenticationData, (Event[0] == HCI_EVENT_USER_CONFIRMATION_REQUEST)?"GAP User Confirmation Request":"GAP Passkey Notification");
+         }
+         break;
+      case HCI_EVENT_KEYPRESS_NOTIFICATION:
+         if(DataLength >= 7)
+         {
+            AuthenticationData.GAP_Authentication_Event_Type           = atKeypressNotification;
+            AuthenticationData.Remote_Device                           = ReadBD_ADDR(Data);
+            AuthenticationData.Authentication_Event_Data.Keypress_Type = Data[6];
+
+            DispatchAuthenticationEvent(&AuthenticationData, "GAP Keypress Notification");
+         }
+         break;
+      case HCI_EVENT_READ_CLOCK_OFFSET_COMPLETE:
+         if(DataLength >= 5)
+         {
+            ClockOffsetData.Status            = Data[0];
+            ClockOffsetData.Connection_Handle = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[1]);
+            ClockOffsetData.Clock_Offset      = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[3]);
+
+            DispatchHCIEvent(etRead_Clock_Offset_Complete_Event, sizeof(ClockOffsetData), &ClockOffsetData, "HCI Read Clock Offset Complete");
+         }
+         break;
+      case HCI_EVENT_READ_REMOTE_FEATURES_COMPLETE:
+         if(DataLength >= 11)
+         {
+            FeaturesData.Status            = Data[0];
+            FeaturesData.Connection_Handle = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[1]);
+
+            BTPS_MemCopy(&FeaturesData.LMP_Features, &Data[3], sizeof(LMP_Features_t));
+
+            DispatchHCIEvent(etRead_Remote_Supported_Features_Complete_Event, sizeof(FeaturesData), &FeaturesData, "HCI Read Remote Features Complete");
+         }
+         break;
+      case HCI_EVENT_PAGE_SCAN_REPETITION_MODE_CHANGE:
+         if(DataLength >= 7)
+         {
+            PageScanData.BD_ADDR                   = ReadBD_ADDR(Data);
+            PageScanData.Page_Scan_Repetition_Mode = Data[6];
+
+            DispatchHCIEvent(etPage_Scan_Repetition_Mode_Change_Event, sizeof(PageScanData), &PageScanData, "HCI Page Scan Repetition Mode Change");
+         }
+         break;
+      case HCI_EVENT_MODE_CHANGE:
+         if(DataLength >= 6)
+         {
+            ModeChangeData.Status            = Data[0];
+            ModeChangeData.Connection_Handle = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[1]);
+            ModeChangeData.Current_Mode      = Data[3];
+            ModeChangeData.Interval          = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[4]);
+
+            DispatchHCIEvent(etMode_Change_Event, sizeof(ModeChangeData), &ModeChangeData, "HCI Mode Change");
+         }
+         break;
+      case HCI_EVENT_SNIFF_SUBRATING:
+         if(DataLength >= 11)
+         {
+            SniffSubratingData.Status                   = Data[0];
+            SniffSubratingData.Connection_Handle        = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[1]);
+            SniffSubratingData.Maximum_Transmit_Latency = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[3]);
+            SniffSubratingData.Maximum_Receive_Latency  = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[5]);
+            SniffSubratingData.Minimum_Remote_Timeout   = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[7]);
+            SniffSubratingData.Minimum_Local_Timeout    = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[9]);
+
+            DispatchHCIEvent(etSniff_Subrating_Event, sizeof(SniffSubratingData), &SniffSubratingData, "HCI Sniff Subrating");
+         }
+         break;
+      case HCI_EVENT_LE_META:
+         if((DataLength >= 19) && (Data[0] == HCI_LE_SUBEVENT_CONNECTION_COMPLETE))
+         {
+            Handle = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[2]);
+
+            BTPS_MemInitialize(&LEConnectionData, 0, sizeof(LEConnectionData));
+
+            LEConnectionData.Status              = Data[1];
+            LEConnectionData.Master              = (Boolean_t)((Data[4] == 0)?TRUE:FALSE);
+            LEConnectionData.Peer_Address_Type   = (GAP_LE_Address_Type_t)Data[5];
+            LEConnectionData.Peer_Address        = ReadBD_ADDR(&Data[6]);
+            LEConnectionData.Connection_Interval = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[12]);
+            LEConnectionData.Slave_Latency       = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[14]);
+            LEConnectionData.Supervision_Timeout = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[16]);
+
+            /* The controller stops advertising when a slave connection*/
+            /* is established.                                          */
+            if((LEConnectionData.Status == HCI_ERROR_CODE_NO_ERROR) && (!LEConnectionData.Master))
+               Advertising = FALSE;
+
+            DispatchGAPLEEvent(etLE_Connection_Complete, sizeof(LEConnectionData), &LEConnectionData, "GAP LE Connection Complete");
+
+            if((LEConnectionData.Status == HCI_ERROR_CODE_NO_ERROR) && (AddConnection(Handle, LEConnectionData.Peer_Address, LINK_TYPE_LE)))
+            {
+               BTPS_MemInitialize(&GATTConnectionData, 0, sizeof(GATTConnectionData));
+
+               GATTConnectionData.ConnectionID   = Handle;
+               GATTConnectionData.ConnectionType = gctLE;
+               GATTConnectionData.RemoteDevice   = LEConnectionData.Peer_Address;
+               GATTConnectionData.MTU            = DEFAULT_ATT_MTU;
+
+               DispatchGATTConnectionEvent(etGATT_Connection_Device_Connection, &GATTConnectionData, "GATT Device Connection");
+
+               for(Index=0;Index<MAXIMUM_GATT_SERVICES;Index++)
+               {
+                  if(GATTServices[Index].InUse)
+                     DispatchGATTServerEvent(&GATTServices[Index], etGATT_Server_Device_Connection, &GATTConnectionData, "GATT Server Device Connection");
+               }
+            }
+         }
+         else
+         {
+            if((DataLength >= 2) && (Data[0] == HCI_LE_SUBEVENT_ADVERTISING_REPORT))
+               ProcessAdvertisingReports(DataLength - 1, &Data[1]);
+            else
+            {
+               if((DataLength >= 10) && (Data[0] == HCI_LE_SUBEVENT_CONNECTION_UPDATE_COMPLETE) && ((Connection = FindConnectionByHandle(READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[2]))) != NULL))
+               {
+                  LEUpdatedData.Status              = Data[1];
+                  LEUpdatedData.BD_ADDR             = Connection->BD_ADDR;
+                  LEUpdatedData.Connection_Interval = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[4]);
+                  LEUpdatedData.Slave_Latency       = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[6]);
+                  LEUpdatedData.Supervision_Timeout = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Data[8]);
+
+                  DispatchGAPLEEvent(etLE_Connection_Parameter_Updated, sizeof(LEUpdatedData), &LEUpdatedData, "GAP LE Connection Parameter Updated");
+               }
+            }
+         }
+         break;
+      default:
+         /* Command Complete/Status and all other events are consumed   */
+         /* by the stack.                                               */
+         break;
+   }
+}
+
+   /* The following function passes an ATT PDU the stack sends on an LE  */
+   /* link (a response or a request of the GATT client) to the response */
+   /* callback.                                                         */
+static void SendATTResponse(Connection_t *Connection, unsigned int Length, Byte_t *PDU)
+{
+   if(ResponseCallback)
+      (*ResponseCallback)(Connection->Handle, Length, PDU, ResponseCallbackParameter);
+}
+
+   /* The following function sends an ATT Error Response.                */
+static void SendATTError(Connection_t *Connection, Byte_t RequestOpCode, Word_t Handle, Byte_t ErrorCode)
+{
+   Byte_t PDU[5];
+
+   PDU[0] = ATT_OPCODE_ERROR_RESPONSE;
+   PDU[1] = RequestOpCode;
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&PDU[2], Handle);
+   PDU[4] = ErrorCode;
+
+   SendATTResponse(Connection, sizeof(PDU), PDU);
+}
+
+   /* The following function returns the LE link that waits for the      */
+   /* response of the specified transaction or NULL if there is none.   */
+static Connection_t *FindConnectionByTransactionID(unsigned int TransactionID)
+{
+   unsigned int  Index;
+   Connection_t *ret_val = NULL;
+
+   for(Index=0;(TransactionID) && (Index<MAXIMUM_CONNECTIONS) && (!ret_val);Index++)
+   {
+      if((Connections[Index].InUse) && (Connections[Index].TransactionID == TransactionID))
+         ret_val = &Connections[Index];
+   }
+
+   return(ret_val);
+}
+
+   /* The following function decodes an ATT request received on an LE   */
+   /* link and dispatches it to the service that owns the handle.       */
+static void ProcessATTRequest(Connection_t *Connection, unsigned int Length, Byte_t *PDU)
+{
+   Byte_t                             Response[3];
+   Word_t                             Handle;
+   Word_t                             AttributeOffset;
+   unsigned int                       Index;
+   GATTService_t                     *Service;
+   GATT_Read_Request_Data_t           ReadData;
+   GATT_Write_Request_Data_t          WriteData;
+   GATT_Prepare_Write_Request_Data_t  PrepareData;
+   GATT_Execute_Write_Request_Data_t  ExecuteData;
+   GATT_Confirmation_Data_t           ConfirmationData;
+   GATT_Device_Connection_MTU_Update_Data_t MTUData;
+   GATT_Device_Buffer_Empty_Data_t    BufferEmptyData;
+
+   if(!Length)
+      return;
+
+   switch(PDU[0])
+   {
+      case ATT_OPCODE_EXCHANGE_MTU_REQUEST:
+         if(Length >= 3)
+         {
+            Connection->MTU = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[1]);
+
+            if(Connection->MTU < DEFAULT_ATT_MTU)
+               Connection->MTU = DEFAULT_ATT_MTU;
+
+            BTPS_MemInitialize(&MTUData, 0, sizeof(MTUData));
+
+            MTUData.ConnectionID   = Connection->Handle;
+            MTUData.ConnectionType = gctLE;
+            MTUData.RemoteDevice   = Connection->BD_ADDR;
+            MTUData.MTU            = Connection->MTU;
+
+            DispatchGATTConnectionEvent(etGATT_Connection_Device_Connection_MTU_Update, &MTUData, "GATT MTU Update");
+
+            /* The stack answers with the MTU of the client (it accepts  */
+            /* any MTU).                                                */
+            Response[0] = ATT_OPCODE_EXCHANGE_MTU_RESPONSE;
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Response[1], Connection->MTU);
+
+            SendATTResponse(Connection, sizeof(Response), Response);
+         }
+         break;
+      case ATT_OPCODE_READ_REQUEST:
+      case ATT_OPCODE_READ_BLOB_REQUEST:
+      case ATT_OPCODE_WRITE_REQUEST:
+      case ATT_OPCODE_WRITE_COMMAND:
+      case ATT_OPCODE_PREPARE_WRITE_REQUEST:
+         if(Length >= 3)
+         {
+            Handle  = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[1]);
+            Service = NULL;
+
+            for(Index=0;(Index<MAXIMUM_GATT_SERVICES) && (!Service);Index++)
+            {
+               if((GATTServices[Index].InUse) && (Handle >= GATTServices[Index].StartingHandle) && (Handle < (GATTServices[Index].StartingHandle + GATTServices[Index].NumberOfAttributes)))
+                  Service = &GATTServices[Index];
+            }
+
+            /* Requests for the attributes of the stack (GAP and GATT   */
+            /* services) are answered by the stack.                     */
+            if(!Service)
+               break;
+
+            /* The stack answers reads of declarations itself (the value*/
+            /* is not modeled) and refuses what the flags do not allow. */
+            AttributeOffset = (Word_t)(Handle - Service->StartingHandle);
+
+            if(AttributeOffset < MAXIMUM_SERVICE_ATTRIBUTES)
+            {
+               if((PDU[0] == ATT_OPCODE_READ_REQUEST) || (PDU[0] == ATT_OPCODE_READ_BLOB_REQUEST))
+               {
+                  if(!(Service->AttributeFlags[AttributeOffset] & GATT_ATTRIBUTE_FLAGS_READABLE))
+                  {
+                     SendATTError(Connection, PDU[0], Handle, ATT_ERROR_READ_NOT_PERMITTED);
+                     break;
+                  }
+
+                  if((Service->AttributeType[AttributeOffset] != aetCharacteristicValue16) && (Service->AttributeType[AttributeOffset] != aetCharacteristicValue128) && (Service->AttributeType[AttributeOffset] != aetCharacteristicDescriptor16) && (Service->AttributeType[AttributeOffset] != aetCharacteristicDescriptor128))
+                  {
+                     Response[0] = (Byte_t)((PDU[0] == ATT_OPCODE_READ_REQUEST)?ATT_OPCODE_READ_RESPONSE:ATT_OPCODE_READ_BLOB_RESPONSE);
+
+                     SendATTResponse(Connection, 1, Response);
+                     break;
+                  }
+               }
+               else
+               {
+                  if(!(Service->AttributeFlags[AttributeOffset] & GATT_ATTRIBUTE_FLAGS_WRITABLE))
+                  {
+                     /* Write commands are dropped silently.            */
+                     if(PDU[0] != ATT_OPCODE_WRITE_COMMAND)
+                        SendATTError(Connection, PDU[0], Handle, ATT_ERROR_WRITE_NOT_PERMITTED);
+                     break;
+                  }
+               }
+            }
+
+            /* The application answers the request with the transaction*/
+            /* ID (a client has at most one request outstanding).       */
+            if(PDU[0] != ATT_OPCODE_WRITE_COMMAND)
+            {
+               Connection->TransactionID = NextTransactionID + 1;
+               Connection->RequestOpCode = PDU[0];
+               Connection->RequestHandle = Handle;
+            }
+
+            if((PDU[0] == ATT_OPCODE_READ_REQUEST) || (PDU[0] == ATT_OPCODE_READ_BLOB_REQUEST))
+            {
+               BTPS_MemInitialize(&ReadData, 0, sizeof(ReadData));
+
+               ReadData.ConnectionID         = Connection->Handle;
+               ReadData.TransactionID        = ++NextTransactionID;
+               ReadData.ConnectionType       = gctLE;
+               ReadData.RemoteDevice         = Connection->BD_ADDR;
+               ReadData.ServiceID            = (Word_t)Service->ServiceID;
+               ReadData.AttributeOffset      = (Word_t)(Handle - Service->StartingHandle);
+               ReadData.AttributeValueOffset = (Word_t)(((PDU[0] == ATT_OPCODE_READ_BLOB_REQUEST) && (Length >= 5))?READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[3]):0);
+
+               DispatchGATTServerEvent(Service, etGATT_Server_Read_Request, &ReadData, "GATT Read Request");
+            }
+            else
+            {
+               if(PDU[0] == ATT_OPCODE_PREPARE_WRITE_REQUEST)
+               {
+                  if(Length >= 5)
+                  {
+                     /* The stack echoes the part in the Prepare Write   */
+                     /* Response.                                       */
+                     Connection->PrepareOffset = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[3]);
+                     Connection->PrepareLength = (Word_t)(((Length - 5) > (sizeof(Connection->PrepareValue) - 5))?(sizeof(Connection->PrepareValue) - 5):(Length - 5));
+
+                     BTPS_MemCopy(Connection->PrepareValue, &PDU[5], Connection->PrepareLength);
+
+                     BTPS_MemInitialize(&PrepareData, 0, sizeof(PrepareData));
+
+                     PrepareData.ConnectionID         = Connection->Handle;
+                     PrepareData.TransactionID        = ++NextTransactionID;
+                     PrepareData.ConnectionType       = gctLE;
+                     PrepareData.RemoteDevice         = Connection->BD_ADDR;
+                     PrepareData.ServiceID            = (Word_t)Service->ServiceID;
+                     PrepareData.AttributeOffset      = (Word_t)(Handle - Service->StartingHandle);
+                     PrepareData.AttributeValueOffset = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[3]);
+                     PrepareData.AttributeValueLength = (Word_t)(Length - 5);
+                     PrepareData.AttributeValue       = &PDU[5];
+
+                     DispatchGATTServerEvent(Service, etGATT_Server_Prepare_Write_Request, &PrepareData, "GATT Prepare Write Request");
+                  }
+               }
+               else
+               {
+                  BTPS_MemInitialize(&WriteData, 0, sizeof(WriteData));
+
+                  WriteData.ConnectionID         = Connection->Handle;
+                  WriteData.TransactionID        = (PDU[0] == ATT_OPCODE_WRITE_REQUEST)?++NextTransactionID:0;
+                  WriteData.ConnectionType       = gctLE;
+                  WriteData.RemoteDevice         = Connection->BD_ADDR;
+                  WriteData.ServiceID            = (Word_t)Service->ServiceID;
+                  WriteData.AttributeOffset      = (Word_t)(Handle - Service->StartingHandle);
+                  WriteData.AttributeValueLength = (Word_t)(Length - 3);
+                  WriteData.AttributeValue       = &PDU[3];
+
+                  DispatchGATTServerEvent(Service, etGATT_Server_Write_Request, &WriteData, "GATT Write Request");
+               }
+            }
+         }
+         break;
+      case ATT_OPCODE_EXECUTE_WRITE_REQUEST:
+         if(Length >= 2)
+         {
+            BTPS_MemInitialize(&ExecuteData, 0, sizeof(ExecuteData));
+
+            ExecuteData.ConnectionID   = Connection->Handle;
+            ExecuteData.TransactionID  = ++NextTransactionID;
+            ExecuteData.ConnectionType = gctLE;
+            ExecuteData.RemoteDevice   = Connection->BD_ADDR;
+            ExecuteData.CancelWrite    = (Boolean_t)((PDU[1] == 0)?TRUE:FALSE);
+
+            Connection->TransactionID = ExecuteData.TransactionID;
+            Connection->RequestOpCode = PDU[0];
+            Connection->RequestHandle = 0;
+
+            /* The prepared writes may span services, every service is  */
+            /* told.                                                    */
+            for(Index=0;Index<MAXIMUM_GATT_SERVICES;Index++)
+            {
+               if(GATTServices[Index].InUse)
+                  DispatchGATTServerEvent(&GATTServices[Index], etGATT_Server_Execute_Write_Request, &ExecuteData, "GATT Execute Write Request");
+            }
+         }
+         break;
+      case ATT_OPCODE_HANDLE_VALUE_CONFIRMATION:
+         /* The confirmation ends the indication of the service that is */
+         /* outstanding on the link.                                    */
+         if(Connection->ServerIndicationTransactionID)
+         {
+            BTPS_MemInitialize(&ConfirmationData, 0, sizeof(ConfirmationData));
+
+            ConfirmationData.ConnectionID   = Connection->Handle;
+            ConfirmationData.TransactionID  = Connection->ServerIndicationTransactionID;
+            ConfirmationData.ConnectionType = gctLE;
+            ConfirmationData.RemoteDevice   = Connection->BD_ADDR;
+            ConfirmationData.Status         = GATT_CONFIRMATION_STATUS_SUCCESS;
+
+            Connection->ServerIndicationTransactionID = 0;
+
+            for(Index=0;Index<MAXIMUM_GATT_SERVICES;Index++)
+            {
+               if((GATTServices[Index].InUse) && (GATTServices[Index].ServiceID == Connection->ServerIndicationServiceID))
+                  DispatchGATTServerEvent(&GATTServices[Index], etGATT_Server_Confirmation_Response, &ConfirmationData, "GATT Confirmation Response");
+            }
+
+            if(Connection->ServerIndicationRefused)
+            {
+               Connection->ServerIndicationRefused = FALSE;
+
+               BTPS_MemInitialize(&BufferEmptyData, 0, sizeof(BufferEmptyData));
+
+               BufferEmptyData.ConnectionID   = Connection->Handle;
+               BufferEmptyData.ConnectionType = gctLE;
+               BufferEmptyData.RemoteDevice   = Connection->BD_ADDR;
+
+               DispatchGATTConnectionEvent(etGATT_Connection_Device_Buffer_Empty, &BufferEmptyData, "GATT Buffer Empty");
+            }
+         }
+         break;
+      default:
+         /* Discovery and all other requests are answered by the stack. */
+         break;
+   }
+}
+
+/* The following function sends a request of the GATT client (the link  */
+/* is busy until the answer arrives).                                   */
+static void SendClientRequest(Connection_t *Connection, unsigned int Length, Byte_t *PDU)
+{
+   Connection->ClientOpCode = PDU[0];
+
+   SendATTResponse(Connection, Length, PDU);
+}
+
+/* The following function sends a discovery request for the specified   */
+/* handle range (the UUID is not sent with a Find Information Request). */
+static void SendDiscoveryRequest(Connection_t *Connection, Byte_t OpCode, Word_t StartingHandle, Word_t EndingHandle, Word_t UUID)
+{
+   Byte_t PDU[7];
+
+   PDU[0] = OpCode;
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&PDU[1], StartingHandle);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&PDU[3], EndingHandle);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&PDU[5], UUID);
+
+   SendClientRequest(Connection, (OpCode == ATT_OPCODE_FIND_INFORMATION_REQUEST)?5:7, PDU);
+}
+
+/* The following function returns TRUE if the specified service UUID    */
+/* passes the UUID filter of the discovery (an empty filter passes every*/
+/* service).                                                            */
+static Boolean_t MatchDiscoveryUUID(Discovery_t *Discovery, GATT_UUID_t *UUID)
+{
+   unsigned int Index;
+   Boolean_t    ret_val = (Boolean_t)((Discovery->NumberOfUUID)?FALSE:TRUE);
+
+   for(Index=0;(Index<Discovery->NumberOfUUID) && (!ret_val);Index++)
+   {
+      if(Discovery->UUIDList[Index].UUID_Type == UUID->UUID_Type)
+      {
+         if(UUID->UUID_Type == guUUID_16)
+            ret_val = (Boolean_t)(!BTPS_MemCompare(&(Discovery->UUIDList[Index].UUID.UUID_16), &(UUID->UUID.UUID_16), sizeof(UUID_16_t)));
+         else
+            ret_val = (Boolean_t)(!BTPS_MemCompare(&(Discovery->UUIDList[Index].UUID.UUID_128), &(UUID->UUID.UUID_128), sizeof(UUID_128_t)));
+      }
+   }
+
+   return(ret_val);
+}
+
+/* The following function decodes a UUID of a discovery response (2 or  */
+/* 16 bytes, little endian as sent).                                    */
+static void ReadUUID(GATT_UUID_t *UUID, unsigned int Length, Byte_t *Data)
+{
+   BTPS_MemInitialize(UUID, 0, sizeof(GATT_UUID_t));
+
+   if(Length == sizeof(UUID_128_t))
+   {
+      UUID->UUID_Type = guUUID_128;
+
+      BTPS_MemCopy(&(UUID->UUID.UUID_128), Data, sizeof(UUID_128_t));
+   }
+   else
+   {
+      UUID->UUID_Type = guUUID_16;
+
+      BTPS_MemCopy(&(UUID->UUID.UUID_16), Data, sizeof(UUID_16_t));
+   }
+}
+
+/* The following function issues the next request of the discovery on   */
+/* the specified link, reports each service when its characteristics and*/
+/* descriptors are known and completes the discovery after the last     */
+/* service.                                                             */
+static void ContinueDiscovery(Connection_t *Connection)
+{
+   Word_t                                    EndingHandle;
+   Discovery_t                              *Discovery;
+   GATT_Service_Information_t               *Service;
+   GATT_Service_Discovery_Event_Data_t       EventData;
+   GATT_Service_Discovery_Indication_Data_t  IndicationData;
+
+   while(((Discovery = Connection->Discovery) != NULL) && (!Connection->ClientOpCode))
+   {
+      if(Discovery->Phase == dpServices)
+      {
+         if(Discovery->NextHandle)
+         {
+            SendDiscoveryRequest(Connection, ATT_OPCODE_READ_BY_GROUP_TYPE_REQUEST, Discovery->NextHandle, 0xFFFF, ATT_UUID_PRIMARY_SERVICE);
+            break;
+         }
+
+         Discovery->Phase                 = dpCharacteristics;
+         Discovery->ServiceIndex          = 0;
+         Discovery->NumberCharacteristics = 0;
+         Discovery->NumberDescriptors     = 0;
+         Discovery->NextHandle            = (Word_t)((Discovery->NumberServices)?Discovery->Services[0].Service_Handle:0);
+      }
+
+      if(Discovery->ServiceIndex >= Discovery->NumberServices)
+      {
+         CompleteDiscovery(Connection, GATT_SERVICE_DISCOVERY_STATUS_SUCCESS);
+         break;
+      }
+
+      Service = &(Discovery->Services[Discovery->ServiceIndex]);
+
+      if(Discovery->Phase == dpCharacteristics)
+      {
+         /* Services the filter does not pass are skipped without any   */
+         /* request.                                                    */
+         if((Discovery->NextHandle) && (Discovery->NextHandle <= Service->End_Group_Handle) && (MatchDiscoveryUUID(Discovery, &(Service->UUID))))
+         {
+            SendDiscoveryRequest(Connection, ATT_OPCODE_READ_BY_TYPE_REQUEST, Discovery->NextHandle, Service->End_Group_Handle, ATT_UUID_CHARACTERISTIC);
+            break;
+         }
+
+         if(!MatchDiscoveryUUID(Discovery, &(Service->UUID)))
+         {
+            if(++Discovery->ServiceIndex < Discovery->NumberServices)
+               Discovery->NextHandle = Discovery->Services[Discovery->ServiceIndex].Service_Handle;
+
+            continue;
+         }
+
+         Discovery->Phase               = dpDescriptors;
+         Discovery->CharacteristicIndex = 0;
+         Discovery->NextHandle          = (Word_t)((Discovery->NumberCharacteristics)?(Discovery->Characteristics[0].Characteristic_Handle + 1):0);
+      }
+
+      if(Discovery->CharacteristicIndex < Discovery->NumberCharacteristics)
+      {
+         /* The descriptors of a characteristic lie between its value   */
+         /* and the next declaration (or the end of the service).       */
+         if((Discovery->CharacteristicIndex + 1) < Discovery->NumberCharacteristics)
+            EndingHandle = (Word_t)(Discovery->DeclarationHandle[Discovery->CharacteristicIndex + 1] - 1);
+         else
+            EndingHandle = Service->End_Group_Handle;
+
+         if((Discovery->NextHandle) && (Discovery->NextHandle <= EndingHandle))
+         {
+            SendDiscoveryRequest(Connection, ATT_OPCODE_FIND_INFORMATION_REQUEST, Discovery->NextHandle, EndingHandle, 0);
+            break;
+         }
+
+         if(++Discovery->CharacteristicIndex < Discovery->NumberCharacteristics)
+            Discovery->NextHandle = (Word_t)(Discovery->Characteristics[Discovery->CharacteristicIndex].Characteristic_Handle + 1);
+
+         continue;
+      }
+
+      /* The service is complete.                                       */
+      BTPS_MemInitialize(&IndicationData, 0, sizeof(IndicationData));
+
+      IndicationData.ConnectionID                  = Connection->Handle;
+      IndicationData.ServiceInformation            = *Service;
+      IndicationData.NumberOfCharacteristics       = Discovery->NumberCharacteristics;
+      IndicationData.CharacteristicInformationList = (Discovery->NumberCharacteristics)?Discovery->Characteristics:NULL;
+
+      EventData.Event_Data_Type = etGATT_Service_Discovery_Indication;
+      EventData.Event_Data_Size = sizeof(IndicationData);
+      EventData.Event_Data.GATT_Service_Discovery_Indication_Data = &IndicationData;
+
+      BeginDispatch();
+      (*Discovery->Callback)(STAND_IN_BLUETOOTH_STACK_ID, &EventData, Discovery->CallbackParameter);
+      EndDispatch("GATT Service Discovery Indication");
+
+      /* The callback may have stopped the discovery.                   */
+      if(Connection->Discovery == Discovery)
+      {
+         Discovery->Phase                 = dpCharacteristics;
+         Discovery->NumberCharacteristics = 0;
+         Discovery->NumberDescriptors     = 0;
+
+         if(++Discovery->ServiceIndex < Discovery->NumberServices)
+            Discovery->NextHandle = Discovery->Services[Discovery->ServiceIndex].Service_Handle;
+      }
+   }
+}
+
+/* The following function ends the discovery on the specified link and  */
+/* reports the status to its callback.                                  */
+static void CompleteDiscovery(Connection_t *Connection, Byte_t Status)
+{
+   Discovery_t                            *Discovery;
+   GATT_Service_Discovery_Event_Data_t     EventData;
+   GATT_Service_Discovery_Complete_Data_t  CompleteData;
+
+   if((Discovery = Connection->Discovery) != NULL)
+   {
+      Connection->Discovery = NULL;
+
+      CompleteData.ConnectionID = Connection->Handle;
+      CompleteData.Status       = Status;
+
+      EventData.Event_Data_Type = etGATT_Service_Discovery_Complete;
+      EventData.Event_Data_Size = sizeof(CompleteData);
+      EventData.Event_Data.GATT_Service_Discovery_Complete_Data = &CompleteData;
+
+      BeginDispatch();
+      (*Discovery->Callback)(STAND_IN_BLUETOOTH_STACK_ID, &EventData, Discovery->CallbackParameter);
+      EndDispatch("GATT Service Discovery Complete");
+
+      BTPS_FreeMemory(Discovery);
+   }
+}
+
+/* The following function decodes the answer to a discovery request.    */
+/* Attribute Not Found ends the current step, entries that do not fit   */
+/* are dropped (as the stack does with its fixed lists).                */
+static void ProcessDiscoveryResponse(Connection_t *Connection, unsigned int Length, Byte_t *PDU)
+{
+   Byte_t       RequestOpCode;
+   Word_t       Handle;
+   unsigned int EntryLength;
+   unsigned int Index;
+   Discovery_t *Discovery = Connection->Discovery;
+
+   RequestOpCode            = Connection->ClientOpCode;
+   Connection->ClientOpCode = 0;
+
+   if((PDU[0] == ATT_OPCODE_ERROR_RESPONSE) && (Length >= 5) && (PDU[1] == RequestOpCode))
+   {
+      if(PDU[4] == ATT_PROTOCOL_ERROR_CODE_ATTRIBUTE_NOT_FOUND)
+         Discovery->NextHandle = 0;
+      else
+      {
+         CompleteDiscovery(Connection, GATT_SERVICE_DISCOVERY_STATUS_RESPONSE_ERROR);
+         return;
+      }
+   }
+   else
+   {
+      if((Length < 2) || (PDU[0] != (Byte_t)(RequestOpCode + 1)))
+      {
+         CompleteDiscovery(Connection, GATT_SERVICE_DISCOVERY_STATUS_RESPONSE_ERROR);
+         return;
+      }
+
+      /* Find Information carries a format (1 is 16-bit, 2 is 128-bit   */
+      /* UUIDs), the other responses the length of an entry.            */
+      if(PDU[0] == ATT_OPCODE_FIND_INFORMATION_RESPONSE)
+         EntryLength = (PDU[1] == 2)?(2 + sizeof(UUID_128_t)):(2 + sizeof(UUID_16_t));
+      else
+         EntryLength = PDU[1];
+
+      Handle = 0;
+
+      for(Index=2;(EntryLength >= 4) && ((Index + EntryLength) <= Length);Index+=EntryLength)
+      {
+         switch(PDU[0])
+         {
+            case ATT_OPCODE_READ_BY_GROUP_TYPE_RESPONSE:
+               Handle = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[Index + 2]);
+
+               if(Discovery->NumberServices < MAXIMUM_DISCOVERY_SERVICES)
+               {
+                  Discovery->Services[Discovery->NumberServices].Service_Handle   = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[Index]);
+                  Discovery->Services[Discovery->NumberServices].End_Group_Handle = Handle;
+
+                  ReadUUID(&(Discovery->Services[Discovery->NumberServices++].UUID), EntryLength - 4, &PDU[Index + 4]);
+               }
+               break;
+            case ATT_OPCODE_READ_BY_TYPE_RESPONSE:
+               Handle = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[Index]);
+
+               if((EntryLength >= 7) && (Discovery->NumberCharacteristics < MAXIMUM_DISCOVERY_CHARACTERISTICS))
+               {
+                  Discovery->DeclarationHandle[Discovery->NumberCharacteristics] = Handle;
+
+                  BTPS_MemInitialize(&(Discovery->Characteristics[Discovery->NumberCharacteristics]), 0, sizeof(GATT_Characteristic_Information_t));
+
+                  Discovery->Characteristics[Discovery->NumberCharacteristics].Characteristic_Properties = PDU[Index + 2];
+                  Discovery->Characteristics[Discovery->NumberCharacteristics].Characteristic_Handle     = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[Index + 3]);
+
+                  ReadUUID(&(Discovery->Characteristics[Discovery->NumberCharacteristics++].Characteristic_UUID), EntryLength - 5, &PDU[Index + 5]);
+               }
+               break;
+            default:
+               Handle = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[Index]);
+
+               if((Discovery->CharacteristicIndex < Discovery->NumberCharacteristics) && (Discovery->NumberDescriptors < MAXIMUM_DISCOVERY_DESCRIPTORS))
+               {
+                  if(!Discovery->Characteristics[Discovery->CharacteristicIndex].NumberOfDescriptors)
+                     Discovery->Characteristics[Discovery->CharacteristicIndex].DescriptorList = &(Discovery->Descriptors[Discovery->NumberDescriptors]);
+
+                  Discovery->Characteristics[Discovery->CharacteristicIndex].NumberOfDescriptors++;
+
+                  Discovery->Descriptors[Discovery->NumberDescriptors].Characteristic_Descriptor_Handle = Handle;
+
+                  ReadUUID(&(Discovery->Descriptors[Discovery->NumberDescriptors++].Characteristic_Descriptor_UUID), EntryLength - 2, &PDU[Index + 2]);
+               }
+               break;
+         }
+      }
+
+      /* The next request starts after the last handle found.           */
+      Discovery->NextHandle = (Word_t)(((Handle) && (Handle != 0xFFFF))?(Handle + 1):0);
+   }
+
+   ContinueDiscovery(Connection);
+}
+
+/* The following function decodes an ATT PDU with an odd opcode (a      */
+/* response to the GATT client or a notification/indication of the      */
+/* remote server) received on an LE link.                               */
+static void ProcessATTResponse(Connection_t *Connection, unsigned int Length, Byte_t *PDU)
+{
+   unsigned int                       Index;
+   unsigned int                       EntryLength;
+   unsigned int                       NumberAttributes;
+   GATT_Read_By_UUID_Data_t           AttributeList[MAXIMUM_ATT_MTU/4];
+   GATT_Request_Error_Data_t          ErrorData;
+   GATT_Write_Response_Data_t         WriteData;
+   GATT_Server_Indication_Data_t      IndicationData;
+   GATT_Server_Notification_Data_t    NotificationData;
+   GATT_Read_By_UUID_Response_Data_t  ReadByUUIDData;
+
+   switch(PDU[0])
+   {
+      case ATT_OPCODE_HANDLE_VALUE_NOTIFICATION:
+      case ATT_OPCODE_HANDLE_VALUE_INDICATION:
+         if(Length >= 3)
+         {
+            /* A notification is decoded like an indication, it has no  */
+            /* transaction and needs no confirmation.                   */
+            BTPS_MemInitialize(&IndicationData, 0, sizeof(IndicationData));
+
+            IndicationData.ConnectionID         = Connection->Handle;
+            IndicationData.ConnectionType       = gctLE;
+            IndicationData.RemoteDevice         = Connection->BD_ADDR;
+            IndicationData.AttributeHandle      = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[1]);
+            IndicationData.AttributeValueLength = (Word_t)(Length - 3);
+            IndicationData.AttributeValue       = &PDU[3];
+
+            if(PDU[0] == ATT_OPCODE_HANDLE_VALUE_INDICATION)
+            {
+               IndicationData.TransactionID        = ++NextTransactionID;
+               Connection->IndicationTransactionID = IndicationData.TransactionID;
+
+               DispatchGATTConnectionEvent(etGATT_Connection_Server_Indication, &IndicationData, "GATT Server Indication");
+            }
+            else
+            {
+               NotificationData.ConnectionID         = IndicationData.ConnectionID;
+               NotificationData.ConnectionType       = IndicationData.ConnectionType;
+               NotificationData.RemoteDevice         = IndicationData.RemoteDevice;
+               NotificationData.AttributeHandle      = IndicationData.AttributeHandle;
+               NotificationData.AttributeValueLength = IndicationData.AttributeValueLength;
+               NotificationData.AttributeValue       = IndicationData.AttributeValue;
+
+               DispatchGATTConnectionEvent(etGATT_Connection_Server_Notification, &NotificationData, "GATT Server Notification");
+            }
+         }
+         break;
+      default:
+         /* A response without a request is dropped, so is the answer to*/
+         /* the request of a discovery that was stopped.                */
+         if(!Connection->ClientOpCode)
+            break;
+
+         if(!Connection->ClientCallback)
+         {
+            if(Connection->Discovery)
+               ProcessDiscoveryResponse(Connection, Length, PDU);
+            else
+               Connection->ClientOpCode = 0;
+
+            break;
+         }
+
+         if((PDU[0] == ATT_OPCODE_ERROR_RESPONSE) && (Length >= 5))
+         {
+            BTPS_MemInitialize(&ErrorData, 0, sizeof(ErrorData));
+
+            ErrorData.ConnectionID               = Connection->Handle;
+            ErrorData.TransactionID              = Connection->ClientTransactionID;
+            ErrorData.AttributeProtocolErrorCode = PDU[4];
+            ErrorData.RequestOpCode              = PDU[1];
+            ErrorData.RequestHandle              = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[2]);
+
+            DispatchGATTClientEvent(Connection, etGATT_Client_Error_Response, &ErrorData, "GATT Client Error Response");
+         }
+         else
+         {
+            if((PDU[0] == ATT_OPCODE_READ_BY_TYPE_RESPONSE) && (Connection->ClientOpCode == ATT_OPCODE_READ_BY_TYPE_REQUEST) && (Length >= 2))
+            {
+               EntryLength = PDU[1];
+
+               for(Index=2,NumberAttributes=0;(EntryLength >= 2) && ((Index + EntryLength) <= Length) && (NumberAttributes < (sizeof(AttributeList)/sizeof(AttributeList[0])));Index+=EntryLength,NumberAttributes++)
+               {
+                  AttributeList[NumberAttributes].AttributeHandle      = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&PDU[Index]);
+                  AttributeList[NumberAttributes].AttributeValueLength = (Word_t)(EntryLength - 2);
+                  AttributeList[NumberAttributes].AttributeValue       = &PDU[Index + 2];
+               }
+
+               BTPS_MemInitialize(&ReadByUUIDData, 0, sizeof(ReadByUUIDData));
+
+               ReadByUUIDData.ConnectionID       = Connection->Handle;
+               ReadByUUIDData.TransactionID      = Connection->ClientTransactionID;
+               ReadByUUIDData.ConnectionType     = gctLE;
+               ReadByUUIDData.RemoteDevice       = Connection->BD_ADDR;
+               ReadByUUIDData.NumberOfAttributes = (Byte_t)NumberAttributes;
+               ReadByUUIDData.AttributeList      = AttributeList;
+
+               DispatchGATTClientEvent(Connection, etGATT_Client_Read_By_UUID_Response, &ReadByUUIDData, "GATT Client Read By UUID Response");
+            }
+            else
+            {
+               if((PDU[0] == ATT_OPCODE_WRITE_RESPONSE) && (Connection->ClientOpCode == ATT_OPCODE_WRITE_REQUEST))
+               {
+                  BTPS_MemInitialize(&WriteData, 0, sizeof(WriteData));
+
+                  WriteData.ConnectionID   = Connection->Handle;
+                  WriteData.TransactionID  = Connection->ClientTransactionID;
+                  WriteData.ConnectionType = gctLE;
+                  WriteData.RemoteDevice   = Connection->BD_ADDR;
+
+                  DispatchGATTClientEvent(Connection, etGATT_Client_Write_Response, &WriteData, "GATT Client Write Response");
+               }
+            }
+         }
+         break;
+   }
+}
+
+   /* The following function decodes one AT result line of the AG and    */
+   /* dispatches the resulting HFRE event.                              */
+static void ProcessATLine(HFREPort_t *Port, char *Line)
+{
+   char                                                  *Value;
+   char                                                  *Quote;
+   unsigned int                                           Index;
+   unsigned int                                           Number;
+   HFRE_Ring_Indication_Data_t                            RingData;
+   HFRE_Command_Result_Data_t                             ResultData;
+   HFRE_Codec_Select_Indication_Data_t                    CodecData;
+   HFRE_InBand_Ring_Tone_Setting_Indication_Data_t        InBandData;
+   HFRE_Call_Waiting_Notification_Indication_Data_t       NumberData;
+   HFRE_Control_Indicator_Status_Indication_Data_t        IndicatorData;
+   HFRE_Call_Hold_Multiparty_Support_Confirmation_Data_t  CallHoldData;
+   HFRE_Open_Service_Level_Connection_Indication_Data_t   ServiceLevelData;
+
+   if((Value = strchr(Line, ':')) != NULL)
+      Value++;
+
+   if(!strcmp(Line, "RING"))
+      DispatchHFREEvent(Port, etHFRE_Ring_Indication, sizeof(RingData), &RingData, "HFRE Ring Indication");
+   else if(!strncmp(Line, "+BRSF:", 6))
+      Port->RemoteFeatures = strtoul(Value, NULL, 10);
+   else if(!strncmp(Line, "+CIND:", 6))
+   {
+      /* The test response lists ("name",(minimum-maximum)), the read   */
+      /* response the current values (only needed by the stack).        */
+      if(strchr(Value, '('))
+      {
+         Port->NumberIndicators = 0;
+
+         while(((Quote = strchr(Value, '"')) != NULL) && (Port->NumberIndicators < MAXIMUM_INDICATORS))
+         {
+            Value = Quote + 1;
+
+            for(Index=0;(Value[Index]) && (Value[Index] != '"') && (Index < (MAXIMUM_INDICATOR_NAME - 1));Index++)
+               Port->IndicatorName[Port->NumberIndicators][Index] = Value[Index];
+
+            Port->IndicatorName[Port->NumberIndicators][Index] = '\0';
+
+            if((Quote = strchr(Value, '"')) == NULL)
+               break;
+
+            Value  = Quote + 1;
+            Number = 1;
+
+            /* The maximum is the last number before the closing ')'.   */
+            while((*Value) && (*Value != ')'))
+            {
+               if((*Value >= '0') && (*Value <= '9'))
+               {
+                  Number = (unsigned int)strtoul(Value, &Value, 10);
+               }
+               else
+                  Value++;
+            }
+
+            Port->IndicatorMaximum[Port->NumberIndicators++] = Number;
+         }
+      }
+   }
+   else if(!strncmp(Line, "+CIEV:", 6))
+   {
+      Index = (unsigned int)strtoul(Value, &Value, 10);
+
+      if((Index) && (Index <= Port->NumberIndicators) && (*Value == ','))
+      {
+         Number = (unsigned int)strtoul(Value + 1, NULL, 10);
+
+         BTPS_MemInitialize(&IndicatorData, 0, sizeof(IndicatorData));
+
+         IndicatorData.HFREControlIndicatorEntry.IndicatorDescription = Port->IndicatorName[Index - 1];
+
+         if(Port->IndicatorMaximum[Index - 1] > 1)
+         {
+            IndicatorData.HFREControlIndicatorEntry.ControlIndicatorType                                              = ciRange;
+            IndicatorData.HFREControlIndicatorEntry.Control_Indicator_Data.ControlIndicatorRangeType.CurrentIndicatorValue = Number;
+         }
+         else
+         {
+            IndicatorData.HFREControlIndicatorEntry.ControlIndicatorType                                                = ciBoolean;
+            IndicatorData.HFREControlIndicatorEntry.Control_Indicator_Data.ControlIndicatorBooleanType.CurrentIndicatorValue = (Boolean_t)(Number?TRUE:FALSE);
+         }
+
+         DispatchHFREEvent(Port, etHFRE_Control_Indicator_Status_Indication, sizeof(IndicatorData), &IndicatorData, "HFRE Control Indicator Indication");
+      }
+   }
+   else if((!strncmp(Line, "+CLIP:", 6)) || (!strncmp(Line, "+CCWA:", 6)))
+   {
+      /* The number is the first (quoted) parameter.                    */
+      if((Quote = strchr(Value, '"')) != NULL)
+      {
+         Value = Quote + 1;
+
+         if((Quote = strchr(Value, '"')) != NULL)
+            *Quote = '\0';
+      }
+
+      NumberData.PhoneNumber = Value;
+
+      if(Line[2] == 'L')
+         DispatchHFREEvent(Port, etHFRE_Call_Line_Identification_Notification_Indication, sizeof(NumberData), &NumberData, "HFRE Call Line Identification");
+      else
+         DispatchHFREEvent(Port, etHFRE_Call_Waiting_Notification_Indication, sizeof(NumberData), &NumberData, "HFRE Call Waiting Notification");
+   }
+   else if(!strncmp(Line, "+BSIR:", 6))
+   {
+      InBandData.Enabled = (Boolean_t)(strtoul(Value, NULL, 10)?TRUE:FALSE);
+
+      DispatchHFREEvent(Port, etHFRE_InBand_Ring_Tone_Setting_Indication, sizeof(InBandData), &InBandData, "HFRE In-Band Ring Tone Setting");
+   }
+   else if(!strncmp(Line, "+BCS:", 5))
+   {
+      CodecData.CodecID = (unsigned int)strtoul(Value, NULL, 10);
+
+      DispatchHFREEvent(Port, etHFRE_Codec_Select_Request_Indication, sizeof(CodecData), &CodecData, "HFRE Codec Select Request");
+   }
+   else if(!strncmp(Line, "+CHLD:", 6))
+   {
+      /* The mask bits are in the order 0, 1, 1x, 2, 2x, 3, 4.          */
+      Port->CallHoldSupport = 0;
+
+      while(*Value)
+      {
+         if((*Value >= '0') && (*Value <= '4'))
+         {
+            Number = (unsigned int)(*Value - '0');
+
+            if(Value[1] == 'x')
+               Port->CallHoldSupport |= (Number == 1)?0x04:0x10;
+            else
+               Port->CallHoldSupport |= (unsigned long)((Number == 0)?0x01:(Number == 1)?0x02:(Number == 2)?0x08:(Number == 3)?0x20:0x40);
+         }
+
+         Value++;
+      }
+
+      if(Port->ServiceLevelConnection)
+      {
+         CallHoldData.CallHoldSupportMask = Port->CallHoldSupport;
+
+         DispatchHFREEvent(Port, etHFRE_Call_Hold_Multiparty_Support_Confirmation, sizeof(CallHoldData), &CallHoldData, "HFRE Call Hold Support Confirmation");
+      }
+   }
+   else if((!strcmp(Line, "OK")) || (!strcmp(Line, "ERROR")) || (!strncmp(Line, "+CME ERROR", 10)))
+   {
+      if(!Port->ServiceLevelConnection)
+      {
+         /* The setup ends with AT+CHLD=? or, if the AG does not support*/
+         /* three way calling, with AT+CMER.                            */
+         if((Line[0] == 'O') && ((!strncmp(Port->LastCommand, "AT+CHLD=?", 9)) || ((!strncmp(Port->LastCommand, "AT+CMER", 7)) && (!(Port->RemoteFeatures & 0x01)))))
+         {
+            Port->ServiceLevelConnection = TRUE;
+
+            ServiceLevelData.RemoteSupportedFeaturesValid    = TRUE;
+            ServiceLevelData.RemoteSupportedFeatures         = Port->RemoteFeatures;
+            ServiceLevelData.RemoteCallHoldMultipartySupport = Port->CallHoldSupport;
+
+            DispatchHFREEvent(Port, etHFRE_Open_Service_Level_Connection_Indication, sizeof(ServiceLevelData), &ServiceLevelData, "HFRE Service Level Connection");
+         }
+      }
+      else
+      {
+         ResultData.ResultType  = (Line[0] == 'O')?HFRE_RESULT_TYPE_OK:HFRE_RESULT_TYPE_ERROR;
+         ResultData.ResultValue = (Line[0] == '+')?(unsigned int)strtoul(Value, NULL, 10):0;
+
+         DispatchHFREEvent(Port, etHFRE_Command_Result, sizeof(ResultData), &ResultData, "HFRE Command Result");
+      }
+   }
+}
+
+   /* The following function decodes an RFCOMM frame.  Received frames   */
+   /* open and close the HFRE ports and carry the AT results of the AG, */
+   /* sent frames carry the AT commands of the stack (only remembered). */
+static void ProcessRFCOMMFrame(unsigned int Direction, Connection_t *Connection, unsigned int Length, Byte_t *Frame)
+{
+   char                               Line[MAXIMUM_AT_LINE];
+   Byte_t                             Control;
+   HFREPort_t                        *Port;
+   unsigned int                       Index;
+   unsigned int                       Header;
+   unsigned int                       LineLength;
+   unsigned int                       InformationLength;
+   HFRE_Open_Port_Indication_Data_t   OpenPortIndicationData;
+   HFRE_Open_Port_Confirmation_Data_t OpenPortConfirmationData;
+   HFRE_Close_Port_Indication_Data_t  ClosePortData;
+
+   Control = (Byte_t)(Frame[1] & ~RFCOMM_POLL_FINAL_BIT);
+
+   /* Only the frames of the data channels matter (DLCI 0 is the        */
+   /* multiplexer control channel).                                     */
+   if(!(Frame[0] >> 2))
+      return;
+
+   if((Port = FindPortByChannel(Connection->Handle, (unsigned int)(Frame[0] >> 3))) == NULL)
+      return;
+
+   if(Frame[2] & 0x01)
+   {
+      InformationLength = (unsigned int)(Frame[2] >> 1);
+      Header            = 3;
+   }
+   else
+   {
+      InformationLength = (unsigned int)((Frame[2] >> 1) | (Frame[3] << 7));
+      Header            = 4;
+   }
+
+   /* UIH frames with the Poll bit set carry a credit byte.             */
+   if((Control == RFCOMM_FRAME_UIH) && (Frame[1] & RFCOMM_POLL_FINAL_BIT))
+      Header++;
+
+   if(Direction == BTSNOOP_DIRECTION_RECEIVED)
+   {
+      switch(Control)
+      {
+         case RFCOMM_FRAME_SABM:
+            if((Port->ServerPort) && (!Port->Connected))
+            {
+               Port->Connected              = TRUE;
+               Port->Handle                 = Connection->Handle;
+               Port->BD_ADDR                = Connection->BD_ADDR;
+               Port->ServiceLevelConnection = FALSE;
+               Port->LastCommand[0]         = '\0';
+
+               OpenPortIndicationData.BD_ADDR = Connection->BD_ADDR;
+
+               DispatchHFREEvent(Port, etHFRE_Open_Port_Indication, sizeof(OpenPortIndicationData), &OpenPortIndicationData, "HFRE Open Port Indication");
+            }
+            break;
+         case RFCOMM_FRAME_UA:
+         case RFCOMM_FRAME_DM:
+            if(Port->Connecting)
+            {
+               Port->Connecting = FALSE;
+
+               if(Control == RFCOMM_FRAME_UA)
+               {
+                  Port->Connected = TRUE;
+                  Port->Handle    = Connection->Handle;
+
+                  OpenPortConfirmationData.PortOpenStatus = HFRE_OPEN_PORT_STATUS_SUCCESS;
+               }
+               else
+                  OpenPortConfirmationData.PortOpenStatus = HFRE_PORT_STATUS_FAILURE;
+
+               DispatchHFREEvent(Port, etHFRE_Open_Port_Confirmation, sizeof(OpenPortConfirmationData), &OpenPortConfirmationData, "HFRE Open Port Confirmation");
+            }
+            break;
+         case RFCOMM_FRAME_DISC:
+            if(Port->Connected)
+            {
+               Port->Connected               = FALSE;
+               Port->ServiceLevelConnection  = FALSE;
+               ClosePortData.PortCloseStatus = 0;
+
+               DispatchHFREEvent(Port, etHFRE_Close_Port_Indication, sizeof(ClosePortData), &ClosePortData, "HFRE Close Port Indication");
+            }
+            break;
+      }
+   }
+
+   if((Control == RFCOMM_FRAME_UIH) && (Port->Connected) && (Length > Header))
+   {
+      /* Split the (possibly truncated) information into lines.         */
+      if(InformationLength > (Length - Header))
+         InformationLength = Length - Header;
+
+      LineLength = 0;
+
+      for(Index=0;Index<=InformationLength;Index++)
+      {
+         if((Index == InformationLength) || (Frame[Header + Index] == '\r') || (Frame[Header + Index] == '\n'))
+         {
+            if(LineLength)
+            {
+               Line[LineLength] = '\0';
+
+               if(Direction == BTSNOOP_DIRECTION_SENT)
+                  BTPS_MemCopy(Port->LastCommand, Line, LineLength + 1);
+               else
+                  ProcessATLine(Port, Line);
+            }
+
+            LineLength = 0;
+         }
+         else
+         {
+            if(LineLength < (MAXIMUM_AT_LINE - 1))
+               Line[LineLength++] = (char)Frame[Header + Index];
+         }
+      }
+   }
+}
+
+   /* The following function decodes an ACL packet (without the packet   */
+   /* type).  Only the first fragment of an L2CAP frame is looked at.   */
+static void ProcessACLData(unsigned int Direction, unsigned int Length, Byte_t *Packet)
+{
+   Word_t                                                    Channel;
+   Byte_t                                                   *Frame;
+   Byte_t                                                    Control;
+   unsigned int                                              FrameLength;
+   unsigned int                                              L2CAPLength;
+   unsigned int                                              InformationLength;
+   Connection_t                                             *Connection;
+   GAP_LE_Connection_Parameter_Update_Response_Event_Data_t  ResponseData;
+
+   if(Length < 8)
+      return;
+
+   /* Continuing fragments (Packet Boundary 01) are skipped.            */
+   if(((Packet[1] >> 4) & 0x03) == 0x01)
+      return;
+
+   if((Connection = FindConnectionByHandle((Word_t)(READ_UNALIGNED_WORD_LITTLE_ENDIAN(Packet) & 0x0FFF))) == NULL)
+      return;
+
+   L2CAPLength = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Packet[4]);
+   Channel     = READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Packet[6]);
+   Frame       = &Packet[8];
+   FrameLength = Length - 8;
+
+   if(Connection->LinkType == LINK_TYPE_LE)
+   {
+      /* Requests have even opcodes, responses and the notifications   */
+      /* and indications of the remote server odd ones.                 */
+      if((Channel == L2CAP_CID_ATT) && (Direction == BTSNOOP_DIRECTION_RECEIVED) && (FrameLength) && (L2CAPLength))
+      {
+         if(Frame[0] & 0x01)
+            ProcessATTResponse(Connection, (FrameLength < L2CAPLength)?FrameLength:L2CAPLength, Frame);
+         else
+            ProcessATTRequest(Connection, (FrameLength < L2CAPLength)?FrameLength:L2CAPLength, Frame);
+      }
+
+      /* The answer of the master to a connection parameter update      */
+      /* request (result 0 is accepted).                                */
+      if((Channel == L2CAP_CID_LE_SIGNALLING) && (Direction == BTSNOOP_DIRECTION_RECEIVED) && (FrameLength >= 6) && (Frame[0] == L2CAP_CODE_CONNECTION_PARAMETER_UPDATE_RESPONSE))
+      {
+         ResponseData.BD_ADDR  = Connection->BD_ADDR;
+         ResponseData.Accepted = (Boolean_t)((READ_UNALIGNED_WORD_LITTLE_ENDIAN(&Frame[4]) == 0)?TRUE:FALSE);
+
+         DispatchGAPLEEvent(etLE_Connection_Parameter_Update_Response, sizeof(ResponseData), &ResponseData, "GAP LE Connection Parameter Update Response");
+      }
+   }
+   else
+   {
+      /* A frame on a dynamic channel is RFCOMM if the address has the  */
+      /* EA bit set, the control field is an RFCOMM frame type and the  */
+      /* RFCOMM length matches the L2CAP length.                        */
+      if((Channel >= L2CAP_CID_DYNAMIC_START) && (FrameLength >= 4) && (Frame[0] & 0x01))
+      {
+         Control = (Byte_t)(Frame[1] & ~RFCOMM_POLL_FINAL_BIT);
+
+         if((Control == RFCOMM_FRAME_SABM) || (Control == RFCOMM_FRAME_UA) || (Control == RFCOMM_FRAME_DM) || (Control == RFCOMM_FRAME_DISC) || (Control == RFCOMM_FRAME_UIH))
+         {
+            if(Frame[2] & 0x01)
+               InformationLength = 3 + (unsigned int)(Frame[2] >> 1);
+            else
+               InformationLength = 4 + (unsigned int)((Frame[2] >> 1) | (Frame[3] << 7));
+
+            if((Control == RFCOMM_FRAME_UIH) && (Frame[1] & RFCOMM_POLL_FINAL_BIT))
+               InformationLength++;
+
+            if((InformationLength + 1) == L2CAPLength)
+               ProcessRFCOMMFrame(Direction, Connection, (FrameLength < L2CAPLength)?FrameLength:L2CAPLength, Frame);
+         }
+      }
+   }
+}
+
+   /* The following function resets the stand-in and installs the        */
+   /* function that receives the issued HCI commands.                   */
+void StandIn_Initialize(StandIn_Command_Callback_t Callback, unsigned long CallbackParameter)
+{
+   unsigned int Index;
+
+   for(Index=0;Index<MAXIMUM_CONNECTIONS;Index++)
+   {
+      if((Connections[Index].InUse) && (Connections[Index].Discovery))
+         BTPS_FreeMemory(Connections[Index].Discovery);
+   }
+
+   BTPS_MemInitialize(HCICallback, 0, sizeof(HCICallback));
+   BTPS_MemInitialize(Connections, 0, sizeof(Connections));
+   BTPS_MemInitialize(NameRequests, 0, sizeof(NameRequests));
+   BTPS_MemInitialize(BondingRequests, 0, sizeof(BondingRequests));
+   BTPS_MemInitialize(GATTServices, 0, sizeof(GATTServices));
+   BTPS_MemInitialize(HFREPorts, 0, sizeof(HFREPorts));
+   BTPS_MemInitialize(EventStatistics, 0, sizeof(EventStatistics));
+   BTPS_MemInitialize(StandIn_Flash, 0xFF, sizeof(StandIn_Flash));
+
+   CommandCallback                   = Callback;
+   CommandCallbackParameter          = CallbackParameter;
+   ResponseCallback                  = NULL;
+   ResponseCallbackParameter         = 0;
+   SignallingCallback                = NULL;
+   SignallingCallbackParameter       = 0;
+   SignallingIdentifier              = 0;
+   DispatchCallback                  = NULL;
+   DispatchCallbackParameter         = 0;
+   ServiceCallback                   = NULL;
+   ServiceCallbackParameter          = 0;
+   CurrentTime                       = 0;
+   NextGATTHandle                    = STAND_IN_DEFAULT_GATT_STARTING_HANDLE;
+   AuthenticationCallback            = NULL;
+   LEAuthenticationCallback          = NULL;
+   LEAdvertisingCallback             = NULL;
+   LEScanCallback                    = NULL;
+   Advertising                       = FALSE;
+   InquiryCallback                   = NULL;
+   GATTConnectionCallback            = NULL;
+   NumberInquiryResults              = 0;
+   NextGATTServiceID                 = 0;
+   NextTransactionID                 = 0;
+   NextHFREPortID                    = 0;
+   SCOPacketType                     = 0x003F;
+   SCOMaxLatency                     = 0xFFFF;
+   SCORetransmissionEffort           = 0xFF;
+   Discoverable                      = FALSE;
+   Connectable                       = FALSE;
+   SimplePairingEnabled              = FALSE;
+   MaintainRole                      = FALSE;
+   ActiveFeatures                    = 0;
+   NumberEventTypes                  = 0;
+   LocalName[0]                      = '\0';
+
+   ASSIGN_CLASS_OF_DEVICE(LocalClassOfDevice, 0, 0, 0);
+}
+
+   /* The following function installs the function that receives the     */
+   /* ATT responses.                                                    */
+void StandIn_SetResponseCallback(StandIn_Response_Callback_t Callback, unsigned long CallbackParameter)
+{
+   ResponseCallback          = Callback;
+   ResponseCallbackParameter = CallbackParameter;
+}
+
+   /* The following function installs the function that receives the LE */
+   /* signalling commands.                                              */
+void StandIn_SetSignallingCallback(StandIn_Signalling_Callback_t Callback, unsigned long CallbackParameter)
+{
+   SignallingCallback          = Callback;
+   SignallingCallbackParameter = CallbackParameter;
+}
+
+   /* The following function installs the function that is called after */
+   /* every application callback.                                       */
+void StandIn_SetDispatchCallback(StandIn_Dispatch_Callback_t Callback, unsigned long CallbackParameter)
+{
+   DispatchCallback          = Callback;
+   DispatchCallbackParameter = CallbackParameter;
+}
+
+   /* The following function installs the function that is called with  */
+   /* every registered GATT service.                                    */
+void StandIn_SetServiceCallback(StandIn_Service_Callback_t Callback, unsigned long CallbackParameter)
+{
+   ServiceCallback          = Callback;
+   ServiceCallbackParameter = CallbackParameter;
+}
+
+   /* The following function sets the handle the next registered GATT    */
+   /* service starts at.                                                */
+void StandIn_SetGATTStartingHandle(Word_t Handle)
+{
+   NextGATTHandle = Handle;
+}
+
+   /* The following function sets the time (in ms) reported to the       */
+   /* application.                                                      */
+void StandIn_SetTime(unsigned long Time)
+{
+   CurrentTime = Time;
+}
+
+   /* The following function returns the time (in ms) reported to the   */
+   /* application.                                                      */
+unsigned long StandIn_GetTime(void)
+{
+   return(CurrentTime);
+}
+
+   /* The following function enables or disables the output of the       */
+   /* application.                                                      */
+void StandIn_SetVerbose(Boolean_t Enable)
+{
+   Verbose = Enable;
+}
+
+   /* The following function returns TRUE if the specified HCI command is*/
+   /* issued by the stand-in.                                           */
+Boolean_t StandIn_IsModeledCommand(Word_t OpCode)
+{
+   Boolean_t ret_val;
+
+   switch(OpCode)
+   {
+      case HCI_OPCODE_INQUIRY:
+      case HCI_OPCODE_CREATE_CONNECTION:
+      case HCI_OPCODE_DISCONNECT:
+      case HCI_OPCODE_ACCEPT_CONNECTION_REQUEST:
+      case HCI_OPCODE_LINK_KEY_REQUEST_REPLY:
+      case HCI_OPCODE_LINK_KEY_REQUEST_NEGATIVE:
+      case HCI_OPCODE_PIN_CODE_REQUEST_REPLY:
+      case HCI_OPCODE_PIN_CODE_REQUEST_NEGATIVE:
+      case HCI_OPCODE_AUTHENTICATION_REQUESTED:
+      case HCI_OPCODE_REMOTE_NAME_REQUEST:
+      case HCI_OPCODE_READ_REMOTE_FEATURES:
+      case HCI_OPCODE_READ_CLOCK_OFFSET:
+      case HCI_OPCODE_SETUP_SYNCHRONOUS_CONNECTION:
+      case HCI_OPCODE_ACCEPT_SYNCHRONOUS_CONNECTION:
+      case HCI_OPCODE_IO_CAPABILITY_REQUEST_REPLY:
+      case HCI_OPCODE_USER_CONFIRMATION_REPLY:
+      case HCI_OPCODE_USER_CONFIRMATION_NEGATIVE:
+      case HCI_OPCODE_USER_PASSKEY_REPLY:
+      case HCI_OPCODE_REMOTE_OOB_DATA_NEGATIVE:
+      case HCI_OPCODE_SNIFF_MODE:
+      case HCI_OPCODE_EXIT_SNIFF_MODE:
+      case HCI_OPCODE_WRITE_DEFAULT_LINK_POLICY:
+      case HCI_OPCODE_SNIFF_SUBRATING:
+      case HCI_OPCODE_DELETE_STORED_LINK_KEY:
+      case HCI_OPCODE_WRITE_LOCAL_NAME:
+      case HCI_OPCODE_WRITE_SCAN_ENABLE:
+      case HCI_OPCODE_WRITE_CLASS_OF_DEVICE:
+      case HCI_OPCODE_WRITE_SIMPLE_PAIRING_MODE:
+      case HCI_OPCODE_LE_SET_ADVERTISING_PARAMETERS:
+      case HCI_OPCODE_LE_SET_ADVERTISING_DATA:
+      case HCI_OPCODE_LE_SET_SCAN_RESPONSE_DATA:
+      case HCI_OPCODE_LE_SET_ADVERTISE_ENABLE:
+      case HCI_OPCODE_LE_SET_SCAN_PARAMETERS:
+      case HCI_OPCODE_LE_SET_SCAN_ENABLE:
+         ret_val = TRUE;
+         break;
+      default:
+         ret_val = FALSE;
+         break;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function processes one packet of the trace.         */
+void StandIn_ProcessPacket(unsigned int Direction, Byte_t PacketType, unsigned int Length, Byte_t *Packet)
+{
+   if((Length) && (Packet))
+   {
+      switch(PacketType)
+      {
+         case HCI_EVENT_PACKET:
+            if(Direction == BTSNOOP_DIRECTION_RECEIVED)
+               ProcessEvent(Length, Packet);
+            break;
+         case HCI_ACL_PACKET:
+            ProcessACLData(Direction, Length, Packet);
+            break;
+         default:
+            /* Commands are compared by the replay engine, SCO data is  */
+            /* not looked at.                                           */
+            break;
+      }
+   }
+}
+
+   /* The following function copies the handler statistics to the        */
+   /* specified buffer.                                                 */
+unsigned int StandIn_QueryEventStatistics(unsigned int MaximumEntries, StandIn_Event_Statistics_t *Statistics)
+{
+   unsigned int ret_val;
+
+   ret_val = (MaximumEntries < NumberEventTypes)?MaximumEntries:NumberEventTypes;
+
+   if((ret_val) && (Statistics))
+      BTPS_MemCopy(Statistics, EventStatistics, ret_val * sizeof(StandIn_Event_Statistics_t));
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* Bluetooth Stack Controller (BSC) API.                             */
+int BTPSAPI BSC_Initialize(HCI_DriverInformation_t *HCI_DriverInformation, unsigned long Flags)
+{
+   return(HCI_DriverInformation?STAND_IN_BLUETOOTH_STACK_ID:STAND_IN_ERROR_INVALID_PARAMETER);
+}
+
+void BTPSAPI BSC_Shutdown(unsigned int BluetoothStackID)
+{
+}
+
+int BTPSAPI BSC_EnableFeature(unsigned int BluetoothStackID, unsigned long Feature)
+{
+   ActiveFeatures |= Feature;
+
+   return(0);
+}
+
+int BTPSAPI BSC_QueryActiveFeatures(unsigned int BluetoothStackID, unsigned long *Features)
+{
+   int ret_val;
+
+   if(Features)
+   {
+      *Features = ActiveFeatures;
+      ret_val   = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* Host Controller Interface (HCI) API.                              */
+int BTPSAPI HCI_Version_Supported(unsigned int BluetoothStackID, HCI_Version_t *HCI_Version)
+{
+   int ret_val;
+
+   if(HCI_Version)
+   {
+      /* The CC256x is a Bluetooth 4.0 controller.                      */
+      *HCI_Version = 6;
+      ret_val      = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI HCI_Command_Supported(unsigned int BluetoothStackID, unsigned int SupportedCommandBitNumber)
+{
+   return(1);
+}
+
+int BTPSAPI HCI_Register_Event_Callback(unsigned int BluetoothStackID, HCI_Event_Callback_t HCI_EventCallback, unsigned long CallbackParameter)
+{
+   int          ret_val = STAND_IN_ERROR_INSUFFICIENT_RESOURCES;
+   unsigned int Index;
+
+   if(HCI_EventCallback)
+   {
+      for(Index=0;(Index<MAXIMUM_HCI_CALLBACKS) && (ret_val < 0);Index++)
+      {
+         if(!HCICallback[Index])
+         {
+            HCICallback[Index]          = HCI_EventCallback;
+            HCICallbackParameter[Index] = CallbackParameter;
+
+            ret_val                     = (int)(Index + 1);
+         }
+      }
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI HCI_Un_Register_Callback(unsigned int BluetoothStackID, unsigned int CallbackID)
+{
+   int ret_val;
+
+   if((CallbackID) && (CallbackID <= MAXIMUM_HCI_CALLBACKS))
+   {
+      HCICallback[CallbackID - 1] = NULL;
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI HCI_Write_Default_Link_Policy_Settings(unsigned int BluetoothStackID, Word_t Link_Policy_Settings, Byte_t *StatusResult)
+{
+   Byte_t Parameters[2];
+
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(Parameters, Link_Policy_Settings);
+
+   SendCommand(HCI_OPCODE_WRITE_DEFAULT_LINK_POLICY, sizeof(Parameters), Parameters);
+
+   if(StatusResult)
+      *StatusResult = HCI_ERROR_CODE_NO_ERROR;
+
+   return(0);
+}
+
+int BTPSAPI HCI_Sniff_Mode(unsigned int BluetoothStackID, Word_t Connection_Handle, Word_t Sniff_Max_Interval, Word_t Sniff_Min_Interval, Word_t Sniff_Attempt, Word_t Sniff_Timeout, Byte_t *StatusResult)
+{
+   Byte_t Parameters[10];
+
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[0], Connection_Handle);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[2], Sniff_Max_Interval);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[4], Sniff_Min_Interval);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[6], Sniff_Attempt);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[8], Sniff_Timeout);
+
+   SendCommand(HCI_OPCODE_SNIFF_MODE, sizeof(Parameters), Parameters);
+
+   if(StatusResult)
+      *StatusResult = HCI_ERROR_CODE_NO_ERROR;
+
+   return(0);
+}
+
+int BTPSAPI HCI_Exit_Sniff_Mode(unsigned int BluetoothStackID, Word_t Connection_Handle, Byte_t *StatusResult)
+{
+   SendHandleCommand(HCI_OPCODE_EXIT_SNIFF_MODE, Connection_Handle);
+
+   if(StatusResult)
+      *StatusResult = HCI_ERROR_CODE_NO_ERROR;
+
+   return(0);
+}
+
+int BTPSAPI HCI_Sniff_Subrating(unsigned int BluetoothStackID, Word_t Connection_Handle, Word_t Maximum_Latency, Word_t Minimum_Remote_Timeout, Word_t Minimum_Local_Timeout, Byte_t *StatusResult, Word_t *Connection_HandleResult)
+{
+   Byte_t Parameters[8];
+
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[0], Connection_Handle);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[2], Maximum_Latency);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[4], Minimum_Remote_Timeout);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[6], Minimum_Local_Timeout);
+
+   SendCommand(HCI_OPCODE_SNIFF_SUBRATING, sizeof(Parameters), Parameters);
+
+   if(StatusResult)
+      *StatusResult = HCI_ERROR_CODE_NO_ERROR;
+
+   if(Connection_HandleResult)
+      *Connection_HandleResult = Connection_Handle;
+
+   return(0);
+}
+
+int BTPSAPI HCI_Read_Clock_Offset(unsigned int BluetoothStackID, Word_t Connection_Handle, Byte_t *StatusResult)
+{
+   SendHandleCommand(HCI_OPCODE_READ_CLOCK_OFFSET, Connection_Handle);
+
+   if(StatusResult)
+      *StatusResult = HCI_ERROR_CODE_NO_ERROR;
+
+   return(0);
+}
+
+int BTPSAPI HCI_Read_Remote_Supported_Features(unsigned int BluetoothStackID, Word_t Connection_Handle, Byte_t *StatusResult)
+{
+   SendHandleCommand(HCI_OPCODE_READ_REMOTE_FEATURES, Connection_Handle);
+
+   if(StatusResult)
+      *StatusResult = HCI_ERROR_CODE_NO_ERROR;
+
+   return(0);
+}
+
+int BTPSAPI HCI_Create_Connection(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, Word_t Packet_Type, Byte_t Page_Scan_Repetition_Mode, Byte_t Page_Scan_Mode, Word_t Clock_Offset, Byte_t Allow_Role_Switch, Byte_t *StatusResult)
+{
+   Byte_t Parameters[13];
+
+   WriteBD_ADDR(Parameters, BD_ADDR);
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[6], Packet_Type);
+   Parameters[8]  = Page_Scan_Repetition_Mode;
+   Parameters[9]  = Page_Scan_Mode;
+   ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[10], Clock_Offset);
+   Parameters[12] = Allow_Role_Switch;
+
+   SendCommand(HCI_OPCODE_CREATE_CONNECTION, sizeof(Parameters), Parameters);
+
+   if(StatusResult)
+      *StatusResult = HCI_ERROR_CODE_NO_ERROR;
+
+   return(0);
+}
+
+int BTPSAPI HCI_Delete_Stored_Link_Key(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, Byte_t Delete_All_Flag, Byte_t *StatusResult, Word_t *Num_Keys_DeletedResult)
+{
+   Byte_t Parameters[7];
+
+   WriteBD_ADDR(Parameters, BD_ADDR);
+   Parameters[6] = Delete_All_Flag;
+
+   SendCommand(HCI_OPCODE_DELETE_STORED_LINK_KEY, sizeof(Parameters), Parameters);
+
+   if(StatusResult)
+      *StatusResult = HCI_ERROR_CODE_NO_ERROR;
+
+   if(Num_Keys_DeletedResult)
+      *Num_Keys_DeletedResult = 0;
+
+   return(0);
+}
+
+   /* Synchronous Connection Oriented (SCO) API.                        */
+int BTPSAPI SCO_Set_Synchronous_Parameters(unsigned int BluetoothStackID, Word_t Packet_Type, Word_t Max_Latency, Byte_t Retransmission_Effort)
+{
+   SCOPacketType           = Packet_Type;
+   SCOMaxLatency           = Max_Latency;
+   SCORetransmissionEffort = Retransmission_Effort;
+
+   return(0);
+}
+
+   /* Logical Link Control and Adaptation Protocol (L2CAP) API.         */
+int BTPSAPI L2CA_Connection_Parameter_Update_Request(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, Word_t IntervalMin, Word_t IntervalMax, Word_t SlaveLatency, Word_t TimeoutMultiplier)
+{
+   int           ret_val;
+   Byte_t        Command[12];
+   Connection_t *Connection;
+
+   if((Connection = FindConnectionByBD_ADDR(BD_ADDR, LINK_TYPE_LE)) != NULL)
+   {
+      /* Identifier 0 is not allowed.                                   */
+      if(!++SignallingIdentifier)
+         SignallingIdentifier = 1;
+
+      Command[0] = L2CAP_CODE_CONNECTION_PARAMETER_UPDATE_REQUEST;
+      Command[1] = SignallingIdentifier;
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Command[2], 8);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Command[4], IntervalMin);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Command[6], IntervalMax);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Command[8], SlaveLatency);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Command[10], TimeoutMultiplier);
+
+      if(SignallingCallback)
+         (*SignallingCallback)(Connection->Handle, sizeof(Command), Command, SignallingCallbackParameter);
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_NOT_CONNECTED;
+
+   return(ret_val);
+}
+
+int BTPSAPI L2CA_Set_Link_Connection_Configuration(unsigned int BluetoothStackID, L2CA_Link_Connect_Params_t *L2CA_Link_Connect_Params)
+{
+   int ret_val;
+
+   if(L2CA_Link_Connect_Params)
+   {
+      MaintainRole = (Boolean_t)((L2CA_Link_Connect_Params->L2CA_Link_Connect_Response_Config == csMaintainCurrentRole)?TRUE:FALSE);
+
+      ret_val      = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* Generic Access Profile (GAP) API.                                 */
+int BTPSAPI GAP_Set_Discoverability_Mode(unsigned int BluetoothStackID, GAP_Discoverability_Mode_t GAP_Discoverability_Mode, unsigned int Max_Discoverable_Time)
+{
+   Discoverable = (Boolean_t)((GAP_Discoverability_Mode != dmNonDiscoverableMode)?TRUE:FALSE);
+
+   SendScanEnable();
+
+   return(0);
+}
+
+int BTPSAPI GAP_Set_Connectability_Mode(unsigned int BluetoothStackID, GAP_Connectability_Mode_t GAP_Connectability_Mode)
+{
+   Connectable = (Boolean_t)((GAP_Connectability_Mode != cmNonConnectableMode)?TRUE:FALSE);
+
+   SendScanEnable();
+
+   return(0);
+}
+
+int BTPSAPI GAP_Set_Pairability_Mode(unsigned int BluetoothStackID, GAP_Pairability_Mode_t GAP_Pairability_Mode)
+{
+   Byte_t Enable;
+
+   /* Secure Simple Pairing is enabled in the controller once, pairing  */
+   /* is otherwise handled by the host.                                 */
+   if((GAP_Pairability_Mode == pmPairableMode_EnableSecureSimplePairing) && (!SimplePairingEnabled))
+   {
+      SimplePairingEnabled = TRUE;
+      Enable               = 1;
+
+      SendCommand(HCI_OPCODE_WRITE_SIMPLE_PAIRING_MODE, sizeof(Enable), &Enable);
+   }
+
+   return(0);
+}
+
+int BTPSAPI GAP_Register_Remote_Authentication(unsigned int BluetoothStackID, GAP_Event_Callback_t GAP_Event_Callback, unsigned long CallbackParameter)
+{
+   AuthenticationCallback          = GAP_Event_Callback;
+   AuthenticationCallbackParameter = CallbackParameter;
+
+   return(0);
+}
+
+int BTPSAPI GAP_Authentication_Response(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, GAP_Authentication_Information_t *GAP_Authentication_Information)
+{
+   int    ret_val = 0;
+   Byte_t Parameters[7 + sizeof(PIN_Code_t)];
+
+   if(GAP_Authentication_Information)
+   {
+      WriteBD_ADDR(Parameters, BD_ADDR);
+
+      switch(GAP_Authentication_Information->GAP_Authentication_Type)
+      {
+         case atLinkKey:
+            if(GAP_Authentication_Information->Authentication_Data_Length)
+            {
+               BTPS_MemCopy(&Parameters[6], &GAP_Authentication_Information->Authentication_Data.Link_Key, sizeof(Link_Key_t));
+
+               SendCommand(HCI_OPCODE_LINK_KEY_REQUEST_REPLY, 6 + sizeof(Link_Key_t), Parameters);
+            }
+            else
+               SendCommand(HCI_OPCODE_LINK_KEY_REQUEST_NEGATIVE, 6, Parameters);
+            break;
+         case atPINCode:
+            if(GAP_Authentication_Information->Authentication_Data_Length)
+            {
+               Parameters[6] = GAP_Authentication_Information->Authentication_Data_Length;
+
+               BTPS_MemCopy(&Parameters[7], &GAP_Authentication_Information->Authentication_Data.PIN_Code, sizeof(PIN_Code_t));
+
+               SendCommand(HCI_OPCODE_PIN_CODE_REQUEST_REPLY, 7 + sizeof(PIN_Code_t), Parameters);
+            }
+            else
+               SendCommand(HCI_OPCODE_PIN_CODE_REQUEST_NEGATIVE, 6, Parameters);
+            break;
+         case atIOCapabilities:
+            /* The bonding is always reported as General Bonding.       */
+            Parameters[6] = (Byte_t)GAP_Authentication_Information->Authentication_Data.IO_Capabilities.IO_Capability;
+            Parameters[7] = (Byte_t)(GAP_Authentication_Information->Authentication_Data.IO_Capabilities.OOB_Data_Present?1:0);
+            Parameters[8] = (Byte_t)(0x04 | (GAP_Authentication_Information->Authentication_Data.IO_Capabilities.MITM_Protection_Required?0x01:0x00));
+
+            SendCommand(HCI_OPCODE_IO_CAPABILITY_REQUEST_REPLY, 9, Parameters);
+            break;
+         case atUserConfirmation:
+            SendCommand((Word_t)(GAP_Authentication_Information->Authentication_Data.Confirmation?HCI_OPCODE_USER_CONFIRMATION_REPLY:HCI_OPCODE_USER_CONFIRMATION_NEGATIVE), 6, Parameters);
+            break;
+         case atPassKey:
+            Parameters[6] = (Byte_t)(GAP_Authentication_Information->Authentication_Data.Passkey);
+            Parameters[7] = (Byte_t)(GAP_Authentication_Information->Authentication_Data.Passkey >> 8);
+            Parameters[8] = (Byte_t)(GAP_Authentication_Information->Authentication_Data.Passkey >> 16);
+            Parameters[9] = (Byte_t)(GAP_Authentication_Information->Authentication_Data.Passkey >> 24);
+
+            SendCommand(HCI_OPCODE_USER_PASSKEY_REPLY, 10, Parameters);
+            break;
+         case atOutOfBandData:
+            SendCommand(HCI_OPCODE_REMOTE_OOB_DATA_NEGATIVE, 6, Parameters);
+            break;
+         default:
+            ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+            break;
+      }
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI GAP_Perform_Inquiry(unsigned int BluetoothStackID, GAP_Inquiry_Type_t GAP_Inquiry_Type, unsigned int MinimumPeriodLength, unsigned int MaximumPeriodLength, unsigned int InquiryLength, unsigned int MaximumResponses, GAP_Event_Callback_t GAP_Event_Callback, unsigned long CallbackParameter)
+{
+   Byte_t Parameters[5];
+
+   InquiryCallback          = GAP_Event_Callback;
+   InquiryCallbackParameter = CallbackParameter;
+   NumberInquiryResults     = 0;
+
+   /* General (GIAC) or Limited (LIAC) inquiry access code.             */
+   Parameters[0] = (Byte_t)((GAP_Inquiry_Type == itLimitedInquiry)?0x00:0x33);
+   Parameters[1] = 0x8B;
+   Parameters[2] = 0x9E;
+   Parameters[3] = (Byte_t)InquiryLength;
+   Parameters[4] = (Byte_t)MaximumResponses;
+
+   SendCommand(HCI_OPCODE_INQUIRY, sizeof(Parameters), Parameters);
+
+   return(0);
+}
+
+int BTPSAPI GAP_Query_Remote_Device_Name(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, GAP_Event_Callback_t GAP_Event_Callback, unsigned long CallbackParameter)
+{
+   int          ret_val;
+   Byte_t       Parameters[10];
+   unsigned int Index;
+
+   if(AddPendingRequest(NameRequests, BD_ADDR, GAP_Event_Callback, CallbackParameter))
+   {
+      /* The paging information of the last inquiry is used.            */
+      WriteBD_ADDR(Parameters, BD_ADDR);
+      Parameters[6] = 0x01;
+      Parameters[7] = 0x00;
+      Parameters[8] = 0x00;
+      Parameters[9] = 0x00;
+
+      for(Index=0;Index<NumberInquiryResults;Index++)
+      {
+         if(COMPARE_BD_ADDR(InquiryResults[Index].BD_ADDR, BD_ADDR))
+         {
+            Parameters[6] = InquiryResults[Index].Page_Scan_Repetition_Mode;
+
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[8], (InquiryResults[Index].Clock_Offset | 0x8000));
+         }
+      }
+
+      SendCommand(HCI_OPCODE_REMOTE_NAME_REQUEST, sizeof(Parameters), Parameters);
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INSUFFICIENT_RESOURCES;
+
+   return(ret_val);
+}
+
+int BTPSAPI GAP_Initiate_Bonding(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, GAP_Bonding_Type_t GAP_Bonding_Type, GAP_Event_Callback_t GAP_Event_Callback, unsigned long CallbackParameter)
+{
+   int               ret_val;
+   Byte_t            Parameters[13];
+   Connection_t     *Connection;
+   PendingRequest_t *Request;
+
+   if((Request = AddPendingRequest(BondingRequests, BD_ADDR, GAP_Event_Callback, CallbackParameter)) != NULL)
+   {
+      if((Connection = FindConnectionByBD_ADDR(BD_ADDR, LINK_TYPE_ACL)) != NULL)
+         SendHandleCommand(HCI_OPCODE_AUTHENTICATION_REQUESTED, Connection->Handle);
+      else
+      {
+         /* Page the device first, the authentication is requested when */
+         /* the link is up.                                             */
+         Request->WaitingForConnection = TRUE;
+
+         WriteBD_ADDR(Parameters, BD_ADDR);
+         ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[6], (HCI_PACKET_ACL_TYPE_DM1 | HCI_PACKET_ACL_TYPE_DH1 | HCI_PACKET_ACL_TYPE_DM3 | HCI_PACKET_ACL_TYPE_DH3 | HCI_PACKET_ACL_TYPE_DM5 | HCI_PACKET_ACL_TYPE_DH5));
+         Parameters[8]  = 0x01;
+         Parameters[9]  = 0x00;
+         Parameters[10] = 0x00;
+         Parameters[11] = 0x00;
+         Parameters[12] = HCI_ROLE_SWITCH_LOCAL_MASTER_ACCEPT_ROLE_SWITCH;
+
+         SendCommand(HCI_OPCODE_CREATE_CONNECTION, sizeof(Parameters), Parameters);
+      }
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INSUFFICIENT_RESOURCES;
+
+   return(ret_val);
+}
+
+int BTPSAPI GAP_End_Bonding(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR)
+{
+   int               ret_val;
+   Byte_t            Parameters[3];
+   Connection_t     *Connection;
+   PendingRequest_t *Request;
+
+   if((Request = FindPendingRequest(BondingRequests, BD_ADDR)) != NULL)
+   {
+      Request->InUse = FALSE;
+
+      /* The link is only dropped if no profile uses it.                */
+      if(((Connection = FindConnectionByBD_ADDR(BD_ADDR, LINK_TYPE_ACL)) != NULL) && (!FindPortByBD_ADDR(BD_ADDR)))
+      {
+         ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(Parameters, Connection->Handle);
+         Parameters[2] = 0x13;
+
+         SendCommand(HCI_OPCODE_DISCONNECT, sizeof(Parameters), Parameters);
+      }
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI GAP_Query_Local_BD_ADDR(unsigned int BluetoothStackID, BD_ADDR_t *BD_ADDR)
+{
+   int ret_val;
+
+   if(BD_ADDR)
+   {
+      ASSIGN_BD_ADDR(*BD_ADDR, 0x00, 0x17, 0xE9, 0x00, 0x00, 0x01);
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI GAP_Set_Local_Device_Name(unsigned int BluetoothStackID, char *Name)
+{
+   int    ret_val;
+   Byte_t Parameters[MAXIMUM_DEVICE_NAME];
+
+   if(Name)
+   {
+      BTPS_MemInitialize(Parameters, 0, sizeof(Parameters));
+      BTPS_MemInitialize(LocalName, 0, sizeof(LocalName));
+
+      BTPS_MemCopy(LocalName, Name, (BTPS_StringLength(Name) < MAXIMUM_DEVICE_NAME)?BTPS_StringLength(Name):MAXIMUM_DEVICE_NAME);
+      BTPS_MemCopy(Parameters, LocalName, BTPS_StringLength(LocalName));
+
+      SendCommand(HCI_OPCODE_WRITE_LOCAL_NAME, sizeof(Parameters), Parameters);
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI GAP_Query_Local_Device_Name(unsigned int BluetoothStackID, unsigned int NameBufferLength, char *NameBuffer)
+{
+   int ret_val;
+
+   if((NameBufferLength) && (NameBuffer))
+   {
+      BTPS_MemInitialize(NameBuffer, 0, NameBufferLength);
+      BTPS_MemCopy(NameBuffer, LocalName, (BTPS_StringLength(LocalName) < NameBufferLength)?BTPS_StringLength(LocalName):(NameBufferLength - 1));
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI GAP_Set_Class_Of_Device(unsigned int BluetoothStackID, Class_of_Device_t Class_of_Device)
+{
+   Byte_t Parameters[3];
+
+   LocalClassOfDevice = Class_of_Device;
+
+   Parameters[0] = Class_of_Device.Class_of_Device0;
+   Parameters[1] = Class_of_Device.Class_of_Device1;
+   Parameters[2] = Class_of_Device.Class_of_Device2;
+
+   SendCommand(HCI_OPCODE_WRITE_CLASS_OF_DEVICE, sizeof(Parameters), Parameters);
+
+   return(0);
+}
+
+int BTPSAPI GAP_Query_Class_Of_Device(unsigned int BluetoothStackID, Class_of_Device_t *Class_of_Device)
+{
+   int ret_val;
+
+   if(Class_of_Device)
+   {
+      *Class_of_Device = LocalClassOfDevice;
+
+      ret_val          = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI GAP_Query_Connection_Handle(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, Word_t *Connection_Handle)
+{
+   int           ret_val;
+   Connection_t *Connection;
+
+   if(((Connection = FindConnectionByBD_ADDR(BD_ADDR, LINK_TYPE_ACL)) != NULL) && (Connection_Handle))
+   {
+      *Connection_Handle = Connection->Handle;
+
+      ret_val            = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_NOT_CONNECTED;
+
+   return(ret_val);
+}
+
+int BTPSAPI GAP_LE_Set_Pairability_Mode(unsigned int BluetoothStackID, GAP_LE_Pairability_Mode_t PairableMode)
+{
+   return(0);
+}
+
+int BTPSAPI GAP_LE_Register_Remote_Authentication(unsigned int BluetoothStackID, GAP_LE_Event_Callback_t GAP_LE_Event_Callback, unsigned long CallbackParameter)
+{
+   LEAuthenticationCallback          = GAP_LE_Event_Callback;
+   LEAuthenticationCallbackParameter = CallbackParameter;
+
+   return(0);
+}
+
+   /* The advertising and scan response data are issued as given (the   */
+   /* significant part, zero padded to 31 bytes).                       */
+int BTPSAPI GAP_LE_Set_Advertising_Data(unsigned int BluetoothStackID, unsigned int Length, Advertising_Data_t *Advertising_Data)
+{
+   int    ret_val;
+   Byte_t Parameters[32];
+
+   if((Length <= sizeof(Advertising_Data->Advertising_Data)) && ((!Length) || (Advertising_Data)))
+   {
+      BTPS_MemInitialize(Parameters, 0, sizeof(Parameters));
+
+      Parameters[0] = (Byte_t)Length;
+
+      if(Length)
+         BTPS_MemCopy(&Parameters[1], Advertising_Data->Advertising_Data, Length);
+
+      SendCommand(HCI_OPCODE_LE_SET_ADVERTISING_DATA, sizeof(Parameters), Parameters);
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI GAP_LE_Set_Scan_Response_Data(unsigned int BluetoothStackID, unsigned int Length, Scan_Response_Data_t *Scan_Response_Data)
+{
+   int    ret_val;
+   Byte_t Parameters[32];
+
+   if((Length <= sizeof(Scan_Response_Data->Scan_Response_Data)) && ((!Length) || (Scan_Response_Data)))
+   {
+      BTPS_MemInitialize(Parameters, 0, sizeof(Parameters));
+
+      Parameters[0] = (Byte_t)Length;
+
+      if(Length)
+         BTPS_MemCopy(&Parameters[1], Scan_Response_Data->Scan_Response_Data, Length);
+
+      SendCommand(HCI_OPCODE_LE_SET_SCAN_RESPONSE_DATA, sizeof(Parameters), Parameters);
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* Advertising is (re)started with the specified parameters, the     */
+   /* callback receives the LE connection events.  The controller only  */
+   /* accepts new parameters while advertising is disabled, so a running*/
+   /* advertising is disabled first.                                    */
+int BTPSAPI GAP_LE_Advertising_Enable(unsigned int BluetoothStackID, Boolean_t EnableScanResponse, GAP_LE_Advertising_Parameters_t *GAP_LE_Advertising_Parameters, GAP_LE_Connectability_Parameters_t *GAP_LE_Connectability_Parameters, GAP_LE_Event_Callback_t GAP_LE_Event_Callback, unsigned long CallbackParameter)
+{
+   int    ret_val;
+   Byte_t Enable;
+   Byte_t Parameters[15];
+
+   if((GAP_LE_Advertising_Parameters) && (GAP_LE_Connectability_Parameters))
+   {
+      if(Advertising)
+      {
+         Enable = 0;
+
+         SendCommand(HCI_OPCODE_LE_SET_ADVERTISE_ENABLE, sizeof(Enable), &Enable);
+      }
+
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[0], GAP_LE_Advertising_Parameters->Advertising_Interval_Min);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[2], GAP_LE_Advertising_Parameters->Advertising_Interval_Max);
+
+      /* ADV_IND, ADV_SCAN_IND or ADV_NONCONN_IND.                      */
+      if(GAP_LE_Connectability_Parameters->Connectability_Mode == lcmConnectable)
+         Parameters[4] = 0x00;
+      else
+         Parameters[4] = (Byte_t)(EnableScanResponse?0x02:0x03);
+
+      Parameters[5] = (Byte_t)GAP_LE_Connectability_Parameters->Own_Address_Type;
+      Parameters[6] = (Byte_t)GAP_LE_Connectability_Parameters->Direct_Address_Type;
+
+      WriteBD_ADDR(&Parameters[7], GAP_LE_Connectability_Parameters->Direct_Address);
+
+      Parameters[13] = GAP_LE_Advertising_Parameters->Advertising_Channel_Map;
+      Parameters[14] = (Byte_t)(((GAP_LE_Advertising_Parameters->Connect_Request_Filter == fpWhiteList)?0x02:0x00) | ((GAP_LE_Advertising_Parameters->Scan_Request_Filter == fpWhiteList)?0x01:0x00));
+
+      SendCommand(HCI_OPCODE_LE_SET_ADVERTISING_PARAMETERS, sizeof(Parameters), Parameters);
+
+      Enable = 1;
+
+      SendCommand(HCI_OPCODE_LE_SET_ADVERTISE_ENABLE, sizeof(Enable), &Enable);
+
+      LEAdvertisingCallback          = GAP_LE_Event_Callback;
+      LEAdvertisingCallbackParameter = CallbackParameter;
+      Advertising                    = TRUE;
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* A scan is (re)started with the specified parameters, the callback */
+   /* receives the advertising reports.  The intervals are in 0.625 ms  */
+   /* units.                                                            */
+int BTPSAPI GAP_LE_Perform_Scan(unsigned int BluetoothStackID, GAP_LE_Scan_Type_t ScanType, unsigned int ScanInterval, unsigned int ScanWindow, GAP_LE_Address_Type_t LocalAddressType, GAP_LE_Filter_Policy_t FilterPolicy, Boolean_t FilterDuplicates, GAP_LE_Event_Callback_t GAP_LE_Event_Callback, unsigned long CallbackParameter)
+{
+   int    ret_val;
+   Byte_t Parameters[7];
+
+   if((GAP_LE_Event_Callback) && (ScanWindow) && (ScanWindow <= ScanInterval) && (ScanInterval <= 0x4000))
+   {
+      if(LEScanCallback)
+      {
+         Parameters[0] = 0;
+         Parameters[1] = 0;
+
+         SendCommand(HCI_OPCODE_LE_SET_SCAN_ENABLE, 2, Parameters);
+      }
+
+      Parameters[0] = (Byte_t)((ScanType == stActive)?0x01:0x00);
+
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[1], (Word_t)ScanInterval);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[3], (Word_t)ScanWindow);
+
+      Parameters[5] = (Byte_t)LocalAddressType;
+      Parameters[6] = (Byte_t)((FilterPolicy == fpWhiteList)?0x01:0x00);
+
+      SendCommand(HCI_OPCODE_LE_SET_SCAN_PARAMETERS, sizeof(Parameters), Parameters);
+
+      Parameters[0] = 1;
+      Parameters[1] = (Byte_t)(FilterDuplicates?1:0);
+
+      SendCommand(HCI_OPCODE_LE_SET_SCAN_ENABLE, 2, Parameters);
+
+      LEScanCallback          = GAP_LE_Event_Callback;
+      LEScanCallbackParameter = CallbackParameter;
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI GAP_LE_Cancel_Scan(unsigned int BluetoothStackID)
+{
+   Byte_t Parameters[2];
+
+   if(LEScanCallback)
+   {
+      Parameters[0]  = 0;
+      Parameters[1]  = 0;
+      LEScanCallback = NULL;
+
+      SendCommand(HCI_OPCODE_LE_SET_SCAN_ENABLE, sizeof(Parameters), Parameters);
+   }
+
+   return(0);
+}
+
+int BTPSAPI GAP_LE_Advertising_Disable(unsigned int BluetoothStackID)
+{
+   Byte_t Enable;
+
+   if(Advertising)
+   {
+      Enable      = 0;
+      Advertising = FALSE;
+
+      SendCommand(HCI_OPCODE_LE_SET_ADVERTISE_ENABLE, sizeof(Enable), &Enable);
+   }
+
+   return(0);
+}
+
+   /* Service Discovery Protocol (SDP) API.  The SDP transactions are    */
+   /* carried on L2CAP and are not decoded, so requests are accepted but*/
+   /* never answered.                                                   */
+int BTPSAPI SDP_Service_Search_Attribute_Request(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, unsigned int NumberServiceUUID, SDP_UUID_Entry_t *SDP_UUID_Entry, unsigned int NumberAttributeListElements, SDP_Attribute_ID_List_Entry_t *AttributeIDList, SDP_Response_Callback_t SDP_Response_Callback, unsigned long CallbackParameter)
+{
+   return(1);
+}
+
+int BTPSAPI SDP_Delete_Service_Record(unsigned int BluetoothStackID, DWord_t Service_Record_Handle)
+{
+   return(0);
+}
+
+   /* Generic Attribute Profile (GATT) API.                             */
+int BTPSAPI GATT_Initialize(unsigned int BluetoothStackID, unsigned long Flags, GATT_Connection_Event_Callback_t ConnectionEventCallback, unsigned long CallbackParameter)
+{
+   GATTConnectionCallback          = ConnectionEventCallback;
+   GATTConnectionCallbackParameter = CallbackParameter;
+
+   return(0);
+}
+
+int BTPSAPI GATT_Register_Service(unsigned int BluetoothStackID, Byte_t ServiceFlags, unsigned int NumberOfServiceAttributeEntries, GATT_Service_Attribute_Entry_t *ServiceTable, GATT_Attribute_Handle_Group_t *ServiceHandleGroupResult, GATT_Server_Event_Callback_t ServerEventCallback, unsigned long CallbackParameter)
+{
+   int          ret_val = STAND_IN_ERROR_INSUFFICIENT_RESOURCES;
+   Word_t       StartingHandle;
+   unsigned int Index;
+   unsigned int Entry;
+
+   if((NumberOfServiceAttributeEntries) && (ServiceTable) && (ServerEventCallback))
+   {
+      /* A requested range (non-zero on input) must hold the service and */
+      /* must not overlap a registered one, the stack does not move the */
+      /* service elsewhere.                                              */
+      StartingHandle = NextGATTHandle;
+      Index          = 0;
+
+      if((ServiceHandleGroupResult) && (ServiceHandleGroupResult->Starting_Handle))
+      {
+         StartingHandle = ServiceHandleGroupResult->Starting_Handle;
+
+         if((ServiceHandleGroupResult->Ending_Handle < StartingHandle) || ((unsigned int)(ServiceHandleGroupResult->Ending_Handle - StartingHandle + 1) < NumberOfServiceAttributeEntries))
+            Index = MAXIMUM_GATT_SERVICES;
+
+         for(Entry=0;(Entry<MAXIMUM_GATT_SERVICES) && (Index<MAXIMUM_GATT_SERVICES);Entry++)
+         {
+            if((GATTServices[Entry].InUse) && (StartingHandle < (GATTServices[Entry].StartingHandle + GATTServices[Entry].NumberOfAttributes)) && ((StartingHandle + NumberOfServiceAttributeEntries) > GATTServices[Entry].StartingHandle))
+               Index = MAXIMUM_GATT_SERVICES;
+         }
+      }
+
+      for(;(Index<MAXIMUM_GATT_SERVICES) && (ret_val < 0);Index++)
+      {
+         if(!GATTServices[Index].InUse)
+         {
+            GATTServices[Index].InUse              = TRUE;
+            GATTServices[Index].ServiceID          = ++NextGATTServiceID;
+            GATTServices[Index].StartingHandle     = StartingHandle;
+            GATTServices[Index].NumberOfAttributes = NumberOfServiceAttributeEntries;
+
+            /* Attributes beyond the table are not checked.             */
+            BTPS_MemInitialize(GATTServices[Index].AttributeFlags, GATT_ATTRIBUTE_FLAGS_READABLE_WRITABLE, sizeof(GATTServices[Index].AttributeFlags));
+            BTPS_MemInitialize(GATTServices[Index].AttributeType, aetCharacteristicValue128, sizeof(GATTServices[Index].AttributeType));
+
+            for(Entry=0;(Entry<NumberOfServiceAttributeEntries) && (Entry<MAXIMUM_SERVICE_ATTRIBUTES);Entry++)
+            {
+               GATTServices[Index].AttributeType[Entry]  = (Byte_t)ServiceTable[Entry].Attribute_Entry_Type;
+               GATTServices[Index].AttributeFlags[Entry] = ServiceTable[Entry].Attribute_Flags;
+            }
+            GATTServices[Index].Callback           = ServerEventCallback;
+            GATTServices[Index].CallbackParameter  = CallbackParameter;
+
+            if(ServiceHandleGroupResult)
+            {
+               ServiceHandleGroupResult->Starting_Handle = StartingHandle;
+               ServiceHandleGroupResult->Ending_Handle   = (Word_t)(StartingHandle + NumberOfServiceAttributeEntries - 1);
+            }
+
+            if((StartingHandle + NumberOfServiceAttributeEntries) > NextGATTHandle)
+               NextGATTHandle = (Word_t)(StartingHandle + NumberOfServiceAttributeEntries);
+
+            ret_val        = (int)GATTServices[Index].ServiceID;
+
+            if(ServiceCallback)
+               (*ServiceCallback)(GATTServices[Index].ServiceID, StartingHandle, NumberOfServiceAttributeEntries, ServiceTable, ServiceCallbackParameter);
+         }
+      }
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* The responses are passed to the response callback as the ATT PDU  */
+   /* the stack would send (truncated to the MTU).                      */
+int BTPSAPI GATT_Read_Response(unsigned int BluetoothStackID, unsigned int TransactionID, unsigned int DataLength, Byte_t *Data)
+{
+   int           ret_val;
+   Byte_t        PDU[MAXIMUM_ATT_MTU];
+   Connection_t *Connection;
+
+   if((TransactionID) && ((!DataLength) || (Data)))
+   {
+      if((Connection = FindConnectionByTransactionID(TransactionID)) != NULL)
+      {
+         if(DataLength > (unsigned int)(Connection->MTU - 1))
+            DataLength = (unsigned int)(Connection->MTU - 1);
+
+         if(DataLength > (sizeof(PDU) - 1))
+            DataLength = sizeof(PDU) - 1;
+
+         PDU[0] = (Byte_t)((Connection->RequestOpCode == ATT_OPCODE_READ_BLOB_REQUEST)?ATT_OPCODE_READ_BLOB_RESPONSE:ATT_OPCODE_READ_RESPONSE);
+
+         if(DataLength)
+            BTPS_MemCopy(&PDU[1], Data, DataLength);
+
+         Connection->TransactionID = 0;
+
+         SendATTResponse(Connection, DataLength + 1, PDU);
+      }
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* A prepared write is answered with the Prepare Write Response, which */
+   /* echoes the handle, the offset and the part.                       */
+int BTPSAPI GATT_Write_Response(unsigned int BluetoothStackID, unsigned int TransactionID)
+{
+   int           ret_val;
+   Byte_t        PDU[MAXIMUM_ATT_MTU];
+   unsigned int  Length;
+   Connection_t *Connection;
+
+   if(TransactionID)
+   {
+      if((Connection = FindConnectionByTransactionID(TransactionID)) != NULL)
+      {
+         if(Connection->RequestOpCode == ATT_OPCODE_PREPARE_WRITE_REQUEST)
+         {
+            Length = Connection->PrepareLength;
+
+            if(Length > (unsigned int)(Connection->MTU - 5))
+               Length = (unsigned int)(Connection->MTU - 5);
+
+            PDU[0] = ATT_OPCODE_PREPARE_WRITE_RESPONSE;
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&PDU[1], Connection->RequestHandle);
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&PDU[3], Connection->PrepareOffset);
+            BTPS_MemCopy(&PDU[5], Connection->PrepareValue, Length);
+
+            Length += 5;
+         }
+         else
+         {
+            PDU[0] = ATT_OPCODE_WRITE_RESPONSE;
+            Length = 1;
+         }
+
+         Connection->TransactionID = 0;
+
+         SendATTResponse(Connection, Length, PDU);
+      }
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI GATT_Execute_Write_Response(unsigned int BluetoothStackID, unsigned int TransactionID)
+{
+   int           ret_val;
+   Byte_t        PDU;
+   Connection_t *Connection;
+
+   if(TransactionID)
+   {
+      if((Connection = FindConnectionByTransactionID(TransactionID)) != NULL)
+      {
+         PDU                       = ATT_OPCODE_EXECUTE_WRITE_RESPONSE;
+         Connection->TransactionID = 0;
+
+         SendATTResponse(Connection, 1, &PDU);
+      }
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI GATT_Error_Response(unsigned int BluetoothStackID, unsigned int TransactionID, Word_t AttributeOffset, Byte_t ErrorCode)
+{
+   int           ret_val;
+   Connection_t *Connection;
+
+   if(TransactionID)
+   {
+      if((Connection = FindConnectionByTransactionID(TransactionID)) != NULL)
+      {
+         Connection->TransactionID = 0;
+
+         SendATTError(Connection, Connection->RequestOpCode, Connection->RequestHandle, ErrorCode);
+      }
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* An indication is sent as the ATT PDU (truncated to the MTU), only  */
+   /* one may be outstanding per link.  The confirmation of the client  */
+   /* is passed to the service as a confirmation response event.        */
+int BTPSAPI GATT_Handle_Value_Indication(unsigned int BluetoothStackID, unsigned int ServiceID, unsigned int ConnectionID, Word_t AttributeOffset, Word_t AttributeValueLength, Byte_t *AttributeValue)
+{
+   int            ret_val;
+   Byte_t         PDU[MAXIMUM_ATT_MTU];
+   unsigned int   Index;
+   unsigned int   DataLength;
+   Connection_t  *Connection;
+   GATTService_t *Service;
+
+   for(Index=0,Service=NULL;(Index<MAXIMUM_GATT_SERVICES) && (!Service);Index++)
+   {
+      if((GATTServices[Index].InUse) && (GATTServices[Index].ServiceID == ServiceID))
+         Service = &GATTServices[Index];
+   }
+
+   if((Service) && (AttributeOffset < Service->NumberOfAttributes) && ((!AttributeValueLength) || (AttributeValue)))
+   {
+      if(((Connection = FindConnectionByHandle((Word_t)ConnectionID)) != NULL) && (Connection->LinkType == LINK_TYPE_LE))
+      {
+         if(!Connection->ServerIndicationTransactionID)
+         {
+            DataLength = AttributeValueLength;
+
+            if(DataLength > (unsigned int)(Connection->MTU - 3))
+               DataLength = (unsigned int)(Connection->MTU - 3);
+
+            if(DataLength > (sizeof(PDU) - 3))
+               DataLength = sizeof(PDU) - 3;
+
+            PDU[0] = ATT_OPCODE_HANDLE_VALUE_INDICATION;
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&PDU[1], (Word_t)(Service->StartingHandle + AttributeOffset));
+
+            if(DataLength)
+               BTPS_MemCopy(&PDU[3], AttributeValue, DataLength);
+
+            Connection->ServerIndicationTransactionID = ++NextTransactionID;
+            Connection->ServerIndicationServiceID     = ServiceID;
+
+            SendATTResponse(Connection, DataLength + 3, PDU);
+
+            ret_val = (int)Connection->ServerIndicationTransactionID;
+         }
+         else
+         {
+            /* The stack reports the buffer empty once the outstanding  */
+            /* indication is confirmed.                                 */
+            Connection->ServerIndicationRefused = TRUE;
+
+            ret_val = STAND_IN_ERROR_INSUFFICIENT_RESOURCES;
+         }
+      }
+      else
+         ret_val = STAND_IN_ERROR_NOT_CONNECTED;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI GATT_Handle_Value_Notification(unsigned int BluetoothStackID, unsigned int ServiceID, unsigned int ConnectionID, Word_t AttributeOffset, Word_t AttributeValueLength, Byte_t *AttributeValue)
+{
+   int            ret_val;
+   Byte_t         PDU[MAXIMUM_ATT_MTU];
+   unsigned int   Index;
+   unsigned int   DataLength;
+   Connection_t  *Connection;
+   GATTService_t *Service;
+
+   for(Index=0,Service=NULL;(Index<MAXIMUM_GATT_SERVICES) && (!Service);Index++)
+   {
+      if((GATTServices[Index].InUse) && (GATTServices[Index].ServiceID == ServiceID))
+         Service = &GATTServices[Index];
+   }
+
+   if((Service) && (AttributeOffset < Service->NumberOfAttributes) && ((!AttributeValueLength) || (AttributeValue)))
+   {
+      if(((Connection = FindConnectionByHandle((Word_t)ConnectionID)) != NULL) && (Connection->LinkType == LINK_TYPE_LE))
+      {
+         /* Notifications are not confirmed, the value is truncated to  */
+         /* the MTU as for indications.                                 */
+         DataLength = AttributeValueLength;
+
+         if(DataLength > (unsigned int)(Connection->MTU - 3))
+            DataLength = (unsigned int)(Connection->MTU - 3);
+
+         if(DataLength > (sizeof(PDU) - 3))
+            DataLength = sizeof(PDU) - 3;
+
+         PDU[0] = ATT_OPCODE_HANDLE_VALUE_NOTIFICATION;
+         ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&PDU[1], (Word_t)(Service->StartingHandle + AttributeOffset));
+
+         if(DataLength)
+            BTPS_MemCopy(&PDU[3], AttributeValue, DataLength);
+
+         SendATTResponse(Connection, DataLength + 3, PDU);
+
+         ret_val = (int)DataLength;
+      }
+      else
+         ret_val = STAND_IN_ERROR_NOT_CONNECTED;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI GATT_Query_Connection_MTU(unsigned int BluetoothStackID, unsigned int ConnectionID, Word_t *MTU)
+{
+   int           ret_val;
+   Connection_t *Connection;
+
+   if(((Connection = FindConnectionByHandle((Word_t)ConnectionID)) != NULL) && (Connection->LinkType == LINK_TYPE_LE) && (MTU))
+   {
+      *MTU    = Connection->MTU;
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_NOT_CONNECTED;
+
+   return(ret_val);
+}
+
+/* The following function starts the discovery of the primary services  */
+/* (all or the ones of the UUID list) with their characteristics and    */
+/* descriptors.  Each service is reported when it is complete, the      */
+/* discovery ends with a complete event.                                */
+int BTPSAPI GATT_Start_Service_Discovery(unsigned int BluetoothStackID, unsigned int ConnectionID, unsigned int NumberOfUUID, GATT_UUID_t *UUIDList, GATT_Service_Discovery_Event_Callback_t ServiceDiscoveryCallback, unsigned long CallbackParameter)
+{
+   int           ret_val;
+   Connection_t *Connection;
+
+   if((ServiceDiscoveryCallback) && (NumberOfUUID <= MAXIMUM_DISCOVERY_UUIDS) && ((!NumberOfUUID) || (UUIDList)))
+   {
+      if(((Connection = FindConnectionByHandle((Word_t)ConnectionID)) != NULL) && (Connection->LinkType == LINK_TYPE_LE))
+      {
+         /* One request at a time on the bearer (the stack would queue, */
+         /* the application does not need that).                        */
+         if((!Connection->Discovery) && (!Connection->ClientOpCode) && ((Connection->Discovery = (Discovery_t *)BTPS_AllocateMemory(sizeof(Discovery_t))) != NULL))
+         {
+            BTPS_MemInitialize(Connection->Discovery, 0, sizeof(Discovery_t));
+
+            Connection->Discovery->Callback          = ServiceDiscoveryCallback;
+            Connection->Discovery->CallbackParameter = CallbackParameter;
+            Connection->Discovery->NumberOfUUID      = NumberOfUUID;
+            Connection->Discovery->Phase             = dpServices;
+            Connection->Discovery->NextHandle        = 0x0001;
+
+            if(NumberOfUUID)
+               BTPS_MemCopy(Connection->Discovery->UUIDList, UUIDList, NumberOfUUID * sizeof(GATT_UUID_t));
+
+            ContinueDiscovery(Connection);
+
+            ret_val = 0;
+         }
+         else
+            ret_val = STAND_IN_ERROR_INSUFFICIENT_RESOURCES;
+      }
+      else
+         ret_val = STAND_IN_ERROR_NOT_CONNECTED;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+/* The following function stops the discovery on the specified link (the*/
+/* answer to its outstanding request is dropped, no complete event is   */
+/* sent).                                                               */
+int BTPSAPI GATT_Stop_Service_Discovery(unsigned int BluetoothStackID, unsigned int ConnectionID)
+{
+   int           ret_val;
+   Connection_t *Connection;
+
+   if(((Connection = FindConnectionByHandle((Word_t)ConnectionID)) != NULL) && (Connection->Discovery))
+   {
+      BTPS_FreeMemory(Connection->Discovery);
+
+      Connection->Discovery = NULL;
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+/* The following function reads the values of the attributes of the     */
+/* specified type in the specified handle range (Read By Type Request). */
+/* This function returns the transaction ID (positive) or a negative    */
+/* error code.                                                          */
+int BTPSAPI GATT_Read_Using_Characteristic_UUID(unsigned int BluetoothStackID, unsigned int ConnectionID, GATT_UUID_t *AttributeUUID, Word_t StartingHandle, Word_t EndingHandle, GATT_Client_Event_Callback_t ClientEventCallback, unsigned long CallbackParameter)
+{
+   int           ret_val;
+   Byte_t        PDU[5 + sizeof(UUID_128_t)];
+   unsigned int  UUIDLength;
+   Connection_t *Connection;
+
+   if((AttributeUUID) && (ClientEventCallback) && (StartingHandle) && (StartingHandle <= EndingHandle))
+   {
+      if(((Connection = FindConnectionByHandle((Word_t)ConnectionID)) != NULL) && (Connection->LinkType == LINK_TYPE_LE))
+      {
+         if((!Connection->Discovery) && (!Connection->ClientOpCode))
+         {
+            UUIDLength = (AttributeUUID->UUID_Type == guUUID_16)?sizeof(UUID_16_t):sizeof(UUID_128_t);
+
+            PDU[0] = ATT_OPCODE_READ_BY_TYPE_REQUEST;
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&PDU[1], StartingHandle);
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&PDU[3], EndingHandle);
+            BTPS_MemCopy(&PDU[5], &(AttributeUUID->UUID), UUIDLength);
+
+            Connection->ClientTransactionID     = ++NextTransactionID;
+            Connection->ClientCallback          = ClientEventCallback;
+            Connection->ClientCallbackParameter = CallbackParameter;
+
+            ret_val = (int)Connection->ClientTransactionID;
+
+            SendClientRequest(Connection, 5 + UUIDLength, PDU);
+         }
+         else
+            ret_val = STAND_IN_ERROR_INSUFFICIENT_RESOURCES;
+      }
+      else
+         ret_val = STAND_IN_ERROR_NOT_CONNECTED;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+/* The following function writes the value of the specified attribute   */
+/* (Write Request).  This function returns the transaction ID (positive)*/
+/* or a negative error code.                                            */
+int BTPSAPI GATT_Write_Request(unsigned int BluetoothStackID, unsigned int ConnectionID, Word_t AttributeHandle, Word_t AttributeLength, void *AttributeValue, GATT_Client_Event_Callback_t ClientEventCallback, unsigned long CallbackParameter)
+{
+   int           ret_val;
+   Byte_t        PDU[MAXIMUM_ATT_MTU];
+   Connection_t *Connection;
+
+   if((AttributeHandle) && (ClientEventCallback) && ((!AttributeLength) || (AttributeValue)))
+   {
+      if(((Connection = FindConnectionByHandle((Word_t)ConnectionID)) != NULL) && (Connection->LinkType == LINK_TYPE_LE))
+      {
+         if((AttributeLength + 3) > Connection->MTU)
+            ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+         else
+         {
+            if((!Connection->Discovery) && (!Connection->ClientOpCode))
+            {
+               PDU[0] = ATT_OPCODE_WRITE_REQUEST;
+               ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&PDU[1], AttributeHandle);
+
+               if(AttributeLength)
+                  BTPS_MemCopy(&PDU[3], AttributeValue, AttributeLength);
+
+               Connection->ClientTransactionID     = ++NextTransactionID;
+               Connection->ClientCallback          = ClientEventCallback;
+               Connection->ClientCallbackParameter = CallbackParameter;
+
+               ret_val = (int)Connection->ClientTransactionID;
+
+               SendClientRequest(Connection, 3 + AttributeLength, PDU);
+            }
+            else
+               ret_val = STAND_IN_ERROR_INSUFFICIENT_RESOURCES;
+         }
+      }
+      else
+         ret_val = STAND_IN_ERROR_NOT_CONNECTED;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+/* The following function confirms the indication of the remote server  */
+/* with the specified transaction ID.                                   */
+int BTPSAPI GATT_Handle_Value_Confirmation(unsigned int BluetoothStackID, unsigned int ConnectionID, unsigned int TransactionID)
+{
+   int           ret_val;
+   Byte_t        PDU[1];
+   Connection_t *Connection;
+
+   if(((Connection = FindConnectionByHandle((Word_t)ConnectionID)) != NULL) && (TransactionID) && (Connection->IndicationTransactionID == TransactionID))
+   {
+      Connection->IndicationTransactionID = 0;
+
+      PDU[0] = ATT_OPCODE_HANDLE_VALUE_CONFIRMATION;
+
+      SendATTResponse(Connection, sizeof(PDU), PDU);
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* Hands-Free (HFRE) API.  The AT commands are generated by the stack */
+   /* (and recorded in the trace), so only the port state and the HCI   */
+   /* commands for the audio connection are modeled.                    */
+int BTPSAPI HFRE_Open_HandsFree_Server_Port(unsigned int BluetoothStackID, unsigned int ServerPort, unsigned long SupportedFeatures, unsigned int NumberAdditionalIndicators, HFRE_Control_Indicator_Entry_t *AdditionalSupportedIndicators, HFRE_Event_Callback_t EventCallback, unsigned long CallbackParameter)
+{
+   int         ret_val;
+   HFREPort_t *Port;
+
+   if((ServerPort) && (EventCallback))
+   {
+      if((Port = AddPort()) != NULL)
+      {
+         Port->ServerPort        = TRUE;
+         Port->ServerChannel     = ServerPort;
+         Port->Callback          = EventCallback;
+         Port->CallbackParameter = CallbackParameter;
+
+         ret_val                 = (int)Port->PortID;
+      }
+      else
+         ret_val = STAND_IN_ERROR_INSUFFICIENT_RESOURCES;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI HFRE_Open_Remote_Audio_Gateway_Port(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR, unsigned int RemoteServerPort, unsigned long SupportedFeatures, unsigned int NumberAdditionalIndicators, HFRE_Control_Indicator_Entry_t *AdditionalSupportedIndicators, HFRE_Event_Callback_t EventCallback, unsigned long CallbackParameter)
+{
+   int         ret_val;
+   Byte_t      Parameters[13];
+   HFREPort_t *Port;
+
+   if((RemoteServerPort) && (EventCallback))
+   {
+      if((Port = AddPort()) != NULL)
+      {
+         Port->ServerChannel     = RemoteServerPort;
+         Port->BD_ADDR           = BD_ADDR;
+         Port->Callback          = EventCallback;
+         Port->CallbackParameter = CallbackParameter;
+         Port->Connecting        = TRUE;
+
+         /* The stack pages the device if there is no link yet.         */
+         if(!FindConnectionByBD_ADDR(BD_ADDR, LINK_TYPE_ACL))
+         {
+            WriteBD_ADDR(Parameters, BD_ADDR);
+            ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[6], (HCI_PACKET_ACL_TYPE_DM1 | HCI_PACKET_ACL_TYPE_DH1 | HCI_PACKET_ACL_TYPE_DM3 | HCI_PACKET_ACL_TYPE_DH3 | HCI_PACKET_ACL_TYPE_DM5 | HCI_PACKET_ACL_TYPE_DH5));
+            Parameters[8]  = 0x01;
+            Parameters[9]  = 0x00;
+            Parameters[10] = 0x00;
+            Parameters[11] = 0x00;
+            Parameters[12] = HCI_ROLE_SWITCH_LOCAL_MASTER_ACCEPT_ROLE_SWITCH;
+
+            SendCommand(HCI_OPCODE_CREATE_CONNECTION, sizeof(Parameters), Parameters);
+         }
+
+         ret_val = (int)Port->PortID;
+      }
+      else
+         ret_val = STAND_IN_ERROR_INSUFFICIENT_RESOURCES;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI HFRE_Close_Server_Port(unsigned int BluetoothStackID, unsigned int HFREPortID)
+{
+   int         ret_val;
+   HFREPort_t *Port;
+
+   if(((Port = FindPortByID(HFREPortID)) != NULL) && (Port->ServerPort))
+   {
+      Port->InUse = FALSE;
+
+      ret_val     = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI HFRE_Close_Port(unsigned int BluetoothStackID, unsigned int HFREPortID)
+{
+   int         ret_val;
+   HFREPort_t *Port;
+
+   if((Port = FindPortByID(HFREPortID)) != NULL)
+   {
+      /* A server port goes back to listening.                          */
+      Port->Connected              = FALSE;
+      Port->Connecting             = FALSE;
+      Port->ServiceLevelConnection = FALSE;
+
+      if(!Port->ServerPort)
+         Port->InUse = FALSE;
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI HFRE_Register_HandsFree_SDP_Record(unsigned int BluetoothStackID, unsigned int HFREPortID, char *ServiceName, DWord_t *SDPServiceRecordHandle)
+{
+   int ret_val;
+
+   if((FindPortByID(HFREPortID)) && (SDPServiceRecordHandle))
+   {
+      *SDPServiceRecordHandle = 0x00010000 + HFREPortID;
+
+      ret_val                 = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+int BTPSAPI HFRE_Setup_Audio_Connection(unsigned int BluetoothStackID, unsigned int HFREPortID)
+{
+   int           ret_val;
+   Byte_t        Parameters[17];
+   HFREPort_t   *Port;
+   Connection_t *Connection;
+
+   if(((Port = FindPortByID(HFREPortID)) != NULL) && (Port->ServiceLevelConnection) && ((Connection = FindConnectionByHandle(Port->Handle)) != NULL))
+   {
+      /* 8 kHz CVSD with the parameters set through the SCO API.        */
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[0], Connection->Handle);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[2], 0x1F40);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[4], 0x0000);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[6], 0x1F40);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[8], 0x0000);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[10], SCOMaxLatency);
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[12], 0x0060);
+      Parameters[14] = SCORetransmissionEffort;
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(&Parameters[15], SCOPacketType);
+
+      SendCommand(HCI_OPCODE_SETUP_SYNCHRONOUS_CONNECTION, sizeof(Parameters), Parameters);
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_NOT_CONNECTED;
+
+   return(ret_val);
+}
+
+int BTPSAPI HFRE_Release_Audio_Connection(unsigned int BluetoothStackID, unsigned int HFREPortID)
+{
+   int         ret_val;
+   Byte_t      Parameters[3];
+   HFREPort_t *Port;
+
+   if(((Port = FindPortByID(HFREPortID)) != NULL) && (Port->SCOHandle))
+   {
+      ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(Parameters, Port->SCOHandle);
+      Parameters[2] = 0x13;
+
+      SendCommand(HCI_OPCODE_DISCONNECT, sizeof(Parameters), Parameters);
+
+      ret_val = 0;
+   }
+   else
+      ret_val = STAND_IN_ERROR_NOT_CONNECTED;
+
+   return(ret_val);
+}
+
+int BTPSAPI HFRE_Answer_Incoming_Call(unsigned int BluetoothStackID, unsigned int HFREPortID)
+{
+   HFREPort_t *Port;
+
+   return((((Port = FindPortByID(HFREPortID)) != NULL) && (Port->ServiceLevelConnection))?0:STAND_IN_ERROR_NOT_CONNECTED);
+}
+
+int BTPSAPI HFRE_Hang_Up_Call(unsigned int BluetoothStackID, unsigned int HFREPortID)
+{
+   HFREPort_t *Port;
+
+   return((((Port = FindPortByID(HFREPortID)) != NULL) && (Port->ServiceLevelConnection))?0:STAND_IN_ERROR_NOT_CONNECTED);
+}
+
+int BTPSAPI HFRE_Enable_Remote_Call_Line_Identification_Notification(unsigned int BluetoothStackID, unsigned int HFREPortID, Boolean_t EnableNotification)
+{
+   return(FindPortByID(HFREPortID)?0:STAND_IN_ERROR_INVALID_PARAMETER);
+}
+
+int BTPSAPI HFRE_Send_Available_Codecs(unsigned int BluetoothStackID, unsigned int HFREPortID, unsigned int NumberSupportedCodecs, unsigned char *AvailableCodecList)
+{
+   return(((FindPortByID(HFREPortID)) && (NumberSupportedCodecs) && (AvailableCodecList))?0:STAND_IN_ERROR_INVALID_PARAMETER);
+}
+
+int BTPSAPI HFRE_Send_Select_Codec(unsigned int BluetoothStackID, unsigned int HFREPortID, unsigned char CodecID)
+{
+   return(FindPortByID(HFREPortID)?0:STAND_IN_ERROR_INVALID_PARAMETER);
+}
+
+   /* Vendor Specific (VS) API.  The CC256x vendor commands are part of  */
+   /* the controller configuration and are not compared.                */
+int BTPSAPI VS_EnableWBS(unsigned int BluetoothStackID, Word_t ConnectionHandle)
+{
+   return(0);
+}
+
+int BTPSAPI VS_DisableWBS(unsigned int BluetoothStackID)
+{
+   return(0);
+}
+
+   /* Kernel (BTPS) API.                                                */
+int BTPSAPI BTPS_Init(void *UserParam)
+{
+   return(0);
+}
+
+int BTPSAPI BTPS_OutputMessage(const char *Format, ...)
+{
+   int     ret_val = 0;
+   va_list Arguments;
+
+   if(Verbose)
+   {
+      va_start(Arguments, Format);
+      ret_val = vprintf(Format, Arguments);
+      va_end(Arguments);
+   }
+
+   return(ret_val);
+}
+
+int BTPSAPI BTPS_SprintF(char *Buffer, const char *Format, ...)
+{
+   int     ret_val;
+   va_list Arguments;
+
+   va_start(Arguments, Format);
+   ret_val = vsprintf(Buffer, Format, Arguments);
+   va_end(Arguments);
+
+   return(ret_val);
+}
+
+unsigned int BTPSAPI BTPS_StringLength(const char *Source)
+{
+   return(Source?(unsigned int)strlen(Source):0);
+}
+
+unsigned long BTPSAPI BTPS_GetTickCount(void)
+{
+   return(CurrentTime);
+}
+
+void *BTPSAPI BTPS_AllocateMemory(unsigned long MemorySize)
+{
+   return(malloc(MemorySize));
+}
+
+void BTPSAPI BTPS_FreeMemory(void *MemoryPointer)
+{
+   free(MemoryPointer);
+}
+
+void BTPSAPI BTPS_MemInitialize(void *Destination, int Value, unsigned long Size)
+{
+   memset(Destination, Value, Size);
+}
+
+void BTPSAPI BTPS_MemCopy(void *Destination, const void *Source, unsigned long Size)
+{
+   memmove(Destination, Source, Size);
+}
+
+int BTPSAPI BTPS_MemCompare(const void *Source1, const void *Source2, unsigned long Size)
+{
+   return(memcmp(Source1, Source2, Size));
+}
+
+   /* Delays advance the replay time, nothing waits.                     */
+void BTPSAPI BTPS_Delay(unsigned long MilliSeconds)
+{
+   CurrentTime += MilliSeconds;
+}
+
+   /* Hardware Abstraction Layer (HAL) API.                             */
+void HAL_ConfigureHardware(int EnablePLL)
+{
+}
+
+unsigned long HAL_GetTickCount(void)
+{
+   return(CurrentTime);
+}
+
+void HAL_LedToggle(int LED_ID)
+{
+}
+
+   /* Console receive (NoOS/ConsoleTRDMA.c).  The host has no console   */
+   /* UART, no line is ever received.                                   */
+int ConsoleTR_Open(void (*Line)(char *Line, unsigned int Length, unsigned long CallbackParameter), unsigned long CallbackParameter)
+{
+   return(0);
+}
+
+void ConsoleTR_Process(void)
+{
+}
+
+   /* Flash driver.  The flash pages of the Peer Cache, the GATT client */
+   /* cache and the GATT database are a RAM array, a page is erased at  */
+   /* a time.                                                           */
+int32_t StandIn_FlashErase(uintptr_t Address)
+{
+   int32_t ret_val;
+
+   if((Address >= (uintptr_t)StandIn_Flash) && (Address < ((uintptr_t)StandIn_Flash + sizeof(StandIn_Flash))) && (!((Address - (uintptr_t)StandIn_Flash) % STAND_IN_FLASH_PAGE_SIZE)))
+   {
+      BTPS_MemInitialize((void *)Address, 0xFF, STAND_IN_FLASH_PAGE_SIZE);
+
+      ret_val = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+int32_t StandIn_FlashProgram(uint32_t *Data, uintptr_t Address, uint32_t Count)
+{
+   int32_t ret_val;
+
+   if((Data) && (Address >= (uintptr_t)StandIn_Flash) && ((Address + Count) <= ((uintptr_t)StandIn_Flash + sizeof(StandIn_Flash))))
+   {
+      BTPS_MemCopy((void *)Address, Data, Count);
+
+      ret_val = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
@@ -0,0 +1,139 @@
+/*****< standin.h >************************************************************/
+/*                                                                            */
+/*  StandIn - Host stand-in for the Bluetopia stack (Linux replay build).     */
+/*                                                                            */
+/*  Implements the Bluetopia API that the application uses on top of a       */
+/*  recorded HCI trace.  Received packets of the trace are decoded into the   */
+/*  HCI, GAP, GATT and HFRE events the stack would deliver and are passed to  */
+/*  the callbacks the application registered (the time spent in each         */
+/*  callback is measured).  API calls that make the stack issue an HCI        */
+/*  command are turned back into that command and reported to the replay     */
+/*  engine, so the commands of the application can be compared against the   */
+/*  commands that were recorded.                                              */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __STANDINH__
+#define __STANDINH__
+
+#include "SS1BTPS.h"          /* Bluetopia API Stand-in Types/Prototypes.     */
+
+#define STAND_IN_BLUETOOTH_STACK_ID                  (1)  /* Denotes the ID  */
+                                                         /* that is returned */
+                                                         /* by              */
+                                                         /* BSC_Initialize().*/
+
+#define STAND_IN_DEFAULT_GATT_STARTING_HANDLE   (0x0001)  /* Denotes the      */
+                                                         /* handle the first */
+                                                         /* registered GATT  */
+                                                         /* service starts   */
+                                                         /* at.              */
+
+#define STAND_IN_MAXIMUM_EVENT_TYPES                (64)  /* Denotes the      */
+                                                         /* maximum number of*/
+                                                         /* event types that */
+                                                         /* are measured.    */
+
+   /* The following constants are returned by the stand-in API for       */
+   /* calls that are not valid in the current state.                    */
+#define STAND_IN_ERROR_INVALID_PARAMETER              (-1)
+#define STAND_IN_ERROR_NOT_CONNECTED                  (-2)
+#define STAND_IN_ERROR_INSUFFICIENT_RESOURCES         (-3)
+
+   /* The following type definition represents the function that is     */
+   /* called with every HCI command the stack would issue on behalf of  */
+   /* the application.                                                  */
+typedef void (*StandIn_Command_Callback_t)(Word_t OpCode, unsigned int ParameterLength, Byte_t *Parameters, unsigned long CallbackParameter);
+
+   /* The following type definition represents the function that is     */
+   /* called with every ATT response the stack sends on an LE link (from*/
+   /* the application or answered by the stack itself).  PDU starts with*/
+   /* the ATT opcode.                                                   */
+typedef void (*StandIn_Response_Callback_t)(Word_t ConnectionHandle, unsigned int Length, Byte_t *PDU, unsigned long CallbackParameter);
+
+   /* The following type definition represents the function that is     */
+   /* called with every LE signalling command the stack sends on an LE  */
+   /* link (connection parameter update requests).  Command starts with */
+   /* the signalling code.                                              */
+typedef void (*StandIn_Signalling_Callback_t)(Word_t ConnectionHandle, unsigned int Length, Byte_t *Command, unsigned long CallbackParameter);
+
+   /* The following type definition represents the function that is     */
+   /* called after every application callback with the event type and   */
+   /* the time (in nanoseconds) spent in the callback.                  */
+typedef void (*StandIn_Dispatch_Callback_t)(const char *Name, unsigned long long Time, unsigned long CallbackParameter);
+
+   /* The following type definition represents the function that is     */
+   /* called with every GATT service the application registers (the    */
+   /* service table and the handle of its first attribute).  The table  */
+   /* is only valid during the call.                                    */
+typedef void (*StandIn_Service_Callback_t)(unsigned int ServiceID, Word_t StartingHandle, unsigned int NumberOfAttributes, GATT_Service_Attribute_Entry_t *ServiceTable, unsigned long CallbackParameter);
+
+   /* The following structure holds the handler statistics of one event  */
+   /* type.  The times are in nanoseconds (time spent in the callbacks  */
+   /* of the application).                                              */
+typedef struct _tagStandIn_Event_Statistics_t
+{
+   const char         *Name;
+   unsigned long       Count;
+   unsigned long long  TotalTime;
+   unsigned long long  MaximumTime;
+} StandIn_Event_Statistics_t;
+
+   /* The following function resets the stand-in and installs the        */
+   /* function that receives the issued HCI commands.                   */
+void StandIn_Initialize(StandIn_Command_Callback_t CommandCallback, unsigned long CallbackParameter);
+
+   /* The following function installs the function that receives the ATT*/
+   /* responses (NULL removes it).  StandIn_Initialize() removes the    */
+   /* function.                                                         */
+void StandIn_SetResponseCallback(StandIn_Response_Callback_t ResponseCallback, unsigned long CallbackParameter);
+
+   /* The following function installs the function that receives the LE */
+   /* signalling commands (NULL removes it).  StandIn_Initialize()      */
+   /* removes the function.                                             */
+void StandIn_SetSignallingCallback(StandIn_Signalling_Callback_t SignallingCallback, unsigned long CallbackParameter);
+
+   /* The following function installs the function that is called after */
+   /* every application callback (NULL removes it).  StandIn_Initialize()*/
+   /* removes the function.                                             */
+void StandIn_SetDispatchCallback(StandIn_Dispatch_Callback_t DispatchCallback, unsigned long CallbackParameter);
+
+   /* The following function installs the function that is called with  */
+   /* every registered GATT service (NULL removes it).                  */
+   /* StandIn_Initialize() removes the function.                        */
+void StandIn_SetServiceCallback(StandIn_Service_Callback_t ServiceCallback, unsigned long CallbackParameter);
+
+   /* The following function sets the handle the next registered GATT    */
+   /* service starts at, so that the ATT handles of the trace resolve to */
+   /* the attributes of the application.  A service that asks for a     */
+   /* handle range of its own is placed there instead.                  */
+void StandIn_SetGATTStartingHandle(Word_t Handle);
+
+   /* The following functions set and return the time (in ms) that is    */
+   /* reported to the application by the tick count functions.  The     */
+   /* replay engine sets the time of each packet, so timeouts in the    */
+   /* application are deterministic.                                    */
+void StandIn_SetTime(unsigned long Time);
+unsigned long StandIn_GetTime(void);
+
+   /* The following function enables or disables the output of the       */
+   /* application through BTPS_OutputMessage().                          */
+void StandIn_SetVerbose(Boolean_t Verbose);
+
+   /* The following function returns TRUE if the specified HCI command is*/
+   /* issued by the stand-in (only these commands can be compared).     */
+Boolean_t StandIn_IsModeledCommand(Word_t OpCode);
+
+   /* The following function processes one packet of the trace.         */
+   /* Direction is one of the BTSNOOP_DIRECTION_... constants, Packet   */
+   /* Type one of the HCI_..._PACKET constants.  Received packets are   */
+   /* dispatched to the application, sent data packets only update the  */
+   /* state of the stand-in (AT commands of the stack).  The packet may */
+   /* be truncated.                                                     */
+void StandIn_ProcessPacket(unsigned int Direction, Byte_t PacketType, unsigned int Length, Byte_t *Packet);
+
+   /* The following function copies the handler statistics of up to     */
+   /* MaximumEntries event types to the specified buffer.  This function*/
+   /* returns the number of event types that were copied.               */
+unsigned int StandIn_QueryEventStatistics(unsigned int MaximumEntries, StandIn_Event_Statistics_t *Statistics);
+
+#endif
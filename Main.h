@@ -38,6 +38,12 @@
    /* negative error code (of the form APPLICATION_ERROR_XXX).          */
 int InitializeApplication(HCI_DriverInformation_t *HCI_DriverInformation, BTPS_Initialization_t *BTPS_Initialization);
 
+   /* The following function is used to close the stack that was opened */
+   /* by InitializeApplication() (the application can be initialized    */
+   /* again afterwards).  This function returns zero if successful or a */
+   /* negative error code if the stack was not open.                    */
+int CloseApplication(void);
+
    /* The following function is used to process a command line string.  */
    /* This function takes as it's only parameter the command line string*/
    /* to be parsed and returns TRUE if a command was parsed and executed*/
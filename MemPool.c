@@ -0,0 +1,308 @@
+/*****< mempool.c >************************************************************/
+/*                                                                            */
+/*  MemPool - Deterministic fixed-block pool allocator for the Bluetopia      */
+/*            kernel memory allocation.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "Main.h"          /* Application Interface Abstraction.              */
+#include "MemPool.h"       /* Pool Allocator Prototypes/Constants.            */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+
+#ifdef MEM_POOL_ENABLE
+
+#if !defined(__linux__)
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "driverlib/interrupt.h"
+
+   /* The following macros mask the interrupts while a free list is     */
+   /* changed.  The previous state is restored, so a caller that masked */
+   /* the interrupts itself keeps them masked.                          */
+#define POOL_LOCK(_x)                             ((_x) = (Boolean_t)IntMasterDisable())
+#define POOL_UNLOCK(_x)                           do { if(!(_x)) IntMasterEnable(); } while(0)
+
+#else
+
+#define POOL_LOCK(_x)                             ((_x) = FALSE)
+#define POOL_UNLOCK(_x)                           ((void)(_x))
+
+#endif
+
+   /* The following structure is placed at the start of every free block */
+   /* to link the free list of its class.                               */
+typedef struct _tagFree_Block_t
+{
+   struct _tagFree_Block_t *NextBlock;
+} Free_Block_t;
+
+   /* The following structure holds the state of one size class.  The    */
+   /* blocks of the class lie between Start and End.                    */
+typedef struct _tagPool_Class_t
+{
+   unsigned char              *Start;
+   unsigned char              *End;
+   Free_Block_t               *FreeList;
+   MemPool_Class_Statistics_t  Statistics;
+} Pool_Class_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static unsigned long long Buffer[(MEM_POOL_BUFFER_SIZE + sizeof(unsigned long long) - 1) / sizeof(unsigned long long)];
+                                                    /* Variable which holds the*/
+                                                    /* blocks of all classes.  */
+
+static const unsigned int ClassSizes[MEM_POOL_NUMBER_CLASSES]  = MEM_POOL_CLASS_SIZES;
+static const unsigned int ClassBlocks[MEM_POOL_NUMBER_CLASSES] = MEM_POOL_CLASS_BLOCKS;
+
+static Pool_Class_t  ClassList[MEM_POOL_NUMBER_CLASSES]; /* Variable which  */
+                                                    /* holds the size classes. */
+
+static unsigned long OversizeFailures;              /* Variables which hold the*/
+static unsigned long InvalidFrees;                  /* counters of the pool.   */
+
+static Boolean_t     Initialized;                   /* Variable which flags    */
+                                                    /* that the classes are    */
+                                                    /* set up.                 */
+
+   /* Internal function prototypes.                                     */
+static void InitializeClasses(void);
+
+   /* The following function carves the blocks of every class out of the */
+   /* buffer and links them into the free lists.  A class gets fewer    */
+   /* blocks if the buffer is too small for the configuration.          */
+static void InitializeClasses(void)
+{
+   unsigned int   Index;
+   unsigned int   Block;
+   unsigned int   BlockSize;
+   unsigned int   NumberBlocks;
+   unsigned char *Next;
+   unsigned char *BufferEnd;
+
+   Next      = (unsigned char *)Buffer;
+   BufferEnd = Next + MEM_POOL_BUFFER_SIZE;
+
+   for(Index=0;Index<MEM_POOL_NUMBER_CLASSES;Index++)
+   {
+      BlockSize    = (ClassSizes[Index] + (MEM_POOL_ALIGNMENT - 1)) & ~(MEM_POOL_ALIGNMENT - 1);
+      NumberBlocks = ClassBlocks[Index];
+
+      if(NumberBlocks > (unsigned int)((BufferEnd - Next) / BlockSize))
+         NumberBlocks = (unsigned int)((BufferEnd - Next) / BlockSize);
+
+      ClassList[Index].Start    = Next;
+      ClassList[Index].End      = Next + (NumberBlocks * BlockSize);
+      ClassList[Index].FreeList = NULL;
+
+      /* Link the blocks from the last to the first, so the first block */
+      /* is allocated first.                                            */
+      for(Block=NumberBlocks;Block>0;Block--)
+      {
+         ((Free_Block_t *)(Next + ((Block - 1) * BlockSize)))->NextBlock = ClassList[Index].FreeList;
+
+         ClassList[Index].FreeList = (Free_Block_t *)(Next + ((Block - 1) * BlockSize));
+      }
+
+      BTPS_MemInitialize(&(ClassList[Index].Statistics), 0, sizeof(MemPool_Class_Statistics_t));
+
+      ClassList[Index].Statistics.BlockSize    = BlockSize;
+      ClassList[Index].Statistics.NumberBlocks = NumberBlocks;
+
+      Next = ClassList[Index].End;
+   }
+
+   Initialized = TRUE;
+}
+
+   /* The following function allocates a block of at least the specified */
+   /* size.  This function returns NULL if no block is available.       */
+void *MemPool_Allocate(unsigned long Size)
+{
+   void         *ret_val;
+   unsigned int  Class;
+   unsigned int  Index;
+   Pool_Class_t *PoolClass;
+   Boolean_t     Masked;
+
+   POOL_LOCK(Masked);
+
+   if(!Initialized)
+      InitializeClasses();
+
+   /* Find the smallest class that fits.                                */
+   for(Class=0;(Class<MEM_POOL_NUMBER_CLASSES) && (ClassList[Class].Statistics.BlockSize < Size);Class++)
+      ;
+
+   if(Class < MEM_POOL_NUMBER_CLASSES)
+   {
+      /* Take a block of the next larger class if the class is          */
+      /* exhausted.                                                     */
+      for(Index=Class;(Index<MEM_POOL_NUMBER_CLASSES) && (!ClassList[Index].FreeList);Index++)
+         ;
+
+      if(Index < MEM_POOL_NUMBER_CLASSES)
+      {
+         PoolClass           = &ClassList[Index];
+         ret_val             = PoolClass->FreeList;
+         PoolClass->FreeList = PoolClass->FreeList->NextBlock;
+
+         PoolClass->Statistics.Allocations++;
+
+         if(++PoolClass->Statistics.InUse > PoolClass->Statistics.HighWatermark)
+            PoolClass->Statistics.HighWatermark = PoolClass->Statistics.InUse;
+
+         if(Index != Class)
+            ClassList[Class].Statistics.Spills++;
+      }
+      else
+      {
+         ClassList[Class].Statistics.Failures++;
+
+         ret_val = NULL;
+      }
+   }
+   else
+   {
+      OversizeFailures++;
+
+      ret_val = NULL;
+   }
+
+   POOL_UNLOCK(Masked);
+
+   return(ret_val);
+}
+
+   /* The following function returns a block to the pool.                */
+void MemPool_Free(void *Block)
+{
+   unsigned int  Index;
+   Pool_Class_t *PoolClass;
+   Boolean_t     Masked;
+
+   if(Block)
+   {
+      POOL_LOCK(Masked);
+
+      for(Index=0;(Index<MEM_POOL_NUMBER_CLASSES) && (((unsigned char *)Block < ClassList[Index].Start) || ((unsigned char *)Block >= ClassList[Index].End));Index++)
+         ;
+
+      if((Index < MEM_POOL_NUMBER_CLASSES) && (!(((unsigned char *)Block - ClassList[Index].Start) % ClassList[Index].Statistics.BlockSize)) && (ClassList[Index].Statistics.InUse))
+      {
+         PoolClass = &ClassList[Index];
+
+         ((Free_Block_t *)Block)->NextBlock = PoolClass->FreeList;
+         PoolClass->FreeList                = (Free_Block_t *)Block;
+
+         PoolClass->Statistics.InUse--;
+      }
+      else
+         InvalidFrees++;
+
+      POOL_UNLOCK(Masked);
+   }
+}
+
+   /* The following function replaces BTPS_AllocateMemory() of the       */
+   /* kernel.                                                           */
+void *BTPSAPI MemPool_BTPS_AllocateMemory(unsigned long MemorySize)
+{
+   void *ret_val;
+
+   ret_val = MemPool_Allocate(MemorySize);
+
+#ifdef MEM_POOL_TRACE
+
+   Display(("MP A %08lX %lu\r\n", (unsigned long)ret_val, MemorySize));
+
+#endif
+
+   return(ret_val);
+}
+
+   /* The following function replaces BTPS_FreeMemory() of the kernel.   */
+void BTPSAPI MemPool_BTPS_FreeMemory(void *MemoryPointer)
+{
+#ifdef MEM_POOL_TRACE
+
+   Display(("MP F %08lX\r\n", (unsigned long)MemoryPointer));
+
+#endif
+
+   MemPool_Free(MemoryPointer);
+}
+
+   /* The following function copies the counters of the pool to the      */
+   /* specified structure.  This function returns zero if successful or */
+   /* a negative value if the parameter is invalid.                     */
+int MemPool_QueryStatistics(MemPool_Statistics_t *Statistics)
+{
+   int          ret_val;
+   unsigned int Index;
+
+   if(Statistics)
+   {
+      if(!Initialized)
+         InitializeClasses();
+
+      Statistics->NumberClasses = MEM_POOL_NUMBER_CLASSES;
+
+      for(Index=0;Index<MEM_POOL_NUMBER_CLASSES;Index++)
+         Statistics->ClassStatistics[Index] = ClassList[Index].Statistics;
+
+      Statistics->OversizeFailures = OversizeFailures;
+      Statistics->InvalidFrees     = InvalidFrees;
+
+      ret_val = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function displays the counters of every size class.  */
+void MemPool_Display(void)
+{
+   unsigned int                Index;
+   MemPool_Class_Statistics_t *Statistics;
+
+   if(!Initialized)
+      InitializeClasses();
+
+   Display(("Memory Pool (%u bytes):\r\n", (unsigned int)MEM_POOL_BUFFER_SIZE));
+   Display(("   %6s %6s %6s %6s %10s %8s %8s\r\n", "Size", "Blocks", "InUse", "Peak", "Allocs", "Spills", "Fails"));
+
+   for(Index=0;Index<MEM_POOL_NUMBER_CLASSES;Index++)
+   {
+      Statistics = &(ClassList[Index].Statistics);
+
+      Display(("   %6u %6u %6u %6u %10lu %8lu %8lu\r\n", Statistics->BlockSize, Statistics->NumberBlocks, Statistics->InUse, Statistics->HighWatermark, Statistics->Allocations, Statistics->Spills, Statistics->Failures));
+   }
+
+   Display(("   Oversize requests: %lu, invalid frees: %lu.\r\n", OversizeFailures, InvalidFrees));
+}
+
+   /* The following function clears the allocation, spill and failure    */
+   /* counters and restarts the high watermarks at the current usage.   */
+void MemPool_ResetStatistics(void)
+{
+   unsigned int Index;
+
+   for(Index=0;Index<MEM_POOL_NUMBER_CLASSES;Index++)
+   {
+      ClassList[Index].Statistics.HighWatermark = ClassList[Index].Statistics.InUse;
+      ClassList[Index].Statistics.Allocations   = 0;
+      ClassList[Index].Statistics.Spills        = 0;
+      ClassList[Index].Statistics.Failures      = 0;
+   }
+
+   OversizeFailures = 0;
+   InvalidFrees     = 0;
+}
+
+#endif
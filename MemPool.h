@@ -0,0 +1,134 @@
+/*****< mempool.h >************************************************************/
+/*                                                                            */
+/*  MemPool - Deterministic fixed-block pool allocator for the Bluetopia      */
+/*            kernel memory allocation.                                       */
+/*                                                                            */
+/*  The pool is split into size classes of fixed-size blocks.  Each class     */
+/*  keeps its free blocks in a singly linked list, so an allocation takes the */
+/*  head of the list of the smallest class that fits (or of the next larger   */
+/*  class if that one is exhausted) and a free returns the block to the list  */
+/*  of the class it lies in.  Both take a time that only depends on the       */
+/*  (fixed) number of classes and the pool cannot fragment.                   */
+/*                                                                            */
+/*  The pool is only compiled in if MEM_POOL_ENABLE is defined.  It replaces  */
+/*  the heap of the kernel by redirecting the references of the stack to      */
+/*  BTPS_AllocateMemory() and BTPS_FreeMemory() to the functions below at     */
+/*  link time:                                                                */
+/*                                                                            */
+/*     TI linker:  --define=MEM_POOL_ENABLE (see linker_ccs.cmd)              */
+/*     GNU ld:     -Wl,--wrap=BTPS_AllocateMemory,--defsym=                   */
+/*                    __wrap_BTPS_AllocateMemory=MemPool_BTPS_AllocateMemory  */
+/*                 (and the same for BTPS_FreeMemory, see CMakeLists.txt)     */
+/*                                                                            */
+/*  The heap of the kernel (MemoryBuffer of BTPSKRNL.c) is no longer used     */
+/*  and should be reduced by the size of the pool.  The interrupts are        */
+/*  masked while a free list is changed, so blocks may also be allocated and  */
+/*  freed from an interrupt handler (the HCI transport of the EWARM and       */
+/*  RVMDK projects is the HCITRANS.c of Bluetopia, whose receive path is not  */
+/*  known).                                                                   */
+/*                                                                            */
+/*  If MEM_POOL_TRACE is defined every allocation and free is written to the  */
+/*  console ("MP A Address Size" / "MP F Address"), a captured console log    */
+/*  can be replayed by Linux/MemPoolBench.c.                                  */
+/*                                                                            */
+/*  The pool is off by default (MEM_POOL option of CMakeLists.txt).  The      */
+/*  default classes below are not sized from a trace of the target, on the    */
+/*  synthetic trace of MemPoolBench they fail 78 allocations the heap of the  */
+/*  same size serves.  Size the classes from the Peak, Spills and Fails of    */
+/*  MemPoolBench for a MEM_POOL_TRACE log of the target before the pool is    */
+/*  enabled.                                                                  */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __MEMPOOLH__
+#define __MEMPOOLH__
+
+#ifndef MEM_POOL_NUMBER_CLASSES
+
+#define MEM_POOL_NUMBER_CLASSES                      (6)  /* Denotes the number*/
+                                                         /* of size classes.  */
+
+#define MEM_POOL_CLASS_SIZES  { 16, 32, 64, 128, 256, 1104 } /* Denotes the    */
+                                                         /* block size of each*/
+                                                         /* class (ascending, */
+                                                         /* the largest holds */
+                                                         /* an ACL packet of  */
+                                                         /* the CC256x).      */
+
+#define MEM_POOL_CLASS_BLOCKS { 24, 24,  16,   8,   4,    2 } /* Denotes the    */
+                                                         /* number of blocks  */
+                                                         /* of each class.    */
+
+#endif
+
+#ifndef MEM_POOL_BUFFER_SIZE
+
+#define MEM_POOL_BUFFER_SIZE                      (6432)  /* Denotes the size  */
+                                                         /* of the pool (in   */
+                                                         /* bytes, the sum of */
+                                                         /* all classes).     */
+
+#endif
+
+#define MEM_POOL_ALIGNMENT                            (8)  /* Denotes the      */
+                                                         /* alignment of the  */
+                                                         /* blocks (block     */
+                                                         /* sizes are rounded */
+                                                         /* up to it).        */
+
+   /* The following structure holds the counters of one size class.      */
+   /* High Watermark is the largest number of blocks that were in use at*/
+   /* the same time.  Spills counts the allocations that were served by */
+   /* a larger class because the class was exhausted, Failures the ones */
+   /* that could not be served at all.                                  */
+typedef struct _tagMemPool_Class_Statistics_t
+{
+   unsigned int  BlockSize;
+   unsigned int  NumberBlocks;
+   unsigned int  InUse;
+   unsigned int  HighWatermark;
+   unsigned long Allocations;
+   unsigned long Spills;
+   unsigned long Failures;
+} MemPool_Class_Statistics_t;
+
+   /* The following structure holds the counters of the pool.            */
+   /* Oversize Failures counts the requests that are larger than the    */
+   /* largest class, Invalid Frees the frees of pointers that are not   */
+   /* blocks of the pool.                                               */
+typedef struct _tagMemPool_Statistics_t
+{
+   unsigned int               NumberClasses;
+   MemPool_Class_Statistics_t ClassStatistics[MEM_POOL_NUMBER_CLASSES];
+   unsigned long              OversizeFailures;
+   unsigned long              InvalidFrees;
+} MemPool_Statistics_t;
+
+#ifdef MEM_POOL_ENABLE
+
+   /* The following function allocates a block of at least the specified */
+   /* size.  This function returns NULL if no block is available.       */
+void *MemPool_Allocate(unsigned long Size);
+
+   /* The following function returns a block to the pool.                */
+void MemPool_Free(void *Block);
+
+   /* The following functions replace BTPS_AllocateMemory() and          */
+   /* BTPS_FreeMemory() of the kernel (see above).                      */
+void *BTPSAPI MemPool_BTPS_AllocateMemory(unsigned long MemorySize);
+void BTPSAPI MemPool_BTPS_FreeMemory(void *MemoryPointer);
+
+   /* The following function copies the counters of the pool to the      */
+   /* specified structure.  This function returns zero if successful or */
+   /* a negative value if the parameter is invalid.                     */
+int MemPool_QueryStatistics(MemPool_Statistics_t *Statistics);
+
+   /* The following function displays the counters of every size class.  */
+void MemPool_Display(void);
+
+   /* The following function clears the allocation, spill and failure    */
+   /* counters and restarts the high watermarks at the current usage.   */
+void MemPool_ResetStatistics(void);
+
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+/*****< metrics.c >************************************************************/
+/*                                                                            */
+/*  Metrics - Runtime counters of the firmware.                               */
+/*                                                                            */
+/******************************************************************************/
+#include <string.h>        /* Included for memset.                            */
+#include "Metrics.h"       /* Metrics Prototypes/Constants.                   */
+
+   /* The following variable is the registry (see Metrics.h).  It is    */
+   /* zero at start up as part of standard C/C++.                       */
+Metrics_t Metrics;
+
+   /* The following tables hold the names of the counters and the       */
+   /* watermarks.                                                       */
+static char *CounterNames[mcNumberCounters] = { "Commands", "Command Errors", "Commands Rejected", "HCI Rx Bytes", "HCI Tx Bytes", "Console Rx Bytes", "Console Tx Bytes" };
+
+static char *WatermarkNames[mwNumberWatermarks] = { "HCI Tx Queue", "Console Backlog", "Prepared Write Queue", "Operations" };
+
+   /* The following function clears the registry.                       */
+void Metrics_Reset(void)
+{
+   memset(&Metrics, 0, sizeof(Metrics));
+}
+
+   /* The following function writes the serialized form of the registry */
+   /* (see METRICS_VALUE_LENGTH) to the specified buffer.  This function*/
+   /* returns the number of bytes written, zero if the buffer is too    */
+   /* small.                                                            */
+unsigned int Metrics_Serialize(unsigned int BufferLength, unsigned char *Buffer)
+{
+   unsigned int   ret_val;
+   unsigned int   Index;
+   unsigned long *Value;
+
+   if((Buffer) && (BufferLength >= METRICS_VALUE_LENGTH))
+   {
+      Buffer[0] = METRICS_VALUE_VERSION;
+      Buffer[1] = mcNumberCounters;
+      Buffer[2] = mwNumberWatermarks;
+      Buffer[3] = METRICS_GAP_EVENT_TYPES;
+      Buffer[4] = METRICS_HFRE_EVENT_TYPES;
+      Buffer[5] = METRICS_GATT_SERVER_EVENT_TYPES;
+      Buffer[6] = METRICS_GATT_CONNECTION_EVENT_TYPES;
+      Buffer[7] = 0;
+
+      /* The tables follow each other in Metrics_t, so the registry is  */
+      /* written as one array.                                          */
+      Value = (unsigned long *)&Metrics;
+
+      for(Index=0;Index<(sizeof(Metrics_t) / sizeof(unsigned long));Index++)
+      {
+         Buffer[8 + (Index * 4)]     = (unsigned char)(Value[Index]);
+         Buffer[8 + (Index * 4) + 1] = (unsigned char)(Value[Index] >> 8);
+         Buffer[8 + (Index * 4) + 2] = (unsigned char)(Value[Index] >> 16);
+         Buffer[8 + (Index * 4) + 3] = (unsigned char)(Value[Index] >> 24);
+      }
+
+      ret_val = METRICS_VALUE_LENGTH;
+   }
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* The following function returns the name of the specified counter. */
+char *Metrics_CounterName(Metrics_Counter_t Counter)
+{
+   return(((unsigned int)Counter < mcNumberCounters)?CounterNames[Counter]:"Unknown");
+}
+
+   /* The following function returns the name of the specified          */
+   /* watermark.                                                        */
+char *Metrics_WatermarkName(Metrics_Watermark_t Watermark)
+{
+   return(((unsigned int)Watermark < mwNumberWatermarks)?WatermarkNames[Watermark]:"Unknown");
+}
@@ -0,0 +1,120 @@
+/*****< metrics.h >************************************************************/
+/*                                                                            */
+/*  Metrics - Runtime counters of the firmware.                               */
+/*                                                                            */
+/*  The registry holds, in one RAM structure:                                 */
+/*                                                                            */
+/*     - one counter per event type of the GAP, HFRE, GATT server and GATT    */
+/*       connection callbacks,                                                */
+/*     - the console commands run, failed and rejected by the parser,         */
+/*     - the bytes received and sent over the HCI UART and the console,       */
+/*     - the high watermarks of the queue depths.                             */
+/*                                                                            */
+/*  The structure is global and the updates are macros, so a counter update   */
+/*  compiles to an increment of a fixed address (an event type past the end   */
+/*  of its table is counted in the last entry, "Other").  The registry is     */
+/*  read with the STATS console command and the metrics characteristic of     */
+/*  the GATT service, which carries the serialized form below.                */
+/*                                                                            */
+/*  This header does not depend on the stack, so the hardware-independent     */
+/*  transport cores (and their host benches) can update the counters.         */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __METRICSH__
+#define __METRICSH__
+
+#define METRICS_GAP_EVENT_TYPES                     (15)  /* Denotes the number*/
+#define METRICS_HFRE_EVENT_TYPES                    (63)  /* of event types    */
+#define METRICS_GATT_SERVER_EVENT_TYPES             (15)  /* counted one by one*/
+#define METRICS_GATT_CONNECTION_EVENT_TYPES         (15)  /* per callback, the */
+                                                         /* types above are   */
+                                                         /* counted together  */
+                                                         /* as Other.         */
+
+#define METRICS_VALUE_VERSION                        (1)  /* Denotes the       */
+                                                         /* version of the    */
+                                                         /* serialized form.  */
+
+   /* The following enumerated type represents the counters of the      */
+   /* registry (the order is the order of the serialized form, new      */
+   /* counters are added at the end).                                   */
+typedef enum
+{
+   mcCommands,
+   mcCommandErrors,
+   mcCommandsRejected,
+   mcHCIRxBytes,
+   mcHCITxBytes,
+   mcConsoleRxBytes,
+   mcConsoleTxBytes,
+   mcNumberCounters
+} Metrics_Counter_t;
+
+   /* The following enumerated type represents the high watermarks of   */
+   /* the registry: the bytes queued for the HCI UART, the console input*/
+   /* that was not handed off yet, the bytes of a prepared write queue  */
+   /* and the stack operations in progress.                             */
+typedef enum
+{
+   mwHCITxQueue,
+   mwConsoleBacklog,
+   mwPreparedWriteQueue,
+   mwOperations,
+   mwNumberWatermarks
+} Metrics_Watermark_t;
+
+   /* The following structure holds the registry.                       */
+typedef struct _tagMetrics_t
+{
+   unsigned long Counters[mcNumberCounters];
+   unsigned long Watermarks[mwNumberWatermarks];
+   unsigned long GAPEvents[METRICS_GAP_EVENT_TYPES + 1];
+   unsigned long HFREEvents[METRICS_HFRE_EVENT_TYPES + 1];
+   unsigned long GATTServerEvents[METRICS_GATT_SERVER_EVENT_TYPES + 1];
+   unsigned long GATTConnectionEvents[METRICS_GATT_CONNECTION_EVENT_TYPES + 1];
+} Metrics_t;
+
+   /* The following constant represents the length of the serialized    */
+   /* form: a header of 8 bytes (the version, the number of counters,   */
+   /* of watermarks and of the GAP, HFRE, GATT server and GATT          */
+   /* connection event types, and a reserved byte) followed by every    */
+   /* value of the registry, in the order of Metrics_t, as 32-bit little*/
+   /* endian numbers.  Each event table has one entry more than its     */
+   /* number of types (Other).                                          */
+#define METRICS_VALUE_LENGTH                       (8 + (sizeof(Metrics_t) / sizeof(unsigned long)) * 4)
+
+   /* The following variable is the registry.  It is only meant to be   */
+   /* updated through the macros below.                                 */
+extern Metrics_t Metrics;
+
+   /* The following macros update the registry.  METRICS_COUNT() and    */
+   /* METRICS_ADD() update a counter, METRICS_COUNT_EVENT() the counter */
+   /* of an event type in the specified table (GAPEvents, HFREEvents,   */
+   /* GATTServerEvents or GATTConnectionEvents, the last entry if the   */
+   /* type is out of range).  METRICS_WATERMARK() raises a high         */
+   /* watermark to the specified depth.                                 */
+#define METRICS_COUNT(_x)                          (Metrics.Counters[(_x)]++)
+
+#define METRICS_ADD(_x, _y)                        (Metrics.Counters[(_x)] += (unsigned long)(_y))
+
+#define METRICS_EVENT_TYPES(_x)                    ((sizeof(Metrics._x) / sizeof(Metrics._x[0])) - 1)
+
+#define METRICS_COUNT_EVENT(_x, _y)                (Metrics._x[((unsigned int)(_y) < METRICS_EVENT_TYPES(_x))?(unsigned int)(_y):METRICS_EVENT_TYPES(_x)]++)
+
+#define METRICS_WATERMARK(_x, _y)                  do { if((unsigned long)(_y) > Metrics.Watermarks[(_x)]) Metrics.Watermarks[(_x)] = (unsigned long)(_y); } while(0)
+
+   /* The following function clears the registry.                       */
+void Metrics_Reset(void);
+
+   /* The following function writes the serialized form of the registry */
+   /* (see METRICS_VALUE_LENGTH) to the specified buffer.  This function*/
+   /* returns the number of bytes written, zero if the buffer is too    */
+   /* small.                                                            */
+unsigned int Metrics_Serialize(unsigned int BufferLength, unsigned char *Buffer);
+
+   /* The following functions return the name of the specified counter  */
+   /* and watermark.                                                    */
+char *Metrics_CounterName(Metrics_Counter_t Counter);
+char *Metrics_WatermarkName(Metrics_Watermark_t Watermark);
+
+#endif
@@ -0,0 +1,333 @@
+/*****< consoledma.c >*********************************************************/
+/*                                                                            */
+/*  ConsoleDMA - DMA fed console receive ring with in-place line assembly.    */
+/*               This module holds the ring management of the console input   */
+/*               and is independent of the hardware, it is driven by a port   */
+/*               layer (the uDMA of the TM4C in ConsoleTRDMA.c or a simulated */
+/*               UART on the host).                                           */
+/*                                                                            */
+/******************************************************************************/
+#include <string.h>        /* Included for memcpy.                            */
+#include "ConsoleDMA.h"    /* Console DMA Receive Core Prototypes/Constants.  */
+#include "../Metrics.h"    /* Metrics Prototypes/Constants.                   */
+
+   /* The following constants represent the characters that edit the    */
+   /* line being typed.                                                 */
+#define CONSOLE_DMA_BACKSPACE                           0x08
+#define CONSOLE_DMA_DELETE                              0x7F
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the compiler*/
+   /* as part of standard C/C++).                                       */
+
+static ConsoleDMA_Port_t      *ConsolePort;         /* Variable which holds the port   */
+                                                    /* layer that drives the core.     */
+
+static ConsoleDMA_Line_t       LineFunction;        /* Variables which hold the        */
+static unsigned long           LineParameter;       /* function (and its parameter)    */
+                                                    /* that receives the complete      */
+                                                    /* lines.                          */
+
+static unsigned char           Ring[CONSOLE_DMA_RING_SIZE + CONSOLE_DMA_MAXIMUM_LINE_LENGTH + 1];
+                                                    /* Variable which holds the        */
+                                                    /* receive ring, followed by the   */
+                                                    /* room for the part of a line     */
+                                                    /* that wrapped around the end of  */
+                                                    /* the ring (and its terminator).  */
+
+static volatile unsigned long  RxFilled;            /* Variable which holds the number */
+                                                    /* of bytes received in the        */
+                                                    /* completed segments.             */
+
+static volatile unsigned long  RxArmed;             /* Variable which holds the end of */
+                                                    /* the segments armed (the same as */
+                                                    /* RxFilled while no segment is    */
+                                                    /* armed).                         */
+
+static volatile unsigned long  LineStart;           /* Variable which holds the first  */
+                                                    /* byte that was not handed off.   */
+                                                    /* The ring is not armed beyond    */
+                                                    /* one ring size past it.          */
+
+static unsigned long           ScanPosition;        /* Variable which holds the next   */
+                                                    /* byte to scan.                   */
+
+static unsigned long           AssemblyPosition;    /* Variable which holds the end of */
+                                                    /* the line being assembled        */
+                                                    /* (behind the scan position after */
+                                                    /* a backspace).                   */
+
+static unsigned char           PreviousCharacter;   /* Variable which holds the last   */
+                                                    /* character scanned (a LF after a */
+                                                    /* CR is not another line).        */
+
+static int                     Discarding;          /* Variable which flags that the   */
+                                                    /* line being typed is too long    */
+                                                    /* and is dropped up to its end.   */
+
+static ConsoleDMA_Statistics_t ConsoleStatistics;   /* Variable which holds the        */
+                                                    /* console statistics.             */
+
+   /* Internal function prototypes.                                     */
+static void ArmSegments(void);
+static void EchoCharacters(unsigned int Length, char *Buffer);
+static void HandOffLine(void);
+
+   /* The following function arms the segments of the ring that are     */
+   /* free, up to both DMA structures.  A segment is free once all the  */
+   /* lines in it were handed off, the DMA never writes past one ring   */
+   /* size beyond the first byte that was not handed off.  This function*/
+   /* is called with the port locked (or from the interrupt handler).   */
+static void ArmSegments(void)
+{
+   while(((RxArmed - RxFilled) < (CONSOLE_DMA_NUMBER_STRUCTURES * CONSOLE_DMA_SEGMENT_SIZE)) && ((RxArmed + CONSOLE_DMA_SEGMENT_SIZE - LineStart) <= CONSOLE_DMA_RING_SIZE))
+   {
+      (*ConsolePort->StartRx)((unsigned int)((RxArmed / CONSOLE_DMA_SEGMENT_SIZE) % CONSOLE_DMA_NUMBER_STRUCTURES), &(Ring[RxArmed % CONSOLE_DMA_RING_SIZE]), CONSOLE_DMA_SEGMENT_SIZE);
+
+      RxArmed += CONSOLE_DMA_SEGMENT_SIZE;
+   }
+}
+
+   /* The following function writes the echo of the typed characters (if*/
+   /* the port echoes).                                                 */
+static void EchoCharacters(unsigned int Length, char *Buffer)
+{
+   if(ConsolePort->Echo)
+   {
+      (*ConsolePort->Echo)(Length, (unsigned char *)Buffer);
+
+      METRICS_ADD(mcConsoleTxBytes, Length);
+   }
+}
+
+   /* The following function hands the assembled line to the Line       */
+   /* function.  The line is terminated in place, only the part of a    */
+   /* line that wrapped around the end of the ring is copied (behind the*/
+   /* end, so that the line is contiguous).                             */
+static void HandOffLine(void)
+{
+   unsigned int Start;
+   unsigned int Length;
+   unsigned int Wrapped;
+
+   Start  = (unsigned int)(LineStart % CONSOLE_DMA_RING_SIZE);
+   Length = (unsigned int)(AssemblyPosition - LineStart);
+
+   if((Start + Length) > CONSOLE_DMA_RING_SIZE)
+   {
+      Wrapped = (Start + Length) - CONSOLE_DMA_RING_SIZE;
+
+      memcpy(&(Ring[CONSOLE_DMA_RING_SIZE]), Ring, Wrapped);
+
+      ConsoleStatistics.WrappedLines++;
+   }
+
+   /* The terminator goes over the end of line character (or a character*/
+   /* that was erased), which was already scanned.                      */
+   Ring[Start + Length] = '\0';
+
+   ConsoleStatistics.Lines++;
+
+   if(Length > ConsoleStatistics.LongestLine)
+      ConsoleStatistics.LongestLine = Length;
+
+   if(LineFunction)
+      (*LineFunction)((char *)&(Ring[Start]), Length, LineParameter);
+}
+
+   /* The following function initializes the core and arms the first    */
+   /* segments through the port.  The Line function is called from      */
+   /* ConsoleDMA_Process() with each complete line.                     */
+void ConsoleDMA_Initialize(ConsoleDMA_Port_t *Port, ConsoleDMA_Line_t Line, unsigned long CallbackParameter)
+{
+   ConsolePort       = Port;
+   LineFunction      = Line;
+   LineParameter     = CallbackParameter;
+
+   RxFilled          = 0;
+   RxArmed           = 0;
+   LineStart         = 0;
+   ScanPosition      = 0;
+   AssemblyPosition  = 0;
+   PreviousCharacter = 0;
+   Discarding        = 0;
+
+   memset(&ConsoleStatistics, 0, sizeof(ConsoleStatistics));
+
+   if(ConsolePort)
+   {
+      (*ConsolePort->Lock)();
+
+      ArmSegments();
+
+      (*ConsolePort->Unlock)();
+   }
+}
+
+   /* The following function is called by the port layer when the DMA   */
+   /* filled the segment of a structure.  The next free segment is armed*/
+   /* right away, if there is none the input waits in the UART FIFO     */
+   /* until the main loop hands off a line.                             */
+void ConsoleDMA_RxComplete(void)
+{
+   if(RxArmed != RxFilled)
+   {
+      RxFilled += CONSOLE_DMA_SEGMENT_SIZE;
+
+      ConsoleStatistics.Segments++;
+
+      ArmSegments();
+
+      if(RxArmed == RxFilled)
+         ConsoleStatistics.Stalls++;
+   }
+}
+
+   /* The following function is called once per interrupt so that the   */
+   /* interrupt load per character can be measured.                     */
+void ConsoleDMA_CountInterrupt(void)
+{
+   ConsoleStatistics.Interrupts++;
+}
+
+   /* The following function is called once per receive FIFO overrun.   */
+void ConsoleDMA_CountOverrun(void)
+{
+   ConsoleStatistics.Overruns++;
+}
+
+   /* The following function scans the characters the DMA received since*/
+   /* the last call, hands the complete lines to the Line function and  */
+   /* re-arms the segments that are free again.  This function must be  */
+   /* called from the main loop, never from an interrupt handler.       */
+void ConsoleDMA_Process(void)
+{
+   unsigned long Written;
+   unsigned char Character;
+   int           Released;
+
+   if(ConsolePort)
+   {
+      /* Take the number of bytes written so far, including the part of */
+      /* the segment the DMA is filling.  A transfer that completes     */
+      /* meanwhile reports the whole segment (its interrupt is held off */
+      /* by the lock and only then counts it).                          */
+      (*ConsolePort->Lock)();
+
+      Written = RxFilled;
+      if(RxArmed != RxFilled)
+         Written += (*ConsolePort->QueryRx)((unsigned int)((RxFilled / CONSOLE_DMA_SEGMENT_SIZE) % CONSOLE_DMA_NUMBER_STRUCTURES));
+
+      (*ConsolePort->Unlock)();
+
+      if((Written - LineStart) > ConsoleStatistics.MaximumBacklog)
+         ConsoleStatistics.MaximumBacklog = Written - LineStart;
+
+      METRICS_WATERMARK(mwConsoleBacklog, Written - LineStart);
+
+      Released = 0;
+
+      while(ScanPosition != Written)
+      {
+         Character = Ring[ScanPosition % CONSOLE_DMA_RING_SIZE];
+
+         ScanPosition++;
+
+         ConsoleStatistics.RxBytes++;
+
+         METRICS_COUNT(mcConsoleRxBytes);
+
+         if((Character == '\r') || (Character == '\n'))
+         {
+            /* A CR LF pair ends a single line.                         */
+            if((Character == '\r') || (PreviousCharacter != '\r'))
+            {
+               EchoCharacters(2, "\r\n");
+
+               if((!Discarding) && (AssemblyPosition != LineStart))
+                  HandOffLine();
+
+               Discarding = 0;
+            }
+
+            AssemblyPosition = ScanPosition;
+            LineStart        = ScanPosition;
+
+            /* The line is done with, arm the segments it held right    */
+            /* away so that the reception goes on while the next lines  */
+            /* are interpreted.                                         */
+            (*ConsolePort->Lock)();
+
+            ArmSegments();
+
+            (*ConsolePort->Unlock)();
+         }
+         else
+         {
+            if((Character == CONSOLE_DMA_BACKSPACE) || (Character == CONSOLE_DMA_DELETE))
+            {
+               if((!Discarding) && (AssemblyPosition != LineStart))
+               {
+                  AssemblyPosition--;
+
+                  EchoCharacters(3, "\b \b");
+               }
+            }
+            else
+            {
+               /* Other control characters (terminal escape sequences,  */
+               /* for example) are not part of a command.               */
+               if((!Discarding) && ((Character >= ' ') || (Character == '\t')))
+               {
+                  if((AssemblyPosition - LineStart) < CONSOLE_DMA_MAXIMUM_LINE_LENGTH)
+                  {
+                     /* The character is moved only if backspaces erased*/
+                     /* characters in front of it.                      */
+                     Ring[AssemblyPosition % CONSOLE_DMA_RING_SIZE] = Character;
+
+                     AssemblyPosition++;
+
+                     EchoCharacters(1, (char *)&Character);
+                  }
+                  else
+                  {
+                     ConsoleStatistics.LongLines++;
+
+                     Discarding = 1;
+                  }
+               }
+            }
+
+            /* The characters of a line that is dropped are released    */
+            /* right away, so that a line without an end cannot stall   */
+            /* the ring.                                                */
+            if(Discarding)
+            {
+               AssemblyPosition = ScanPosition;
+               LineStart        = ScanPosition;
+               Released         = 1;
+            }
+         }
+
+         PreviousCharacter = Character;
+      }
+
+      /* Arm the segments that the dropped characters have freed (a     */
+      /* reception that stalled on a line without an end resumes here). */
+      if(Released)
+      {
+         (*ConsolePort->Lock)();
+
+         ArmSegments();
+
+         (*ConsolePort->Unlock)();
+      }
+   }
+}
+
+   /* The following function returns the console statistics.            */
+void ConsoleDMA_QueryStatistics(ConsoleDMA_Statistics_t *Statistics)
+{
+   if(Statistics)
+      *Statistics = ConsoleStatistics;
+}
@@ -0,0 +1,128 @@
+/*****< consoledma.h >*********************************************************/
+/*                                                                            */
+/*  ConsoleDMA - DMA fed console receive ring with in-place line assembly.    */
+/*               This module holds the ring management of the console input   */
+/*               and is independent of the hardware, it is driven by a port   */
+/*               layer (the uDMA of the TM4C in ConsoleTRDMA.c or a simulated */
+/*               UART on the host).                                           */
+/*                                                                            */
+/*  The receive DMA writes the console input straight into a ring of          */
+/*  segments (one segment per ping-pong transfer, so the CPU is interrupted   */
+/*  once per segment, not once per character).  The main loop scans the new   */
+/*  characters where the DMA put them, applies backspaces in place and hands  */
+/*  each complete line to the interpreter as a pointer into the ring.  Only   */
+/*  a line that wraps around the end of the ring is copied (the part at the   */
+/*  start of the ring is moved behind the end).  A segment is re-armed once   */
+/*  the lines in it were handed off, so a burst of scripted commands is       */
+/*  absorbed by the ring while the interpreter runs.                          */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __CONSOLEDMAH__
+#define __CONSOLEDMAH__
+
+#define CONSOLE_DMA_NUMBER_STRUCTURES               (2)  /* Denotes the number */
+                                                         /* of DMA transfers  */
+                                                         /* that are armed at */
+                                                         /* once (ping and    */
+                                                         /* pong).            */
+
+#ifndef CONSOLE_DMA_NUMBER_SEGMENTS
+
+#define CONSOLE_DMA_NUMBER_SEGMENTS                 (8)  /* Denotes the number */
+                                                         /* of segments of the*/
+                                                         /* receive ring.     */
+
+#endif
+
+#ifndef CONSOLE_DMA_SEGMENT_SIZE
+
+#define CONSOLE_DMA_SEGMENT_SIZE                  (256)  /* Denotes the size of*/
+                                                         /* each segment.  The*/
+                                                         /* ring (2 KB holds  */
+                                                         /* 170 ms at 115200  */
+                                                         /* baud) must be a   */
+                                                         /* power of two.     */
+
+#endif
+
+#define CONSOLE_DMA_RING_SIZE                      (CONSOLE_DMA_NUMBER_SEGMENTS * CONSOLE_DMA_SEGMENT_SIZE)
+
+#ifndef CONSOLE_DMA_MAXIMUM_LINE_LENGTH
+
+#define CONSOLE_DMA_MAXIMUM_LINE_LENGTH            (64)  /* Denotes the       */
+                                                         /* longest line that */
+                                                         /* is handed off,    */
+                                                         /* longer lines are  */
+                                                         /* dropped.          */
+
+#endif
+
+   /* The following structure holds the functions that a port layer     */
+   /* provides to the core.  StartRx() arms the specified DMA structure */
+   /* (segment N of the ring uses structure N % 2) with a segment,      */
+   /* QueryRx() returns the number of bytes the DMA has written into the*/
+   /* segment of the specified structure so far.  Echo() writes the     */
+   /* echo of the typed characters (NULL for none) and Lock()/Unlock()  */
+   /* protect the state that is shared with the interrupt handler       */
+   /* (normally by masking the UART interrupt).                         */
+typedef struct _tagConsoleDMA_Port_t
+{
+   void         (*StartRx)(unsigned int StructureIndex, unsigned char *Buffer, unsigned int Length);
+   unsigned int (*QueryRx)(unsigned int StructureIndex);
+   void         (*Echo)(unsigned int Length, unsigned char *Buffer);
+   void         (*Lock)(void);
+   void         (*Unlock)(void);
+} ConsoleDMA_Port_t;
+
+   /* The following type definition represents the function that        */
+   /* receives a complete line.  The line is passed in the ring (no copy*/
+   /* is made), it is NULL terminated and may be modified (the          */
+   /* interpreter tokenizes it in place).  It stays valid until this    */
+   /* function returns.                                                 */
+typedef void (*ConsoleDMA_Line_t)(char *Line, unsigned int Length, unsigned long CallbackParameter);
+
+   /* The following structure holds the statistics of the console.      */
+   /* WrappedLines are the lines that were copied because they wrapped  */
+   /* around the end of the ring, LongLines the lines that were dropped */
+   /* because they were too long.  Stalls count the times no segment    */
+   /* could be armed (the input then waits in the UART FIFO and is lost */
+   /* with an Overrun if the FIFO fills up).  MaximumBacklog is the     */
+   /* largest amount of input the ring held that was not handed off yet.*/
+typedef struct _tagConsoleDMA_Statistics_t
+{
+   unsigned long RxBytes;
+   unsigned long Lines;
+   unsigned long LongestLine;
+   unsigned long WrappedLines;
+   unsigned long LongLines;
+   unsigned long Segments;
+   unsigned long Interrupts;
+   unsigned long Stalls;
+   unsigned long Overruns;
+   unsigned long MaximumBacklog;
+} ConsoleDMA_Statistics_t;
+
+   /* The following function initializes the core and arms the first    */
+   /* segments through the port.  The Line function is called from      */
+   /* ConsoleDMA_Process() with each complete line.                     */
+void ConsoleDMA_Initialize(ConsoleDMA_Port_t *Port, ConsoleDMA_Line_t Line, unsigned long CallbackParameter);
+
+   /* The following functions are called by the port layer from its     */
+   /* interrupt handler.  ConsoleDMA_RxComplete() is called when the DMA*/
+   /* filled the segment of a structure (in the order the segments were */
+   /* armed).  ConsoleDMA_CountInterrupt() is called once per interrupt */
+   /* and ConsoleDMA_CountOverrun() once per receive FIFO overrun.      */
+void ConsoleDMA_RxComplete(void);
+void ConsoleDMA_CountInterrupt(void);
+void ConsoleDMA_CountOverrun(void);
+
+   /* The following function scans the characters the DMA received since*/
+   /* the last call, hands the complete lines to the Line function and  */
+   /* re-arms the segments that are free again.  This function must be  */
+   /* called from the main loop, never from an interrupt handler.       */
+void ConsoleDMA_Process(void);
+
+   /* The following function returns the console statistics.            */
+void ConsoleDMA_QueryStatistics(ConsoleDMA_Statistics_t *Statistics);
+
+#endif
@@ -0,0 +1,238 @@
+/*****< consoletrdma.c >*******************************************************/
+/*                                                                            */
+/*  ConsoleTRDMA - uDMA driven console UART receive for the TM4C (replaces    */
+/*                 the interrupt per character receive of the HAL).           */
+/*                                                                            */
+/*  The uDMA (ping-pong mode, single requests so that every character is      */
+/*  moved as soon as it arrives) writes the typed or scripted input straight  */
+/*  into the segments of the receive ring of ConsoleDMA.c.  The CPU is only   */
+/*  interrupted when a segment is full, the main loop picks up the characters */
+/*  of the segment being filled by reading the remaining transfer count.      */
+/*                                                                            */
+/******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_uart.h"
+#include "inc/hw_ints.h"
+#include "driverlib/uart.h"
+#include "driverlib/udma.h"
+#include "driverlib/interrupt.h"
+
+#include "HAL.h"           /* Function for Hardware Abstraction.              */
+#include "ConsoleTRDMA.h"  /* Console DMA Receive Prototypes/Constants.       */
+#include "UDMATable.h"     /* Shared uDMA Control Table Prototypes.           */
+
+   /* The following constants define the console UART.  The defaults    */
+   /* match the virtual COM port of the DK boards, they may be          */
+   /* overridden on the compiler command line (and must match the       */
+   /* console of the board's HALCFG.h).                                 */
+#ifndef CONSOLE_DMA_UART_BASE
+
+#define CONSOLE_DMA_UART_BASE                      UART0_BASE
+#define CONSOLE_DMA_UART_INT                       INT_UART0
+#define CONSOLE_DMA_RX_CHANNEL                     UDMA_CHANNEL_UART0RX
+
+#endif
+
+   /* The following macro returns the uDMA control structure select for */
+   /* the specified structure index.                                    */
+#define DMA_STRUCTURE_SELECT(_x)                   ((_x)?UDMA_ALT_SELECT:UDMA_PRI_SELECT)
+
+   /* The following function is the console interrupt handler of the    */
+   /* HAL, it is still used for the transmit side.                      */
+extern void ConsoleIntHandler(void);
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the compiler*/
+   /* as part of standard C/C++).                                       */
+
+static bool                   ConsoleOpen;          /* Variable which flags whether    */
+                                                    /* the console receive is open.    */
+
+static unsigned int           RxBufferLength[CONSOLE_DMA_NUMBER_STRUCTURES];
+                                                    /* Variable which holds the size   */
+                                                    /* of the segment that is armed on */
+                                                    /* each uDMA control structure.    */
+
+static volatile unsigned char RxArmed[CONSOLE_DMA_NUMBER_STRUCTURES];
+                                                    /* Variable which flags the        */
+                                                    /* control structures that hold an */
+                                                    /* armed segment.                  */
+
+static volatile unsigned int  RxActiveIndex;        /* Variable which holds the index  */
+                                                    /* of the structure that the uDMA  */
+                                                    /* is currently filling.           */
+
+   /* Internal function prototypes.                                     */
+static void PortStartRx(unsigned int StructureIndex, unsigned char *Buffer, unsigned int Length);
+static unsigned int PortQueryRx(unsigned int StructureIndex);
+static void PortEcho(unsigned int Length, unsigned char *Buffer);
+static void PortLock(void);
+static void PortUnlock(void);
+
+   /* The following structure holds the port functions that are passed  */
+   /* to the console core.                                              */
+static ConsoleDMA_Port_t DMAPort =
+{
+   PortStartRx,
+   PortQueryRx,
+   PortEcho,
+   PortLock,
+   PortUnlock
+};
+
+   /* The following function arms the specified uDMA control structure  */
+   /* with the specified segment.  If the receive uDMA stopped because  */
+   /* no segment was free it is restarted on this structure (the input  */
+   /* waited in the UART FIFO meanwhile).                               */
+static void PortStartRx(unsigned int StructureIndex, unsigned char *Buffer, unsigned int Length)
+{
+   RxBufferLength[StructureIndex] = Length;
+
+   uDMAChannelTransferSet(CONSOLE_DMA_RX_CHANNEL | DMA_STRUCTURE_SELECT(StructureIndex), UDMA_MODE_PINGPONG, (void *)(CONSOLE_DMA_UART_BASE + UART_O_DR), Buffer, Length);
+
+   RxArmed[StructureIndex] = 1;
+
+   if(!RxArmed[RxActiveIndex])
+   {
+      if(StructureIndex)
+         uDMAChannelAttributeEnable(CONSOLE_DMA_RX_CHANNEL, UDMA_ATTR_ALTSELECT);
+      else
+         uDMAChannelAttributeDisable(CONSOLE_DMA_RX_CHANNEL, UDMA_ATTR_ALTSELECT);
+
+      RxActiveIndex = StructureIndex;
+   }
+
+   if(!uDMAChannelIsEnabled(CONSOLE_DMA_RX_CHANNEL))
+      uDMAChannelEnable(CONSOLE_DMA_RX_CHANNEL);
+}
+
+   /* The following function returns the number of bytes the uDMA has   */
+   /* written into the segment of the specified structure.  A structure */
+   /* that finished (its interrupt is pending while the port is locked) */
+   /* reports the whole segment.                                        */
+static unsigned int PortQueryRx(unsigned int StructureIndex)
+{
+   unsigned int ret_val;
+
+   if(RxArmed[StructureIndex])
+      ret_val = RxBufferLength[StructureIndex] - (unsigned int)uDMAChannelSizeGet(CONSOLE_DMA_RX_CHANNEL | DMA_STRUCTURE_SELECT(StructureIndex));
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* The following function echoes the typed characters through the    */
+   /* (buffered) console output of the HAL.                             */
+static void PortEcho(unsigned int Length, unsigned char *Buffer)
+{
+   HAL_ConsoleWrite((int)Length, (char *)Buffer);
+}
+
+   /* The following functions protect the console state that is shared  */
+   /* with the interrupt handler.  The uDMA completion interrupt of the */
+   /* UART channel is delivered on the UART vector so masking it is     */
+   /* sufficient.                                                       */
+static void PortLock(void)
+{
+   IntDisable(CONSOLE_DMA_UART_INT);
+}
+
+static void PortUnlock(void)
+{
+   IntEnable(CONSOLE_DMA_UART_INT);
+}
+
+   /* The following function is the UART interrupt handler of the       */
+   /* console UART (it is referenced by the vector table in place of the*/
+   /* HAL's ConsoleIntHandler(), which it calls for the transmit side). */
+void ConsoleTR_UARTIntHandler(void)
+{
+   uint32_t Status;
+
+   if(ConsoleOpen)
+   {
+      ConsoleDMA_CountInterrupt();
+
+      Status = UARTIntStatus(CONSOLE_DMA_UART_BASE, true);
+      if(Status & UART_INT_OE)
+      {
+         UARTIntClear(CONSOLE_DMA_UART_BASE, UART_INT_OE);
+
+         ConsoleDMA_CountOverrun();
+      }
+
+      /* Hand every segment that the uDMA filled to the core (in the    */
+      /* order they were filled), the core arms the next free segments. */
+      while((RxArmed[RxActiveIndex]) && (uDMAChannelModeGet(CONSOLE_DMA_RX_CHANNEL | DMA_STRUCTURE_SELECT(RxActiveIndex)) == UDMA_MODE_STOP))
+      {
+         RxArmed[RxActiveIndex] = 0;
+         RxActiveIndex         ^= 1;
+
+         ConsoleDMA_RxComplete();
+      }
+   }
+
+   /* The receive interrupts are masked, so the HAL only serves the     */
+   /* transmit side.                                                    */
+   ConsoleIntHandler();
+}
+
+   /* The following function takes over the receive side of the console */
+   /* UART (set up by HAL_ConfigureHardware()) and hands each complete  */
+   /* line to the specified function.  The transmit side stays with the */
+   /* HAL.  This function returns zero if successful or a negative value*/
+   /* if the console is already open.                                   */
+int ConsoleTR_Open(ConsoleDMA_Line_t Line, unsigned long CallbackParameter)
+{
+   int ret_val;
+
+   if(!ConsoleOpen)
+   {
+      IntDisable(CONSOLE_DMA_UART_INT);
+
+      /* The characters are no longer read by the HAL, one at a time.   */
+      UARTIntDisable(CONSOLE_DMA_UART_BASE, (UART_INT_RX | UART_INT_RT));
+
+      UDMATable_Enable();
+
+      /* Single requests (no bursts), so that a character is moved as   */
+      /* soon as it is in the FIFO and no receive timeout is needed.    */
+      uDMAChannelAttributeDisable(CONSOLE_DMA_RX_CHANNEL, UDMA_ATTR_ALL);
+      uDMAChannelControlSet(CONSOLE_DMA_RX_CHANNEL | UDMA_PRI_SELECT, (UDMA_SIZE_8 | UDMA_SRC_INC_NONE | UDMA_DST_INC_8 | UDMA_ARB_4));
+      uDMAChannelControlSet(CONSOLE_DMA_RX_CHANNEL | UDMA_ALT_SELECT, (UDMA_SIZE_8 | UDMA_SRC_INC_NONE | UDMA_DST_INC_8 | UDMA_ARB_4));
+
+      RxArmed[0]    = 0;
+      RxArmed[1]    = 0;
+      RxActiveIndex = 0;
+
+      /* Arm the first segments of the ring.                            */
+      ConsoleDMA_Initialize(&DMAPort, Line, CallbackParameter);
+
+      UARTDMAEnable(CONSOLE_DMA_UART_BASE, UART_DMA_RX);
+      UARTIntEnable(CONSOLE_DMA_UART_BASE, UART_INT_OE);
+
+      ConsoleOpen = true;
+
+      IntEnable(CONSOLE_DMA_UART_INT);
+
+      ret_val = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function hands the lines received since the last    */
+   /* call to the Line function.  This function must be called from the */
+   /* main loop.                                                        */
+void ConsoleTR_Process(void)
+{
+   if(ConsoleOpen)
+      ConsoleDMA_Process();
+}
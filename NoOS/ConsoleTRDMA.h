@@ -0,0 +1,28 @@
+/*****< consoletrdma.h >*******************************************************/
+/*                                                                            */
+/*  ConsoleTRDMA - uDMA driven console UART receive for the TM4C.             */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __CONSOLETRDMAH__
+#define __CONSOLETRDMAH__
+
+#include "ConsoleDMA.h"    /* Console DMA Receive Core Prototypes/Constants.  */
+
+   /* The following function takes over the receive side of the console */
+   /* UART (set up by HAL_ConfigureHardware()) and hands each complete  */
+   /* line to the specified function.  The transmit side stays with the */
+   /* HAL.  This function returns zero if successful or a negative value*/
+   /* if the console is already open.                                   */
+int ConsoleTR_Open(ConsoleDMA_Line_t Line, unsigned long CallbackParameter);
+
+   /* The following function hands the lines received since the last    */
+   /* call to the Line function.  This function must be called from the */
+   /* main loop.                                                        */
+void ConsoleTR_Process(void);
+
+   /* The following function is the UART interrupt handler of the       */
+   /* console UART (it is referenced by the vector table in place of the*/
+   /* HAL's ConsoleIntHandler(), which it calls for the transmit side). */
+void ConsoleTR_UARTIntHandler(void);
+
+#endif
@@ -0,0 +1,354 @@
+/*****< hcidma.c >*************************************************************/
+/*                                                                            */
+/*  HCIDMA - Double buffered (ping-pong) HCI UART transport core.  This       */
+/*           module holds the buffer management of the DMA driven HCI         */
+/*           transport and is independent of the hardware, it is driven by a  */
+/*           port layer (the uDMA of the TM4C in HCITRDMA.c or a simulated    */
+/*           UART on the host).                                               */
+/*                                                                            */
+/******************************************************************************/
+#include <string.h>        /* Included for memcpy.                            */
+#include "HCIDMA.h"        /* HCI DMA Transport Core Prototypes/Constants.    */
+#include "../BTSnoop.h"    /* HCI Traffic Capture Prototypes/Constants.       */
+#include "../Metrics.h"    /* Metrics Prototypes/Constants.                   */
+
+   /* The following constants represent the H4 packet types (and the    */
+   /* HCILL sleep protocol bytes) that are recognized when following the*/
+   /* packet headers in the received data.                              */
+#define H4_PACKET_TYPE_COMMAND                          0x01
+#define H4_PACKET_TYPE_ACL_DATA                         0x02
+#define H4_PACKET_TYPE_SCO_DATA                         0x03
+#define H4_PACKET_TYPE_EVENT                            0x04
+
+#define HCILL_FIRST_MESSAGE                             0x30
+#define HCILL_LAST_MESSAGE                              0x33
+
+#define H4_MAXIMUM_HEADER_LENGTH                        4
+
+   /* The following enumerated type represents the state of the H4      */
+   /* packet tracker.                                                   */
+typedef enum
+{
+   tsPacketType,
+   tsHeader,
+   tsPayload
+} TrackerState_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static HCIDMA_Port_t         *TransportPort;        /* Variable which holds the port   */
+                                                    /* layer that drives the core.     */
+
+static HCIDMA_Deliver_t       DeliverFunction;      /* Variables which hold the        */
+static unsigned long          DeliverParameter;     /* function (and its parameter)    */
+                                                    /* that receives the filled        */
+                                                    /* receive buffers.                */
+
+static unsigned char          RxBuffer[HCI_DMA_NUMBER_BUFFERS][HCI_DMA_RX_BUFFER_SIZE];
+                                                    /* Variable which holds the receive*/
+                                                    /* buffers.                        */
+
+static unsigned int           RxLength[HCI_DMA_NUMBER_BUFFERS]; /* Variable which holds*/
+                                                    /* the number of bytes received in */
+                                                    /* each receive buffer.            */
+
+static volatile unsigned char RxReady[HCI_DMA_NUMBER_BUFFERS]; /* Variable which flags */
+                                                    /* the receive buffers that are    */
+                                                    /* waiting to be delivered.        */
+
+static unsigned int           NextRxIndex;          /* Variable which holds the index  */
+                                                    /* of the next buffer to deliver.  */
+
+static unsigned char          TxBuffer[HCI_DMA_NUMBER_BUFFERS][HCI_DMA_TX_BUFFER_SIZE];
+                                                    /* Variable which holds the        */
+                                                    /* transmit buffers.               */
+
+static unsigned int           TxLength[HCI_DMA_NUMBER_BUFFERS]; /* Variable which holds*/
+                                                    /* the number of bytes queued in   */
+                                                    /* each transmit buffer.           */
+
+static volatile int           TxActiveIndex;        /* Variable which holds the index  */
+                                                    /* of the buffer being sent (or -1)*/
+
+static unsigned int           TxFillIndex;          /* Variable which holds the index  */
+                                                    /* of the buffer being filled.     */
+                                                    /* This is never the buffer that   */
+                                                    /* is being sent.                  */
+
+static TrackerState_t         TrackerState;         /* Variables which hold the state  */
+static unsigned int           TrackerRemaining;     /* of the H4 packet tracker.  The  */
+static unsigned int           TrackerHeaderLength;  /* header buffer holds the packet  */
+static unsigned int           TrackerHeaderIndex;   /* type followed by the header.    */
+static unsigned char          TrackerHeader[H4_MAXIMUM_HEADER_LENGTH + 1];
+
+static HCIDMA_Statistics_t    TransportStatistics;  /* Variable which holds the        */
+                                                    /* transport statistics.           */
+
+   /* Internal function prototypes.                                     */
+static void TrackPackets(unsigned int Length, unsigned char *Data);
+
+   /* The following function follows the H4 packet headers in the       */
+   /* received data to count complete packets and framing errors.  On a*/
+   /* framing error the tracker simply waits for the next byte that is  */
+   /* a valid packet type.                                              */
+static void TrackPackets(unsigned int Length, unsigned char *Data)
+{
+   unsigned int Count;
+
+   while(Length)
+   {
+      switch(TrackerState)
+      {
+         case tsPacketType:
+            switch(*Data)
+            {
+               case H4_PACKET_TYPE_COMMAND:
+               case H4_PACKET_TYPE_SCO_DATA:
+                  TrackerHeaderLength = 3;
+                  break;
+               case H4_PACKET_TYPE_ACL_DATA:
+                  TrackerHeaderLength = 4;
+                  break;
+               case H4_PACKET_TYPE_EVENT:
+                  TrackerHeaderLength = 2;
+                  break;
+               default:
+                  /* HCILL messages are single bytes, anything else is a*/
+                  /* framing error.                                     */
+                  if((*Data < HCILL_FIRST_MESSAGE) || (*Data > HCILL_LAST_MESSAGE))
+                     TransportStatistics.FramingErrors++;
+
+                  TrackerHeaderLength = 0;
+                  break;
+            }
+
+            if(TrackerHeaderLength)
+            {
+               TrackerHeader[0]   = *Data;
+               TrackerHeaderIndex = 0;
+               TrackerState       = tsHeader;
+            }
+
+            Data++;
+            Length--;
+            break;
+         case tsHeader:
+            TrackerHeader[++TrackerHeaderIndex] = *Data;
+
+            Data++;
+            Length--;
+
+            if(TrackerHeaderIndex == TrackerHeaderLength)
+            {
+               /* The header is complete, the payload length is the last*/
+               /* field of every header (16 bits for ACL data).         */
+               if(TrackerHeader[0] == H4_PACKET_TYPE_ACL_DATA)
+                  TrackerRemaining = (unsigned int)TrackerHeader[3] | ((unsigned int)TrackerHeader[4] << 8);
+               else
+                  TrackerRemaining = TrackerHeader[TrackerHeaderLength];
+
+               if(TrackerRemaining)
+                  TrackerState = tsPayload;
+               else
+               {
+                  TransportStatistics.Packets++;
+
+                  TrackerState = tsPacketType;
+               }
+            }
+            break;
+         case tsPayload:
+            Count             = (Length < TrackerRemaining)?Length:TrackerRemaining;
+            Data             += Count;
+            Length           -= Count;
+            TrackerRemaining -= Count;
+
+            if(!TrackerRemaining)
+            {
+               TransportStatistics.Packets++;
+
+               TrackerState = tsPacketType;
+            }
+            break;
+      }
+   }
+}
+
+   /* The following function initializes the core and arms both receive */
+   /* buffers through the port.  The Deliver function is called from    */
+   /* HCIDMA_Process() with each filled receive buffer.                 */
+void HCIDMA_Initialize(HCIDMA_Port_t *Port, HCIDMA_Deliver_t Deliver, unsigned long CallbackParameter)
+{
+   unsigned int Index;
+
+   TransportPort    = Port;
+   DeliverFunction  = Deliver;
+   DeliverParameter = CallbackParameter;
+
+   NextRxIndex      = 0;
+   TxActiveIndex    = -1;
+   TxFillIndex      = 0;
+   TrackerState     = tsPacketType;
+
+   memset(&TransportStatistics, 0, sizeof(TransportStatistics));
+
+   for(Index=0;Index<HCI_DMA_NUMBER_BUFFERS;Index++)
+   {
+      RxReady[Index]  = 0;
+      RxLength[Index] = 0;
+      TxLength[Index] = 0;
+   }
+
+   for(Index=0;Index<HCI_DMA_NUMBER_BUFFERS;Index++)
+      (*TransportPort->StartRx)(Index, RxBuffer[Index], HCI_DMA_RX_BUFFER_SIZE);
+}
+
+   /* The following function is called by the port layer when the       */
+   /* receive DMA of a buffer stopped, either because the buffer is full*/
+   /* or because the line went idle.                                    */
+void HCIDMA_RxComplete(unsigned int BufferIndex, unsigned int Length, int IdleLine)
+{
+   if(BufferIndex < HCI_DMA_NUMBER_BUFFERS)
+   {
+      if(Length)
+      {
+         RxLength[BufferIndex] = Length;
+         RxReady[BufferIndex]  = 1;
+
+         TransportStatistics.RxBytes += Length;
+         TransportStatistics.RxHandoffs++;
+
+         if(IdleLine)
+            TransportStatistics.IdleLineHandoffs++;
+
+         /* If the other buffer has not been delivered yet there is no  */
+         /* buffer left to receive into, the controller is held off by  */
+         /* RTS until the main loop catches up.                         */
+         if(RxReady[BufferIndex ^ 1])
+            TransportStatistics.RxStalls++;
+      }
+      else
+      {
+         /* Nothing was received, simply re-arm the buffer.             */
+         (*TransportPort->StartRx)(BufferIndex, RxBuffer[BufferIndex], HCI_DMA_RX_BUFFER_SIZE);
+      }
+   }
+}
+
+   /* The following function is called by the port layer when the       */
+   /* transmit DMA finished.  The other buffer is started if data was   */
+   /* queued in it in the mean time.                                    */
+void HCIDMA_TxComplete(void)
+{
+   if(TxActiveIndex >= 0)
+   {
+      TransportStatistics.TxBytes += TxLength[TxActiveIndex];
+      TxLength[TxActiveIndex]      = 0;
+
+      if(TxLength[TxFillIndex])
+      {
+         TxActiveIndex = (int)TxFillIndex;
+         TxFillIndex  ^= 1;
+
+         (*TransportPort->StartTx)(TxBuffer[TxActiveIndex], TxLength[TxActiveIndex]);
+      }
+      else
+         TxActiveIndex = -1;
+   }
+}
+
+   /* The following function is called once per interrupt so that the   */
+   /* interrupt load per byte can be measured.                          */
+void HCIDMA_CountInterrupt(void)
+{
+   TransportStatistics.Interrupts++;
+}
+
+   /* The following function delivers all filled receive buffers (in the */
+   /* order they were filled) and re-arms them.  This function must be  */
+   /* called from the main loop, never from an interrupt handler.       */
+void HCIDMA_Process(void)
+{
+   while(RxReady[NextRxIndex])
+   {
+      TrackPackets(RxLength[NextRxIndex], RxBuffer[NextRxIndex]);
+
+      METRICS_ADD(mcHCIRxBytes, RxLength[NextRxIndex]);
+
+      BTSnoop_CaptureData(BTSNOOP_DIRECTION_RECEIVED, RxLength[NextRxIndex], RxBuffer[NextRxIndex]);
+
+      /* Hand the buffer itself to the stack (no copy is made).         */
+      if(DeliverFunction)
+         (*DeliverFunction)(RxLength[NextRxIndex], RxBuffer[NextRxIndex], DeliverParameter);
+
+      /* The buffer is free again, arm it for the next reception.       */
+      (*TransportPort->Lock)();
+
+      RxReady[NextRxIndex] = 0;
+
+      (*TransportPort->StartRx)(NextRxIndex, RxBuffer[NextRxIndex], HCI_DMA_RX_BUFFER_SIZE);
+
+      (*TransportPort->Unlock)();
+
+      NextRxIndex ^= 1;
+   }
+}
+
+   /* The following function queues data for transmission.  The data is */
+   /* copied into the transmit buffer that is not currently being sent. */
+   /* This function returns the number of bytes that were queued, which */
+   /* may be less than Length if both transmit buffers are in use.      */
+unsigned int HCIDMA_Write(unsigned int Length, unsigned char *Buffer)
+{
+   unsigned int ret_val;
+
+   (*TransportPort->Lock)();
+
+   ret_val = HCI_DMA_TX_BUFFER_SIZE - TxLength[TxFillIndex];
+   if(ret_val > Length)
+      ret_val = Length;
+
+   if(ret_val)
+   {
+      memcpy(&(TxBuffer[TxFillIndex][TxLength[TxFillIndex]]), Buffer, ret_val);
+
+      TxLength[TxFillIndex] += ret_val;
+
+      METRICS_ADD(mcHCITxBytes, ret_val);
+      METRICS_WATERMARK(mwHCITxQueue, TxLength[0] + TxLength[1]);
+
+      /* Start sending right away if the DMA is idle.                   */
+      if(TxActiveIndex < 0)
+      {
+         TxActiveIndex = (int)TxFillIndex;
+         TxFillIndex  ^= 1;
+
+         (*TransportPort->StartTx)(TxBuffer[TxActiveIndex], TxLength[TxActiveIndex]);
+      }
+   }
+   else
+      TransportStatistics.TxWaits++;
+
+   (*TransportPort->Unlock)();
+
+   if(ret_val)
+      BTSnoop_CaptureData(BTSNOOP_DIRECTION_SENT, ret_val, Buffer);
+
+   return(ret_val);
+}
+
+   /* The following function returns non-zero if no data is queued or   */
+   /* being transmitted.                                                */
+int HCIDMA_TxIdle(void)
+{
+   return((TxActiveIndex < 0) && (!TxLength[TxFillIndex]));
+}
+
+   /* The following function returns the transport statistics.          */
+void HCIDMA_QueryStatistics(HCIDMA_Statistics_t *Statistics)
+{
+   if(Statistics)
+      *Statistics = TransportStatistics;
+}
@@ -0,0 +1,113 @@
+/*****< hcidma.h >*************************************************************/
+/*                                                                            */
+/*  HCIDMA - Double buffered (ping-pong) HCI UART transport core.  This       */
+/*           module holds the buffer management of the DMA driven HCI         */
+/*           transport and is independent of the hardware, it is driven by a  */
+/*           port layer (the uDMA of the TM4C in HCITRDMA.c or a simulated    */
+/*           UART on the host).                                               */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __HCIDMAH__
+#define __HCIDMAH__
+
+#define HCI_DMA_NUMBER_BUFFERS                      (2)  /* Denotes the number */
+                                                         /* of RX and TX      */
+                                                         /* buffers (ping and */
+                                                         /* pong).            */
+
+#ifndef HCI_DMA_RX_BUFFER_SIZE
+
+#define HCI_DMA_RX_BUFFER_SIZE                    (256)  /* Denotes the size of*/
+                                                         /* each receive      */
+                                                         /* buffer.  Must not */
+                                                         /* exceed 1024 (max  */
+                                                         /* uDMA transfer).   */
+
+#endif
+
+#ifndef HCI_DMA_TX_BUFFER_SIZE
+
+#define HCI_DMA_TX_BUFFER_SIZE                    (256)  /* Denotes the size of*/
+                                                         /* each transmit     */
+                                                         /* buffer.  Must not */
+                                                         /* exceed 1024 (max  */
+                                                         /* uDMA transfer).   */
+
+#endif
+
+   /* The following structure holds the functions that a port layer     */
+   /* provides to the core.  StartRx() (re-)arms the receive DMA of the */
+   /* specified buffer, StartTx() starts transmitting the specified     */
+   /* data and Lock()/Unlock() protect the state that is shared with the*/
+   /* interrupt handlers (normally by masking the UART interrupt).      */
+typedef struct _tagHCIDMA_Port_t
+{
+   void (*StartRx)(unsigned int BufferIndex, unsigned char *Buffer, unsigned int Length);
+   void (*StartTx)(unsigned char *Buffer, unsigned int Length);
+   void (*Lock)(void);
+   void (*Unlock)(void);
+} HCIDMA_Port_t;
+
+   /* The following type definition represents the function that       */
+   /* receives the data of a filled receive buffer.  The buffer is      */
+   /* passed directly (no copy is made) and is re-armed as soon as this */
+   /* function returns.                                                 */
+typedef void (*HCIDMA_Deliver_t)(unsigned int DataLength, unsigned char *DataBuffer, unsigned long CallbackParameter);
+
+   /* The following structure holds the statistics of the transport.     */
+   /* Idle Line Handoffs are receive buffers that were handed off before*/
+   /* they were full because the line went idle, Rx Stalls count the    */
+   /* times both receive buffers were waiting to be delivered (the      */
+   /* controller is then held off by RTS) and Tx Waits count the times a*/
+   /* write had to wait for a free transmit buffer.  Packets and Framing*/
+   /* Errors are counted by following the H4 packet headers in the      */
+   /* received data.                                                    */
+typedef struct _tagHCIDMA_Statistics_t
+{
+   unsigned long RxBytes;
+   unsigned long TxBytes;
+   unsigned long Interrupts;
+   unsigned long RxHandoffs;
+   unsigned long IdleLineHandoffs;
+   unsigned long RxStalls;
+   unsigned long TxWaits;
+   unsigned long Packets;
+   unsigned long FramingErrors;
+} HCIDMA_Statistics_t;
+
+   /* The following function initializes the core and arms both receive */
+   /* buffers through the port.  The Deliver function is called from    */
+   /* HCIDMA_Process() with each filled receive buffer.                 */
+void HCIDMA_Initialize(HCIDMA_Port_t *Port, HCIDMA_Deliver_t Deliver, unsigned long CallbackParameter);
+
+   /* The following functions are called by the port layer from its     */
+   /* interrupt handler.  HCIDMA_RxComplete() is called when the receive*/
+   /* DMA of a buffer stopped, either because the buffer is full or     */
+   /* because the line went idle (IdleLine is non-zero and Length is the*/
+   /* number of bytes that were received).  HCIDMA_TxComplete() is      */
+   /* called when the transmit DMA finished.  HCIDMA_CountInterrupt() is*/
+   /* called once per interrupt so that the interrupt load per byte can */
+   /* be measured.                                                      */
+void HCIDMA_RxComplete(unsigned int BufferIndex, unsigned int Length, int IdleLine);
+void HCIDMA_TxComplete(void);
+void HCIDMA_CountInterrupt(void);
+
+   /* The following function delivers all filled receive buffers (in the */
+   /* order they were filled) and re-arms them.  This function must be  */
+   /* called from the main loop, never from an interrupt handler.       */
+void HCIDMA_Process(void);
+
+   /* The following function queues data for transmission.  The data is */
+   /* copied into the transmit buffer that is not currently being sent. */
+   /* This function returns the number of bytes that were queued, which */
+   /* may be less than Length if both transmit buffers are in use.      */
+unsigned int HCIDMA_Write(unsigned int Length, unsigned char *Buffer);
+
+   /* The following function returns non-zero if no data is queued or   */
+   /* being transmitted.                                                */
+int HCIDMA_TxIdle(void);
+
+   /* The following function returns the transport statistics.          */
+void HCIDMA_QueryStatistics(HCIDMA_Statistics_t *Statistics);
+
+#endif
@@ -0,0 +1,459 @@
+/*****< hcitrdma.c >***********************************************************/
+/*                                                                            */
+/*  HCITRDMA - uDMA driven HCI UART Transport for the TM4C123 (replaces the   */
+/*             interrupt per FIFO threshold HCITRANS.c of the SDK).           */
+/*                                                                            */
+/*  Received data is written by the uDMA (ping-pong mode) directly into two   */
+/*  receive buffers that are handed to the stack without being copied.  The   */
+/*  UART receive timeout (idle line) interrupt hands off a partially filled   */
+/*  buffer so that the end of a packet is never held back.  Transmit data is  */
+/*  double buffered so that the stack can queue data while the previous       */
+/*  buffer is being sent.                                                     */
+/*                                                                            */
+/******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_uart.h"
+#include "inc/hw_ints.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/gpio.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/uart.h"
+#include "driverlib/udma.h"
+#include "driverlib/interrupt.h"
+
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+#include "HCITRANS.h"      /* HCI Transport Prototypes/Constants.             */
+#include "HCIDMA.h"        /* HCI DMA Transport Core Prototypes/Constants.    */
+#include "UDMATable.h"     /* Shared uDMA Control Table Prototypes.           */
+
+   /* The following constants define the hardware that is used for the  */
+   /* HCI UART.  The defaults match the CC256x EM adapter on the        */
+   /* DK-TM4C123G, they may be overridden on the compiler command line  */
+   /* (and must match the pin usage of the board's HALCFG.h).           */
+#ifndef HCI_DMA_UART_BASE
+
+#define HCI_DMA_UART_BASE                          UART1_BASE
+#define HCI_DMA_UART_INT                           INT_UART1
+#define HCI_DMA_UART_PERIPH                        SYSCTL_PERIPH_UART1
+#define HCI_DMA_RX_CHANNEL                         UDMA_CHANNEL_UART1RX
+#define HCI_DMA_TX_CHANNEL                         UDMA_CHANNEL_UART1TX
+
+#define HCI_DMA_UART_GPIO_PERIPH                   SYSCTL_PERIPH_GPIOC
+#define HCI_DMA_UART_GPIO_BASE                     GPIO_PORTC_BASE
+#define HCI_DMA_UART_RX_PIN                        GPIO_PIN_4
+#define HCI_DMA_UART_RX_PIN_CONFIG                 GPIO_PC4_U1RX
+#define HCI_DMA_UART_TX_PIN                        GPIO_PIN_5
+#define HCI_DMA_UART_TX_PIN_CONFIG                 GPIO_PC5_U1TX
+
+#define HCI_DMA_FLOW_GPIO_PERIPH                   SYSCTL_PERIPH_GPIOF
+#define HCI_DMA_FLOW_GPIO_BASE                     GPIO_PORTF_BASE
+#define HCI_DMA_UART_RTS_PIN                       GPIO_PIN_0
+#define HCI_DMA_UART_RTS_PIN_CONFIG                GPIO_PF0_U1RTS
+#define HCI_DMA_UART_CTS_PIN                       GPIO_PIN_1
+#define HCI_DMA_UART_CTS_PIN_CONFIG                GPIO_PF1_U1CTS
+
+#define HCI_DMA_RESET_GPIO_PERIPH                  SYSCTL_PERIPH_GPIOH
+#define HCI_DMA_RESET_GPIO_BASE                    GPIO_PORTH_BASE
+#define HCI_DMA_RESET_PIN                          GPIO_PIN_4
+
+#endif
+
+#define HCI_DMA_RESET_DELAY                          (10)  /* Denotes the time */
+                                                         /* (in ms) the       */
+                                                         /* controller is held*/
+                                                         /* in reset.         */
+
+#define TRANSPORT_ID                                  (1)  /* Denotes the ID    */
+                                                         /* that is returned  */
+                                                         /* to the stack.     */
+
+   /* The following macro returns the uDMA control structure select for  */
+   /* the specified buffer (the first buffer uses the primary structure */
+   /* and the second the alternate structure).                          */
+#define DMA_STRUCTURE_SELECT(_x)                   ((_x)?UDMA_ALT_SELECT:UDMA_PRI_SELECT)
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static Boolean_t               TransportOpen;       /* Variable which flags whether the*/
+                                                    /* transport is currently open.    */
+
+static HCITR_COMDataCallback_t COMDataCallback;     /* Variables which hold the        */
+static unsigned long           COMCallbackParameter; /* function (and its parameter)   */
+                                                    /* that receives the HCI data.     */
+
+static unsigned char          *RxBufferList[HCI_DMA_NUMBER_BUFFERS]; /* Variable which */
+                                                    /* holds the buffer that is armed  */
+                                                    /* on each uDMA control structure. */
+
+static unsigned int            RxBufferLength[HCI_DMA_NUMBER_BUFFERS]; /* Variable     */
+                                                    /* which holds the size of each    */
+                                                    /* armed buffer.                   */
+
+static volatile unsigned char  RxArmed[HCI_DMA_NUMBER_BUFFERS]; /* Variable which flags*/
+                                                    /* the control structures that hold*/
+                                                    /* an armed buffer.                */
+
+static volatile unsigned int   RxActiveIndex;       /* Variable which holds the index  */
+                                                    /* of the buffer that the uDMA is  */
+                                                    /* currently filling.              */
+
+static volatile Boolean_t      TxBusy;              /* Variable which flags that the   */
+                                                    /* transmit uDMA is running.       */
+
+static unsigned long           Overruns;            /* Variable which counts receive   */
+                                                    /* FIFO overruns.                  */
+
+   /* Internal function prototypes.                                     */
+static void PortStartRx(unsigned int BufferIndex, unsigned char *Buffer, unsigned int Length);
+static void PortStartTx(unsigned char *Buffer, unsigned int Length);
+static void PortLock(void);
+static void PortUnlock(void);
+static void DeliverData(unsigned int DataLength, unsigned char *DataBuffer, unsigned long CallbackParameter);
+static void HandleIdleLine(void);
+
+   /* The following structure holds the port functions that are passed  */
+   /* to the transport core.                                            */
+static HCIDMA_Port_t DMAPort =
+{
+   PortStartRx,
+   PortStartTx,
+   PortLock,
+   PortUnlock
+};
+
+   /* The following function arms the specified uDMA control structure  */
+   /* with the specified receive buffer.  If the receive uDMA stopped   */
+   /* because no buffer was available it is restarted on this buffer.   */
+static void PortStartRx(unsigned int BufferIndex, unsigned char *Buffer, unsigned int Length)
+{
+   RxBufferList[BufferIndex]   = Buffer;
+   RxBufferLength[BufferIndex] = Length;
+
+   uDMAChannelTransferSet(HCI_DMA_RX_CHANNEL | DMA_STRUCTURE_SELECT(BufferIndex), UDMA_MODE_PINGPONG, (void *)(HCI_DMA_UART_BASE + UART_O_DR), Buffer, Length);
+
+   RxArmed[BufferIndex] = 1;
+
+   if(!RxArmed[RxActiveIndex])
+   {
+      /* The uDMA stalled (both buffers were waiting to be delivered),  */
+      /* make this buffer the active one and restart it.  The receive   */
+      /* timeout interrupt was masked while stalled.                    */
+      if(BufferIndex)
+         uDMAChannelAttributeEnable(HCI_DMA_RX_CHANNEL, UDMA_ATTR_ALTSELECT);
+      else
+         uDMAChannelAttributeDisable(HCI_DMA_RX_CHANNEL, UDMA_ATTR_ALTSELECT);
+
+      RxActiveIndex = BufferIndex;
+   }
+
+   if(!uDMAChannelIsEnabled(HCI_DMA_RX_CHANNEL))
+   {
+      uDMAChannelEnable(HCI_DMA_RX_CHANNEL);
+
+      UARTIntEnable(HCI_DMA_UART_BASE, UART_INT_RT);
+   }
+}
+
+   /* The following function starts transmitting the specified buffer.  */
+static void PortStartTx(unsigned char *Buffer, unsigned int Length)
+{
+   TxBusy = TRUE;
+
+   uDMAChannelTransferSet(HCI_DMA_TX_CHANNEL | UDMA_PRI_SELECT, UDMA_MODE_BASIC, Buffer, (void *)(HCI_DMA_UART_BASE + UART_O_DR), Length);
+   uDMAChannelEnable(HCI_DMA_TX_CHANNEL);
+}
+
+   /* The following functions protect the transport state that is       */
+   /* shared with the interrupt handler.  The uDMA completion interrupts*/
+   /* of the UART channels are delivered on the UART vector so masking  */
+   /* it is sufficient.                                                 */
+static void PortLock(void)
+{
+   IntDisable(HCI_DMA_UART_INT);
+}
+
+static void PortUnlock(void)
+{
+   if(TransportOpen)
+      IntEnable(HCI_DMA_UART_INT);
+}
+
+   /* The following function hands a filled receive buffer to the stack. */
+static void DeliverData(unsigned int DataLength, unsigned char *DataBuffer, unsigned long CallbackParameter)
+{
+   if(COMDataCallback)
+      (*COMDataCallback)(TRANSPORT_ID, DataLength, DataBuffer, COMCallbackParameter);
+}
+
+   /* The following function is called from the interrupt handler when   */
+   /* the receive line went idle with data left in the FIFO.  The uDMA  */
+   /* only moves data in bursts of 8 bytes so the tail of a packet      */
+   /* remains in the FIFO; it is moved into the active buffer by the CPU*/
+   /* and the buffer is handed off immediately.                         */
+static void HandleIdleLine(void)
+{
+   unsigned int  Index;
+   unsigned int  Received;
+
+   Index = RxActiveIndex;
+
+   if(RxArmed[Index])
+   {
+      uDMAChannelDisable(HCI_DMA_RX_CHANNEL);
+
+      /* Determine how much the uDMA has written into the buffer and    */
+      /* append whatever is left in the FIFO.                           */
+      Received = RxBufferLength[Index] - uDMAChannelSizeGet(HCI_DMA_RX_CHANNEL | DMA_STRUCTURE_SELECT(Index));
+
+      while((Received < RxBufferLength[Index]) && (UARTCharsAvail(HCI_DMA_UART_BASE)))
+         RxBufferList[Index][Received++] = (unsigned char)UARTCharGetNonBlocking(HCI_DMA_UART_BASE);
+
+      if(Received)
+      {
+         /* Retire this structure and continue on the other buffer.     */
+         uDMAChannelTransferSet(HCI_DMA_RX_CHANNEL | DMA_STRUCTURE_SELECT(Index), UDMA_MODE_STOP, (void *)(HCI_DMA_UART_BASE + UART_O_DR), RxBufferList[Index], 1);
+
+         RxArmed[Index] = 0;
+         RxActiveIndex  = Index ^ 1;
+
+         if(RxActiveIndex)
+            uDMAChannelAttributeEnable(HCI_DMA_RX_CHANNEL, UDMA_ATTR_ALTSELECT);
+         else
+            uDMAChannelAttributeDisable(HCI_DMA_RX_CHANNEL, UDMA_ATTR_ALTSELECT);
+
+         HCIDMA_RxComplete(Index, Received, 1);
+      }
+
+      if(RxArmed[RxActiveIndex])
+         uDMAChannelEnable(HCI_DMA_RX_CHANNEL);
+   }
+
+   /* If no buffer is left the data stays in the FIFO (and the          */
+   /* controller is held off by RTS) until a buffer has been delivered, */
+   /* the receive timeout is masked so it does not fire continuously.   */
+   if(!RxArmed[RxActiveIndex])
+      UARTIntDisable(HCI_DMA_UART_BASE, UART_INT_RT);
+}
+
+   /* The following function is the UART interrupt handler of the HCI   */
+   /* UART (it is referenced by the vector table).  It handles the uDMA  */
+   /* completion of both directions as well as the receive timeout.     */
+void HCITR_UARTIntHandler(void)
+{
+   uint32_t Status;
+
+   Status = UARTIntStatus(HCI_DMA_UART_BASE, true);
+   UARTIntClear(HCI_DMA_UART_BASE, Status);
+
+   HCIDMA_CountInterrupt();
+
+   if(Status & UART_INT_OE)
+      Overruns++;
+
+   /* Hand off every receive buffer that the uDMA filled completely (in */
+   /* the order they were filled).                                      */
+   while((RxArmed[RxActiveIndex]) && (uDMAChannelModeGet(HCI_DMA_RX_CHANNEL | DMA_STRUCTURE_SELECT(RxActiveIndex)) == UDMA_MODE_STOP))
+   {
+      RxArmed[RxActiveIndex] = 0;
+      RxActiveIndex         ^= 1;
+
+      HCIDMA_RxComplete(RxActiveIndex ^ 1, RxBufferLength[RxActiveIndex ^ 1], 0);
+   }
+
+   if(Status & UART_INT_RT)
+      HandleIdleLine();
+
+   /* Check to see if the transmit uDMA finished.                       */
+   if((TxBusy) && (!uDMAChannelIsEnabled(HCI_DMA_TX_CHANNEL)))
+   {
+      TxBusy = FALSE;
+
+      HCIDMA_TxComplete();
+   }
+}
+
+   /* The following function is responsible for opening the HCI         */
+   /* Transport layer that will be used by Bluetopia to send and receive*/
+   /* COM (Serial) data.  This function must be successfully issued in  */
+   /* order for Bluetopia to function.  This function returns a positive*/
+   /* Transport ID on success or a negative error code on failure.      */
+int BTPSAPI HCITR_COMOpen(HCI_COMMDriverInformation_t *COMMDriverInformation, HCITR_COMDataCallback_t COMDataCallbackFunction, unsigned long CallbackParameter)
+{
+   int ret_val;
+
+   if((!TransportOpen) && (COMMDriverInformation) && (COMDataCallbackFunction))
+   {
+      COMDataCallback      = COMDataCallbackFunction;
+      COMCallbackParameter = CallbackParameter;
+
+      SysCtlPeripheralEnable(HCI_DMA_UART_PERIPH);
+      SysCtlPeripheralEnable(HCI_DMA_UART_GPIO_PERIPH);
+      SysCtlPeripheralEnable(HCI_DMA_FLOW_GPIO_PERIPH);
+      SysCtlPeripheralEnable(HCI_DMA_RESET_GPIO_PERIPH);
+
+      /* Hold the controller in reset while the UART is configured.     */
+      GPIOPinTypeGPIOOutput(HCI_DMA_RESET_GPIO_BASE, HCI_DMA_RESET_PIN);
+      GPIOPinWrite(HCI_DMA_RESET_GPIO_BASE, HCI_DMA_RESET_PIN, 0);
+
+      GPIOPinConfigure(HCI_DMA_UART_RX_PIN_CONFIG);
+      GPIOPinConfigure(HCI_DMA_UART_TX_PIN_CONFIG);
+      GPIOPinConfigure(HCI_DMA_UART_RTS_PIN_CONFIG);
+      GPIOPinConfigure(HCI_DMA_UART_CTS_PIN_CONFIG);
+      GPIOPinTypeUART(HCI_DMA_UART_GPIO_BASE, HCI_DMA_UART_RX_PIN | HCI_DMA_UART_TX_PIN);
+      GPIOPinTypeUART(HCI_DMA_FLOW_GPIO_BASE, HCI_DMA_UART_RTS_PIN | HCI_DMA_UART_CTS_PIN);
+
+      UARTConfigSetExpClk(HCI_DMA_UART_BASE, SysCtlClockGet(), COMMDriverInformation->BaudRate, (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
+      UARTFlowControlSet(HCI_DMA_UART_BASE, (UART_FLOWCONTROL_TX | UART_FLOWCONTROL_RX));
+
+      /* The receive uDMA uses bursts of 8 bytes (half the FIFO), any   */
+      /* remainder is collected on the receive timeout.                 */
+      UARTFIFOLevelSet(HCI_DMA_UART_BASE, UART_FIFO_TX4_8, UART_FIFO_RX4_8);
+      UARTFIFOEnable(HCI_DMA_UART_BASE);
+
+      /* The console may have set up the uDMA controller already.       */
+      UDMATable_Enable();
+
+      uDMAChannelAttributeDisable(HCI_DMA_RX_CHANNEL, UDMA_ATTR_ALL);
+      uDMAChannelAttributeEnable(HCI_DMA_RX_CHANNEL, UDMA_ATTR_USEBURST);
+      uDMAChannelControlSet(HCI_DMA_RX_CHANNEL | UDMA_PRI_SELECT, (UDMA_SIZE_8 | UDMA_SRC_INC_NONE | UDMA_DST_INC_8 | UDMA_ARB_8));
+      uDMAChannelControlSet(HCI_DMA_RX_CHANNEL | UDMA_ALT_SELECT, (UDMA_SIZE_8 | UDMA_SRC_INC_NONE | UDMA_DST_INC_8 | UDMA_ARB_8));
+
+      uDMAChannelAttributeDisable(HCI_DMA_TX_CHANNEL, UDMA_ATTR_ALL);
+      uDMAChannelControlSet(HCI_DMA_TX_CHANNEL | UDMA_PRI_SELECT, (UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_4));
+
+      RxArmed[0]    = 0;
+      RxArmed[1]    = 0;
+      RxActiveIndex = 0;
+      TxBusy        = FALSE;
+      Overruns      = 0;
+
+      /* Arm both receive buffers and enable the UART.                  */
+      HCIDMA_Initialize(&DMAPort, DeliverData, 0);
+
+      UARTDMAEnable(HCI_DMA_UART_BASE, (UART_DMA_RX | UART_DMA_TX));
+      UARTIntEnable(HCI_DMA_UART_BASE, (UART_INT_RT | UART_INT_OE));
+      UARTEnable(HCI_DMA_UART_BASE);
+
+      TransportOpen = TRUE;
+
+      IntEnable(HCI_DMA_UART_INT);
+
+      /* Release the controller from reset.                             */
+      BTPS_Delay(HCI_DMA_RESET_DELAY);
+
+      GPIOPinWrite(HCI_DMA_RESET_GPIO_BASE, HCI_DMA_RESET_PIN, HCI_DMA_RESET_PIN);
+
+      ret_val = TRANSPORT_ID;
+   }
+   else
+      ret_val = HCITR_ERROR_UNABLE_TO_OPEN_TRANSPORT;
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for closing the specific HCI*/
+   /* Transport layer that was opened via a successful call to the      */
+   /* HCITR_COMOpen() function.  The controller is placed back in reset.*/
+void BTPSAPI HCITR_COMClose(unsigned int HCITransportID)
+{
+   if((TransportOpen) && (HCITransportID == TRANSPORT_ID))
+   {
+      TransportOpen = FALSE;
+
+      IntDisable(HCI_DMA_UART_INT);
+
+      UARTIntDisable(HCI_DMA_UART_BASE, (UART_INT_RT | UART_INT_OE));
+      UARTDMADisable(HCI_DMA_UART_BASE, (UART_DMA_RX | UART_DMA_TX));
+
+      uDMAChannelDisable(HCI_DMA_RX_CHANNEL);
+      uDMAChannelDisable(HCI_DMA_TX_CHANNEL);
+
+      UARTDisable(HCI_DMA_UART_BASE);
+
+      GPIOPinWrite(HCI_DMA_RESET_GPIO_BASE, HCI_DMA_RESET_PIN, 0);
+
+      COMDataCallback = NULL;
+   }
+}
+
+   /* The following function is responsible for instructing the         */
+   /* specified HCI Transport layer (that was opened via a successful   */
+   /* call to the HCITR_COMOpen() function) to reconfigure itself with  */
+   /* the specified information.  Only a change of the baud rate is     */
+   /* supported, it is made once all queued data has been sent.         */
+void BTPSAPI HCITR_COMReconfigure(unsigned int HCITransportID, HCI_Driver_Reconfigure_Data_t *DriverReconfigureData)
+{
+   HCI_COMMReconfigureInformation_t *ReconfigureInformation;
+
+   if((TransportOpen) && (HCITransportID == TRANSPORT_ID) && (DriverReconfigureData) && (DriverReconfigureData->ReconfigureCommand == HCI_COMM_DRIVER_RECONFIGURE_DATA_COMMAND_CHANGE_PARAMETERS) && (DriverReconfigureData->ReconfigureData))
+   {
+      ReconfigureInformation = (HCI_COMMReconfigureInformation_t *)DriverReconfigureData->ReconfigureData;
+
+      if(ReconfigureInformation->ReconfigureFlags & HCI_COMM_RECONFIGURE_INFORMATION_RECONFIGURE_FLAGS_CHANGE_BAUDRATE)
+      {
+         /* Wait for the transmit buffers and the UART to drain.        */
+         while((!HCIDMA_TxIdle()) || (UARTBusy(HCI_DMA_UART_BASE)))
+            ;
+
+         UARTConfigSetExpClk(HCI_DMA_UART_BASE, SysCtlClockGet(), ReconfigureInformation->BaudRate, (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
+      }
+   }
+}
+
+   /* The following function is responsible for actually sending data   */
+   /* through the opened HCI Transport layer.  The data is copied into  */
+   /* the transmit buffers, this function only waits if both buffers    */
+   /* are in use.  This function returns zero if successful or a        */
+   /* negative return error code if there was an error.                 */
+int BTPSAPI HCITR_COMWrite(unsigned int HCITransportID, unsigned int Length, unsigned char *Buffer)
+{
+   int          ret_val;
+   unsigned int Queued;
+
+   if((TransportOpen) && (HCITransportID == TRANSPORT_ID) && (Length) && (Buffer))
+   {
+      while(Length)
+      {
+         Queued  = HCIDMA_Write(Length, Buffer);
+
+         Buffer += Queued;
+         Length -= Queued;
+      }
+
+      ret_val = 0;
+   }
+   else
+      ret_val = HCITR_ERROR_WRITING_TO_PORT;
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for suspending the HCI      */
+   /* Transport layer (for HCILL sleep).  This function returns zero if */
+   /* all data has been sent and the transport may be suspended, or a   */
+   /* negative value if data is still being sent.                       */
+int BTPSAPI HCITR_COMSuspend(unsigned int HCITransportID)
+{
+   int ret_val;
+
+   if((TransportOpen) && (HCITransportID == TRANSPORT_ID) && (HCIDMA_TxIdle()) && (!UARTBusy(HCI_DMA_UART_BASE)))
+      ret_val = 0;
+   else
+      ret_val = HCITR_ERROR_WRITING_TO_PORT;
+
+   return(ret_val);
+}
+
+   /* The following function is called from the main loop of the stack  */
+   /* scheduler to deliver the received data to the stack.              */
+void BTPSAPI HCITR_COMProcess(unsigned int HCITransportID)
+{
+   if((TransportOpen) && (HCITransportID == TRANSPORT_ID))
+      HCIDMA_Process();
+}
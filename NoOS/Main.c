@@ -3,6 +3,23 @@
 #include <GATTAPI.h>
 #include <SDPAPI.h>
 #include "../Main.h"                /* Main application header.                  */
+#include "../PeerCache.h"           /* Peer paging information cache.            */
+#include "../Recovery.h"            /* Retry/backoff of failed operations.       */
+#include "../BootSeq.h"             /* Boot phase timing.                        */
+#include "../BTSnoop.h"             /* HCI traffic capture.                      */
+#include "../Profile.h"             /* Handler latency profiling.                */
+#include "../StackMark.h"           /* Stack high watermark.                     */
+#include "../GATTUUID.h"            /* Compile-time GATT UUIDs.                  */
+#include "../Advertise.h"           /* LE advertising manager.                   */
+#include "../Scan.h"                /* LE scanner.                               */
+#include "../ConnParam.h"           /* LE connection parameter policy.           */
+#include "../GATTClient.h"          /* GATT client discovery cache.              */
+#include "../GATTDatabase.h"        /* GATT Database Hash and Service Changed.   */
+#include "../GATTLong.h"            /* Long attribute reads and prepared writes. */
+#include "../Sniff.h"               /* Sniff mode of the idle HFP link.          */
+#include "../Coroutine.h"           /* Awaited stack operations.                 */
+#include "../Metrics.h"             /* Runtime counters.                         */
+#include "ConsoleTRDMA.h"           /* DMA fed console input.                    */
 #include "HAL.h"                 /* Function for Hardware Abstraction.        */
 #include "HALCFG.h"              /* HAL Configuration Constants.              */
 
@@ -10,6 +27,29 @@ int configureBTStack();
 
 void configureGATT(int bluetoothStackID);
 
+void configureAdvertising(int bluetoothStackID);
+
+int bringUpBTStack(unsigned long callbackParameter);
+
+void printRecoveryTime();
+
+void consoleLine(char *line, unsigned int length, unsigned long callbackParameter);
+
+unsigned long long snoopTimestamp();
+
+// set by errorFunc() when any step of the stack bring-up fails
+bool bringUpFailed = false;
+
+int btStackId = 0;
+
+// BR/EDR name and the name in the LE scan response
+#define LOCAL_DEVICE_NAME "Bluetooth rulez"
+
+// section names of the latency and stack measurements, those are keyed by address so every stop of a section uses the same array
+const char gattServiceCallbackName[] = "GATTServiceCallback";
+const char gattConnectionCallbackName[] = "gattConnectionCallback";
+const char onPairRequestName[] = "onPairRequest";
+
 int main(void)
 {
    /* Configure the hardware for its intended use.                      */
@@ -17,194 +57,670 @@ int main(void)
 
    printf("HardwareConfigured\n");
 
-   int btStackId = configureBTStack();
+   // the uDMA fills the console ring, so a burst of scripted commands is not lost while one runs
+   ConsoleTR_Open(consoleLine, 0);
+
+   // cycle counter for the handler latency histograms (compiled out unless PROFILE_ENABLE)
+   PROFILE_INITIALIZE();
 
-    configureGATT(btStackId);
+   // cheap enough to leave on, drained with the SNOOP command or the snoop characteristic
+   BTSnoop_Initialize(snoopTimestamp, BTSNOOP_DEFAULT_TRUNCATION);
+
+   // instead of halting, keep retrying the bring-up with backoff
+   if(bringUpBTStack(0) < 0){
+       printf("Bluetooth bring-up failed, retrying!\n");
+       Recovery_Start(RECOVERY_ID_STACK, bringUpBTStack, 0, 0);
+   }
 
    while(1)
    {
       HAL_LedToggle(0);
 
+      /* Run any retries that are due (stack bring-up, AG reconnect).   */
+      bool stackRecovering = Recovery_InProgress(RECOVERY_ID_STACK);
+
+      Recovery_Process();
+
+      if(stackRecovering && !Recovery_InProgress(RECOVERY_ID_STACK))
+          printRecoveryTime();
+
+      /* Write back any paging information learned since the last pass. */
+      PeerCache_Flush();
+
+#ifdef GATT_CLIENT_ENABLE
+
+      /* Write back the databases of peers discovered since then.       */
+      GATTClient_Flush();
+
+#endif
+
+      /* Write back Service Changed subscriptions and pending changes.  */
+      GATTDatabase_Flush();
+
+      /* Fast/slow advertising switch and restart after a lost link.    */
+      Advertise_Process();
+
+#ifdef SCAN_ENABLE
+
+      /* Scanner RSSI windows, lost devices and bloom filter rotation.  */
+      Scan_Process();
+
+#endif
+
+      /* Ask for short intervals while links are busy, relax idle ones. */
+      ConnParam_Process();
+
+      /* Put the idle link to the AG into sniff mode.                   */
+      Sniff_Process();
+
+      /* Time out the stack operations whose events never came.         */
+      Coroutine_Process();
+
+      /* Run the console commands received since the last pass.         */
+      ConsoleTR_Process();
+
       BTPS_Delay(100);
    }
 }
 
 void errorFunc() {
-    while(1);
+    bringUpFailed = true;
+}
+
+int bringUpBTStack(unsigned long callbackParameter) {
+    bringUpFailed = false;
+
+    btStackId = configureBTStack();
+
+    if(!bringUpFailed){
+        configureGATT(btStackId);
+        BootSeq_MarkPhase("GATT", 0);
+    }
+
+    // needs the service UUIDs, so only after the GATT service is up
+    if(!bringUpFailed){
+        configureAdvertising(btStackId);
+        BootSeq_MarkPhase("Advertising", 0);
+    }
+
+    if(bringUpFailed){
+        // start from scratch on the next attempt
+        Advertise_Cleanup();
+        ConnParam_Cleanup();
+#ifdef GATT_CLIENT_ENABLE
+        GATTClient_Cleanup();
+#endif
+        GATTDatabase_Cleanup();
+        GATTLong_Cleanup();
+
+        if(btStackId > 0)
+            CloseApplication();
+
+        btStackId = 0;
+        return -1;
+    }
+
+    // phases that went over budget are flagged, so boot time regressions show up on the console
+    BootSeq_Display();
+
+    return 1;
+}
+
+// no real time clock on the board, so the capture starts at 1970 + uptime
+unsigned long long snoopTimestamp() {
+    return (unsigned long long)HAL_GetTickCount() * 1000ULL;
+}
+
+// the line is handed over in the receive ring, the interpreter tokenizes it in place
+void consoleLine(char *line, unsigned int length, unsigned long callbackParameter) {
+    ProcessCommandLine(line);
+}
+
+void printRecoveryTime() {
+    Recovery_Statistics_t statistics;
+
+    if(Recovery_QueryStatistics(RECOVERY_ID_STACK, &statistics) == 0)
+        printf("Bluetooth recovered after %lu ms (%u attempts in total)\n", statistics.LastTimeToRecover, statistics.Attempts);
+}
+
+// connections that can be subscribed to the value characteristic at the same time (the host simulations raise it)
+#ifndef VALUE_MAXIMUM_SUBSCRIBERS
+#define VALUE_MAXIMUM_SUBSCRIBERS 4
+#endif
+
+// client characteristic configuration of the value per connection, a zero configuration marks a free entry
+typedef struct {
+    unsigned int connectionID;
+    Word_t configuration;
+} valueSubscriber_t;
+
+valueSubscriber_t valueSubscribers[VALUE_MAXIMUM_SUBSCRIBERS];
+
+// entry of the connection, a free entry instead if the connection has none and allocate is set
+valueSubscriber_t *findValueSubscriber(unsigned int connectionID, bool allocate) {
+    valueSubscriber_t *freeEntry = NULL;
+    unsigned int index;
+
+    for(index = 0; index < VALUE_MAXIMUM_SUBSCRIBERS; index++){
+        if(valueSubscribers[index].configuration && valueSubscribers[index].connectionID == connectionID)
+            return &valueSubscribers[index];
+
+        if(!valueSubscribers[index].configuration && !freeEntry)
+            freeEntry = &valueSubscribers[index];
+    }
+
+    return allocate ? freeEntry : NULL;
 }
 
  void gattConnectionCallback(unsigned int BluetoothStackID, GATT_Connection_Event_Data_t *GATT_Connection_Event_Data,
                              unsigned long CallbackParameter){
+     PROFILE_DECLARE(profileStart)
+     STACK_MARK_DECLARE(stackMark)
+     STACK_MARK_START(stackMark);
+     PROFILE_START(profileStart);
+
      printf("GATT connection callback called!");
+
+     if(GATT_Connection_Event_Data)
+         METRICS_COUNT_EVENT(GATTConnectionEvents, GATT_Connection_Event_Data->Event_Data_Type);
+
+     // discovery after the connection and drained notification buffers drive the connection parameters
+     ConnParam_ProcessGATTConnectionEvent(GATT_Connection_Event_Data);
+
+#ifdef GATT_CLIENT_ENABLE
+     // known peers get their database from the cache, Service Changed indications are confirmed there
+     GATTClient_ProcessGATTConnectionEvent(GATT_Connection_Event_Data);
+#endif
+
+     // clients that missed a change of our database get the Service Changed indication now
+     GATTDatabase_ProcessGATTConnectionEvent(GATT_Connection_Event_Data);
+
+     // a subscription to the value ends with the connection
+     if(GATT_Connection_Event_Data && GATT_Connection_Event_Data->Event_Data_Type == etGATT_Connection_Device_Disconnection){
+         valueSubscriber_t *subscriber = findValueSubscriber(GATT_Connection_Event_Data->Event_Data.GATT_Device_Disconnection_Data->ConnectionID, false);
+
+         if(subscriber)
+             subscriber->configuration = 0;
+     }
+
+     PROFILE_STOP(profileStart, gattConnectionCallbackName, GATT_Connection_Event_Data ? GATT_Connection_Event_Data->Event_Data_Type : 0);
+     STACK_MARK_STOP(stackMark, gattConnectionCallbackName, GATT_Connection_Event_Data ? GATT_Connection_Event_Data->Event_Data_Type : 0);
  }
 
 
-void assertGATTInitialized(int result) {
+bool assertGATTInitialized(int result) {
     if(result == 0){
         printf("GATT configured!\n");
-        return;
+        return true;
     }
 
     printf("GATT configuration failed!\n");
     errorFunc();
+    return false;
+}
+
+#ifdef GATT_CLIENT_ENABLE
+bool assertGATTClientOK(int result) {
+    if(result >= 0){
+        printf("GATT client started, %d peers cached!\n", result);
+        return true;
+    }
+
+    printf("GATT client failed : %d!\n", result);
+    errorFunc();
+    return false;
 }
+#endif
 
-void assertRegisterServiceOK(int result) {
+bool assertGATTDatabaseOK(int result) {
+    if(result >= 0){
+        printf("GATT database started, %d clients subscribed!\n", result);
+        return true;
+    }
+
+    printf("GATT database failed : %d!\n", result);
+    errorFunc();
+    return false;
+}
+
+bool assertPublishOK(int result) {
+    if(result >= 0){
+        if(result > 0)
+            printf("GATT database changed, %d clients will be told!\n", result);
+        return true;
+    }
+
+    printf("GATT database publish failed : %d!\n", result);
+    errorFunc();
+    return false;
+}
+
+#ifdef GATT_CLIENT_ENABLE
+void gattClientReady(unsigned int connectionID, BD_ADDR_t bdAddr, Boolean_t cached, unsigned long callbackParameter) {
+    printf("GATT database of connection %u %s!\n", connectionID, cached ? "taken from the cache" : "discovered");
+}
+#endif
+
+bool assertRegisterServiceOK(int result) {
     if(result >= 0){
         printf("Service registration successful!\n");
-        return;
+        return true;
     }
 
     printf("Service registration failed : %d!\n", result);
     errorFunc();
+    return false;
+}
+
+// offset of the characteristic value and of its client characteristic configuration in serviceTable
+#define VALUE_ATTRIBUTE_OFFSET 2
+#define VALUE_CONFIGURATION_ATTRIBUTE_OFFSET 3
+
+// offset of the snoop characteristic value in serviceTable
+#define SNOOP_VALUE_ATTRIBUTE_OFFSET 5
+
+// offset of the configuration blob value in serviceTable
+#define CONFIGURATION_VALUE_ATTRIBUTE_OFFSET 7
+
+// configuration blobs are larger than an ATT MTU, clients read them with Read Blob and write them with prepared writes
+#define CONFIGURATION_MAXIMUM_LENGTH 256
+
+// largest read response we ever send (MTU is queried per connection)
+#define SNOOP_MAXIMUM_READ_LENGTH 64
+
+// offset of the metrics value in serviceTable
+#define METRICS_VALUE_ATTRIBUTE_OFFSET 9
+
+Byte_t metricsValue[METRICS_VALUE_LENGTH];
+
+Byte_t characteristicRawValue;
+
+// the value and its client characteristic configuration (the one of the reading connection) fit in a single read
+void readValue(unsigned int stackId, GATT_Read_Request_Data_t *request) {
+    Byte_t configurationValue[2];
+    Byte_t *value = &characteristicRawValue;
+    unsigned int length = sizeof(characteristicRawValue);
+
+    if(request->AttributeOffset == VALUE_CONFIGURATION_ATTRIBUTE_OFFSET){
+        valueSubscriber_t *subscriber = findValueSubscriber(request->ConnectionID, false);
+
+        ASSIGN_HOST_WORD_TO_LITTLE_ENDIAN_UNALIGNED_WORD(configurationValue, subscriber ? subscriber->configuration : 0);
+        value = configurationValue;
+        length = sizeof(configurationValue);
+    }
+
+    if(request->AttributeValueOffset <= length)
+        GATT_Read_Response(stackId, request->TransactionID, length - request->AttributeValueOffset, &value[request->AttributeValueOffset]);
+    else
+        GATT_Error_Response(stackId, request->TransactionID, request->AttributeOffset, ATT_PROTOCOL_ERROR_CODE_INVALID_OFFSET);
+}
+
+// a change of the value is notified to every subscribed connection (the writer included)
+void notifyValue(unsigned int stackId, unsigned int serviceID) {
+    unsigned int index;
+
+    for(index = 0; index < VALUE_MAXIMUM_SUBSCRIBERS; index++){
+        if(valueSubscribers[index].configuration & GATT_CLIENT_CONFIGURATION_CHARACTERISTIC_NOTIFY_ENABLE)
+            GATT_Handle_Value_Notification(stackId, serviceID, valueSubscribers[index].connectionID, VALUE_ATTRIBUTE_OFFSET,
+                                           sizeof(characteristicRawValue), &characteristicRawValue);
+    }
+}
+
+// write requests are answered, write commands (no transaction) are not
+void writeValue(unsigned int stackId, GATT_Write_Request_Data_t *request) {
+    Byte_t errorCode = 0;
+    bool changed = false;
+
+    if(request->AttributeOffset == VALUE_CONFIGURATION_ATTRIBUTE_OFFSET){
+        if(request->AttributeValueOffset || request->AttributeValueLength != 2 || !request->AttributeValue){
+            errorCode = ATT_PROTOCOL_ERROR_CODE_INVALID_ATTRIBUTE_VALUE_LENGTH;
+        } else {
+            Word_t configuration = READ_UNALIGNED_WORD_LITTLE_ENDIAN(request->AttributeValue);
+            valueSubscriber_t *subscriber = findValueSubscriber(request->ConnectionID, configuration != 0);
+
+            if(subscriber){
+                subscriber->connectionID = request->ConnectionID;
+                subscriber->configuration = configuration;
+            } else if(configuration) {
+                errorCode = ATT_PROTOCOL_ERROR_CODE_INSUFFICIENT_RESOURCES;
+            }
+        }
+    } else {
+        if(request->AttributeValueOffset || request->AttributeValueLength != sizeof(characteristicRawValue) || !request->AttributeValue){
+            errorCode = ATT_PROTOCOL_ERROR_CODE_INVALID_ATTRIBUTE_VALUE_LENGTH;
+        } else {
+            changed = (characteristicRawValue != request->AttributeValue[0]);
+            characteristicRawValue = request->AttributeValue[0];
+        }
+    }
+
+    if(request->TransactionID){
+        if(errorCode)
+            GATT_Error_Response(stackId, request->TransactionID, request->AttributeOffset, errorCode);
+        else
+            GATT_Write_Response(stackId, request->TransactionID);
+    }
+
+    if(changed)
+        notifyValue(stackId, request->ServiceID);
+}
+
+// the metrics are serialized when a read starts, the Read Blob requests that follow get the same snapshot
+void readMetrics(unsigned int stackId, GATT_Read_Request_Data_t *request) {
+    Word_t mtu;
+    Word_t length;
+
+    if(request->AttributeValueOffset == 0)
+        Metrics_Serialize(sizeof(metricsValue), metricsValue);
+
+    if(request->AttributeValueOffset > sizeof(metricsValue)){
+        GATT_Error_Response(stackId, request->TransactionID, request->AttributeOffset, ATT_PROTOCOL_ERROR_CODE_INVALID_OFFSET);
+        return;
+    }
+
+    if(GATT_Query_Connection_MTU(stackId, request->ConnectionID, &mtu) != 0 || mtu < ATT_PROTOCOL_MTU_MINIMUM_LE)
+        mtu = ATT_PROTOCOL_MTU_MINIMUM_LE;
+
+    length = sizeof(metricsValue) - request->AttributeValueOffset;
+    if(length > mtu - 1)
+        length = mtu - 1;
+
+    GATT_Read_Response(stackId, request->TransactionID, length, &metricsValue[request->AttributeValueOffset]);
 }
 
 void GATTServiceCallback(unsigned int stackId, GATT_Server_Event_Data_t *GATT_Server_Event_Data,
                          unsigned long CallbackParameter){
-    printf("Bluetooth callback called!\n");
+    PROFILE_DECLARE(profileStart)
+    STACK_MARK_DECLARE(stackMark)
+    STACK_MARK_START(stackMark);
+    PROFILE_START(profileStart);
+
+    if(GATT_Server_Event_Data)
+        METRICS_COUNT_EVENT(GATTServerEvents, GATT_Server_Event_Data->Event_Data_Type);
+
+    // bursts of requests get short connection intervals, the link is relaxed once they stop
+    if(GATT_Server_Event_Data && GATT_Server_Event_Data->Event_Data_Type == etGATT_Server_Read_Request)
+        ConnParam_NoteActivity(GATT_Server_Event_Data->Event_Data.GATT_Read_Request_Data->RemoteDevice);
+    else if(GATT_Server_Event_Data && GATT_Server_Event_Data->Event_Data_Type == etGATT_Server_Write_Request)
+        ConnParam_NoteActivity(GATT_Server_Event_Data->Event_Data.GATT_Write_Request_Data->RemoteDevice);
+
+    // the configuration blob: reads at an offset, prepared writes queued until they are executed
+    if(GATTLong_ProcessServerEvent(stackId, GATT_Server_Event_Data)){
+        PROFILE_STOP(profileStart, gattServiceCallbackName, GATT_Server_Event_Data->Event_Data_Type);
+        STACK_MARK_STOP(stackMark, gattServiceCallbackName, GATT_Server_Event_Data->Event_Data_Type);
+        return;
+    }
+
+    if(GATT_Server_Event_Data && GATT_Server_Event_Data->Event_Data_Type == etGATT_Server_Read_Request &&
+       (GATT_Server_Event_Data->Event_Data.GATT_Read_Request_Data->AttributeOffset == VALUE_ATTRIBUTE_OFFSET ||
+        GATT_Server_Event_Data->Event_Data.GATT_Read_Request_Data->AttributeOffset == VALUE_CONFIGURATION_ATTRIBUTE_OFFSET)){
+        readValue(stackId, GATT_Server_Event_Data->Event_Data.GATT_Read_Request_Data);
+
+        PROFILE_STOP(profileStart, gattServiceCallbackName, etGATT_Server_Read_Request);
+        STACK_MARK_STOP(stackMark, gattServiceCallbackName, etGATT_Server_Read_Request);
+        return;
+    }
+
+    if(GATT_Server_Event_Data && GATT_Server_Event_Data->Event_Data_Type == etGATT_Server_Write_Request &&
+       (GATT_Server_Event_Data->Event_Data.GATT_Write_Request_Data->AttributeOffset == VALUE_ATTRIBUTE_OFFSET ||
+        GATT_Server_Event_Data->Event_Data.GATT_Write_Request_Data->AttributeOffset == VALUE_CONFIGURATION_ATTRIBUTE_OFFSET)){
+        writeValue(stackId, GATT_Server_Event_Data->Event_Data.GATT_Write_Request_Data);
+
+        PROFILE_STOP(profileStart, gattServiceCallbackName, etGATT_Server_Write_Request);
+        STACK_MARK_STOP(stackMark, gattServiceCallbackName, etGATT_Server_Write_Request);
+        return;
+    }
+
+    if(GATT_Server_Event_Data && GATT_Server_Event_Data->Event_Data_Type == etGATT_Server_Read_Request &&
+       GATT_Server_Event_Data->Event_Data.GATT_Read_Request_Data->AttributeOffset == SNOOP_VALUE_ATTRIBUTE_OFFSET){
+        // every read drains the next chunk of the capture, an empty value means it is drained
+        // (the value is a stream, so the value offset of blob reads is ignored)
+        GATT_Read_Request_Data_t *request = GATT_Server_Event_Data->Event_Data.GATT_Read_Request_Data;
+        Byte_t snoopData[SNOOP_MAXIMUM_READ_LENGTH];
+        Word_t mtu;
+
+        if(GATT_Query_Connection_MTU(stackId, request->ConnectionID, &mtu) != 0 || mtu < 23)
+            mtu = 23;
+
+        if(mtu - 1 > SNOOP_MAXIMUM_READ_LENGTH)
+            mtu = SNOOP_MAXIMUM_READ_LENGTH + 1;
+
+        unsigned int length = BTSnoop_Read(mtu - 1, snoopData);
+        GATT_Read_Response(stackId, request->TransactionID, length, snoopData);
+
+        PROFILE_STOP(profileStart, gattServiceCallbackName, etGATT_Server_Read_Request);
+        STACK_MARK_STOP(stackMark, gattServiceCallbackName, etGATT_Server_Read_Request);
+        return;
+    }
+
+    if(GATT_Server_Event_Data && GATT_Server_Event_Data->Event_Data_Type == etGATT_Server_Read_Request &&
+       GATT_Server_Event_Data->Event_Data.GATT_Read_Request_Data->AttributeOffset == METRICS_VALUE_ATTRIBUTE_OFFSET){
+        readMetrics(stackId, GATT_Server_Event_Data->Event_Data.GATT_Read_Request_Data);
+
+        PROFILE_STOP(profileStart, gattServiceCallbackName, etGATT_Server_Read_Request);
+        STACK_MARK_STOP(stackMark, gattServiceCallbackName, etGATT_Server_Read_Request);
+        return;
+    }
+
+    // a request for an attribute nobody serves still gets an answer, the client would wait for it until it times out
+    if(GATT_Server_Event_Data && GATT_Server_Event_Data->Event_Data_Type == etGATT_Server_Read_Request)
+        GATT_Error_Response(stackId, GATT_Server_Event_Data->Event_Data.GATT_Read_Request_Data->TransactionID,
+                            GATT_Server_Event_Data->Event_Data.GATT_Read_Request_Data->AttributeOffset, ATT_PROTOCOL_ERROR_CODE_READ_NOT_PERMITTED);
+    else if(GATT_Server_Event_Data && GATT_Server_Event_Data->Event_Data_Type == etGATT_Server_Write_Request &&
+            GATT_Server_Event_Data->Event_Data.GATT_Write_Request_Data->TransactionID)
+        GATT_Error_Response(stackId, GATT_Server_Event_Data->Event_Data.GATT_Write_Request_Data->TransactionID,
+                            GATT_Server_Event_Data->Event_Data.GATT_Write_Request_Data->AttributeOffset, ATT_PROTOCOL_ERROR_CODE_WRITE_NOT_PERMITTED);
+
+    PROFILE_STOP(profileStart, gattServiceCallbackName, GATT_Server_Event_Data ? GATT_Server_Event_Data->Event_Data_Type : 0);
+    STACK_MARK_STOP(stackMark, gattServiceCallbackName, GATT_Server_Event_Data ? GATT_Server_Event_Data->Event_Data_Type : 0);
+}
+
+
+// canonical groups of the UUIDs ("00000000-0000-0000-0000-00000001000A"), UUIDs on the
+// Bluetooth base would be registered as 16-bit attributes automatically
+const GATT_UUID_t serviceUUID = GATT_UUID_INITIALIZER(0x00000000, 0x0000, 0x0000, 0x0000, 0x00000001000AULL);
+const GATT_UUID_t characteristicUUID = GATT_UUID_INITIALIZER(0x00000000, 0x0000, 0x0000, 0x0000, 0x00000001000BULL);
+const GATT_UUID_t valueUUID = GATT_UUID_INITIALIZER(0x00000000, 0x0000, 0x0000, 0x0000, 0x00000001000CULL);
+const GATT_UUID_t snoopUUID = GATT_UUID_INITIALIZER(0x00000000, 0x0000, 0x0000, 0x0000, 0x00000001000DULL);
+const GATT_UUID_t configurationUUID = GATT_UUID_INITIALIZER(0x00000000, 0x0000, 0x0000, 0x0000, 0x00000001000EULL);
+const GATT_UUID_t metricsUUID = GATT_UUID_INITIALIZER(0x00000000, 0x0000, 0x0000, 0x0000, 0x00000001000FULL);
+const GATT_UUID_t clientConfigurationUUID = GATT_UUID_16_INITIALIZER(0x2902);
+
+GATTUUID_Entry_Value_t serviceEntry;
+GATTUUID_Entry_Value_t characteristicDescription;
+GATTUUID_Entry_Value_t characteristicValue;
+GATTUUID_Entry_Value_t characteristicConfiguration;
+GATTUUID_Entry_Value_t snoopDescription;
+GATTUUID_Entry_Value_t snoopValue;
+GATTUUID_Entry_Value_t configurationDescription;
+GATTUUID_Entry_Value_t configurationValue;
+GATTUUID_Entry_Value_t metricsDescription;
+GATTUUID_Entry_Value_t metricsValueEntry;
+Byte_t configuration[CONFIGURATION_MAXIMUM_LENGTH];
+
+void configurationWritten(unsigned int connectionID, unsigned int attributeID, Word_t length, unsigned long callbackParameter) {
+    printf("Configuration written by connection %u, %u bytes!\n", connectionID, (unsigned int)length);
 }
 
+bool assertGATTLongOK(int result) {
+    if(result >= 0)
+        return true;
 
-GATT_Primary_Service_128_Entry_t serviceUUID;
-GATT_Characteristic_Declaration_128_Entry_t characteristicDescription;
-GATT_Characteristic_Value_128_Entry_t characteristicValue;
-UUID_128_t characteristicUUID;
-UUID_128_t valueUUID;
+    printf("Long attribute setup failed : %d!\n", result);
+    errorFunc();
+    return false;
+}
 
+// stops at the first step that fails, bringUpBTStack() then hands the stack over to Recovery
 void configureGATT(int bluetoothStackID) {
-    assertGATTInitialized(GATT_Initialize(bluetoothStackID, GATT_INITIALIZATION_FLAGS_SUPPORT_LE, gattConnectionCallback, 0));
+    if(!assertGATTInitialized(GATT_Initialize(bluetoothStackID, GATT_INITIALIZATION_FLAGS_SUPPORT_LE, gattConnectionCallback, 0)))
+        return;
 
+    // Generic Attribute service first, so our handles only move when the tables change
+    if(!assertGATTDatabaseOK(GATTDatabase_Initialize(bluetoothStackID)))
+        return;
 
-    GATT_Service_Attribute_Entry_t serviceTable[3];
+    // reads and prepared writes of the configuration blob
+    if(!assertGATTLongOK(GATTLong_Initialize(bluetoothStackID)))
+        return;
+
+    // the stack keeps the table, so it must outlive this function
+    static GATT_Service_Attribute_Entry_t serviceTable[10];
     GATT_Attribute_Handle_Group_t handleGroupResult;
     handleGroupResult.Ending_Handle=0;
     handleGroupResult.Starting_Handle=0;
 
-    serviceUUID.Service_UUID.UUID_Byte0=10; // must be greater than 0, so it does not collide with standard UUIDS
-    serviceUUID.Service_UUID.UUID_Byte2=1; // base for standard UUIDS
-    serviceTable[0].Attribute_Entry_Type = aetPrimaryService128;
-    serviceTable[0].Attribute_Flags = GATT_ATTRIBUTE_FLAGS_READABLE;
-    serviceTable[0].Attribute_Value = &serviceUUID;
-
-    characteristicUUID.UUID_Byte0=11;
-    characteristicUUID.UUID_Byte2=1;
-    characteristicDescription.Characteristic_Value_UUID=characteristicUUID;
-    characteristicDescription.Properties=0; // no idea what this is
-    serviceTable[1].Attribute_Entry_Type = aetCharacteristicDeclaration128;
-    serviceTable[1].Attribute_Flags = GATT_ATTRIBUTE_FLAGS_READABLE;
-    serviceTable[1].Attribute_Value = &characteristicDescription;
-    valueUUID.UUID_Byte0=12;
-    valueUUID.UUID_Byte2=1;
-    bool characteristicRawValue=false;
-    characteristicValue.Characteristic_Value_UUID=valueUUID;
-    characteristicValue.Characteristic_Value_Length=1;
-    characteristicValue.Characteristic_Value = &characteristicRawValue;
-    serviceTable[2].Attribute_Entry_Type = aetCharacteristicValue128;
-    serviceTable[2].Attribute_Flags = GATT_ATTRIBUTE_FLAGS_READABLE_WRITABLE;
-    serviceTable[2].Attribute_Value = &characteristicValue;
-
-    int serviceID = GATT_Register_Service(bluetoothStackID, GATT_SERVICE_FLAGS_LE_SERVICE,
+    GATTUUID_AssignPrimaryService(&serviceTable[0], &serviceEntry, &serviceUUID);
+
+    // one byte value, answered by GATTServiceCallback, changes are notified to the subscribed connections
+    GATTUUID_AssignCharacteristicDeclaration(&serviceTable[1], &characteristicDescription, &characteristicUUID,
+                                             GATT_CHARACTERISTIC_PROPERTIES_READ | GATT_CHARACTERISTIC_PROPERTIES_WRITE |
+                                             GATT_CHARACTERISTIC_PROPERTIES_WRITE_WITHOUT_RESPONSE | GATT_CHARACTERISTIC_PROPERTIES_NOTIFY);
+    characteristicRawValue=0;
+    BTPS_MemInitialize(valueSubscribers, 0, sizeof(valueSubscribers));
+    GATTUUID_AssignCharacteristicValue(&serviceTable[VALUE_ATTRIBUTE_OFFSET], &characteristicValue, &valueUUID, GATT_ATTRIBUTE_FLAGS_READABLE_WRITABLE,
+                                       sizeof(characteristicRawValue), &characteristicRawValue);
+    GATTUUID_AssignCharacteristicDescriptor(&serviceTable[VALUE_CONFIGURATION_ATTRIBUTE_OFFSET], &characteristicConfiguration, &clientConfigurationUUID,
+                                            GATT_ATTRIBUTE_FLAGS_READABLE_WRITABLE, 0, NULL);
+
+    // BTSnoop capture, read it repeatedly to drain the ring (prefix the BTSnoop file header yourself)
+    GATTUUID_AssignCharacteristicDeclaration(&serviceTable[4], &snoopDescription, &snoopUUID, GATT_CHARACTERISTIC_PROPERTIES_READ);
+    GATTUUID_AssignCharacteristicValue(&serviceTable[SNOOP_VALUE_ATTRIBUTE_OFFSET], &snoopValue, &snoopUUID, GATT_ATTRIBUTE_FLAGS_READABLE, 0, NULL);
+
+    // configuration blob, the value lives in configuration[] and is served by GATTLong
+    GATTUUID_AssignCharacteristicDeclaration(&serviceTable[6], &configurationDescription, &configurationUUID,
+                                             GATT_CHARACTERISTIC_PROPERTIES_READ | GATT_CHARACTERISTIC_PROPERTIES_WRITE);
+    GATTUUID_AssignCharacteristicValue(&serviceTable[CONFIGURATION_VALUE_ATTRIBUTE_OFFSET], &configurationValue, &configurationUUID,
+                                       GATT_ATTRIBUTE_FLAGS_READABLE_WRITABLE, 0, NULL);
+
+    // runtime metrics (the STATS console command), the value is serialized into metricsValue[] by readMetrics
+    GATTUUID_AssignCharacteristicDeclaration(&serviceTable[8], &metricsDescription, &metricsUUID, GATT_CHARACTERISTIC_PROPERTIES_READ);
+    GATTUUID_AssignCharacteristicValue(&serviceTable[METRICS_VALUE_ATTRIBUTE_OFFSET], &metricsValueEntry, &metricsUUID,
+                                       GATT_ATTRIBUTE_FLAGS_READABLE, 0, NULL);
+
+    // registered through the database so it is covered by the Database Hash (GATTHash.h)
+    int serviceID = GATTDatabase_RegisterService(bluetoothStackID, GATT_SERVICE_FLAGS_LE_SERVICE,
                           sizeof(serviceTable)/sizeof(GATT_Service_Attribute_Entry_t), serviceTable,
                                          &handleGroupResult, GATTServiceCallback, 0);
-    assertRegisterServiceOK(serviceID);
-}
+    if(!assertRegisterServiceOK(serviceID))
+        return;
 
+    if(!assertGATTLongOK(GATTLong_RegisterAttribute(serviceID, CONFIGURATION_VALUE_ATTRIBUTE_OFFSET, sizeof(configuration),
+                                                    configuration, 0, configurationWritten, 0)))
+        return;
 
-void printCharacter(char c){
-    printf("%c", c);
-}
+    // all services are up, subscribed clients are told at their next connection if they changed
+    if(!assertPublishOK(GATTDatabase_Publish()))
+        return;
 
-void assertBTStackOK(int bluetoothStackID) {
-    printf("Bluetooth stack ID : %d\n", bluetoothStackID);
-    if(bluetoothStackID == 0){
-        printf("Bluetooth stack initialization error!\n");
-        errorFunc();
-    }
+#ifdef GATT_CLIENT_ENABLE
+    // reconnects to known peers skip the service discovery (the client is compiled out unless GATT_CLIENT_ENABLE)
+    assertGATTClientOK(GATTClient_Initialize(bluetoothStackID, gattClientReady, 0));
+#endif
 }
 
-void assertBLEEnabled(int feature) {
-    if(feature == 0){
-        printf("BLE failed to be enabled!\n");
-        errorFunc();
+bool assertAdvertisingOK(int result) {
+    if(result == 0){
+        printf("LE advertising started!\n");
+        return true;
     }
-    printf("BLE succesfully Enabled\n");
-}
 
-void printDeviceAddress(int stackId) {
-    BD_ADDR_t localBtAddress;
-    int result = GAP_Query_Local_BD_ADDR(stackId, &localBtAddress);
+    printf("LE advertising failed : %d!\n", result);
+    errorFunc();
+    return false;
+}
 
+bool assertConnParamOK(int result) {
     if(result == 0)
-        printf("0x%02X%02X%02X%02X%02X%02X \n", localBtAddress.BD_ADDR5, localBtAddress.BD_ADDR4, localBtAddress.BD_ADDR3,
-           localBtAddress.BD_ADDR2, localBtAddress.BD_ADDR1, localBtAddress.BD_ADDR0);
-    else{
-        printf("Getting bluetooth address failed!\n");
-        errorFunc();
-    }
+        return true;
+
+    printf("Connection parameter policy failed : %d!\n", result);
+    errorFunc();
+    return false;
 }
 
-void assertDiscoverableOK(int result) {
-    if(result == 0){
-        printf("Device set to discverability mode!\n");
+void configureAdvertising(int bluetoothStackID) {
+    // before the advertising, the policy has to see the first connection
+    if(!assertConnParamOK(ConnParam_Initialize(bluetoothStackID)))
         return;
-    }
 
-    printf("Discoverability failed!\n");
+    // payloads are built once here, only the interval changes afterwards
+    assertAdvertisingOK(Advertise_Initialize(bluetoothStackID, LOCAL_DEVICE_NAME, 1, &serviceUUID));
+}
+
+
+// every character of BTPS_OutputMessage (Display() of the application) comes through here
+void printCharacter(char c){
+    METRICS_COUNT(mcConsoleTxBytes);
+
+    printf("%c", c);
+}
+
+bool assertBTStackOK(int bluetoothStackID) {
+    printf("Bluetooth stack ID : %d\n", bluetoothStackID);
+    if(bluetoothStackID > 0)
+        return true;
+
+    printf("Bluetooth stack initialization error!\n");
     errorFunc();
+    return false;
 }
 
-void assertLocalNameOK(int result) {
-    if(result==0){
-        printf("Local name set successfully!\n");
-        return;
+bool assertBLEEnabled(int feature) {
+    if(feature != 0){
+        printf("BLE succesfully Enabled\n");
+        return true;
     }
 
-    printf("Local name set failed!\n");
+    printf("BLE failed to be enabled!\n");
     errorFunc();
+    return false;
 }
 
-void assertConnectableOK(int result) {
+bool assertLocalNameOK(int result) {
     if(result==0){
-        printf("Connectability OK!\n");
-        return;
+        printf("Local name set successfully!\n");
+        return true;
     }
 
-    printf("Connectability failed!");
+    printf("Local name set failed!\n");
     errorFunc();
+    return false;
 }
 
-void assertPairableLEOK(int result) {
+bool assertPairableLEOK(int result) {
     if(result==0){
         printf("Pairability LE set successfully!\n");
-        return;
+        return true;
     }
 
     printf("Pairability LE failed!%d\n",result);
     errorFunc();
+    return false;
 }
 
+// LE pairing only, HFPDemo handles the BR/EDR authentication of the AG
 void onPairRequest(unsigned int BluetoothStackID, GAP_Event_Data_t *GAP_Event_Data, unsigned long CallbackParameter){
+    PROFILE_DECLARE(profileStart)
+    STACK_MARK_DECLARE(stackMark)
+    STACK_MARK_START(stackMark);
+    PROFILE_START(profileStart);
+
     printf("onPairRequest done. eventType: %d\n", GAP_Event_Data->Event_Data_Type);
+
+    PROFILE_STOP(profileStart, onPairRequestName, GAP_Event_Data->Event_Data_Type);
+    STACK_MARK_STOP(stackMark, onPairRequestName, GAP_Event_Data->Event_Data_Type);
 }
 
-void assertLERemoteAuthenticationOK(int result) {
+bool assertLERemoteAuthenticationOK(int result) {
     if(result==0){
         printf("Remote Authentication set!\n");
-        return;
+        return true;
     }
 
     printf("Remote authentication failed!\n");
     errorFunc();
-}
-
-void assertPairableOK(int result) {
-    if(result==0){
-        printf("Pairable OK!\n");
-        return;
-    }
-
-    printf("Pairable failed!%d\n", result);
-    errorFunc();
+    return false;
 }
 
 int configureBTStack() {
@@ -213,26 +729,29 @@ int configureBTStack() {
     BTPS_Initialization_t btpsInitInfo;
     btpsInitInfo.GetTickCountCallback = HAL_GetTickCount;
     btpsInitInfo.MessageOutputCallback = printCharacter;
-    BTPS_Init(&btpsInitInfo);
-    printf("Some shit configured\n");
 
+    // the vendor init switches to this rate before the service pack download, so use the fastest one the CC256x supports
+    // no initialization delay, CTS flow control holds the first command until the controller leaves reset (see BootSeq.h)
     HCI_DriverInformation_t driverInfo;
-    HCI_DRIVER_SET_COMM_INFORMATION(&driverInfo, 1, VENDOR_BAUD_RATE, cpHCILL_RTS_CTS);
-    driverInfo.DriverInformation.COMMDriverInformation.InitializationDelay = 100; //todo check if zero works correctly
+    HCI_DRIVER_SET_COMM_INFORMATION(&driverInfo, 1, BOOT_SEQ_HCI_BAUD_RATE, cpHCILL_RTS_CTS);
+    driverInfo.DriverInformation.COMMDriverInformation.InitializationDelay = BOOT_SEQ_INITIALIZATION_DELAY;
 
-    int bluetoothStackID = BSC_Initialize(&driverInfo,0);
+    // HFPDemo opens the stack and makes it connectable, discoverable and pairable, so its HCI and GAP
+    // callbacks (peer cache, AG reconnect, sniff, audio link, pairing) and the console commands run on it
+    int bluetoothStackID = InitializeApplication(&driverInfo, &btpsInitInfo);
 
-    assertBTStackOK(bluetoothStackID);
-    assertBLEEnabled(BSC_EnableFeature(bluetoothStackID, BSC_FEATURE_BLUETOOTH_LOW_ENERGY));
+    if(!assertBTStackOK(bluetoothStackID))
+        return 0;
 
-    printDeviceAddress(bluetoothStackID);
+    // from here on a failed step returns the open stack, bringUpBTStack() closes it and hands over to Recovery
+    if(!assertBLEEnabled(BSC_EnableFeature(bluetoothStackID, BSC_FEATURE_BLUETOOTH_LOW_ENERGY)))
+        return bluetoothStackID;
+    BootSeq_MarkPhase("BLE Enable", 0);
 
-    assertLocalNameOK(GAP_Set_Local_Device_Name(bluetoothStackID, "Bluetooth rulez"));
-    assertConnectableOK(GAP_Set_Connectability_Mode(bluetoothStackID, cmConnectableMode));
-    assertDiscoverableOK(GAP_Set_Discoverability_Mode(bluetoothStackID, dmGeneralDiscoverableMode, 0));
+    // same name over BR/EDR as in the LE scan response
+    if(!assertLocalNameOK(GAP_Set_Local_Device_Name(bluetoothStackID, LOCAL_DEVICE_NAME)))
+        return bluetoothStackID;
 
-    assertPairableOK(GAP_Set_Pairability_Mode(bluetoothStackID, pmPairableMode));
-    assertLERemoteAuthenticationOK(GAP_Register_Remote_Authentication(bluetoothStackID,onPairRequest, 0));
     //assertPairableLEOK(GAP_LE_Set_Pairability_Mode(bluetoothStackID, lpmPairableMode)); does not support LE? WTF
     //assertLERemoteAuthenticationOK(GAP_LE_Register_Remote_Authentication(bluetoothStackID, onPairRequest, 0));
 
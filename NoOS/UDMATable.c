@@ -0,0 +1,52 @@
+/*****< udmatable.c >**********************************************************/
+/*                                                                            */
+/*  UDMATable - uDMA control table shared by the DMA driven UARTs.            */
+/*                                                                            */
+/******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "driverlib/sysctl.h"
+#include "driverlib/udma.h"
+
+#include "UDMATable.h"     /* Shared uDMA Control Table Prototypes.           */
+
+   /* The uDMA control table must be aligned on a 1024 byte boundary.    */
+#if defined(ewarm)
+
+#pragma data_alignment=1024
+static uint8_t DMAControlTable[1024];
+
+#elif defined(ccs)
+
+#pragma DATA_ALIGN(DMAControlTable, 1024)
+static uint8_t DMAControlTable[1024];
+
+#else
+
+static uint8_t DMAControlTable[1024] __attribute__ ((aligned(1024)));
+
+#endif
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the compiler*/
+   /* as part of standard C/C++).                                       */
+
+static bool TableEnabled;                           /* Variable which flags whether    */
+                                                    /* the controller was enabled.     */
+
+   /* The following function enables the uDMA controller and sets its   */
+   /* control table.  Calling it again does nothing, the channels that  */
+   /* are already configured keep running.                              */
+void UDMATable_Enable(void)
+{
+   if(!TableEnabled)
+   {
+      SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+
+      uDMAEnable();
+      uDMAControlBaseSet(DMAControlTable);
+
+      TableEnabled = true;
+   }
+}
@@ -0,0 +1,19 @@
+/*****< udmatable.h >**********************************************************/
+/*                                                                            */
+/*  UDMATable - uDMA control table shared by the DMA driven UARTs.            */
+/*                                                                            */
+/*  The uDMA controller has a single control table for all of its channels,   */
+/*  so the HCI transport (HCITRDMA.c) and the console (ConsoleTRDMA.c) both   */
+/*  enable the controller through this module, whichever is opened first      */
+/*  sets it up.                                                               */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __UDMATABLEH__
+#define __UDMATABLEH__
+
+   /* The following function enables the uDMA controller and sets its   */
+   /* control table.  Calling it again does nothing, the channels that  */
+   /* are already configured keep running.                              */
+void UDMATable_Enable(void);
+
+#endif
@@ -34,6 +34,13 @@
 /* --stack_size=256                                                          */
 /* --library=rtsv7M3_T_le_eabi.lib                                           */
 
+/* If the memory pool is used (see MemPool.h) the references of the stack to */
+/* the heap of the kernel are redirected to the pool.                        */
+#ifdef MEM_POOL_ENABLE
+--symbol_map=BTPS_AllocateMemory=MemPool_BTPS_AllocateMemory
+--symbol_map=BTPS_FreeMemory=MemPool_BTPS_FreeMemory
+#endif
+
 /* The starting address of the application.  Normally the interrupt vectors  */
 /* must be located at the beginning of the application.                      */
 #define APP_BASE 0x00000000
@@ -43,8 +50,11 @@
 
 MEMORY
 {
-    /* Application stored in and executes from internal flash */
-    FLASH (RX) : origin = APP_BASE, length = 0x00040000
+    /* Application stored in and executes from internal flash.  The last */
+    /* 1KB page is reserved for the Peer Cache (see PeerCache.h), the 2KB */
+    /* below it for the GATT client cache (see GATTClient.h) and the 1KB  */
+    /* page below that for the GATT database (see GATTDatabase.h).        */
+    FLASH (RX) : origin = APP_BASE, length = 0x0003F000
     /* Application uses internal RAM for data */
     SRAM (RWX) : origin = 0x20000000, length = 0x00008000
 }
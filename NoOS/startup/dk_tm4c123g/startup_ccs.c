@@ -44,6 +44,14 @@ static void IntDefaultHandler(void);
 //*****************************************************************************
 extern void _c_int00(void);
 
+//*****************************************************************************
+//
+// External declaration of the function that paints the stack for the high
+// watermark (see StackMark.h).
+//
+//*****************************************************************************
+extern void StackMark_Paint(void);
+
 //*****************************************************************************
 //
 // Linker variable that marks the top of the stack.
@@ -57,7 +65,7 @@ extern uint32_t __STACK_TOP;
 //
 //*****************************************************************************
 extern void TimerIntHandler(void);
-extern void ConsoleIntHandler(void);
+extern void ConsoleTR_UARTIntHandler(void);
 extern void HCITR_UARTIntHandler(void);
 
 //*****************************************************************************
@@ -92,7 +100,7 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // GPIO Port C
     IntDefaultHandler,                      // GPIO Port D
     IntDefaultHandler,                      // GPIO Port E
-    ConsoleIntHandler,                      // UART0 Rx and Tx
+    ConsoleTR_UARTIntHandler,               // UART0 Rx and Tx
     HCITR_UARTIntHandler,                   // UART1 Rx and Tx
     IntDefaultHandler,                      // SSI0 Rx and Tx
     IntDefaultHandler,                      // I2C0 Master and Slave
@@ -241,6 +249,11 @@ void (* const g_pfnVectors[])(void) =
 void
 ResetISR(void)
 {
+    //
+    // Paint the stack before anything else uses it.
+    //
+    StackMark_Paint();
+
     //
     // Jump to the CCS C initialization routine.  This will enable the
     // floating-point unit as well, so that does not need to be done here.
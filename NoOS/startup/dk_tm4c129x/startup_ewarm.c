@@ -51,13 +51,21 @@ static void IntDefaultHandler(void);
 //*****************************************************************************
 extern void __iar_program_start(void);
 
+//*****************************************************************************
+//
+// External declaration of the function that paints the stack for the high
+// watermark (see StackMark.h).
+//
+//*****************************************************************************
+extern void StackMark_Paint(void);
+
 //*****************************************************************************
 //
 // External declarations for the interrupt handlers used by the application.
 //
 //*****************************************************************************
 extern void TimerIntHandler(void);
-extern void ConsoleIntHandler(void);
+extern void ConsoleTR_UARTIntHandler(void);
 extern void HCITR_UARTIntHandler(void);
 
 //*****************************************************************************
@@ -111,7 +119,7 @@ __root const uVectorEntry __vector_table[] @ ".intvec" =
     IntDefaultHandler,                      // GPIO Port C
     IntDefaultHandler,                      // GPIO Port D
     IntDefaultHandler,                      // GPIO Port E
-    ConsoleIntHandler,                      // UART0 Rx and Tx
+    ConsoleTR_UARTIntHandler,               // UART0 Rx and Tx
     IntDefaultHandler,                      // UART1 Rx and Tx
     IntDefaultHandler,                      // SSI0 Rx and Tx
     IntDefaultHandler,                      // I2C0 Master and Slave
@@ -247,6 +255,11 @@ ResetISR(void)
                          ~(NVIC_CPAC_CP10_M | NVIC_CPAC_CP11_M)) |
                         NVIC_CPAC_CP10_FULL | NVIC_CPAC_CP11_FULL);
 
+    //
+    // Paint the stack before anything else uses it.
+    //
+    StackMark_Paint();
+
     //
     // Call the application's entry point.
     //
@@ -0,0 +1,521 @@
+/*****< peercache.c >**********************************************************/
+/*                                                                            */
+/*  PeerCache - Persistent cache of remote device paging information.         */
+/*                                                                            */
+/******************************************************************************/
+#include <stdint.h>        /* Included for TivaWare driver library types.     */
+#include <stdbool.h>       /* Included for TivaWare driver library types.     */
+#include "PeerCache.h"     /* Peer Cache Prototypes/Constants.                */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+#include "driverlib/flash.h" /* TivaWare Flash Driver Prototypes.             */
+
+#define PEER_CACHE_SIGNATURE                     (0x50434348)  /* "PCCH"      */
+
+#define PEER_CACHE_VERSION                           (0x0002)
+
+#define PEER_CACHE_MAX_CONNECTIONS                       (4)  /* Denotes the   */
+                                                         /* max number of     */
+                                                         /* simultaneous ACL  */
+                                                         /* connections that  */
+                                                         /* are tracked.      */
+
+#define PEER_CACHE_PAGE_VALID_FLAGS                      (PEER_CACHE_FLAGS_PAGE_SCAN_VALID | PEER_CACHE_FLAGS_CLOCK_OFFSET_VALID)
+
+#define PEER_CACHE_CLOCK_OFFSET_TOLERANCE               (64)  /* Denotes the   */
+                                                         /* drift of the Clock*/
+                                                         /* Offset (in units  */
+                                                         /* of 1.25 ms) that  */
+                                                         /* is only kept in   */
+                                                         /* RAM (the offset of*/
+                                                         /* every device      */
+                                                         /* drifts, a page    */
+                                                         /* train covers      */
+                                                         /* 1.28 s of error). */
+
+   /* The following type definition represents the image of the cache   */
+   /* that is stored in flash.                                          */
+typedef struct _tagPeerCacheImage_t
+{
+   DWord_t          Signature;
+   Word_t           Version;
+   Word_t           NumberEntries;
+   PeerCacheEntry_t Entries[PEER_CACHE_MAX_ENTRIES];
+   DWord_t          Checksum;
+} PeerCacheImage_t;
+
+   /* The flash can only be programmed a word at a time so the image is */
+   /* built in a word aligned buffer that is rounded up to a word.      */
+#define PEER_CACHE_IMAGE_WORDS                           ((sizeof(PeerCacheImage_t) + sizeof(uint32_t) - 1)/sizeof(uint32_t))
+
+typedef union _tagPeerCacheImageBuffer_t
+{
+   PeerCacheImage_t Image;
+   uint32_t         Words[PEER_CACHE_IMAGE_WORDS];
+} PeerCacheImageBuffer_t;
+
+   /* The following type definition is used to map an active ACL        */
+   /* Connection Handle to a remote device.                             */
+typedef struct _tagConnectionMap_t
+{
+   BD_ADDR_t BD_ADDR;
+   Word_t    Connection_Handle;
+   Boolean_t InUse;
+} ConnectionMap_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static PeerCacheImageBuffer_t PeerCacheImage;       /* Variable which holds the RAM    */
+                                                    /* copy of the cache.              */
+
+static Boolean_t             PeerCacheDirty;        /* Variable which flags that the   */
+                                                    /* cache must be written back to   */
+                                                    /* flash.                          */
+
+static Byte_t                PeerCacheAge;          /* Variable which holds the current*/
+                                                    /* age stamp given to entries when */
+                                                    /* they are used.                  */
+
+static ConnectionMap_t       ConnectionMap[PEER_CACHE_MAX_CONNECTIONS]; /* Variable    */
+                                                    /* which maps Connection Handles to*/
+                                                    /* remote devices.                 */
+
+static BD_ADDR_t             PageBD_ADDR;           /* Variable which holds the device */
+                                                    /* currently being paged.          */
+
+static unsigned long         PageStartTime;         /* Variable which holds the tick   */
+                                                    /* count when the page started.    */
+
+static Boolean_t             PageCached;            /* Variable which flags whether the*/
+                                                    /* outstanding page used cached    */
+                                                    /* parameters.                     */
+
+static PeerCacheStatistics_t PeerCacheStatistics;   /* Variable which holds the page   */
+                                                    /* latency statistics.             */
+
+   /* Internal function prototypes.                                     */
+static DWord_t CalculateChecksum(PeerCacheImage_t *Image);
+static PeerCacheEntry_t *FindEntry(BD_ADDR_t BD_ADDR);
+static PeerCacheEntry_t *AllocateEntry(BD_ADDR_t BD_ADDR);
+static ConnectionMap_t *FindConnection(Word_t Connection_Handle);
+static Boolean_t ClockOffsetMoved(PeerCacheEntry_t *Entry, Word_t Clock_Offset);
+
+   /* The following function calculates the checksum of the cache image*/
+   /* (excluding the checksum itself).                                  */
+static DWord_t CalculateChecksum(PeerCacheImage_t *Image)
+{
+   DWord_t       ret_val = 0;
+   Byte_t       *Data    = (Byte_t *)Image;
+   unsigned int  Index;
+
+   for(Index=0;Index<(unsigned int)((Byte_t *)&(Image->Checksum) - Data);Index++)
+      ret_val = ((ret_val << 5) | (ret_val >> 27)) ^ Data[Index];
+
+   return(ret_val);
+}
+
+   /* The following function searches the cache for the specified       */
+   /* device.  This function returns a pointer to the entry if found or */
+   /* NULL if the device is not cached.                                 */
+static PeerCacheEntry_t *FindEntry(BD_ADDR_t BD_ADDR)
+{
+   unsigned int      Index;
+   PeerCacheEntry_t *ret_val = NULL;
+
+   for(Index=0;(Index<PeerCacheImage.Image.NumberEntries) && (!ret_val);Index++)
+   {
+      if(COMPARE_BD_ADDR(PeerCacheImage.Image.Entries[Index].BD_ADDR, BD_ADDR))
+         ret_val = &(PeerCacheImage.Image.Entries[Index]);
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the cache entry for the specified  */
+   /* device, creating it if it does not already exist.  When the cache */
+   /* is full the least recently used entry is replaced.                */
+static PeerCacheEntry_t *AllocateEntry(BD_ADDR_t BD_ADDR)
+{
+   unsigned int      Index;
+   PeerCacheEntry_t *ret_val;
+
+   if((ret_val = FindEntry(BD_ADDR)) == NULL)
+   {
+      if(PeerCacheImage.Image.NumberEntries < PEER_CACHE_MAX_ENTRIES)
+         ret_val = &(PeerCacheImage.Image.Entries[PeerCacheImage.Image.NumberEntries++]);
+      else
+      {
+         /* The cache is full, replace the entry that has gone the      */
+         /* longest without being used (the age stamp wraps so compare  */
+         /* distances from the current stamp).                          */
+         for(Index=1,ret_val=&(PeerCacheImage.Image.Entries[0]);Index<PEER_CACHE_MAX_ENTRIES;Index++)
+         {
+            if((Byte_t)(PeerCacheAge - PeerCacheImage.Image.Entries[Index].Age) > (Byte_t)(PeerCacheAge - ret_val->Age))
+               ret_val = &(PeerCacheImage.Image.Entries[Index]);
+         }
+      }
+
+      BTPS_MemInitialize(ret_val, 0, sizeof(PeerCacheEntry_t));
+
+      ret_val->BD_ADDR = BD_ADDR;
+   }
+
+   ret_val->Age = ++PeerCacheAge;
+
+   return(ret_val);
+}
+
+   /* The following function searches the connection map for the       */
+   /* specified Connection Handle.                                      */
+static ConnectionMap_t *FindConnection(Word_t Connection_Handle)
+{
+   unsigned int     Index;
+   ConnectionMap_t *ret_val = NULL;
+
+   for(Index=0;(Index<PEER_CACHE_MAX_CONNECTIONS) && (!ret_val);Index++)
+   {
+      if((ConnectionMap[Index].InUse) && (ConnectionMap[Index].Connection_Handle == Connection_Handle))
+         ret_val = &(ConnectionMap[Index]);
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns TRUE if the specified Clock Offset  */
+   /* (bits 14-0, see PeerCache_UpdatePageInformation()) is not cached  */
+   /* for the entry or moved by more than the tolerance from the cached */
+   /* one (the offset wraps).                                           */
+static Boolean_t ClockOffsetMoved(PeerCacheEntry_t *Entry, Word_t Clock_Offset)
+{
+   Word_t Drift;
+
+   Drift = (Word_t)((Clock_Offset - Entry->Clock_Offset) & 0x7FFF);
+   if(Drift > 0x4000)
+      Drift = (Word_t)(0x8000 - Drift);
+
+   return((Boolean_t)((!(Entry->Flags & PEER_CACHE_FLAGS_CLOCK_OFFSET_VALID)) || (Drift > PEER_CACHE_CLOCK_OFFSET_TOLERANCE)));
+}
+
+   /* The following function is responsible for loading the Peer Cache  */
+   /* from persistent storage.  If no valid image is present the cache  */
+   /* is simply cleared.  This function returns the number of entries   */
+   /* that were restored.                                               */
+int PeerCache_Initialize(void)
+{
+   unsigned int Index;
+
+   BTPS_MemCopy(&PeerCacheImage, (void *)PEER_CACHE_FLASH_ADDRESS, sizeof(PeerCacheImage));
+
+   if((PeerCacheImage.Image.Signature != PEER_CACHE_SIGNATURE) || (PeerCacheImage.Image.Version != PEER_CACHE_VERSION) || (PeerCacheImage.Image.NumberEntries > PEER_CACHE_MAX_ENTRIES) || (PeerCacheImage.Image.Checksum != CalculateChecksum(&(PeerCacheImage.Image))))
+   {
+      /* No valid image was found, start with an empty cache.           */
+      BTPS_MemInitialize(&PeerCacheImage, 0, sizeof(PeerCacheImage));
+
+      PeerCacheImage.Image.Signature = PEER_CACHE_SIGNATURE;
+      PeerCacheImage.Image.Version   = PEER_CACHE_VERSION;
+   }
+
+   /* Continue the age stamps from the most recently used entry.        */
+   for(Index=0,PeerCacheAge=0;Index<PeerCacheImage.Image.NumberEntries;Index++)
+   {
+      if((SByte_t)(PeerCacheImage.Image.Entries[Index].Age - PeerCacheAge) > 0)
+         PeerCacheAge = PeerCacheImage.Image.Entries[Index].Age;
+   }
+
+   PeerCacheDirty = FALSE;
+
+   BTPS_MemInitialize(ConnectionMap, 0, sizeof(ConnectionMap));
+   BTPS_MemInitialize(&PageBD_ADDR, 0, sizeof(PageBD_ADDR));
+
+   return((int)PeerCacheImage.Image.NumberEntries);
+}
+
+   /* The following function writes the Peer Cache back to persistent    */
+   /* storage if it has been modified.  Because erasing flash stalls the*/
+   /* processor for several milliseconds this function should only be   */
+   /* called from the main loop (never from a stack callback).  This    */
+   /* function returns zero if nothing was written, a positive value if */
+   /* the cache was written, or a negative value on error.              */
+int PeerCache_Flush(void)
+{
+   int ret_val = 0;
+
+   if(PeerCacheDirty)
+   {
+      PeerCacheImage.Image.Checksum = CalculateChecksum(&(PeerCacheImage.Image));
+
+      /* Only rewrite the page if the contents actually differ, this    */
+      /* saves erase cycles when an update did not change anything.     */
+      if(BTPS_MemCompare(&PeerCacheImage, (void *)PEER_CACHE_FLASH_ADDRESS, sizeof(PeerCacheImage)))
+      {
+         if((!FlashErase(PEER_CACHE_FLASH_ADDRESS)) && (!FlashProgram(PeerCacheImage.Words, PEER_CACHE_FLASH_ADDRESS, sizeof(PeerCacheImage.Words))))
+         {
+            PeerCacheStatistics.FlashWrites++;
+
+            ret_val = 1;
+         }
+         else
+            ret_val = -1;
+      }
+
+      /* A failed write is retried on the next flush.                   */
+      if(ret_val >= 0)
+         PeerCacheDirty = FALSE;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function removes all entries from the cache (and    */
+   /* flags the cache to be written back on the next flush).            */
+void PeerCache_Clear(void)
+{
+   PeerCacheImage.Image.NumberEntries = 0;
+
+   BTPS_MemInitialize(PeerCacheImage.Image.Entries, 0, sizeof(PeerCacheImage.Image.Entries));
+
+   PeerCacheDirty = TRUE;
+}
+
+   /* The following functions are used to record paging information     */
+   /* about a remote device as it is learned from Inquiry Results,      */
+   /* Inquiry Entry Results and HCI events.  The Clock Offset passed in */
+   /* should be the value as reported by the controller.                */
+void PeerCache_UpdatePageInformation(BD_ADDR_t BD_ADDR, Byte_t Page_Scan_Repetition_Mode, Word_t Clock_Offset)
+{
+   PeerCacheEntry_t *Entry = AllocateEntry(BD_ADDR);
+
+   /* Bit 15 of the Clock Offset is reserved in events (and is used as  */
+   /* the valid flag when paging) so only store the offset bits.        */
+   Clock_Offset &= 0x7FFF;
+
+   /* Every inquiry result reports a slightly different offset, only a  */
+   /* change that matters for paging is written back to flash.          */
+   if((Entry->Page_Scan_Repetition_Mode != Page_Scan_Repetition_Mode) || (ClockOffsetMoved(Entry, Clock_Offset)) || ((Entry->Flags & PEER_CACHE_PAGE_VALID_FLAGS) != PEER_CACHE_PAGE_VALID_FLAGS))
+      PeerCacheDirty = TRUE;
+
+   Entry->Page_Scan_Repetition_Mode  = Page_Scan_Repetition_Mode;
+   Entry->Clock_Offset               = Clock_Offset;
+   Entry->Flags                     |= PEER_CACHE_PAGE_VALID_FLAGS;
+}
+
+void PeerCache_UpdatePageScanMode(BD_ADDR_t BD_ADDR, Byte_t Page_Scan_Repetition_Mode)
+{
+   PeerCacheEntry_t *Entry = AllocateEntry(BD_ADDR);
+
+   if((Entry->Page_Scan_Repetition_Mode != Page_Scan_Repetition_Mode) || (!(Entry->Flags & PEER_CACHE_FLAGS_PAGE_SCAN_VALID)))
+   {
+      Entry->Page_Scan_Repetition_Mode  = Page_Scan_Repetition_Mode;
+      Entry->Flags                     |= PEER_CACHE_FLAGS_PAGE_SCAN_VALID;
+
+      PeerCacheDirty                    = TRUE;
+   }
+}
+
+void PeerCache_UpdateClassOfDevice(BD_ADDR_t BD_ADDR, Class_of_Device_t Class_of_Device)
+{
+   PeerCacheEntry_t *Entry = AllocateEntry(BD_ADDR);
+
+   if((BTPS_MemCompare(&(Entry->Class_of_Device), &Class_of_Device, sizeof(Class_of_Device_t))) || (!(Entry->Flags & PEER_CACHE_FLAGS_CLASS_OF_DEVICE_VALID)))
+   {
+      Entry->Class_of_Device  = Class_of_Device;
+      Entry->Flags           |= PEER_CACHE_FLAGS_CLASS_OF_DEVICE_VALID;
+
+      PeerCacheDirty          = TRUE;
+   }
+}
+
+void PeerCache_UpdateFeatures(BD_ADDR_t BD_ADDR, LMP_Features_t *Features)
+{
+   PeerCacheEntry_t *Entry;
+
+   if(Features)
+   {
+      Entry = AllocateEntry(BD_ADDR);
+
+      if((BTPS_MemCompare(&(Entry->Features), Features, sizeof(LMP_Features_t))) || (!(Entry->Flags & PEER_CACHE_FLAGS_FEATURES_VALID)))
+      {
+         Entry->Features  = *Features;
+         Entry->Flags    |= PEER_CACHE_FLAGS_FEATURES_VALID;
+
+         PeerCacheDirty   = TRUE;
+      }
+   }
+}
+
+   /* The following functions record and return the audio parameter set */
+   /* that worked for the specified device and codec (zero forgets it,  */
+   /* 0xFF marks a codec the device could not set up).                  */
+   /* PeerCache_QueryAudioSet() returns zero if no set is known.        */
+void PeerCache_UpdateAudioSet(BD_ADDR_t BD_ADDR, unsigned int Codec, Byte_t AudioSet)
+{
+   PeerCacheEntry_t *Entry;
+
+   /* Forgetting the set of an unknown device must not take an entry.   */
+   if((Codec < PEER_CACHE_NUMBER_AUDIO_CODECS) && ((AudioSet) || (FindEntry(BD_ADDR))))
+   {
+      Entry = AllocateEntry(BD_ADDR);
+
+      if(Entry->AudioSet[Codec] != AudioSet)
+      {
+         Entry->AudioSet[Codec] = AudioSet;
+
+         PeerCacheDirty         = TRUE;
+      }
+   }
+}
+
+Byte_t PeerCache_QueryAudioSet(BD_ADDR_t BD_ADDR, unsigned int Codec)
+{
+   Byte_t            ret_val = 0;
+   PeerCacheEntry_t *Entry;
+
+   if((Codec < PEER_CACHE_NUMBER_AUDIO_CODECS) && ((Entry = FindEntry(BD_ADDR)) != NULL))
+      ret_val = Entry->AudioSet[Codec];
+
+   return(ret_val);
+}
+
+   /* The following functions are used to track connection handles so   */
+   /* that HCI events (which only carry a Connection Handle) can be     */
+   /* associated with the correct cache entry.                          */
+void PeerCache_ConnectionEstablished(BD_ADDR_t BD_ADDR, Word_t Connection_Handle)
+{
+   unsigned int Index;
+
+   for(Index=0;Index<PEER_CACHE_MAX_CONNECTIONS;Index++)
+   {
+      if(!ConnectionMap[Index].InUse)
+      {
+         ConnectionMap[Index].BD_ADDR           = BD_ADDR;
+         ConnectionMap[Index].Connection_Handle = Connection_Handle;
+         ConnectionMap[Index].InUse             = TRUE;
+         break;
+      }
+   }
+}
+
+void PeerCache_ConnectionTerminated(Word_t Connection_Handle)
+{
+   ConnectionMap_t *Connection;
+
+   if((Connection = FindConnection(Connection_Handle)) != NULL)
+      Connection->InUse = FALSE;
+}
+
+void PeerCache_UpdateClockOffsetByHandle(Word_t Connection_Handle, Word_t Clock_Offset)
+{
+   PeerCacheEntry_t *Entry;
+   ConnectionMap_t  *Connection;
+
+   if((Connection = FindConnection(Connection_Handle)) != NULL)
+   {
+      /* The Page Scan Repetition Mode is only learned from inquiry (or */
+      /* the mode change event) so keep whatever is already cached.     */
+      Entry         = AllocateEntry(Connection->BD_ADDR);
+      Clock_Offset &= 0x7FFF;
+
+      if(ClockOffsetMoved(Entry, Clock_Offset))
+         PeerCacheDirty = TRUE;
+
+      Entry->Clock_Offset  = Clock_Offset;
+      Entry->Flags        |= PEER_CACHE_FLAGS_CLOCK_OFFSET_VALID;
+   }
+}
+
+void PeerCache_UpdateFeaturesByHandle(Word_t Connection_Handle, LMP_Features_t *Features)
+{
+   ConnectionMap_t *Connection;
+
+   if((Connection = FindConnection(Connection_Handle)) != NULL)
+      PeerCache_UpdateFeatures(Connection->BD_ADDR, Features);
+}
+
+   /* The following function looks up the specified device in the cache.*/
+   /* If the device is present (and has valid paging information) the  */
+   /* entry is copied into the buffer passed in and this function       */
+   /* returns TRUE, otherwise it returns FALSE.                         */
+Boolean_t PeerCache_Query(BD_ADDR_t BD_ADDR, PeerCacheEntry_t *PeerCacheEntry)
+{
+   Boolean_t         ret_val = FALSE;
+   PeerCacheEntry_t *Entry;
+
+   if(((Entry = FindEntry(BD_ADDR)) != NULL) && ((Entry->Flags & PEER_CACHE_PAGE_VALID_FLAGS) == PEER_CACHE_PAGE_VALID_FLAGS))
+   {
+      if(PeerCacheEntry)
+         *PeerCacheEntry = *Entry;
+
+      Entry->Age = ++PeerCacheAge;
+
+      ret_val    = TRUE;
+   }
+
+   return(ret_val);
+}
+
+   /* The following functions are used to measure the page latency of   */
+   /* outgoing connections.  PeerCache_PageStarted() is called when the */
+   /* connection request is submitted (Cached denotes whether cached    */
+   /* paging parameters were used) and PeerCache_PageComplete() when    */
+   /* the Connection Complete event is received.  The latter returns the*/
+   /* measured latency (in milliseconds) or a negative value if no page */
+   /* was outstanding for the device.                                   */
+void PeerCache_PageStarted(BD_ADDR_t BD_ADDR, Boolean_t Cached)
+{
+   PageBD_ADDR   = BD_ADDR;
+   PageCached    = Cached;
+   PageStartTime = BTPS_GetTickCount();
+}
+
+long PeerCache_PageComplete(BD_ADDR_t BD_ADDR, Byte_t Status)
+{
+   long              ret_val = -1;
+   PeerCacheEntry_t *Entry;
+
+   if((!COMPARE_NULL_BD_ADDR(PageBD_ADDR)) && (COMPARE_BD_ADDR(PageBD_ADDR, BD_ADDR)))
+   {
+      ret_val = (long)(BTPS_GetTickCount() - PageStartTime);
+
+      if(!Status)
+      {
+         if(PageCached)
+         {
+            PeerCacheStatistics.CachedPages++;
+            PeerCacheStatistics.CachedPageTime += ret_val;
+         }
+         else
+         {
+            PeerCacheStatistics.BlindPages++;
+            PeerCacheStatistics.BlindPageTime  += ret_val;
+         }
+
+         /* Note the latest page time in the entry (this is only kept in*/
+         /* RAM, it does not warrant a flash write on its own).         */
+         if((Entry = FindEntry(BD_ADDR)) != NULL)
+            Entry->PageTime = (Word_t)((ret_val > 0xFFFF)?0xFFFF:ret_val);
+      }
+      else
+         PeerCacheStatistics.FailedPages++;
+
+      BTPS_MemInitialize(&PageBD_ADDR, 0, sizeof(PageBD_ADDR));
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the current page latency statistics*/
+   /* and the list of cached devices (up to MaximumEntries).  The return*/
+   /* value is the number of entries copied.                            */
+int PeerCache_QueryStatistics(PeerCacheStatistics_t *Statistics, unsigned int MaximumEntries, PeerCacheEntry_t *EntryList)
+{
+   unsigned int Index;
+
+   if(Statistics)
+      *Statistics = PeerCacheStatistics;
+
+   for(Index=0;(EntryList) && (Index<MaximumEntries) && (Index<PeerCacheImage.Image.NumberEntries);Index++)
+      EntryList[Index] = PeerCacheImage.Image.Entries[Index];
+
+   return((int)Index);
+}
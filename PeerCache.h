@@ -0,0 +1,145 @@
+/*****< peercache.h >**********************************************************/
+/*                                                                            */
+/*  PeerCache - Persistent cache of remote device paging information.         */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __PEERCACHEH__
+#define __PEERCACHEH__
+
+#include "SS1BTPS.h"       /* Includes for the SS1 Bluetooth Protocol Stack.  */
+
+#define PEER_CACHE_MAX_ENTRIES                      (8)  /* Denotes the max   */
+                                                         /* number of remote  */
+                                                         /* devices that are  */
+                                                         /* remembered.       */
+
+#ifndef PEER_CACHE_FLASH_ADDRESS
+
+#define PEER_CACHE_FLASH_ADDRESS           (0x0003FC00)  /* Denotes the flash */
+                                                         /* page that holds   */
+                                                         /* the cache.  This  */
+                                                         /* page is removed   */
+                                                         /* from the FLASH    */
+                                                         /* region in the     */
+                                                         /* linker files.     */
+
+#endif
+
+#define PEER_CACHE_FLASH_PAGE_SIZE              (0x0400)  /* Denotes the flash */
+                                                         /* erase block size. */
+
+#define PEER_CACHE_NUMBER_AUDIO_CODECS               (2)  /* Denotes the number*/
+                                                         /* of audio codecs a */
+                                                         /* parameter set is  */
+                                                         /* remembered for.   */
+
+   /* The following bit masks are used with the Flags member of the     */
+   /* Peer Cache Entry to denote which members contain valid data.      */
+#define PEER_CACHE_FLAGS_PAGE_SCAN_VALID                 0x01
+#define PEER_CACHE_FLAGS_CLOCK_OFFSET_VALID              0x02
+#define PEER_CACHE_FLAGS_CLASS_OF_DEVICE_VALID           0x04
+#define PEER_CACHE_FLAGS_FEATURES_VALID                  0x08
+
+   /* The following type definition represents a single entry in the    */
+   /* Peer Cache.  The Clock Offset is stored in the form that is used  */
+   /* by the HCI Create Connection command (bits 16-2 of the offset) and*/
+   /* the Page Time is the last measured page latency (in milliseconds) */
+   /* for the device.  The Age member is used to determine the least    */
+   /* recently used entry when the cache is full.  AudioSet holds, per  */
+   /* audio codec, the audio parameter set the last audio connection to */
+   /* the device was set up with (zero if unknown, 0xFF if the codec    */
+   /* failed).                                                          */
+typedef struct _tagPeerCacheEntry_t
+{
+   BD_ADDR_t         BD_ADDR;
+   Byte_t            Flags;
+   Byte_t            Page_Scan_Repetition_Mode;
+   Word_t            Clock_Offset;
+   Word_t            PageTime;
+   Class_of_Device_t Class_of_Device;
+   Byte_t            Age;
+   LMP_Features_t    Features;
+   Byte_t            AudioSet[PEER_CACHE_NUMBER_AUDIO_CODECS];
+} PeerCacheEntry_t;
+
+#define PEER_CACHE_ENTRY_SIZE                            (sizeof(PeerCacheEntry_t))
+
+   /* The following structure holds the page latency statistics that    */
+   /* are gathered for every outgoing connection.  Pages are classified */
+   /* as Cached (Clock Offset and Page Scan Repetition Mode were known  */
+   /* when the page was started) or Blind.  All times are specified in  */
+   /* milliseconds.                                                     */
+typedef struct _tagPeerCacheStatistics_t
+{
+   unsigned int  CachedPages;
+   unsigned long CachedPageTime;
+   unsigned int  BlindPages;
+   unsigned long BlindPageTime;
+   unsigned int  FailedPages;
+   unsigned int  FlashWrites;
+} PeerCacheStatistics_t;
+
+   /* The following function is responsible for loading the Peer Cache  */
+   /* from persistent storage.  If no valid image is present the cache  */
+   /* is simply cleared.  This function returns the number of entries   */
+   /* that were restored.                                               */
+int PeerCache_Initialize(void);
+
+   /* The following function writes the Peer Cache back to persistent    */
+   /* storage if it has been modified.  Because erasing flash stalls the*/
+   /* processor for several milliseconds this function should only be   */
+   /* called from the main loop (never from a stack callback).  This    */
+   /* function returns zero if nothing was written, a positive value if */
+   /* the cache was written, or a negative value on error.              */
+int PeerCache_Flush(void);
+
+   /* The following function removes all entries from the cache (and    */
+   /* flags the cache to be written back on the next flush).            */
+void PeerCache_Clear(void);
+
+   /* The following functions are used to record paging information     */
+   /* about a remote device as it is learned from Inquiry Results,      */
+   /* Inquiry Entry Results and HCI events.  The Clock Offset passed in */
+   /* should be the value as reported by the controller.                */
+void PeerCache_UpdatePageInformation(BD_ADDR_t BD_ADDR, Byte_t Page_Scan_Repetition_Mode, Word_t Clock_Offset);
+void PeerCache_UpdatePageScanMode(BD_ADDR_t BD_ADDR, Byte_t Page_Scan_Repetition_Mode);
+void PeerCache_UpdateClassOfDevice(BD_ADDR_t BD_ADDR, Class_of_Device_t Class_of_Device);
+void PeerCache_UpdateFeatures(BD_ADDR_t BD_ADDR, LMP_Features_t *Features);
+
+   /* The following functions record and return the audio parameter set */
+   /* that worked for the specified device and codec (zero forgets it,  */
+   /* 0xFF marks a codec the device could not set up).                  */
+   /* PeerCache_QueryAudioSet() returns zero if no set is known.        */
+void PeerCache_UpdateAudioSet(BD_ADDR_t BD_ADDR, unsigned int Codec, Byte_t AudioSet);
+Byte_t PeerCache_QueryAudioSet(BD_ADDR_t BD_ADDR, unsigned int Codec);
+
+   /* The following functions are used to track connection handles so   */
+   /* that HCI events (which only carry a Connection Handle) can be     */
+   /* associated with the correct cache entry.                          */
+void PeerCache_ConnectionEstablished(BD_ADDR_t BD_ADDR, Word_t Connection_Handle);
+void PeerCache_ConnectionTerminated(Word_t Connection_Handle);
+void PeerCache_UpdateClockOffsetByHandle(Word_t Connection_Handle, Word_t Clock_Offset);
+void PeerCache_UpdateFeaturesByHandle(Word_t Connection_Handle, LMP_Features_t *Features);
+
+   /* The following function looks up the specified device in the cache.*/
+   /* If the device is present (and has valid paging information) the  */
+   /* entry is copied into the buffer passed in and this function       */
+   /* returns TRUE, otherwise it returns FALSE.                         */
+Boolean_t PeerCache_Query(BD_ADDR_t BD_ADDR, PeerCacheEntry_t *PeerCacheEntry);
+
+   /* The following functions are used to measure the page latency of   */
+   /* outgoing connections.  PeerCache_PageStarted() is called when the */
+   /* connection request is submitted (Cached denotes whether cached    */
+   /* paging parameters were used) and PeerCache_PageComplete() when    */
+   /* the Connection Complete event is received.  The latter returns the*/
+   /* measured latency (in milliseconds) or a negative value if no page */
+   /* was outstanding for the device.                                   */
+void PeerCache_PageStarted(BD_ADDR_t BD_ADDR, Boolean_t Cached);
+long PeerCache_PageComplete(BD_ADDR_t BD_ADDR, Byte_t Status);
+
+   /* The following function returns the current page latency statistics*/
+   /* and the list of cached devices (up to MaximumEntries).  The return*/
+   /* value is the number of entries copied.                            */
+int PeerCache_QueryStatistics(PeerCacheStatistics_t *Statistics, unsigned int MaximumEntries, PeerCacheEntry_t *EntryList);
+
+#endif
@@ -0,0 +1,186 @@
+/*****< profile.c >************************************************************/
+/*                                                                            */
+/*  Profile - Handler latency profiling with log2 histograms.                 */
+/*                                                                            */
+/******************************************************************************/
+#include "Main.h"          /* Application Interface Abstraction.              */
+#include "Profile.h"       /* Handler Profiling Prototypes/Constants.         */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+
+#ifdef PROFILE_ENABLE
+
+#if defined(__linux__)
+
+#include <time.h>
+
+#endif
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static Profile_Entry_t EntryList[PROFILE_MAXIMUM_ENTRIES]; /* Variable which    */
+                                                    /* holds the measured      */
+                                                    /* name/key pairs.         */
+
+static unsigned int    NumberEntries;               /* Variable which holds the*/
+                                                    /* number of valid entries */
+                                                    /* in the Entry List.      */
+
+static unsigned long   DroppedRecords;              /* Variable which holds the*/
+                                                    /* number of measurements  */
+                                                    /* that did not fit in the */
+                                                    /* Entry List.             */
+
+   /* Internal function prototypes.                                     */
+static unsigned int CountsToTenths(unsigned long long Counts);
+
+   /* The following function converts counts of the counter to tenths of*/
+   /* microseconds.                                                     */
+static unsigned int CountsToTenths(unsigned long long Counts)
+{
+   return((unsigned int)((Counts * 10ULL) / (PROFILE_COUNTER_FREQUENCY / 1000000UL)));
+}
+
+   /* The following function enables the cycle counter and clears all    */
+   /* measurements.                                                     */
+void Profile_Initialize(void)
+{
+#if !defined(__linux__)
+
+   /* The DWT is part of the trace unit, which must be enabled first.   */
+   *((volatile unsigned long *)PROFILE_DEMCR_REGISTER)    |= PROFILE_DEMCR_TRCENA;
+   *((volatile unsigned long *)PROFILE_DWT_CYCCNT_REGISTER)  = 0;
+   *((volatile unsigned long *)PROFILE_DWT_CTRL_REGISTER) |= PROFILE_DWT_CTRL_CYCCNTENA;
+
+#endif
+
+   Profile_Reset();
+}
+
+#if defined(__linux__)
+
+   /* The following function returns the monotonic time in nanoseconds   */
+   /* (the counter of the Linux build).                                 */
+unsigned long Profile_ReadCounter(void)
+{
+   struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+
+   return(((unsigned long)Now.tv_sec * 1000000000UL) + (unsigned long)Now.tv_nsec);
+}
+
+#endif
+
+   /* The following function records a measurement (in counts) of the    */
+   /* specified name/key pair.                                          */
+void Profile_Record(const char *Name, unsigned int Key, unsigned long Counts)
+{
+   unsigned int     Index;
+   unsigned int     Bucket;
+   unsigned long    Bound;
+   Profile_Entry_t *Entry;
+
+   for(Index=0;(Index<NumberEntries) && ((EntryList[Index].Name != Name) || (EntryList[Index].Key != Key));Index++)
+      ;
+
+   if(Index == NumberEntries)
+   {
+      if(NumberEntries == PROFILE_MAXIMUM_ENTRIES)
+      {
+         DroppedRecords++;
+         return;
+      }
+
+      EntryList[Index].Name = Name;
+      EntryList[Index].Key  = Key;
+
+      NumberEntries++;
+   }
+
+   Entry = &EntryList[Index];
+
+   Entry->Count++;
+   Entry->Total += Counts;
+
+   if(Counts > Entry->Maximum)
+      Entry->Maximum = Counts;
+
+   /* Find the first bucket whose bound is above the measurement.       */
+   for(Bucket=0,Bound=(1UL << PROFILE_FIRST_BUCKET_BITS);(Bucket < (PROFILE_NUMBER_BUCKETS - 1)) && (Counts >= Bound);Bucket++)
+      Bound <<= 1;
+
+   if(Entry->Histogram[Bucket] != 0xFFFF)
+      Entry->Histogram[Bucket]++;
+}
+
+   /* The following function copies up to MaximumEntries measured name/  */
+   /* key pairs to the specified buffer.  This function returns the     */
+   /* number of pairs that were copied.                                 */
+unsigned int Profile_QueryEntries(unsigned int MaximumEntries, Profile_Entry_t *Entries)
+{
+   unsigned int ret_val;
+
+   ret_val = (MaximumEntries < NumberEntries)?MaximumEntries:NumberEntries;
+
+   if((ret_val) && (Entries))
+      BTPS_MemCopy(Entries, EntryList, ret_val * sizeof(Profile_Entry_t));
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* The following function displays the measurements (count, mean and */
+   /* maximum in microseconds and the non-empty histogram buckets).     */
+void Profile_Display(void)
+{
+   unsigned int  Index;
+   unsigned int  Bucket;
+   unsigned int  Mean;
+   unsigned int  Maximum;
+   unsigned long Bound;
+
+   Display(("Handler Latency (us):\r\n"));
+   Display(("   %-24s %4s %8s %8s %8s\r\n", "Name", "Key", "Count", "Mean", "Max"));
+
+   for(Index=0;Index<NumberEntries;Index++)
+   {
+      Mean    = CountsToTenths(EntryList[Index].Total / EntryList[Index].Count);
+      Maximum = CountsToTenths(EntryList[Index].Maximum);
+
+      Display(("   %-24s %4u %8lu %6u.%u %6u.%u\r\n", EntryList[Index].Name, EntryList[Index].Key, EntryList[Index].Count, Mean / 10, Mean % 10, Maximum / 10, Maximum % 10));
+
+      /* Each bucket is shown with its upper bound, the last bucket     */
+      /* holds everything above the bound of the previous one.          */
+      Display(("     "));
+
+      for(Bucket=0,Bound=(1UL << PROFILE_FIRST_BUCKET_BITS);Bucket<PROFILE_NUMBER_BUCKETS;Bucket++,Bound<<=1)
+      {
+         if(EntryList[Index].Histogram[Bucket])
+         {
+            if(Bucket < (PROFILE_NUMBER_BUCKETS - 1))
+               Display((" <%u.%u:%u", CountsToTenths(Bound) / 10, CountsToTenths(Bound) % 10, EntryList[Index].Histogram[Bucket]));
+            else
+               Display((" >=%u.%u:%u", CountsToTenths(Bound >> 1) / 10, CountsToTenths(Bound >> 1) % 10, EntryList[Index].Histogram[Bucket]));
+         }
+      }
+
+      Display(("\r\n"));
+   }
+
+   if(DroppedRecords)
+      Display(("   %lu measurements dropped (increase PROFILE_MAXIMUM_ENTRIES).\r\n", DroppedRecords));
+}
+
+   /* The following function clears all measurements.                   */
+void Profile_Reset(void)
+{
+   BTPS_MemInitialize(EntryList, 0, sizeof(EntryList));
+
+   NumberEntries  = 0;
+   DroppedRecords = 0;
+}
+
+#endif
@@ -0,0 +1,145 @@
+/*****< profile.h >************************************************************/
+/*                                                                            */
+/*  Profile - Handler latency profiling with log2 histograms.                 */
+/*                                                                            */
+/*  The latency of an instrumented code section (event callbacks, console     */
+/*  commands) is measured with the DWT cycle counter of the Cortex-M4 (or     */
+/*  clock_gettime() in the Linux build, where the counter counts nano-        */
+/*  seconds) and accumulated in a fixed RAM histogram for the section.        */
+/*  Sections are identified by a name and a key (e.g. the event type), so a   */
+/*  single measurement around the switch of a callback gives one histogram    */
+/*  per case.                                                                 */
+/*                                                                            */
+/*  The profiling is only compiled in if PROFILE_ENABLE is defined, otherwise */
+/*  the macros below expand to nothing.                                       */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __PROFILEH__
+#define __PROFILEH__
+
+#ifndef PROFILE_MAXIMUM_ENTRIES
+
+#define PROFILE_MAXIMUM_ENTRIES                     (48)  /* Denotes the max   */
+                                                         /* number of name/key*/
+                                                         /* pairs that are    */
+                                                         /* measured (further */
+                                                         /* pairs are counted */
+                                                         /* as dropped).      */
+
+#endif
+
+#define PROFILE_NUMBER_BUCKETS                      (16)  /* Denotes the number*/
+                                                         /* of histogram      */
+                                                         /* buckets.          */
+
+#define PROFILE_FIRST_BUCKET_BITS                    (8)  /* Denotes the upper */
+                                                         /* bound (as a power */
+                                                         /* of two counts) of */
+                                                         /* the first bucket, */
+                                                         /* each further      */
+                                                         /* bucket doubles the*/
+                                                         /* bound (the last   */
+                                                         /* one is open).     */
+
+#ifndef PROFILE_COUNTER_FREQUENCY
+
+#if defined(__linux__)
+
+#define PROFILE_COUNTER_FREQUENCY           (1000000000UL)  /* Denotes the rate */
+                                                         /* (in Hz) of the    */
+                                                         /* counter.          */
+
+#else
+
+#define PROFILE_COUNTER_FREQUENCY             (80000000UL)  /* Denotes the rate */
+                                                         /* (in Hz) of the    */
+                                                         /* counter (the      */
+                                                         /* system clock).    */
+
+#endif
+
+#endif
+
+   /* The following constants are the Cortex-M4 debug registers that     */
+   /* provide the cycle counter.                                        */
+#define PROFILE_DEMCR_REGISTER                    (0xE000EDFCUL)
+#define PROFILE_DEMCR_TRCENA                      (0x01000000UL)
+#define PROFILE_DWT_CTRL_REGISTER                 (0xE0001000UL)
+#define PROFILE_DWT_CTRL_CYCCNTENA                (0x00000001UL)
+#define PROFILE_DWT_CYCCNT_REGISTER               (0xE0001004UL)
+
+   /* The following structure holds the measurements of a single name/  */
+   /* key pair.  All times are in counts of the counter.  The histogram */
+   /* counts saturate.                                                  */
+typedef struct _tagProfile_Entry_t
+{
+   const char         *Name;
+   unsigned int        Key;
+   unsigned long       Count;
+   unsigned long       Maximum;
+   unsigned long long  Total;
+   unsigned short      Histogram[PROFILE_NUMBER_BUCKETS];
+} Profile_Entry_t;
+
+#ifdef PROFILE_ENABLE
+
+#if defined(__linux__)
+
+#define PROFILE_READ_COUNTER()                    Profile_ReadCounter()
+
+#else
+
+#define PROFILE_READ_COUNTER()                    (*((volatile unsigned long *)PROFILE_DWT_CYCCNT_REGISTER))
+
+#endif
+
+   /* The following macros instrument a code section.  PROFILE_DECLARE() */
+   /* declares the variable that holds the start count (it must be used */
+   /* with the other local declarations), PROFILE_START() starts the    */
+   /* measurement and PROFILE_STOP() records it for the specified name  */
+   /* and key.  Names are compared by address, so a section that is     */
+   /* stopped in more than one place must use a single const char array */
+   /* for its name rather than repeating the string literal.            */
+#define PROFILE_INITIALIZE()                      Profile_Initialize()
+#define PROFILE_DECLARE(_x)                       unsigned long _x;
+#define PROFILE_START(_x)                         do { (_x) = PROFILE_READ_COUNTER(); } while(0)
+#define PROFILE_STOP(_x, _y, _z)                  Profile_Record((_y), (unsigned int)(_z), PROFILE_READ_COUNTER() - (_x))
+
+   /* The following function enables the cycle counter and clears all    */
+   /* measurements.                                                     */
+void Profile_Initialize(void);
+
+#if defined(__linux__)
+
+   /* The following function returns the monotonic time in nanoseconds   */
+   /* (the counter of the Linux build).                                 */
+unsigned long Profile_ReadCounter(void);
+
+#endif
+
+   /* The following function records a measurement (in counts) of the    */
+   /* specified name/key pair.                                          */
+void Profile_Record(const char *Name, unsigned int Key, unsigned long Counts);
+
+   /* The following function copies up to MaximumEntries measured name/  */
+   /* key pairs to the specified buffer.  This function returns the     */
+   /* number of pairs that were copied.                                 */
+unsigned int Profile_QueryEntries(unsigned int MaximumEntries, Profile_Entry_t *Entries);
+
+   /* The following function displays the measurements (count, mean and */
+   /* maximum in microseconds and the non-empty histogram buckets).     */
+void Profile_Display(void);
+
+   /* The following function clears all measurements.                   */
+void Profile_Reset(void);
+
+#else
+
+#define PROFILE_INITIALIZE()
+#define PROFILE_DECLARE(_x)
+#define PROFILE_START(_x)
+#define PROFILE_STOP(_x, _y, _z)
+
+#endif
+
+#endif
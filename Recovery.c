@@ -0,0 +1,261 @@
+/*****< recovery.c >***********************************************************/
+/*                                                                            */
+/*  Recovery - Retry scheduler with exponential backoff used to recover from  */
+/*             stack bring-up failures and lost links.                        */
+/*                                                                            */
+/******************************************************************************/
+#include "Recovery.h"      /* Recovery Prototypes/Constants.                  */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+
+   /* The following enumerated type represents the state of a recovery  */
+   /* operation.                                                        */
+typedef enum
+{
+   rsIdle,
+   rsWaiting,
+   rsAttemptPending
+} Recovery_State_t;
+
+   /* The following type definition represents the container type which */
+   /* holds the state of a single recovery operation.                   */
+typedef struct _tagRecovery_Operation_t
+{
+   Recovery_State_t      State;
+   Recovery_Action_t     Action;
+   unsigned long         CallbackParameter;
+   unsigned int          MaximumAttempts;
+   unsigned int          AttemptCount;
+   unsigned long         Delay;
+   unsigned long         FaultTime;
+   unsigned long         NextTime;
+   Recovery_Statistics_t Statistics;
+} Recovery_Operation_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static Recovery_Operation_t RecoveryOperations[RECOVERY_MAX_OPERATIONS]; /* Variable   */
+                                                    /* which holds the state of each   */
+                                                    /* recovery operation.             */
+
+static DWord_t              JitterSeed;             /* Variable which holds the state  */
+                                                    /* of the jitter random number     */
+                                                    /* generator.                      */
+
+   /* Internal function prototypes.                                     */
+static unsigned long ApplyJitter(unsigned long Delay);
+static void ScheduleNextAttempt(Recovery_Operation_t *Operation);
+static void OperationRecovered(Recovery_Operation_t *Operation);
+
+   /* The following function applies +/- RECOVERY_JITTER_PERCENT of     */
+   /* random jitter to the specified delay.  Jitter keeps several       */
+   /* devices that lost the same AG (or a controller reset) from        */
+   /* retrying in lock step.                                            */
+static unsigned long ApplyJitter(unsigned long Delay)
+{
+   unsigned long Range;
+
+   /* Seed the generator from the tick count the first time through     */
+   /* (the exact boot time varies enough between devices).              */
+   if(!JitterSeed)
+      JitterSeed = (DWord_t)BTPS_GetTickCount() | 1;
+
+   /* Simple xorshift generator.                                        */
+   JitterSeed ^= JitterSeed << 13;
+   JitterSeed ^= JitterSeed >> 17;
+   JitterSeed ^= JitterSeed << 5;
+
+   Range = (Delay * RECOVERY_JITTER_PERCENT) / 100;
+
+   if(Range)
+      Delay = (Delay - Range) + (JitterSeed % ((Range * 2) + 1));
+
+   return(Delay);
+}
+
+   /* The following function schedules the next attempt of the specified*/
+   /* operation and doubles the backoff delay.                          */
+static void ScheduleNextAttempt(Recovery_Operation_t *Operation)
+{
+   if((Operation->MaximumAttempts) && (Operation->AttemptCount >= Operation->MaximumAttempts))
+   {
+      /* Give up on this operation.                                     */
+      Operation->Statistics.Abandoned++;
+      Operation->State = rsIdle;
+   }
+   else
+   {
+      Operation->NextTime = BTPS_GetTickCount() + ApplyJitter(Operation->Delay);
+      Operation->State    = rsWaiting;
+
+      Operation->Delay   *= 2;
+      if(Operation->Delay > RECOVERY_MAXIMUM_DELAY_MS)
+         Operation->Delay = RECOVERY_MAXIMUM_DELAY_MS;
+   }
+}
+
+   /* The following function updates the statistics of an operation    */
+   /* that has recovered.                                               */
+static void OperationRecovered(Recovery_Operation_t *Operation)
+{
+   unsigned long TimeToRecover = BTPS_GetTickCount() - Operation->FaultTime;
+
+   Operation->Statistics.Recoveries++;
+   Operation->Statistics.LastTimeToRecover   = TimeToRecover;
+   Operation->Statistics.TotalTimeToRecover += TimeToRecover;
+
+   if(TimeToRecover > Operation->Statistics.MaximumTimeToRecover)
+      Operation->Statistics.MaximumTimeToRecover = TimeToRecover;
+
+   Operation->State = rsIdle;
+}
+
+   /* The following function is used to report a fault and start the    */
+   /* recovery of the specified operation.  The Action will be invoked  */
+   /* from Recovery_Process() with exponentially increasing (jittered)  */
+   /* delays until it succeeds, the operation is cancelled or (if       */
+   /* MaximumAttempts is non-zero) the maximum number of attempts has   */
+   /* been made.  If the operation is already recovering this call does */
+   /* nothing.  This function returns zero if successful or a negative  */
+   /* value if the parameters are invalid.                              */
+int Recovery_Start(unsigned int RecoveryID, Recovery_Action_t Action, unsigned long CallbackParameter, unsigned int MaximumAttempts)
+{
+   int                   ret_val;
+   Recovery_Operation_t *Operation;
+
+   if((RecoveryID < RECOVERY_MAX_OPERATIONS) && (Action))
+   {
+      Operation = &(RecoveryOperations[RecoveryID]);
+
+      if(Operation->State == rsIdle)
+      {
+         Operation->Action            = Action;
+         Operation->CallbackParameter = CallbackParameter;
+         Operation->MaximumAttempts   = MaximumAttempts;
+         Operation->AttemptCount      = 0;
+         Operation->Delay             = RECOVERY_INITIAL_DELAY_MS;
+         Operation->FaultTime         = BTPS_GetTickCount();
+
+         Operation->Statistics.Faults++;
+
+         ScheduleNextAttempt(Operation);
+      }
+
+      ret_val = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function is used to report the result of an         */
+   /* asynchronous attempt that was started by a Recovery Action.  A    */
+   /* successful result may also be reported while waiting for the next*/
+   /* attempt (for example, the remote device reconnected on its own).  */
+void Recovery_Complete(unsigned int RecoveryID, Boolean_t Success)
+{
+   Recovery_Operation_t *Operation;
+
+   if(RecoveryID < RECOVERY_MAX_OPERATIONS)
+   {
+      Operation = &(RecoveryOperations[RecoveryID]);
+
+      if(Success)
+      {
+         if(Operation->State != rsIdle)
+            OperationRecovered(Operation);
+      }
+      else
+      {
+         if(Operation->State == rsAttemptPending)
+            ScheduleNextAttempt(Operation);
+      }
+   }
+}
+
+   /* The following function stops the recovery of the specified        */
+   /* operation without counting it as recovered.                       */
+void Recovery_Cancel(unsigned int RecoveryID)
+{
+   if(RecoveryID < RECOVERY_MAX_OPERATIONS)
+      RecoveryOperations[RecoveryID].State = rsIdle;
+}
+
+   /* The following function returns TRUE if the specified operation is */
+   /* currently being recovered.                                        */
+Boolean_t Recovery_InProgress(unsigned int RecoveryID)
+{
+   return((Boolean_t)((RecoveryID < RECOVERY_MAX_OPERATIONS) && (RecoveryOperations[RecoveryID].State != rsIdle)));
+}
+
+   /* The following function must be called periodically from the main  */
+   /* loop.  It runs every recovery attempt that is due and times out   */
+   /* asynchronous attempts that never completed.                       */
+void Recovery_Process(void)
+{
+   int                   Result;
+   unsigned int          Index;
+   unsigned long         CurrentTime;
+   Recovery_Operation_t *Operation;
+
+   for(Index=0;Index<RECOVERY_MAX_OPERATIONS;Index++)
+   {
+      Operation   = &(RecoveryOperations[Index]);
+      CurrentTime = BTPS_GetTickCount();
+
+      /* Note the signed compare so that tick count wrap is handled.    */
+      if((Operation->State != rsIdle) && ((long)(CurrentTime - Operation->NextTime) >= 0))
+      {
+         if(Operation->State == rsWaiting)
+         {
+            Operation->AttemptCount++;
+            Operation->Statistics.Attempts++;
+
+            /* Flag the attempt as pending before calling the action so */
+            /* that an action that completes synchronously (through     */
+            /* Recovery_Complete()) is handled correctly.               */
+            Operation->State    = rsAttemptPending;
+            Operation->NextTime = CurrentTime + RECOVERY_ATTEMPT_TIMEOUT_MS;
+
+            Result = (*Operation->Action)(Operation->CallbackParameter);
+
+            if(Operation->State == rsAttemptPending)
+            {
+               if(Result > 0)
+                  OperationRecovered(Operation);
+               else
+               {
+                  if(Result < 0)
+                     ScheduleNextAttempt(Operation);
+               }
+            }
+         }
+         else
+         {
+            /* The asynchronous attempt timed out.                      */
+            ScheduleNextAttempt(Operation);
+         }
+      }
+   }
+}
+
+   /* The following function returns the statistics of the specified    */
+   /* operation.  This function returns zero if successful or a negative*/
+   /* value if the parameters are invalid.                              */
+int Recovery_QueryStatistics(unsigned int RecoveryID, Recovery_Statistics_t *Statistics)
+{
+   int ret_val;
+
+   if((RecoveryID < RECOVERY_MAX_OPERATIONS) && (Statistics))
+   {
+      *Statistics = RecoveryOperations[RecoveryID].Statistics;
+
+      ret_val     = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
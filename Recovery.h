@@ -0,0 +1,97 @@
+/*****< recovery.h >***********************************************************/
+/*                                                                            */
+/*  Recovery - Retry scheduler with exponential backoff used to recover from  */
+/*             stack bring-up failures and lost links.                        */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __RECOVERYH__
+#define __RECOVERYH__
+
+#include "SS1BTPS.h"       /* Includes for the SS1 Bluetooth Protocol Stack.  */
+
+   /* The following constants define the recovery operations that are   */
+   /* known to the application.  Each operation is scheduled and tracked*/
+   /* independently.                                                    */
+#define RECOVERY_ID_STACK                                 (0)
+#define RECOVERY_ID_HFP_PEER                              (1)
+
+#define RECOVERY_MAX_OPERATIONS                           (2)
+
+#define RECOVERY_INITIAL_DELAY_MS                       (250)  /* Denotes the  */
+                                                         /* delay before the  */
+                                                         /* first attempt.    */
+
+#define RECOVERY_MAXIMUM_DELAY_MS                     (30000)  /* Denotes the  */
+                                                         /* max delay between */
+                                                         /* attempts.         */
+
+#define RECOVERY_ATTEMPT_TIMEOUT_MS                   (15000)  /* Denotes how  */
+                                                         /* long an           */
+                                                         /* asynchronous      */
+                                                         /* attempt may take  */
+                                                         /* before it is      */
+                                                         /* considered failed.*/
+
+#define RECOVERY_JITTER_PERCENT                          (25)  /* Denotes the  */
+                                                         /* +/- random jitter */
+                                                         /* applied to each   */
+                                                         /* delay.            */
+
+   /* The following type definition represents the function that is     */
+   /* called to perform a single recovery attempt.  The function should */
+   /* return a positive value if the operation recovered, zero if an    */
+   /* asynchronous attempt was started (the result must then be reported*/
+   /* with Recovery_Complete()), or a negative value if the attempt     */
+   /* failed.                                                           */
+typedef int (*Recovery_Action_t)(unsigned long CallbackParameter);
+
+   /* The following structure holds the statistics that are kept for    */
+   /* each recovery operation.  All times are in milliseconds.  The Time*/
+   /* To Recover is measured from the fault being reported until the    */
+   /* operation recovered.                                              */
+typedef struct _tagRecovery_Statistics_t
+{
+   unsigned int  Faults;
+   unsigned int  Attempts;
+   unsigned int  Recoveries;
+   unsigned int  Abandoned;
+   unsigned long LastTimeToRecover;
+   unsigned long MaximumTimeToRecover;
+   unsigned long TotalTimeToRecover;
+} Recovery_Statistics_t;
+
+   /* The following function is used to report a fault and start the    */
+   /* recovery of the specified operation.  The Action will be invoked  */
+   /* from Recovery_Process() with exponentially increasing (jittered)  */
+   /* delays until it succeeds, the operation is cancelled or (if       */
+   /* MaximumAttempts is non-zero) the maximum number of attempts has   */
+   /* been made.  If the operation is already recovering this call does */
+   /* nothing.  This function returns zero if successful or a negative  */
+   /* value if the parameters are invalid.                              */
+int Recovery_Start(unsigned int RecoveryID, Recovery_Action_t Action, unsigned long CallbackParameter, unsigned int MaximumAttempts);
+
+   /* The following function is used to report the result of an         */
+   /* asynchronous attempt that was started by a Recovery Action.  A    */
+   /* successful result may also be reported while waiting for the next*/
+   /* attempt (for example, the remote device reconnected on its own).  */
+void Recovery_Complete(unsigned int RecoveryID, Boolean_t Success);
+
+   /* The following function stops the recovery of the specified        */
+   /* operation without counting it as recovered.                       */
+void Recovery_Cancel(unsigned int RecoveryID);
+
+   /* The following function returns TRUE if the specified operation is */
+   /* currently being recovered.                                        */
+Boolean_t Recovery_InProgress(unsigned int RecoveryID);
+
+   /* The following function must be called periodically from the main  */
+   /* loop.  It runs every recovery attempt that is due and times out   */
+   /* asynchronous attempts that never completed.                       */
+void Recovery_Process(void);
+
+   /* The following function returns the statistics of the specified    */
+   /* operation.  This function returns zero if successful or a negative*/
+   /* value if the parameters are invalid.                              */
+int Recovery_QueryStatistics(unsigned int RecoveryID, Recovery_Statistics_t *Statistics);
+
+#endif
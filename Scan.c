@@ -0,0 +1,575 @@
+/*****< scan.c >***************************************************************/
+/*                                                                            */
+/*  Scan - LE scanner with duplicate suppression and RSSI aggregation.        */
+/*                                                                            */
+/******************************************************************************/
+#include "Main.h"          /* Application Interface Abstraction.              */
+#include "Scan.h"          /* LE Scanner Prototypes/Constants.                */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+
+#ifdef SCAN_ENABLE
+
+#define SCAN_HASH_BUCKETS              (SCAN_MAXIMUM_DEVICES)  /* Denotes the  */
+                                                         /* number of buckets */
+                                                         /* of the device     */
+                                                         /* table.            */
+
+#define SCAN_RSSI_SLOT_MS    (SCAN_RSSI_WINDOW_MS / SCAN_RSSI_SLOTS)  /* Denotes*/
+                                                         /* the length of a   */
+                                                         /* window slot.      */
+
+#define MAXIMUM_SLOT_REPORTS                       (255)  /* Denotes the number*/
+                                                         /* of reports that   */
+                                                         /* are averaged per  */
+                                                         /* slot (the sum     */
+                                                         /* must fit a word). */
+
+#define FNV_OFFSET_BASIS                     (2166136261UL)
+#define FNV_PRIME                              (16777619UL)
+
+   /* The following type definition represents the container type which */
+   /* holds a tracked device.  The devices are chained per bucket (and  */
+   /* the free ones in the free list) by index + 1, zero ends a chain.  */
+   /* The data hashes are the ones of the advertising data and of the   */
+   /* scan response.                                                    */
+typedef struct _tagScanDevice_t
+{
+   Byte_t        NextDevice;
+   Byte_t        InUse;
+   Byte_t        Address_Type;
+   SByte_t       ReportedRSSI;
+   BD_ADDR_t     BD_ADDR;
+   DWord_t       DataHash[2];
+   unsigned long LastSeen;
+   SWord_t       RSSISum[SCAN_RSSI_SLOTS];
+   Byte_t        RSSICount[SCAN_RSSI_SLOTS];
+} ScanDevice_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static unsigned int           ScanStackID;          /* Variables which hold the*/
+static Scan_Report_Callback_t ScanCallback;         /* stack that is scanned   */
+static unsigned long          ScanCallbackParameter; /* (zero if not scanning)*/
+                                                    /* and the callback of the */
+                                                    /* application.            */
+
+static ScanDevice_t           ScanDevices[SCAN_MAXIMUM_DEVICES]; /* Variables   */
+static Byte_t                 HashBuckets[SCAN_HASH_BUCKETS]; /* which hold the*/
+static Byte_t                 FreeDevice;           /* tracked devices, the    */
+                                                    /* buckets and the free    */
+                                                    /* list.                   */
+
+static Byte_t                 BloomBits[2][SCAN_BLOOM_BITS / 8]; /* Variables   */
+static unsigned int           BloomGeneration;      /* which hold the two bloom*/
+static unsigned long          GenerationStartTime;  /* filter generations and  */
+                                                    /* which one is current.   */
+
+static unsigned int           CurrentSlot;          /* Variables which hold the*/
+static unsigned long          SlotStartTime;        /* current slot of the RSSI*/
+                                                    /* windows.                */
+
+static Scan_Statistics_t      ScanStatistics;       /* Variable which holds the*/
+                                                    /* statistics.             */
+
+   /* Internal function prototypes.                                     */
+static DWord_t HashBytes(DWord_t Hash, unsigned int Length, Byte_t *Data);
+static DWord_t HashAddress(Byte_t Address_Type, BD_ADDR_t BD_ADDR);
+static Boolean_t BloomTestAndSet(DWord_t Key);
+static ScanDevice_t *FindDevice(DWord_t AddressHash, Byte_t Address_Type, BD_ADDR_t BD_ADDR);
+static void UnlinkDevice(ScanDevice_t *Device);
+static ScanDevice_t *AllocateDevice(DWord_t AddressHash, Boolean_t Evict);
+static void Deliver(Scan_Report_t *Report);
+static void DeliverDevice(ScanDevice_t *Device, Scan_Report_Reason_t Reason, unsigned int Reports);
+static void ProcessReport(GAP_LE_Advertising_Report_Data_t *ReportData);
+static void BTPSAPI GAP_LE_Event_Callback(unsigned int BluetoothStackID, GAP_LE_Event_Data_t *GAP_LE_Event_Data, unsigned long CallbackParameter);
+
+   /* The following function continues the FNV-1a hash of the specified  */
+   /* bytes.                                                            */
+static DWord_t HashBytes(DWord_t Hash, unsigned int Length, Byte_t *Data)
+{
+   while(Length--)
+   {
+      Hash ^= *(Data++);
+      Hash *= FNV_PRIME;
+   }
+
+   return(Hash);
+}
+
+   /* The following function returns the hash of a device address.     */
+static DWord_t HashAddress(Byte_t Address_Type, BD_ADDR_t BD_ADDR)
+{
+   DWord_t Hash;
+
+   Hash = HashBytes(FNV_OFFSET_BASIS, sizeof(Address_Type), &Address_Type);
+
+   return(HashBytes(Hash, sizeof(BD_ADDR), (Byte_t *)&BD_ADDR));
+}
+
+   /* The following function returns TRUE if the specified key is in    */
+   /* either generation of the bloom filter.  The key is (re)added to   */
+   /* the current generation, so it is forgotten one to two lifetimes   */
+   /* after it was last seen.  The bits are derived by double hashing of*/
+   /* the key.                                                          */
+static Boolean_t BloomTestAndSet(DWord_t Key)
+{
+   Boolean_t    ret_val;
+   Byte_t       Found[2];
+   Byte_t       Mask[SCAN_BLOOM_HASHES];
+   DWord_t      Step;
+   unsigned int Byte[SCAN_BLOOM_HASHES];
+   unsigned int Index;
+
+   Step     = ((Key >> 16) | (Key << 16)) | 1;
+   Found[0] = TRUE;
+   Found[1] = TRUE;
+
+   for(Index=0;Index<SCAN_BLOOM_HASHES;Index++)
+   {
+      Byte[Index] = (unsigned int)(((Key + (Index * Step)) & (SCAN_BLOOM_BITS - 1)) >> 3);
+      Mask[Index] = (Byte_t)(1 << ((Key + (Index * Step)) & 7));
+
+      if(!(BloomBits[0][Byte[Index]] & Mask[Index]))
+         Found[0] = FALSE;
+
+      if(!(BloomBits[1][Byte[Index]] & Mask[Index]))
+         Found[1] = FALSE;
+   }
+
+   ret_val = (Boolean_t)((Found[0]) || (Found[1]));
+
+   if(!Found[BloomGeneration])
+   {
+      for(Index=0;Index<SCAN_BLOOM_HASHES;Index++)
+         BloomBits[BloomGeneration][Byte[Index]] |= Mask[Index];
+
+      ScanStatistics.BloomInserts++;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the tracked device with the        */
+   /* specified address, or NULL if the device is not tracked.          */
+static ScanDevice_t *FindDevice(DWord_t AddressHash, Byte_t Address_Type, BD_ADDR_t BD_ADDR)
+{
+   Byte_t        Index;
+   ScanDevice_t *ret_val = NULL;
+
+   for(Index=HashBuckets[AddressHash % SCAN_HASH_BUCKETS];Index;Index=ScanDevices[Index - 1].NextDevice)
+   {
+      if((ScanDevices[Index - 1].Address_Type == Address_Type) && (COMPARE_BD_ADDR(ScanDevices[Index - 1].BD_ADDR, BD_ADDR)))
+      {
+         ret_val = &ScanDevices[Index - 1];
+         break;
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function removes a tracked device from its bucket   */
+   /* and puts it into the free list.                                   */
+static void UnlinkDevice(ScanDevice_t *Device)
+{
+   Byte_t *Link;
+   Byte_t  DeviceIndex;
+
+   DeviceIndex = (Byte_t)((Device - ScanDevices) + 1);
+
+   for(Link=&HashBuckets[HashAddress(Device->Address_Type, Device->BD_ADDR) % SCAN_HASH_BUCKETS];*Link;Link=&(ScanDevices[*Link - 1].NextDevice))
+   {
+      if(*Link == DeviceIndex)
+      {
+         *Link = Device->NextDevice;
+         break;
+      }
+   }
+
+   Device->InUse      = FALSE;
+   Device->NextDevice = FreeDevice;
+   FreeDevice         = DeviceIndex;
+
+   ScanStatistics.TrackedDevices--;
+}
+
+   /* The following function takes a device from the free list and puts */
+   /* it into the bucket of the specified address.  If the table is full*/
+   /* and Evict is TRUE the device that was silent the longest is       */
+   /* reused, but only if it was silent for a whole RSSI window (so an  */
+   /* active device is never replaced by a passing one).  This function */
+   /* returns NULL if no device is available.                           */
+static ScanDevice_t *AllocateDevice(DWord_t AddressHash, Boolean_t Evict)
+{
+   ScanDevice_t  *ret_val = NULL;
+   unsigned int   Index;
+   unsigned long  Now;
+
+   if((!FreeDevice) && (Evict))
+   {
+      Now = BTPS_GetTickCount();
+
+      for(Index=0;Index<SCAN_MAXIMUM_DEVICES;Index++)
+      {
+         if(((Now - ScanDevices[Index].LastSeen) >= SCAN_RSSI_WINDOW_MS) && ((!ret_val) || ((long)(ScanDevices[Index].LastSeen - ret_val->LastSeen) < 0)))
+            ret_val = &ScanDevices[Index];
+      }
+
+      if(ret_val)
+      {
+         UnlinkDevice(ret_val);
+
+         ScanStatistics.Evicted++;
+      }
+   }
+
+   if(FreeDevice)
+   {
+      ret_val    = &ScanDevices[FreeDevice - 1];
+      FreeDevice = ret_val->NextDevice;
+
+      BTPS_MemInitialize(ret_val, 0, sizeof(ScanDevice_t));
+
+      ret_val->InUse                              = TRUE;
+      ret_val->NextDevice                         = HashBuckets[AddressHash % SCAN_HASH_BUCKETS];
+      HashBuckets[AddressHash % SCAN_HASH_BUCKETS] = (Byte_t)((ret_val - ScanDevices) + 1);
+
+      ScanStatistics.TrackedDevices++;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function passes a report to the application.         */
+static void Deliver(Scan_Report_t *Report)
+{
+   ScanStatistics.Delivered++;
+
+   if(ScanCallback)
+      (*ScanCallback)(Report, ScanCallbackParameter);
+}
+
+   /* The following function delivers a window report (a changed average*/
+   /* or a lost device) of a tracked device.                            */
+static void DeliverDevice(ScanDevice_t *Device, Scan_Report_Reason_t Reason, unsigned int Reports)
+{
+   Scan_Report_t Report;
+
+   BTPS_MemInitialize(&Report, 0, sizeof(Report));
+
+   Report.Reason       = Reason;
+   Report.Tracked      = TRUE;
+   Report.Address_Type = (GAP_LE_Address_Type_t)Device->Address_Type;
+   Report.BD_ADDR      = Device->BD_ADDR;
+   Report.RSSI         = Device->ReportedRSSI;
+   Report.Reports      = Reports;
+
+   Deliver(&Report);
+}
+
+   /* The following function filters a single advertising report.  This */
+   /* is the path every report takes, it must stay cheap.               */
+static void ProcessReport(GAP_LE_Advertising_Report_Data_t *ReportData)
+{
+   Byte_t                Address_Type;
+   DWord_t               AddressHash;
+   DWord_t               DataHash;
+   Boolean_t             Known;
+   Boolean_t             Suppressed;
+   ScanDevice_t         *Device;
+   unsigned int          Kind;
+   unsigned int          Index;
+   Scan_Report_t         Report;
+   Scan_Report_Reason_t  Reason;
+
+   ScanStatistics.Received++;
+
+   /* A data hash of zero marks a tracked device that did not send this */
+   /* kind of data yet.                                                 */
+   Address_Type = (Byte_t)ReportData->Address_Type;
+   Kind         = (ReportData->Advertising_Report_Type == rtScanResponse)?1:0;
+   AddressHash  = HashAddress(Address_Type, ReportData->BD_ADDR);
+   DataHash     = HashBytes(FNV_OFFSET_BASIS ^ Kind, ReportData->Raw_Report_Length, ReportData->Raw_Report_Data) | 1;
+   Suppressed   = FALSE;
+   Reason       = srNew;
+
+   if((Device = FindDevice(AddressHash, Address_Type, ReportData->BD_ADDR)) != NULL)
+   {
+      Device->LastSeen = BTPS_GetTickCount();
+
+      if(Device->RSSICount[CurrentSlot] < MAXIMUM_SLOT_REPORTS)
+      {
+         Device->RSSISum[CurrentSlot] += ReportData->RSSI;
+         Device->RSSICount[CurrentSlot]++;
+      }
+
+      if(Device->DataHash[Kind] == DataHash)
+      {
+         Suppressed = TRUE;
+
+         ScanStatistics.SuppressedTracked++;
+      }
+      else
+      {
+         if(Device->DataHash[Kind])
+            Reason = srDataChanged;
+
+         Device->DataHash[Kind] = DataHash;
+      }
+   }
+   else
+   {
+      /* A device that is not tracked is suppressed if the bloom filter */
+      /* knows its address and data, unless a device is free to track   */
+      /* it (e.g. it was lost and is back).  Only a device the filter   */
+      /* does not know may replace a silent tracked device.             */
+      Known = BloomTestAndSet(AddressHash ^ (DataHash * 0x9E3779B1UL));
+
+      if((Device = AllocateDevice(AddressHash, (Boolean_t)(!Known))) != NULL)
+      {
+         Device->Address_Type   = Address_Type;
+         Device->BD_ADDR        = ReportData->BD_ADDR;
+         Device->ReportedRSSI   = ReportData->RSSI;
+         Device->DataHash[Kind] = DataHash;
+         Device->LastSeen       = BTPS_GetTickCount();
+
+         Device->RSSISum[CurrentSlot]   = ReportData->RSSI;
+         Device->RSSICount[CurrentSlot] = 1;
+      }
+      else
+      {
+         if(Known)
+         {
+            Suppressed = TRUE;
+
+            ScanStatistics.SuppressedBloom++;
+         }
+         else
+            ScanStatistics.Untracked++;
+      }
+   }
+
+   if(!Suppressed)
+   {
+      Report.Reason       = Reason;
+      Report.Tracked      = (Boolean_t)(Device != NULL);
+      Report.Address_Type = ReportData->Address_Type;
+      Report.BD_ADDR      = ReportData->BD_ADDR;
+      Report.Report_Type  = ReportData->Advertising_Report_Type;
+      Report.RSSI         = ReportData->RSSI;
+      Report.Reports      = 0;
+      Report.Data_Length  = ReportData->Raw_Report_Length;
+      Report.Data         = ReportData->Raw_Report_Data;
+
+      if(Device)
+      {
+         for(Index=0;Index<SCAN_RSSI_SLOTS;Index++)
+            Report.Reports += Device->RSSICount[Index];
+      }
+
+      Deliver(&Report);
+   }
+}
+
+   /* The following function is the GAP LE event callback of the scan,  */
+   /* it filters the advertising reports.                               */
+static void BTPSAPI GAP_LE_Event_Callback(unsigned int BluetoothStackID, GAP_LE_Event_Data_t *GAP_LE_Event_Data, unsigned long CallbackParameter)
+{
+   unsigned int Index;
+
+   if((ScanStackID) && (GAP_LE_Event_Data) && (GAP_LE_Event_Data->Event_Data_Type == etLE_Advertising_Report) && (GAP_LE_Event_Data->Event_Data.GAP_LE_Advertising_Report_Event_Data))
+   {
+      for(Index=0;(ScanStackID) && (Index<GAP_LE_Event_Data->Event_Data.GAP_LE_Advertising_Report_Event_Data->Number_Device_Entries);Index++)
+         ProcessReport(&(GAP_LE_Event_Data->Event_Data.GAP_LE_Advertising_Report_Event_Data->Advertising_Data[Index]));
+   }
+}
+
+   /* The following function starts scanning (active scanning requests  */
+   /* the scan responses too) with the specified interval and window (in*/
+   /* 0.625 ms units).  The tracked devices and the bloom filter are    */
+   /* cleared.  This function returns zero if successful or a negative  */
+   /* error code.                                                       */
+int Scan_Start(unsigned int BluetoothStackID, Boolean_t Active, Word_t Interval, Word_t Window, Scan_Report_Callback_t Callback, unsigned long CallbackParameter)
+{
+   int          ret_val;
+   unsigned int Index;
+
+   if((BluetoothStackID) && (Callback))
+   {
+      if(ScanStackID)
+         Scan_Stop();
+
+      BTPS_MemInitialize(ScanDevices, 0, sizeof(ScanDevices));
+      BTPS_MemInitialize(HashBuckets, 0, sizeof(HashBuckets));
+      BTPS_MemInitialize(BloomBits, 0, sizeof(BloomBits));
+
+      for(Index=0;Index<SCAN_MAXIMUM_DEVICES;Index++)
+         ScanDevices[Index].NextDevice = (Byte_t)((Index + 1 < SCAN_MAXIMUM_DEVICES)?(Index + 2):0);
+
+      FreeDevice            = 1;
+      BloomGeneration       = 0;
+      CurrentSlot           = 0;
+      GenerationStartTime   = BTPS_GetTickCount();
+      SlotStartTime         = GenerationStartTime;
+      ScanCallback          = Callback;
+      ScanCallbackParameter = CallbackParameter;
+
+      BTPS_MemInitialize(&ScanStatistics, 0, sizeof(ScanStatistics));
+
+      /* Duplicates are filtered here, the controller has to pass every */
+      /* report (and with it every RSSI).                               */
+      if((ret_val = GAP_LE_Perform_Scan(BluetoothStackID, (Active?stActive:stPassive), Interval, Window, latPublic, fpNoFilter, FALSE, GAP_LE_Event_Callback, 0)) == 0)
+         ScanStackID = BluetoothStackID;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function stops scanning.                            */
+void Scan_Stop(void)
+{
+   if(ScanStackID)
+   {
+      GAP_LE_Cancel_Scan(ScanStackID);
+
+      ScanStackID = 0;
+   }
+}
+
+   /* The following function must be called periodically from the main  */
+   /* loop.  It advances the RSSI windows (delivering changed averages),*/
+   /* reports and drops silent devices and rotates the bloom filter.    */
+void Scan_Process(void)
+{
+   int            Sum;
+   int            Average;
+   unsigned int   Count;
+   unsigned int   Slot;
+   unsigned int   Index;
+   unsigned long  Now;
+   ScanDevice_t  *Device;
+
+   if(ScanStackID)
+   {
+      Now = BTPS_GetTickCount();
+
+      if((Now - SlotStartTime) >= SCAN_RSSI_SLOT_MS)
+      {
+         for(Index=0;(ScanStackID) && (Index<SCAN_MAXIMUM_DEVICES);Index++)
+         {
+            Device = &ScanDevices[Index];
+
+            if(Device->InUse)
+            {
+               if((Now - Device->LastSeen) >= SCAN_DEVICE_TIMEOUT_MS)
+               {
+                  UnlinkDevice(Device);
+
+                  ScanStatistics.Lost++;
+
+                  DeliverDevice(Device, srLost, 0);
+               }
+               else
+               {
+                  for(Slot=0,Sum=0,Count=0;Slot<SCAN_RSSI_SLOTS;Slot++)
+                  {
+                     Sum   += Device->RSSISum[Slot];
+                     Count += Device->RSSICount[Slot];
+                  }
+
+                  if(Count)
+                  {
+                     /* Round to the nearest dB.                        */
+                     Average = (Sum < 0)?-(int)((-Sum + (int)(Count / 2)) / (int)Count):(int)((Sum + (int)(Count / 2)) / (int)Count);
+
+                     if((Average >= (Device->ReportedRSSI + SCAN_RSSI_CHANGE_DB)) || (Average <= (Device->ReportedRSSI - SCAN_RSSI_CHANGE_DB)))
+                     {
+                        Device->ReportedRSSI = (SByte_t)Average;
+
+                        DeliverDevice(Device, srRSSIChanged, Count);
+                     }
+                  }
+
+                  /* The oldest slot becomes the new current slot.      */
+                  Slot                    = (CurrentSlot + 1) % SCAN_RSSI_SLOTS;
+                  Device->RSSISum[Slot]   = 0;
+                  Device->RSSICount[Slot] = 0;
+               }
+            }
+         }
+
+         CurrentSlot = (CurrentSlot + 1) % SCAN_RSSI_SLOTS;
+
+         /* Do not try to catch up after a long main loop pass.         */
+         if((Now - SlotStartTime) >= (2 * SCAN_RSSI_SLOT_MS))
+            SlotStartTime = Now;
+         else
+            SlotStartTime += SCAN_RSSI_SLOT_MS;
+      }
+
+      /* The previous generation is dropped and the current one becomes */
+      /* the previous, so a key is remembered for one to two lifetimes. */
+      if((Now - GenerationStartTime) >= SCAN_BLOOM_ROTATE_MS)
+      {
+         BloomGeneration = (BloomGeneration + 1) % 2;
+
+         BTPS_MemInitialize(BloomBits[BloomGeneration], 0, sizeof(BloomBits[BloomGeneration]));
+
+         GenerationStartTime = Now;
+
+         ScanStatistics.Rotations++;
+         ScanStatistics.BloomInserts = 0;
+      }
+   }
+}
+
+   /* The following function returns the statistics of the scanner.     */
+   /* This function returns zero if successful or a negative value if   */
+   /* the parameter is invalid.                                         */
+int Scan_QueryStatistics(Scan_Statistics_t *Statistics)
+{
+   int ret_val;
+
+   if(Statistics)
+   {
+      *Statistics = ScanStatistics;
+      ret_val     = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function displays the statistics of the scanner and */
+   /* the tracked devices.                                              */
+void Scan_Display(void)
+{
+   unsigned int  Index;
+   unsigned long Now;
+
+   Display(("Scan %s:\r\n", ScanStackID?"running":"stopped"));
+   Display(("   %-20s %lu\r\n", "Reports", ScanStatistics.Received));
+   Display(("   %-20s %lu\r\n", "Delivered", ScanStatistics.Delivered));
+   Display(("   %-20s %lu tracked, %lu bloom\r\n", "Suppressed", ScanStatistics.SuppressedTracked, ScanStatistics.SuppressedBloom));
+   Display(("   %-20s %lu\r\n", "Untracked", ScanStatistics.Untracked));
+   Display(("   %-20s %lu evicted, %lu lost\r\n", "Dropped", ScanStatistics.Evicted, ScanStatistics.Lost));
+   Display(("   %-20s %u of %u bits set (%lu rotations)\r\n", "Bloom", (ScanStatistics.BloomInserts * SCAN_BLOOM_HASHES), SCAN_BLOOM_BITS, ScanStatistics.Rotations));
+   Display(("   %-20s %u of %u\r\n", "Tracked", ScanStatistics.TrackedDevices, SCAN_MAXIMUM_DEVICES));
+
+   Now = BTPS_GetTickCount();
+
+   for(Index=0;Index<SCAN_MAXIMUM_DEVICES;Index++)
+   {
+      if(ScanDevices[Index].InUse)
+      {
+         Display(("   %02X:%02X:%02X:%02X:%02X:%02X %4d dBm %6lu ms ago\r\n", ScanDevices[Index].BD_ADDR.BD_ADDR5, ScanDevices[Index].BD_ADDR.BD_ADDR4, ScanDevices[Index].BD_ADDR.BD_ADDR3, ScanDevices[Index].BD_ADDR.BD_ADDR2, ScanDevices[Index].BD_ADDR.BD_ADDR1, ScanDevices[Index].BD_ADDR.BD_ADDR0, ScanDevices[Index].ReportedRSSI, (Now - ScanDevices[Index].LastSeen)));
+      }
+   }
+}
+
+#endif
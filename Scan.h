@@ -0,0 +1,171 @@
+/*****< scan.h >***************************************************************/
+/*                                                                            */
+/*  Scan - LE scanner with duplicate suppression and RSSI aggregation.        */
+/*                                                                            */
+/*  The controller filter of duplicates is not used (its table is small and  */
+/*  drops RSSI changes), every advertising report reaches the host and is    */
+/*  filtered here:                                                           */
+/*                                                                            */
+/*     - Up to SCAN_MAXIMUM_DEVICES devices are tracked in a hash table by   */
+/*       address.  A report of a tracked device is only delivered if its     */
+/*       data changed, its RSSI is averaged over a sliding window and a      */
+/*       change of the average is delivered from Scan_Process().             */
+/*     - Every other device is remembered in a rotating bloom filter (two    */
+/*       generations of SCAN_BLOOM_ROTATE_MS) by address and data, so a      */
+/*       device that did not fit into the table is delivered again only if  */
+/*       its data changed or after it was not heard for up to two            */
+/*       generations.                                                        */
+/*                                                                            */
+/*  Only the table keeps RSSI, so no more than SCAN_MAXIMUM_DEVICES devices   */
+/*  are tracked.  The filters are sized for about 2000 devices heard per      */
+/*  generation: with 2000 beacons ScanBench misses the first data of 10 and  */
+/*  4% of the data changes, with 5000 beacons 6% and 26% (the filters fill   */
+/*  up and report unseen data as a duplicate).                               */
+/*                                                                            */
+/*  The callback path does two hashes and at most one table lookup and three */
+/*  bloom bit tests per report, the windows and generations are advanced     */
+/*  from the main loop.                                                      */
+/*                                                                            */
+/*  The scanner is only compiled in if SCAN_ENABLE is defined (the SCAN       */
+/*  option of CMakeLists.txt).  The demo only connects as the slave, so by    */
+/*  default the 5.3 KB of RAM of the device table and the bloom filters are   */
+/*  left to the rest of the image (see NoOS/Budget.txt).                      */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __SCANH__
+#define __SCANH__
+
+#include "SS1BTPS.h"       /* Includes for the SS1 Bluetooth Protocol Stack.  */
+
+#ifndef SCAN_MAXIMUM_DEVICES
+
+#define SCAN_MAXIMUM_DEVICES                        (32)  /* Denotes the number*/
+                                                         /* of devices that   */
+                                                         /* are tracked (with */
+                                                         /* RSSI aggregation).*/
+
+#endif
+
+#ifndef SCAN_BLOOM_BITS
+
+#define SCAN_BLOOM_BITS                          (16384)  /* Denotes the size  */
+                                                         /* (in bits, a power */
+                                                         /* of 2) of a bloom  */
+                                                         /* filter generation.*/
+
+#endif
+
+#define SCAN_BLOOM_HASHES                            (3)  /* Denotes the number*/
+                                                         /* of bits set per   */
+                                                         /* device.           */
+
+#define SCAN_BLOOM_ROTATE_MS                     (10000)  /* Denotes the       */
+                                                         /* lifetime of a     */
+                                                         /* bloom filter      */
+                                                         /* generation.       */
+
+#define SCAN_RSSI_WINDOW_MS                       (2000)  /* Denotes the length*/
+                                                         /* of the sliding    */
+                                                         /* RSSI window.      */
+
+#define SCAN_RSSI_SLOTS                              (4)  /* Denotes the number*/
+                                                         /* of slots the      */
+                                                         /* window advances   */
+                                                         /* by.               */
+
+#define SCAN_RSSI_CHANGE_DB                          (6)  /* Denotes the change*/
+                                                         /* of the average    */
+                                                         /* RSSI that is      */
+                                                         /* delivered.        */
+
+#define SCAN_DEVICE_TIMEOUT_MS                   (10000)  /* Denotes how long a*/
+                                                         /* tracked device may*/
+                                                         /* be silent before  */
+                                                         /* it is reported    */
+                                                         /* lost.             */
+
+#define SCAN_DEFAULT_INTERVAL                      (160)  /* Denotes the scan  */
+#define SCAN_DEFAULT_WINDOW                        (160)  /* interval and      */
+                                                         /* window (100 ms, in*/
+                                                         /* 0.625 ms units,   */
+                                                         /* scanning all the  */
+                                                         /* time).            */
+
+   /* The following enumerated type represents the reason a report is   */
+   /* delivered.                                                        */
+typedef enum
+{
+   srNew,
+   srDataChanged,
+   srRSSIChanged,
+   srLost
+} Scan_Report_Reason_t;
+
+   /* The following structure is a report delivered to the application. */
+   /* RSSI is the one of the advertising report for srNew and           */
+   /* srDataChanged and the window average otherwise.  Reports is the   */
+   /* number of advertising reports in the window (zero for devices that*/
+   /* are not tracked).  The data (the advertising data or scan response*/
+   /* as received) is only valid during the callback and is NULL for    */
+   /* srRSSIChanged and srLost.                                         */
+typedef struct _tagScan_Report_t
+{
+   Scan_Report_Reason_t             Reason;
+   Boolean_t                        Tracked;
+   GAP_LE_Address_Type_t            Address_Type;
+   BD_ADDR_t                        BD_ADDR;
+   GAP_LE_Advertising_Report_Type_t Report_Type;
+   SByte_t                          RSSI;
+   unsigned int                     Reports;
+   unsigned int                     Data_Length;
+   Byte_t                          *Data;
+} Scan_Report_t;
+
+   /* The following type definition represents the function that        */
+   /* receives the delivered reports.                                   */
+typedef void (*Scan_Report_Callback_t)(Scan_Report_t *Report, unsigned long CallbackParameter);
+
+   /* The following structure holds the statistics of the scanner.      */
+typedef struct _tagScan_Statistics_t
+{
+   unsigned long Received;
+   unsigned long Delivered;
+   unsigned long SuppressedTracked;
+   unsigned long SuppressedBloom;
+   unsigned long Untracked;
+   unsigned long Evicted;
+   unsigned long Lost;
+   unsigned long Rotations;
+   unsigned int  TrackedDevices;
+   unsigned int  BloomInserts;
+} Scan_Statistics_t;
+
+#ifdef SCAN_ENABLE
+
+   /* The following function starts scanning (active scanning requests  */
+   /* the scan responses too) with the specified interval and window (in*/
+   /* 0.625 ms units).  The tracked devices and the bloom filter are    */
+   /* cleared.  This function returns zero if successful or a negative  */
+   /* error code.                                                       */
+int Scan_Start(unsigned int BluetoothStackID, Boolean_t Active, Word_t Interval, Word_t Window, Scan_Report_Callback_t Callback, unsigned long CallbackParameter);
+
+   /* The following function stops scanning.                            */
+void Scan_Stop(void);
+
+   /* The following function must be called periodically from the main  */
+   /* loop.  It advances the RSSI windows (delivering changed averages),*/
+   /* reports and drops silent devices and rotates the bloom filter.    */
+void Scan_Process(void);
+
+   /* The following function returns the statistics of the scanner.     */
+   /* This function returns zero if successful or a negative value if   */
+   /* the parameter is invalid.                                         */
+int Scan_QueryStatistics(Scan_Statistics_t *Statistics);
+
+   /* The following function displays the statistics of the scanner and */
+   /* the tracked devices.                                              */
+void Scan_Display(void);
+
+#endif
+
+#endif
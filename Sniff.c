@@ -0,0 +1,555 @@
+/*****< sniff.c >**************************************************************/
+/*                                                                            */
+/*  Sniff - Sniff mode and sniff subrating of the idle HFP links.             */
+/*                                                                            */
+/******************************************************************************/
+#include "Main.h"          /* Application Interface Abstraction.              */
+#include "Sniff.h"         /* Sniff Manager Prototypes/Constants.             */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+
+   /* The following type definition represents the container type which */
+   /* holds the state of a link.  RequestTime is the time of the last   */
+   /* mode request (Exiting is set if it was an exit from sniff), Gap   */
+   /* the time that must pass after a rejected sniff request (it grows  */
+   /* with each rejection).                                             */
+typedef struct _tagLink_t
+{
+   Boolean_t                InUse;
+   Sniff_Link_Information_t Information;
+   unsigned long            LastActivity;
+   Boolean_t                Exiting;
+   Boolean_t                Rejected;
+   Boolean_t                SubratingRequested;
+   unsigned long            RequestTime;
+   unsigned long            Gap;
+   unsigned long            ModeStart;
+} Link_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static unsigned int       SniffStackID;             /* Variable which holds the*/
+                                                    /* stack the links are     */
+                                                    /* managed on (zero if     */
+                                                    /* they are not managed).  */
+
+static Boolean_t          SubratingSupported;       /* Variable which flags if */
+                                                    /* the controller supports */
+                                                    /* sniff subrating.        */
+
+static Link_t             Links[SNIFF_MAXIMUM_LINKS]; /* Variable which holds  */
+                                                    /* the tracked links.      */
+
+static Sniff_Statistics_t SniffStatistics;          /* Variable which holds the*/
+                                                    /* statistics.             */
+
+static char *ModeNames[smNumberModes] = { "Active", "Sniff", "Other" };
+
+   /* Internal function prototypes.                                     */
+static Link_t *FindLink(BD_ADDR_t BD_ADDR);
+static Link_t *FindLinkByHandle(Word_t Connection_Handle);
+static void AccountTime(Link_t *Link, unsigned long Now);
+static int ExitSniff(Link_t *Link, unsigned long Now);
+static void RequestSniff(Link_t *Link, unsigned long Now);
+static void ProcessModeChange(HCI_Mode_Change_Event_Data_t *ModeChangeData);
+
+   /* The following function returns the tracked link to the specified  */
+   /* device (NULL if the link is not tracked).                         */
+static Link_t *FindLink(BD_ADDR_t BD_ADDR)
+{
+   unsigned int  Index;
+   Link_t       *ret_val = NULL;
+
+   for(Index=0;(Index<SNIFF_MAXIMUM_LINKS) && (!ret_val);Index++)
+   {
+      if((Links[Index].InUse) && (COMPARE_BD_ADDR(Links[Index].Information.BD_ADDR, BD_ADDR)))
+         ret_val = &Links[Index];
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the tracked link with the specified*/
+   /* connection handle (NULL if the link is not tracked).              */
+static Link_t *FindLinkByHandle(Word_t Connection_Handle)
+{
+   unsigned int  Index;
+   Link_t       *ret_val = NULL;
+
+   for(Index=0;(Index<SNIFF_MAXIMUM_LINKS) && (!ret_val);Index++)
+   {
+      if((Links[Index].InUse) && (Links[Index].Information.Connection_Handle == Connection_Handle))
+         ret_val = &Links[Index];
+   }
+
+   return(ret_val);
+}
+
+   /* The following function adds the time since the last call to the   */
+   /* mode the link is in.                                              */
+static void AccountTime(Link_t *Link, unsigned long Now)
+{
+   Link->Information.ModeTime[Link->Information.Mode] += Now - Link->ModeStart;
+   Link->ModeStart                                     = Now;
+}
+
+   /* The following function asks the controller to take a link in sniff*/
+   /* mode back to active mode (the wake latency is measured from here).*/
+   /* This function returns a positive value if the exit was requested, */
+   /* zero if the link is not in sniff mode or an exit is already       */
+   /* outstanding, or a negative value if the request failed.           */
+static int ExitSniff(Link_t *Link, unsigned long Now)
+{
+   int    ret_val;
+   Byte_t Status;
+
+   if((Link->Information.Mode == smSniff) && (!Link->Exiting))
+   {
+      if((!HCI_Exit_Sniff_Mode(SniffStackID, Link->Information.Connection_Handle, &Status)) && (Status == HCI_ERROR_CODE_NO_ERROR))
+      {
+         Link->Information.Pending = TRUE;
+         Link->Exiting             = TRUE;
+         Link->RequestTime         = Now;
+
+         Link->Information.Wakes++;
+         SniffStatistics.Wakes++;
+
+         ret_val = 1;
+      }
+      else
+      {
+         SniffStatistics.Failures++;
+
+         ret_val = -1;
+      }
+   }
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* The following function asks the controller to put a link into     */
+   /* sniff mode.  Sniff subrating is set up with the first request of  */
+   /* the link, the controller applies it once the link is in sniff     */
+   /* mode.                                                             */
+static void RequestSniff(Link_t *Link, unsigned long Now)
+{
+   Byte_t Status;
+   Word_t Connection_Handle;
+
+   if((SubratingSupported) && (!Link->SubratingRequested))
+   {
+      if((!HCI_Sniff_Subrating(SniffStackID, Link->Information.Connection_Handle, SNIFF_SUBRATING_MAXIMUM_LATENCY, SNIFF_SUBRATING_MINIMUM_REMOTE_TIMEOUT, SNIFF_SUBRATING_MINIMUM_LOCAL_TIMEOUT, &Status, &Connection_Handle)) && (Status == HCI_ERROR_CODE_NO_ERROR))
+         Link->SubratingRequested = TRUE;
+   }
+
+   Link->RequestTime = Now;
+   Link->Rejected    = FALSE;
+
+   if((!HCI_Sniff_Mode(SniffStackID, Link->Information.Connection_Handle, SNIFF_MAXIMUM_INTERVAL, SNIFF_MINIMUM_INTERVAL, SNIFF_ATTEMPT, SNIFF_TIMEOUT, &Status)) && (Status == HCI_ERROR_CODE_NO_ERROR))
+   {
+      Link->Information.Pending = TRUE;
+      Link->Exiting             = FALSE;
+
+      SniffStatistics.Requests++;
+   }
+   else
+   {
+      /* A request the controller refused is retried after the gap as   */
+      /* well.                                                          */
+      Link->Rejected = TRUE;
+
+      SniffStatistics.Failures++;
+   }
+}
+
+   /* The following function processes a Mode Change event.  A failed   */
+   /* sniff request doubles the gap to the next one, an exit that was   */
+   /* not requested by this module is counted as a remote wake.         */
+static void ProcessModeChange(HCI_Mode_Change_Event_Data_t *ModeChangeData)
+{
+   unsigned long  Now;
+   unsigned long  Latency;
+   Link_t        *Link;
+
+   if((Link = FindLinkByHandle(ModeChangeData->Connection_Handle)) != NULL)
+   {
+      Now = BTPS_GetTickCount();
+
+      if(ModeChangeData->Status == HCI_ERROR_CODE_NO_ERROR)
+      {
+         AccountTime(Link, Now);
+
+         switch(ModeChangeData->Current_Mode)
+         {
+            case HCI_CURRENT_MODE_ACTIVE_MODE:
+               if((Link->Information.Pending) && (Link->Exiting))
+               {
+                  Latency = Now - Link->RequestTime;
+
+                  Link->Information.LastWakeLatency   = Latency;
+                  Link->Information.TotalWakeLatency += Latency;
+
+                  if(Latency > Link->Information.MaximumWakeLatency)
+                     Link->Information.MaximumWakeLatency = Latency;
+
+                  if(Latency > SniffStatistics.MaximumWakeLatency)
+                     SniffStatistics.MaximumWakeLatency = Latency;
+               }
+               else
+               {
+                  if(Link->Information.Mode == smSniff)
+                  {
+                     Link->Information.RemoteWakes++;
+                     SniffStatistics.RemoteWakes++;
+                  }
+               }
+
+               /* Whatever woke the link, the idle time starts over.    */
+               Link->Information.Mode = smActive;
+               Link->LastActivity     = Now;
+               break;
+            case HCI_CURRENT_MODE_SNIFF_MODE:
+               Link->Information.Mode     = smSniff;
+               Link->Information.Interval = ModeChangeData->Interval;
+               Link->Gap                  = SNIFF_RETRY_GAP_MS;
+
+               Link->Information.Entries++;
+               SniffStatistics.Entries++;
+               break;
+            default:
+               Link->Information.Mode = smOther;
+               break;
+         }
+
+         Link->Information.Pending = FALSE;
+         Link->Exiting             = FALSE;
+      }
+      else
+      {
+         /* The AG (or the controller) refused the change.  A refused   */
+         /* exit is left to the next wake, a refused sniff request is   */
+         /* asked for again after the gap.                              */
+         if((Link->Information.Pending) && (!Link->Exiting))
+         {
+            Link->Information.Rejections++;
+            SniffStatistics.Rejected++;
+
+            Link->Rejected = TRUE;
+
+            if((Link->Gap *= 2) > SNIFF_MAXIMUM_GAP_MS)
+               Link->Gap = SNIFF_MAXIMUM_GAP_MS;
+         }
+
+         Link->Information.Pending = FALSE;
+         Link->Exiting             = FALSE;
+      }
+   }
+}
+
+   /* The following function starts the management of the link modes of */
+   /* the specified stack (the links that are tracked are dropped, the  */
+   /* statistics are kept).  This function returns zero if successful or*/
+   /* a negative error code.                                            */
+int Sniff_Initialize(unsigned int BluetoothStackID)
+{
+   int ret_val;
+
+   if(BluetoothStackID)
+   {
+      BTPS_MemInitialize(Links, 0, sizeof(Links));
+
+      SniffStackID          = BluetoothStackID;
+      SubratingSupported    = (Boolean_t)(HCI_Command_Supported(BluetoothStackID, HCI_SUPPORTED_COMMAND_SNIFF_SUBRATING_BIT_NUMBER) > 0);
+      SniffStatistics.Links = 0;
+
+      ret_val               = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function stops the management of the link modes.    */
+void Sniff_Cleanup(void)
+{
+   BTPS_MemInitialize(Links, 0, sizeof(Links));
+
+   SniffStackID          = 0;
+   SniffStatistics.Links = 0;
+}
+
+   /* The following function must be called with the HCI events         */
+   /* (connection, disconnection, Mode Change and Sniff Subrating).     */
+void Sniff_ProcessHCIEvent(HCI_Event_Data_t *HCI_Event_Data)
+{
+   unsigned int                          Index;
+   Link_t                               *Link;
+   HCI_Connection_Complete_Event_Data_t *ConnectionData;
+   HCI_Sniff_Subrating_Event_Data_t     *SubratingData;
+
+   if((SniffStackID) && (HCI_Event_Data) && (HCI_Event_Data->Event_Data.Void))
+   {
+      switch(HCI_Event_Data->Event_Data_Type)
+      {
+         case etConnection_Complete_Event:
+            /* Only the ACL links are managed (the SCO links of the     */
+            /* audio connections complete with this event as well).     */
+            ConnectionData = HCI_Event_Data->Event_Data.HCI_Connection_Complete_Event_Data;
+
+            if((ConnectionData->Status == HCI_ERROR_CODE_NO_ERROR) && (ConnectionData->Link_Type == HCI_LINK_TYPE_ACL_CONNECTION) && (!FindLink(ConnectionData->BD_ADDR)))
+            {
+               for(Index=0;(Index<SNIFF_MAXIMUM_LINKS) && (Links[Index].InUse);Index++)
+                  ;
+
+               if(Index < SNIFF_MAXIMUM_LINKS)
+               {
+                  Link = &Links[Index];
+
+                  BTPS_MemInitialize(Link, 0, sizeof(Link_t));
+
+                  Link->InUse                         = TRUE;
+                  Link->Information.BD_ADDR           = ConnectionData->BD_ADDR;
+                  Link->Information.Connection_Handle = ConnectionData->Connection_Handle;
+                  Link->Information.Mode              = smActive;
+                  Link->LastActivity                  = BTPS_GetTickCount();
+                  Link->ModeStart                     = Link->LastActivity;
+                  Link->Gap                           = SNIFF_RETRY_GAP_MS;
+
+                  SniffStatistics.Links++;
+               }
+            }
+            break;
+         case etDisconnection_Complete_Event:
+            if((Link = FindLinkByHandle(HCI_Event_Data->Event_Data.HCI_Disconnection_Complete_Event_Data->Connection_Handle)) != NULL)
+            {
+               Link->InUse = FALSE;
+
+               SniffStatistics.Links--;
+            }
+            break;
+         case etMode_Change_Event:
+            ProcessModeChange(HCI_Event_Data->Event_Data.HCI_Mode_Change_Event_Data);
+            break;
+         case etSniff_Subrating_Event:
+            SubratingData = HCI_Event_Data->Event_Data.HCI_Sniff_Subrating_Event_Data;
+
+            if((SubratingData->Status == HCI_ERROR_CODE_NO_ERROR) && ((Link = FindLinkByHandle(SubratingData->Connection_Handle)) != NULL))
+            {
+               if(!Link->Information.Subrated)
+                  SniffStatistics.Subrated++;
+
+               Link->Information.Subrated                 = TRUE;
+               Link->Information.Maximum_Transmit_Latency = SubratingData->Maximum_Transmit_Latency;
+               Link->Information.Maximum_Receive_Latency  = SubratingData->Maximum_Receive_Latency;
+            }
+            break;
+         default:
+            break;
+      }
+   }
+}
+
+   /* The following function enables (the service level connection is   */
+   /* up) or disables the management of the link to the specified       */
+   /* device.  A disabled link is woken if it is in sniff mode.  This   */
+   /* function returns zero if successful or a negative value if the    */
+   /* link is not tracked.                                              */
+int Sniff_EnableLink(BD_ADDR_t BD_ADDR, Boolean_t Enable)
+{
+   int     ret_val;
+   Link_t *Link;
+
+   if((SniffStackID) && ((Link = FindLink(BD_ADDR)) != NULL))
+   {
+      Link->Information.Managed = Enable;
+      Link->LastActivity        = BTPS_GetTickCount();
+
+      if(!Enable)
+         ExitSniff(Link, Link->LastActivity);
+
+      ret_val = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function notes AT traffic on the link to the        */
+   /* specified device (it restarts the idle time).                     */
+void Sniff_NoteActivity(BD_ADDR_t BD_ADDR)
+{
+   Link_t *Link;
+
+   if((SniffStackID) && ((Link = FindLink(BD_ADDR)) != NULL))
+      Link->LastActivity = BTPS_GetTickCount();
+}
+
+   /* The following function notes that an audio connection to the      */
+   /* specified device was set up (Active TRUE) or released.  The link  */
+   /* is woken and stays active while the audio connection is up.       */
+void Sniff_NoteAudio(BD_ADDR_t BD_ADDR, Boolean_t Active)
+{
+   Link_t *Link;
+
+   if((SniffStackID) && ((Link = FindLink(BD_ADDR)) != NULL))
+   {
+      Link->Information.Audio = Active;
+      Link->LastActivity      = BTPS_GetTickCount();
+
+      if(Active)
+         ExitSniff(Link, Link->LastActivity);
+   }
+}
+
+   /* The following function must be called ahead of an operation on the*/
+   /* link to the specified device that cannot wait for the next sniff  */
+   /* anchor.  This function returns zero if the link is active, a      */
+   /* positive value if the exit from sniff mode was requested, or a    */
+   /* negative value if the link is not tracked.                        */
+int Sniff_Wake(BD_ADDR_t BD_ADDR)
+{
+   int     ret_val;
+   Link_t *Link;
+
+   if((SniffStackID) && ((Link = FindLink(BD_ADDR)) != NULL))
+   {
+      Link->LastActivity = BTPS_GetTickCount();
+
+      /* An exit that is already outstanding is waited for, the         */
+      /* operation is queued by the controller until it completes.      */
+      if((Link->Information.Pending) && (Link->Exiting))
+         ret_val = 1;
+      else
+         ret_val = ExitSniff(Link, Link->LastActivity);
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function must be called periodically from the main  */
+   /* loop.  It puts the links that were idle long enough into sniff    */
+   /* mode.                                                             */
+void Sniff_Process(void)
+{
+   unsigned int   Index;
+   unsigned long  Now;
+   Link_t        *Link;
+
+   if(SniffStackID)
+   {
+      Now = BTPS_GetTickCount();
+
+      for(Index=0;Index<SNIFF_MAXIMUM_LINKS;Index++)
+      {
+         Link = &Links[Index];
+
+         if(!Link->InUse)
+            continue;
+
+         /* A Mode Change that never came ends the request, the mode    */
+         /* is left as it was.  An unanswered sniff request counts as a */
+         /* rejection.                                                  */
+         if((Link->Information.Pending) && ((Now - Link->RequestTime) >= SNIFF_RESPONSE_TIMEOUT_MS))
+         {
+            if(!Link->Exiting)
+            {
+               Link->Rejected = TRUE;
+
+               if((Link->Gap *= 2) > SNIFF_MAXIMUM_GAP_MS)
+                  Link->Gap = SNIFF_MAXIMUM_GAP_MS;
+            }
+
+            Link->Information.Pending = FALSE;
+            Link->Exiting             = FALSE;
+
+            SniffStatistics.Timeouts++;
+         }
+
+         if((!Link->Information.Managed) || (Link->Information.Pending) || (Link->Information.Audio) || (Link->Information.Mode != smActive))
+            continue;
+
+         if((Now - Link->LastActivity) < SNIFF_IDLE_MS)
+            continue;
+
+         if((!Link->Rejected) || ((Now - Link->RequestTime) >= Link->Gap))
+            RequestSniff(Link, Now);
+      }
+   }
+}
+
+   /* The following function returns the state of the link to the       */
+   /* specified device.  This function returns zero if successful or a  */
+   /* negative value if the link is not tracked.                        */
+int Sniff_QueryLink(BD_ADDR_t BD_ADDR, Sniff_Link_Information_t *Information)
+{
+   int     ret_val;
+   Link_t *Link;
+
+   if((Information) && ((Link = FindLink(BD_ADDR)) != NULL))
+   {
+      AccountTime(Link, BTPS_GetTickCount());
+
+      *Information = Link->Information;
+      ret_val      = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function returns the statistics of all links.  This */
+   /* function returns zero if successful or a negative value if the    */
+   /* parameter is invalid.                                             */
+int Sniff_QueryStatistics(Sniff_Statistics_t *Statistics)
+{
+   int ret_val;
+
+   if(Statistics)
+   {
+      *Statistics = SniffStatistics;
+      ret_val     = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function displays the links with their modes, the   */
+   /* wake latencies and the statistics.                                */
+void Sniff_Display(void)
+{
+   unsigned int  Index;
+   Link_t       *Link;
+
+   Display(("   %-17s %-6s %-3s %8s %4s %4s %4s %11s %8s %8s\r\n", "Link", "Mode", "SLC", "Interval", "Sub", "Ent", "Wake", "Lat ms a/m", "Active s", "Sniff s"));
+
+   for(Index=0;Index<SNIFF_MAXIMUM_LINKS;Index++)
+   {
+      Link = &Links[Index];
+
+      if(!Link->InUse)
+         continue;
+
+      AccountTime(Link, BTPS_GetTickCount());
+
+      Display(("   %02X:%02X:%02X:%02X:%02X:%02X %-6s %-3s", Link->Information.BD_ADDR.BD_ADDR5, Link->Information.BD_ADDR.BD_ADDR4, Link->Information.BD_ADDR.BD_ADDR3, Link->Information.BD_ADDR.BD_ADDR2, Link->Information.BD_ADDR.BD_ADDR1, Link->Information.BD_ADDR.BD_ADDR0, ModeNames[Link->Information.Mode], (Link->Information.Managed)?"Yes":"No"));
+
+      /* The interval is in 0.625 ms slots, shown in milliseconds.      */
+      Display((" %8u %4s %4u %4u %5lu/%5lu %8lu %8lu%s%s\r\n", (Link->Information.Interval * 5) / 8, (Link->Information.Subrated)?"Yes":"No", Link->Information.Entries, Link->Information.Wakes, (Link->Information.Wakes)?(Link->Information.TotalWakeLatency / Link->Information.Wakes):0, Link->Information.MaximumWakeLatency, Link->Information.ModeTime[smActive] / 1000, Link->Information.ModeTime[smSniff] / 1000, (Link->Information.Audio)?" (audio)":"", (Link->Information.Pending)?" (pending)":""));
+   }
+
+   Display(("   %-24s %u\r\n", "Links", SniffStatistics.Links));
+   Display(("   %-24s %lu (%lu entered, %lu rejected, %lu unanswered, %lu failed)\r\n", "Sniff Requests", SniffStatistics.Requests, SniffStatistics.Entries, SniffStatistics.Rejected, SniffStatistics.Timeouts, SniffStatistics.Failures));
+   Display(("   %-24s %lu%s\r\n", "Subrated Links", SniffStatistics.Subrated, (SubratingSupported)?"":" (not supported)"));
+   Display(("   %-24s %lu (%lu by the AG)\r\n", "Wakes", SniffStatistics.Wakes, SniffStatistics.RemoteWakes));
+   Display(("   %-24s %lu ms\r\n", "Maximum Wake Latency", SniffStatistics.MaximumWakeLatency));
+}
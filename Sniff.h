@@ -0,0 +1,168 @@
+/*****< sniff.h >**************************************************************/
+/*                                                                            */
+/*  Sniff - Sniff mode and sniff subrating of the idle HFP links.             */
+/*                                                                            */
+/*  Once the service level connection is up the ACL link to the AG is put     */
+/*  into sniff mode when it was quiet (no AT traffic, no audio) for           */
+/*  SNIFF_IDLE_MS.  Sniff subrating is set up with the first request, so the  */
+/*  controllers may lengthen the interval further while nothing is sent.      */
+/*                                                                            */
+/*  The application wakes the link ahead of operations that cannot wait for   */
+/*  the next sniff anchor (ring handling, audio setup), an audio connection   */
+/*  keeps the link active until it is released.  A wake counts as activity,   */
+/*  the link goes back to sniff after it was idle again.                      */
+/*                                                                            */
+/*  The time spent in each mode and the wake-up latency (the exit request to  */
+/*  the Mode Change event) are recorded per link.                             */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __SNIFFH__
+#define __SNIFFH__
+
+#include "SS1BTPS.h"       /* Includes for the SS1 Bluetooth Protocol Stack.  */
+
+#ifndef SNIFF_MAXIMUM_LINKS
+
+#define SNIFF_MAXIMUM_LINKS                          (2)  /* Denotes the number*/
+                                                         /* of ACL links whose*/
+                                                         /* mode is managed.  */
+
+#endif
+
+#define SNIFF_MINIMUM_INTERVAL                     (400)  /* Denotes the sniff */
+#define SNIFF_MAXIMUM_INTERVAL                     (800)  /* parameters (250 - */
+#define SNIFF_ATTEMPT                                (4)  /* 500 ms interval,  */
+#define SNIFF_TIMEOUT                                (1)  /* in slots).        */
+
+#define SNIFF_SUBRATING_MAXIMUM_LATENCY           (3200)  /* Denotes the sniff */
+#define SNIFF_SUBRATING_MINIMUM_REMOTE_TIMEOUT       (0)  /* subrating (2 s    */
+#define SNIFF_SUBRATING_MINIMUM_LOCAL_TIMEOUT     (3200)  /* latency after 2 s */
+                                                         /* without traffic,  */
+                                                         /* in slots).        */
+
+#define SNIFF_IDLE_MS                             (5000)  /* Denotes how long a*/
+                                                         /* link must be quiet*/
+                                                         /* before it is put  */
+                                                         /* into sniff mode.  */
+
+#define SNIFF_RESPONSE_TIMEOUT_MS                 (5000)  /* Denotes how long  */
+                                                         /* the Mode Change   */
+                                                         /* event is waited   */
+                                                         /* for.              */
+
+#define SNIFF_RETRY_GAP_MS                       (10000)  /* Denotes the least */
+#define SNIFF_MAXIMUM_GAP_MS                    (120000)  /* and the largest   */
+                                                         /* time before sniff */
+                                                         /* is asked for again*/
+                                                         /* after a rejection.*/
+
+   /* The following enumerated type represents the modes of a link (hold*/
+   /* and park are counted as other).                                   */
+typedef enum
+{
+   smActive,
+   smSniff,
+   smOther,
+   smNumberModes
+} Sniff_Mode_t;
+
+   /* The following structure holds the state of one link.  Managed is  */
+   /* TRUE while the service level connection is up.  Interval is the   */
+   /* sniff interval of the controller (slots), the subrating latencies */
+   /* are the ones negotiated (slots).  The wake latencies and the time */
+   /* in each mode are in milliseconds.                                 */
+typedef struct _tagSniff_Link_Information_t
+{
+   BD_ADDR_t     BD_ADDR;
+   Word_t        Connection_Handle;
+   Sniff_Mode_t  Mode;
+   Boolean_t     Managed;
+   Boolean_t     Audio;
+   Boolean_t     Pending;
+   Word_t        Interval;
+   Boolean_t     Subrated;
+   Word_t        Maximum_Transmit_Latency;
+   Word_t        Maximum_Receive_Latency;
+   unsigned int  Entries;
+   unsigned int  Rejections;
+   unsigned int  Wakes;
+   unsigned int  RemoteWakes;
+   unsigned long LastWakeLatency;
+   unsigned long MaximumWakeLatency;
+   unsigned long TotalWakeLatency;
+   unsigned long ModeTime[smNumberModes];
+} Sniff_Link_Information_t;
+
+   /* The following structure holds the statistics of all links.        */
+   /* RemoteWakes counts the exits from sniff that were not asked for by*/
+   /* this module (the AG had data or changed the mode itself).         */
+typedef struct _tagSniff_Statistics_t
+{
+   unsigned int  Links;
+   unsigned long Requests;
+   unsigned long Entries;
+   unsigned long Rejected;
+   unsigned long Timeouts;
+   unsigned long Failures;
+   unsigned long Subrated;
+   unsigned long Wakes;
+   unsigned long RemoteWakes;
+   unsigned long MaximumWakeLatency;
+} Sniff_Statistics_t;
+
+   /* The following function starts the management of the link modes of */
+   /* the specified stack (the links that are tracked are dropped, the  */
+   /* statistics are kept).  This function returns zero if successful or*/
+   /* a negative error code.                                            */
+int Sniff_Initialize(unsigned int BluetoothStackID);
+
+   /* The following function stops the management of the link modes.    */
+void Sniff_Cleanup(void);
+
+   /* The following function must be called with the HCI events         */
+   /* (connection, disconnection, Mode Change and Sniff Subrating).     */
+void Sniff_ProcessHCIEvent(HCI_Event_Data_t *HCI_Event_Data);
+
+   /* The following function enables (the service level connection is   */
+   /* up) or disables the management of the link to the specified       */
+   /* device.  A disabled link is woken if it is in sniff mode.  This   */
+   /* function returns zero if successful or a negative value if the    */
+   /* link is not tracked.                                              */
+int Sniff_EnableLink(BD_ADDR_t BD_ADDR, Boolean_t Enable);
+
+   /* The following function notes AT traffic on the link to the        */
+   /* specified device (it restarts the idle time).                     */
+void Sniff_NoteActivity(BD_ADDR_t BD_ADDR);
+
+   /* The following function notes that an audio connection to the      */
+   /* specified device was set up (Active TRUE) or released.  The link  */
+   /* is woken and stays active while the audio connection is up.       */
+void Sniff_NoteAudio(BD_ADDR_t BD_ADDR, Boolean_t Active);
+
+   /* The following function must be called ahead of an operation on the*/
+   /* link to the specified device that cannot wait for the next sniff  */
+   /* anchor.  This function returns zero if the link is active, a      */
+   /* positive value if the exit from sniff mode was requested, or a    */
+   /* negative value if the link is not tracked.                        */
+int Sniff_Wake(BD_ADDR_t BD_ADDR);
+
+   /* The following function must be called periodically from the main  */
+   /* loop.  It puts the links that were idle long enough into sniff    */
+   /* mode.                                                             */
+void Sniff_Process(void);
+
+   /* The following function returns the state of the link to the       */
+   /* specified device.  This function returns zero if successful or a  */
+   /* negative value if the link is not tracked.                        */
+int Sniff_QueryLink(BD_ADDR_t BD_ADDR, Sniff_Link_Information_t *Information);
+
+   /* The following function returns the statistics of all links.  This */
+   /* function returns zero if successful or a negative value if the    */
+   /* parameter is invalid.                                             */
+int Sniff_QueryStatistics(Sniff_Statistics_t *Statistics);
+
+   /* The following function displays the links with their modes, the   */
+   /* wake latencies and the statistics.                                */
+void Sniff_Display(void);
+
+#endif
@@ -0,0 +1,229 @@
+/*****< stackmark.c >**********************************************************/
+/*                                                                            */
+/*  StackMark - Stack high-watermark painting with per-section peaks.         */
+/*                                                                            */
+/******************************************************************************/
+#include "Main.h"          /* Application Interface Abstraction.              */
+#include "StackMark.h"     /* Stack Watermark Prototypes/Constants.           */
+#include "BTPSKRNL.h"      /* BTPS Kernel Header.                             */
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+static StackMark_Entry_t EntryList[STACK_MARK_MAXIMUM_ENTRIES]; /* Variable   */
+                                                    /* which holds the measured*/
+                                                    /* name/key pairs.         */
+
+static unsigned int      NumberEntries;             /* Variable which holds the*/
+                                                    /* number of valid entries */
+                                                    /* in the Entry List.      */
+
+static unsigned long     DroppedRecords;            /* Variable which holds the*/
+                                                    /* number of measurements  */
+                                                    /* that did not fit in the */
+                                                    /* Entry List.             */
+
+#if !defined(__linux__)
+
+static unsigned long    *HighWatermark;             /* Variable which holds the*/
+                                                    /* deepest used word of the*/
+                                                    /* stack since reset.      */
+
+static unsigned long    *SectionLowest;             /* Variable which holds the*/
+                                                    /* deepest word used by the*/
+                                                    /* sections in progress    */
+                                                    /* (NULL if none).         */
+
+   /* Internal function prototypes.                                     */
+static unsigned long *FindLowest(void);
+static void RecordPeak(const char *Name, unsigned int Key, unsigned long Peak);
+
+   /* The following function returns the deepest word of the stack that  */
+   /* no longer holds the paint and updates the high watermark.         */
+static unsigned long *FindLowest(void)
+{
+   unsigned long *ret_val;
+
+   for(ret_val=STACK_MARK_BOTTOM;(ret_val < STACK_MARK_TOP) && (*ret_val == STACK_MARK_PAINT);ret_val++)
+      ;
+
+   if((!HighWatermark) || (ret_val < HighWatermark))
+      HighWatermark = ret_val;
+
+   return(ret_val);
+}
+
+   /* The following function paints the stack below the current frame.  */
+   /* It is called by the reset handler before the C initialization, so */
+   /* it must not use any static data.                                  */
+void StackMark_Paint(void)
+{
+   unsigned long  Frame;
+   unsigned long *Word;
+
+   for(Word=STACK_MARK_BOTTOM;Word<(&Frame - STACK_MARK_GUARD_WORDS);Word++)
+      *Word = STACK_MARK_PAINT;
+}
+
+   /* The following function starts the measurement of a section.  The   */
+   /* return value must be passed to StackMark_Stop().                  */
+unsigned long *StackMark_Start(void)
+{
+   unsigned long  Frame;
+   unsigned long *ret_val;
+   unsigned long *Lowest;
+   unsigned long *Word;
+
+   Lowest = FindLowest();
+
+   /* The re-painting below erases what the enclosing sections used so  */
+   /* far, so it is folded into their peak first.                       */
+   if((SectionLowest) && (Lowest < SectionLowest))
+      SectionLowest = Lowest;
+
+   ret_val = SectionLowest;
+
+   /* Re-paint the used part of the stack below the current frame.      */
+   for(Word=Lowest;Word<(&Frame - STACK_MARK_GUARD_WORDS);Word++)
+      *Word = STACK_MARK_PAINT;
+
+   SectionLowest = &Frame;
+
+   return(ret_val);
+}
+
+   /* The following function stops the measurement of a section and     */
+   /* records the peak for the specified name/key pair.                 */
+void StackMark_Stop(unsigned long *Enclosing, const char *Name, unsigned int Key)
+{
+   unsigned long *Lowest;
+
+   Lowest = FindLowest();
+
+   /* Nested sections re-painted the stack, their peak is included.     */
+   if((SectionLowest) && (SectionLowest < Lowest))
+      Lowest = SectionLowest;
+
+   RecordPeak(Name, Key, (unsigned long)(STACK_MARK_TOP - Lowest) * sizeof(unsigned long));
+
+   if((Enclosing) && (Enclosing < Lowest))
+      Lowest = Enclosing;
+
+   SectionLowest = (Enclosing)?Lowest:NULL;
+}
+
+   /* The following function records the peak (in bytes) of the         */
+   /* specified name/key pair.                                          */
+static void RecordPeak(const char *Name, unsigned int Key, unsigned long Peak)
+{
+   unsigned int Index;
+
+   for(Index=0;(Index<NumberEntries) && ((EntryList[Index].Name != Name) || (EntryList[Index].Key != Key));Index++)
+      ;
+
+   if(Index == NumberEntries)
+   {
+      if(NumberEntries == STACK_MARK_MAXIMUM_ENTRIES)
+      {
+         DroppedRecords++;
+         return;
+      }
+
+      EntryList[Index].Name = Name;
+      EntryList[Index].Key  = Key;
+
+      NumberEntries++;
+   }
+
+   EntryList[Index].Count++;
+
+   if(Peak > EntryList[Index].Peak)
+      EntryList[Index].Peak = Peak;
+}
+
+#endif
+
+   /* The following function returns the deepest stack usage (in bytes)  */
+   /* since reset and the size of the stack.                            */
+unsigned long StackMark_QueryPeak(unsigned long *StackSize)
+{
+   unsigned long ret_val;
+
+#if !defined(__linux__)
+
+   FindLowest();
+
+   ret_val = (unsigned long)(STACK_MARK_TOP - HighWatermark) * sizeof(unsigned long);
+
+   if(StackSize)
+      *StackSize = (unsigned long)(STACK_MARK_TOP - STACK_MARK_BOTTOM) * sizeof(unsigned long);
+
+#else
+
+   ret_val = 0;
+
+   if(StackSize)
+      *StackSize = 0;
+
+#endif
+
+   return(ret_val);
+}
+
+   /* The following function copies up to MaximumEntries measured name/  */
+   /* key pairs to the specified buffer.  This function returns the     */
+   /* number of pairs that were copied.                                 */
+unsigned int StackMark_QueryEntries(unsigned int MaximumEntries, StackMark_Entry_t *Entries)
+{
+   unsigned int ret_val;
+
+   ret_val = (MaximumEntries < NumberEntries)?MaximumEntries:NumberEntries;
+
+   if((ret_val) && (Entries))
+      BTPS_MemCopy(Entries, EntryList, ret_val * sizeof(StackMark_Entry_t));
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* The following function displays the high watermark of the stack    */
+   /* and the peak of every measured section.                           */
+void StackMark_Display(void)
+{
+   unsigned int  Index;
+   unsigned long Peak;
+   unsigned long StackSize;
+
+   Peak = StackMark_QueryPeak(&StackSize);
+
+   if(StackSize)
+   {
+      Display(("Stack: %lu of %lu bytes used since reset, %lu free.\r\n", Peak, StackSize, StackSize - Peak));
+
+      /* No painted word is left if the stack was used up completely.    */
+      if(Peak == StackSize)
+         Display(("   The stack was used up, it may have overflowed.\r\n"));
+
+      Display(("   %-24s %4s %8s %8s\r\n", "Name", "Key", "Count", "Peak"));
+
+      for(Index=0;Index<NumberEntries;Index++)
+         Display(("   %-24s %4u %8lu %8lu\r\n", EntryList[Index].Name, EntryList[Index].Key, EntryList[Index].Count, EntryList[Index].Peak));
+
+      if(DroppedRecords)
+         Display(("   %lu measurements dropped (increase STACK_MARK_MAXIMUM_ENTRIES).\r\n", DroppedRecords));
+   }
+   else
+      Display(("Stack watermarks are not available in this build.\r\n"));
+}
+
+   /* The following function clears the measurements of the sections     */
+   /* (the high watermark since reset is kept).                         */
+void StackMark_Reset(void)
+{
+   BTPS_MemInitialize(EntryList, 0, sizeof(EntryList));
+
+   NumberEntries  = 0;
+   DroppedRecords = 0;
+}
@@ -0,0 +1,142 @@
+/*****< stackmark.h >**********************************************************/
+/*                                                                            */
+/*  StackMark - Stack high-watermark painting with per-section peaks.         */
+/*                                                                            */
+/*  The stack is painted with STACK_MARK_PAINT at reset (StackMark_Paint()    */
+/*  is called by the reset handler of every startup file before the C         */
+/*  initialization).  The deepest word that no longer holds the paint is the  */
+/*  high watermark of the stack.                                              */
+/*                                                                            */
+/*  Code sections (event callbacks, console commands) are measured by         */
+/*  re-painting the stack below the current stack pointer when the section    */
+/*  starts and by finding the deepest used word when it stops, the peak of    */
+/*  every section (name and key, e.g. the event type) is kept in a fixed      */
+/*  table.  Nested sections are accounted to the enclosing section as well.   */
+/*  Interrupts that occur during a section are accounted to the section.      */
+/*                                                                            */
+/*  The stack bounds are taken from the toolchain: the __stack and            */
+/*  __STACK_TOP symbols of the TI linker (linker_ccs.cmd), the .noinit        */
+/*  section of IAR (startup_ewarm.c places only the stack there) and the      */
+/*  STACK$$Base and STACK$$Limit symbols of the Keil linker for the STACK     */
+/*  area of startup_rvmdk.S.  Other toolchains must define STACK_MARK_BOTTOM  */
+/*  and STACK_MARK_TOP.  The Linux build has no painted stack, the macros     */
+/*  below expand to nothing and StackMark_Display() reports that.             */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __STACKMARKH__
+#define __STACKMARKH__
+
+#define STACK_MARK_PAINT                  (0xC5C5C5C5UL)  /* Denotes the value */
+                                                         /* the unused stack  */
+                                                         /* is painted with.  */
+
+#define STACK_MARK_GUARD_WORDS                      (16)  /* Denotes the words */
+                                                         /* below the current */
+                                                         /* frame that are not*/
+                                                         /* painted (frame of */
+                                                         /* the painting      */
+                                                         /* function).        */
+
+#ifndef STACK_MARK_MAXIMUM_ENTRIES
+
+#define STACK_MARK_MAXIMUM_ENTRIES                  (16)  /* Denotes the max   */
+                                                         /* number of name/key*/
+                                                         /* pairs that are    */
+                                                         /* measured.         */
+
+#endif
+
+#ifndef STACK_MARK_BOTTOM
+
+#if defined(__ICCARM__)
+
+   /* The stack is the only .noinit data (startup_ewarm.c).             */
+#pragma section = ".noinit"
+
+#define STACK_MARK_BOTTOM                         ((unsigned long *)__section_begin(".noinit"))
+#define STACK_MARK_TOP                            ((unsigned long *)__section_end(".noinit"))
+
+#elif defined(__CC_ARM) || defined(__ARMCC_VERSION)
+
+   /* Linker symbols of the STACK area (startup_rvmdk.S).               */
+extern unsigned long STACK$$Base;
+extern unsigned long STACK$$Limit;
+
+#define STACK_MARK_BOTTOM                         (&STACK$$Base)
+#define STACK_MARK_TOP                            (&STACK$$Limit)
+
+#else
+
+   /* Linker symbols of the stack (linker_ccs.cmd).                     */
+extern unsigned long __stack;
+extern unsigned long __STACK_TOP;
+
+#define STACK_MARK_BOTTOM                         (&__stack)
+#define STACK_MARK_TOP                            (&__STACK_TOP)
+
+#endif
+
+#endif
+
+   /* The following structure holds the peak of a single name/key pair.  */
+   /* Peak is the deepest stack usage (in bytes from the top of the     */
+   /* stack) that was observed during the section.                      */
+typedef struct _tagStackMark_Entry_t
+{
+   const char    *Name;
+   unsigned int   Key;
+   unsigned long  Count;
+   unsigned long  Peak;
+} StackMark_Entry_t;
+
+#if !defined(__linux__)
+
+   /* The following macros instrument a code section.                   */
+   /* STACK_MARK_DECLARE() declares the variable that holds the state of*/
+   /* the enclosing sections (it must be used with the other local      */
+   /* declarations), STACK_MARK_START() starts the measurement and      */
+   /* STACK_MARK_STOP() records the peak for the specified name and key.*/
+   /* Names are compared by address (see PROFILE_STOP() in Profile.h).  */
+#define STACK_MARK_DECLARE(_x)                    unsigned long *_x;
+#define STACK_MARK_START(_x)                      do { (_x) = StackMark_Start(); } while(0)
+#define STACK_MARK_STOP(_x, _y, _z)               StackMark_Stop((_x), (_y), (unsigned int)(_z))
+
+   /* The following function paints the stack below the current frame.  */
+   /* It is called by the reset handler before the C initialization, so */
+   /* it must not use any static data.                                  */
+void StackMark_Paint(void);
+
+   /* The following function starts the measurement of a section.  The   */
+   /* return value must be passed to StackMark_Stop().                  */
+unsigned long *StackMark_Start(void);
+
+   /* The following function stops the measurement of a section and     */
+   /* records the peak for the specified name/key pair.                 */
+void StackMark_Stop(unsigned long *Enclosing, const char *Name, unsigned int Key);
+
+#else
+
+#define STACK_MARK_DECLARE(_x)
+#define STACK_MARK_START(_x)
+#define STACK_MARK_STOP(_x, _y, _z)
+
+#endif
+
+   /* The following function returns the deepest stack usage (in bytes)  */
+   /* since reset and the size of the stack.                            */
+unsigned long StackMark_QueryPeak(unsigned long *StackSize);
+
+   /* The following function copies up to MaximumEntries measured name/  */
+   /* key pairs to the specified buffer.  This function returns the     */
+   /* number of pairs that were copied.                                 */
+unsigned int StackMark_QueryEntries(unsigned int MaximumEntries, StackMark_Entry_t *Entries);
+
+   /* The following function displays the high watermark of the stack    */
+   /* and the peak of every measured section.                           */
+void StackMark_Display(void);
+
+   /* The following function clears the measurements of the sections     */
+   /* (the high watermark since reset is kept).                         */
+void StackMark_Reset(void);
+
+#endif